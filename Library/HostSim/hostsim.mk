@@ -0,0 +1,45 @@
+#/**************************************************************************//**
+# * @file     hostsim.mk
+# * @version  V1.00
+# * @brief    Make fragment for building StdDriver code against the host simulator
+# *
+# * @note     Set BSP_ROOT to the BSP top directory and append application sources
+# *           to HOSTSIM_APP_SRC before including this file. Only x86-64 Linux is
+# *           supported; the executable is linked non-PIE so that buffers handed to
+# *           the PDMA model have 32-bit addresses.
+# *
+# * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+# *****************************************************************************/
+
+HOSTSIM_DIR      := $(BSP_ROOT)/Library/HostSim
+HOSTSIM_CC       ?= gcc
+
+HOSTSIM_INC      := -I$(BSP_ROOT)/Library/CMSIS/Include \
+                    -I$(BSP_ROOT)/Library/Device/Nuvoton/M031/Include \
+                    -I$(BSP_ROOT)/Library/StdDriver/inc \
+                    -I$(HOSTSIM_DIR)/inc
+
+HOSTSIM_CFLAGS   := -O2 -g -std=gnu99 -fno-pie -fno-strict-aliasing -Wno-attributes \
+                    -include $(HOSTSIM_DIR)/inc/hostsim_cmsis.h \
+                    -Wno-int-to-pointer-cast -Wno-pointer-to-int-cast \
+                    $(HOSTSIM_INC)
+
+HOSTSIM_LDFLAGS  := -no-pie
+
+HOSTSIM_DRV      ?= uart spi pdma fmc crc usbd adc clk sys
+HOSTSIM_DRV_SRC  := $(foreach d,$(HOSTSIM_DRV),$(BSP_ROOT)/Library/StdDriver/src/$(d).c)
+
+HOSTSIM_SIM_SRC  := $(HOSTSIM_DIR)/src/hostsim.c \
+                    $(HOSTSIM_DIR)/src/hostsim_uart.c \
+                    $(HOSTSIM_DIR)/src/hostsim_spi.c \
+                    $(HOSTSIM_DIR)/src/hostsim_uspi.c \
+                    $(HOSTSIM_DIR)/src/hostsim_pdma.c \
+                    $(HOSTSIM_DIR)/src/hostsim_fmc.c \
+                    $(HOSTSIM_DIR)/src/hostsim_crc.c \
+                    $(HOSTSIM_DIR)/src/hostsim_usbd.c \
+                    $(HOSTSIM_DIR)/src/hostsim_timer.c \
+                    $(HOSTSIM_DIR)/src/hostsim_adc.c
+
+HOSTSIM_SRC      := $(HOSTSIM_SIM_SRC) $(HOSTSIM_DRV_SRC) \
+                    $(BSP_ROOT)/Library/Device/Nuvoton/M031/Source/system_M031Series.c \
+                    $(HOSTSIM_APP_SRC)
@@ -0,0 +1,156 @@
+/**************************************************************************//**
+ * @file     hostsim.h
+ * @version  V1.00
+ * @brief    M031 series host (Linux) register-level simulator header file
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __HOSTSIM_H__
+#define __HOSTSIM_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+/** @addtogroup HOSTSIM_EXPORTED_CONSTANTS HostSim Exported Constants
+  @{
+*/
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Simulated address map                                                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+#define HOSTSIM_CORE_BASE       0x5F000000UL    /*!< Simulated core special registers (PRIMASK, WFI)  \hideinitializer */
+#define HOSTSIM_CORE_PRIMASK    (HOSTSIM_CORE_BASE + 0x00UL)    /*!< PRIMASK shadow used by MRS/MSR/CPSID/CPSIE  \hideinitializer */
+#define HOSTSIM_CORE_CONTROL    (HOSTSIM_CORE_BASE + 0x04UL)    /*!< CONTROL/other special register shadow  \hideinitializer */
+#define HOSTSIM_CORE_WFI        (HOSTSIM_CORE_BASE + 0x08UL)    /*!< Read by WFI/WFE to skip time to the next event  \hideinitializer */
+
+#define HOSTSIM_ACCESS_CYCLES   4UL             /*!< Default HCLK cycles charged per trapped CPU access  \hideinitializer */
+#define HOSTSIM_UART_NUM        3UL             /*!< Number of simulated UART channels (UART0~UART2)  \hideinitializer */
+#define HOSTSIM_UART_SINK_SIZE  0x10000UL       /*!< Bytes buffered per UART transmit sink  \hideinitializer */
+#define HOSTSIM_TIMER_NUM       4UL             /*!< Number of simulated timers (TIMER0~TIMER3)  \hideinitializer */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  USB host transaction result                                                                            */
+/*---------------------------------------------------------------------------------------------------------*/
+#define HOSTSIM_USB_NAK         (-1)            /*!< Endpoint answered NAK  \hideinitializer */
+#define HOSTSIM_USB_STALL       (-2)            /*!< Endpoint answered STALL  \hideinitializer */
+#define HOSTSIM_USB_NOEP        (-3)            /*!< No endpoint configured for the address  \hideinitializer */
+
+/*@}*/ /* end of group HOSTSIM_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup HOSTSIM_EXPORTED_STRUCTS HostSim Exported Structs
+  @{
+*/
+
+/**
+  * @details    Counters collected while drivers run on the simulator.
+  */
+typedef struct
+{
+    uint64_t u64Cycle;                  /*!< HCLK cycles elapsed since last HostSim_ClearStat() */
+    uint64_t u64Access;                 /*!< CPU accesses to simulated registers or peripheral SRAM */
+    uint64_t u64DmaBeat;                /*!< Data items moved by the PDMA model */
+    uint32_t au32IrqCnt[32];            /*!< Handler entries per IRQn */
+    uint32_t u32SysTickCnt;             /*!< SysTick_Handler entries */
+} HOSTSIM_STAT_T;
+
+/**
+  * @details    Flash wear and timing counters of the FMC model.
+  */
+typedef struct
+{
+    uint32_t u32PageErase;              /*!< Page erase commands executed */
+    uint32_t u32WordProgram;            /*!< Words programmed by FMC_ISPCMD_PROGRAM / PROGRAM_64 */
+    uint32_t u32MultiProgram;           /*!< Words programmed by FMC_ISPCMD_MULTI_PROG */
+    uint32_t u32IspCmd;                 /*!< ISP commands triggered in total */
+} HOSTSIM_FMC_STAT_T;
+
+typedef uint32_t (*HOSTSIM_SPI_SLAVE_T)(uint32_t u32TxData);   /*!< SPI slave model, returns the word shifted back */
+typedef uint32_t (*HOSTSIM_ADC_SOURCE_T)(uint32_t u32Ch, uint64_t u64Cycle);   /*!< Analog input model, returns the conversion result */
+
+/*@}*/ /* end of group HOSTSIM_EXPORTED_STRUCTS */
+
+
+/** @addtogroup HOSTSIM_EXPORTED_FUNCTIONS HostSim Exported Functions
+  @{
+*/
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Simulator control                                                                                       */
+/*---------------------------------------------------------------------------------------------------------*/
+int32_t  HostSim_Init(uint32_t u32HclkFreq);
+void     HostSim_Close(void);
+uint32_t HostSim_GetHclkFreq(void);
+uint64_t HostSim_GetCycle(void);
+void     HostSim_SetAccessCycles(uint32_t u32Cycles);
+void     HostSim_Delay(uint32_t u32Cycles);
+int32_t  HostSim_RunUntilIdle(uint64_t u64MaxCycles);
+void     HostSim_GetStat(HOSTSIM_STAT_T *psStat);
+void     HostSim_ClearStat(void);
+void     HostSim_SetResetHook(void (*pfnHook)(void));
+uint32_t HostSim_GpioGetPin(uint32_t u32Port, uint32_t u32Pin);
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* UART line side                                                                                          */
+/*---------------------------------------------------------------------------------------------------------*/
+void     HostSim_UartSetLoopback(uint32_t u32Port, uint32_t u32Enable);
+uint32_t HostSim_UartInject(uint32_t u32Port, const uint8_t pu8Buf[], uint32_t u32Len);
+uint32_t HostSim_UartInjectAddress(uint32_t u32Port, uint8_t u8Addr);
+uint32_t HostSim_UartTake(uint32_t u32Port, uint8_t pu8Buf[], uint32_t u32Len);
+uint64_t HostSim_UartGetTxCount(uint32_t u32Port);
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* SPI line side                                                                                           */
+/*---------------------------------------------------------------------------------------------------------*/
+void     HostSim_SpiSetSlave(HOSTSIM_SPI_SLAVE_T pfnSlave);
+uint64_t HostSim_SpiGetTxCount(void);
+void     HostSim_UspiSetSlave(HOSTSIM_SPI_SLAVE_T pfnSlave);
+uint64_t HostSim_UspiGetTxCount(void);
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* ADC analog side                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+void     HostSim_AdcSetSource(HOSTSIM_ADC_SOURCE_T pfnSource);
+uint64_t HostSim_AdcGetConvCount(uint64_t *pu64Lost);
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Timers                                                                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+uint64_t HostSim_TimerGetTimeoutCount(uint32_t u32Timer);
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Flash array                                                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+void     HostSim_FmcLoad(uint32_t u32Addr, const void *pvBuf, uint32_t u32Len);
+void     HostSim_FmcDump(uint32_t u32Addr, void *pvBuf, uint32_t u32Len);
+void     HostSim_FmcGetStat(HOSTSIM_FMC_STAT_T *psStat);
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* USB host side                                                                                           */
+/*---------------------------------------------------------------------------------------------------------*/
+void     HostSim_UsbdAttach(uint32_t u32Attach);
+void     HostSim_UsbdBusReset(void);
+int32_t  HostSim_UsbdSetup(const uint8_t pu8Setup[8]);
+int32_t  HostSim_UsbdOut(uint32_t u32EpAddr, const uint8_t pu8Buf[], uint32_t u32Len);
+int32_t  HostSim_UsbdIn(uint32_t u32EpAddr, uint8_t pu8Buf[], uint32_t u32Len);
+
+/*@}*/ /* end of group HOSTSIM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group HostSim */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOSTSIM_H__ */
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,78 @@
+/**************************************************************************//**
+ * @file     hostsim_cmsis.h
+ * @version  V1.00
+ * @brief    Cortex-M0 core instruction shims for host simulator builds
+ *
+ * @note     This header is force-included (gcc -include) into every translation
+ *           unit of a host build. cmsis_gcc.h emits Thumb instructions through
+ *           inline assembly; the assembler macros below re-encode them as x86-64
+ *           accesses to the simulated core page (HOSTSIM_CORE_BASE), so PRIMASK
+ *           critical sections and WFI are visible to the simulator and the
+ *           CMSIS headers can be used unmodified.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __HOSTSIM_CMSIS_H__
+#define __HOSTSIM_CMSIS_H__
+
+#if !defined(__x86_64__)
+#error "The host simulator supports x86-64 Linux builds only."
+#endif
+
+#define HOSTSIM_CMSIS_STR_(x)   #x
+#define HOSTSIM_CMSIS_STR(x)    HOSTSIM_CMSIS_STR_(x)
+
+/* Keep in sync with HOSTSIM_CORE_PRIMASK / HOSTSIM_CORE_CONTROL / HOSTSIM_CORE_WFI in hostsim.h */
+#define HOSTSIM_CMSIS_PRIMASK   0x5F000000
+#define HOSTSIM_CMSIS_CONTROL   0x5F000004
+#define HOSTSIM_CMSIS_WFI       0x5F000008
+
+__asm__(
+    ".macro MRS reg, sysreg\n"
+    "  .ifc \\sysreg,primask\n"
+    "    movl " HOSTSIM_CMSIS_STR(HOSTSIM_CMSIS_PRIMASK) ", \\reg\n"
+    "  .else\n"
+    "    movl " HOSTSIM_CMSIS_STR(HOSTSIM_CMSIS_CONTROL) ", \\reg\n"
+    "  .endif\n"
+    ".endm\n"
+    ".macro MSR sysreg, reg\n"
+    "  .ifc \\sysreg,primask\n"
+    "    movl \\reg, " HOSTSIM_CMSIS_STR(HOSTSIM_CMSIS_PRIMASK) "\n"
+    "  .else\n"
+    "    movl \\reg, " HOSTSIM_CMSIS_STR(HOSTSIM_CMSIS_CONTROL) "\n"
+    "  .endif\n"
+    ".endm\n"
+    ".macro cpsid flag\n"
+    "    movl $1, " HOSTSIM_CMSIS_STR(HOSTSIM_CMSIS_PRIMASK) "\n"
+    ".endm\n"
+    ".macro cpsie flag\n"
+    "    movl $0, " HOSTSIM_CMSIS_STR(HOSTSIM_CMSIS_PRIMASK) "\n"
+    ".endm\n"
+    ".macro wfi\n"
+    "    testl $0, " HOSTSIM_CMSIS_STR(HOSTSIM_CMSIS_WFI) "\n"
+    ".endm\n"
+    ".macro wfe\n"
+    "    testl $0, " HOSTSIM_CMSIS_STR(HOSTSIM_CMSIS_WFI) "\n"
+    ".endm\n"
+    ".macro sev\n"
+    ".endm\n"
+    ".macro isb opt\n"
+    ".endm\n"
+    ".macro dsb opt\n"
+    "    mfence\n"
+    ".endm\n"
+    ".macro dmb opt\n"
+    "    mfence\n"
+    ".endm\n"
+    ".macro rev dst, src\n"
+    "    movl \\src, \\dst\n"
+    "    bswap \\dst\n"
+    ".endm\n"
+    ".macro bkpt val\n"
+    "    int3\n"
+    ".endm\n"
+);
+
+#endif /* __HOSTSIM_CMSIS_H__ */
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,1320 @@
+/**************************************************************************//**
+ * @file     hostsim.c
+ * @version  V1.00
+ * @brief    M031 series host (Linux) register-level simulator core
+ *
+ * @note     The peripheral window (AHB_BASE), the System Control Space (SCS_BASE)
+ *           and the simulated core page (HOSTSIM_CORE_BASE) are mapped at their
+ *           device addresses with no access permission. Every driver access
+ *           faults (SIGSEGV); the access is then charged to the virtual HCLK,
+ *           handed to the owning peripheral model and single-stepped (SIGTRAP)
+ *           through a temporarily opened page. Pending interrupts are dispatched
+ *           to the weak <peripheral>_IRQHandler symbols after each access. A
+ *           register that keeps reading back the same value is being polled;
+ *           the clock then skips to the next model event.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "hostsim_model.h"
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE     0x100000
+#endif
+
+#define HOSTSIM_PAGE_SIZE       0x1000UL
+#define HOSTSIM_STEP_PAGES      4UL
+#define HOSTSIM_EFLAGS_TF       0x100UL
+#define HOSTSIM_PF_WRITE        0x2UL
+#define HOSTSIM_SPIN_READS      4UL     /* Same value read back to back: a polling loop */
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Weak vector table                                                                                       */
+/*---------------------------------------------------------------------------------------------------------*/
+#define HOSTSIM_WEAK __attribute__((weak))
+extern void SysTick_Handler(void) HOSTSIM_WEAK;
+extern void BOD_IRQHandler(void) HOSTSIM_WEAK;
+extern void WDT_IRQHandler(void) HOSTSIM_WEAK;
+extern void EINT024_IRQHandler(void) HOSTSIM_WEAK;
+extern void EINT135_IRQHandler(void) HOSTSIM_WEAK;
+extern void GPABGH_IRQHandler(void) HOSTSIM_WEAK;
+extern void GPCDEF_IRQHandler(void) HOSTSIM_WEAK;
+extern void PWM0_IRQHandler(void) HOSTSIM_WEAK;
+extern void PWM1_IRQHandler(void) HOSTSIM_WEAK;
+extern void TMR0_IRQHandler(void) HOSTSIM_WEAK;
+extern void TMR1_IRQHandler(void) HOSTSIM_WEAK;
+extern void TMR2_IRQHandler(void) HOSTSIM_WEAK;
+extern void TMR3_IRQHandler(void) HOSTSIM_WEAK;
+extern void UART02_IRQHandler(void) HOSTSIM_WEAK;
+extern void UART13_IRQHandler(void) HOSTSIM_WEAK;
+extern void SPI0_IRQHandler(void) HOSTSIM_WEAK;
+extern void QSPI0_IRQHandler(void) HOSTSIM_WEAK;
+extern void ISP_IRQHandler(void) HOSTSIM_WEAK;
+extern void UART57_IRQHandler(void) HOSTSIM_WEAK;
+extern void I2C0_IRQHandler(void) HOSTSIM_WEAK;
+extern void I2C1_IRQHandler(void) HOSTSIM_WEAK;
+extern void BPWM0_IRQHandler(void) HOSTSIM_WEAK;
+extern void BPWM1_IRQHandler(void) HOSTSIM_WEAK;
+extern void USCI01_IRQHandler(void) HOSTSIM_WEAK;
+extern void USBD_IRQHandler(void) HOSTSIM_WEAK;
+extern void ACMP01_IRQHandler(void) HOSTSIM_WEAK;
+extern void PDMA_IRQHandler(void) HOSTSIM_WEAK;
+extern void UART46_IRQHandler(void) HOSTSIM_WEAK;
+extern void PWRWU_IRQHandler(void) HOSTSIM_WEAK;
+extern void ADC_IRQHandler(void) HOSTSIM_WEAK;
+extern void CKFAIL_IRQHandler(void) HOSTSIM_WEAK;
+extern void RTC_IRQHandler(void) HOSTSIM_WEAK;
+
+static void (*const s_apfnIrqHandler[32])(void) =
+{
+    BOD_IRQHandler,     WDT_IRQHandler,     EINT024_IRQHandler, EINT135_IRQHandler,
+    GPABGH_IRQHandler,  GPCDEF_IRQHandler,  PWM0_IRQHandler,    PWM1_IRQHandler,
+    TMR0_IRQHandler,    TMR1_IRQHandler,    TMR2_IRQHandler,    TMR3_IRQHandler,
+    UART02_IRQHandler,  UART13_IRQHandler,  SPI0_IRQHandler,    QSPI0_IRQHandler,
+    ISP_IRQHandler,     UART57_IRQHandler,  I2C0_IRQHandler,    I2C1_IRQHandler,
+    BPWM0_IRQHandler,   BPWM1_IRQHandler,   USCI01_IRQHandler,  USBD_IRQHandler,
+    NULL,               ACMP01_IRQHandler,  PDMA_IRQHandler,    UART46_IRQHandler,
+    PWRWU_IRQHandler,   ADC_IRQHandler,     CKFAIL_IRQHandler,  RTC_IRQHandler
+};
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Address regions                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32Base;
+    uint32_t u32Size;
+    uint8_t *pu8Alias;
+} HOSTSIM_REGION_T;
+
+static HOSTSIM_REGION_T s_asRegion[] =
+{
+    { HOSTSIM_CORE_BASE, HOSTSIM_PAGE_SIZE, NULL },
+    { AHB_BASE,          0x00100000UL,      NULL },
+    { SCS_BASE,          HOSTSIM_PAGE_SIZE, NULL },
+};
+
+#define HOSTSIM_REGION_NUM  (sizeof(s_asRegion) / sizeof(s_asRegion[0]))
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Simulator state                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t  u32Active;
+    uint32_t  u32Write;
+    uint32_t  u32Addr;
+    uint32_t  u32Old;
+    uint32_t  u32PageCnt;
+    uintptr_t auPage[HOSTSIM_STEP_PAGES];
+} HOSTSIM_STEP_T;
+
+static int32_t s_i32MemFd = -1;
+static uint32_t s_u32Hclk = __HIRC;
+static uint32_t s_u32AccessCycles = HOSTSIM_ACCESS_CYCLES;
+static uint64_t s_u64Now = 0ULL;
+static uint64_t s_u64StallEnd = 0ULL;
+static uint32_t s_u32SpinAddr = 0UL, s_u32SpinVal = 0UL, s_u32SpinCnt = 0UL;
+static uint64_t s_u64StatBase = 0ULL;
+static HOSTSIM_STAT_T s_sStat;
+static HOSTSIM_STEP_T s_sStep;
+static volatile uint32_t s_u32Primask = 0UL;
+static volatile uint32_t s_u32InHandler = 0UL;
+static struct sigaction s_sOldSegv, s_sOldTrap;
+
+/* NVIC / SysTick state */
+static uint32_t s_u32NvicEnable = 0UL;
+static uint32_t s_u32NvicPend = 0UL;
+static uint32_t s_u32SysTickPend = 0UL;
+static uint32_t s_u32SysTickFlagRead = 0UL;
+static uint64_t s_u64SysTickWrap = HOSTSIM_NEVER;
+
+/* SYS register lock sequence */
+static uint32_t s_u32UnlockSeq = 0UL;
+
+static void HostSim_CoreWrite(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New);
+static void HostSim_CoreRead(uint32_t u32Inst, uint32_t u32Offset);
+static void HostSim_ScsReset(uint32_t u32Inst);
+static void HostSim_ScsRead(uint32_t u32Inst, uint32_t u32Offset);
+static void HostSim_ScsWrite(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New);
+static void HostSim_ScsSync(uint32_t u32Inst, uint64_t u64Now);
+static uint64_t HostSim_ScsNextEvent(uint32_t u32Inst);
+static void HostSim_SysReset(uint32_t u32Inst);
+static void HostSim_SysRead(uint32_t u32Inst, uint32_t u32Offset);
+static void HostSim_SysWrite(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New);
+
+static const HOSTSIM_MODEL_T s_sCoreModel =
+{
+    "CORE", HOSTSIM_CORE_BASE, HOSTSIM_PAGE_SIZE, HOSTSIM_NO_IRQ, 0UL,
+    NULL, HostSim_CoreRead, HostSim_CoreWrite, NULL, NULL, NULL, NULL
+};
+
+static const HOSTSIM_MODEL_T s_sScsModel =
+{
+    "SCS", SCS_BASE, HOSTSIM_PAGE_SIZE, HOSTSIM_NO_IRQ, 0UL,
+    HostSim_ScsReset, HostSim_ScsRead, HostSim_ScsWrite, HostSim_ScsSync, HostSim_ScsNextEvent, NULL, NULL
+};
+
+static const HOSTSIM_MODEL_T s_sSysModel =
+{
+    "SYS", SYS_BASE, 0x400UL, HOSTSIM_NO_IRQ, 0UL,
+    HostSim_SysReset, HostSim_SysRead, HostSim_SysWrite, NULL, NULL, NULL, NULL
+};
+
+static const HOSTSIM_MODEL_T *const s_apsModel[] =
+{
+    &s_sCoreModel,
+    &s_sScsModel,
+    &s_sSysModel,
+    &g_asHostSimUartModel[0],
+    &g_asHostSimUartModel[1],
+    &g_asHostSimUartModel[2],
+    &g_sHostSimSpiModel,
+    &g_sHostSimUspiModel,
+    &g_sHostSimPdmaModel,
+    &g_sHostSimFmcModel,
+    &g_sHostSimCrcModel,
+    &g_sHostSimUsbdModel,
+    &g_asHostSimTimerModel[0],
+    &g_asHostSimTimerModel[1],
+    &g_asHostSimTimerModel[2],
+    &g_asHostSimTimerModel[3],
+    &g_sHostSimAdcModel,
+};
+
+#define HOSTSIM_MODEL_NUM   (sizeof(s_apsModel) / sizeof(s_apsModel[0]))
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Lookup helpers                                                                                          */
+/*---------------------------------------------------------------------------------------------------------*/
+static HOSTSIM_REGION_T *HostSim_FindRegion(uintptr_t uAddr)
+{
+    uint32_t i;
+
+    for(i = 0UL; i < HOSTSIM_REGION_NUM; i++)
+    {
+        if((uAddr >= s_asRegion[i].u32Base) && (uAddr < ((uintptr_t)s_asRegion[i].u32Base + s_asRegion[i].u32Size)))
+        {
+            return &s_asRegion[i];
+        }
+    }
+    return NULL;
+}
+
+static const HOSTSIM_MODEL_T *HostSim_FindModel(uint32_t u32Addr)
+{
+    uint32_t i;
+
+    for(i = 0UL; i < HOSTSIM_MODEL_NUM; i++)
+    {
+        if((u32Addr >= s_apsModel[i]->u32Base) && (u32Addr < (s_apsModel[i]->u32Base + s_apsModel[i]->u32Size)))
+        {
+            return s_apsModel[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief       Get model view of a simulated address
+ *
+ * @param[in]   u32Addr     Device address inside a simulated region
+ *
+ * @return      Read/write pointer that does not trap, or NULL if the address is not simulated
+ */
+void *HostSim_Alias(uint32_t u32Addr)
+{
+    HOSTSIM_REGION_T *psRegion = HostSim_FindRegion(u32Addr);
+
+    if((psRegion == NULL) || (psRegion->pu8Alias == NULL))
+    {
+        return NULL;
+    }
+    return psRegion->pu8Alias + (u32Addr - psRegion->u32Base);
+}
+
+static uint32_t *HostSim_AliasWord(uint32_t u32Addr)
+{
+    return (uint32_t *)HostSim_Alias(u32Addr & ~3UL);
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Scheduler                                                                                               */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint64_t HostSim_NextEvent(void)
+{
+    uint64_t u64Next = HOSTSIM_NEVER, u64Evt;
+    uint32_t i;
+
+    for(i = 0UL; i < HOSTSIM_MODEL_NUM; i++)
+    {
+        if(s_apsModel[i]->pfnNextEvent != NULL)
+        {
+            u64Evt = s_apsModel[i]->pfnNextEvent(s_apsModel[i]->u32Inst);
+            if(u64Evt < u64Next)
+            {
+                u64Next = u64Evt;
+            }
+        }
+    }
+    return u64Next;
+}
+
+static void HostSim_SyncAll(void)
+{
+    uint32_t i;
+
+    for(i = 0UL; i < HOSTSIM_MODEL_NUM; i++)
+    {
+        if(s_apsModel[i]->pfnSync != NULL)
+        {
+            s_apsModel[i]->pfnSync(s_apsModel[i]->u32Inst, s_u64Now);
+        }
+    }
+}
+
+static void HostSim_RunTo(uint64_t u64Target)
+{
+    uint64_t u64Next;
+
+    while(1)
+    {
+        u64Next = HostSim_NextEvent();
+        if(u64Next > u64Target)
+        {
+            break;
+        }
+        if(u64Next > s_u64Now)
+        {
+            s_u64Now = u64Next;
+        }
+        HostSim_SyncAll();
+
+        /* A model that is still due after syncing needs the clock to move on */
+        if(HostSim_NextEvent() <= s_u64Now)
+        {
+            if(s_u64Now >= u64Target)
+            {
+                break;
+            }
+            s_u64Now++;
+        }
+    }
+
+    if(u64Target > s_u64Now)
+    {
+        s_u64Now = u64Target;
+    }
+    HostSim_SyncAll();
+}
+
+/**
+ * @brief       Get current simulated cycle
+ *
+ * @return      Absolute HCLK cycle count
+ */
+uint64_t HostSim_Now(void)
+{
+    return s_u64Now;
+}
+
+/**
+ * @brief       Stall the CPU after the current access
+ *
+ * @param[in]   u64Until    Absolute HCLK cycle the CPU resumes at
+ *
+ * @details     Models keep running while the CPU waits, e.g. for instruction fetch from a busy flash.
+ */
+void HostSim_StallCpu(uint64_t u64Until)
+{
+    if(u64Until > s_u64StallEnd)
+    {
+        s_u64StallEnd = u64Until;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Interrupt dispatch                                                                                      */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint32_t HostSim_IrqLevels(void)
+{
+    uint32_t i, u32Level = 0UL;
+    const HOSTSIM_MODEL_T *psModel;
+
+    for(i = 0UL; i < HOSTSIM_MODEL_NUM; i++)
+    {
+        psModel = s_apsModel[i];
+        if((psModel->pfnIrqLevel != NULL) && (psModel->i32IRQn >= 0))
+        {
+            if(psModel->pfnIrqLevel(psModel->u32Inst))
+            {
+                u32Level |= (1UL << psModel->i32IRQn);
+            }
+        }
+    }
+    return u32Level;
+}
+
+static uint32_t HostSim_IrqPriority(int32_t i32IRQn)
+{
+    NVIC_Type *psNvic = (NVIC_Type *)HostSim_Alias(NVIC_BASE);
+    SCB_Type *psScb = (SCB_Type *)HostSim_Alias(SCB_BASE);
+
+    if(i32IRQn < 0)
+    {
+        return (psScb->SHP[_SHP_IDX(i32IRQn)] >> _BIT_SHIFT(i32IRQn)) & 0xC0UL;
+    }
+    return (psNvic->IP[_IP_IDX(i32IRQn)] >> _BIT_SHIFT(i32IRQn)) & 0xC0UL;
+}
+
+static int32_t HostSim_NextIrq(void)
+{
+    uint32_t u32Pend, u32Prio, u32Best = 0x100UL;
+    int32_t i32IRQn, i32Sel = HOSTSIM_NO_IRQ;
+
+    if(s_u32SysTickPend)
+    {
+        i32Sel = SysTick_IRQn;
+        u32Best = HostSim_IrqPriority(SysTick_IRQn);
+    }
+
+    u32Pend = (s_u32NvicPend | HostSim_IrqLevels()) & s_u32NvicEnable;
+    for(i32IRQn = 0; i32IRQn < 32; i32IRQn++)
+    {
+        if(u32Pend & (1UL << i32IRQn))
+        {
+            u32Prio = HostSim_IrqPriority(i32IRQn);
+            if(u32Prio < u32Best)
+            {
+                u32Best = u32Prio;
+                i32Sel = i32IRQn;
+            }
+        }
+    }
+    return i32Sel;
+}
+
+/**
+ * @brief       Dispatch pending interrupts
+ *
+ * @return      None
+ *
+ * @details     Runs enabled, pending handlers in priority order while PRIMASK is clear.
+ *              Handlers are not nested; a handler that leaves its source asserted is re-entered.
+ */
+void HostSim_Service(void)
+{
+    int32_t i32IRQn;
+    void (*pfnHandler)(void);
+
+    if(s_u32InHandler || s_u32Primask)
+    {
+        return;
+    }
+
+    s_u32InHandler = 1UL;
+    while(!s_u32Primask && ((i32IRQn = HostSim_NextIrq()) != HOSTSIM_NO_IRQ))
+    {
+        if(i32IRQn == SysTick_IRQn)
+        {
+            s_u32SysTickPend = 0UL;
+            s_sStat.u32SysTickCnt++;
+            pfnHandler = SysTick_Handler;
+        }
+        else
+        {
+            s_u32NvicPend &= ~(1UL << i32IRQn);
+            s_sStat.au32IrqCnt[i32IRQn]++;
+            pfnHandler = s_apfnIrqHandler[i32IRQn];
+        }
+
+        if(pfnHandler == NULL)
+        {
+            fprintf(stderr, "[HostSim] IRQ %d enabled without a handler\n", (int)i32IRQn);
+            abort();
+        }
+        pfnHandler();
+    }
+    s_u32InHandler = 0UL;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Bus access used by the PDMA model                                                                       */
+/*---------------------------------------------------------------------------------------------------------*/
+static void *HostSim_HostPtr(uint32_t u32Addr)
+{
+    if(u32Addr < 0x10000UL)
+    {
+        fprintf(stderr, "[HostSim] bus access to unmapped address 0x%08X\n", (unsigned)u32Addr);
+        abort();
+    }
+    return (void *)(uintptr_t)u32Addr;
+}
+
+/**
+ * @brief       Read from the simulated bus
+ *
+ * @param[in]   u32Addr     Device or host (below 4 GB) address
+ * @param[in]   u32Width    Access width in bytes (1, 2 or 4)
+ *
+ * @return      Data read
+ */
+uint32_t HostSim_BusRead(uint32_t u32Addr, uint32_t u32Width)
+{
+    const HOSTSIM_MODEL_T *psModel;
+    uint8_t *pu8;
+
+    if(HostSim_FindRegion(u32Addr) != NULL)
+    {
+        psModel = HostSim_FindModel(u32Addr);
+        if((psModel != NULL) && (psModel->pfnRead != NULL))
+        {
+            psModel->pfnRead(psModel->u32Inst, (u32Addr & ~3UL) - psModel->u32Base);
+        }
+        pu8 = (uint8_t *)HostSim_Alias(u32Addr);
+    }
+    else
+    {
+        pu8 = (uint8_t *)HostSim_HostPtr(u32Addr);
+    }
+
+    if(u32Width == 1UL)
+    {
+        return *pu8;
+    }
+    else if(u32Width == 2UL)
+    {
+        return *(uint16_t *)pu8;
+    }
+    return *(uint32_t *)pu8;
+}
+
+/**
+ * @brief       Write to the simulated bus
+ *
+ * @param[in]   u32Addr     Device or host (below 4 GB) address
+ * @param[in]   u32Data     Data to write
+ * @param[in]   u32Width    Access width in bytes (1, 2 or 4)
+ *
+ * @return      None
+ */
+void HostSim_BusWrite(uint32_t u32Addr, uint32_t u32Data, uint32_t u32Width)
+{
+    const HOSTSIM_MODEL_T *psModel = NULL;
+    uint32_t u32Old = 0UL;
+    uint8_t *pu8;
+
+    if(HostSim_FindRegion(u32Addr) != NULL)
+    {
+        psModel = HostSim_FindModel(u32Addr);
+        u32Old = *HostSim_AliasWord(u32Addr);
+        pu8 = (uint8_t *)HostSim_Alias(u32Addr);
+    }
+    else
+    {
+        pu8 = (uint8_t *)HostSim_HostPtr(u32Addr);
+    }
+
+    if(u32Width == 1UL)
+    {
+        *pu8 = (uint8_t)u32Data;
+    }
+    else if(u32Width == 2UL)
+    {
+        *(uint16_t *)pu8 = (uint16_t)u32Data;
+    }
+    else
+    {
+        *(uint32_t *)pu8 = u32Data;
+    }
+
+    if((psModel != NULL) && (psModel->pfnWrite != NULL))
+    {
+        psModel->pfnWrite(psModel->u32Inst, (u32Addr & ~3UL) - psModel->u32Base, u32Old, *HostSim_AliasWord(u32Addr));
+    }
+}
+
+/**
+ * @brief       Query a PDMA request line
+ *
+ * @param[in]   u32ReqSel   Request source, PDMA_UART0_TX ~ PDMA_UART7_RX
+ *
+ * @retval      0 Request inactive
+ * @retval      1 Request active
+ */
+uint32_t HostSim_DmaRequest(uint32_t u32ReqSel)
+{
+    uint32_t i;
+
+    for(i = 0UL; i < HOSTSIM_MODEL_NUM; i++)
+    {
+        if(s_apsModel[i]->pfnDmaRequest != NULL)
+        {
+            if(s_apsModel[i]->pfnDmaRequest(s_apsModel[i]->u32Inst, u32ReqSel))
+            {
+                return 1UL;
+            }
+        }
+    }
+    return 0UL;
+}
+
+/**
+ * @brief       Count one item moved by the PDMA model
+ *
+ * @return      None
+ */
+void HostSim_CountDmaBeat(void)
+{
+    s_sStat.u64DmaBeat++;
+}
+
+/**
+ * @brief       Get APB clock frequency
+ *
+ * @param[in]   u32Apb      APB bus index (0 or 1)
+ *
+ * @return      PCLK frequency in Hz derived from CLK->PCLKDIV
+ */
+uint32_t HostSim_GetPclkFreq(uint32_t u32Apb)
+{
+    CLK_T *psClk = (CLK_T *)HostSim_Alias(CLK_BASE);
+    uint32_t u32Div;
+
+    if(u32Apb == 0UL)
+    {
+        u32Div = (psClk->PCLKDIV & CLK_PCLKDIV_APB0DIV_Msk) >> CLK_PCLKDIV_APB0DIV_Pos;
+    }
+    else
+    {
+        u32Div = (psClk->PCLKDIV & CLK_PCLKDIV_APB1DIV_Msk) >> CLK_PCLKDIV_APB1DIV_Pos;
+    }
+    return s_u32Hclk >> u32Div;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Core page: PRIMASK, CONTROL and WFI                                                                     */
+/*---------------------------------------------------------------------------------------------------------*/
+static void HostSim_CoreRead(uint32_t u32Inst, uint32_t u32Offset)
+{
+    uint64_t u64Next;
+
+    (void)u32Inst;
+    if(u32Offset == (HOSTSIM_CORE_WFI - HOSTSIM_CORE_BASE))
+    {
+        /* Sleep until the next model event unless an interrupt is already pending */
+        if(HostSim_NextIrq() == HOSTSIM_NO_IRQ)
+        {
+            u64Next = HostSim_NextEvent();
+            if((u64Next != HOSTSIM_NEVER) && (u64Next > s_u64Now))
+            {
+                HostSim_RunTo(u64Next);
+            }
+        }
+    }
+}
+
+static void HostSim_CoreWrite(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    (void)u32Inst;
+    (void)u32Old;
+    if(u32Offset == (HOSTSIM_CORE_PRIMASK - HOSTSIM_CORE_BASE))
+    {
+        s_u32Primask = u32New & 1UL;
+        *HostSim_AliasWord(HOSTSIM_CORE_PRIMASK) = s_u32Primask;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* System Control Space: SysTick, NVIC and SCB                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+static void (*s_pfnResetHook)(void) = NULL;
+
+static void HostSim_SystemReset(void)
+{
+    if(s_pfnResetHook != NULL)
+    {
+        s_pfnResetHook();
+    }
+    else
+    {
+        printf("[HostSim] system reset requested at cycle %llu\n", (unsigned long long)s_u64Now);
+        exit(0);
+    }
+}
+
+/**
+ * @brief       Install system reset hook
+ *
+ * @param[in]   pfnHook     Called on SYSRESETREQ or CHIPRST instead of exiting the process
+ *
+ * @return      None
+ */
+void HostSim_SetResetHook(void (*pfnHook)(void))
+{
+    s_pfnResetHook = pfnHook;
+}
+
+static uint32_t HostSim_SysTickScale(void)
+{
+    SysTick_Type *psTick = (SysTick_Type *)HostSim_Alias(SysTick_BASE);
+
+    /* The external reference is modelled as HCLK/2 */
+    return (psTick->CTRL & SysTick_CTRL_CLKSOURCE_Msk) ? 1UL : 2UL;
+}
+
+static void HostSim_ScsReset(uint32_t u32Inst)
+{
+    SCB_Type *psScb = (SCB_Type *)HostSim_Alias(SCB_BASE);
+
+    (void)u32Inst;
+    memset(HostSim_Alias(SCS_BASE), 0, HOSTSIM_PAGE_SIZE);
+    HOSTSIM_SET(psScb->CPUID, 0x410CC200UL);
+    s_u32NvicEnable = 0UL;
+    s_u32NvicPend = 0UL;
+    s_u32SysTickPend = 0UL;
+    s_u32SysTickFlagRead = 0UL;
+    s_u64SysTickWrap = HOSTSIM_NEVER;
+}
+
+static void HostSim_ScsSync(uint32_t u32Inst, uint64_t u64Now)
+{
+    SysTick_Type *psTick = (SysTick_Type *)HostSim_Alias(SysTick_BASE);
+    uint64_t u64Period;
+
+    (void)u32Inst;
+    if(s_u32SysTickFlagRead)
+    {
+        psTick->CTRL &= ~SysTick_CTRL_COUNTFLAG_Msk;
+        s_u32SysTickFlagRead = 0UL;
+    }
+
+    u64Period = (uint64_t)((psTick->LOAD & SysTick_LOAD_RELOAD_Msk) + 1UL) * HostSim_SysTickScale();
+    while(s_u64SysTickWrap <= u64Now)
+    {
+        psTick->CTRL |= SysTick_CTRL_COUNTFLAG_Msk;
+        if(psTick->CTRL & SysTick_CTRL_TICKINT_Msk)
+        {
+            s_u32SysTickPend = 1UL;
+        }
+        if((psTick->LOAD == 0UL) || !(psTick->CTRL & SysTick_CTRL_ENABLE_Msk))
+        {
+            s_u64SysTickWrap = HOSTSIM_NEVER;
+        }
+        else
+        {
+            s_u64SysTickWrap += u64Period;
+        }
+    }
+}
+
+static uint64_t HostSim_ScsNextEvent(uint32_t u32Inst)
+{
+    (void)u32Inst;
+    return s_u64SysTickWrap;
+}
+
+static void HostSim_ScsRead(uint32_t u32Inst, uint32_t u32Offset)
+{
+    SysTick_Type *psTick = (SysTick_Type *)HostSim_Alias(SysTick_BASE);
+    NVIC_Type *psNvic = (NVIC_Type *)HostSim_Alias(NVIC_BASE);
+    uint32_t u32Addr = SCS_BASE + u32Offset;
+
+    HostSim_ScsSync(u32Inst, s_u64Now);
+
+    if(u32Addr == (uint32_t)(uintptr_t)&SysTick->VAL)
+    {
+        if(s_u64SysTickWrap == HOSTSIM_NEVER)
+        {
+            psTick->VAL = 0UL;
+        }
+        else
+        {
+            psTick->VAL = (uint32_t)((s_u64SysTickWrap - s_u64Now) / HostSim_SysTickScale());
+        }
+    }
+    else if(u32Addr == (uint32_t)(uintptr_t)&SysTick->CTRL)
+    {
+        /* COUNTFLAG reads as one once; it is cleared on the next sync */
+        s_u32SysTickFlagRead = (psTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) ? 1UL : 0UL;
+    }
+    else if((u32Addr == (uint32_t)(uintptr_t)&NVIC->ISER[0]) || (u32Addr == (uint32_t)(uintptr_t)&NVIC->ICER[0]))
+    {
+        psNvic->ISER[0] = s_u32NvicEnable;
+        psNvic->ICER[0] = s_u32NvicEnable;
+    }
+    else if((u32Addr == (uint32_t)(uintptr_t)&NVIC->ISPR[0]) || (u32Addr == (uint32_t)(uintptr_t)&NVIC->ICPR[0]))
+    {
+        psNvic->ISPR[0] = s_u32NvicPend | HostSim_IrqLevels();
+        psNvic->ICPR[0] = psNvic->ISPR[0];
+    }
+}
+
+static void HostSim_ScsWrite(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    SysTick_Type *psTick = (SysTick_Type *)HostSim_Alias(SysTick_BASE);
+    NVIC_Type *psNvic = (NVIC_Type *)HostSim_Alias(NVIC_BASE);
+    uint32_t u32Addr = SCS_BASE + u32Offset;
+
+    (void)u32Inst;
+    if(u32Addr == (uint32_t)(uintptr_t)&SysTick->CTRL)
+    {
+        psTick->CTRL = (u32New & ~SysTick_CTRL_COUNTFLAG_Msk) | (u32Old & SysTick_CTRL_COUNTFLAG_Msk);
+        if((u32New & SysTick_CTRL_ENABLE_Msk) && !(u32Old & SysTick_CTRL_ENABLE_Msk))
+        {
+            /* Counting starts from the current value; zero reloads on the next tick */
+            s_u64SysTickWrap = s_u64Now + (uint64_t)(psTick->VAL ? psTick->VAL : ((psTick->LOAD & SysTick_LOAD_RELOAD_Msk) + 1UL)) * HostSim_SysTickScale();
+        }
+        else if(!(u32New & SysTick_CTRL_ENABLE_Msk))
+        {
+            s_u64SysTickWrap = HOSTSIM_NEVER;
+        }
+    }
+    else if(u32Addr == (uint32_t)(uintptr_t)&SysTick->VAL)
+    {
+        /* Any write clears the counter and COUNTFLAG */
+        psTick->VAL = 0UL;
+        psTick->CTRL &= ~SysTick_CTRL_COUNTFLAG_Msk;
+        if(psTick->CTRL & SysTick_CTRL_ENABLE_Msk)
+        {
+            s_u64SysTickWrap = s_u64Now + (uint64_t)((psTick->LOAD & SysTick_LOAD_RELOAD_Msk) + 1UL) * HostSim_SysTickScale();
+        }
+    }
+    else if(u32Addr == (uint32_t)(uintptr_t)&NVIC->ISER[0])
+    {
+        s_u32NvicEnable |= u32New;
+        psNvic->ISER[0] = s_u32NvicEnable;
+    }
+    else if(u32Addr == (uint32_t)(uintptr_t)&NVIC->ICER[0])
+    {
+        s_u32NvicEnable &= ~u32New;
+        psNvic->ICER[0] = s_u32NvicEnable;
+    }
+    else if(u32Addr == (uint32_t)(uintptr_t)&NVIC->ISPR[0])
+    {
+        s_u32NvicPend |= u32New;
+    }
+    else if(u32Addr == (uint32_t)(uintptr_t)&NVIC->ICPR[0])
+    {
+        s_u32NvicPend &= ~u32New;
+    }
+    else if(u32Addr == (uint32_t)(uintptr_t)&SCB->ICSR)
+    {
+        if(u32New & SCB_ICSR_PENDSTSET_Msk)
+        {
+            s_u32SysTickPend = 1UL;
+        }
+        if(u32New & SCB_ICSR_PENDSTCLR_Msk)
+        {
+            s_u32SysTickPend = 0UL;
+        }
+        *HostSim_AliasWord(u32Addr) = 0UL;
+    }
+    else if(u32Addr == (uint32_t)(uintptr_t)&SCB->AIRCR)
+    {
+        if(((u32New >> 16) == 0x05FAUL) && (u32New & SCB_AIRCR_SYSRESETREQ_Msk))
+        {
+            HostSim_SystemReset();
+        }
+        *HostSim_AliasWord(u32Addr) = 0UL;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* SYS / CLK                                                                                               */
+/*---------------------------------------------------------------------------------------------------------*/
+static void HostSim_SysReset(uint32_t u32Inst)
+{
+    CLK_T *psClk = (CLK_T *)HostSim_Alias(CLK_BASE);
+
+    (void)u32Inst;
+    memset(HostSim_Alias(SYS_BASE), 0, 0x400UL);
+    psClk->PWRCTL  = CLK_PWRCTL_HIRCEN_Msk;
+    psClk->CLKSEL0 = (7UL << CLK_CLKSEL0_HCLKSEL_Pos);
+    psClk->CLKSEL1 = (3UL << CLK_CLKSEL1_UART0SEL_Pos) | (3UL << CLK_CLKSEL1_UART1SEL_Pos);
+    psClk->CLKSEL2 = (2UL << CLK_CLKSEL2_SPI0SEL_Pos);
+    psClk->CLKSEL3 = (3UL << CLK_CLKSEL3_UART2SEL_Pos);
+    s_u32UnlockSeq = 0UL;
+}
+
+static void HostSim_SysRead(uint32_t u32Inst, uint32_t u32Offset)
+{
+    (void)u32Inst;
+    if(u32Offset == ((uint32_t)(uintptr_t)&SYS->REGLCTL - SYS_BASE))
+    {
+        *HostSim_AliasWord(SYS_BASE + u32Offset) = (s_u32UnlockSeq == 3UL) ? 1UL : 0UL;
+    }
+    else if(u32Offset == ((uint32_t)(uintptr_t)&CLK->STATUS - SYS_BASE))
+    {
+        /* All clock sources report stable */
+        *HostSim_AliasWord(SYS_BASE + u32Offset) = CLK_STATUS_HXTSTB_Msk | CLK_STATUS_LXTSTB_Msk | CLK_STATUS_PLLSTB_Msk |
+                CLK_STATUS_LIRCSTB_Msk | CLK_STATUS_HIRCSTB_Msk;
+    }
+}
+
+static void HostSim_ResetModels(uint32_t u32Base)
+{
+    const HOSTSIM_MODEL_T *psModel = HostSim_FindModel(u32Base);
+
+    if((psModel != NULL) && (psModel->pfnReset != NULL))
+    {
+        psModel->pfnReset(psModel->u32Inst);
+    }
+}
+
+static void HostSim_SysWrite(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    uint32_t u32Set = u32New & ~u32Old;
+
+    (void)u32Inst;
+    if(u32Offset == ((uint32_t)(uintptr_t)&SYS->REGLCTL - SYS_BASE))
+    {
+        if((u32New == 0x59UL) && (s_u32UnlockSeq != 3UL))
+        {
+            s_u32UnlockSeq = 1UL;
+        }
+        else if((u32New == 0x16UL) && (s_u32UnlockSeq == 1UL))
+        {
+            s_u32UnlockSeq = 2UL;
+        }
+        else if((u32New == 0x88UL) && (s_u32UnlockSeq == 2UL))
+        {
+            s_u32UnlockSeq = 3UL;
+        }
+        else if(s_u32UnlockSeq != 3UL || u32New == 0UL)
+        {
+            s_u32UnlockSeq = 0UL;
+        }
+    }
+    else if(u32Offset == ((uint32_t)(uintptr_t)&SYS->IPRST0 - SYS_BASE))
+    {
+        if(u32Set & SYS_IPRST0_CHIPRST_Msk)
+        {
+            HostSim_SystemReset();
+        }
+        if(u32Set & SYS_IPRST0_PDMARST_Msk)
+        {
+            HostSim_ResetModels(PDMA_BASE);
+        }
+        if(u32Set & SYS_IPRST0_CRCRST_Msk)
+        {
+            HostSim_ResetModels(CRC_BASE);
+        }
+    }
+    else if(u32Offset == ((uint32_t)(uintptr_t)&SYS->IPRST1 - SYS_BASE))
+    {
+        if(u32Set & SYS_IPRST1_TMR0RST_Msk)
+        {
+            HostSim_ResetModels(TIMER0_BASE);
+        }
+        if(u32Set & SYS_IPRST1_TMR1RST_Msk)
+        {
+            HostSim_ResetModels(TIMER1_BASE);
+        }
+        if(u32Set & SYS_IPRST1_TMR2RST_Msk)
+        {
+            HostSim_ResetModels(TIMER2_BASE);
+        }
+        if(u32Set & SYS_IPRST1_TMR3RST_Msk)
+        {
+            HostSim_ResetModels(TIMER3_BASE);
+        }
+        if(u32Set & SYS_IPRST1_UART0RST_Msk)
+        {
+            HostSim_ResetModels(UART0_BASE);
+        }
+        if(u32Set & SYS_IPRST1_UART1RST_Msk)
+        {
+            HostSim_ResetModels(UART1_BASE);
+        }
+        if(u32Set & SYS_IPRST1_UART2RST_Msk)
+        {
+            HostSim_ResetModels(UART2_BASE);
+        }
+        if(u32Set & SYS_IPRST1_SPI0RST_Msk)
+        {
+            HostSim_ResetModels(SPI0_BASE);
+        }
+        if(u32Set & SYS_IPRST1_USBDRST_Msk)
+        {
+            HostSim_ResetModels(USBD_BASE);
+        }
+        if(u32Set & SYS_IPRST1_ADCRST_Msk)
+        {
+            HostSim_ResetModels(ADC_BASE);
+        }
+    }
+    else if(u32Offset == ((uint32_t)(uintptr_t)&SYS->IPRST2 - SYS_BASE))
+    {
+        if(u32Set & SYS_IPRST2_USCI0RST_Msk)
+        {
+            HostSim_ResetModels(USCI0_BASE);
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Trap engine                                                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+static void HostSim_OnSegv(int i32Sig, siginfo_t *psInfo, void *pvCtx)
+{
+    ucontext_t *psCtx = (ucontext_t *)pvCtx;
+    uintptr_t uAddr = (uintptr_t)psInfo->si_addr;
+    uintptr_t uPage = uAddr & ~(uintptr_t)(HOSTSIM_PAGE_SIZE - 1UL);
+    const HOSTSIM_MODEL_T *psModel;
+    uint64_t u64Next;
+
+    (void)i32Sig;
+    if((HostSim_FindRegion(uAddr) == NULL) || (s_sStep.u32PageCnt >= HOSTSIM_STEP_PAGES))
+    {
+        /* Not a simulated register: let the default action report the fault */
+        sigaction(SIGSEGV, &s_sOldSegv, NULL);
+        return;
+    }
+
+    if(!s_sStep.u32Active)
+    {
+        s_sStep.u32Active = 1UL;
+        s_sStep.u32Write = (psCtx->uc_mcontext.gregs[REG_ERR] & HOSTSIM_PF_WRITE) ? 1UL : 0UL;
+        s_sStep.u32Addr = (uint32_t)uAddr & ~3UL;
+        s_sStat.u64Access++;
+
+        HostSim_RunTo(s_u64Now + s_u32AccessCycles);
+
+        /* A register polled without change cannot change before the next model event */
+        if(!s_sStep.u32Write && (s_sStep.u32Addr == s_u32SpinAddr) && (s_u32SpinCnt >= HOSTSIM_SPIN_READS))
+        {
+            u64Next = HostSim_NextEvent();
+            if((u64Next != HOSTSIM_NEVER) && (u64Next > s_u64Now))
+            {
+                HostSim_RunTo(u64Next);
+            }
+        }
+
+        psModel = HostSim_FindModel(s_sStep.u32Addr);
+        if(!s_sStep.u32Write && (psModel != NULL) && (psModel->pfnRead != NULL))
+        {
+            psModel->pfnRead(psModel->u32Inst, s_sStep.u32Addr - psModel->u32Base);
+        }
+        s_sStep.u32Old = *HostSim_AliasWord(s_sStep.u32Addr);
+
+        if(s_sStep.u32Write)
+        {
+            s_u32SpinCnt = 0UL;
+        }
+        else if((s_sStep.u32Addr == s_u32SpinAddr) && (s_sStep.u32Old == s_u32SpinVal))
+        {
+            s_u32SpinCnt++;
+        }
+        else
+        {
+            s_u32SpinAddr = s_sStep.u32Addr;
+            s_u32SpinVal = s_sStep.u32Old;
+            s_u32SpinCnt = 1UL;
+        }
+        psCtx->uc_mcontext.gregs[REG_EFL] |= HOSTSIM_EFLAGS_TF;
+    }
+
+    mprotect((void *)uPage, HOSTSIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+    s_sStep.auPage[s_sStep.u32PageCnt++] = uPage;
+}
+
+static void HostSim_OnTrap(int i32Sig, siginfo_t *psInfo, void *pvCtx)
+{
+    ucontext_t *psCtx = (ucontext_t *)pvCtx;
+    const HOSTSIM_MODEL_T *psModel;
+    HOSTSIM_STEP_T sStep;
+    uint32_t i;
+
+    (void)i32Sig;
+    (void)psInfo;
+    if(!s_sStep.u32Active)
+    {
+        /* Breakpoint or debugger trap: restore the previous disposition */
+        sigaction(SIGTRAP, &s_sOldTrap, NULL);
+        raise(SIGTRAP);
+        return;
+    }
+
+    psCtx->uc_mcontext.gregs[REG_EFL] &= ~(greg_t)HOSTSIM_EFLAGS_TF;
+    for(i = 0UL; i < s_sStep.u32PageCnt; i++)
+    {
+        mprotect((void *)s_sStep.auPage[i], HOSTSIM_PAGE_SIZE, PROT_NONE);
+    }
+
+    sStep = s_sStep;
+    memset(&s_sStep, 0, sizeof(s_sStep));
+
+    if(sStep.u32Write)
+    {
+        psModel = HostSim_FindModel(sStep.u32Addr);
+        if((psModel != NULL) && (psModel->pfnWrite != NULL))
+        {
+            psModel->pfnWrite(psModel->u32Inst, sStep.u32Addr - psModel->u32Base, sStep.u32Old, *HostSim_AliasWord(sStep.u32Addr));
+        }
+    }
+
+    if(s_u64StallEnd > s_u64Now)
+    {
+        HostSim_RunTo(s_u64StallEnd);
+    }
+    s_u64StallEnd = 0ULL;
+
+    HostSim_Service();
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Public API                                                                                              */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/** @addtogroup HOSTSIM_EXPORTED_FUNCTIONS HostSim Exported Functions
+  @{
+*/
+
+/**
+ * @brief       Initialize the host simulator
+ *
+ * @param[in]   u32HclkFreq     Simulated HCLK in Hz. 0 selects __HIRC.
+ *
+ * @retval      0   Success
+ * @retval      -1  The device address map could not be reserved
+ *
+ * @details     Maps the simulated register regions at their device addresses and installs the
+ *              SIGSEGV/SIGTRAP handlers. The program must be linked non-PIE (-no-pie) so that
+ *              buffers handed to the PDMA model have 32-bit addresses; such buffers must be static.
+ */
+int32_t HostSim_Init(uint32_t u32HclkFreq)
+{
+    struct sigaction sAct;
+    uint32_t i, u32Off = 0UL, u32Total = 0UL;
+    void *pvTrap;
+
+    if(s_i32MemFd >= 0)
+    {
+        HostSim_Close();
+    }
+
+    for(i = 0UL; i < HOSTSIM_REGION_NUM; i++)
+    {
+        u32Total += s_asRegion[i].u32Size;
+    }
+
+    s_i32MemFd = memfd_create("hostsim", 0);
+    if((s_i32MemFd < 0) || (ftruncate(s_i32MemFd, (off_t)u32Total) != 0))
+    {
+        return -1;
+    }
+
+    for(i = 0UL; i < HOSTSIM_REGION_NUM; i++)
+    {
+        pvTrap = mmap((void *)(uintptr_t)s_asRegion[i].u32Base, s_asRegion[i].u32Size, PROT_NONE,
+                      MAP_SHARED | MAP_FIXED_NOREPLACE, s_i32MemFd, (off_t)u32Off);
+        if(pvTrap != (void *)(uintptr_t)s_asRegion[i].u32Base)
+        {
+            fprintf(stderr, "[HostSim] cannot map 0x%08X\n", (unsigned)s_asRegion[i].u32Base);
+            return -1;
+        }
+        s_asRegion[i].pu8Alias = (uint8_t *)mmap(NULL, s_asRegion[i].u32Size, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED, s_i32MemFd, (off_t)u32Off);
+        if(s_asRegion[i].pu8Alias == (uint8_t *)MAP_FAILED)
+        {
+            s_asRegion[i].pu8Alias = NULL;
+            return -1;
+        }
+        u32Off += s_asRegion[i].u32Size;
+    }
+
+    memset(&sAct, 0, sizeof(sAct));
+    sigemptyset(&sAct.sa_mask);
+    sAct.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sAct.sa_sigaction = HostSim_OnSegv;
+    sigaction(SIGSEGV, &sAct, &s_sOldSegv);
+    sAct.sa_sigaction = HostSim_OnTrap;
+    sigaction(SIGTRAP, &sAct, &s_sOldTrap);
+
+    s_u32Hclk = (u32HclkFreq != 0UL) ? u32HclkFreq : __HIRC;
+    s_u32AccessCycles = HOSTSIM_ACCESS_CYCLES;
+    s_u64Now = 0ULL;
+    s_u32Primask = 0UL;
+    s_u32InHandler = 0UL;
+    memset(&s_sStep, 0, sizeof(s_sStep));
+
+    for(i = 0UL; i < HOSTSIM_MODEL_NUM; i++)
+    {
+        if(s_apsModel[i]->pfnReset != NULL)
+        {
+            s_apsModel[i]->pfnReset(s_apsModel[i]->u32Inst);
+        }
+    }
+
+    HostSim_ClearStat();
+    return 0;
+}
+
+/**
+ * @brief       Release the simulated address map
+ *
+ * @return      None
+ */
+void HostSim_Close(void)
+{
+    uint32_t i;
+
+    for(i = 0UL; i < HOSTSIM_REGION_NUM; i++)
+    {
+        if(s_asRegion[i].pu8Alias != NULL)
+        {
+            munmap((void *)(uintptr_t)s_asRegion[i].u32Base, s_asRegion[i].u32Size);
+            munmap(s_asRegion[i].pu8Alias, s_asRegion[i].u32Size);
+            s_asRegion[i].pu8Alias = NULL;
+        }
+    }
+
+    if(s_i32MemFd >= 0)
+    {
+        sigaction(SIGSEGV, &s_sOldSegv, NULL);
+        sigaction(SIGTRAP, &s_sOldTrap, NULL);
+        close(s_i32MemFd);
+        s_i32MemFd = -1;
+    }
+}
+
+/**
+ * @brief       Get simulated HCLK frequency
+ *
+ * @return      HCLK in Hz
+ */
+uint32_t HostSim_GetHclkFreq(void)
+{
+    return s_u32Hclk;
+}
+
+/**
+ * @brief       Get simulated cycle counter
+ *
+ * @return      HCLK cycles since HostSim_Init()
+ */
+uint64_t HostSim_GetCycle(void)
+{
+    return s_u64Now;
+}
+
+/**
+ * @brief       Set cost of a CPU register access
+ *
+ * @param[in]   u32Cycles   HCLK cycles charged per trapped access (load/store plus loop overhead)
+ *
+ * @return      None
+ */
+void HostSim_SetAccessCycles(uint32_t u32Cycles)
+{
+    s_u32AccessCycles = u32Cycles;
+}
+
+/**
+ * @brief       Account CPU work that does not touch registers
+ *
+ * @param[in]   u32Cycles   HCLK cycles to advance
+ *
+ * @return      None
+ *
+ * @details     Peripheral models keep running and due interrupts are serviced during the delay.
+ */
+void HostSim_Delay(uint32_t u32Cycles)
+{
+    uint64_t u64End = s_u64Now + u32Cycles, u64Next;
+
+    do
+    {
+        u64Next = HostSim_NextEvent();
+        HostSim_RunTo((u64Next < u64End) ? u64Next : u64End);
+        HostSim_Service();
+    }
+    while(s_u64Now < u64End);
+}
+
+/**
+ * @brief       Run peripheral models until no event is scheduled
+ *
+ * @param[in]   u64MaxCycles    Upper bound of HCLK cycles to run
+ *
+ * @retval      0   All models idle
+ * @retval      -1  Still busy after u64MaxCycles
+ */
+int32_t HostSim_RunUntilIdle(uint64_t u64MaxCycles)
+{
+    uint64_t u64End = s_u64Now + u64MaxCycles, u64Next;
+
+    while(1)
+    {
+        HostSim_Service();
+        u64Next = HostSim_NextEvent();
+        if(u64Next == HOSTSIM_NEVER)
+        {
+            return 0;
+        }
+        if(u64Next > u64End)
+        {
+            HostSim_RunTo(u64End);
+            return -1;
+        }
+        HostSim_RunTo(u64Next);
+    }
+}
+
+/**
+ * @brief       Get simulator counters
+ *
+ * @param[out]  psStat      Counters since the last HostSim_ClearStat()
+ *
+ * @return      None
+ */
+void HostSim_GetStat(HOSTSIM_STAT_T *psStat)
+{
+    *psStat = s_sStat;
+    psStat->u64Cycle = s_u64Now - s_u64StatBase;
+}
+
+/**
+ * @brief       Clear simulator counters
+ *
+ * @return      None
+ */
+void HostSim_ClearStat(void)
+{
+    memset(&s_sStat, 0, sizeof(s_sStat));
+    s_u64StatBase = s_u64Now;
+}
+
+/**
+ * @brief       Get the level of a GPIO output pin
+ *
+ * @param[in]   u32Port     Port index, 0 for PA, 1 for PB, ...
+ * @param[in]   u32Pin      Pin number, 0 ~ 15
+ *
+ * @return      Last value written to the pin data register (Px_PDIO).
+ *
+ * @details     Safe to call from model callbacks such as a SPI slave model, which
+ *              run while a register access is being trapped.
+ */
+uint32_t HostSim_GpioGetPin(uint32_t u32Port, uint32_t u32Pin)
+{
+    return *HostSim_AliasWord((uint32_t)(uintptr_t)&GPIO_PIN_DATA(u32Port, u32Pin)) & 1UL;
+}
+
+/*@}*/ /* end of group HOSTSIM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,359 @@
+/**************************************************************************//**
+ * @file     hostsim_adc.c
+ * @version  V1.00
+ * @brief    ADC model of the M031 host simulator
+ *
+ * @note     Single, burst, single cycle scan and continuous scan modes started
+ *           by ADST, or with TRGEN set by the selected hardware trigger (only
+ *           the timer time-out trigger is wired); a trigger arriving while a
+ *           conversion runs is ignored. With CALEN set ADST runs a calibration
+ *           that completes at once. Each conversion takes 17 + EXTSMPT ADC clocks from the
+ *           CLK_CLKSEL2 ADCSEL source and CLKDIV0 ADCDIV divider. Results come
+ *           from a source callback installed with HostSim_AdcSetSource(), or a
+ *           12-bit ramp by default. With PTEN set the ADC_RX PDMA request stays
+ *           active until ADPDMA is read; a result not read in time is counted as
+ *           lost and flags OVERRUNF. Data register VALID/OVERRUN read-clear is
+ *           not modelled.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "hostsim_model.h"
+
+#define ADC_CH_NUM          30UL        /* ADDR[0] ~ ADDR[29] */
+#define ADC_CONV_CLKS       17UL        /* ADC clocks per conversion without extended sampling */
+
+typedef struct
+{
+    uint32_t u32Running;
+    uint32_t u32Ch;                     /* Channel being converted */
+    uint64_t u64Done;                   /* Cycle the current conversion finishes */
+    uint64_t u64Begin;                  /* Cycle ADST was set */
+    uint64_t u64ConvIdx;                /* Conversions since ADST, for drift-free timing */
+    uint32_t u32PdmaPend;               /* ADPDMA holds a result not yet read by PDMA */
+    uint32_t u32StsFlag;                /* Sticky ADSR0 flags */
+    uint32_t u32Seq;                    /* Ramp value of the default source */
+    uint64_t u64ConvCnt;
+    uint64_t u64LostCnt;
+    HOSTSIM_ADC_SOURCE_T pfnSource;
+} ADC_SIM_T;
+
+static ADC_SIM_T s_sAdc;
+
+static ADC_T *AdcSim_Regs(void)
+{
+    return (ADC_T *)HostSim_Alias(ADC_BASE);
+}
+
+/* Cycle the conversion u64Idx (counted from 0 at ADST) finishes */
+static uint64_t AdcSim_DoneTime(uint64_t u64Idx)
+{
+    CLK_T *psClk = (CLK_T *)HostSim_Alias(CLK_BASE);
+    uint32_t u32Src, u32Div;
+    uint64_t u64Cycles;
+
+    switch((psClk->CLKSEL2 & CLK_CLKSEL2_ADCSEL_Msk) >> CLK_CLKSEL2_ADCSEL_Pos)
+    {
+        case 0UL:
+            u32Src = __HXT;
+            break;
+        case 2UL:
+            u32Src = HostSim_GetPclkFreq(1UL);
+            break;
+        case 3UL:
+            u32Src = __HIRC;
+            break;
+        default:
+            u32Src = HostSim_GetHclkFreq();
+            break;
+    }
+    u32Div = ((psClk->CLKDIV0 & CLK_CLKDIV0_ADCDIV_Msk) >> CLK_CLKDIV0_ADCDIV_Pos) + 1UL;
+    u64Cycles = ((uint64_t)HostSim_GetHclkFreq() * u32Div * (u64Idx + 1ULL) *
+                 (ADC_CONV_CLKS + ((AdcSim_Regs()->ESMPCTL & ADC_ESMPCTL_EXTSMPT_Msk) >> ADC_ESMPCTL_EXTSMPT_Pos))) / u32Src;
+    return s_sAdc.u64Begin + ((u64Cycles <= u64Idx) ? (u64Idx + 1ULL) : u64Cycles);
+}
+
+/* Next enabled channel at or after u32From, or ADC_CH_NUM when none */
+static uint32_t AdcSim_NextCh(uint32_t u32From)
+{
+    uint32_t u32En = AdcSim_Regs()->ADCHER, i;
+
+    for(i = u32From; i < ADC_CH_NUM; i++)
+    {
+        if(u32En & (1UL << i))
+        {
+            return i;
+        }
+    }
+    return ADC_CH_NUM;
+}
+
+static void AdcSim_Refresh(void)
+{
+    ADC_T *adc = AdcSim_Regs();
+    uint32_t u32Sts = s_sAdc.u32StsFlag, i;
+
+    for(i = 0UL; i < ADC_CH_NUM; i++)
+    {
+        if(adc->ADDR[i] & ADC_ADDR_VALID_Msk)
+        {
+            u32Sts |= ADC_ADSR0_VALIDF_Msk;
+        }
+    }
+    if(s_sAdc.u32Running)
+    {
+        u32Sts |= ADC_ADSR0_BUSY_Msk;
+    }
+    u32Sts |= (s_sAdc.u32Ch & 0x1FUL) << ADC_ADSR0_CHANNEL_Pos;
+    adc->ADSR0 = u32Sts;
+}
+
+static void AdcSim_Start(uint64_t u64Now)
+{
+    ADC_T *adc = AdcSim_Regs();
+
+    s_sAdc.u32Ch = AdcSim_NextCh(0UL);
+    if(!(adc->ADCR & ADC_ADCR_ADEN_Msk) || (s_sAdc.u32Ch == ADC_CH_NUM))
+    {
+        s_sAdc.u32Running = 0UL;
+        adc->ADCR &= ~ADC_ADCR_ADST_Msk;
+        return;
+    }
+    s_sAdc.u32Running = 1UL;
+    s_sAdc.u64Begin = u64Now;
+    s_sAdc.u64ConvIdx = 0ULL;
+    s_sAdc.u64Done = AdcSim_DoneTime(0ULL);
+}
+
+static void AdcSim_Convert(void)
+{
+    ADC_T *adc = AdcSim_Regs();
+    uint32_t u32Ch = s_sAdc.u32Ch, u32Data;
+
+    u32Data = (s_sAdc.pfnSource != NULL) ? s_sAdc.pfnSource(u32Ch, s_sAdc.u64Done) : (s_sAdc.u32Seq++ & 0xFFFUL);
+    u32Data &= ADC_ADDR_RSLT_Msk;
+
+    HOSTSIM_SET(adc->ADDR[u32Ch], u32Data | ADC_ADDR_VALID_Msk);
+    s_sAdc.u64ConvCnt++;
+
+    if(adc->ADCR & ADC_ADCR_PTEN_Msk)
+    {
+        if(s_sAdc.u32PdmaPend)
+        {
+            s_sAdc.u64LostCnt++;
+            s_sAdc.u32StsFlag |= ADC_ADSR0_OVERRUNF_Msk;
+        }
+        HOSTSIM_SET(adc->ADPDMA, u32Data);
+        s_sAdc.u32PdmaPend = 1UL;
+    }
+}
+
+/* One conversion finished: pick the next channel or stop according to ADMD */
+static void AdcSim_Step(void)
+{
+    ADC_T *adc = AdcSim_Regs();
+    uint32_t u32Mode = adc->ADCR & ADC_ADCR_ADMD_Msk, u32Next;
+
+    AdcSim_Convert();
+
+    if((u32Mode == ADC_ADCR_ADMD_SINGLE) || (u32Mode == ADC_ADCR_ADMD_BURST))
+    {
+        s_sAdc.u32StsFlag |= ADC_ADSR0_ADF_Msk;
+        if(u32Mode == ADC_ADCR_ADMD_SINGLE)
+        {
+            s_sAdc.u32Running = 0UL;
+            adc->ADCR &= ~ADC_ADCR_ADST_Msk;
+            return;
+        }
+        u32Next = s_sAdc.u32Ch;
+    }
+    else
+    {
+        u32Next = AdcSim_NextCh(s_sAdc.u32Ch + 1UL);
+        if(u32Next == ADC_CH_NUM)
+        {
+            s_sAdc.u32StsFlag |= ADC_ADSR0_ADF_Msk;
+            if(u32Mode == ADC_ADCR_ADMD_SINGLE_CYCLE)
+            {
+                s_sAdc.u32Running = 0UL;
+                adc->ADCR &= ~ADC_ADCR_ADST_Msk;
+                return;
+            }
+            u32Next = AdcSim_NextCh(0UL);
+        }
+    }
+    s_sAdc.u32Ch = u32Next;
+    s_sAdc.u64ConvIdx++;
+    s_sAdc.u64Done = AdcSim_DoneTime(s_sAdc.u64ConvIdx);
+}
+
+static void AdcSim_Reset(uint32_t u32Inst)
+{
+    HOSTSIM_ADC_SOURCE_T pfnSource = s_sAdc.pfnSource;
+
+    (void)u32Inst;
+    memset(&s_sAdc, 0, sizeof(s_sAdc));
+    s_sAdc.pfnSource = pfnSource;
+    memset((void *)AdcSim_Regs(), 0, sizeof(ADC_T));
+    AdcSim_Refresh();
+}
+
+static void AdcSim_Sync(uint32_t u32Inst, uint64_t u64Now)
+{
+    (void)u32Inst;
+    while(s_sAdc.u32Running && (s_sAdc.u64Done <= u64Now))
+    {
+        AdcSim_Step();
+    }
+    AdcSim_Refresh();
+}
+
+static uint64_t AdcSim_NextEvent(uint32_t u32Inst)
+{
+    (void)u32Inst;
+    return s_sAdc.u32Running ? s_sAdc.u64Done : HOSTSIM_NEVER;
+}
+
+static void AdcSim_Read(uint32_t u32Inst, uint32_t u32Offset)
+{
+    (void)u32Inst;
+    if(u32Offset == offsetof(ADC_T, ADPDMA))
+    {
+        s_sAdc.u32PdmaPend = 0UL;
+    }
+    AdcSim_Refresh();
+}
+
+static void AdcSim_Write(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    ADC_T *adc = AdcSim_Regs();
+
+    (void)u32Inst;
+    switch(u32Offset)
+    {
+        case offsetof(ADC_T, ADCR):
+            if(u32New & ADC_ADCR_RESET_Msk)
+            {
+                /* Controller reset keeps the converter powered */
+                AdcSim_Reset(0UL);
+                adc->ADCR = u32New & ADC_ADCR_ADEN_Msk;
+                return;
+            }
+            if((u32New & ADC_ADCR_ADST_Msk) && !(u32Old & ADC_ADCR_ADST_Msk) && (adc->ADCALR & ADC_ADCALR_CALEN_Msk))
+            {
+                /* Calibration completes at once */
+                adc->ADCALSTSR |= ADC_ADCALSTSR_CALIF_Msk;
+                adc->ADCALR &= ~ADC_ADCALR_CALEN_Msk;
+                adc->ADCR &= ~ADC_ADCR_ADST_Msk;
+            }
+            else if((u32New & ADC_ADCR_ADST_Msk) && !(u32Old & ADC_ADCR_ADST_Msk))
+            {
+                AdcSim_Start(HostSim_Now());
+            }
+            else if(!(u32New & ADC_ADCR_ADST_Msk) || !(u32New & ADC_ADCR_ADEN_Msk))
+            {
+                s_sAdc.u32Running = 0UL;
+                adc->ADCR &= ~ADC_ADCR_ADST_Msk;
+            }
+            if(!(u32New & ADC_ADCR_PTEN_Msk))
+            {
+                s_sAdc.u32PdmaPend = 0UL;
+            }
+            break;
+
+        case offsetof(ADC_T, ADCALSTSR):
+            adc->ADCALSTSR = u32Old & ~u32New;
+            break;
+
+        case offsetof(ADC_T, ADSR0):
+            s_sAdc.u32StsFlag &= ~(u32New & (ADC_ADSR0_ADF_Msk | ADC_ADSR0_CMPF0_Msk | ADC_ADSR0_CMPF1_Msk));
+            break;
+
+        default:
+            break;
+    }
+    AdcSim_Refresh();
+}
+
+static uint32_t AdcSim_IrqLevel(uint32_t u32Inst)
+{
+    ADC_T *adc = AdcSim_Regs();
+
+    (void)u32Inst;
+    return ((adc->ADCR & ADC_ADCR_ADIE_Msk) && (s_sAdc.u32StsFlag & ADC_ADSR0_ADF_Msk)) ? 1UL : 0UL;
+}
+
+static uint32_t AdcSim_DmaRequest(uint32_t u32Inst, uint32_t u32ReqSel)
+{
+    (void)u32Inst;
+    if(u32ReqSel == PDMA_ADC_RX)
+    {
+        return ((AdcSim_Regs()->ADCR & ADC_ADCR_PTEN_Msk) && s_sAdc.u32PdmaPend) ? 1UL : 0UL;
+    }
+    return 0UL;
+}
+
+/* Hardware trigger from another model: sets ADST when TRGEN selects u32Source and the converter is idle */
+void HostSim_AdcTrigger(uint32_t u32Source, uint64_t u64When)
+{
+    ADC_T *adc = AdcSim_Regs();
+    uint32_t u32Adcr = adc->ADCR;
+
+    if(s_sAdc.u32Running || !(u32Adcr & ADC_ADCR_ADEN_Msk) || !(u32Adcr & ADC_ADCR_TRGEN_Msk) ||
+            ((u32Adcr & ADC_ADCR_TRGS_Msk) != u32Source) || (adc->ADCALR & ADC_ADCALR_CALEN_Msk))
+    {
+        return;
+    }
+    adc->ADCR = u32Adcr | ADC_ADCR_ADST_Msk;
+    AdcSim_Start(u64When);
+    AdcSim_Refresh();
+}
+
+const HOSTSIM_MODEL_T g_sHostSimAdcModel =
+{
+    "ADC", ADC_BASE, 0x1000UL, ADC_IRQn, 0UL,
+    AdcSim_Reset, AdcSim_Read, AdcSim_Write, AdcSim_Sync, AdcSim_NextEvent, AdcSim_IrqLevel, AdcSim_DmaRequest
+};
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+/** @addtogroup HOSTSIM_EXPORTED_FUNCTIONS HostSim Exported Functions
+  @{
+*/
+
+/**
+ * @brief       Attach an analog input model
+ *
+ * @param[in]   pfnSource   Called once per conversion with the channel and the HCLK cycle the
+ *                          conversion completes, returns the result. NULL restores the 12-bit ramp.
+ *
+ * @return      None
+ */
+void HostSim_AdcSetSource(HOSTSIM_ADC_SOURCE_T pfnSource)
+{
+    s_sAdc.pfnSource = pfnSource;
+}
+
+/**
+ * @brief       Get ADC conversion counters
+ *
+ * @param[out]  pu64Lost    Conversions overwritten before the PDMA read them, may be NULL
+ *
+ * @return      Conversions completed since HostSim_Init()
+ */
+uint64_t HostSim_AdcGetConvCount(uint64_t *pu64Lost)
+{
+    if(pu64Lost != NULL)
+    {
+        *pu64Lost = s_sAdc.u64LostCnt;
+    }
+    return s_sAdc.u64ConvCnt;
+}
+
+/*@}*/ /* end of group HOSTSIM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
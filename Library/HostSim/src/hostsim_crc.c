@@ -0,0 +1,146 @@
+/**************************************************************************//**
+ * @file     hostsim_crc.c
+ * @version  V1.00
+ * @brief    CRC model of the M031 host simulator
+ *
+ * @note     CCITT/CRC-8/CRC-16/CRC-32 polynomials computed MSB first with the
+ *           write-data and checksum reverse/complement options of CRC_T::CTL.
+ *           Each write to CRC_T::DAT consumes DATLEN bytes, low byte first.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "hostsim_model.h"
+
+static uint32_t s_u32CrcState;
+
+static CRC_T *CrcSim_Regs(void)
+{
+    return (CRC_T *)HostSim_Alias(CRC_BASE);
+}
+
+static uint32_t CrcSim_Width(uint32_t u32Ctl)
+{
+    static const uint32_t au32Width[4] = { 16UL, 8UL, 16UL, 32UL };
+
+    return au32Width[(u32Ctl & CRC_CTL_CRCMODE_Msk) >> CRC_CTL_CRCMODE_Pos];
+}
+
+static uint32_t CrcSim_Poly(uint32_t u32Ctl)
+{
+    static const uint32_t au32Poly[4] = { 0x1021UL, 0x07UL, 0x8005UL, 0x04C11DB7UL };
+
+    return au32Poly[(u32Ctl & CRC_CTL_CRCMODE_Msk) >> CRC_CTL_CRCMODE_Pos];
+}
+
+static uint32_t CrcSim_Mask(uint32_t u32Width)
+{
+    return (u32Width == 32UL) ? 0xFFFFFFFFUL : ((1UL << u32Width) - 1UL);
+}
+
+static uint32_t CrcSim_Reverse(uint32_t u32Data, uint32_t u32Bits)
+{
+    uint32_t u32Out = 0UL, i;
+
+    for(i = 0UL; i < u32Bits; i++)
+    {
+        u32Out = (u32Out << 1) | ((u32Data >> i) & 1UL);
+    }
+    return u32Out;
+}
+
+static void CrcSim_Refresh(void)
+{
+    CRC_T *crc = CrcSim_Regs();
+    uint32_t u32Ctl = crc->CTL, u32Width = CrcSim_Width(u32Ctl), u32Sum = s_u32CrcState;
+
+    if(u32Ctl & CRC_CTL_CHKSREV_Msk)
+    {
+        u32Sum = CrcSim_Reverse(u32Sum, u32Width);
+    }
+    if(u32Ctl & CRC_CTL_CHKSFMT_Msk)
+    {
+        u32Sum = ~u32Sum;
+    }
+    HOSTSIM_SET(crc->CHECKSUM, u32Sum & CrcSim_Mask(u32Width));
+}
+
+static void CrcSim_Byte(uint32_t u32Ctl, uint8_t u8Data)
+{
+    uint32_t u32Width = CrcSim_Width(u32Ctl), u32Poly = CrcSim_Poly(u32Ctl), u32Top = 1UL << (u32Width - 1UL), i;
+
+    if(u32Ctl & CRC_CTL_DATREV_Msk)
+    {
+        u8Data = (uint8_t)CrcSim_Reverse(u8Data, 8UL);
+    }
+    s_u32CrcState ^= (uint32_t)u8Data << (u32Width - 8UL);
+    for(i = 0UL; i < 8UL; i++)
+    {
+        s_u32CrcState = (s_u32CrcState & u32Top) ? ((s_u32CrcState << 1) ^ u32Poly) : (s_u32CrcState << 1);
+    }
+    s_u32CrcState &= CrcSim_Mask(u32Width);
+}
+
+static void CrcSim_Reset(uint32_t u32Inst)
+{
+    CRC_T *crc = CrcSim_Regs();
+
+    (void)u32Inst;
+    memset((void *)crc, 0, sizeof(CRC_T));
+    crc->CTL = 0x20000000UL;
+    crc->SEED = 0xFFFFFFFFUL;
+    s_u32CrcState = 0xFFFFUL;
+    CrcSim_Refresh();
+}
+
+static void CrcSim_Write(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    CRC_T *crc = CrcSim_Regs();
+    uint32_t u32Ctl = crc->CTL, u32Len, i;
+
+    (void)u32Inst;
+    (void)u32Old;
+    if(u32Offset == offsetof(CRC_T, CTL))
+    {
+        if(u32New & CRC_CTL_CHKSINIT_Msk)
+        {
+            s_u32CrcState = crc->SEED & CrcSim_Mask(CrcSim_Width(u32New));
+            crc->CTL = u32New & ~CRC_CTL_CHKSINIT_Msk;
+        }
+    }
+    else if(u32Offset == offsetof(CRC_T, DAT))
+    {
+        if(u32Ctl & CRC_CTL_CRCEN_Msk)
+        {
+            u32Len = 1UL << ((u32Ctl & CRC_CTL_DATLEN_Msk) >> CRC_CTL_DATLEN_Pos);
+            if(u32Len > 4UL)
+            {
+                u32Len = 4UL;
+            }
+            if(u32Ctl & CRC_CTL_DATFMT_Msk)
+            {
+                u32New = ~u32New;
+            }
+            for(i = 0UL; i < u32Len; i++)
+            {
+                CrcSim_Byte(u32Ctl, (uint8_t)(u32New >> (i * 8UL)));
+            }
+        }
+    }
+    CrcSim_Refresh();
+}
+
+static void CrcSim_Read(uint32_t u32Inst, uint32_t u32Offset)
+{
+    (void)u32Inst;
+    (void)u32Offset;
+    CrcSim_Refresh();
+}
+
+const HOSTSIM_MODEL_T g_sHostSimCrcModel =
+{
+    "CRC", CRC_BASE, 0x1000UL, HOSTSIM_NO_IRQ, 0UL,
+    CrcSim_Reset, CrcSim_Read, CrcSim_Write, NULL, NULL, NULL, NULL
+};
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
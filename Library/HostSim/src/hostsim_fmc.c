@@ -0,0 +1,574 @@
+/**************************************************************************//**
+ * @file     hostsim_fmc.c
+ * @version  V1.00
+ * @brief    FMC (flash memory controller) model of the M031 host simulator
+ *
+ * @note     APROM, LDROM, SPROM and User Configuration arrays with erase to
+ *           0xFF and AND-programming, the ISP command set used by fmc.c
+ *           (read, program, 64-bit program, multi-word program, page/bank
+ *           erase, checksum, all-one check, IDs, vector map) and update
+ *           enable checks that raise ISPFF. Program and erase times are
+ *           approximations of the datasheet values and are charged to the
+ *           virtual HCLK. Code runs from flash, so the CPU stalls until every
+ *           command but multi-word program, which it has to feed, finishes.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "hostsim_model.h"
+
+#define FMC_SIM_APROM_SIZE      0x40000UL   /* Largest M031 APROM (256 KB) */
+#define FMC_SIM_LDROM_SIZE      0x1000UL
+#define FMC_SIM_SPROM_SIZE      FMC_SPROM_SIZE
+#define FMC_SIM_CONFIG_SIZE     0x10UL
+
+#define FMC_SIM_T_READ          8UL         /* HCLK cycles */
+#define FMC_SIM_T_PROG_US       20UL        /* 32-bit program */
+#define FMC_SIM_T_PROG64_US     25UL        /* 64-bit program */
+#define FMC_SIM_T_MPROG_US      10UL        /* One 64-bit pair of a multi-word program */
+#define FMC_SIM_T_ERASE_US      4000UL      /* Page erase */
+#define FMC_SIM_T_BANK_US       20000UL     /* Bank erase */
+
+#define FMC_SIM_CID             0x000000DAUL
+#define FMC_SIM_PDID            0x01131000UL
+
+typedef struct
+{
+    uint8_t  au8Aprom[FMC_SIM_APROM_SIZE];
+    uint8_t  au8Ldrom[FMC_SIM_LDROM_SIZE];
+    uint8_t  au8Sprom[FMC_SIM_SPROM_SIZE];
+    uint8_t  au8Config[FMC_SIM_CONFIG_SIZE];
+    uint32_t u32Busy;
+    uint64_t u64Done;
+    uint32_t u32Cmd;
+    uint32_t u32Checksum;
+    uint32_t u32AllOne;
+    /* Multi-word program */
+    uint32_t u32MpActive;
+    uint32_t u32MpAddr;
+    uint32_t u32MpSlot;                     /* 0: MPDAT0/1 pair, 1: MPDAT2/3 pair */
+    uint32_t au32MpData[2];
+    uint32_t u32MpLoaded;                   /* MPSTS D0~D3 image */
+    HOSTSIM_FMC_STAT_T sStat;
+} FMC_SIM_T;
+
+static FMC_SIM_T s_sFmc;
+static uint32_t s_u32FmcBlank = 0UL;
+
+static FMC_T *FmcSim_Regs(void)
+{
+    return (FMC_T *)HostSim_Alias(FMC_BASE);
+}
+
+static uint64_t FmcSim_Us(uint32_t u32Us)
+{
+    return ((uint64_t)HostSim_GetHclkFreq() * u32Us) / 1000000ULL;
+}
+
+/* Map a flash address to the backing array; u32Update selects the update-enable check */
+static uint8_t *FmcSim_Map(uint32_t u32Addr, uint32_t u32Len, uint32_t u32Update)
+{
+    FMC_T *fmc = FmcSim_Regs();
+    uint32_t u32Ctl = fmc->ISPCTL;
+
+    if((u32Addr + u32Len) <= FMC_SIM_APROM_SIZE)
+    {
+        if(u32Update && !(u32Ctl & FMC_ISPCTL_APUEN_Msk) && !(u32Ctl & FMC_ISPCTL_BS_Msk))
+        {
+            return NULL;
+        }
+        return &s_sFmc.au8Aprom[u32Addr];
+    }
+    if((u32Addr >= FMC_LDROM_BASE) && ((u32Addr + u32Len) <= (FMC_LDROM_BASE + FMC_SIM_LDROM_SIZE)))
+    {
+        if(u32Update && !(u32Ctl & FMC_ISPCTL_LDUEN_Msk))
+        {
+            return NULL;
+        }
+        return &s_sFmc.au8Ldrom[u32Addr - FMC_LDROM_BASE];
+    }
+    if((u32Addr >= FMC_SPROM_BASE) && ((u32Addr + u32Len) <= (FMC_SPROM_BASE + FMC_SIM_SPROM_SIZE)))
+    {
+        if(u32Update && !(u32Ctl & FMC_ISPCTL_SPUEN_Msk))
+        {
+            return NULL;
+        }
+        return &s_sFmc.au8Sprom[u32Addr - FMC_SPROM_BASE];
+    }
+    if((u32Addr >= FMC_CONFIG_BASE) && ((u32Addr + u32Len) <= (FMC_CONFIG_BASE + FMC_SIM_CONFIG_SIZE)))
+    {
+        if(u32Update && !(u32Ctl & FMC_ISPCTL_CFGUEN_Msk))
+        {
+            return NULL;
+        }
+        return &s_sFmc.au8Config[u32Addr - FMC_CONFIG_BASE];
+    }
+    return NULL;
+}
+
+static void FmcSim_Program(uint8_t *pu8Dst, uint32_t u32Data)
+{
+    uint32_t u32Old;
+
+    memcpy(&u32Old, pu8Dst, 4UL);
+    u32Old &= u32Data;
+    memcpy(pu8Dst, &u32Old, 4UL);
+}
+
+static uint32_t FmcSim_Crc32(const uint8_t *pu8Buf, uint32_t u32Len)
+{
+    uint32_t u32Crc = 0xFFFFFFFFUL, i, j;
+
+    for(i = 0UL; i < u32Len; i++)
+    {
+        u32Crc ^= pu8Buf[i];
+        for(j = 0UL; j < 8UL; j++)
+        {
+            u32Crc = (u32Crc >> 1) ^ ((u32Crc & 1UL) ? 0xEDB88320UL : 0UL);
+        }
+    }
+    return ~u32Crc;
+}
+
+static void FmcSim_UpdateDfba(void)
+{
+    FMC_T *fmc = FmcSim_Regs();
+    uint32_t u32Cfg0, u32Cfg1;
+
+    memcpy(&u32Cfg0, &s_sFmc.au8Config[0], 4UL);
+    memcpy(&u32Cfg1, &s_sFmc.au8Config[4], 4UL);
+    HOSTSIM_SET(fmc->DFBA, (u32Cfg0 & 0x1UL) ? 0xFFFFFFFFUL : u32Cfg1);
+}
+
+static void FmcSim_Fail(void)
+{
+    FMC_T *fmc = FmcSim_Regs();
+
+    fmc->ISPCTL |= FMC_ISPCTL_ISPFF_Msk;
+    fmc->ISPSTS |= FMC_ISPSTS_ISPFF_Msk;
+}
+
+static void FmcSim_Refresh(void)
+{
+    FMC_T *fmc = FmcSim_Regs();
+
+    if(s_sFmc.u32Busy)
+    {
+        fmc->ISPTRG = FMC_ISPTRG_ISPGO_Msk;
+        fmc->ISPSTS |= FMC_ISPSTS_ISPBUSY_Msk;
+    }
+    else
+    {
+        fmc->ISPTRG = 0UL;
+        fmc->ISPSTS &= ~FMC_ISPSTS_ISPBUSY_Msk;
+    }
+    fmc->ISPSTS = (fmc->ISPSTS & ~FMC_ISPSTS_CBS_Msk) | ((fmc->ISPCTL & FMC_ISPCTL_BS_Msk) ? FMC_ISPSTS_CBS_Msk : 0UL);
+    HOSTSIM_SET(fmc->MPSTS, (s_sFmc.u32MpActive ? FMC_MPSTS_MPBUSY_Msk : 0UL) | (s_sFmc.u32MpLoaded << FMC_MPSTS_D0_Pos));
+    HOSTSIM_SET(fmc->MPADDR, s_sFmc.u32MpAddr);
+}
+
+/* Start programming the next multi-word pair, or finish when software did not refill it */
+static void FmcSim_MpNextPair(uint64_t u64When)
+{
+    FMC_T *fmc = FmcSim_Regs();
+    uint32_t u32Mask = 3UL << (s_sFmc.u32MpSlot * 2UL);
+
+    if((s_sFmc.u32MpLoaded & u32Mask) != u32Mask)
+    {
+        s_sFmc.u32MpActive = 0UL;
+        s_sFmc.u32Busy = 0UL;
+        return;
+    }
+    if(s_sFmc.u32MpSlot == 0UL)
+    {
+        s_sFmc.au32MpData[0] = fmc->MPDAT0;
+        s_sFmc.au32MpData[1] = fmc->MPDAT1;
+    }
+    else
+    {
+        s_sFmc.au32MpData[0] = fmc->MPDAT2;
+        s_sFmc.au32MpData[1] = fmc->MPDAT3;
+    }
+    s_sFmc.u32MpLoaded &= ~u32Mask;
+    s_sFmc.u64Done = u64When + FmcSim_Us(FMC_SIM_T_MPROG_US);
+}
+
+static void FmcSim_Start(void)
+{
+    FMC_T *fmc = FmcSim_Regs();
+    uint32_t u32Addr = fmc->ISPADDR, u32Dat = fmc->ISPDAT, u32Page, i;
+    uint64_t u64Cost = FMC_SIM_T_READ;
+    uint8_t *pu8;
+
+    s_sFmc.sStat.u32IspCmd++;
+    s_sFmc.u32Cmd = fmc->ISPCMD & FMC_ISPCMD_CMD_Msk;
+
+    if(!(fmc->ISPCTL & FMC_ISPCTL_ISPEN_Msk))
+    {
+        FmcSim_Fail();
+        return;
+    }
+
+    switch(s_sFmc.u32Cmd)
+    {
+        case FMC_ISPCMD_READ:
+            pu8 = FmcSim_Map(u32Addr & ~3UL, 4UL, 0UL);
+            if(pu8 == NULL)
+            {
+                FmcSim_Fail();
+                break;
+            }
+            memcpy(&u32Dat, pu8, 4UL);
+            fmc->ISPDAT = u32Dat;
+            break;
+
+        case FMC_ISPCMD_READ_UID:
+            fmc->ISPDAT = 0x4E560000UL | (u32Addr & 0xFFUL);
+            break;
+
+        case FMC_ISPCMD_READ_CID:
+            fmc->ISPDAT = FMC_SIM_CID;
+            break;
+
+        case FMC_ISPCMD_READ_DID:
+            fmc->ISPDAT = FMC_SIM_PDID;
+            break;
+
+        case FMC_ISPCMD_PROGRAM:
+            pu8 = ((u32Addr & 3UL) == 0UL) ? FmcSim_Map(u32Addr, 4UL, 1UL) : NULL;
+            if(pu8 == NULL)
+            {
+                FmcSim_Fail();
+                break;
+            }
+            FmcSim_Program(pu8, u32Dat);
+            s_sFmc.sStat.u32WordProgram++;
+            u64Cost = FmcSim_Us(FMC_SIM_T_PROG_US);
+            break;
+
+        case FMC_ISPCMD_PROGRAM_64:
+            pu8 = ((u32Addr & 7UL) == 0UL) ? FmcSim_Map(u32Addr, 8UL, 1UL) : NULL;
+            if(pu8 == NULL)
+            {
+                FmcSim_Fail();
+                break;
+            }
+            FmcSim_Program(pu8, fmc->MPDAT0);
+            FmcSim_Program(pu8 + 4UL, fmc->MPDAT1);
+            s_sFmc.sStat.u32WordProgram += 2UL;
+            u64Cost = FmcSim_Us(FMC_SIM_T_PROG64_US);
+            break;
+
+        case FMC_ISPCMD_MULTI_PROG:
+            if(((u32Addr & 7UL) != 0UL) || (FmcSim_Map(u32Addr, 8UL, 1UL) == NULL))
+            {
+                FmcSim_Fail();
+                break;
+            }
+            s_sFmc.u32MpActive = 1UL;
+            s_sFmc.u32MpAddr = u32Addr;
+            s_sFmc.u32MpSlot = 0UL;
+            s_sFmc.u32MpLoaded = 0xFUL;
+            s_sFmc.u32Busy = 1UL;
+            FmcSim_MpNextPair(HostSim_Now());
+            return;
+
+        case FMC_ISPCMD_PAGE_ERASE:
+            u32Page = u32Addr & FMC_PAGE_ADDR_MASK;
+            if((u32Page == FMC_SPROM_BASE) && (u32Dat != 0x0055AA03UL))
+            {
+                FmcSim_Fail();
+                break;
+            }
+            if(u32Page == FMC_CONFIG_BASE)
+            {
+                pu8 = FmcSim_Map(u32Page, FMC_SIM_CONFIG_SIZE, 1UL);
+                i = FMC_SIM_CONFIG_SIZE;
+            }
+            else
+            {
+                pu8 = FmcSim_Map(u32Page, FMC_FLASH_PAGE_SIZE, 1UL);
+                i = FMC_FLASH_PAGE_SIZE;
+            }
+            if(pu8 == NULL)
+            {
+                FmcSim_Fail();
+                break;
+            }
+            memset(pu8, 0xFF, i);
+            s_sFmc.sStat.u32PageErase++;
+            u64Cost = FmcSim_Us(FMC_SIM_T_ERASE_US);
+            break;
+
+        case FMC_ISPCMD_BANK_ERASE:
+            if(FmcSim_Map(0UL, FMC_SIM_APROM_SIZE, 1UL) == NULL)
+            {
+                FmcSim_Fail();
+                break;
+            }
+            memset(s_sFmc.au8Aprom, 0xFF, sizeof(s_sFmc.au8Aprom));
+            s_sFmc.sStat.u32PageErase += FMC_SIM_APROM_SIZE / FMC_FLASH_PAGE_SIZE;
+            u64Cost = FmcSim_Us(FMC_SIM_T_BANK_US);
+            break;
+
+        case FMC_ISPCMD_RUN_CKS:
+            pu8 = FmcSim_Map(u32Addr, u32Dat, 0UL);
+            if((pu8 == NULL) || (u32Dat == 0UL) || (u32Addr % FMC_FLASH_PAGE_SIZE) || (u32Dat % FMC_FLASH_PAGE_SIZE))
+            {
+                FmcSim_Fail();
+                break;
+            }
+            s_sFmc.u32Checksum = FmcSim_Crc32(pu8, u32Dat);
+            u64Cost = u32Dat / 4UL;
+            break;
+
+        case FMC_ISPCMD_READ_CKS:
+            fmc->ISPDAT = s_sFmc.u32Checksum;
+            break;
+
+        case FMC_ISPCMD_RUN_ALL1:
+            pu8 = FmcSim_Map(u32Addr, u32Dat, 0UL);
+            if((pu8 == NULL) || (u32Dat == 0UL))
+            {
+                FmcSim_Fail();
+                break;
+            }
+            s_sFmc.u32AllOne = READ_ALLONE_YES;
+            for(i = 0UL; i < u32Dat; i++)
+            {
+                if(pu8[i] != 0xFFU)
+                {
+                    s_sFmc.u32AllOne = READ_ALLONE_NOT;
+                    break;
+                }
+            }
+            u64Cost = u32Dat / 4UL;
+            break;
+
+        case FMC_ISPCMD_READ_ALL1:
+            fmc->ISPDAT = s_sFmc.u32AllOne;
+            break;
+
+        case FMC_ISPCMD_VECMAP:
+            fmc->ISPSTS = (fmc->ISPSTS & ~FMC_ISPSTS_VECMAP_Msk) | ((u32Addr >> 9) << FMC_ISPSTS_VECMAP_Pos);
+            break;
+
+        case FMC_ISPCMD_BANK_REMAP:
+            if(u32Dat != 0x5AA55AA5UL)
+            {
+                FmcSim_Fail();
+            }
+            break;
+
+        default:
+            FmcSim_Fail();
+            break;
+    }
+
+    s_sFmc.u32Busy = 1UL;
+    s_sFmc.u64Done = HostSim_Now() + u64Cost;
+}
+
+static void FmcSim_Reset(uint32_t u32Inst)
+{
+    FMC_T *fmc = FmcSim_Regs();
+
+    (void)u32Inst;
+    /* Flash contents survive a peripheral reset; only the controller is cleared */
+    if(!s_u32FmcBlank)
+    {
+        memset(&s_sFmc, 0xFF, sizeof(s_sFmc.au8Aprom) + sizeof(s_sFmc.au8Ldrom) + sizeof(s_sFmc.au8Sprom) + sizeof(s_sFmc.au8Config));
+        memset(&s_sFmc.sStat, 0, sizeof(s_sFmc.sStat));
+        s_u32FmcBlank = 1UL;
+    }
+    s_sFmc.u32Busy = 0UL;
+    s_sFmc.u32MpActive = 0UL;
+    s_sFmc.u32MpLoaded = 0UL;
+    memset((void *)fmc, 0, 0x100UL);
+    FmcSim_UpdateDfba();
+    FmcSim_Refresh();
+}
+
+static void FmcSim_Sync(uint32_t u32Inst, uint64_t u64Now)
+{
+    uint8_t *pu8;
+
+    (void)u32Inst;
+    while(s_sFmc.u32Busy && (s_sFmc.u64Done <= u64Now))
+    {
+        if(!s_sFmc.u32MpActive)
+        {
+            s_sFmc.u32Busy = 0UL;
+            break;
+        }
+
+        /* One pair of the multi-word program is complete */
+        pu8 = FmcSim_Map(s_sFmc.u32MpAddr, 8UL, 1UL);
+        if(pu8 == NULL)
+        {
+            FmcSim_Fail();
+            s_sFmc.u32MpActive = 0UL;
+            s_sFmc.u32Busy = 0UL;
+            break;
+        }
+        FmcSim_Program(pu8, s_sFmc.au32MpData[0]);
+        FmcSim_Program(pu8 + 4UL, s_sFmc.au32MpData[1]);
+        s_sFmc.sStat.u32MultiProgram += 2UL;
+        s_sFmc.u32MpAddr += 8UL;
+        s_sFmc.u32MpSlot ^= 1UL;
+        FmcSim_MpNextPair(s_sFmc.u64Done);
+    }
+
+    if(!s_sFmc.u32Busy)
+    {
+        FmcSim_UpdateDfba();
+    }
+    FmcSim_Refresh();
+}
+
+static uint64_t FmcSim_NextEvent(uint32_t u32Inst)
+{
+    (void)u32Inst;
+    return s_sFmc.u32Busy ? s_sFmc.u64Done : HOSTSIM_NEVER;
+}
+
+static void FmcSim_Read(uint32_t u32Inst, uint32_t u32Offset)
+{
+    (void)u32Inst;
+    (void)u32Offset;
+    FmcSim_Refresh();
+}
+
+static void FmcSim_Write(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    FMC_T *fmc = FmcSim_Regs();
+
+    (void)u32Inst;
+    switch(u32Offset)
+    {
+        case offsetof(FMC_T, ISPTRG):
+            if((u32New & FMC_ISPTRG_ISPGO_Msk) && !s_sFmc.u32Busy)
+            {
+                FmcSim_Start();
+                if(s_sFmc.u32Busy && !s_sFmc.u32MpActive)
+                {
+                    HostSim_StallCpu(s_sFmc.u64Done);
+                }
+            }
+            break;
+
+        case offsetof(FMC_T, ISPCTL):
+            /* ISPFF is write-1-to-clear */
+            fmc->ISPCTL = (u32New & ~FMC_ISPCTL_ISPFF_Msk) | (u32Old & FMC_ISPCTL_ISPFF_Msk & ~u32New);
+            if(u32New & FMC_ISPCTL_ISPFF_Msk)
+            {
+                fmc->ISPSTS &= ~FMC_ISPSTS_ISPFF_Msk;
+            }
+            break;
+
+        case offsetof(FMC_T, ISPSTS):
+            fmc->ISPSTS = u32Old & ~(u32New & (FMC_ISPSTS_ISPFF_Msk | FMC_ISPSTS_ALLONE_Msk | FMC_ISPSTS_PGFF_Msk));
+            if(u32New & FMC_ISPSTS_ISPFF_Msk)
+            {
+                fmc->ISPCTL &= ~FMC_ISPCTL_ISPFF_Msk;
+            }
+            break;
+
+        case offsetof(FMC_T, MPDAT0):
+        case offsetof(FMC_T, MPDAT1):
+        case offsetof(FMC_T, MPDAT2):
+        case offsetof(FMC_T, MPDAT3):
+            if(s_sFmc.u32MpActive)
+            {
+                s_sFmc.u32MpLoaded |= 1UL << ((u32Offset - offsetof(FMC_T, MPDAT0)) / 4UL);
+            }
+            break;
+
+        default:
+            break;
+    }
+    FmcSim_Refresh();
+}
+
+const HOSTSIM_MODEL_T g_sHostSimFmcModel =
+{
+    "FMC", FMC_BASE, 0x1000UL, ISP_IRQn, 0UL,
+    FmcSim_Reset, FmcSim_Read, FmcSim_Write, FmcSim_Sync, FmcSim_NextEvent, NULL, NULL
+};
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+/** @addtogroup HOSTSIM_EXPORTED_FUNCTIONS HostSim Exported Functions
+  @{
+*/
+
+/**
+ * @brief       Preload the flash array
+ *
+ * @param[in]   u32Addr     Flash address (APROM, LDROM, SPROM or CONFIG space)
+ * @param[in]   pvBuf       Source data
+ * @param[in]   u32Len      Number of bytes
+ *
+ * @return      None
+ *
+ * @details     HostSim_Init() erases the whole array to 0xFF once per process; call this afterwards
+ *              to install an image or user configuration without going through ISP commands.
+ */
+void HostSim_FmcLoad(uint32_t u32Addr, const void *pvBuf, uint32_t u32Len)
+{
+    FMC_T *fmc = FmcSim_Regs();
+    uint32_t u32Ctl = fmc->ISPCTL;
+    uint8_t *pu8;
+
+    fmc->ISPCTL = u32Ctl | FMC_ISPCTL_APUEN_Msk | FMC_ISPCTL_LDUEN_Msk | FMC_ISPCTL_SPUEN_Msk | FMC_ISPCTL_CFGUEN_Msk;
+    pu8 = FmcSim_Map(u32Addr, u32Len, 1UL);
+    fmc->ISPCTL = u32Ctl;
+    if(pu8 != NULL)
+    {
+        memcpy(pu8, pvBuf, u32Len);
+        FmcSim_UpdateDfba();
+    }
+}
+
+/**
+ * @brief       Read back the flash array
+ *
+ * @param[in]   u32Addr     Flash address
+ * @param[out]  pvBuf       Destination buffer
+ * @param[in]   u32Len      Number of bytes
+ *
+ * @return      None
+ */
+void HostSim_FmcDump(uint32_t u32Addr, void *pvBuf, uint32_t u32Len)
+{
+    uint8_t *pu8 = FmcSim_Map(u32Addr, u32Len, 0UL);
+
+    if(pu8 != NULL)
+    {
+        memcpy(pvBuf, pu8, u32Len);
+    }
+    else
+    {
+        memset(pvBuf, 0xFF, u32Len);
+    }
+}
+
+/**
+ * @brief       Get flash program/erase counters
+ *
+ * @param[out]  psStat      Counters since HostSim_Init()
+ *
+ * @return      None
+ */
+void HostSim_FmcGetStat(HOSTSIM_FMC_STAT_T *psStat)
+{
+    *psStat = s_sFmc.sStat;
+}
+
+/*@}*/ /* end of group HOSTSIM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,80 @@
+/**************************************************************************//**
+ * @file     hostsim_model.h
+ * @version  V1.00
+ * @brief    Peripheral model interface of the M031 host simulator
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __HOSTSIM_MODEL_H__
+#define __HOSTSIM_MODEL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "NuMicro.h"
+#include "hostsim.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define HOSTSIM_NEVER           UINT64_MAX      /* pfnNextEvent() result when nothing is scheduled */
+#define HOSTSIM_NO_IRQ          (-100)          /* HOSTSIM_MODEL_T::i32IRQn of models without interrupt */
+#define HOSTSIM_SET(reg, val)   (*(volatile uint32_t *)(uintptr_t)&(reg) = (uint32_t)(val))   /* Update a read-only (__I) register image */
+
+/**
+  * @details    One simulated register block.
+  *
+  *             Models keep their register image in the alias view returned by HostSim_Alias().
+  *             pfnRead() runs before a CPU or PDMA read so the image can be refreshed (and read
+  *             side effects such as FIFO pops applied). pfnWrite() runs after the image has been
+  *             written and receives the word value before and after the access; it must rewrite
+  *             the image for write-1-to-clear or write-only bits. pfnSync() advances the model to
+  *             an absolute HCLK cycle and pfnNextEvent() reports the next cycle it needs to run.
+  */
+typedef struct
+{
+    const char *pcName;
+    uint32_t u32Base;
+    uint32_t u32Size;
+    int32_t  i32IRQn;
+    uint32_t u32Inst;
+    void     (*pfnReset)(uint32_t u32Inst);
+    void     (*pfnRead)(uint32_t u32Inst, uint32_t u32Offset);
+    void     (*pfnWrite)(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New);
+    void     (*pfnSync)(uint32_t u32Inst, uint64_t u64Now);
+    uint64_t (*pfnNextEvent)(uint32_t u32Inst);
+    uint32_t (*pfnIrqLevel)(uint32_t u32Inst);
+    uint32_t (*pfnDmaRequest)(uint32_t u32Inst, uint32_t u32ReqSel);
+} HOSTSIM_MODEL_T;
+
+/* Simulator services used by the models */
+void    *HostSim_Alias(uint32_t u32Addr);
+uint64_t HostSim_Now(void);
+void     HostSim_StallCpu(uint64_t u64Until);
+uint32_t HostSim_BusRead(uint32_t u32Addr, uint32_t u32Width);
+void     HostSim_BusWrite(uint32_t u32Addr, uint32_t u32Data, uint32_t u32Width);
+uint32_t HostSim_DmaRequest(uint32_t u32ReqSel);
+uint32_t HostSim_GetPclkFreq(uint32_t u32Apb);
+void     HostSim_CountDmaBeat(void);
+void     HostSim_Service(void);
+void     HostSim_AdcTrigger(uint32_t u32Source, uint64_t u64When);
+
+/* Models linked into the simulator */
+extern const HOSTSIM_MODEL_T g_asHostSimUartModel[HOSTSIM_UART_NUM];
+extern const HOSTSIM_MODEL_T g_sHostSimSpiModel;
+extern const HOSTSIM_MODEL_T g_sHostSimUspiModel;
+extern const HOSTSIM_MODEL_T g_sHostSimPdmaModel;
+extern const HOSTSIM_MODEL_T g_sHostSimFmcModel;
+extern const HOSTSIM_MODEL_T g_sHostSimCrcModel;
+extern const HOSTSIM_MODEL_T g_sHostSimUsbdModel;
+extern const HOSTSIM_MODEL_T g_asHostSimTimerModel[HOSTSIM_TIMER_NUM];
+extern const HOSTSIM_MODEL_T g_sHostSimAdcModel;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOSTSIM_MODEL_H__ */
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
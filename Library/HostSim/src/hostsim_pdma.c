@@ -0,0 +1,417 @@
+/**************************************************************************//**
+ * @file     hostsim_pdma.c
+ * @version  V1.00
+ * @brief    PDMA model of the M031 host simulator
+ *
+ * @note     Nine channels with basic and scatter-gather operation, software
+ *           (PDMA_MEM) and peripheral requests, fixed/round-robin priority,
+ *           transfer done / abort / request time-out flags. One data item is
+ *           moved per PDMA_BEAT_CYCLES HCLK cycles through HostSim_BusRead()
+ *           and HostSim_BusWrite(), so peripheral FIFOs see every access.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "hostsim_model.h"
+
+#define PDMA_BEAT_CYCLES    2UL         /* HCLK cycles per data item (read + write) */
+#define PDMA_TOUT_CH_NUM    2UL         /* Channels with request time-out counter */
+
+typedef struct
+{
+    uint32_t u32Loaded;                 /* Descriptor latched into the counters below */
+    uint32_t u32SrcAddr;
+    uint32_t u32DstAddr;
+    uint32_t u32Remain;
+    uint32_t u32SwReq;                  /* PDMA_MEM channel triggered by SWREQ */
+    uint64_t u64LastActive;             /* Time of the last beat, for request time-out */
+} PDMA_SIM_CH_T;
+
+static PDMA_SIM_CH_T s_asCh[PDMA_CH_MAX];
+static uint64_t s_u64BusFree;
+static uint32_t s_u32RrNext;
+static uint32_t s_u32ToutFlag;
+
+static PDMA_T *PdmaSim_Regs(void)
+{
+    return (PDMA_T *)HostSim_Alias(PDMA_BASE);
+}
+
+static uint32_t PdmaSim_ReqSel(uint32_t u32Ch)
+{
+    PDMA_T *pdma = PdmaSim_Regs();
+
+    if(u32Ch < 4UL)
+    {
+        return (pdma->REQSEL0_3 >> (u32Ch * 8UL)) & 0x3FUL;
+    }
+    else if(u32Ch < 8UL)
+    {
+        return (pdma->REQSEL4_7 >> ((u32Ch - 4UL) * 8UL)) & 0x3FUL;
+    }
+    return pdma->REQSEL8 & 0x3FUL;
+}
+
+/* Load the scatter-gather table linked from the channel NEXT field */
+static void PdmaSim_FetchDesc(uint32_t u32Ch)
+{
+    PDMA_T *pdma = PdmaSim_Regs();
+    uint32_t u32Desc = (pdma->SCATBA & PDMA_SCATBA_SCATBA_Msk) | (pdma->DSCT[u32Ch].NEXT & PDMA_DSCT_NEXT_NEXT_Msk);
+
+    pdma->DSCT[u32Ch].CTL  = HostSim_BusRead(u32Desc + 0x0UL, 4UL);
+    pdma->DSCT[u32Ch].SA   = HostSim_BusRead(u32Desc + 0x4UL, 4UL);
+    pdma->DSCT[u32Ch].DA   = HostSim_BusRead(u32Desc + 0x8UL, 4UL);
+    pdma->DSCT[u32Ch].NEXT = HostSim_BusRead(u32Desc + 0xCUL, 4UL);
+    HOSTSIM_SET(pdma->CURSCAT[u32Ch], u32Desc);
+}
+
+/* Latch the channel descriptor; scatter-gather mode first follows NEXT */
+static uint32_t PdmaSim_Load(uint32_t u32Ch)
+{
+    PDMA_T *pdma = PdmaSim_Regs();
+    PDMA_SIM_CH_T *psCh = &s_asCh[u32Ch];
+
+    if((pdma->DSCT[u32Ch].CTL & PDMA_DSCT_CTL_OPMODE_Msk) == PDMA_OP_SCATTER)
+    {
+        PdmaSim_FetchDesc(u32Ch);
+        if((pdma->DSCT[u32Ch].CTL & PDMA_DSCT_CTL_OPMODE_Msk) == PDMA_OP_STOP)
+        {
+            return 0UL;
+        }
+    }
+
+    psCh->u32SrcAddr = pdma->DSCT[u32Ch].SA;
+    psCh->u32DstAddr = pdma->DSCT[u32Ch].DA;
+    psCh->u32Remain = ((pdma->DSCT[u32Ch].CTL & PDMA_DSCT_CTL_TXCNT_Msk) >> PDMA_DSCT_CTL_TXCNT_Pos) + 1UL;
+    psCh->u32Loaded = 1UL;
+    return 1UL;
+}
+
+static uint32_t PdmaSim_Armed(uint32_t u32Ch)
+{
+    PDMA_T *pdma = PdmaSim_Regs();
+
+    return ((pdma->CHCTL & (1UL << u32Ch)) &&
+            ((pdma->DSCT[u32Ch].CTL & PDMA_DSCT_CTL_OPMODE_Msk) != PDMA_OP_STOP)) ? 1UL : 0UL;
+}
+
+static uint32_t PdmaSim_Ready(uint32_t u32Ch)
+{
+    uint32_t u32ReqSel;
+
+    if(!PdmaSim_Armed(u32Ch))
+    {
+        return 0UL;
+    }
+    u32ReqSel = PdmaSim_ReqSel(u32Ch);
+    if(u32ReqSel == PDMA_MEM)
+    {
+        return s_asCh[u32Ch].u32SwReq;
+    }
+    return HostSim_DmaRequest(u32ReqSel);
+}
+
+static int32_t PdmaSim_Select(void)
+{
+    PDMA_T *pdma = PdmaSim_Regs();
+    uint32_t i, u32Ch;
+
+    /* Fixed-priority channels first, then round-robin among the rest */
+    for(i = 0UL; i < PDMA_CH_MAX; i++)
+    {
+        u32Ch = (s_u32RrNext + i) % PDMA_CH_MAX;
+        if((pdma->PRISET & (1UL << u32Ch)) && PdmaSim_Ready(u32Ch))
+        {
+            return (int32_t)u32Ch;
+        }
+    }
+    for(i = 0UL; i < PDMA_CH_MAX; i++)
+    {
+        u32Ch = (s_u32RrNext + i) % PDMA_CH_MAX;
+        if(PdmaSim_Ready(u32Ch))
+        {
+            return (int32_t)u32Ch;
+        }
+    }
+    return -1;
+}
+
+static void PdmaSim_TableDone(uint32_t u32Ch)
+{
+    PDMA_T *pdma = PdmaSim_Regs();
+    PDMA_SIM_CH_T *psCh = &s_asCh[u32Ch];
+    uint32_t u32Ctl = pdma->DSCT[u32Ch].CTL;
+
+    psCh->u32Loaded = 0UL;
+    if((u32Ctl & PDMA_DSCT_CTL_OPMODE_Msk) == PDMA_OP_SCATTER)
+    {
+        /* Chained table: report it unless TBINTDIS and continue with NEXT */
+        if(!(u32Ctl & PDMA_DSCT_CTL_TBINTDIS_Msk))
+        {
+            pdma->TDSTS |= (1UL << u32Ch);
+        }
+        return;
+    }
+
+    pdma->DSCT[u32Ch].CTL = u32Ctl & ~PDMA_DSCT_CTL_OPMODE_Msk;
+    pdma->TDSTS |= (1UL << u32Ch);
+    psCh->u32SwReq = 0UL;
+}
+
+static void PdmaSim_Beat(uint32_t u32Ch, uint64_t u64When)
+{
+    PDMA_T *pdma = PdmaSim_Regs();
+    PDMA_SIM_CH_T *psCh = &s_asCh[u32Ch];
+    uint32_t u32Ctl, u32Width, u32Data;
+
+    if(!psCh->u32Loaded && !PdmaSim_Load(u32Ch))
+    {
+        pdma->TDSTS |= (1UL << u32Ch);
+        psCh->u32SwReq = 0UL;
+        return;
+    }
+
+    u32Ctl = pdma->DSCT[u32Ch].CTL;
+    u32Width = 1UL << ((u32Ctl & PDMA_DSCT_CTL_TXWIDTH_Msk) >> PDMA_DSCT_CTL_TXWIDTH_Pos);
+
+    u32Data = HostSim_BusRead(psCh->u32SrcAddr, u32Width);
+    HostSim_BusWrite(psCh->u32DstAddr, u32Data, u32Width);
+    HostSim_CountDmaBeat();
+
+    if((u32Ctl & PDMA_DSCT_CTL_SAINC_Msk) != PDMA_SAR_FIX)
+    {
+        psCh->u32SrcAddr += u32Width;
+    }
+    if((u32Ctl & PDMA_DSCT_CTL_DAINC_Msk) != PDMA_DAR_FIX)
+    {
+        psCh->u32DstAddr += u32Width;
+    }
+    psCh->u32Remain--;
+    psCh->u64LastActive = u64When;
+
+    pdma->DSCT[u32Ch].CTL = (u32Ctl & ~PDMA_DSCT_CTL_TXCNT_Msk) |
+                            (((psCh->u32Remain - 1UL) << PDMA_DSCT_CTL_TXCNT_Pos) & PDMA_DSCT_CTL_TXCNT_Msk);
+    if(psCh->u32Remain == 0UL)
+    {
+        pdma->DSCT[u32Ch].CTL = u32Ctl & ~PDMA_DSCT_CTL_TXCNT_Msk;
+        PdmaSim_TableDone(u32Ch);
+    }
+}
+
+static uint64_t PdmaSim_ToutPeriod(uint32_t u32Ch)
+{
+    PDMA_T *pdma = PdmaSim_Regs();
+    uint32_t u32Psc = (pdma->TOUTPSC >> (u32Ch * 4UL)) & 0x7UL;
+    uint32_t u32Toc = (pdma->TOC0_1 >> (u32Ch * 16UL)) & 0xFFFFUL;
+
+    return (uint64_t)u32Toc << (8UL + u32Psc);
+}
+
+static uint64_t PdmaSim_ToutTime(uint32_t u32Ch)
+{
+    PDMA_T *pdma = PdmaSim_Regs();
+
+    if(!(pdma->TOUTEN & (1UL << u32Ch)) || (s_u32ToutFlag & (1UL << u32Ch)) || !PdmaSim_Armed(u32Ch) ||
+            (PdmaSim_ReqSel(u32Ch) == PDMA_MEM) || (PdmaSim_ToutPeriod(u32Ch) == 0ULL))
+    {
+        return HOSTSIM_NEVER;
+    }
+    return s_asCh[u32Ch].u64LastActive + PdmaSim_ToutPeriod(u32Ch);
+}
+
+static void PdmaSim_Refresh(void)
+{
+    PDMA_T *pdma = PdmaSim_Regs();
+    uint32_t i, u32Trg = 0UL, u32Act = 0UL;
+
+    for(i = 0UL; i < PDMA_CH_MAX; i++)
+    {
+        if(s_asCh[i].u32SwReq)
+        {
+            u32Trg |= (1UL << i);
+        }
+        if(s_asCh[i].u32Loaded)
+        {
+            u32Act |= (1UL << i);
+        }
+    }
+    HOSTSIM_SET(pdma->TRGSTS, u32Trg);
+    HOSTSIM_SET(pdma->TACTSTS, u32Act);
+    pdma->INTSTS = (pdma->ABTSTS ? PDMA_INTSTS_ABTIF_Msk : 0UL) |
+                   (pdma->TDSTS ? PDMA_INTSTS_TDIF_Msk : 0UL) |
+                   (s_u32ToutFlag << PDMA_INTSTS_REQTOF0_Pos);
+}
+
+static void PdmaSim_Reset(uint32_t u32Inst)
+{
+    (void)u32Inst;
+    memset(s_asCh, 0, sizeof(s_asCh));
+    memset((void *)PdmaSim_Regs(), 0, sizeof(PDMA_T));
+    s_u64BusFree = 0ULL;
+    s_u32RrNext = 0UL;
+    s_u32ToutFlag = 0UL;
+    PdmaSim_Refresh();
+}
+
+static void PdmaSim_Sync(uint32_t u32Inst, uint64_t u64Now)
+{
+    int32_t i32Ch;
+    uint32_t i;
+
+    (void)u32Inst;
+    if(s_u64BusFree < u64Now)
+    {
+        s_u64BusFree = u64Now;
+    }
+    while(s_u64BusFree <= u64Now)
+    {
+        i32Ch = PdmaSim_Select();
+        if(i32Ch < 0)
+        {
+            break;
+        }
+        PdmaSim_Beat((uint32_t)i32Ch, s_u64BusFree);
+        s_u32RrNext = ((uint32_t)i32Ch + 1UL) % PDMA_CH_MAX;
+        s_u64BusFree += PDMA_BEAT_CYCLES;
+    }
+
+    for(i = 0UL; i < PDMA_TOUT_CH_NUM; i++)
+    {
+        if(PdmaSim_ToutTime(i) <= u64Now)
+        {
+            s_u32ToutFlag |= (1UL << i);
+        }
+    }
+    PdmaSim_Refresh();
+}
+
+static uint64_t PdmaSim_NextEvent(uint32_t u32Inst)
+{
+    uint64_t u64Next = HOSTSIM_NEVER, u64Tout;
+    uint32_t i;
+
+    (void)u32Inst;
+    if(PdmaSim_Select() >= 0)
+    {
+        u64Next = (s_u64BusFree > HostSim_Now()) ? s_u64BusFree : HostSim_Now();
+    }
+    for(i = 0UL; i < PDMA_TOUT_CH_NUM; i++)
+    {
+        u64Tout = PdmaSim_ToutTime(i);
+        if(u64Tout < u64Next)
+        {
+            u64Next = u64Tout;
+        }
+    }
+    return u64Next;
+}
+
+static void PdmaSim_Read(uint32_t u32Inst, uint32_t u32Offset)
+{
+    (void)u32Inst;
+    (void)u32Offset;
+    PdmaSim_Refresh();
+}
+
+static void PdmaSim_Write(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    PDMA_T *pdma = PdmaSim_Regs();
+    uint32_t i;
+
+    (void)u32Inst;
+    if(u32Offset < sizeof(pdma->DSCT))
+    {
+        /* Re-arming a channel restarts it from the programmed descriptor */
+        i = u32Offset / sizeof(DSCT_T);
+        if(((u32Offset % sizeof(DSCT_T)) == 0UL) && !(u32Old & PDMA_DSCT_CTL_OPMODE_Msk) && (u32New & PDMA_DSCT_CTL_OPMODE_Msk))
+        {
+            s_asCh[i].u32Loaded = 0UL;
+            s_asCh[i].u64LastActive = HostSim_Now();
+        }
+        return;
+    }
+
+    switch(u32Offset)
+    {
+        case offsetof(PDMA_T, CHCTL):
+            for(i = 0UL; i < PDMA_CH_MAX; i++)
+            {
+                if((u32New & (1UL << i)) && !(u32Old & (1UL << i)))
+                {
+                    s_asCh[i].u64LastActive = HostSim_Now();
+                }
+            }
+            break;
+
+        case offsetof(PDMA_T, SWREQ):
+            for(i = 0UL; i < PDMA_CH_MAX; i++)
+            {
+                if(u32New & (1UL << i))
+                {
+                    s_asCh[i].u32SwReq = 1UL;
+                }
+            }
+            pdma->SWREQ = 0UL;
+            break;
+
+        case offsetof(PDMA_T, PAUSE):
+        case offsetof(PDMA_T, CHRST):
+            for(i = 0UL; i < PDMA_CH_MAX; i++)
+            {
+                if(u32New & (1UL << i))
+                {
+                    s_asCh[i].u32Loaded = 0UL;
+                    s_asCh[i].u32SwReq = 0UL;
+                    pdma->DSCT[i].CTL &= ~PDMA_DSCT_CTL_OPMODE_Msk;
+                }
+            }
+            *(uint32_t *)((uint8_t *)pdma + u32Offset) = 0UL;
+            break;
+
+        case offsetof(PDMA_T, PRISET):
+            pdma->PRISET = u32Old | u32New;
+            break;
+
+        case offsetof(PDMA_T, PRICLR):
+            pdma->PRISET &= ~u32New;
+            pdma->PRICLR = 0UL;
+            break;
+
+        case offsetof(PDMA_T, TDSTS):
+        case offsetof(PDMA_T, ABTSTS):
+        case offsetof(PDMA_T, ALIGN):
+            *(uint32_t *)((uint8_t *)pdma + u32Offset) = u32Old & ~u32New;
+            break;
+
+        case offsetof(PDMA_T, INTSTS):
+            s_u32ToutFlag &= ~(u32New >> PDMA_INTSTS_REQTOF0_Pos);
+            for(i = 0UL; i < PDMA_TOUT_CH_NUM; i++)
+            {
+                if(u32New & (1UL << (PDMA_INTSTS_REQTOF0_Pos + i)))
+                {
+                    s_asCh[i].u64LastActive = HostSim_Now();
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+    PdmaSim_Refresh();
+}
+
+static uint32_t PdmaSim_IrqLevel(uint32_t u32Inst)
+{
+    PDMA_T *pdma = PdmaSim_Regs();
+
+    (void)u32Inst;
+    return (((pdma->TDSTS | pdma->ABTSTS) & pdma->INTEN) || (s_u32ToutFlag & pdma->TOUTIEN)) ? 1UL : 0UL;
+}
+
+const HOSTSIM_MODEL_T g_sHostSimPdmaModel =
+{
+    "PDMA", PDMA_BASE, 0x1000UL, PDMA_IRQn, 0UL,
+    PdmaSim_Reset, PdmaSim_Read, PdmaSim_Write, PdmaSim_Sync, PdmaSim_NextEvent, PdmaSim_IrqLevel, NULL
+};
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,365 @@
+/**************************************************************************//**
+ * @file     hostsim_spi.c
+ * @version  V1.00
+ * @brief    SPI0 master model of the M031 host simulator
+ *
+ * @note     4-level TX/RX FIFOs, word timing from SPI_T::CLKDIV and the
+ *           CLK_CLKSEL2 SPI0SEL source, unit transfer/threshold/overrun flags
+ *           and PDMA request lines. MISO is looped back from MOSI unless a
+ *           slave callback is installed with HostSim_SpiSetSlave().
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "hostsim_model.h"
+
+#define SPI_FIFO_DEPTH      4UL
+
+typedef struct
+{
+    uint32_t au32TxFifo[SPI_FIFO_DEPTH];
+    uint32_t u32TxHead, u32TxCnt;
+    uint32_t au32RxFifo[SPI_FIFO_DEPTH];
+    uint32_t u32RxHead, u32RxCnt;
+    uint32_t u32Shifting;
+    uint32_t u32TxShift;
+    uint64_t u64ShiftDone;
+    uint64_t u64LastDone;
+    uint32_t u32StsFlag;            /* sticky STATUS flags */
+    uint64_t u64TxCount;
+    HOSTSIM_SPI_SLAVE_T pfnSlave;
+} SPI_SIM_T;
+
+static SPI_SIM_T s_sSpi;
+
+static SPI_T *SpiSim_Regs(void)
+{
+    return (SPI_T *)HostSim_Alias(SPI0_BASE);
+}
+
+static uint32_t SpiSim_Width(void)
+{
+    uint32_t u32Width = (SpiSim_Regs()->CTL & SPI_CTL_DWIDTH_Msk) >> SPI_CTL_DWIDTH_Pos;
+
+    return (u32Width == 0UL) ? 32UL : u32Width;
+}
+
+static uint32_t SpiSim_WidthMask(void)
+{
+    uint32_t u32Width = SpiSim_Width();
+
+    return (u32Width == 32UL) ? 0xFFFFFFFFUL : ((1UL << u32Width) - 1UL);
+}
+
+/* HCLK cycles per SPI clock, in 1/256 units */
+static uint64_t SpiSim_BitTime256(void)
+{
+    CLK_T *psClk = (CLK_T *)HostSim_Alias(CLK_BASE);
+    uint32_t u32Src;
+
+    switch((psClk->CLKSEL2 & CLK_CLKSEL2_SPI0SEL_Msk) >> CLK_CLKSEL2_SPI0SEL_Pos)
+    {
+        case 0UL:
+            u32Src = __HXT;
+            break;
+        case 1UL:
+            u32Src = __HSI;
+            break;
+        case 2UL:
+            u32Src = HostSim_GetPclkFreq(1UL);
+            break;
+        default:
+            u32Src = __HIRC;
+            break;
+    }
+
+    return ((uint64_t)HostSim_GetHclkFreq() * 256ULL * (((SpiSim_Regs()->CLKDIV & SPI_CLKDIV_DIVIDER_Msk) >> SPI_CLKDIV_DIVIDER_Pos) + 1UL)) / u32Src;
+}
+
+static void SpiSim_Refresh(void)
+{
+    SPI_T *spi = SpiSim_Regs();
+    uint32_t u32Sts, u32RxTh, u32TxTh;
+
+    u32RxTh = (spi->FIFOCTL & SPI_FIFOCTL_RXTH_Msk) >> SPI_FIFOCTL_RXTH_Pos;
+    u32TxTh = (spi->FIFOCTL & SPI_FIFOCTL_TXTH_Msk) >> SPI_FIFOCTL_TXTH_Pos;
+
+    u32Sts = s_sSpi.u32StsFlag;
+    u32Sts |= (s_sSpi.u32RxCnt << SPI_STATUS_RXCNT_Pos) | (s_sSpi.u32TxCnt << SPI_STATUS_TXCNT_Pos);
+    if(s_sSpi.u32Shifting || s_sSpi.u32TxCnt)
+    {
+        u32Sts |= SPI_STATUS_BUSY_Msk;
+    }
+    if(s_sSpi.u32RxCnt == 0UL)
+    {
+        u32Sts |= SPI_STATUS_RXEMPTY_Msk;
+    }
+    if(s_sSpi.u32RxCnt >= SPI_FIFO_DEPTH)
+    {
+        u32Sts |= SPI_STATUS_RXFULL_Msk;
+    }
+    if(s_sSpi.u32RxCnt > u32RxTh)
+    {
+        u32Sts |= SPI_STATUS_RXTHIF_Msk;
+    }
+    if(s_sSpi.u32TxCnt == 0UL)
+    {
+        u32Sts |= SPI_STATUS_TXEMPTY_Msk;
+    }
+    if(s_sSpi.u32TxCnt >= SPI_FIFO_DEPTH)
+    {
+        u32Sts |= SPI_STATUS_TXFULL_Msk;
+    }
+    if(s_sSpi.u32TxCnt <= u32TxTh)
+    {
+        u32Sts |= SPI_STATUS_TXTHIF_Msk;
+    }
+    if(spi->CTL & SPI_CTL_SPIEN_Msk)
+    {
+        u32Sts |= SPI_STATUS_SPIENSTS_Msk;
+    }
+    spi->STATUS = u32Sts;
+}
+
+static void SpiSim_Start(uint64_t u64When)
+{
+    SPI_T *spi = SpiSim_Regs();
+    uint64_t u64Word;
+
+    if(s_sSpi.u32Shifting || !(spi->CTL & SPI_CTL_SPIEN_Msk) || (spi->CTL & SPI_CTL_SLAVE_Msk))
+    {
+        return;
+    }
+
+    if(s_sSpi.u32TxCnt)
+    {
+        s_sSpi.u32TxShift = s_sSpi.au32TxFifo[s_sSpi.u32TxHead];
+        s_sSpi.u32TxHead = (s_sSpi.u32TxHead + 1UL) % SPI_FIFO_DEPTH;
+        s_sSpi.u32TxCnt--;
+    }
+    else if((spi->CTL & SPI_CTL_RXONLY_Msk) && (s_sSpi.u32RxCnt < SPI_FIFO_DEPTH))
+    {
+        /* Receive-only mode keeps clocking while the RX FIFO has room */
+        s_sSpi.u32TxShift = 0UL;
+    }
+    else
+    {
+        return;
+    }
+
+    /* Back-to-back words are separated by the suspend interval */
+    u64Word = SpiSim_BitTime256() * SpiSim_Width();
+    if(u64When <= s_sSpi.u64LastDone)
+    {
+        u64When = s_sSpi.u64LastDone;
+        u64Word += SpiSim_BitTime256() * ((spi->CTL & SPI_CTL_SUSPITV_Msk) >> SPI_CTL_SUSPITV_Pos);
+    }
+    s_sSpi.u32Shifting = 1UL;
+    s_sSpi.u64ShiftDone = u64When + (u64Word / 256ULL) + 1ULL;
+}
+
+static void SpiSim_Reset(uint32_t u32Inst)
+{
+    HOSTSIM_SPI_SLAVE_T pfnSlave = s_sSpi.pfnSlave;
+    SPI_T *spi = SpiSim_Regs();
+
+    (void)u32Inst;
+    memset(&s_sSpi, 0, sizeof(s_sSpi));
+    s_sSpi.pfnSlave = pfnSlave;
+    memset((void *)spi, 0, sizeof(SPI_T));
+    spi->CTL = (8UL << SPI_CTL_DWIDTH_Pos) | (3UL << SPI_CTL_SUSPITV_Pos) | SPI_CTL_TXNEG_Msk;
+    spi->FIFOCTL = (1UL << SPI_FIFOCTL_RXTH_Pos) | (1UL << SPI_FIFOCTL_TXTH_Pos);
+    SpiSim_Refresh();
+}
+
+static void SpiSim_Sync(uint32_t u32Inst, uint64_t u64Now)
+{
+    uint32_t u32Rx;
+
+    (void)u32Inst;
+    while(s_sSpi.u32Shifting && (s_sSpi.u64ShiftDone <= u64Now))
+    {
+        u32Rx = (s_sSpi.pfnSlave != NULL) ? s_sSpi.pfnSlave(s_sSpi.u32TxShift) : s_sSpi.u32TxShift;
+        if(s_sSpi.u32RxCnt >= SPI_FIFO_DEPTH)
+        {
+            s_sSpi.u32StsFlag |= SPI_STATUS_RXOVIF_Msk;
+        }
+        else
+        {
+            s_sSpi.au32RxFifo[(s_sSpi.u32RxHead + s_sSpi.u32RxCnt) % SPI_FIFO_DEPTH] = u32Rx & SpiSim_WidthMask();
+            s_sSpi.u32RxCnt++;
+        }
+        s_sSpi.u32StsFlag |= SPI_STATUS_UNITIF_Msk;
+        s_sSpi.u64TxCount++;
+        s_sSpi.u32Shifting = 0UL;
+        s_sSpi.u64LastDone = s_sSpi.u64ShiftDone;
+        SpiSim_Start(s_sSpi.u64ShiftDone);
+    }
+    SpiSim_Refresh();
+}
+
+static uint64_t SpiSim_NextEvent(uint32_t u32Inst)
+{
+    (void)u32Inst;
+    return s_sSpi.u32Shifting ? s_sSpi.u64ShiftDone : HOSTSIM_NEVER;
+}
+
+static void SpiSim_Read(uint32_t u32Inst, uint32_t u32Offset)
+{
+    SPI_T *spi = SpiSim_Regs();
+
+    (void)u32Inst;
+    if(u32Offset == offsetof(SPI_T, RX))
+    {
+        if(s_sSpi.u32RxCnt)
+        {
+            HOSTSIM_SET(spi->RX, s_sSpi.au32RxFifo[s_sSpi.u32RxHead]);
+            s_sSpi.u32RxHead = (s_sSpi.u32RxHead + 1UL) % SPI_FIFO_DEPTH;
+            s_sSpi.u32RxCnt--;
+            SpiSim_Start(HostSim_Now());
+        }
+    }
+    SpiSim_Refresh();
+}
+
+static void SpiSim_Write(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    SPI_T *spi = SpiSim_Regs();
+
+    (void)u32Inst;
+    switch(u32Offset)
+    {
+        case offsetof(SPI_T, TX):
+            if(s_sSpi.u32TxCnt < SPI_FIFO_DEPTH)
+            {
+                s_sSpi.au32TxFifo[(s_sSpi.u32TxHead + s_sSpi.u32TxCnt) % SPI_FIFO_DEPTH] = u32New & SpiSim_WidthMask();
+                s_sSpi.u32TxCnt++;
+            }
+            spi->TX = 0UL;
+            SpiSim_Start(HostSim_Now());
+            break;
+
+        case offsetof(SPI_T, CTL):
+            if((u32New & SPI_CTL_SPIEN_Msk) && !(u32Old & SPI_CTL_SPIEN_Msk))
+            {
+                SpiSim_Start(HostSim_Now());
+            }
+            break;
+
+        case offsetof(SPI_T, PDMACTL):
+            if(u32New & SPI_PDMACTL_PDMARST_Msk)
+            {
+                spi->PDMACTL = 0UL;
+            }
+            break;
+
+        case offsetof(SPI_T, FIFOCTL):
+            if(u32New & (SPI_FIFOCTL_RXRST_Msk | SPI_FIFOCTL_RXFBCLR_Msk))
+            {
+                s_sSpi.u32RxHead = s_sSpi.u32RxCnt = 0UL;
+            }
+            if(u32New & (SPI_FIFOCTL_TXRST_Msk | SPI_FIFOCTL_TXFBCLR_Msk))
+            {
+                s_sSpi.u32TxHead = s_sSpi.u32TxCnt = 0UL;
+            }
+            if(u32New & (SPI_FIFOCTL_RXRST_Msk | SPI_FIFOCTL_TXRST_Msk))
+            {
+                s_sSpi.u32StsFlag &= ~SPI_STATUS_RXOVIF_Msk;
+            }
+            spi->FIFOCTL = u32New & ~(SPI_FIFOCTL_RXRST_Msk | SPI_FIFOCTL_TXRST_Msk |
+                                      SPI_FIFOCTL_RXFBCLR_Msk | SPI_FIFOCTL_TXFBCLR_Msk);
+            break;
+
+        case offsetof(SPI_T, STATUS):
+            s_sSpi.u32StsFlag &= ~u32New;
+            break;
+
+        default:
+            break;
+    }
+    SpiSim_Refresh();
+}
+
+static uint32_t SpiSim_IrqLevel(uint32_t u32Inst)
+{
+    SPI_T *spi = SpiSim_Regs();
+    uint32_t u32Sts = spi->STATUS;
+
+    (void)u32Inst;
+    if((spi->CTL & SPI_CTL_UNITIEN_Msk) && (u32Sts & SPI_STATUS_UNITIF_Msk))
+    {
+        return 1UL;
+    }
+    if((spi->FIFOCTL & SPI_FIFOCTL_RXTHIEN_Msk) && (u32Sts & SPI_STATUS_RXTHIF_Msk))
+    {
+        return 1UL;
+    }
+    if((spi->FIFOCTL & SPI_FIFOCTL_TXTHIEN_Msk) && (u32Sts & SPI_STATUS_TXTHIF_Msk))
+    {
+        return 1UL;
+    }
+    if((spi->FIFOCTL & SPI_FIFOCTL_RXOVIEN_Msk) && (u32Sts & SPI_STATUS_RXOVIF_Msk))
+    {
+        return 1UL;
+    }
+    return 0UL;
+}
+
+static uint32_t SpiSim_DmaRequest(uint32_t u32Inst, uint32_t u32ReqSel)
+{
+    SPI_T *spi = SpiSim_Regs();
+
+    (void)u32Inst;
+    if(u32ReqSel == PDMA_SPI0_TX)
+    {
+        return ((spi->PDMACTL & SPI_PDMACTL_TXPDMAEN_Msk) && (s_sSpi.u32TxCnt < SPI_FIFO_DEPTH)) ? 1UL : 0UL;
+    }
+    if(u32ReqSel == PDMA_SPI0_RX)
+    {
+        return ((spi->PDMACTL & SPI_PDMACTL_RXPDMAEN_Msk) && s_sSpi.u32RxCnt) ? 1UL : 0UL;
+    }
+    return 0UL;
+}
+
+const HOSTSIM_MODEL_T g_sHostSimSpiModel =
+{
+    "SPI0", SPI0_BASE, 0x1000UL, SPI0_IRQn, 0UL,
+    SpiSim_Reset, SpiSim_Read, SpiSim_Write, SpiSim_Sync, SpiSim_NextEvent, SpiSim_IrqLevel, SpiSim_DmaRequest
+};
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+/** @addtogroup HOSTSIM_EXPORTED_FUNCTIONS HostSim Exported Functions
+  @{
+*/
+
+/**
+ * @brief       Attach a SPI0 slave model
+ *
+ * @param[in]   pfnSlave    Called once per word with the MOSI data, returns MISO data.
+ *                          NULL loops MOSI back to MISO.
+ *
+ * @return      None
+ */
+void HostSim_SpiSetSlave(HOSTSIM_SPI_SLAVE_T pfnSlave)
+{
+    s_sSpi.pfnSlave = pfnSlave;
+}
+
+/**
+ * @brief       Get number of SPI0 words transferred
+ *
+ * @return      Words shifted since HostSim_Init()
+ */
+uint64_t HostSim_SpiGetTxCount(void)
+{
+    return s_sSpi.u64TxCount;
+}
+
+/*@}*/ /* end of group HOSTSIM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,323 @@
+/**************************************************************************//**
+ * @file     hostsim_timer.c
+ * @version  V1.00
+ * @brief    TIMER0~TIMER3 model of the M031 host simulator
+ *
+ * @note     24-bit up counter behind the 8-bit prescaler, clocked from the
+ *           CLK_CLKSEL1 TMRxSEL source (PCLK0 for TIMER0/1, PCLK1 for
+ *           TIMER2/3). One-shot, periodic, toggle and continuous modes raise
+ *           TIF when the counter reaches CMPDAT; with TRGADC set and TRGSSEL on
+ *           the time-out event each time-out also starts an ADC conversion.
+ *           Capture, event counting, toggle output pins and the PWM/PDMA
+ *           triggers are not modelled.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "hostsim_model.h"
+
+#define TIMER_CNT_RANGE     0x1000000ULL    /* 24-bit counter */
+
+typedef struct
+{
+    uint32_t u32Running;
+    uint64_t u64Origin;                 /* Cycle the counter held u32Cnt0 */
+    uint32_t u32Cnt0;
+    uint64_t u64Zero;                   /* Ticks since u64Origin at which the counter was last cleared */
+    uint64_t u64Due;                    /* Cycle of the next time-out */
+    uint32_t u32StsFlag;                /* Sticky INTSTS flags */
+    uint64_t u64TimeoutCnt;
+} TIMER_SIM_T;
+
+static TIMER_SIM_T s_asTimer[HOSTSIM_TIMER_NUM];
+
+static const uint32_t s_au32TimerBase[HOSTSIM_TIMER_NUM] = { TIMER0_BASE, TIMER1_BASE, TIMER2_BASE, TIMER3_BASE };
+
+static TIMER_T *TimerSim_Regs(uint32_t u32Inst)
+{
+    return (TIMER_T *)HostSim_Alias(s_au32TimerBase[u32Inst]);
+}
+
+/* Counter clock after the prescaler is u32Clk / u32Div; 0 when the source does not run */
+static uint32_t TimerSim_Clock(uint32_t u32Inst, uint32_t *pu32Div)
+{
+    CLK_T *psClk = (CLK_T *)HostSim_Alias(CLK_BASE);
+    static const uint32_t au32Pos[HOSTSIM_TIMER_NUM] =
+    {
+        CLK_CLKSEL1_TMR0SEL_Pos, CLK_CLKSEL1_TMR1SEL_Pos, CLK_CLKSEL1_TMR2SEL_Pos, CLK_CLKSEL1_TMR3SEL_Pos
+    };
+    uint32_t u32Clk;
+
+    *pu32Div = ((TimerSim_Regs(u32Inst)->CTL & TIMER_CTL_PSC_Msk) >> TIMER_CTL_PSC_Pos) + 1UL;
+
+    switch((psClk->CLKSEL1 >> au32Pos[u32Inst]) & 0x7UL)
+    {
+        case 0UL:
+            u32Clk = __HXT;
+            break;
+        case 1UL:
+            u32Clk = __LXT;
+            break;
+        case 2UL:
+            u32Clk = HostSim_GetPclkFreq((u32Inst < 2UL) ? 0UL : 1UL);
+            break;
+        case 5UL:
+            u32Clk = __LIRC;
+            break;
+        case 7UL:
+            u32Clk = __HIRC;
+            break;
+        default:
+            u32Clk = 0UL;
+            break;
+    }
+    return u32Clk;
+}
+
+/* Ticks counted between u64Origin and u64Cycle */
+static uint64_t TimerSim_Ticks(uint32_t u32Inst, uint64_t u64Cycle)
+{
+    TIMER_SIM_T *psTmr = &s_asTimer[u32Inst];
+    uint32_t u32Div, u32Clk = TimerSim_Clock(u32Inst, &u32Div);
+
+    if((u32Clk == 0UL) || (u64Cycle <= psTmr->u64Origin))
+    {
+        return 0ULL;
+    }
+    return ((u64Cycle - psTmr->u64Origin) * u32Clk) / ((uint64_t)HostSim_GetHclkFreq() * u32Div);
+}
+
+static uint32_t TimerSim_Count(uint32_t u32Inst, uint64_t u64Cycle)
+{
+    TIMER_SIM_T *psTmr = &s_asTimer[u32Inst];
+
+    return (uint32_t)((psTmr->u32Cnt0 + TimerSim_Ticks(u32Inst, u64Cycle) - psTmr->u64Zero) % TIMER_CNT_RANGE);
+}
+
+static uint32_t TimerSim_Cmp(uint32_t u32Inst)
+{
+    uint32_t u32Cmp = TimerSim_Regs(u32Inst)->CMP & TIMER_CMP_CMPDAT_Msk;
+
+    /* CMPDAT 0 and 1 are not allowed, the counter then runs its full range */
+    return (u32Cmp < 2UL) ? (uint32_t)TIMER_CNT_RANGE : u32Cmp;
+}
+
+/* Schedule the next time-out: the cycle the counter reaches CMPDAT after being cleared at u64Zero */
+static void TimerSim_Schedule(uint32_t u32Inst)
+{
+    TIMER_SIM_T *psTmr = &s_asTimer[u32Inst];
+    uint32_t u32Div, u32Clk = TimerSim_Clock(u32Inst, &u32Div);
+    uint64_t u64Ticks, u64Hz;
+
+    if(!psTmr->u32Running || (u32Clk == 0UL))
+    {
+        psTmr->u64Due = HOSTSIM_NEVER;
+        return;
+    }
+    u64Ticks = psTmr->u64Zero + TimerSim_Cmp(u32Inst) - psTmr->u32Cnt0;
+    u64Hz = (uint64_t)HostSim_GetHclkFreq() * u32Div;
+    psTmr->u64Due = psTmr->u64Origin + (u64Ticks * u64Hz + u32Clk - 1ULL) / u32Clk;
+}
+
+/* Restart the tick arithmetic at the current count, after the prescaler or comparator changed */
+static void TimerSim_Rebase(uint32_t u32Inst, uint64_t u64Now)
+{
+    TIMER_SIM_T *psTmr = &s_asTimer[u32Inst];
+
+    if(psTmr->u32Running)
+    {
+        psTmr->u32Cnt0 = TimerSim_Count(u32Inst, u64Now);
+        if(psTmr->u32Cnt0 >= TimerSim_Cmp(u32Inst))
+        {
+            psTmr->u32Cnt0 = 0UL;
+        }
+    }
+    psTmr->u64Origin = u64Now;
+    psTmr->u64Zero = 0ULL;
+    TimerSim_Schedule(u32Inst);
+}
+
+static void TimerSim_Refresh(uint32_t u32Inst)
+{
+    TIMER_T *timer = TimerSim_Regs(u32Inst);
+    TIMER_SIM_T *psTmr = &s_asTimer[u32Inst];
+
+    if(psTmr->u32Running)
+    {
+        timer->CTL |= TIMER_CTL_ACTSTS_Msk;
+        HOSTSIM_SET(timer->CNT, TimerSim_Count(u32Inst, HostSim_Now()));
+    }
+    else
+    {
+        timer->CTL &= ~TIMER_CTL_ACTSTS_Msk;
+        HOSTSIM_SET(timer->CNT, psTmr->u32Cnt0);
+    }
+    timer->INTSTS = psTmr->u32StsFlag;
+}
+
+static void TimerSim_Timeout(uint32_t u32Inst)
+{
+    TIMER_T *timer = TimerSim_Regs(u32Inst);
+    TIMER_SIM_T *psTmr = &s_asTimer[u32Inst];
+    uint32_t u32Ctl = timer->CTL;
+    uint64_t u64When = psTmr->u64Due;
+
+    psTmr->u32StsFlag |= TIMER_INTSTS_TIF_Msk;
+    psTmr->u64TimeoutCnt++;
+
+    if((u32Ctl & TIMER_CTL_TRGADC_Msk) && !(u32Ctl & TIMER_CTL_TRGSSEL_Msk))
+    {
+        HostSim_AdcTrigger(ADC_ADCR_TRGS_TIMER, u64When);
+    }
+
+    switch(u32Ctl & TIMER_CTL_OPMODE_Msk)
+    {
+        case TIMER_ONESHOT_MODE:
+            /* Counting stops and CNTEN clears; the counter is left cleared */
+            psTmr->u32Running = 0UL;
+            psTmr->u32Cnt0 = 0UL;
+            psTmr->u64Due = HOSTSIM_NEVER;
+            timer->CTL &= ~TIMER_CTL_CNTEN_Msk;
+            break;
+
+        case TIMER_CONTINUOUS_MODE:
+            /* The counter keeps running and matches again after wrapping */
+            psTmr->u64Zero += TIMER_CNT_RANGE;
+            TimerSim_Schedule(u32Inst);
+            break;
+
+        default:
+            psTmr->u64Zero += TimerSim_Cmp(u32Inst);
+            TimerSim_Schedule(u32Inst);
+            break;
+    }
+}
+
+static void TimerSim_Reset(uint32_t u32Inst)
+{
+    memset(&s_asTimer[u32Inst], 0, sizeof(s_asTimer[u32Inst]));
+    s_asTimer[u32Inst].u64Due = HOSTSIM_NEVER;
+    memset((void *)TimerSim_Regs(u32Inst), 0, sizeof(TIMER_T));
+    TimerSim_Refresh(u32Inst);
+}
+
+static void TimerSim_Sync(uint32_t u32Inst, uint64_t u64Now)
+{
+    while(s_asTimer[u32Inst].u64Due <= u64Now)
+    {
+        TimerSim_Timeout(u32Inst);
+    }
+    TimerSim_Refresh(u32Inst);
+}
+
+static uint64_t TimerSim_NextEvent(uint32_t u32Inst)
+{
+    return s_asTimer[u32Inst].u64Due;
+}
+
+static void TimerSim_Read(uint32_t u32Inst, uint32_t u32Offset)
+{
+    (void)u32Offset;
+    TimerSim_Refresh(u32Inst);
+}
+
+static void TimerSim_Write(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    TIMER_T *timer = TimerSim_Regs(u32Inst);
+    TIMER_SIM_T *psTmr = &s_asTimer[u32Inst];
+    uint64_t u64Now = HostSim_Now();
+
+    switch(u32Offset)
+    {
+        case offsetof(TIMER_T, CTL):
+            if(u32New & TIMER_CTL_RSTCNT_Msk)
+            {
+                /* Clears the counter, the prescaler and CNTEN */
+                psTmr->u32Running = 0UL;
+                psTmr->u32Cnt0 = 0UL;
+                timer->CTL = u32New & ~(TIMER_CTL_RSTCNT_Msk | TIMER_CTL_CNTEN_Msk);
+            }
+            else if((u32New & TIMER_CTL_CNTEN_Msk) && !psTmr->u32Running)
+            {
+                psTmr->u32Running = 1UL;
+                if(psTmr->u32Cnt0 >= TimerSim_Cmp(u32Inst))
+                {
+                    psTmr->u32Cnt0 = 0UL;
+                }
+            }
+            else if(!(u32New & TIMER_CTL_CNTEN_Msk) && psTmr->u32Running)
+            {
+                psTmr->u32Cnt0 = TimerSim_Count(u32Inst, u64Now);
+                psTmr->u32Running = 0UL;
+            }
+            else if(!((u32Old ^ u32New) & (TIMER_CTL_PSC_Msk | TIMER_CTL_OPMODE_Msk)))
+            {
+                break;
+            }
+            TimerSim_Rebase(u32Inst, u64Now);
+            break;
+
+        case offsetof(TIMER_T, CMP):
+            TimerSim_Rebase(u32Inst, u64Now);
+            break;
+
+        case offsetof(TIMER_T, INTSTS):
+            psTmr->u32StsFlag &= ~(u32New & (TIMER_INTSTS_TIF_Msk | TIMER_INTSTS_TWKF_Msk));
+            break;
+
+        default:
+            break;
+    }
+    TimerSim_Refresh(u32Inst);
+}
+
+static uint32_t TimerSim_IrqLevel(uint32_t u32Inst)
+{
+    return ((TimerSim_Regs(u32Inst)->CTL & TIMER_CTL_INTEN_Msk) && (s_asTimer[u32Inst].u32StsFlag & TIMER_INTSTS_TIF_Msk)) ? 1UL : 0UL;
+}
+
+const HOSTSIM_MODEL_T g_asHostSimTimerModel[HOSTSIM_TIMER_NUM] =
+{
+    {
+        "TIMER0", TIMER0_BASE, sizeof(TIMER_T), TMR0_IRQn, 0UL,
+        TimerSim_Reset, TimerSim_Read, TimerSim_Write, TimerSim_Sync, TimerSim_NextEvent, TimerSim_IrqLevel, NULL
+    },
+    {
+        "TIMER1", TIMER1_BASE, sizeof(TIMER_T), TMR1_IRQn, 1UL,
+        TimerSim_Reset, TimerSim_Read, TimerSim_Write, TimerSim_Sync, TimerSim_NextEvent, TimerSim_IrqLevel, NULL
+    },
+    {
+        "TIMER2", TIMER2_BASE, sizeof(TIMER_T), TMR2_IRQn, 2UL,
+        TimerSim_Reset, TimerSim_Read, TimerSim_Write, TimerSim_Sync, TimerSim_NextEvent, TimerSim_IrqLevel, NULL
+    },
+    {
+        "TIMER3", TIMER3_BASE, sizeof(TIMER_T), TMR3_IRQn, 3UL,
+        TimerSim_Reset, TimerSim_Read, TimerSim_Write, TimerSim_Sync, TimerSim_NextEvent, TimerSim_IrqLevel, NULL
+    },
+};
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+/** @addtogroup HOSTSIM_EXPORTED_FUNCTIONS HostSim Exported Functions
+  @{
+*/
+
+/**
+ * @brief       Get the number of time-outs of a timer
+ *
+ * @param[in]   u32Timer    Timer number, 0 ~ 3
+ *
+ * @return      Time-out events since HostSim_Init() or the last timer reset
+ */
+uint64_t HostSim_TimerGetTimeoutCount(uint32_t u32Timer)
+{
+    return (u32Timer < HOSTSIM_TIMER_NUM) ? s_asTimer[u32Timer].u64TimeoutCnt : 0ULL;
+}
+
+/*@}*/ /* end of group HOSTSIM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
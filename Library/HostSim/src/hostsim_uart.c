@@ -0,0 +1,624 @@
+/**************************************************************************//**
+ * @file     hostsim_uart.c
+ * @version  V1.00
+ * @brief    UART0~UART2 model of the M031 host simulator
+ *
+ * @note     16-byte TX/RX FIFOs, character timing from UART_T::BAUD/LINE and the
+ *           CLK_CLKSEL/CLKDIV selection, RX time-out, PDMA request lines, RS485
+ *           NMM/AAD address detection and a line side that records transmitted
+ *           bytes and paces injected ones.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "hostsim_model.h"
+
+#define UART_FIFO_DEPTH     16UL
+#define UART_LINE_SIZE      HOSTSIM_UART_SINK_SIZE
+#define UART_CHAR_ADDR      0x100UL     /* 9th bit set: RS485 address byte */
+
+typedef struct
+{
+    uint8_t  au8TxFifo[UART_FIFO_DEPTH];
+    uint32_t u32TxHead, u32TxCnt;
+    uint32_t u32Shifting;
+    uint8_t  u8TxShift;
+    uint64_t u64TxDone;
+
+    uint8_t  au8RxFifo[UART_FIFO_DEPTH];
+    uint32_t u32RxHead, u32RxCnt;
+    uint64_t u64RxLast;
+    uint32_t u32RxTout;
+    uint32_t u32RxOn;           /* RS485 AAD: last address byte matched ADDRMV */
+
+    uint16_t au16Inject[UART_LINE_SIZE];
+    uint32_t u32InjHead, u32InjCnt;
+    uint64_t u64InjNext;
+
+    uint8_t  au8Sink[UART_LINE_SIZE];
+    uint32_t u32SinkHead, u32SinkCnt;
+    uint64_t u64TxCount;
+
+    uint32_t u32StsFlag;        /* sticky FIFOSTS error flags */
+    uint32_t u32Loopback;
+} UART_SIM_T;
+
+static UART_SIM_T s_asUart[HOSTSIM_UART_NUM];
+
+static const uint32_t s_au32UartBase[HOSTSIM_UART_NUM] = { UART0_BASE, UART1_BASE, UART2_BASE };
+
+static UART_T *UartSim_Regs(uint32_t u32Inst)
+{
+    return (UART_T *)HostSim_Alias(s_au32UartBase[u32Inst]);
+}
+
+static uint32_t UartSim_ClockFreq(uint32_t u32Inst)
+{
+    CLK_T *psClk = (CLK_T *)HostSim_Alias(CLK_BASE);
+    uint32_t u32Sel, u32Div, u32Freq;
+
+    if(u32Inst == 0UL)
+    {
+        u32Sel = (psClk->CLKSEL1 & CLK_CLKSEL1_UART0SEL_Msk) >> CLK_CLKSEL1_UART0SEL_Pos;
+        u32Div = (psClk->CLKDIV0 & CLK_CLKDIV0_UART0DIV_Msk) >> CLK_CLKDIV0_UART0DIV_Pos;
+    }
+    else if(u32Inst == 1UL)
+    {
+        u32Sel = (psClk->CLKSEL1 & CLK_CLKSEL1_UART1SEL_Msk) >> CLK_CLKSEL1_UART1SEL_Pos;
+        u32Div = (psClk->CLKDIV0 & CLK_CLKDIV0_UART1DIV_Msk) >> CLK_CLKDIV0_UART1DIV_Pos;
+    }
+    else
+    {
+        u32Sel = (psClk->CLKSEL3 & CLK_CLKSEL3_UART2SEL_Msk) >> CLK_CLKSEL3_UART2SEL_Pos;
+        u32Div = (psClk->CLKDIV4 & CLK_CLKDIV4_UART2DIV_Msk) >> CLK_CLKDIV4_UART2DIV_Pos;
+    }
+
+    switch(u32Sel)
+    {
+        case 0UL:
+            u32Freq = __HXT;
+            break;
+        case 1UL:
+            u32Freq = __HSI;
+            break;
+        case 2UL:
+            u32Freq = __LXT;
+            break;
+        case 4UL:
+            u32Freq = HostSim_GetPclkFreq((u32Inst == 1UL) ? 1UL : 0UL);
+            break;
+        case 5UL:
+            u32Freq = __LIRC;
+            break;
+        default:
+            u32Freq = __HIRC;
+            break;
+    }
+    return u32Freq / (u32Div + 1UL);
+}
+
+/* HCLK cycles per bit, in 1/256 units to keep multi-Mbps rates accurate */
+static uint64_t UartSim_BitTime256(uint32_t u32Inst)
+{
+    UART_T *uart = UartSim_Regs(u32Inst);
+    uint32_t u32Brd = (uart->BAUD & UART_BAUD_BRD_Msk) >> UART_BAUD_BRD_Pos;
+    uint32_t u32Edivm1 = (uart->BAUD & UART_BAUD_EDIVM1_Msk) >> UART_BAUD_EDIVM1_Pos;
+    uint64_t u64Div;
+
+    if((uart->BAUD & (UART_BAUD_BAUDM1_Msk | UART_BAUD_BAUDM0_Msk)) == (UART_BAUD_BAUDM1_Msk | UART_BAUD_BAUDM0_Msk))
+    {
+        u64Div = u32Brd + 2UL;
+    }
+    else if(uart->BAUD & UART_BAUD_BAUDM1_Msk)
+    {
+        u64Div = (uint64_t)(u32Edivm1 + 1UL) * (u32Brd + 2UL);
+    }
+    else
+    {
+        u64Div = 16ULL * (u32Brd + 2UL);
+    }
+
+    return (u64Div * HostSim_GetHclkFreq() * 256ULL) / UartSim_ClockFreq(u32Inst);
+}
+
+static uint64_t UartSim_CharTime(uint32_t u32Inst)
+{
+    UART_T *uart = UartSim_Regs(u32Inst);
+    uint32_t u32Bits2;      /* frame length in half bits */
+
+    u32Bits2 = 2UL * (1UL + 5UL + ((uart->LINE & UART_LINE_WLS_Msk) >> UART_LINE_WLS_Pos));
+    if(uart->LINE & UART_LINE_PBE_Msk)
+    {
+        u32Bits2 += 2UL;
+    }
+    if(uart->LINE & UART_LINE_NSB_Msk)
+    {
+        u32Bits2 += ((uart->LINE & UART_LINE_WLS_Msk) == 0UL) ? 3UL : 4UL;
+    }
+    else
+    {
+        u32Bits2 += 2UL;
+    }
+
+    return ((UartSim_BitTime256(u32Inst) * u32Bits2) / 512ULL) + 1ULL;
+}
+
+static uint32_t UartSim_RxTrigger(uint32_t u32Inst)
+{
+    static const uint32_t au32Level[4] = { 1UL, 4UL, 8UL, 14UL };
+    UART_T *uart = UartSim_Regs(u32Inst);
+
+    return au32Level[((uart->FIFO & UART_FIFO_RFITL_Msk) >> UART_FIFO_RFITL_Pos) & 3UL];
+}
+
+static void UartSim_Refresh(uint32_t u32Inst)
+{
+    UART_SIM_T *psSim = &s_asUart[u32Inst];
+    UART_T *uart = UartSim_Regs(u32Inst);
+    uint32_t u32Fifo, u32Int, u32Ien = uart->INTEN;
+
+    u32Fifo = psSim->u32StsFlag;
+    u32Fifo |= ((psSim->u32RxCnt & 0x3FUL) << UART_FIFOSTS_RXPTR_Pos);
+    u32Fifo |= ((psSim->u32TxCnt & 0x3FUL) << UART_FIFOSTS_TXPTR_Pos);
+    if(psSim->u32RxCnt == 0UL)
+    {
+        u32Fifo |= UART_FIFOSTS_RXEMPTY_Msk;
+    }
+    if(psSim->u32RxCnt >= UART_FIFO_DEPTH)
+    {
+        u32Fifo |= UART_FIFOSTS_RXFULL_Msk;
+    }
+    if(psSim->u32TxCnt == 0UL)
+    {
+        u32Fifo |= UART_FIFOSTS_TXEMPTY_Msk;
+        if(!psSim->u32Shifting)
+        {
+            u32Fifo |= UART_FIFOSTS_TXEMPTYF_Msk;
+        }
+    }
+    if(psSim->u32TxCnt >= UART_FIFO_DEPTH)
+    {
+        u32Fifo |= UART_FIFOSTS_TXFULL_Msk;
+    }
+    if(psSim->u32InjCnt == 0UL)
+    {
+        u32Fifo |= UART_FIFOSTS_RXIDLE_Msk;
+    }
+    if(psSim->u32Shifting || psSim->u32InjCnt)
+    {
+        u32Fifo |= UART_FIFOSTS_TXRXACT_Msk;
+    }
+    uart->FIFOSTS = u32Fifo;
+
+    u32Int = 0UL;
+    if(psSim->u32RxCnt >= UartSim_RxTrigger(u32Inst))
+    {
+        u32Int |= UART_INTSTS_RDAIF_Msk;
+    }
+    if(psSim->u32TxCnt == 0UL)
+    {
+        u32Int |= UART_INTSTS_THREIF_Msk;
+        if(!psSim->u32Shifting)
+        {
+            u32Int |= UART_INTSTS_TXENDIF_Msk;
+        }
+    }
+    if(u32Fifo & (UART_FIFOSTS_BIF_Msk | UART_FIFOSTS_FEF_Msk | UART_FIFOSTS_PEF_Msk | UART_FIFOSTS_ADDRDETF_Msk))
+    {
+        u32Int |= UART_INTSTS_RLSIF_Msk;
+    }
+    if(u32Fifo & (UART_FIFOSTS_RXOVIF_Msk | UART_FIFOSTS_TXOVIF_Msk))
+    {
+        u32Int |= UART_INTSTS_BUFERRIF_Msk;
+    }
+    if(psSim->u32RxTout)
+    {
+        u32Int |= UART_INTSTS_RXTOIF_Msk;
+    }
+
+    if((u32Int & UART_INTSTS_RDAIF_Msk) && (u32Ien & UART_INTEN_RDAIEN_Msk))
+    {
+        u32Int |= UART_INTSTS_RDAINT_Msk;
+    }
+    if((u32Int & UART_INTSTS_THREIF_Msk) && (u32Ien & UART_INTEN_THREIEN_Msk))
+    {
+        u32Int |= UART_INTSTS_THREINT_Msk;
+    }
+    if((u32Int & UART_INTSTS_RLSIF_Msk) && (u32Ien & UART_INTEN_RLSIEN_Msk))
+    {
+        u32Int |= UART_INTSTS_RLSINT_Msk;
+    }
+    if((u32Int & UART_INTSTS_RXTOIF_Msk) && (u32Ien & UART_INTEN_RXTOIEN_Msk))
+    {
+        u32Int |= UART_INTSTS_RXTOINT_Msk;
+    }
+    if((u32Int & UART_INTSTS_BUFERRIF_Msk) && (u32Ien & UART_INTEN_BUFERRIEN_Msk))
+    {
+        u32Int |= UART_INTSTS_BUFERRINT_Msk;
+    }
+    if((u32Int & UART_INTSTS_TXENDIF_Msk) && (u32Ien & UART_INTEN_TXENDIEN_Msk))
+    {
+        u32Int |= UART_INTSTS_TXENDINT_Msk;
+    }
+    uart->INTSTS = u32Int;
+}
+
+static void UartSim_RxPush(uint32_t u32Inst, uint32_t u32Char, uint64_t u64When)
+{
+    UART_SIM_T *psSim = &s_asUart[u32Inst];
+    UART_T *uart = UartSim_Regs(u32Inst);
+    uint32_t u32Alt = uart->ALTCTL;
+
+    if(((uart->FUNCSEL & UART_FUNCSEL_FUNCSEL_Msk) == UART_FUNCSEL_RS485) && (u32Alt & UART_ALTCTL_ADDRDEN_Msk) &&
+            (u32Alt & (UART_ALTCTL_RS485NMM_Msk | UART_ALTCTL_RS485AAD_Msk)))
+    {
+        if(u32Char & UART_CHAR_ADDR)
+        {
+            /* NMM takes every address byte, even with RXOFF set; AAD only a match and then
+               the data up to the next address byte */
+            if(u32Alt & UART_ALTCTL_RS485AAD_Msk)
+            {
+                psSim->u32RxOn = ((u32Char & 0xFFUL) == ((u32Alt & UART_ALTCTL_ADDRMV_Msk) >> UART_ALTCTL_ADDRMV_Pos));
+                if(!psSim->u32RxOn)
+                {
+                    return;
+                }
+            }
+            psSim->u32StsFlag |= UART_FIFOSTS_ADDRDETF_Msk;
+        }
+        else if((u32Alt & UART_ALTCTL_RS485AAD_Msk) ? !psSim->u32RxOn : (uart->FIFO & UART_FIFO_RXOFF_Msk))
+        {
+            return;
+        }
+    }
+    else if(uart->FIFO & UART_FIFO_RXOFF_Msk)
+    {
+        return;
+    }
+    if(psSim->u32RxCnt >= UART_FIFO_DEPTH)
+    {
+        psSim->u32StsFlag |= UART_FIFOSTS_RXOVIF_Msk;
+        return;
+    }
+    psSim->au8RxFifo[(psSim->u32RxHead + psSim->u32RxCnt) % UART_FIFO_DEPTH] = (uint8_t)u32Char;
+    psSim->u32RxCnt++;
+    psSim->u64RxLast = u64When;
+}
+
+static void UartSim_StartTx(uint32_t u32Inst, uint64_t u64When)
+{
+    UART_SIM_T *psSim = &s_asUart[u32Inst];
+
+    if(psSim->u32Shifting || (psSim->u32TxCnt == 0UL))
+    {
+        return;
+    }
+    psSim->u8TxShift = psSim->au8TxFifo[psSim->u32TxHead];
+    psSim->u32TxHead = (psSim->u32TxHead + 1UL) % UART_FIFO_DEPTH;
+    psSim->u32TxCnt--;
+    psSim->u32Shifting = 1UL;
+    psSim->u64TxDone = u64When + UartSim_CharTime(u32Inst);
+}
+
+static uint64_t UartSim_ToutTime(uint32_t u32Inst)
+{
+    UART_SIM_T *psSim = &s_asUart[u32Inst];
+    UART_T *uart = UartSim_Regs(u32Inst);
+    uint32_t u32Toic = (uart->TOUT & UART_TOUT_TOIC_Msk) >> UART_TOUT_TOIC_Pos;
+
+    if(!(uart->INTEN & UART_INTEN_TOCNTEN_Msk) || (psSim->u32RxCnt == 0UL) || psSim->u32RxTout || (u32Toic == 0UL))
+    {
+        return HOSTSIM_NEVER;
+    }
+    return psSim->u64RxLast + ((UartSim_BitTime256(u32Inst) * u32Toic) / 256ULL) + 1ULL;
+}
+
+static void UartSim_Reset(uint32_t u32Inst)
+{
+    UART_T *uart = UartSim_Regs(u32Inst);
+    uint32_t u32Loopback = s_asUart[u32Inst].u32Loopback;
+
+    memset(&s_asUart[u32Inst], 0, sizeof(UART_SIM_T));
+    s_asUart[u32Inst].u32Loopback = u32Loopback;
+    memset((void *)uart, 0, sizeof(UART_T));
+    UartSim_Refresh(u32Inst);
+}
+
+static void UartSim_Sync(uint32_t u32Inst, uint64_t u64Now)
+{
+    UART_SIM_T *psSim = &s_asUart[u32Inst];
+    uint64_t u64Tout;
+
+    while(psSim->u32Shifting && (psSim->u64TxDone <= u64Now))
+    {
+        psSim->au8Sink[(psSim->u32SinkHead + psSim->u32SinkCnt) % UART_LINE_SIZE] = psSim->u8TxShift;
+        if(psSim->u32SinkCnt < UART_LINE_SIZE)
+        {
+            psSim->u32SinkCnt++;
+        }
+        else
+        {
+            psSim->u32SinkHead = (psSim->u32SinkHead + 1UL) % UART_LINE_SIZE;
+        }
+        psSim->u64TxCount++;
+
+        if(psSim->u32Loopback)
+        {
+            UartSim_RxPush(u32Inst, psSim->u8TxShift, psSim->u64TxDone);
+        }
+
+        psSim->u32Shifting = 0UL;
+        UartSim_StartTx(u32Inst, psSim->u64TxDone);
+    }
+
+    while(psSim->u32InjCnt && (psSim->u64InjNext <= u64Now))
+    {
+        UartSim_RxPush(u32Inst, psSim->au16Inject[psSim->u32InjHead], psSim->u64InjNext);
+        psSim->u32InjHead = (psSim->u32InjHead + 1UL) % UART_LINE_SIZE;
+        psSim->u32InjCnt--;
+        psSim->u64InjNext += UartSim_CharTime(u32Inst);
+    }
+
+    u64Tout = UartSim_ToutTime(u32Inst);
+    if(u64Tout <= u64Now)
+    {
+        psSim->u32RxTout = 1UL;
+    }
+
+    UartSim_Refresh(u32Inst);
+}
+
+static uint64_t UartSim_NextEvent(uint32_t u32Inst)
+{
+    UART_SIM_T *psSim = &s_asUart[u32Inst];
+    uint64_t u64Next = HOSTSIM_NEVER, u64Tout;
+
+    if(psSim->u32Shifting)
+    {
+        u64Next = psSim->u64TxDone;
+    }
+    if(psSim->u32InjCnt && (psSim->u64InjNext < u64Next))
+    {
+        u64Next = psSim->u64InjNext;
+    }
+    u64Tout = UartSim_ToutTime(u32Inst);
+    if(u64Tout < u64Next)
+    {
+        u64Next = u64Tout;
+    }
+    return u64Next;
+}
+
+static void UartSim_Read(uint32_t u32Inst, uint32_t u32Offset)
+{
+    UART_SIM_T *psSim = &s_asUart[u32Inst];
+    UART_T *uart = UartSim_Regs(u32Inst);
+
+    if(u32Offset == offsetof(UART_T, DAT))
+    {
+        if(psSim->u32RxCnt)
+        {
+            uart->DAT = psSim->au8RxFifo[psSim->u32RxHead];
+            psSim->u32RxHead = (psSim->u32RxHead + 1UL) % UART_FIFO_DEPTH;
+            psSim->u32RxCnt--;
+        }
+        psSim->u32RxTout = 0UL;
+    }
+    UartSim_Refresh(u32Inst);
+}
+
+static void UartSim_Write(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    UART_SIM_T *psSim = &s_asUart[u32Inst];
+    UART_T *uart = UartSim_Regs(u32Inst);
+
+    switch(u32Offset)
+    {
+        case offsetof(UART_T, DAT):
+            if(psSim->u32TxCnt >= UART_FIFO_DEPTH)
+            {
+                psSim->u32StsFlag |= UART_FIFOSTS_TXOVIF_Msk;
+            }
+            else
+            {
+                psSim->au8TxFifo[(psSim->u32TxHead + psSim->u32TxCnt) % UART_FIFO_DEPTH] = (uint8_t)u32New;
+                psSim->u32TxCnt++;
+                UartSim_StartTx(u32Inst, HostSim_Now());
+            }
+            break;
+
+        case offsetof(UART_T, FIFO):
+            if(u32New & UART_FIFO_RXRST_Msk)
+            {
+                psSim->u32RxHead = psSim->u32RxCnt = 0UL;
+                psSim->u32RxTout = 0UL;
+            }
+            if(u32New & UART_FIFO_TXRST_Msk)
+            {
+                psSim->u32TxHead = psSim->u32TxCnt = 0UL;
+            }
+            uart->FIFO = u32New & ~(UART_FIFO_RXRST_Msk | UART_FIFO_TXRST_Msk);
+            break;
+
+        case offsetof(UART_T, FIFOSTS):
+            psSim->u32StsFlag &= ~u32New;
+            break;
+
+        case offsetof(UART_T, INTSTS):
+            if(u32New & UART_INTSTS_RXTOIF_Msk)
+            {
+                psSim->u32RxTout = 0UL;
+            }
+            break;
+
+        default:
+            (void)u32Old;
+            break;
+    }
+    UartSim_Refresh(u32Inst);
+}
+
+static uint32_t UartSim_IrqLevel(uint32_t u32Inst)
+{
+    UART_T *uart = UartSim_Regs(u32Inst);
+
+    return (uart->INTSTS & (UART_INTSTS_RDAINT_Msk | UART_INTSTS_THREINT_Msk | UART_INTSTS_RLSINT_Msk |
+                            UART_INTSTS_RXTOINT_Msk | UART_INTSTS_BUFERRINT_Msk | UART_INTSTS_TXENDINT_Msk)) ? 1UL : 0UL;
+}
+
+static uint32_t UartSim_DmaRequest(uint32_t u32Inst, uint32_t u32ReqSel)
+{
+    UART_SIM_T *psSim = &s_asUart[u32Inst];
+    UART_T *uart = UartSim_Regs(u32Inst);
+    uint32_t u32TxReq = PDMA_UART0_TX + (u32Inst * 2UL);
+
+    if(u32ReqSel == u32TxReq)
+    {
+        return ((uart->INTEN & UART_INTEN_TXPDMAEN_Msk) && (psSim->u32TxCnt < UART_FIFO_DEPTH)) ? 1UL : 0UL;
+    }
+    if(u32ReqSel == (u32TxReq + 1UL))
+    {
+        return ((uart->INTEN & UART_INTEN_RXPDMAEN_Msk) && (psSim->u32RxCnt != 0UL)) ? 1UL : 0UL;
+    }
+    return 0UL;
+}
+
+const HOSTSIM_MODEL_T g_asHostSimUartModel[HOSTSIM_UART_NUM] =
+{
+    {
+        "UART0", UART0_BASE, 0x1000UL, UART02_IRQn, 0UL,
+        UartSim_Reset, UartSim_Read, UartSim_Write, UartSim_Sync, UartSim_NextEvent, UartSim_IrqLevel, UartSim_DmaRequest
+    },
+    {
+        "UART1", UART1_BASE, 0x1000UL, UART13_IRQn, 1UL,
+        UartSim_Reset, UartSim_Read, UartSim_Write, UartSim_Sync, UartSim_NextEvent, UartSim_IrqLevel, UartSim_DmaRequest
+    },
+    {
+        "UART2", UART2_BASE, 0x1000UL, UART02_IRQn, 2UL,
+        UartSim_Reset, UartSim_Read, UartSim_Write, UartSim_Sync, UartSim_NextEvent, UartSim_IrqLevel, UartSim_DmaRequest
+    },
+};
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+/** @addtogroup HOSTSIM_EXPORTED_FUNCTIONS HostSim Exported Functions
+  @{
+*/
+
+/**
+ * @brief       Connect UART TX back to its RX
+ *
+ * @param[in]   u32Port     UART index (0 ~ HOSTSIM_UART_NUM-1)
+ * @param[in]   u32Enable   1: loop transmitted characters back; 0: line RX only sees HostSim_UartInject()
+ *
+ * @return      None
+ */
+void HostSim_UartSetLoopback(uint32_t u32Port, uint32_t u32Enable)
+{
+    if(u32Port < HOSTSIM_UART_NUM)
+    {
+        s_asUart[u32Port].u32Loopback = u32Enable;
+    }
+}
+
+static uint32_t UartSim_Inject(uint32_t u32Port, const uint8_t pu8Buf[], uint32_t u32Len, uint32_t u32Bit8)
+{
+    UART_SIM_T *psSim;
+    uint32_t i;
+
+    if(u32Port >= HOSTSIM_UART_NUM)
+    {
+        return 0UL;
+    }
+    psSim = &s_asUart[u32Port];
+    if(psSim->u32InjCnt == 0UL)
+    {
+        psSim->u64InjNext = HostSim_Now() + UartSim_CharTime(u32Port);
+    }
+    for(i = 0UL; (i < u32Len) && (psSim->u32InjCnt < UART_LINE_SIZE); i++)
+    {
+        psSim->au16Inject[(psSim->u32InjHead + psSim->u32InjCnt) % UART_LINE_SIZE] = (uint16_t)(pu8Buf[i] | u32Bit8);
+        psSim->u32InjCnt++;
+    }
+    return i;
+}
+
+/**
+ * @brief       Send characters to the UART RX line
+ *
+ * @param[in]   u32Port     UART index
+ * @param[in]   pu8Buf      Characters to send
+ * @param[in]   u32Len      Number of characters
+ *
+ * @return      Number of characters queued on the line
+ *
+ * @details     Characters arrive back to back at the configured baud rate.
+ */
+uint32_t HostSim_UartInject(uint32_t u32Port, const uint8_t pu8Buf[], uint32_t u32Len)
+{
+    return UartSim_Inject(u32Port, pu8Buf, u32Len, 0UL);
+}
+
+/**
+ * @brief       Send an RS485 address byte to the UART RX line
+ *
+ * @param[in]   u32Port     UART index
+ * @param[in]   u8Addr      Address, sent with the 9th (parity) bit set
+ *
+ * @return      1 if queued on the line, 0 if the line is full
+ *
+ * @details     In RS485 NMM or AAD mode with UART_ALTCTL_ADDRDEN set it raises ADDRDETF;
+ *              otherwise it arrives as an ordinary character.
+ */
+uint32_t HostSim_UartInjectAddress(uint32_t u32Port, uint8_t u8Addr)
+{
+    return UartSim_Inject(u32Port, &u8Addr, 1UL, UART_CHAR_ADDR);
+}
+
+/**
+ * @brief       Collect characters sent on the UART TX line
+ *
+ * @param[in]   u32Port     UART index
+ * @param[out]  pu8Buf      Buffer for the characters
+ * @param[in]   u32Len      Buffer size
+ *
+ * @return      Number of characters copied
+ */
+uint32_t HostSim_UartTake(uint32_t u32Port, uint8_t pu8Buf[], uint32_t u32Len)
+{
+    UART_SIM_T *psSim;
+    uint32_t i;
+
+    if(u32Port >= HOSTSIM_UART_NUM)
+    {
+        return 0UL;
+    }
+    psSim = &s_asUart[u32Port];
+    for(i = 0UL; (i < u32Len) && psSim->u32SinkCnt; i++)
+    {
+        pu8Buf[i] = psSim->au8Sink[psSim->u32SinkHead];
+        psSim->u32SinkHead = (psSim->u32SinkHead + 1UL) % UART_LINE_SIZE;
+        psSim->u32SinkCnt--;
+    }
+    return i;
+}
+
+/**
+ * @brief       Get number of characters transmitted
+ *
+ * @param[in]   u32Port     UART index
+ *
+ * @return      Characters shifted out since HostSim_Init()
+ */
+uint64_t HostSim_UartGetTxCount(uint32_t u32Port)
+{
+    return (u32Port < HOSTSIM_UART_NUM) ? s_asUart[u32Port].u64TxCount : 0ULL;
+}
+
+/*@}*/ /* end of group HOSTSIM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,352 @@
+/**************************************************************************//**
+ * @file     hostsim_usbd.c
+ * @version  V1.00
+ * @brief    USBD (full-speed device) model of the M031 host simulator
+ *
+ * @note     1 KB packet SRAM at USBD_BUF_BASE, eight endpoints with
+ *           BUFSEG/MXPLD/CFG/CFGP semantics, SETUP/EPEVTn/BUS/VBDET events,
+ *           EPSTS0 transaction status and a 1 ms frame number. The host
+ *           side is driven by HostSim_UsbdSetup(), HostSim_UsbdOut() and
+ *           HostSim_UsbdIn(); each transaction is charged its 12 Mbps bus
+ *           time.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "hostsim_model.h"
+
+#define USBD_SIM_SRAM_SIZE      0x400UL
+#define USBD_SIM_BIT_RATE       12000000UL
+#define USBD_SIM_TOKEN_BITS     102UL       /* SYNC/PID/CRC/EOP, handshake and inter-packet gaps */
+
+/* EPSTS0 transaction status */
+#define USBD_SIM_STS_INACK      0x0UL
+#define USBD_SIM_STS_INNAK      0x1UL
+#define USBD_SIM_STS_OUT0ACK    0x2UL
+#define USBD_SIM_STS_OUT1ACK    0x6UL
+
+static uint32_t s_u32UsbdReady;             /* Endpoint ready bitmap, set by MXPLD writes */
+static uint32_t s_u32UsbdAttached;
+
+static USBD_T *UsbdSim_Regs(void)
+{
+    return (USBD_T *)HostSim_Alias(USBD_BASE);
+}
+
+static uint8_t *UsbdSim_Sram(uint32_t u32Offset)
+{
+    return (uint8_t *)HostSim_Alias(USBD_BUF_BASE + (u32Offset & (USBD_SIM_SRAM_SIZE - 1UL)));
+}
+
+static void UsbdSim_Refresh(void)
+{
+    USBD_T *usbd = UsbdSim_Regs();
+
+    if(usbd->INTSTS & (USBD_INTSTS_SETUP_Msk | (0xFFUL << USBD_INTSTS_EPEVT0_Pos)))
+    {
+        usbd->INTSTS |= USBD_INTSTS_USBIF_Msk;
+    }
+    else
+    {
+        usbd->INTSTS &= ~USBD_INTSTS_USBIF_Msk;
+    }
+    HOSTSIM_SET(usbd->VBUSDET, s_u32UsbdAttached ? USBD_VBUSDET_VBUSDET_Msk : 0UL);
+}
+
+static void UsbdSim_Reset(uint32_t u32Inst)
+{
+    (void)u32Inst;
+    memset(HostSim_Alias(USBD_BASE), 0, 0x1000UL);
+    s_u32UsbdReady = 0UL;
+    UsbdSim_Refresh();
+}
+
+static void UsbdSim_Read(uint32_t u32Inst, uint32_t u32Offset)
+{
+    (void)u32Inst;
+    if(u32Offset == offsetof(USBD_T, FN))
+    {
+        /* One start-of-frame per millisecond */
+        HOSTSIM_SET(UsbdSim_Regs()->FN, (HostSim_Now() / (HostSim_GetHclkFreq() / 1000UL)) & USBD_FN_FN_Msk);
+    }
+    UsbdSim_Refresh();
+}
+
+static void UsbdSim_Write(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    USBD_T *usbd = UsbdSim_Regs();
+    uint32_t u32Ep, u32Reg;
+
+    (void)u32Inst;
+    if(u32Offset == offsetof(USBD_T, INTSTS))
+    {
+        usbd->INTSTS = u32Old & ~u32New;
+        if(u32New & USBD_INTSTS_BUSIF_Msk)
+        {
+            usbd->ATTR &= ~(USBD_ATTR_USBRST_Msk | USBD_ATTR_SUSPEND_Msk | USBD_ATTR_RESUME_Msk | USBD_ATTR_TOUT_Msk);
+        }
+    }
+    else if((u32Offset >= offsetof(USBD_T, EP)) && (u32Offset < (offsetof(USBD_T, EP) + sizeof(usbd->EP))))
+    {
+        u32Ep = (u32Offset - offsetof(USBD_T, EP)) / sizeof(USBD_EP_T);
+        u32Reg = (u32Offset - offsetof(USBD_T, EP)) % sizeof(USBD_EP_T);
+        if(u32Reg == offsetof(USBD_EP_T, MXPLD))
+        {
+            /* Writing MXPLD arms the endpoint for one transaction */
+            s_u32UsbdReady |= (1UL << u32Ep);
+        }
+        else if(u32Reg == offsetof(USBD_EP_T, CFGP))
+        {
+            if(u32New & USBD_CFGP_CLRRDY_Msk)
+            {
+                s_u32UsbdReady &= ~(1UL << u32Ep);
+                usbd->EP[u32Ep].CFGP = u32New & ~USBD_CFGP_CLRRDY_Msk;
+            }
+        }
+        else if(u32Reg == offsetof(USBD_EP_T, CFG))
+        {
+            if(u32New & USBD_CFG_CSTALL_Msk)
+            {
+                usbd->EP[u32Ep].CFGP &= ~USBD_CFGP_SSTALL_Msk;
+                usbd->EP[u32Ep].CFG = u32New & ~USBD_CFG_CSTALL_Msk;
+            }
+        }
+    }
+    UsbdSim_Refresh();
+}
+
+static uint32_t UsbdSim_IrqLevel(uint32_t u32Inst)
+{
+    USBD_T *usbd = UsbdSim_Regs();
+    uint32_t u32Mask = USBD_INTSTS_BUSIF_Msk | USBD_INTSTS_USBIF_Msk | USBD_INTSTS_VBDETIF_Msk |
+                       USBD_INTSTS_NEVWKIF_Msk | USBD_INTSTS_SOFIF_Msk;
+
+    (void)u32Inst;
+    return (usbd->INTSTS & usbd->INTEN & u32Mask) ? 1UL : 0UL;
+}
+
+const HOSTSIM_MODEL_T g_sHostSimUsbdModel =
+{
+    "USBD", USBD_BASE, 0x1000UL, USBD_IRQn, 0UL,
+    UsbdSim_Reset, UsbdSim_Read, UsbdSim_Write, NULL, NULL, UsbdSim_IrqLevel, NULL
+};
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Host side                                                                                               */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint32_t UsbdSim_Online(void)
+{
+    USBD_T *usbd = UsbdSim_Regs();
+
+    return (s_u32UsbdAttached && (usbd->ATTR & USBD_ATTR_USBEN_Msk) && (usbd->ATTR & USBD_ATTR_PHYEN_Msk) &&
+            !(usbd->SE0 & USBD_SE0_SE0_Msk)) ? 1UL : 0UL;
+}
+
+static void UsbdSim_BusTime(uint32_t u32Bytes)
+{
+    uint64_t u64Bits = USBD_SIM_TOKEN_BITS + (8ULL * u32Bytes);
+
+    HostSim_Delay((uint32_t)((u64Bits * HostSim_GetHclkFreq()) / USBD_SIM_BIT_RATE));
+}
+
+static int32_t UsbdSim_FindEp(uint32_t u32EpNum, uint32_t u32State)
+{
+    USBD_T *usbd = UsbdSim_Regs();
+    uint32_t i;
+
+    for(i = 0UL; i < USBD_MAX_EP; i++)
+    {
+        if(((usbd->EP[i].CFG & USBD_CFG_EPNUM_Msk) == (u32EpNum & 0xFUL)) &&
+                ((usbd->EP[i].CFG & USBD_CFG_STATE_Msk) == u32State))
+        {
+            return (int32_t)i;
+        }
+    }
+    return -1;
+}
+
+static void UsbdSim_Event(uint32_t u32Ep, uint32_t u32Sts)
+{
+    USBD_T *usbd = UsbdSim_Regs();
+
+    HOSTSIM_SET(usbd->EPSTS0, (usbd->EPSTS0 & ~(0xFUL << (u32Ep * 4UL))) | (u32Sts << (u32Ep * 4UL)));
+    usbd->INTSTS |= (USBD_INTSTS_EPEVT0_Msk << u32Ep);
+    UsbdSim_Refresh();
+}
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+/** @addtogroup HOSTSIM_EXPORTED_FUNCTIONS HostSim Exported Functions
+  @{
+*/
+
+/**
+ * @brief       Plug or unplug the USB cable
+ *
+ * @param[in]   u32Attach   1: VBUS present; 0: VBUS removed
+ *
+ * @return      None
+ */
+void HostSim_UsbdAttach(uint32_t u32Attach)
+{
+    USBD_T *usbd = UsbdSim_Regs();
+
+    s_u32UsbdAttached = u32Attach ? 1UL : 0UL;
+    usbd->INTSTS |= USBD_INTSTS_VBDETIF_Msk;
+    UsbdSim_Refresh();
+    HostSim_Delay(1UL);
+}
+
+/**
+ * @brief       Drive a USB bus reset
+ *
+ * @return      None
+ */
+void HostSim_UsbdBusReset(void)
+{
+    USBD_T *usbd = UsbdSim_Regs();
+
+    s_u32UsbdReady = 0UL;
+    usbd->ATTR |= USBD_ATTR_USBRST_Msk;
+    usbd->INTSTS |= USBD_INTSTS_BUSIF_Msk;
+    UsbdSim_Refresh();
+    HostSim_Delay((uint32_t)(HostSim_GetHclkFreq() / 100UL));
+}
+
+/**
+ * @brief       Send a SETUP transaction
+ *
+ * @param[in]   pu8Setup    8-byte setup packet
+ *
+ * @retval      0                   Setup packet acknowledged
+ * @retval      HOSTSIM_USB_NOEP    Device not attached, disabled or driving SE0
+ *
+ * @details     The device IRQ handler runs before this function returns, so the data or status
+ *              stage can follow with HostSim_UsbdIn()/HostSim_UsbdOut() on endpoint 0.
+ */
+int32_t HostSim_UsbdSetup(const uint8_t pu8Setup[8])
+{
+    USBD_T *usbd = UsbdSim_Regs();
+    uint32_t i;
+
+    if(!UsbdSim_Online())
+    {
+        return HOSTSIM_USB_NOEP;
+    }
+    UsbdSim_BusTime(8UL);
+    for(i = 0UL; i < USBD_MAX_EP; i++)
+    {
+        /* A SETUP token clears the protocol stall of the control endpoint */
+        if((usbd->EP[i].CFG & USBD_CFG_EPNUM_Msk) == 0UL)
+        {
+            usbd->EP[i].CFGP &= ~USBD_CFGP_SSTALL_Msk;
+        }
+    }
+    memcpy(UsbdSim_Sram(usbd->STBUFSEG & USBD_STBUFSEG_STBUFSEG_Msk), pu8Setup, 8UL);
+    usbd->INTSTS |= USBD_INTSTS_SETUP_Msk;
+    UsbdSim_Refresh();
+    HostSim_Delay(1UL);
+    return 0;
+}
+
+/**
+ * @brief       Send one OUT data packet
+ *
+ * @param[in]   u32EpAddr   Endpoint number (bit 7 ignored)
+ * @param[in]   pu8Buf      Packet data
+ * @param[in]   u32Len      Packet length, at most the endpoint buffer size
+ *
+ * @return      Bytes accepted, or HOSTSIM_USB_NAK / HOSTSIM_USB_STALL / HOSTSIM_USB_NOEP
+ */
+int32_t HostSim_UsbdOut(uint32_t u32EpAddr, const uint8_t pu8Buf[], uint32_t u32Len)
+{
+    USBD_T *usbd = UsbdSim_Regs();
+    int32_t i32Ep;
+    uint32_t u32Ep, u32Sts;
+
+    i32Ep = UsbdSim_Online() ? UsbdSim_FindEp(u32EpAddr, USBD_CFG_EPMODE_OUT) : -1;
+    if(i32Ep < 0)
+    {
+        return HOSTSIM_USB_NOEP;
+    }
+    u32Ep = (uint32_t)i32Ep;
+
+    UsbdSim_BusTime(u32Len);
+    if(usbd->EP[u32Ep].CFGP & USBD_CFGP_SSTALL_Msk)
+    {
+        return HOSTSIM_USB_STALL;
+    }
+    if(!(s_u32UsbdReady & (1UL << u32Ep)))
+    {
+        return HOSTSIM_USB_NAK;
+    }
+
+    memcpy(UsbdSim_Sram(usbd->EP[u32Ep].BUFSEG & USBD_BUFSEG_BUFSEG_Msk), pu8Buf, u32Len);
+    usbd->EP[u32Ep].MXPLD = u32Len;
+    s_u32UsbdReady &= ~(1UL << u32Ep);
+    u32Sts = (usbd->EP[u32Ep].CFG & USBD_CFG_DSQSYNC_Msk) ? USBD_SIM_STS_OUT1ACK : USBD_SIM_STS_OUT0ACK;
+    usbd->EP[u32Ep].CFG ^= USBD_CFG_DSQSYNC_Msk;
+    UsbdSim_Event(u32Ep, u32Sts);
+    HostSim_Delay(1UL);
+    return (int32_t)u32Len;
+}
+
+/**
+ * @brief       Request one IN data packet
+ *
+ * @param[in]   u32EpAddr   Endpoint number (bit 7 ignored)
+ * @param[out]  pu8Buf      Packet data
+ * @param[in]   u32Len      Buffer size
+ *
+ * @return      Packet length, or HOSTSIM_USB_NAK / HOSTSIM_USB_STALL / HOSTSIM_USB_NOEP
+ */
+int32_t HostSim_UsbdIn(uint32_t u32EpAddr, uint8_t pu8Buf[], uint32_t u32Len)
+{
+    USBD_T *usbd = UsbdSim_Regs();
+    int32_t i32Ep;
+    uint32_t u32Ep, u32Size;
+
+    i32Ep = UsbdSim_Online() ? UsbdSim_FindEp(u32EpAddr, USBD_CFG_EPMODE_IN) : -1;
+    if(i32Ep < 0)
+    {
+        return HOSTSIM_USB_NOEP;
+    }
+    u32Ep = (uint32_t)i32Ep;
+
+    if(usbd->EP[u32Ep].CFGP & USBD_CFGP_SSTALL_Msk)
+    {
+        UsbdSim_BusTime(0UL);
+        return HOSTSIM_USB_STALL;
+    }
+    if(!(s_u32UsbdReady & (1UL << u32Ep)))
+    {
+        UsbdSim_BusTime(0UL);
+        if(usbd->INTEN & USBD_INTEN_INNAKEN_Msk)
+        {
+            UsbdSim_Event(u32Ep, USBD_SIM_STS_INNAK);
+            HostSim_Delay(1UL);
+        }
+        return HOSTSIM_USB_NAK;
+    }
+
+    u32Size = usbd->EP[u32Ep].MXPLD & USBD_MXPLD_MXPLD_Msk;
+    if(u32Size > u32Len)
+    {
+        u32Size = u32Len;
+    }
+    UsbdSim_BusTime(u32Size);
+    memcpy(pu8Buf, UsbdSim_Sram(usbd->EP[u32Ep].BUFSEG & USBD_BUFSEG_BUFSEG_Msk), u32Size);
+    s_u32UsbdReady &= ~(1UL << u32Ep);
+    usbd->EP[u32Ep].CFG ^= USBD_CFG_DSQSYNC_Msk;
+    UsbdSim_Event(u32Ep, USBD_SIM_STS_INACK);
+    HostSim_Delay(1UL);
+    return (int32_t)u32Size;
+}
+
+/*@}*/ /* end of group HOSTSIM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
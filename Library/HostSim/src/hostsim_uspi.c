@@ -0,0 +1,297 @@
+/**************************************************************************//**
+ * @file     hostsim_uspi.c
+ * @version  V1.00
+ * @brief    USCI0 SPI master model of the M031 host simulator
+ *
+ * @note     One-level TX buffer in front of the shifter, two-level RX buffer,
+ *           word timing from USPI_T::BRGEN on PCLK0, TX/RX end flags and PDMA
+ *           request lines. MISO is looped back from MOSI unless a slave
+ *           callback is installed with HostSim_UspiSetSlave().
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "hostsim_model.h"
+
+#define USPI_RX_DEPTH       2UL
+
+typedef struct
+{
+    uint32_t u32TxBuf;
+    uint32_t u32TxFull;
+    uint32_t au32RxBuf[USPI_RX_DEPTH];
+    uint32_t u32RxHead, u32RxCnt;
+    uint32_t u32Shifting;
+    uint32_t u32TxShift;
+    uint64_t u64ShiftDone;
+    uint32_t u32ProtFlag;           /* sticky PROTSTS flags */
+    uint32_t u32BufFlag;            /* sticky BUFSTS flags */
+    uint64_t u64TxCount;
+    HOSTSIM_SPI_SLAVE_T pfnSlave;
+} USPI_SIM_T;
+
+static USPI_SIM_T s_sUspi;
+
+static USPI_T *UspiSim_Regs(void)
+{
+    return (USPI_T *)HostSim_Alias(USCI0_BASE);
+}
+
+static uint32_t UspiSim_Width(void)
+{
+    uint32_t u32Width = (UspiSim_Regs()->LINECTL & USPI_LINECTL_DWIDTH_Msk) >> USPI_LINECTL_DWIDTH_Pos;
+
+    return (u32Width == 0UL) ? 16UL : u32Width;
+}
+
+/* HCLK cycles per SPI clock, in 1/256 units: PCLK0 / (2 x (CLKDIV + 1)) */
+static uint64_t UspiSim_BitTime256(void)
+{
+    uint32_t u32Div = ((UspiSim_Regs()->BRGEN & USPI_BRGEN_CLKDIV_Msk) >> USPI_BRGEN_CLKDIV_Pos) + 1UL;
+
+    return ((uint64_t)HostSim_GetHclkFreq() * 256ULL * 2ULL * u32Div) / HostSim_GetPclkFreq(0UL);
+}
+
+static uint32_t UspiSim_Enabled(void)
+{
+    USPI_T *uspi = UspiSim_Regs();
+
+    return (((uspi->CTL & USPI_CTL_FUNMODE_Msk) >> USPI_CTL_FUNMODE_Pos) == 1UL) &&
+           (uspi->PROTCTL & USPI_PROTCTL_PROTEN_Msk) && !(uspi->PROTCTL & USPI_PROTCTL_SLAVE_Msk);
+}
+
+static void UspiSim_Refresh(void)
+{
+    USPI_T *uspi = UspiSim_Regs();
+    uint32_t u32Buf;
+
+    u32Buf = s_sUspi.u32BufFlag;
+    if(s_sUspi.u32RxCnt == 0UL)
+    {
+        u32Buf |= USPI_BUFSTS_RXEMPTY_Msk;
+    }
+    if(s_sUspi.u32RxCnt >= USPI_RX_DEPTH)
+    {
+        u32Buf |= USPI_BUFSTS_RXFULL_Msk;
+    }
+    u32Buf |= s_sUspi.u32TxFull ? USPI_BUFSTS_TXFULL_Msk : USPI_BUFSTS_TXEMPTY_Msk;
+    uspi->BUFSTS = u32Buf;
+
+    uspi->PROTSTS = s_sUspi.u32ProtFlag | ((s_sUspi.u32Shifting || s_sUspi.u32TxFull) ? USPI_PROTSTS_BUSY_Msk : 0UL);
+}
+
+static void UspiSim_Start(uint64_t u64When)
+{
+    if(s_sUspi.u32Shifting || !s_sUspi.u32TxFull || !UspiSim_Enabled())
+    {
+        return;
+    }
+
+    s_sUspi.u32TxShift = s_sUspi.u32TxBuf;
+    s_sUspi.u32TxFull = 0UL;
+    s_sUspi.u32Shifting = 1UL;
+    s_sUspi.u32ProtFlag |= USPI_PROTSTS_TXSTIF_Msk;
+    s_sUspi.u64ShiftDone = u64When + ((UspiSim_BitTime256() * UspiSim_Width()) / 256ULL) + 1ULL;
+}
+
+static void UspiSim_Reset(uint32_t u32Inst)
+{
+    HOSTSIM_SPI_SLAVE_T pfnSlave = s_sUspi.pfnSlave;
+    USPI_T *uspi = UspiSim_Regs();
+
+    (void)u32Inst;
+    memset(&s_sUspi, 0, sizeof(s_sUspi));
+    s_sUspi.pfnSlave = pfnSlave;
+    memset((void *)uspi, 0, sizeof(USPI_T));
+    UspiSim_Refresh();
+}
+
+static void UspiSim_Sync(uint32_t u32Inst, uint64_t u64Now)
+{
+    uint32_t u32Rx;
+
+    (void)u32Inst;
+    while(s_sUspi.u32Shifting && (s_sUspi.u64ShiftDone <= u64Now))
+    {
+        u32Rx = (s_sUspi.pfnSlave != NULL) ? s_sUspi.pfnSlave(s_sUspi.u32TxShift) : s_sUspi.u32TxShift;
+        if(s_sUspi.u32RxCnt >= USPI_RX_DEPTH)
+        {
+            s_sUspi.u32BufFlag |= USPI_BUFSTS_RXOVIF_Msk;
+        }
+        else
+        {
+            s_sUspi.au32RxBuf[(s_sUspi.u32RxHead + s_sUspi.u32RxCnt) % USPI_RX_DEPTH] = u32Rx & 0xFFFFUL;
+            s_sUspi.u32RxCnt++;
+        }
+        s_sUspi.u32ProtFlag |= USPI_PROTSTS_TXENDIF_Msk | USPI_PROTSTS_RXENDIF_Msk;
+        s_sUspi.u64TxCount++;
+        s_sUspi.u32Shifting = 0UL;
+        UspiSim_Start(s_sUspi.u64ShiftDone);
+    }
+    UspiSim_Refresh();
+}
+
+static uint64_t UspiSim_NextEvent(uint32_t u32Inst)
+{
+    (void)u32Inst;
+    return s_sUspi.u32Shifting ? s_sUspi.u64ShiftDone : HOSTSIM_NEVER;
+}
+
+static void UspiSim_Read(uint32_t u32Inst, uint32_t u32Offset)
+{
+    USPI_T *uspi = UspiSim_Regs();
+
+    (void)u32Inst;
+    if((u32Offset == offsetof(USPI_T, RXDAT)) && s_sUspi.u32RxCnt)
+    {
+        HOSTSIM_SET(uspi->RXDAT, s_sUspi.au32RxBuf[s_sUspi.u32RxHead]);
+        s_sUspi.u32RxHead = (s_sUspi.u32RxHead + 1UL) % USPI_RX_DEPTH;
+        s_sUspi.u32RxCnt--;
+    }
+    UspiSim_Refresh();
+}
+
+static void UspiSim_Write(uint32_t u32Inst, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    USPI_T *uspi = UspiSim_Regs();
+
+    (void)u32Inst;
+    (void)u32Old;
+    switch(u32Offset)
+    {
+        case offsetof(USPI_T, TXDAT):
+            if(!s_sUspi.u32TxFull)
+            {
+                s_sUspi.u32TxBuf = u32New & 0xFFFFUL;
+                s_sUspi.u32TxFull = 1UL;
+            }
+            uspi->TXDAT = 0UL;
+            UspiSim_Start(HostSim_Now());
+            break;
+
+        case offsetof(USPI_T, CTL):
+        case offsetof(USPI_T, PROTCTL):
+            UspiSim_Start(HostSim_Now());
+            break;
+
+        case offsetof(USPI_T, BUFCTL):
+            if(u32New & (USPI_BUFCTL_RXCLR_Msk | USPI_BUFCTL_RXRST_Msk))
+            {
+                s_sUspi.u32RxHead = s_sUspi.u32RxCnt = 0UL;
+            }
+            if(u32New & (USPI_BUFCTL_TXCLR_Msk | USPI_BUFCTL_TXRST_Msk))
+            {
+                s_sUspi.u32TxFull = 0UL;
+            }
+            uspi->BUFCTL = u32New & ~(USPI_BUFCTL_RXCLR_Msk | USPI_BUFCTL_TXCLR_Msk |
+                                      USPI_BUFCTL_RXRST_Msk | USPI_BUFCTL_TXRST_Msk);
+            break;
+
+        case offsetof(USPI_T, BUFSTS):
+            s_sUspi.u32BufFlag &= ~(u32New & (USPI_BUFSTS_RXOVIF_Msk | USPI_BUFSTS_TXUDRIF_Msk));
+            break;
+
+        case offsetof(USPI_T, PROTSTS):
+            s_sUspi.u32ProtFlag &= ~u32New;
+            break;
+
+        case offsetof(USPI_T, PDMACTL):
+            if(u32New & USPI_PDMACTL_PDMARST_Msk)
+            {
+                uspi->PDMACTL = 0UL;
+            }
+            break;
+
+        default:
+            break;
+    }
+    UspiSim_Refresh();
+}
+
+static uint32_t UspiSim_IrqLevel(uint32_t u32Inst)
+{
+    USPI_T *uspi = UspiSim_Regs();
+    uint32_t u32Sts = uspi->PROTSTS;
+
+    (void)u32Inst;
+    if((uspi->INTEN & USPI_INTEN_TXSTIEN_Msk) && (u32Sts & USPI_PROTSTS_TXSTIF_Msk))
+    {
+        return 1UL;
+    }
+    if((uspi->INTEN & USPI_INTEN_TXENDIEN_Msk) && (u32Sts & USPI_PROTSTS_TXENDIF_Msk))
+    {
+        return 1UL;
+    }
+    if((uspi->INTEN & USPI_INTEN_RXENDIEN_Msk) && (u32Sts & USPI_PROTSTS_RXENDIF_Msk))
+    {
+        return 1UL;
+    }
+    if((uspi->BUFCTL & USPI_BUFCTL_RXOVIEN_Msk) && (uspi->BUFSTS & USPI_BUFSTS_RXOVIF_Msk))
+    {
+        return 1UL;
+    }
+    return 0UL;
+}
+
+static uint32_t UspiSim_DmaRequest(uint32_t u32Inst, uint32_t u32ReqSel)
+{
+    USPI_T *uspi = UspiSim_Regs();
+
+    (void)u32Inst;
+    if(!(uspi->PDMACTL & USPI_PDMACTL_PDMAEN_Msk))
+    {
+        return 0UL;
+    }
+    if(u32ReqSel == PDMA_USCI0_TX)
+    {
+        return ((uspi->PDMACTL & USPI_PDMACTL_TXPDMAEN_Msk) && !s_sUspi.u32TxFull) ? 1UL : 0UL;
+    }
+    if(u32ReqSel == PDMA_USCI0_RX)
+    {
+        return ((uspi->PDMACTL & USPI_PDMACTL_RXPDMAEN_Msk) && s_sUspi.u32RxCnt) ? 1UL : 0UL;
+    }
+    return 0UL;
+}
+
+const HOSTSIM_MODEL_T g_sHostSimUspiModel =
+{
+    "USCI0", USCI0_BASE, 0x1000UL, USCI01_IRQn, 0UL,
+    UspiSim_Reset, UspiSim_Read, UspiSim_Write, UspiSim_Sync, UspiSim_NextEvent, UspiSim_IrqLevel, UspiSim_DmaRequest
+};
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+/** @addtogroup HOSTSIM_EXPORTED_FUNCTIONS HostSim Exported Functions
+  @{
+*/
+
+/**
+ * @brief       Attach a USCI0 SPI slave model
+ *
+ * @param[in]   pfnSlave    Called once per word with the MOSI data, returns MISO data.
+ *                          NULL loops MOSI back to MISO.
+ *
+ * @return      None
+ */
+void HostSim_UspiSetSlave(HOSTSIM_SPI_SLAVE_T pfnSlave)
+{
+    s_sUspi.pfnSlave = pfnSlave;
+}
+
+/**
+ * @brief       Get number of USCI0 SPI words transferred
+ *
+ * @return      Words shifted since HostSim_Init()
+ */
+uint64_t HostSim_UspiGetTxCount(void)
+{
+    return s_sUspi.u64TxCount;
+}
+
+/*@}*/ /* end of group HOSTSIM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,458 @@
+/**************************************************************************//**
+ * @file     HostLCD.c
+ * @version  V1.00
+ * @brief    lcm.h port for host builds: an ILI9341 controller model in memory
+ *
+ * @note     Commands and data are decoded the way the ILI9341 on the NuMaker
+ *           board takes them over 4-wire SPI: CASET/PASET windows, RAMWR and
+ *           RAMWRC memory writes, RAMRD and RAMRDC reads with their dummy
+ *           byte, MADCTL address mapping and COLMOD 16/18 bpp. The memory is
+ *           kept in the native 240x320 orientation and starts black, so a
+ *           MADCTL change between frames remaps what is already there. Every
+ *           byte is counted as it would go over the bus; HostLCD_GetStat()
+ *           turns the count into bus time at the SPI clock.
+ *           Build it instead of ILI9341.c, with GUI_X_Delay() from the host.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "GUI.h"
+
+#include "lcm.h"
+#include "HostLCD.h"
+
+//
+// Controller commands
+//
+#define CMD_SWRESET 0x01
+#define CMD_CASET   0x2A
+#define CMD_PASET   0x2B
+#define CMD_RAMWR   0x2C
+#define CMD_RAMRD   0x2E
+#define CMD_MADCTL  0x36
+#define CMD_COLMOD  0x3A
+#define CMD_RAMWRC  0x3C
+#define CMD_RAMRDC  0x3E
+
+#define MADCTL_MY   0x80
+#define MADCTL_MX   0x40
+#define MADCTL_MV   0x20
+#define MADCTL_BGR  0x08
+
+static uint16_t s_au16Mem[HOSTLCD_YSIZE][HOSTLCD_XSIZE];
+static uint8_t s_u8Cmd;             /* Last command */
+static uint32_t s_u32NumParas;      /* Data bytes received for s_u8Cmd */
+static uint8_t s_u8Madctl;
+static uint8_t s_u8Colmod;
+static uint16_t s_au16Win[4];       /* Column start/end, page start/end */
+static uint16_t s_au16Para[2];      /* CASET/PASET parameters being received */
+static uint32_t s_u32Col, s_u32Page;    /* Memory pointer */
+static uint8_t s_au8Pixel[3];       /* Bytes of the pixel being written */
+static uint32_t s_u32PixelByte;     /* Bytes of the pixel read or written so far, 3 + dummy for reads */
+static uint16_t s_u16ReadPixel;
+static uint32_t s_u32SpiClock = HOSTLCD_SPI_CLOCK;
+static HOSTLCD_STAT_T s_sStat;
+
+/*********************************************************************
+*
+*       _Reset
+*/
+static void _Reset(void)
+{
+    s_u8Madctl = 0x00;
+    s_u8Colmod = 0x66;
+    s_au16Win[0] = 0;
+    s_au16Win[1] = HOSTLCD_XSIZE - 1;
+    s_au16Win[2] = 0;
+    s_au16Win[3] = HOSTLCD_YSIZE - 1;
+}
+
+/*********************************************************************
+*
+*       _MapPixel
+*
+* Purpose:
+*   Finds the memory cell of column c, page p under the current MADCTL.
+*   Returns NULL outside of the memory.
+*/
+static uint16_t *_MapPixel(uint32_t c, uint32_t p)
+{
+    uint32_t cMax;
+    uint32_t pMax;
+
+    cMax = ((s_u8Madctl & MADCTL_MV) ? HOSTLCD_YSIZE : HOSTLCD_XSIZE) - 1;
+    pMax = ((s_u8Madctl & MADCTL_MV) ? HOSTLCD_XSIZE : HOSTLCD_YSIZE) - 1;
+    if((c > cMax) || (p > pMax))
+        return NULL;
+    if(s_u8Madctl & MADCTL_MX)
+        c = cMax - c;
+    if(s_u8Madctl & MADCTL_MY)
+        p = pMax - p;
+    return (s_u8Madctl & MADCTL_MV) ? &s_au16Mem[c][p] : &s_au16Mem[p][c];
+}
+
+/*********************************************************************
+*
+*       _NextPixel
+*
+* Purpose:
+*   Advances the memory pointer through the window, wrapping at its end.
+*/
+static void _NextPixel(void)
+{
+    if(++s_u32Col <= s_au16Win[1])
+        return;
+    s_u32Col = s_au16Win[0];
+    if(++s_u32Page > s_au16Win[3])
+        s_u32Page = s_au16Win[2];
+}
+
+/*********************************************************************
+*
+*       _WriteData
+*
+* Purpose:
+*   Takes one byte sent with DC high as parameter or pixel data of the
+*   last command.
+*/
+static void _WriteData(U8 Data)
+{
+    uint16_t *pu16Cell;
+    uint16_t u16Pixel;
+    uint32_t u32NumPara;
+
+    u32NumPara = s_u32NumParas++;
+    switch(s_u8Cmd)
+    {
+        case CMD_CASET:
+        case CMD_PASET:
+            s_sStat.u64ParamBytes++;
+            if(u32NumPara >= 4)
+                break;
+            s_au16Para[u32NumPara >> 1] = (u32NumPara & 1) ? (s_au16Para[u32NumPara >> 1] | Data) : (Data << 8);
+            if(u32NumPara == 3)
+                memcpy(&s_au16Win[(s_u8Cmd == CMD_CASET) ? 0 : 2], s_au16Para, sizeof(s_au16Para));
+            break;
+        case CMD_MADCTL:
+            s_sStat.u64ParamBytes++;
+            if(u32NumPara == 0)
+                s_u8Madctl = Data;
+            break;
+        case CMD_COLMOD:
+            s_sStat.u64ParamBytes++;
+            if(u32NumPara == 0)
+                s_u8Colmod = Data;
+            break;
+        case CMD_RAMWR:
+        case CMD_RAMWRC:
+            s_sStat.u64PixelBytes++;
+            s_au8Pixel[s_u32PixelByte++] = Data;
+            if(((s_u8Colmod & 0x07) == 0x05) && (s_u32PixelByte == 2))
+                u16Pixel = (uint16_t)((s_au8Pixel[0] << 8) | s_au8Pixel[1]);
+            else if(s_u32PixelByte == 3)
+                u16Pixel = (uint16_t)(((s_au8Pixel[0] >> 3) << 11) | ((s_au8Pixel[1] >> 2) << 5) | (s_au8Pixel[2] >> 3));
+            else
+                break;
+            s_u32PixelByte = 0;
+            s_sStat.u64Pixels++;
+            pu16Cell = _MapPixel(s_u32Col, s_u32Page);
+            if(pu16Cell != NULL)
+            {
+                if(*pu16Cell == u16Pixel)
+                    s_sStat.u64Unchanged++;
+                *pu16Cell = u16Pixel;
+            }
+            _NextPixel();
+            break;
+        default:
+            s_sStat.u64ParamBytes++;
+            break;
+    }
+}
+
+/*********************************************************************
+*
+*       _ReadData
+*
+* Purpose:
+*   Returns the next byte clocked in. Memory reads start with a dummy
+*   byte and return 18 bpp, one byte per color, whatever COLMOD says.
+*/
+static U8 _ReadData(void)
+{
+    uint16_t *pu16Cell;
+    U8 Data;
+
+    s_sStat.u64ReadBytes++;
+    if((s_u8Cmd != CMD_RAMRD) && (s_u8Cmd != CMD_RAMRDC))
+        return 0;
+    if(s_u32PixelByte == 0)
+    {
+        s_u32PixelByte = 1;
+        return 0;
+    }
+    if(s_u32PixelByte == 1)
+    {
+        pu16Cell = _MapPixel(s_u32Col, s_u32Page);
+        s_u16ReadPixel = (pu16Cell != NULL) ? *pu16Cell : 0;
+        _NextPixel();
+    }
+    switch(s_u32PixelByte)
+    {
+        case 1:
+            Data = (U8)(((s_u16ReadPixel >> 11) << 3) | ((s_u16ReadPixel >> 13) & 0x04));
+            break;
+        case 2:
+            Data = (U8)(((s_u16ReadPixel >> 5) & 0x3F) << 2);
+            break;
+        default:
+            Data = (U8)((s_u16ReadPixel << 3) | ((s_u16ReadPixel >> 2) & 0x04));
+            break;
+    }
+    s_u32PixelByte = (s_u32PixelByte == 3) ? 1 : (s_u32PixelByte + 1);
+    return Data;
+}
+
+/*********************************************************************
+*
+*       _WaitM1
+*
+* Purpose:
+*   Nothing is left on the bus, every call completes at once
+*/
+void _WaitM1(void)
+{
+}
+
+/*********************************************************************
+*
+*       _Read1
+*/
+U8 _Read1(void)
+{
+    s_sStat.u64Transfers++;
+    return _ReadData();
+}
+
+/*********************************************************************
+*
+*       _ReadM1
+*/
+void _ReadM1(U8 * pData, int NumItems)
+{
+    s_sStat.u64Transfers++;
+    while(NumItems-- > 0)
+        *pData++ = _ReadData();
+}
+
+/*********************************************************************
+*
+*       _Write0
+*/
+void _Write0(U8 Cmd)
+{
+    s_sStat.u64Transfers++;
+    s_sStat.u64CmdBytes++;
+
+    s_u8Cmd = Cmd;
+    s_u32NumParas = 0;
+    switch(Cmd)
+    {
+        case CMD_SWRESET:
+            _Reset();
+            break;
+        case CMD_RAMWR:
+        case CMD_RAMRD:
+            s_u32Col = s_au16Win[0];
+            s_u32Page = s_au16Win[2];
+            s_u32PixelByte = 0;
+            break;
+        case CMD_RAMWRC:
+        case CMD_RAMRDC:
+            s_u32PixelByte = 0;
+            break;
+    }
+}
+
+/*********************************************************************
+*
+*       _Write1
+*/
+void _Write1(U8 Data)
+{
+    s_sStat.u64Transfers++;
+    _WriteData(Data);
+}
+
+/*********************************************************************
+*
+*       _WriteM1
+*/
+void _WriteM1(U8 * pData, int NumItems)
+{
+    s_sStat.u64Transfers++;
+    while(NumItems-- > 0)
+        _WriteData(*pData++);
+}
+
+/*********************************************************************
+*
+*       _InitController
+*
+* Purpose:
+*   Sends the initial sequence of the ILI9341 port, so it is counted
+*   and leaves the controller in the same address mode
+*/
+void _InitController(void)
+{
+    static const U8 s_au8Init[] =
+    {
+        /* Command, number of parameters, parameters */
+        0xCF, 3, 0x00, 0xD9, 0x30,
+        0xED, 4, 0x64, 0x03, 0x12, 0x81,
+        0xE8, 3, 0x85, 0x10, 0x78,
+        0xCB, 5, 0x39, 0x2C, 0x00, 0x34, 0x02,
+        0xF7, 1, 0x20,
+        0xEA, 2, 0x00, 0x00,
+        0xC0, 1, 0x21,      /* Power control */
+        0xC1, 1, 0x12,      /* Power control */
+        0xC5, 2, 0x32, 0x3C,/* VCM control */
+        0xC7, 1, 0xC1,      /* VCM control2 */
+        0x36, 1, 0xE8,      /* Memory Access Control */
+        0x3A, 1, 0x55,
+        0xB1, 2, 0x00, 0x18,
+        0xB6, 2, 0x0A, 0xA2,/* Display Function Control */
+        0xF2, 1, 0x00,      /* 3Gamma Function Disable */
+        0x26, 1, 0x01,      /* Gamma curve selected */
+        0xE0, 15, 0x0F, 0x20, 0x1E, 0x09, 0x12, 0x0B, 0x50, 0xBA, 0x44, 0x09, 0x14, 0x05, 0x23, 0x21, 0x00,
+        0xE1, 15, 0x00, 0x19, 0x19, 0x00, 0x12, 0x07, 0x2D, 0x28, 0x3F, 0x02, 0x0A, 0x08, 0x25, 0x2D, 0x0F,
+    };
+    static uint8_t s_InitOnce = 0;
+    uint32_t i, n;
+
+    if(s_InitOnce == 0)
+        s_InitOnce = 1;
+    else
+        return;
+
+    _Reset();
+
+    /* Hardware reset */
+    GUI_X_Delay(20);
+    GUI_X_Delay(40);
+
+    for(i = 0; i < sizeof(s_au8Init); i += n + 2)
+    {
+        n = s_au8Init[i + 1];
+        _Write0(s_au8Init[i]);
+        _WriteM1((U8 *)&s_au8Init[i + 2], n);
+    }
+
+    _Write0(0x11);    //Exit Sleep
+    GUI_X_Delay(120);
+    _Write0(0x29);    //Display on
+}
+
+/*********************************************************************
+*
+*       HostLCD_SetSpiClock
+*/
+void HostLCD_SetSpiClock(uint32_t u32Hz)
+{
+    s_u32SpiClock = u32Hz;
+}
+
+/*********************************************************************
+*
+*       HostLCD_ClearStat
+*/
+void HostLCD_ClearStat(void)
+{
+    memset(&s_sStat, 0, sizeof(s_sStat));
+}
+
+/*********************************************************************
+*
+*       HostLCD_GetStat
+*/
+void HostLCD_GetStat(HOSTLCD_STAT_T *psStat)
+{
+    uint64_t u64Bytes;
+
+    u64Bytes = s_sStat.u64CmdBytes + s_sStat.u64ParamBytes + s_sStat.u64PixelBytes + s_sStat.u64ReadBytes;
+    s_sStat.u64BusNs = u64Bytes * 8ULL * 1000000000ULL / s_u32SpiClock;
+    *psStat = s_sStat;
+}
+
+/*********************************************************************
+*
+*       HostLCD_GetSize
+*
+* Purpose:
+*   Columns and pages of the memory under the current MADCTL
+*/
+void HostLCD_GetSize(uint32_t *pu32XSize, uint32_t *pu32YSize)
+{
+    *pu32XSize = (s_u8Madctl & MADCTL_MV) ? HOSTLCD_YSIZE : HOSTLCD_XSIZE;
+    *pu32YSize = (s_u8Madctl & MADCTL_MV) ? HOSTLCD_XSIZE : HOSTLCD_YSIZE;
+}
+
+/*********************************************************************
+*
+*       HostLCD_GetPixel
+*
+* Purpose:
+*   Returns the 16 bpp value written at column u32X, page u32Y under
+*   the current MADCTL, -1 outside of the memory
+*/
+int32_t HostLCD_GetPixel(uint32_t u32X, uint32_t u32Y)
+{
+    uint16_t *pu16Cell;
+
+    pu16Cell = _MapPixel(u32X, u32Y);
+    return (pu16Cell != NULL) ? *pu16Cell : -1;
+}
+
+/*********************************************************************
+*
+*       HostLCD_WritePPM
+*
+* Purpose:
+*   Saves the memory as a binary PPM, laid out as addressed under the
+*   current MADCTL: what was drawn at column x, page y is at x, y of the
+*   image. The BGR bit selects which end of the 16 bpp value is red.
+*/
+int32_t HostLCD_WritePPM(const char *pcFile)
+{
+    FILE *pFile;
+    uint32_t u32XSize, u32YSize, x, y;
+    uint32_t u32Hi, u32Mid, u32Lo;
+    uint16_t u16Pixel;
+    uint8_t au8Rgb[3];
+
+    pFile = fopen(pcFile, "wb");
+    if(pFile == NULL)
+        return -1;
+
+    HostLCD_GetSize(&u32XSize, &u32YSize);
+    fprintf(pFile, "P6\n%u %u\n255\n", (unsigned)u32XSize, (unsigned)u32YSize);
+    for(y = 0; y < u32YSize; y++)
+    {
+        for(x = 0; x < u32XSize; x++)
+        {
+            u16Pixel = *_MapPixel(x, y);
+            u32Hi = (u16Pixel >> 11) & 0x1F;
+            u32Mid = (u16Pixel >> 5) & 0x3F;
+            u32Lo = u16Pixel & 0x1F;
+            au8Rgb[(s_u8Madctl & MADCTL_BGR) ? 2 : 0] = (uint8_t)((u32Hi << 3) | (u32Hi >> 2));
+            au8Rgb[1] = (uint8_t)((u32Mid << 2) | (u32Mid >> 4));
+            au8Rgb[(s_u8Madctl & MADCTL_BGR) ? 0 : 2] = (uint8_t)((u32Lo << 3) | (u32Lo >> 2));
+            fwrite(au8Rgb, 1, sizeof(au8Rgb), pFile);
+        }
+    }
+    return (fclose(pFile) == 0) ? 0 : -1;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
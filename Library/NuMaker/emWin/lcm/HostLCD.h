@@ -0,0 +1,50 @@
+/****************************************************************
+ *                                                             *
+ * Copyright (c) Nuvoton Technology Corp. All rights reserved. *
+ *                                                              *
+ ****************************************************************/
+
+#ifndef __HOSTLCD_H__
+#define __HOSTLCD_H__
+
+#include <stdint.h>
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+/*
+    HostLCD.c is the lcm.h port for host builds: the same commands and data
+    the ILI9341 port puts on SPI land in a model of the controller memory
+    instead of a panel. The statistics below count what would have crossed
+    the bus since the last HostLCD_ClearStat().
+*/
+#define HOSTLCD_XSIZE       240UL           /* Controller memory, native orientation */
+#define HOSTLCD_YSIZE       320UL
+#define HOSTLCD_SPI_CLOCK   24000000UL      /* USCI0 SPI clock of the NuMaker port */
+
+typedef struct
+{
+    uint64_t u64CmdBytes;       /* Bytes sent with DC low */
+    uint64_t u64ParamBytes;     /* Bytes sent with DC high, memory writes excluded */
+    uint64_t u64PixelBytes;     /* Bytes sent after RAMWR or RAMWRC */
+    uint64_t u64ReadBytes;      /* Bytes clocked in, dummy bytes included */
+    uint64_t u64Pixels;         /* Pixels written to the controller memory */
+    uint64_t u64Unchanged;      /* Pixels written with the value they already had */
+    uint64_t u64Transfers;      /* Chip select cycles, one per port call */
+    uint64_t u64BusNs;          /* Time on the bus for all bytes at the SPI clock */
+} HOSTLCD_STAT_T;
+
+void HostLCD_SetSpiClock(uint32_t u32Hz);
+void HostLCD_ClearStat(void);
+void HostLCD_GetStat(HOSTLCD_STAT_T *psStat);
+void HostLCD_GetSize(uint32_t *pu32XSize, uint32_t *pu32YSize);
+int32_t HostLCD_GetPixel(uint32_t u32X, uint32_t u32Y);
+int32_t HostLCD_WritePPM(const char *pcFile);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  // __HOSTLCD_H__
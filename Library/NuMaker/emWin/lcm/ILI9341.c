@@ -44,6 +44,7 @@ Purpose     : Display controller configuration (single layer)
 
 #include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "GUI.h"
 #include "GUIDRV_FlexColor.h"
@@ -82,7 +83,39 @@ Purpose     : Display controller configuration (single layer)
 
 #define ILI9341_LED     PA6
 
-#define USPI_MASTER_TX_DMA_CH  0
+//
+// _WriteM1 copies the pixels into one of two buffers and leaves the transfer to PDMA, so
+// emWin renders the next line while this one is on the bus. The PDMA interrupt reports the
+// end of the transfer; PDMA_IRQHandler of the application must call PDMA_DispatchIRQ().
+//
+#define LCM_DMA_BUF_SIZE    (320 * 2)   /* One line of 16bpp pixels */
+
+static uint8_t s_au8DmaBuf[2][LCM_DMA_BUF_SIZE];
+static uint32_t s_u32DmaBuf;
+static S_PDMA_XFER_T s_sDmaXfer;
+static uint8_t s_u8DmaCs;               /* Chip select still held for the last transfer */
+
+/*********************************************************************
+*
+*       _WaitM1
+*
+* Purpose:
+*   Waits until the last _WriteM1 has left the bus and releases the chip select
+*/
+void _WaitM1(void)
+{
+    if(s_u8DmaCs == 0)
+        return;
+
+    /* The PDMA interrupt ends the transfer and turns the TX request off */
+    while(SPI_LCD_PORT->PDMACTL & USPI_PDMACTL_TXPDMAEN_Msk);
+
+    /* The last data are still in the shifter */
+    while(USPI_IS_BUSY(SPI_LCD_PORT));
+
+    SPI_CS_SET;
+    s_u8DmaCs = 0;
+}
 
 /*********************************************************************
 *
@@ -94,6 +127,7 @@ U8 _Read1(void)
     /* FIXME if panel supports read back feature */
     return 0;
 #else
+    _WaitM1();
     LCM_DC_SET;
     SPI_CS_CLR;
     USPI_WRITE_TX(SPI_LCD_PORT, 0x00);
@@ -112,6 +146,7 @@ void _ReadM1(U8 * pData, int NumItems)
 #if 1
     /* FIXME if panel supports read back feature */
 #else
+    _WaitM1();
     LCM_DC_SET;
     SPI_CS_CLR;
     while(NumItems--)
@@ -130,6 +165,8 @@ void _ReadM1(U8 * pData, int NumItems)
 */
 void _Write0(U8 Cmd)
 {
+    _WaitM1();
+
     LCM_DC_CLR;
 
     SPI_CS_CLR;
@@ -147,6 +184,8 @@ void _Write0(U8 Cmd)
 */
 void _Write1(U8 Data)
 {
+    _WaitM1();
+
     LCM_DC_SET;
 
     SPI_CS_CLR;
@@ -164,30 +203,42 @@ void _Write1(U8 Data)
 */
 void _WriteM1(U8 * pData, int NumItems)
 {
-    LCM_DC_SET;
+    uint8_t *pu8Buf;
+    int n;
 
-    /* Set transfer count */
-    PDMA_SET_TRANS_CNT(PDMA, USPI_MASTER_TX_DMA_CH, NumItems);
-    /* Set source address */
-    PDMA_SET_SRC_ADDR(PDMA, USPI_MASTER_TX_DMA_CH, (uint32_t)pData++);
-    /* Set basic mode */
-    PDMA->DSCT[USPI_MASTER_TX_DMA_CH].CTL = (PDMA->DSCT[USPI_MASTER_TX_DMA_CH].CTL & ~PDMA_DSCT_CTL_OPMODE_Msk) | PDMA_OP_BASIC;
+    while(NumItems > 0)
+    {
+        n = (NumItems < LCM_DMA_BUF_SIZE) ? NumItems : LCM_DMA_BUF_SIZE;
 
-    SPI_CS_CLR;
+        /* Fill one buffer while the other one is still being sent */
+        pu8Buf = s_au8DmaBuf[s_u32DmaBuf];
+        s_u32DmaBuf ^= 1;
+        memcpy(pu8Buf, pData, n);
+        pData += n;
+        NumItems -= n;
 
-    /* Enable SPI master's PDMA transfer function */
-    USPI_TRIGGER_TX_PDMA(SPI_LCD_PORT);
+        _WaitM1();
 
-    /* Check the PDMA transfer done flag */
-    while((PDMA_GET_TD_STS(PDMA) & (1 << USPI_MASTER_TX_DMA_CH)) == 0);
+        LCM_DC_SET;
 
-    /* Clear the PDMA transfer done flag */
-    PDMA_CLR_TD_FLAG(PDMA, (1 << USPI_MASTER_TX_DMA_CH));
+        SPI_CS_CLR;
 
-    /* Wait TX finish */
-    while(USPI_IS_BUSY(SPI_LCD_PORT));
+        if(USPI_WriteAsync(SPI_LCD_PORT, &s_sDmaXfer, pu8Buf, n) >= 0)
+        {
+            s_u8DmaCs = 1;
+            continue;
+        }
 
-    SPI_CS_SET;
+        /* No PDMA channel free, send by CPU */
+        while(n--)
+        {
+            while(USPI_GET_TX_FULL_FLAG(SPI_LCD_PORT));
+            USPI_WRITE_TX(SPI_LCD_PORT, *pu8Buf++);
+        }
+        while(USPI_IS_BUSY(SPI_LCD_PORT));
+
+        SPI_CS_SET;
+    }
 }
 
 static void _Open_SPI(void)
@@ -223,21 +274,10 @@ static void _Open_PDMA(void)
     /* Reset PDMA module */
     SYS_ResetModule(PDMA_RST);
 
-    /* Enable PDMA channel */
-    PDMA_Open(PDMA, (1 << USPI_MASTER_TX_DMA_CH));
-
-    /* Set transfer width (8 bits) */
-    PDMA->DSCT[USPI_MASTER_TX_DMA_CH].CTL = (PDMA->DSCT[USPI_MASTER_TX_DMA_CH].CTL & ~PDMA_DSCT_CTL_TXWIDTH_Msk) | PDMA_WIDTH_8;
-    /* Set destination address */
-    PDMA_SET_DST_ADDR(PDMA, USPI_MASTER_TX_DMA_CH, (uint32_t)&SPI_LCD_PORT->TXDAT);
-    /* Set source/destination attributes */
-    PDMA->DSCT[USPI_MASTER_TX_DMA_CH].CTL = (PDMA->DSCT[USPI_MASTER_TX_DMA_CH].CTL & ~(PDMA_DSCT_CTL_SAINC_Msk | PDMA_DSCT_CTL_DAINC_Msk)) | (PDMA_SAR_INC | PDMA_DAR_FIX);
-    /* Set request source; set basic mode. */
-    PDMA_SetTransferMode(PDMA, USPI_MASTER_TX_DMA_CH, PDMA_USCI0_TX, FALSE, 0);
-    /* Single request type. SPI only support PDMA single request type. */
-    PDMA_SetBurstType(PDMA, USPI_MASTER_TX_DMA_CH, PDMA_REQ_SINGLE, 0);
-    /* Disable table interrupt */
-    PDMA->DSCT[USPI_MASTER_TX_DMA_CH].CTL |= PDMA_TBINTDIS_DISABLE;
+    /* Each _WriteM1 reserves a channel with USPI_WriteAsync() and is completed in the PDMA interrupt */
+    s_sDmaXfer.pfnCallback = NULL;
+    s_sDmaXfer.pvUserData = NULL;
+    NVIC_EnableIRQ(PDMA_IRQn);
 }
 
 /*********************************************************************
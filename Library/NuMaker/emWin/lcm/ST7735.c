@@ -44,6 +44,7 @@ Purpose     : Display controller configuration (single layer)
 
 #include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "GUI.h"
 #include "GUIDRV_FlexColor.h"
@@ -80,6 +81,40 @@ Purpose     : Display controller configuration (single layer)
 #define LCM_RESET_SET GPIO_LCM_RESET = 1
 #define LCM_RESET_CLR GPIO_LCM_RESET = 0
 
+//
+// _WriteM1 copies the pixels into one of two buffers and leaves the transfer to PDMA, so
+// emWin renders the next line while this one is on the bus. The PDMA interrupt reports the
+// end of the transfer; PDMA_IRQHandler of the application must call PDMA_DispatchIRQ().
+//
+#define LCM_DMA_BUF_SIZE    (160 * 2)   /* One line of 16bpp pixels */
+
+static uint8_t s_au8DmaBuf[2][LCM_DMA_BUF_SIZE];
+static uint32_t s_u32DmaBuf;
+static S_PDMA_XFER_T s_sDmaXfer;
+static uint8_t s_u8DmaCs;               /* Chip select still held for the last transfer */
+
+/*********************************************************************
+*
+*       _WaitM1
+*
+* Purpose:
+*   Waits until the last _WriteM1 has left the bus and releases the chip select
+*/
+void _WaitM1(void)
+{
+    if(s_u8DmaCs == 0)
+        return;
+
+    /* The PDMA interrupt ends the transfer and turns the TX request off */
+    while(SPI_LCD_PORT->PDMACTL & USPI_PDMACTL_TXPDMAEN_Msk);
+
+    /* The last data are still in the shifter */
+    while(USPI_IS_BUSY(SPI_LCD_PORT));
+
+    SPI_CS_SET;
+    s_u8DmaCs = 0;
+}
+
 /*********************************************************************
 *
 *       _Read1
@@ -90,6 +125,7 @@ U8 _Read1(void)
     /* FIXME if panel supports read back feature */
     return 0;
 #else
+    _WaitM1();
     LCM_DC_SET;
     SPI_CS_CLR;
     USPI_WRITE_TX(SPI_LCD_PORT, 0x00);
@@ -108,6 +144,7 @@ void _ReadM1(U8 * pData, int NumItems)
 #if 1
     /* FIXME if panel supports read back feature */
 #else
+    _WaitM1();
     LCM_DC_SET;
     SPI_CS_CLR;
     while(NumItems--)
@@ -126,6 +163,8 @@ void _ReadM1(U8 * pData, int NumItems)
 */
 void _Write0(U8 Cmd)
 {
+    _WaitM1();
+
     LCM_DC_CLR;
 
     SPI_CS_CLR;
@@ -143,6 +182,8 @@ void _Write0(U8 Cmd)
 */
 void _Write1(U8 Data)
 {
+    _WaitM1();
+
     LCM_DC_SET;
 
     SPI_CS_CLR;
@@ -160,18 +201,42 @@ void _Write1(U8 Data)
 */
 void _WriteM1(U8 * pData, int NumItems)
 {
-    LCM_DC_SET;
-
-    SPI_CS_CLR;
+    uint8_t *pu8Buf;
+    int n;
 
-    while(NumItems--)
+    while(NumItems > 0)
     {
-        while(USPI_GET_TX_FULL_FLAG(SPI_LCD_PORT));
-        USPI_WRITE_TX(SPI_LCD_PORT, *pData++);
-        while (USPI_IS_BUSY(SPI_LCD_PORT));
-    }
+        n = (NumItems < LCM_DMA_BUF_SIZE) ? NumItems : LCM_DMA_BUF_SIZE;
 
-    SPI_CS_SET;
+        /* Fill one buffer while the other one is still being sent */
+        pu8Buf = s_au8DmaBuf[s_u32DmaBuf];
+        s_u32DmaBuf ^= 1;
+        memcpy(pu8Buf, pData, n);
+        pData += n;
+        NumItems -= n;
+
+        _WaitM1();
+
+        LCM_DC_SET;
+
+        SPI_CS_CLR;
+
+        if(USPI_WriteAsync(SPI_LCD_PORT, &s_sDmaXfer, pu8Buf, n) >= 0)
+        {
+            s_u8DmaCs = 1;
+            continue;
+        }
+
+        /* No PDMA channel free, send by CPU */
+        while(n--)
+        {
+            while(USPI_GET_TX_FULL_FLAG(SPI_LCD_PORT));
+            USPI_WRITE_TX(SPI_LCD_PORT, *pu8Buf++);
+        }
+        while(USPI_IS_BUSY(SPI_LCD_PORT));
+
+        SPI_CS_SET;
+    }
 }
 
 static void _Open_SPI(void)
@@ -202,6 +267,14 @@ static void _Open_SPI(void)
     USPI_DisableAutoSS(SPI_LCD_PORT);
 }
 
+static void _Open_PDMA(void)
+{
+    /* Each _WriteM1 reserves a channel with USPI_WriteAsync() and is completed in the PDMA interrupt */
+    s_sDmaXfer.pfnCallback = NULL;
+    s_sDmaXfer.pvUserData = NULL;
+    NVIC_EnableIRQ(PDMA_IRQn);
+}
+
 /*********************************************************************
 *
 *       _InitController
@@ -219,6 +292,7 @@ void _InitController(void) {
         return;
 
     _Open_SPI();
+    _Open_PDMA();
 
     LCM_RESET_SET;
     LCM_RESET_CLR;
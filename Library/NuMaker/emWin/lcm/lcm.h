@@ -17,6 +17,7 @@ void _ReadM1(U8 * pData, int NumItems);
 void _Write0(U8 Cmd);
 void _Write1(U8 Data);
 void _WriteM1(U8 * pData, int NumItems);
+void _WaitM1(void);
 void _InitController(void);
 
 #ifdef  __cplusplus
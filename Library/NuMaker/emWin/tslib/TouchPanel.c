@@ -2,16 +2,212 @@
 #include "NuMicro.h"
 
 #include "TouchPanel.h"
+#include "tslib-private.h"
+
+/*
+    One X/Y pair is sampled per scan. The ADC stays open between scans and its
+    interrupt steps through the scan: X conversion, switch the panel drive,
+    Y conversion, publish the pair. The extended sampling time covers the
+    settling of the panel after the drive is switched.
+
+    Start_TouchScan() hands the scan to TP_SCAN_TIMER, whose time-out starts
+    each conversion by the ADC hardware trigger. The drive for the next axis
+    is switched as soon as a conversion ends, so the panel settles during the
+    whole trigger period. Every pair goes through the tslib filter chain and
+    the resulting pen events are queued for Read_TouchEvent().
+*/
+#define TP_STATE_IDLE       0
+#define TP_STATE_X          1
+#define TP_STATE_Y          2
+
+#define TP_SETTLE_ADC_CLKS  255     /* Extended sampling time, ADC clocks */
+
+#define TP_SCAN_TIMER       TIMER1
+#define TP_SCAN_MODULE      TMR1_MODULE
+#define TP_SCAN_CLKSEL      CLK_CLKSEL1_TMR1SEL_HIRC
+#define TP_SCAN_HZ          400     /* Conversions per second, one axis each */
+#define TP_PEN_PRESSURE     1000    /* ts_sample pressure of a pressed sample */
+#define TP_EVENT_NUM        16      /* Queued pen events, power of two */
+
+static volatile    uint32_t    g_u32TpState;
+static volatile    uint32_t    g_u32TpSeq;      /* Pairs completed */
+static volatile    uint16_t    g_u16TpX, g_u16TpY;
+static volatile    uint16_t    g_u16TpScanX;
+static volatile    uint32_t    g_u32TpScanOn;
+
+/* Pen events, written by the ADC interrupt only and read by Read_TouchEvent() only */
+static struct ts_sample g_asTpEvent[TP_EVENT_NUM];
+static volatile    uint32_t    g_u32TpEvtHead, g_u32TpEvtTail;
+static struct ts_sample g_sTpPend, g_sTpQueued;
+static uint32_t g_u32TpPendValid;
+
+static struct tsdev g_sTsDev;
+static struct tslib_module_info g_sTsRaw;
+static uint32_t g_u32TpRawSeq;
+
+/* Drive XR high and XL low, sample YU on ADC CH7 */
+static void _TP_SelectX(void)
+{
+    GPIO_SetMode(PB, BIT4, GPIO_MODE_OUTPUT);   // XR
+    GPIO_SetMode(PB, BIT5, GPIO_MODE_INPUT);    // YD
+    GPIO_SetMode(PB, BIT6, GPIO_MODE_OUTPUT);   // XL
+    PB4 = 1; //XR High
+    PB6 = 0; //XL Low
+
+    SYS->GPB_MFPL &= ~(SYS_GPB_MFPL_PB4MFP_Msk);    // Disable ADC CH4
+    SYS->GPB_MFPL &= ~(SYS_GPB_MFPL_PB7MFP_Msk);    // Enable ADC CH7
+    SYS->GPB_MFPL |= SYS_GPB_MFPL_PB7MFP_ADC0_CH7;  //YU sample
+
+    /* Disable the GPB7 digital input path to avoid the leakage current. */
+    GPIO_DISABLE_DIGITAL_PATH(PB, BIT7);            //YU
+
+    ADC_SET_INPUT_CHANNEL(ADC, BIT7);
+}
 
-static volatile    uint32_t    g_u32AdcIntFlag_TP;
+/* Drive YU high and YD low, sample XR on ADC CH4 */
+static void _TP_SelectY(void)
+{
+    GPIO_SetMode(PB, BIT7, GPIO_MODE_OUTPUT);   // YU
+    GPIO_SetMode(PB, BIT5, GPIO_MODE_OUTPUT);   // YD
+    GPIO_SetMode(PB, BIT6, GPIO_MODE_INPUT);    // XL
+    PB7 = 1;
+    PB5 = 0;
+
+    SYS->GPB_MFPL &= ~(SYS_GPB_MFPL_PB7MFP_Msk);    // Disable ADC CH7
+    SYS->GPB_MFPL &= ~(SYS_GPB_MFPL_PB4MFP_Msk);    // Enable ADC CH4
+    SYS->GPB_MFPL |= SYS_GPB_MFPL_PB4MFP_ADC0_CH4;  //XR
+
+    /* Disable the GPB4 digital input path to avoid the leakage current. */
+    GPIO_DISABLE_DIGITAL_PATH(PB, BIT4);            //XR
+
+    ADC_SET_INPUT_CHANNEL(ADC, BIT4);
+}
+
+/* Copy the last pair, return 0 if the pen is up or no scan has completed yet */
+static int _TP_GetPair(int *x, int *y)
+{
+    uint32_t u32Seq;
+
+    do
+    {
+        u32Seq = g_u32TpSeq;
+        *x = g_u16TpX;
+        *y = g_u16TpY;
+    }
+    while(u32Seq != g_u32TpSeq);
+
+    if((u32Seq == 0) || ((*x & 0x0F00) == 0x0F00) || ((*y & 0x0F00) == 0x0F00))
+        return 0;
+    else
+        return 1;
+}
+
+/* Bottom of the filter chain: the pair just completed, once */
+static int _TP_ReadRaw(struct tslib_module_info *inf, struct ts_sample *samp, int nr)
+{
+    (void)inf;
+
+    if((nr < 1) || (g_u32TpRawSeq == g_u32TpSeq))
+        return 0;
+
+    g_u32TpRawSeq = g_u32TpSeq;
+    samp->pressure = _TP_GetPair(&samp->x, &samp->y) ? TP_PEN_PRESSURE : 0;
+    return 1;
+}
+
+static const struct tslib_ops g_sTsRawOps = { _TP_ReadRaw, NULL };
+
+static int _TP_PutEvent(const struct ts_sample *samp)
+{
+    uint32_t u32Head = g_u32TpEvtHead;
+
+    if((u32Head - g_u32TpEvtTail) >= TP_EVENT_NUM)
+        return 0;
+
+    g_asTpEvent[u32Head % TP_EVENT_NUM] = *samp;
+    __DMB();    /* The event is in place before the consumer can see it */
+    g_u32TpEvtHead = u32Head + 1;
+    return 1;
+}
+
+/*
+    Run the pair through the filter chain and queue what comes out. A pen
+    held still is queued once. If the queue is full the newest sample is
+    kept back and queued on a later pair, so the last pen state always
+    reaches the consumer even when intermediate moves are dropped.
+*/
+static void _TP_Filter(void)
+{
+    struct ts_sample sSamp;
+
+    if(ts_read(&g_sTsDev, &sSamp, 1) == 1)
+    {
+        if((sSamp.x != g_sTpQueued.x) || (sSamp.y != g_sTpQueued.y) || (sSamp.pressure != g_sTpQueued.pressure))
+        {
+            g_sTpPend = sSamp;
+            g_u32TpPendValid = 1;
+        }
+    }
+
+    if(g_u32TpPendValid && _TP_PutEvent(&g_sTpPend))
+    {
+        g_sTpQueued = g_sTpPend;
+        g_u32TpPendValid = 0;
+    }
+}
 
 void ADC_IRQHandler(void)
 {
     /* Clear the A/D ADINT1 interrupt flag */
     ADC_CLR_INT_FLAG(ADC, ADC_ADF_INT);
 
-    g_u32AdcIntFlag_TP = 1;
+    if(g_u32TpState == TP_STATE_X)
+    {
+        g_u16TpScanX = ADC_GET_CONVERSION_DATA(ADC, 7);
+        _TP_SelectY();
+        g_u32TpState = TP_STATE_Y;
+        if(!g_u32TpScanOn)
+            ADC_START_CONV(ADC);
+    }
+    else if(g_u32TpState == TP_STATE_Y)
+    {
+        g_u16TpX = g_u16TpScanX;
+        g_u16TpY = ADC_GET_CONVERSION_DATA(ADC, 4);
+        g_u32TpSeq++;
+        if(g_u32TpScanOn)
+        {
+            _TP_SelectX();
+            g_u32TpState = TP_STATE_X;
+            _TP_Filter();
+        }
+        else
+            g_u32TpState = TP_STATE_IDLE;
+    }
+}
 
+/* Start a scan unless one is running or the timer is scanning */
+static void _TP_StartScan(void)
+{
+    if((g_u32TpState == TP_STATE_IDLE) && !g_u32TpScanOn)
+    {
+        _TP_SelectX();
+        g_u32TpState = TP_STATE_X;
+        ADC_START_CONV(ADC);
+    }
+}
+
+/* Sleep until a scan completes after u32Seq */
+static void _TP_WaitPair(uint32_t u32Seq)
+{
+    /* An interrupt pending under PRIMASK still ends WFI, so the last scan step cannot be missed */
+    __disable_irq();
+    while(g_u32TpSeq == u32Seq)
+    {
+        __WFI();
+        __enable_irq();
+        __disable_irq();
+    }
+    __enable_irq();
 }
 
 int Init_TouchPanel(void)
@@ -22,211 +218,153 @@ int Init_TouchPanel(void)
     /* Peripheral clock source */
     CLK_SetModuleClock(ADC_MODULE, CLK_CLKSEL2_ADCSEL_PCLK1, CLK_CLKDIV0_ADC(1));
 
-    return 1;
-}
-#if 0
-static void _BubbleSort(uint16_t arr[], int len)
-{
-    int i, j, temp;
-    for(i = 0; i < len - 1; ++i)
-        for(j = 0; j < len - 1 - i; ++j)
-            if(arr[j] > arr[j + 1])
-            {
-                temp = arr[j];
-                arr[j] = arr[j + 1];
-                arr[j + 1] = temp;
-            }
-}
-#endif
-static uint16_t _Api_Get_TP_X(void)
-{
-    uint32_t x_adc_in;
-//    uint16_t nNormalizationFactor;
-//    static uint16_t nXBorderMin = Init_MinBorderCaliValue_X;
-//    static uint16_t nXBorderMax = Init_MaxBorderCaliValue_X;
-//    static uint8_t nMaxBorderCaliCnt = 0;
-//    static uint8_t nMinBorderCaliCnt = 0;
-//    static uint16_t nMaxBorderCaliBuffer[5] = {0};
-//    static uint16_t nMinBorderCaliBuffer[5] = {0};
-    /* Init ADC for TP */
     /* Power on ADC module */
     ADC_POWER_ON(ADC);
 
     /* Set input mode as single-end and enable the A/D converter */
     ADC_Open(ADC, ADC_ADCR_DIFFEN_SINGLE_END, ADC_ADCR_ADMD_SINGLE, BIT7);
+    ADC_SetExtendSampleTime(ADC, 0, TP_SETTLE_ADC_CLKS);
 
-    /*=== Get X from ADC input ===*/
-    GPIO_SetMode(PB, BIT4, GPIO_MODE_OUTPUT);   // XR
-    GPIO_SetMode(PB, BIT5, GPIO_MODE_INPUT);   // YD
-    GPIO_SetMode(PB, BIT6, GPIO_MODE_OUTPUT);  // XL
-    PB4 = 1; //XR High
-    PB6 = 0; //XL Low
-
-    /* Configure the GPB7 ADC analog input pins.  */
-    SYS->GPB_MFPL &= ~(SYS_GPB_MFPL_PB4MFP_Msk);    // Disable ADC CH4
-    SYS->GPB_MFPL &= ~(SYS_GPB_MFPL_PB7MFP_Msk);    // Enable ADC CH7
-    SYS->GPB_MFPL |= SYS_GPB_MFPL_PB7MFP_ADC0_CH7;  //YU sample
-
-    /* Disable the GPB7 digital input path to avoid the leakage current. */
-    GPIO_DISABLE_DIGITAL_PATH(PB, BIT7);            //YU
-
-    /* Power on ADC module */
-//    ADC_POWER_ON(ADC);
+    /* Clear the A/D ADINT1 interrupt flag for safe */
+    ADC_CLR_INT_FLAG(ADC, ADC_ADF_INT);
 
     /* Enable the sample module 1 interrupt.  */
     ADC_EnableInt(ADC, ADC_ADF_INT);                //Enable sample module A/D ADINT1 interrupt.
     NVIC_EnableIRQ(ADC_IRQn);
 
-    /* Clear the A/D ADINT1 interrupt flag for safe */
-    ADC_CLR_INT_FLAG(ADC, ADC_ADF_INT);
+    g_u32TpState = TP_STATE_IDLE;
+    g_u32TpSeq = 0;
 
-    /* Reset the ADC interrupt indicator and trigger sample module 1 to start A/D conversion */
-    g_u32AdcIntFlag_TP = 0;
-    ADC_START_CONV(ADC);
+    return 1;
+}
 
-    /* Wait ADC interrupt (g_u32AdcIntFlag_TP will be set at IRQ_Handler function) */
-    while(g_u32AdcIntFlag_TP == 0);
-    x_adc_in = ADC_GET_CONVERSION_DATA(ADC, 7);
+/*
+    Never waits: returns the pair of the last completed scan and starts the
+    next one (the timer starts it while Start_TouchScan() is in effect), so
+    the result is one poll old. Safe to call from an interrupt
+    handler such as the one running GUI_TOUCH_Exec().
+*/
+int Poll_TouchPanel(int *x, int *y)
+{
+    int i32Down = _TP_GetPair(x, y);
 
-    ADC_Close(ADC);
-#if 0
-    //Normalization
-    if(x_adc_in <= ReportThreshold)
-    {
-        //Dymanic Border Calibration
-        if(x_adc_in > nXBorderMax)
-        {
-            nMaxBorderCaliBuffer[nMaxBorderCaliCnt] = x_adc_in;
-            nMaxBorderCaliCnt++;
-            if(nMaxBorderCaliCnt == 5)
-            {
-                _BubbleSort(nMaxBorderCaliBuffer, 5);
-                nMaxBorderCaliCnt = 0;
-                nXBorderMax = (nMaxBorderCaliBuffer[0] + nMaxBorderCaliBuffer[1]) / 2;
-            }
-        }
-        if(x_adc_in < nXBorderMin)
-        {
-            nMinBorderCaliBuffer[nMinBorderCaliCnt] = x_adc_in;
-            nMinBorderCaliCnt++;
-            if(nMinBorderCaliCnt == 5)
-            {
-                _BubbleSort(nMinBorderCaliBuffer, 5);
-                nMinBorderCaliCnt = 0;
-                nXBorderMin = (nMinBorderCaliBuffer[3] + nMinBorderCaliBuffer[4]) / 2;
-            }
-        }
-        x_adc_in -= nXBorderMin;
-        nNormalizationFactor = (nXBorderMax - nXBorderMin) * 1000 / LCD_Resolution_X;
-        x_adc_in *= 1000;
-        x_adc_in /= nNormalizationFactor;
-    }
-#endif
-    return x_adc_in;
-}
-
-/*-----------------------------------------------*/
-// Get Y Position from Touch Panel (ADC input)
-//
-/*-----------------------------------------------*/
-static uint16_t _Api_Get_TP_Y(void)
-{
-    uint32_t y_adc_in;
-//    uint16_t nNormalizationFactor;
-//    static uint16_t nYBorderMin = Init_MinBorderCaliValue_Y;
-//    static uint16_t nYBorderMax = Init_MaxBorderCaliValue_Y;
-//    static uint8_t nMaxBorderCaliCnt = 0;
-//    static uint8_t nMinBorderCaliCnt = 0;
-//    static uint16_t nMaxBorderCaliBuffer[5] = {0};
-//    static uint16_t nMinBorderCaliBuffer[5] = {0};
-    /* Init ADC for TP */
-    /* Power on ADC module */
-    ADC_POWER_ON(ADC);
+    _TP_StartScan();
 
-    /* Set input mode as single-end and enable the A/D converter */
-    ADC_Open(ADC, ADC_ADCR_DIFFEN_SINGLE_END, ADC_ADCR_ADMD_SINGLE, BIT4);
+    return i32Down;
+}
 
-    /*=== Get Y from ADC input ===*/
-    GPIO_SetMode(PB, BIT7, GPIO_MODE_OUTPUT);   // YU
-    GPIO_SetMode(PB, BIT5, GPIO_MODE_OUTPUT);  // YD
-    GPIO_SetMode(PB, BIT6, GPIO_MODE_INPUT);   // XL
-    PB7 = 1;
-    PB5 = 0;
+/*
+    Returns a pair sampled after the call, sleeping until the scan completes.
+    Must not be called from an interrupt handler at or above the ADC priority.
+*/
+int Read_TouchPanel(int *x, int *y)
+{
+    uint32_t u32Seq;
 
-    /* Configure the GPB4 ADC analog input pins.  */
-    SYS->GPB_MFPL &= ~(SYS_GPB_MFPL_PB7MFP_Msk);    // Disable ADC CH7
-    SYS->GPB_MFPL &= ~(SYS_GPB_MFPL_PB4MFP_Msk);    // Enable ADC CH4
-    SYS->GPB_MFPL |= SYS_GPB_MFPL_PB4MFP_ADC0_CH4;  //XR
+    /* A scan already running may have sampled X before the call */
+    if(g_u32TpState != TP_STATE_IDLE)
+        _TP_WaitPair(g_u32TpSeq);
 
-    /* Disable the GPB4 digital input path to avoid the leakage current. */
-    GPIO_DISABLE_DIGITAL_PATH(PB, BIT4);            //XR
+    u32Seq = g_u32TpSeq;
+    _TP_StartScan();
+    _TP_WaitPair(u32Seq);
 
-    /* Power on ADC module */
-//    ADC_POWER_ON(ADC);
+    return _TP_GetPair(x, y);
+}
 
-    /* Enable the sample module 1 interrupt.  */
-    ADC_EnableInt(ADC, ADC_ADF_INT);    //Enable sample module A/D ADINT1 interrupt.
-    NVIC_EnableIRQ(ADC_IRQn);
+/*
+    Scan in the background from TP_SCAN_TIMER: TP_SCAN_HZ / 2 pairs per
+    second, filtered by debounce, median and linear (ts_phy2log, so after
+    ts_calibrate()). Read_TouchPanel() and Poll_TouchPanel() keep working
+    and return raw pairs.
+*/
+int Start_TouchScan(void)
+{
+    if(g_u32TpScanOn)
+        return 1;
 
-    /* Clear the A/D ADINT1 interrupt flag for safe */
-    ADC_CLR_INT_FLAG(ADC, ADC_ADF_INT);
+    /* A scan already running finishes in software mode */
+    if(g_u32TpState != TP_STATE_IDLE)
+        _TP_WaitPair(g_u32TpSeq);
+
+    g_sTsDev.list = &g_sTsRaw;
+    g_sTsDev.list_raw = &g_sTsRaw;
+    g_sTsRaw.dev = &g_sTsDev;
+    g_sTsRaw.next = NULL;
+    g_sTsRaw.ops = &g_sTsRawOps;
+    if((ts_load_module(&g_sTsDev, "debounce", NULL) != 0) ||
+            (ts_load_module(&g_sTsDev, "median", NULL) != 0) ||
+            (ts_load_module(&g_sTsDev, "linear", NULL) != 0))
+        return 0;
+    g_u32TpRawSeq = g_u32TpSeq;
+    g_u32TpPendValid = 0;
+    g_sTpQueued.x = g_sTpQueued.y = -1;
+    g_sTpQueued.pressure = 0;
+    g_u32TpEvtTail = g_u32TpEvtHead;
+
+    /* The trigger period covers the settling, no extended sampling needed */
+    ADC_SetExtendSampleTime(ADC, 0, 0);
+    ADC_EnableHWTrigger(ADC, ADC_ADCR_TRGS_TIMER, 0);
+
+    CLK_EnableModuleClock(TP_SCAN_MODULE);
+    CLK_SetModuleClock(TP_SCAN_MODULE, TP_SCAN_CLKSEL, 0);
+    TIMER_Open(TP_SCAN_TIMER, TIMER_PERIODIC_MODE, TP_SCAN_HZ);
+    TIMER_SetTriggerSource(TP_SCAN_TIMER, TIMER_TRGSRC_TIMEOUT_EVENT);
+    TIMER_SetTriggerTarget(TP_SCAN_TIMER, TIMER_TRG_TO_ADC);
+
+    _TP_SelectX();
+    g_u32TpState = TP_STATE_X;
+    g_u32TpScanOn = 1;
+    TIMER_Start(TP_SCAN_TIMER);
 
-    /* Reset the ADC interrupt indicator and trigger sample module 2 to start A/D conversion */
-    g_u32AdcIntFlag_TP = 0;
-    ADC_START_CONV(ADC);
+    return 1;
+}
 
-    /* Wait ADC interrupt (g_u32AdcIntFlag_TP will be set at IRQ_Handler function) */
-    while(g_u32AdcIntFlag_TP == 0);
-    y_adc_in = ADC_GET_CONVERSION_DATA(ADC, 4);
-    ADC_Close(ADC);
-#if 0
-    /*=== Calculate the Y ===*/
-    if(y_adc_in <= ReportThreshold)
-    {
-        //Dymanic Border Calibration
-        if(y_adc_in > nYBorderMax)
-        {
-            nMaxBorderCaliBuffer[nMaxBorderCaliCnt] = y_adc_in;
-            nMaxBorderCaliCnt++;
-            if(nMaxBorderCaliCnt == 5)
-            {
-                _BubbleSort(nMaxBorderCaliBuffer, 5);
-                nMaxBorderCaliCnt = 0;
-                nYBorderMax = (nMaxBorderCaliBuffer[0] + nMaxBorderCaliBuffer[1]) / 2;
-            }
-        }
-        if(y_adc_in < nYBorderMin)
-        {
-            nMinBorderCaliBuffer[nMinBorderCaliCnt] = y_adc_in;
-            nMinBorderCaliCnt++;
-            if(nMinBorderCaliCnt == 5)
-            {
-                _BubbleSort(nMinBorderCaliBuffer, 5);
-                nMinBorderCaliCnt = 0;
-                nYBorderMin = (nMinBorderCaliBuffer[3] + nMinBorderCaliBuffer[4]) / 2;
-            }
-        }
-        y_adc_in -= nYBorderMin;
-        nNormalizationFactor = (nYBorderMax - nYBorderMin) * 1000 / LCD_Resolution_Y;
-        y_adc_in *= 1000;
-        y_adc_in /= nNormalizationFactor;
-    }
-#endif
-    return y_adc_in;
+int Stop_TouchScan(void)
+{
+    if(!g_u32TpScanOn)
+        return 1;
+
+    TIMER_Close(TP_SCAN_TIMER);
+    ADC_DisableHWTrigger(ADC);
+
+    /* A conversion still running ends in the idle state */
+    __disable_irq();
+    g_u32TpScanOn = 0;
+    g_u32TpState = TP_STATE_IDLE;
+    __enable_irq();
+
+    ADC_SetExtendSampleTime(ADC, 0, TP_SETTLE_ADC_CLKS);
+
+    return 1;
 }
 
-int Read_TouchPanel(int *x, int *y)
+/*
+    Take the oldest pen event queued by the background scan, in screen
+    coordinates; pressure is 0 for the pen going up. Returns 0 if none is
+    queued. Never waits, one consumer only.
+*/
+int Read_TouchEvent(struct ts_sample *samp)
 {
-    *x = _Api_Get_TP_X();
-    *y = _Api_Get_TP_Y();
-    if(((*x & 0x0F00) == 0x0F00) || ((*y & 0x0F00) == 0x0F00))
+    uint32_t u32Tail = g_u32TpEvtTail;
+
+    if(u32Tail == g_u32TpEvtHead)
         return 0;
-    else
-        return 1;
+
+    __DMB();    /* Read the event after seeing it published */
+    *samp = g_asTpEvent[u32Tail % TP_EVENT_NUM];
+    g_u32TpEvtTail = u32Tail + 1;
+    return 1;
 }
 
 int Uninit_TouchPanel(void)
 {
+    Stop_TouchScan();
+    NVIC_DisableIRQ(ADC_IRQn);
+    ADC_DisableInt(ADC, ADC_ADF_INT);
+    ADC_Close(ADC);
+    g_u32TpState = TP_STATE_IDLE;
+
     return 1;
 }
 
@@ -234,4 +372,3 @@ int Check_TouchPanel(void)
 {
     return 0;   //Pen up;
 }
-
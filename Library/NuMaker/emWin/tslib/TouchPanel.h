@@ -11,8 +11,14 @@
 #define __DEMO_TS_HEIGHT__      240
 #endif
 
+struct ts_sample;
+
 int Init_TouchPanel(void);
 int Read_TouchPanel(int *x, int *y);
+int Poll_TouchPanel(int *x, int *y);
 int Uninit_TouchPanel(void);
 int Check_TouchPanel(void);
+int Start_TouchScan(void);
+int Stop_TouchScan(void);
+int Read_TouchEvent(struct ts_sample *samp);
 #endif
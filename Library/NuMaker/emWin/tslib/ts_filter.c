@@ -0,0 +1,218 @@
+/**************************************************************************//**
+ * @file     ts_filter.c
+ * @version  V1.00
+ * @brief    Touch screen filter modules for the tslib chain
+ *
+ * @note     The modules follow tslib-filter.h: each read() takes samples from
+ *           the next module down the chain, filters them in place and returns
+ *           how many it kept. Modules are static, one instance each, and are
+ *           stacked on a tsdev by ts_load_module() the way tslib loads its
+ *           plugins; the raw module at the bottom is provided by the caller.
+ *           The chain does not allocate or block and can run in an interrupt
+ *           handler.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include "tslib-private.h"
+
+#define TS_MEDIAN_DEPTH     3   /* Pressed samples per median window */
+#define TS_DEBOUNCE_DOWN    3   /* Pressed samples in a row before the pen goes down */
+#define TS_DEBOUNCE_UP      2   /* Released samples in a row before the pen goes up */
+
+extern int ts_phy2log(int *sumx, int *sumy);
+
+/*
+    debounce: the pen goes down after TS_DEBOUNCE_DOWN pressed samples in a
+    row and up after TS_DEBOUNCE_UP released ones. Pressed samples pass while
+    the pen is down; a single released sample is reported when it goes up, at
+    the last pressed position. Everything else is dropped.
+*/
+struct tslib_debounce
+{
+    struct tslib_module_info module;
+    int down;
+    int count;
+    struct ts_sample last;
+};
+
+static int debounce_read(struct tslib_module_info *inf, struct ts_sample *samp, int nr)
+{
+    struct tslib_debounce *d = (struct tslib_debounce *)inf;
+    int ret, i, n = 0;
+
+    ret = inf->next->ops->read(inf->next, samp, nr);
+    for(i = 0; i < ret; i++)
+    {
+        if(samp[i].pressure != 0)
+        {
+            d->last = samp[i];
+            if(!d->down && (++d->count < TS_DEBOUNCE_DOWN))
+                continue;
+            d->down = 1;
+            d->count = 0;
+            samp[n++] = samp[i];
+        }
+        else if(!d->down)
+        {
+            d->count = 0;
+        }
+        else if(++d->count >= TS_DEBOUNCE_UP)
+        {
+            d->down = 0;
+            d->count = 0;
+            samp[n] = d->last;
+            samp[n++].pressure = 0;
+        }
+    }
+    return n;
+}
+
+/*
+    median: x and y of each pressed sample are replaced by the median of the
+    last TS_MEDIAN_DEPTH pressed samples, the first sample of a touch standing
+    for the ones before it. A release takes the last filtered position and
+    starts a new window.
+*/
+struct tslib_median
+{
+    struct tslib_module_info module;
+    int nr;
+    int next;
+    int x[TS_MEDIAN_DEPTH];
+    int y[TS_MEDIAN_DEPTH];
+    int last_x, last_y;
+};
+
+static int median_of(const int *v, int nr)
+{
+    int s[TS_MEDIAN_DEPTH];
+    int i, j, t;
+
+    for(i = 0; i < nr; i++)
+    {
+        t = v[i];
+        for(j = i; (j > 0) && (s[j - 1] > t); j--)
+            s[j] = s[j - 1];
+        s[j] = t;
+    }
+    return s[nr / 2];
+}
+
+static int median_read(struct tslib_module_info *inf, struct ts_sample *samp, int nr)
+{
+    struct tslib_median *m = (struct tslib_median *)inf;
+    int ret, i;
+
+    ret = inf->next->ops->read(inf->next, samp, nr);
+    for(i = 0; i < ret; i++)
+    {
+        if(samp[i].pressure == 0)
+        {
+            if(m->nr)
+            {
+                samp[i].x = m->last_x;
+                samp[i].y = m->last_y;
+            }
+            m->nr = 0;
+            m->next = 0;
+            continue;
+        }
+        if(m->nr == 0)
+        {
+            /* The first sample of a touch fills the window */
+            for(m->nr = 0; m->nr < TS_MEDIAN_DEPTH; m->nr++)
+            {
+                m->x[m->nr] = samp[i].x;
+                m->y[m->nr] = samp[i].y;
+            }
+        }
+        m->x[m->next] = samp[i].x;
+        m->y[m->next] = samp[i].y;
+        m->next = (m->next + 1) % TS_MEDIAN_DEPTH;
+        samp[i].x = m->last_x = median_of(m->x, m->nr);
+        samp[i].y = m->last_y = median_of(m->y, m->nr);
+    }
+    return ret;
+}
+
+/*
+    linear: physical to screen coordinates with the ts_calibrate() result.
+*/
+static int linear_read(struct tslib_module_info *inf, struct ts_sample *samp, int nr)
+{
+    int ret, i;
+
+    ret = inf->next->ops->read(inf->next, samp, nr);
+    for(i = 0; i < ret; i++)
+        ts_phy2log(&samp[i].x, &samp[i].y);
+    return ret;
+}
+
+static const struct tslib_ops debounce_ops = { debounce_read, NULL };
+static const struct tslib_ops median_ops   = { median_read, NULL };
+static const struct tslib_ops linear_ops   = { linear_read, NULL };
+
+static struct tslib_debounce    debounce_info;
+static struct tslib_median      median_info;
+static struct tslib_module_info linear_info;
+
+static const struct
+{
+    const char *name;
+    struct tslib_module_info *info;
+    size_t size;
+    const struct tslib_ops *ops;
+} ts_modules[] =
+{
+    { "debounce", &debounce_info.module, sizeof(debounce_info), &debounce_ops },
+    { "median",   &median_info.module,   sizeof(median_info),   &median_ops },
+    { "linear",   &linear_info,          sizeof(linear_info),   &linear_ops },
+};
+
+/*
+    Stack a module on top of the chain of ts, with its state cleared. The
+    parameter string is not supported, each module uses its built-in setting.
+    Returns -1 for an unknown module or one already in the chain.
+*/
+int ts_load_module(struct tsdev *ts, const char *mod, const char *params)
+{
+    struct tslib_module_info *info, *p;
+    unsigned int i;
+
+    (void)params;
+    for(i = 0; i < sizeof(ts_modules) / sizeof(ts_modules[0]); i++)
+    {
+        if(strcmp(ts_modules[i].name, mod) == 0)
+            break;
+    }
+    if(i == sizeof(ts_modules) / sizeof(ts_modules[0]))
+        return -1;
+
+    info = ts_modules[i].info;
+    for(p = ts->list; p != NULL; p = p->next)
+    {
+        if(p == info)
+            return -1;
+    }
+
+    memset(info, 0, ts_modules[i].size);
+    info->dev = ts;
+    info->ops = ts_modules[i].ops;
+    info->next = ts->list;
+    ts->list = info;
+    return 0;
+}
+
+int ts_read(struct tsdev *ts, struct ts_sample *samp, int nr)
+{
+    return ts->list->ops->read(ts->list, samp, nr);
+}
+
+int ts_read_raw(struct tsdev *ts, struct ts_sample *samp, int nr)
+{
+    return ts->list_raw->ops->read(ts->list_raw, samp, nr);
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
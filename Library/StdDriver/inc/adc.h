@@ -98,10 +98,39 @@ extern "C"
 #define ADC_LESS_THAN          0   /*!< ADC compare condition is "less than the compare value"                  \hideinitializer */
 #define ADC_GREATER_OR_EQUAL   1   /*!< ADC compare condition is "greater than or equal to the compare value"   \hideinitializer */
 
+/*---------------------------------------------------------------------------------------------------------*/
+/* ADC Streaming Constant Definitions                                                                      */
+/*---------------------------------------------------------------------------------------------------------*/
+#define ADC_STREAM_BLK_MAX     16UL    /*!< Maximum number of blocks in a streaming ring    \hideinitializer */
+
 
 
 /*@}*/ /* end of group ADC_EXPORTED_CONSTANTS */
 
+
+/** @addtogroup ADC_EXPORTED_STRUCTS ADC Exported Structs
+  @{
+*/
+
+/**
+  * @details    Continuous ADC to SRAM stream. The application fills the first five members before
+  *             ADC_StreamStart(); the rest is maintained by the driver.
+  */
+typedef struct
+{
+    PDMA_T   *pdma;                     /*!< PDMA controller moving the conversion results */
+    DSCT_T   *psDesc;                   /*!< u32BlkNum descriptor tables inside the PDMA_T::SCATBA window */
+    uint16_t *pu16Buf;                  /*!< Ring storage of u32BlkNum x u32BlkLen samples */
+    uint32_t u32BlkNum;                 /*!< Blocks in the ring, 2 ~ \ref ADC_STREAM_BLK_MAX */
+    uint32_t u32BlkLen;                 /*!< Samples per block, 1 ~ 65536 */
+    uint32_t u32Ch;                     /*!< PDMA channel owned by the stream */
+    volatile uint32_t u32Filled;        /*!< Blocks filled by PDMA, only written by the PDMA interrupt */
+    volatile uint32_t u32Taken;         /*!< Blocks handed back by the application */
+    volatile uint32_t u32Lost;          /*!< Blocks overwritten before the application released them */
+} ADC_STREAM_T;
+
+/*@}*/ /* end of group ADC_EXPORTED_STRUCTS */
+
 /** @addtogroup ADC_EXPORTED_FUNCTIONS ADC Exported Functions
   @{
 */
@@ -365,6 +394,14 @@ extern "C"
   */
 #define ADC_DISABLE_INT ADC_DisableInt
 
+/**
+  * @brief Get number of lost streaming blocks.
+  * @param[in] psStream The pointer of the stream started by ADC_StreamStart()
+  * @return Blocks overwritten by PDMA before the application released them
+  * \hideinitializer
+  */
+#define ADC_STREAM_GET_LOST(psStream) ((psStream)->u32Lost)
+
 
 void ADC_Open(ADC_T *adc,
               uint32_t u32InputMode,
@@ -380,6 +417,10 @@ void ADC_DisableInt(ADC_T *adc, uint32_t u32Mask);
 void ADC_SetExtendSampleTime(ADC_T *adc,
                              uint32_t u32ModuleNum,
                              uint32_t u32ExtendSampleTime);
+int32_t ADC_StreamStart(ADC_T *adc, ADC_STREAM_T *psStream);
+void ADC_StreamStop(ADC_T *adc, ADC_STREAM_T *psStream);
+uint16_t *ADC_StreamGetBlock(ADC_STREAM_T *psStream);
+int32_t ADC_StreamReleaseBlock(ADC_STREAM_T *psStream);
 
 
 /*@}*/ /* end of group ADC_EXPORTED_FUNCTIONS */
@@ -82,9 +82,58 @@ extern "C"
 #define READ_ALLONE_YES         0xA11FFFFFUL    /*!< Check-all-one result is all one.      \hideinitializer */
 #define READ_ALLONE_NOT         0xA1100000UL    /*!< Check-all-one result is not all one.  \hideinitializer */
 #define READ_ALLONE_CMD_FAIL    0xFFFFFFFFUL    /*!< Check-all-one command failed.         \hideinitializer */
+
+/*----------------------------------------------------------------------------------------------------------*/
+/*  A/B update constant definitions                                                                         */
+/*----------------------------------------------------------------------------------------------------------*/
+#define FMC_AB_IDLE             0UL             /*!< No update in progress                 \hideinitializer */
+#define FMC_AB_BUSY             1UL             /*!< Update in progress, call FMC_AB_Poll  \hideinitializer */
+#define FMC_AB_READY            2UL             /*!< Image written and verified            \hideinitializer */
+#define FMC_AB_ERROR            3UL             /*!< Erase, program or verify failed       \hideinitializer */
+
+#define FMC_AB_REC_NEW          0UL             /*!< Bank committed, not booted yet        \hideinitializer */
+#define FMC_AB_REC_TRIAL        1UL             /*!< Bank booted once, not confirmed       \hideinitializer */
+#define FMC_AB_REC_OK           2UL             /*!< Bank confirmed                        \hideinitializer */
+
+#define FMC_AB_REC_SIZE         32UL            /*!< Size of one boot record in bytes      \hideinitializer */
 /*@}*/ /* end of group FMC_EXPORTED_CONSTANTS */
 
 
+/** @addtogroup FMC_EXPORTED_STRUCTS FMC Exported Structs
+  @{
+*/
+
+/**
+  * @details    A/B firmware update. The application fills the members up to au32RecPage
+  *             before FMC_AB_Open(); the rest is maintained by the driver. Both banks are
+  *             page aligned areas of APROM, each holding an image linked at its own base
+  *             and booted through VECMAP. The boot records are appended to one of the two
+  *             record pages; the newest record with a valid CRC selects the bank.
+  */
+typedef struct
+{
+    uint32_t au32Bank[2];               /*!< Base address of bank A and bank B */
+    uint32_t u32BankSize;               /*!< Size of each bank, whole pages */
+    uint32_t au32RecPage[2];            /*!< Two flash pages for the boot records, outside both banks */
+    uint32_t u32Seq;                    /*!< Sequence number of the newest record */
+    uint32_t u32Bank;                   /*!< Bank selected by the newest record */
+    uint32_t u32RecState;               /*!< FMC_AB_REC_* state of the newest record */
+    uint32_t au32Len[2];                /*!< Image length of each bank in bytes, 0 if unknown */
+    uint32_t au32Crc[2];                /*!< CRC32 of each image padded to whole pages with 0xFF */
+    uint32_t u32RecAddr;                /*!< Where the next record goes; at a page boundary the other record page is erased first */
+    uint32_t u32State;                  /*!< FMC_AB_* state of the update */
+    uint32_t u32Step;                   /*!< 0: collect a page, 1: erase it, 2: program it, 3: check the image */
+    uint32_t u32Target;                 /*!< Bank being written */
+    uint32_t u32Done;                   /*!< Bytes of the target bank written, whole pages */
+    uint32_t u32Fill;                   /*!< Bytes in au32Page */
+    uint32_t u32Prog;                   /*!< Bytes of au32Page programmed */
+    uint32_t u32RunCrc;                 /*!< CRC32 of the pages written so far, not inverted */
+    uint32_t au32Page[FMC_FLASH_PAGE_SIZE / 4]; /*!< The page being collected or programmed */
+} FMC_AB_T;
+
+/*@}*/ /* end of group FMC_EXPORTED_STRUCTS */
+
+
 /** @addtogroup FMC_EXPORTED_FUNCTIONS FMC Exported Functions
   @{
 */
@@ -248,7 +297,16 @@ extern int32_t  FMC_WriteConfig(uint32_t u32Config[], uint32_t u32Count);
 extern uint32_t FMC_GetChkSum(uint32_t u32addr, uint32_t u32count);
 extern uint32_t  FMC_CheckAllOne(uint32_t u32addr, uint32_t u32count);
 extern int32_t FMC_WriteMultiple(uint32_t u32Addr, uint32_t pu32Buf[], uint32_t u32Len);
+extern int32_t FMC_WriteVerify(uint32_t u32Addr, uint32_t pu32Buf[], uint32_t u32Len);
 extern int32_t FMC_RemapBank(uint32_t u32BankIdx);
+extern int32_t FMC_AB_Open(FMC_AB_T *psAB);
+extern uint32_t FMC_AB_Select(FMC_AB_T *psAB);
+extern int32_t FMC_AB_Begin(FMC_AB_T *psAB, uint32_t u32Len, uint32_t u32Crc);
+extern uint32_t FMC_AB_Write(FMC_AB_T *psAB, const uint8_t pu8Data[], uint32_t u32Len);
+extern uint32_t FMC_AB_Poll(FMC_AB_T *psAB);
+extern int32_t FMC_AB_Commit(FMC_AB_T *psAB);
+extern int32_t FMC_AB_Confirm(FMC_AB_T *psAB);
+extern int32_t FMC_AB_Rollback(FMC_AB_T *psAB);
 
 /*@}*/ /* end of group FMC_EXPORTED_FUNCTIONS */
 
@@ -122,9 +122,70 @@ extern "C"
 #define PDMA_INT_TEMPTY     0x00000001UL            /*!<Table Empty Interrupt  \hideinitializer */
 #define PDMA_INT_TIMEOUT    0x00000002UL            /*!<Timeout Interrupt \hideinitializer */
 
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Scatter-gather Chain Constant Definitions                                                              */
+/*---------------------------------------------------------------------------------------------------------*/
+#define PDMA_CHAIN_TX       0x00000000UL            /*!<Chain buffers are source, fixed address is destination  \hideinitializer */
+#define PDMA_CHAIN_RX       0x00000001UL            /*!<Fixed address is source, chain buffers are destination  \hideinitializer */
+#define PDMA_CHAIN_RING     0x00000002UL            /*!<Last table links back to the first one  \hideinitializer */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Channel Reservation Constant Definitions                                                               */
+/*---------------------------------------------------------------------------------------------------------*/
+#define PDMA_CH_ANY         0x000001FFUL            /*!<Reserve any channel  \hideinitializer */
+#define PDMA_CH_TOUT        0x00000003UL            /*!<Reserve a channel with timeout counter (channel 0/1)  \hideinitializer */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Channel Callback Event Constant Definitions                                                            */
+/*---------------------------------------------------------------------------------------------------------*/
+#define PDMA_EVENT_DONE     0x00000001UL            /*!<Transfer done  \hideinitializer */
+#define PDMA_EVENT_ABORT    0x00000002UL            /*!<Target abort  \hideinitializer */
+#define PDMA_EVENT_TIMEOUT  0x00000004UL            /*!<Request timeout  \hideinitializer */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Asynchronous Transfer Status Constant Definitions                                                      */
+/*---------------------------------------------------------------------------------------------------------*/
+#define PDMA_XFER_DONE      (0L)                    /*!<Asynchronous transfer completed  \hideinitializer */
+#define PDMA_XFER_BUSY      (1L)                    /*!<Asynchronous transfer in progress  \hideinitializer */
+#define PDMA_XFER_ABORT     (-1L)                   /*!<Asynchronous transfer aborted  \hideinitializer */
+#define PDMA_XFER_NO_CH     (-2L)                   /*!<No free PDMA channel for asynchronous transfer  \hideinitializer */
+
 
 /*@}*/ /* end of group PDMA_EXPORTED_CONSTANTS */
 
+
+/** @addtogroup PDMA_EXPORTED_STRUCTS PDMA Exported Structs
+  @{
+*/
+/**
+  * @details    Channel callback, called from PDMA_DispatchIRQ() with \ref PDMA_EVENT_DONE,
+  *             \ref PDMA_EVENT_ABORT and \ref PDMA_EVENT_TIMEOUT bits in u32Event.
+  */
+typedef void (*PDMA_CALLBACK_T)(uint32_t u32Ch, uint32_t u32Event, void *pvUserData);
+
+/**
+  * @details    Asynchronous transfer completion callback, called from PDMA_DispatchIRQ().
+  *             i32Status is \ref PDMA_XFER_DONE or \ref PDMA_XFER_ABORT.
+  */
+typedef void (*PDMA_XFER_CB_T)(void *pvUserData, int32_t i32Status);
+
+/**
+  * @details    Asynchronous transfer control block. Caller owns the storage and must keep it
+  *             valid until the transfer leaves \ref PDMA_XFER_BUSY.
+  */
+typedef struct
+{
+    PDMA_XFER_CB_T pfnCallback;         /*!< Completion callback, NULL to poll i32Status */
+    void *pvUserData;                   /*!< Argument passed to pfnCallback */
+    volatile uint32_t *pu32ReqCtl;      /*!< Peripheral PDMA request enable register, cleared on completion */
+    uint32_t u32ReqMsk;                 /*!< Peripheral PDMA request enable bits */
+    uint32_t u32Ch;                     /*!< PDMA channel used, set by PDMA_XferStart() */
+    uint32_t u32Count;                  /*!< Transfer count in data items */
+    volatile int32_t i32Status;         /*!< \ref PDMA_XFER_BUSY, \ref PDMA_XFER_DONE or \ref PDMA_XFER_ABORT */
+} S_PDMA_XFER_T;
+
+/*@}*/ /* end of group PDMA_EXPORTED_STRUCTS */
+
 /** @addtogroup PDMA_EXPORTED_FUNCTIONS PDMA Exported Functions
   @{
 */
@@ -340,6 +401,15 @@ void PDMA_SetTimeOut(PDMA_T *pdma, uint32_t u32Ch, uint32_t u32OnOff, uint32_t u
 void PDMA_Trigger(PDMA_T *pdma, uint32_t u32Ch);
 void PDMA_EnableInt(PDMA_T *pdma, uint32_t u32Ch, uint32_t u32Mask);
 void PDMA_DisableInt(PDMA_T *pdma, uint32_t u32Ch, uint32_t u32Mask);
+int32_t PDMA_BuildScatterChain(PDMA_T *pdma, DSCT_T asDesc[], uint32_t au32BufAddr[], uint32_t u32BufNum, uint32_t u32Count, uint32_t u32Ctl, uint32_t u32FixAddr, uint32_t u32Flags);
+void PDMA_StopScatterChain(DSCT_T asDesc[], uint32_t u32DescNum);
+int32_t PDMA_RequestChannel(PDMA_T *pdma, uint32_t u32ChMask);
+void PDMA_ReleaseChannel(PDMA_T *pdma, uint32_t u32Ch);
+void PDMA_SetCallback(PDMA_T *pdma, uint32_t u32Ch, PDMA_CALLBACK_T pfnCallback, void *pvUserData);
+void PDMA_DispatchIRQ(PDMA_T *pdma);
+int32_t PDMA_XferStart(PDMA_T *pdma, S_PDMA_XFER_T *psXfer, uint32_t u32Peripheral, uint32_t u32Width, uint32_t u32SrcAddr, uint32_t u32SrcCtrl, uint32_t u32DstAddr, uint32_t u32DstCtrl, uint32_t u32Count);
+uint32_t PDMA_XferAbort(PDMA_T *pdma, S_PDMA_XFER_T *psXfer);
+uint32_t PDMA_XferGetRemain(PDMA_T *pdma, S_PDMA_XFER_T *psXfer);
 
 
 /*@}*/ /* end of group PDMA_EXPORTED_FUNCTIONS */
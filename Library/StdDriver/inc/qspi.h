@@ -376,6 +376,8 @@ void QSPI_DisableInt(QSPI_T *qspi, uint32_t u32Mask);
 uint32_t QSPI_GetIntFlag(QSPI_T *qspi, uint32_t u32Mask);
 void QSPI_ClearIntFlag(QSPI_T *qspi, uint32_t u32Mask);
 uint32_t QSPI_GetStatus(QSPI_T *qspi, uint32_t u32Mask);
+int32_t QSPI_WriteAsync(QSPI_T *qspi, S_PDMA_XFER_T *psXfer, void *pvTxBuf, uint32_t u32Count);
+int32_t QSPI_ReadAsync(QSPI_T *qspi, S_PDMA_XFER_T *psXfer, void *pvRxBuf, uint32_t u32Count);
 
 
 /*@}*/ /* end of group QSPI_EXPORTED_FUNCTIONS */
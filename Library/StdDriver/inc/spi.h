@@ -517,6 +517,8 @@ void SPI_DisableInt(SPI_T *spi, uint32_t u32Mask);
 uint32_t SPI_GetIntFlag(SPI_T *spi, uint32_t u32Mask);
 void SPI_ClearIntFlag(SPI_T *spi, uint32_t u32Mask);
 uint32_t SPI_GetStatus(SPI_T *spi, uint32_t u32Mask);
+int32_t SPI_WriteAsync(SPI_T *spi, S_PDMA_XFER_T *psXfer, void *pvTxBuf, uint32_t u32Count);
+int32_t SPI_ReadAsync(SPI_T *spi, S_PDMA_XFER_T *psXfer, void *pvRxBuf, uint32_t u32Count);
 
 uint32_t SPII2S_Open(SPI_T *i2s, uint32_t u32MasterSlave, uint32_t u32SampleRate, uint32_t u32WordWidth, uint32_t u32Channels, uint32_t u32DataFormat);
 void SPII2S_Close(SPI_T *i2s);
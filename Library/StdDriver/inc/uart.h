@@ -103,10 +103,48 @@ extern "C"
 #define UART_BAUD_MODE0     (0ul) /*!< Set UART Baudrate Mode is Mode0 \hideinitializer */
 #define UART_BAUD_MODE2     (UART_BAUD_BAUDM1_Msk | UART_BAUD_BAUDM0_Msk) /*!< Set UART Baudrate Mode is Mode2 \hideinitializer */
 
+/*---------------------------------------------------------------------------------------------------------*/
+/* UART buffered driver constants definitions                                                              */
+/*---------------------------------------------------------------------------------------------------------*/
+#define UART_BUF_RX_SEG     (4ul) /*!< PDMA descriptor tables (segments) of the buffered driver receive ring \hideinitializer */
+
 
 /*@}*/ /* end of group UART_EXPORTED_CONSTANTS */
 
 
+/** @addtogroup UART_EXPORTED_STRUCTS UART Exported Structs
+  @{
+*/
+
+typedef void (*UART_BUF_CB_T)(void *pvUserData);    /*!< Receive notification of the buffered driver */
+
+/**
+  * @details    Buffered UART. The application fills the members up to pvUserData before
+  *             UART_BufOpen(); the rest is maintained by the driver. Both ring sizes must be
+  *             a power of two. The receive ring is written by PDMA and is split into
+  *             \ref UART_BUF_RX_SEG segments of at most 65536 bytes.
+  */
+typedef struct
+{
+    uint8_t  *pu8RxBuf;                 /*!< Receive ring storage */
+    uint32_t u32RxSize;                 /*!< Receive ring size, 4 ~ 262144 */
+    uint8_t  *pu8TxBuf;                 /*!< Transmit ring storage */
+    uint32_t u32TxSize;                 /*!< Transmit ring size, 0 if only receive is buffered */
+    DSCT_T   *psRxDesc;                 /*!< \ref UART_BUF_RX_SEG descriptor tables inside the PDMA_T::SCATBA window */
+    UART_BUF_CB_T pfnRxNotify;          /*!< Called from PDMA_DispatchIRQ() when a segment fills or the line goes idle, may be NULL */
+    void     *pvUserData;               /*!< Argument of pfnRxNotify */
+    uint32_t u32RxCh;                   /*!< PDMA channel of the receive ring */
+    volatile uint32_t u32RxDone;        /*!< Receive segments completed, written by the PDMA interrupt only */
+    volatile uint32_t u32RxTail;        /*!< Bytes read by the application */
+    volatile uint32_t u32RxLost;        /*!< Bytes overwritten before the application read them */
+    uint32_t u32RxNotified;             /*!< Receive position of the last notification */
+    volatile uint32_t u32TxHead;        /*!< Bytes queued by the application */
+    volatile uint32_t u32TxTail;        /*!< Bytes moved to the TX FIFO, written by the UART interrupt only */
+} UART_BUF_T;
+
+/*@}*/ /* end of group UART_EXPORTED_STRUCTS */
+
+
 /** @addtogroup UART_EXPORTED_FUNCTIONS UART Exported Functions
   @{
 */
@@ -476,6 +514,14 @@ void UART_SelectIrDAMode(UART_T *uart, uint32_t u32Buadrate, uint32_t u32Directi
 void UART_SelectRS485Mode(UART_T *uart, uint32_t u32Mode, uint32_t u32Addr);
 uint32_t UART_Write(UART_T *uart, uint8_t pu8TxBuf[], uint32_t u32WriteBytes);
 void UART_SelectSingleWireMode(UART_T *uart);
+int32_t UART_WriteAsync(UART_T *uart, S_PDMA_XFER_T *psXfer, uint8_t pu8TxBuf[], uint32_t u32WriteBytes);
+int32_t UART_ReadAsync(UART_T *uart, S_PDMA_XFER_T *psXfer, uint8_t pu8RxBuf[], uint32_t u32ReadBytes);
+int32_t UART_BufOpen(UART_T *uart, UART_BUF_T *psBuf, uint32_t u32IdleTOC);
+void UART_BufClose(UART_T *uart, UART_BUF_T *psBuf);
+uint32_t UART_BufRead(UART_T *uart, UART_BUF_T *psBuf, uint8_t pu8RxBuf[], uint32_t u32ReadBytes);
+uint32_t UART_BufWrite(UART_T *uart, UART_BUF_T *psBuf, uint8_t pu8TxBuf[], uint32_t u32WriteBytes);
+uint32_t UART_BufGetRxCount(UART_T *uart, UART_BUF_T *psBuf);
+void UART_BufIRQHandler(UART_T *uart, UART_BUF_T *psBuf);
 
 
 
@@ -550,16 +550,70 @@ extern const S_USBD_INFO_T gsInfo;
   * @return     None
   *
   * @details    This function will copy the number of data specified by size and src parameters to the address specified by dest parameter.
+  *             When dest and src have the same word alignment, the bulk is moved by word access, four words per loop,
+  *             so a 64-byte packet takes 16 USB SRAM accesses instead of 64. Otherwise it falls back to byte access,
+  *             because Cortex-M0 does not support unaligned word access.
   *
   */
 __STATIC_INLINE void USBD_MemCopy(uint8_t dest[], uint8_t src[], uint32_t size)
 {
-    uint32_t volatile i=0ul;
+    uint8_t volatile *pu8Dest = dest;
+    uint8_t volatile *pu8Src = src;
+    uint32_t volatile *pu32Dest;
+    uint32_t volatile *pu32Src;
 
-    while(size--)
+    if((((uint32_t)dest ^ (uint32_t)src) & 3ul) == 0ul)
     {
-        dest[i] = src[i];
-        i++;
+        while((size != 0ul) && ((uint32_t)pu8Dest & 3ul))
+        {
+            *pu8Dest++ = *pu8Src++;
+            size--;
+        }
+
+        pu32Dest = (uint32_t volatile *)pu8Dest;
+        pu32Src = (uint32_t volatile *)pu8Src;
+
+        while(size >= 16ul)
+        {
+            pu32Dest[0] = pu32Src[0];
+            pu32Dest[1] = pu32Src[1];
+            pu32Dest[2] = pu32Src[2];
+            pu32Dest[3] = pu32Src[3];
+            pu32Dest += 4;
+            pu32Src += 4;
+            size -= 16ul;
+        }
+
+        while(size >= 4ul)
+        {
+            *pu32Dest++ = *pu32Src++;
+            size -= 4ul;
+        }
+
+        pu8Dest = (uint8_t volatile *)pu32Dest;
+        pu8Src = (uint8_t volatile *)pu32Src;
+
+        switch(size)
+        {
+            case 3ul:
+                pu8Dest[2] = pu8Src[2];
+            /* fall through */
+            case 2ul:
+                pu8Dest[1] = pu8Src[1];
+            /* fall through */
+            case 1ul:
+                pu8Dest[0] = pu8Src[0];
+            /* fall through */
+            default:
+                break;
+        }
+    }
+    else
+    {
+        while(size--)
+        {
+            *pu8Dest++ = *pu8Src++;
+        }
     }
 }
 
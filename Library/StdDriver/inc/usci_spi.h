@@ -392,6 +392,8 @@ void USPI_ClearIntFlag(USPI_T *uspi, uint32_t u32Mask);
 uint32_t USPI_GetStatus(USPI_T *uspi, uint32_t u32Mask);
 void USPI_EnableWakeup(USPI_T *uspi);
 void USPI_DisableWakeup(USPI_T *uspi);
+int32_t USPI_WriteAsync(USPI_T *uspi, S_PDMA_XFER_T *psXfer, void *pvTxBuf, uint32_t u32Count);
+int32_t USPI_ReadAsync(USPI_T *uspi, S_PDMA_XFER_T *psXfer, void *pvRxBuf, uint32_t u32Count);
 
 
 /*@}*/ /* end of group USCI_SPI_EXPORTED_FUNCTIONS */
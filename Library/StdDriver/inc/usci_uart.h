@@ -56,10 +56,48 @@ extern "C"
 #define UUART_RXST_INT_MASK     (0x040ul) /*!< RX start interrupt mask \hideinitializer */
 #define UUART_RXEND_INT_MASK    (0x080ul) /*!< RX end interrupt mask \hideinitializer */
 
+/*---------------------------------------------------------------------------------------------------------*/
+/* USCI UART buffered driver constants definitions                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+#define UUART_BUF_RX_SEG        (4ul) /*!< PDMA descriptor tables (segments) of the buffered driver receive ring \hideinitializer */
+
 
 /*@}*/ /* end of group USCI_UART_EXPORTED_CONSTANTS */
 
 
+/** @addtogroup USCI_UART_EXPORTED_STRUCTS USCI_UART Exported Structs
+  @{
+*/
+
+typedef void (*UUART_BUF_CB_T)(void *pvUserData);   /*!< Receive notification of the buffered driver */
+
+/**
+  * @details    Buffered USCI_UART. The application fills the members up to pvUserData before
+  *             UUART_BufOpen(); the rest is maintained by the driver. Both ring sizes must be
+  *             a power of two. The receive ring is written by PDMA and is split into
+  *             \ref UUART_BUF_RX_SEG segments of at most 65536 bytes.
+  */
+typedef struct
+{
+    uint8_t  *pu8RxBuf;                 /*!< Receive ring storage */
+    uint32_t u32RxSize;                 /*!< Receive ring size, 4 ~ 262144 */
+    uint8_t  *pu8TxBuf;                 /*!< Transmit ring storage */
+    uint32_t u32TxSize;                 /*!< Transmit ring size, 0 if only receive is buffered */
+    DSCT_T   *psRxDesc;                 /*!< \ref UUART_BUF_RX_SEG descriptor tables inside the PDMA_T::SCATBA window */
+    UUART_BUF_CB_T pfnRxNotify;         /*!< Called from PDMA_DispatchIRQ() when a segment fills or the line goes idle, may be NULL */
+    void     *pvUserData;               /*!< Argument of pfnRxNotify */
+    uint32_t u32RxCh;                   /*!< PDMA channel of the receive ring */
+    volatile uint32_t u32RxDone;        /*!< Receive segments completed, written by the PDMA interrupt only */
+    volatile uint32_t u32RxTail;        /*!< Bytes read by the application */
+    volatile uint32_t u32RxLost;        /*!< Bytes overwritten before the application read them */
+    uint32_t u32RxNotified;             /*!< Receive position of the last notification */
+    volatile uint32_t u32TxHead;        /*!< Bytes queued by the application */
+    volatile uint32_t u32TxTail;        /*!< Bytes moved to the TX buffer, written by the USCI interrupt only */
+} UUART_BUF_T;
+
+/*@}*/ /* end of group USCI_UART_EXPORTED_STRUCTS */
+
+
 /** @addtogroup USCI_UART_EXPORTED_FUNCTIONS USCI_UART Exported Functions
   @{
 */
@@ -473,6 +511,14 @@ void UUART_EnableWakeup(UUART_T* uuart, uint32_t u32WakeupMode);
 void UUART_DisableWakeup(UUART_T* uuart);
 void UUART_EnableFlowCtrl(UUART_T* uuart);
 void UUART_DisableFlowCtrl(UUART_T* uuart);
+int32_t UUART_WriteAsync(UUART_T *uuart, S_PDMA_XFER_T *psXfer, uint8_t pu8TxBuf[], uint32_t u32WriteBytes);
+int32_t UUART_ReadAsync(UUART_T *uuart, S_PDMA_XFER_T *psXfer, uint8_t pu8RxBuf[], uint32_t u32ReadBytes);
+int32_t UUART_BufOpen(UUART_T *uuart, UUART_BUF_T *psBuf, uint32_t u32IdleTOC);
+void UUART_BufClose(UUART_T *uuart, UUART_BUF_T *psBuf);
+uint32_t UUART_BufRead(UUART_T *uuart, UUART_BUF_T *psBuf, uint8_t pu8RxBuf[], uint32_t u32ReadBytes);
+uint32_t UUART_BufWrite(UUART_T *uuart, UUART_BUF_T *psBuf, uint8_t pu8TxBuf[], uint32_t u32WriteBytes);
+uint32_t UUART_BufGetRxCount(UUART_T *uuart, UUART_BUF_T *psBuf);
+void UUART_BufIRQHandler(UUART_T *uuart, UUART_BUF_T *psBuf);
 
 
 /*@}*/ /* end of group USCI_UART_EXPORTED_FUNCTIONS */
@@ -190,6 +190,130 @@ void ADC_SetExtendSampleTime(ADC_T *adc, uint32_t u32ModuleNum, uint32_t u32Exte
                    (u32ExtendSampleTime << ADC_ESMPCTL_EXTSMPT_Pos);
 }
 
+/* PDMA event of a stream: one table of the ring has been filled */
+static void ADC_StreamEvent(uint32_t u32Ch, uint32_t u32Event, void *pvUserData)
+{
+    ADC_STREAM_T *psStream = (ADC_STREAM_T *)pvUserData;
+
+    (void)u32Ch;
+
+    if(u32Event & PDMA_EVENT_DONE)
+    {
+        psStream->u32Filled++;
+    }
+}
+
+/**
+  * @brief Start streaming conversion results into a ring of blocks.
+  * @param[in] adc The pointer of the specified ADC module.
+  * @param[in,out] psStream The stream. pdma, psDesc, pu16Buf, u32BlkNum and u32BlkLen must be set.
+  * @return PDMA channel used by the stream, or a negative value on failure
+  *         - \ref PDMA_XFER_NO_CH  :No free PDMA channel
+  *         - -1                    :Invalid ring geometry or descriptor tables outside the PDMA_T::SCATBA window
+  * @details The ring is built with PDMA_BuildScatterChain() and armed once, so conversions keep
+  *          flowing into the next block while the application works on filled ones; nothing is
+  *          reloaded and no sample is dropped between blocks. ADC must already be powered on and
+  *          opened in burst or continuous scan mode with the channels to convert. The application
+  *          PDMA_IRQHandler must call PDMA_DispatchIRQ().
+  * @note While enable PDMA transfer, ADC interrupt must be disabled.
+  */
+int32_t ADC_StreamStart(ADC_T *adc, ADC_STREAM_T *psStream)
+{
+    uint32_t au32Buf[ADC_STREAM_BLK_MAX], i;
+    int32_t i32Ch;
+
+    if((psStream->u32BlkNum < 2UL) || (psStream->u32BlkNum > ADC_STREAM_BLK_MAX))
+        return -1;
+
+    for(i = 0UL; i < psStream->u32BlkNum; i++)
+        au32Buf[i] = (uint32_t)&psStream->pu16Buf[i * psStream->u32BlkLen];
+
+    if(PDMA_BuildScatterChain(psStream->pdma, psStream->psDesc, au32Buf, psStream->u32BlkNum, psStream->u32BlkLen,
+                              PDMA_WIDTH_16 | PDMA_REQ_SINGLE, (uint32_t)&adc->ADPDMA, PDMA_CHAIN_RX | PDMA_CHAIN_RING) != 0)
+        return -1;
+
+    i32Ch = PDMA_RequestChannel(psStream->pdma, PDMA_CH_ANY);
+    if(i32Ch < 0)
+        return PDMA_XFER_NO_CH;
+
+    psStream->u32Ch = (uint32_t)i32Ch;
+    psStream->u32Filled = 0UL;
+    psStream->u32Taken = 0UL;
+    psStream->u32Lost = 0UL;
+
+    PDMA_SetCallback(psStream->pdma, psStream->u32Ch, ADC_StreamEvent, psStream);
+    PDMA_SetTransferMode(psStream->pdma, psStream->u32Ch, PDMA_ADC_RX, TRUE, (uint32_t)&psStream->psDesc[0]);
+    PDMA_EnableInt(psStream->pdma, psStream->u32Ch, PDMA_INT_TRANS_DONE);
+
+    adc->ADCR &= ~ADC_ADCR_ADIE_Msk;
+    ADC_ENABLE_PDMA(adc);
+    ADC_START_CONV(adc);
+
+    return i32Ch;
+}
+
+/**
+  * @brief Stop a stream started by ADC_StreamStart().
+  * @param[in] adc The pointer of the specified ADC module.
+  * @param[in,out] psStream The stream.
+  * @return None
+  * @details Conversion stops, the PDMA channel is released and blocks not yet released by the
+  *          application stay readable until the stream is started again.
+  */
+void ADC_StreamStop(ADC_T *adc, ADC_STREAM_T *psStream)
+{
+    ADC_STOP_CONV(adc);
+    ADC_DISABLE_PDMA(adc);
+    PDMA_STOP(psStream->pdma, psStream->u32Ch);
+    PDMA_ReleaseChannel(psStream->pdma, psStream->u32Ch);
+}
+
+/**
+  * @brief Get the oldest filled block of a stream.
+  * @param[in,out] psStream The stream.
+  * @return Pointer to u32BlkLen samples inside the ring, or NULL if no block is filled yet
+  * @details The block is used in place and stays owned by the application until
+  *          ADC_StreamReleaseBlock(). If PDMA has come round to a block the application has not
+  *          released, the overwritten blocks are skipped and counted in u32Lost.
+  */
+uint16_t *ADC_StreamGetBlock(ADC_STREAM_T *psStream)
+{
+    uint32_t u32Pending = psStream->u32Filled - psStream->u32Taken;
+
+    if(u32Pending >= psStream->u32BlkNum)
+    {
+        /* The block PDMA is writing now is the oldest one, keep only the complete newer ones */
+        psStream->u32Lost += u32Pending - (psStream->u32BlkNum - 1UL);
+        psStream->u32Taken += u32Pending - (psStream->u32BlkNum - 1UL);
+    }
+    else if(u32Pending == 0UL)
+    {
+        return NULL;
+    }
+
+    return &psStream->pu16Buf[(psStream->u32Taken % psStream->u32BlkNum) * psStream->u32BlkLen];
+}
+
+/**
+  * @brief Hand the block returned by ADC_StreamGetBlock() back to the stream.
+  * @param[in,out] psStream The stream.
+  * @retval 0 The block was intact while the application used it
+  * @retval 1 PDMA overwrote the block before it was released; it is counted in u32Lost
+  */
+int32_t ADC_StreamReleaseBlock(ADC_STREAM_T *psStream)
+{
+    int32_t i32Ret = 0;
+
+    if((psStream->u32Filled - psStream->u32Taken) >= psStream->u32BlkNum)
+    {
+        psStream->u32Lost++;
+        i32Ret = 1;
+    }
+    psStream->u32Taken++;
+
+    return i32Ret;
+}
+
 /*@}*/ /* end of group ADC_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group ADC_Driver */
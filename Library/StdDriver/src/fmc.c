@@ -10,6 +10,7 @@
 *****************************************************************************/
 
 #include <stdio.h>
+#include <string.h>
 
 #include "NuMicro.h"
 
@@ -425,10 +426,11 @@ uint32_t FMC_CheckAllOne(uint32_t u32addr, uint32_t u32count)
  * @param[in]  u32Addr    Start flash address in APROM where the data chunk to be programmed into.
  *                        This address must be 8-bytes aligned to flash address.
  * @param[in]  pu32Buf    Buffer that carry the data chunk.
- * @param[in]  u32Len     Length of the data chunk in bytes.
+ * @param[in]  u32Len     Length of the data chunk in bytes. It must be a multiple of 16
+ *                        and not more than FMC_MULTI_WORD_PROG_LEN.
  *
  * @retval     >=0  Number of data bytes were programmed.
- * @return     -1   Invalid address.
+ * @return     -1   Invalid address or length.
  *
  * @detail     Program Multi-Word data into specified address of flash.
  */
@@ -452,7 +454,7 @@ int32_t FMC_WriteMultiple(uint32_t u32Addr, uint32_t pu32Buf[], uint32_t u32Len)
     uint32_t i, idx, u32OnProg, retval = 0;
     int32_t err;
 
-    if ((u32Addr % 8) != 0)
+    if (((u32Addr % 8) != 0) || (u32Len == 0u) || ((u32Len % 16u) != 0) || (u32Len > FMC_MULTI_WORD_PROG_LEN))
     {
         return -1;
     }
@@ -472,7 +474,7 @@ int32_t FMC_WriteMultiple(uint32_t u32Addr, uint32_t pu32Buf[], uint32_t u32Len)
         FMC->ISPTRG = 0x1u;
         idx += 4u;
 
-        for (i = idx; i < (FMC_MULTI_WORD_PROG_LEN / 4u); i += 4u) /* Max data length is 256 bytes (512/4 words)*/
+        for (i = idx; i < (u32Len / 4u); i += 4u) /* Max data length is 256 bytes (512/4 words)*/
         {
             __set_PRIMASK(1u); /* Mask interrupt to avoid status check coherence error*/
             do
@@ -540,6 +542,518 @@ int32_t FMC_WriteMultiple(uint32_t u32Addr, uint32_t pu32Buf[], uint32_t u32Len)
 
 #endif
 
+/* CRC32 as computed by FMC_ISPCMD_RUN_CKS, four bits at a time; u32Crc is the running value, not inverted */
+static uint32_t FMC_Crc32Update(uint32_t u32Crc, const uint32_t pu32Buf[], uint32_t u32Len)
+{
+    static const uint32_t au32Tbl[16] =
+    {
+        0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL, 0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+        0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL, 0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL
+    };
+    uint32_t u32Data, i, j;
+
+    for (i = 0UL; i < (u32Len / 4UL); i++)
+    {
+        u32Data = pu32Buf[i];
+        for (j = 0UL; j < 8UL; j++)
+        {
+            u32Crc = (u32Crc >> 4) ^ au32Tbl[(u32Crc ^ u32Data) & 0xFUL];
+            u32Data >>= 4;
+        }
+    }
+
+    return u32Crc;
+}
+
+static uint32_t FMC_Crc32(const uint32_t pu32Buf[], uint32_t u32Len)
+{
+    return ~FMC_Crc32Update(0xFFFFFFFFUL, pu32Buf, u32Len);
+}
+
+/**
+ * @brief      Program a block of flash and verify it
+ *
+ * @param[in]  u32Addr    Start flash address. It must be word aligned and the area must be erased.
+ * @param[in]  pu32Buf    Buffer that carry the data.
+ * @param[in]  u32Len     Length of the data in bytes. It must be a multiple of 4.
+ *
+ * @retval     0    Success.
+ * @retval     -1   Invalid parameter, ISP command failed or the flash does not match the buffer.
+ *
+ * @details    The data is programmed by FMC_WriteMultiple in bursts of up to FMC_MULTI_WORD_PROG_LEN
+ *             bytes; only words that cannot form an aligned 16-byte group use single-word program.
+ *             The 512-byte aligned part is then verified with FMC_GetChkSum against the CRC32 of the
+ *             buffer, the rest by reading back.
+ *             Place FMC_WriteMultiple in SRAM (section "fastcode") to keep each burst going;
+ *             from flash a burst breaks more often and is resumed, which is slower but correct.
+ */
+int32_t FMC_WriteVerify(uint32_t u32Addr, uint32_t pu32Buf[], uint32_t u32Len)
+{
+    uint32_t u32Off, u32Burst, u32CksStart, u32CksEnd;
+
+    if (((u32Addr % 4UL) != 0UL) || ((u32Len % 4UL) != 0UL))
+    {
+        return -1;
+    }
+
+    FMC->ISPCTL |= FMC_ISPCTL_ISPFF_Msk;
+
+    for (u32Off = 0UL; u32Off < u32Len; u32Off += u32Burst)
+    {
+        /* A burst stays inside one FMC_MULTI_WORD_PROG_LEN row */
+        u32Burst = FMC_MULTI_WORD_PROG_LEN - ((u32Addr + u32Off) % FMC_MULTI_WORD_PROG_LEN);
+        if (u32Burst > (u32Len - u32Off))
+        {
+            u32Burst = u32Len - u32Off;
+        }
+        u32Burst &= ~0xFUL;
+
+        if ((((u32Addr + u32Off) % 16UL) == 0UL) && (u32Burst != 0UL))
+        {
+            if (FMC_WriteMultiple(u32Addr + u32Off, &pu32Buf[u32Off / 4UL], u32Burst) < 0)
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            u32Burst = 4UL;
+            FMC_Write(u32Addr + u32Off, pu32Buf[u32Off / 4UL]);
+        }
+
+        if (FMC->ISPCTL & FMC_ISPCTL_ISPFF_Msk)
+        {
+            FMC->ISPCTL |= FMC_ISPCTL_ISPFF_Msk;
+            return -1;
+        }
+    }
+
+    /* Hardware checksum over whole 512-byte blocks, read back the edges */
+    u32CksStart = (u32Addr + 511UL) & ~511UL;
+    u32CksEnd = (u32Addr + u32Len) & ~511UL;
+    if (u32CksEnd <= u32CksStart)
+    {
+        u32CksStart = u32CksEnd = u32Addr + u32Len;
+    }
+    else if (FMC_GetChkSum(u32CksStart, u32CksEnd - u32CksStart) !=
+             FMC_Crc32(&pu32Buf[(u32CksStart - u32Addr) / 4UL], u32CksEnd - u32CksStart))
+    {
+        return -1;
+    }
+
+    for (u32Off = 0UL; u32Off < u32Len; u32Off += 4UL)
+    {
+        if ((u32Addr + u32Off) == u32CksStart)
+        {
+            u32Off = u32CksEnd - u32Addr;
+            if (u32Off >= u32Len)
+            {
+                break;
+            }
+        }
+        if (FMC_Read(u32Addr + u32Off) != pu32Buf[u32Off / 4UL])
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  A/B update                                                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+#define FMC_AB_MAGIC            0x42414D46UL    /* "FMAB" */
+#define FMC_AB_STEP_COLLECT     0UL
+#define FMC_AB_STEP_ERASE       1UL
+#define FMC_AB_STEP_PROGRAM     2UL
+#define FMC_AB_STEP_CHECK       3UL
+
+/* Boot record: magic, sequence, bank | state << 8, length and CRC32 of bank A and B, CRC32 of the words before */
+static int32_t FMC_AB_ReadRec(uint32_t u32Addr, uint32_t au32Rec[])
+{
+    uint32_t i;
+
+    for (i = 0UL; i < (FMC_AB_REC_SIZE / 4UL); i++)
+    {
+        au32Rec[i] = FMC_Read(u32Addr + i * 4UL);
+    }
+
+    if ((au32Rec[0] != FMC_AB_MAGIC) || (au32Rec[7] != FMC_Crc32(au32Rec, 28UL)) || ((au32Rec[2] & 0xFFUL) > 1UL))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+static int32_t FMC_AB_IsBlank(uint32_t u32Addr)
+{
+    uint32_t i;
+
+    for (i = 0UL; i < FMC_AB_REC_SIZE; i += 4UL)
+    {
+        if (FMC_Read(u32Addr + i) != 0xFFFFFFFFUL)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Append a record selecting u32Bank. The page holding the newest record is never erased,
+   so a reset at any point leaves either the old or the new record in force. */
+static int32_t FMC_AB_WriteRec(FMC_AB_T *psAB, uint32_t u32Bank, uint32_t u32RecState)
+{
+    uint32_t au32Rec[FMC_AB_REC_SIZE / 4UL], u32Addr = psAB->u32RecAddr;
+
+    if ((u32Addr % FMC_FLASH_PAGE_SIZE) == 0UL)
+    {
+        /* The current page is full: start the other one */
+        u32Addr = ((u32Addr - FMC_FLASH_PAGE_SIZE) == psAB->au32RecPage[0]) ? psAB->au32RecPage[1] : psAB->au32RecPage[0];
+        if (FMC_Erase(u32Addr) != 0)
+        {
+            return -1;
+        }
+    }
+
+    au32Rec[0] = FMC_AB_MAGIC;
+    au32Rec[1] = psAB->u32Seq + 1UL;
+    au32Rec[2] = u32Bank | (u32RecState << 8);
+    au32Rec[3] = psAB->au32Len[0];
+    au32Rec[4] = psAB->au32Crc[0];
+    au32Rec[5] = psAB->au32Len[1];
+    au32Rec[6] = psAB->au32Crc[1];
+    au32Rec[7] = FMC_Crc32(au32Rec, 28UL);
+
+    psAB->u32RecAddr = u32Addr + FMC_AB_REC_SIZE;
+    if (FMC_WriteVerify(u32Addr, au32Rec, FMC_AB_REC_SIZE) != 0)
+    {
+        return -1;
+    }
+
+    psAB->u32Seq = au32Rec[1];
+    psAB->u32Bank = u32Bank;
+    psAB->u32RecState = u32RecState;
+    return 0;
+}
+
+/* TRUE if the bank holds the image its record describes, or nothing is known about it */
+static int32_t FMC_AB_Intact(FMC_AB_T *psAB, uint32_t u32Bank)
+{
+    uint32_t u32Len = (psAB->au32Len[u32Bank] + FMC_FLASH_PAGE_SIZE - 1UL) & FMC_PAGE_ADDR_MASK;
+
+    return (u32Len == 0UL) || (FMC_GetChkSum(psAB->au32Bank[u32Bank], u32Len) == psAB->au32Crc[u32Bank]);
+}
+
+/**
+ * @brief      Load the boot records of an A/B update
+ *
+ * @param[in]  psAB    A/B update with au32Bank, u32BankSize and au32RecPage filled in.
+ *
+ * @retval     0    Success.
+ * @retval     -1   A bank or record page is not page aligned.
+ *
+ * @details    The newest record with a valid CRC gives the selected bank, its state and the
+ *             image of each bank. Without any record bank A is selected and confirmed.
+ *             Records left half written by a reset are skipped. ISP and APROM update must be
+ *             enabled (FMC_Open(), FMC_ENABLE_AP_UPDATE()) before any FMC_AB_ function.
+ */
+int32_t FMC_AB_Open(FMC_AB_T *psAB)
+{
+    uint32_t au32Rec[FMC_AB_REC_SIZE / 4UL], u32Addr, u32Found = 0UL, i;
+
+    if ((psAB->au32Bank[0] % FMC_FLASH_PAGE_SIZE) || (psAB->au32Bank[1] % FMC_FLASH_PAGE_SIZE) ||
+            (psAB->u32BankSize % FMC_FLASH_PAGE_SIZE) || (psAB->au32RecPage[0] % FMC_FLASH_PAGE_SIZE) ||
+            (psAB->au32RecPage[1] % FMC_FLASH_PAGE_SIZE))
+    {
+        return -1;
+    }
+
+    psAB->u32Seq = 0UL;
+    psAB->u32Bank = 0UL;
+    psAB->u32RecState = FMC_AB_REC_OK;
+    psAB->au32Len[0] = psAB->au32Len[1] = 0UL;
+    psAB->au32Crc[0] = psAB->au32Crc[1] = 0UL;
+    psAB->u32RecAddr = psAB->au32RecPage[1] + FMC_FLASH_PAGE_SIZE;
+    psAB->u32State = FMC_AB_IDLE;
+
+    for (i = 0UL; i < 2UL; i++)
+    {
+        for (u32Addr = psAB->au32RecPage[i]; u32Addr < (psAB->au32RecPage[i] + FMC_FLASH_PAGE_SIZE); u32Addr += FMC_AB_REC_SIZE)
+        {
+            if ((FMC_AB_ReadRec(u32Addr, au32Rec) == 0) && ((u32Found == 0UL) || ((int32_t)(au32Rec[1] - psAB->u32Seq) > 0)))
+            {
+                u32Found = 1UL;
+                psAB->u32Seq = au32Rec[1];
+                psAB->u32Bank = au32Rec[2] & 0xFFUL;
+                psAB->u32RecState = (au32Rec[2] >> 8) & 0xFFUL;
+                psAB->au32Len[0] = au32Rec[3];
+                psAB->au32Crc[0] = au32Rec[4];
+                psAB->au32Len[1] = au32Rec[5];
+                psAB->au32Crc[1] = au32Rec[6];
+                psAB->u32RecAddr = u32Addr + FMC_AB_REC_SIZE;
+            }
+        }
+    }
+
+    while (((psAB->u32RecAddr % FMC_FLASH_PAGE_SIZE) != 0UL) && !FMC_AB_IsBlank(psAB->u32RecAddr))
+    {
+        psAB->u32RecAddr += FMC_AB_REC_SIZE;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      Choose the bank to boot
+ *
+ * @param[in]  psAB    A/B update opened by FMC_AB_Open().
+ *
+ * @return     Base address of the bank to boot.
+ *
+ * @details    For the boot selector: pass the result to FMC_SetVectorPageAddr() and reset the
+ *             CPU. A newly committed bank gets one boot; if it has not called FMC_AB_Confirm()
+ *             by the next one, the other bank is selected again. A bank whose CRC no longer
+ *             matches is left for the other one when that is intact.
+ */
+uint32_t FMC_AB_Select(FMC_AB_T *psAB)
+{
+    if (psAB->u32RecState == FMC_AB_REC_NEW)
+    {
+        FMC_AB_WriteRec(psAB, psAB->u32Bank, FMC_AB_REC_TRIAL);
+    }
+    else if (psAB->u32RecState == FMC_AB_REC_TRIAL)
+    {
+        FMC_AB_Rollback(psAB);
+    }
+
+    if (!FMC_AB_Intact(psAB, psAB->u32Bank))
+    {
+        FMC_AB_Rollback(psAB);
+    }
+
+    return psAB->au32Bank[psAB->u32Bank];
+}
+
+/**
+ * @brief      Start writing a new image to the bank that is not running
+ *
+ * @param[in]  psAB    A/B update opened by FMC_AB_Open().
+ * @param[in]  u32Len  Image length in bytes, up to u32BankSize.
+ * @param[in]  u32Crc  CRC32 of the image padded with 0xFF to whole pages, as FMC_GetChkSum() gives it.
+ *
+ * @retval     0    Success.
+ * @retval     -1   Bad length, an update is in progress, or the running bank is not confirmed
+ *                  yet and the other bank is still its way back.
+ *
+ * @details    Feed the image with FMC_AB_Write() and call FMC_AB_Poll() until it is no
+ *             longer FMC_AB_BUSY. Nothing is erased here. A running bank without a record
+ *             is taken whole, with its current CRC, as the image to go back to.
+ */
+int32_t FMC_AB_Begin(FMC_AB_T *psAB, uint32_t u32Len, uint32_t u32Crc)
+{
+    if ((psAB->u32State == FMC_AB_BUSY) || (psAB->u32RecState != FMC_AB_REC_OK) || (u32Len == 0UL) ||
+            (u32Len > psAB->u32BankSize))
+    {
+        return -1;
+    }
+
+    /* A factory image has no record: take the whole running bank as the way back */
+    if (psAB->au32Len[psAB->u32Bank] == 0UL)
+    {
+        psAB->au32Len[psAB->u32Bank] = psAB->u32BankSize;
+        psAB->au32Crc[psAB->u32Bank] = FMC_GetChkSum(psAB->au32Bank[psAB->u32Bank], psAB->u32BankSize);
+    }
+
+    psAB->u32Target = psAB->u32Bank ^ 1UL;
+    psAB->au32Len[psAB->u32Target] = u32Len;
+    psAB->au32Crc[psAB->u32Target] = u32Crc;
+    psAB->u32Step = FMC_AB_STEP_COLLECT;
+    psAB->u32Done = 0UL;
+    psAB->u32Fill = 0UL;
+    psAB->u32Prog = 0UL;
+    psAB->u32RunCrc = 0xFFFFFFFFUL;
+    psAB->u32State = FMC_AB_BUSY;
+    return 0;
+}
+
+/**
+ * @brief      Hand image data to an update
+ *
+ * @param[in]  psAB     A/B update started by FMC_AB_Begin().
+ * @param[in]  pu8Data  Next bytes of the image.
+ * @param[in]  u32Len   Number of bytes.
+ *
+ * @return     Number of bytes taken. Fewer than u32Len while a page is being programmed;
+ *             offer the rest again after FMC_AB_Poll().
+ */
+uint32_t FMC_AB_Write(FMC_AB_T *psAB, const uint8_t pu8Data[], uint32_t u32Len)
+{
+    uint32_t u32Room;
+
+    if ((psAB->u32State != FMC_AB_BUSY) || (psAB->u32Step != FMC_AB_STEP_COLLECT))
+    {
+        return 0UL;
+    }
+
+    u32Room = FMC_FLASH_PAGE_SIZE - psAB->u32Fill;
+    if (u32Room > (psAB->au32Len[psAB->u32Target] - psAB->u32Done - psAB->u32Fill))
+    {
+        u32Room = psAB->au32Len[psAB->u32Target] - psAB->u32Done - psAB->u32Fill;
+    }
+    if (u32Len > u32Room)
+    {
+        u32Len = u32Room;
+    }
+
+    memcpy((uint8_t *)psAB->au32Page + psAB->u32Fill, pu8Data, u32Len);
+    psAB->u32Fill += u32Len;
+    return u32Len;
+}
+
+/**
+ * @brief      Run one step of an update
+ *
+ * @param[in]  psAB    A/B update started by FMC_AB_Begin().
+ *
+ * @return     FMC_AB_BUSY, FMC_AB_READY once the whole image is written and its CRC matches,
+ *             FMC_AB_ERROR, or FMC_AB_IDLE if no update was started.
+ *
+ * @details    Each call does at most one page erase, one FMC_MULTI_WORD_PROG_LEN burst or one
+ *             CRC check, so the caller keeps serving its work between calls. The CPU still
+ *             stalls while the flash is busy when it runs from flash.
+ */
+uint32_t FMC_AB_Poll(FMC_AB_T *psAB)
+{
+    uint32_t u32Page = psAB->au32Bank[psAB->u32Target] + psAB->u32Done;
+
+    if (psAB->u32State != FMC_AB_BUSY)
+    {
+        return psAB->u32State;
+    }
+
+    switch (psAB->u32Step)
+    {
+    case FMC_AB_STEP_COLLECT:
+        if ((psAB->u32Fill < FMC_FLASH_PAGE_SIZE) && ((psAB->u32Done + psAB->u32Fill) < psAB->au32Len[psAB->u32Target]))
+        {
+            break;
+        }
+
+        /* The last page is padded as an erased page reads */
+        memset((uint8_t *)psAB->au32Page + psAB->u32Fill, 0xFF, FMC_FLASH_PAGE_SIZE - psAB->u32Fill);
+        psAB->u32Step = FMC_AB_STEP_ERASE;
+        break;
+
+    case FMC_AB_STEP_ERASE:
+        if (FMC_Erase(u32Page) != 0)
+        {
+            psAB->u32State = FMC_AB_ERROR;
+            break;
+        }
+        psAB->u32Prog = 0UL;
+        psAB->u32Step = FMC_AB_STEP_PROGRAM;
+        break;
+
+    case FMC_AB_STEP_PROGRAM:
+        FMC->ISPCTL |= FMC_ISPCTL_ISPFF_Msk;
+        if ((FMC_WriteMultiple(u32Page + psAB->u32Prog, &psAB->au32Page[psAB->u32Prog / 4UL], FMC_MULTI_WORD_PROG_LEN) < 0) ||
+                (FMC->ISPCTL & FMC_ISPCTL_ISPFF_Msk))
+        {
+            FMC->ISPCTL |= FMC_ISPCTL_ISPFF_Msk;
+            psAB->u32State = FMC_AB_ERROR;
+            break;
+        }
+
+        psAB->u32Prog += FMC_MULTI_WORD_PROG_LEN;
+        if (psAB->u32Prog < FMC_FLASH_PAGE_SIZE)
+        {
+            break;
+        }
+
+        /* Page complete: check it and carry it into the image CRC */
+        if (FMC_GetChkSum(u32Page, FMC_FLASH_PAGE_SIZE) != FMC_Crc32(psAB->au32Page, FMC_FLASH_PAGE_SIZE))
+        {
+            psAB->u32State = FMC_AB_ERROR;
+            break;
+        }
+        psAB->u32RunCrc = FMC_Crc32Update(psAB->u32RunCrc, psAB->au32Page, FMC_FLASH_PAGE_SIZE);
+        psAB->u32Done += FMC_FLASH_PAGE_SIZE;
+        psAB->u32Fill = 0UL;
+        psAB->u32Step = (psAB->u32Done < psAB->au32Len[psAB->u32Target]) ? FMC_AB_STEP_COLLECT : FMC_AB_STEP_CHECK;
+        break;
+
+    default:
+        /* The data received and the whole bank as the flash reads it must both match */
+        psAB->u32State = ((~psAB->u32RunCrc == psAB->au32Crc[psAB->u32Target]) && FMC_AB_Intact(psAB, psAB->u32Target)) ?
+                         FMC_AB_READY : FMC_AB_ERROR;
+        break;
+    }
+
+    return psAB->u32State;
+}
+
+/**
+ * @brief      Select the new image for the next boot
+ *
+ * @param[in]  psAB    A/B update that FMC_AB_Poll() reported FMC_AB_READY.
+ *
+ * @retval     0    Success.
+ * @retval     -1   No verified image, or the record could not be written.
+ *
+ * @details    One boot record is appended; the running image is untouched and keeps going
+ *             until the next reset, when FMC_AB_Select() picks the new bank.
+ */
+int32_t FMC_AB_Commit(FMC_AB_T *psAB)
+{
+    if ((psAB->u32State != FMC_AB_READY) || (FMC_AB_WriteRec(psAB, psAB->u32Target, FMC_AB_REC_NEW) != 0))
+    {
+        return -1;
+    }
+
+    psAB->u32State = FMC_AB_IDLE;
+    return 0;
+}
+
+/**
+ * @brief      Keep the running image
+ *
+ * @param[in]  psAB    A/B update opened by FMC_AB_Open().
+ *
+ * @retval     0    Success.
+ * @retval     -1   The record could not be written.
+ *
+ * @details    Call once a new image has checked itself; until then the next reset goes back
+ *             to the other bank and FMC_AB_Begin() is refused.
+ */
+int32_t FMC_AB_Confirm(FMC_AB_T *psAB)
+{
+    return (psAB->u32RecState == FMC_AB_REC_OK) ? 0 : FMC_AB_WriteRec(psAB, psAB->u32Bank, FMC_AB_REC_OK);
+}
+
+/**
+ * @brief      Select the other bank for the next boot
+ *
+ * @param[in]  psAB    A/B update opened by FMC_AB_Open().
+ *
+ * @retval     0    Success.
+ * @retval     -1   An update is in progress, the other bank holds no known image or its CRC
+ *                  does not match, or the record could not be written.
+ */
+int32_t FMC_AB_Rollback(FMC_AB_T *psAB)
+{
+    uint32_t u32Other = psAB->u32Bank ^ 1UL;
+
+    if ((psAB->u32State == FMC_AB_BUSY) || (psAB->u32State == FMC_AB_READY) || (psAB->au32Len[u32Other] == 0UL) ||
+            !FMC_AB_Intact(psAB, u32Other))
+    {
+        return -1;
+    }
+
+    return FMC_AB_WriteRec(psAB, u32Other, FMC_AB_REC_OK);
+}
+
+
 /*@}*/ /* end of group FMC_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group FMC_Driver */
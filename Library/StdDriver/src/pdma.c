@@ -9,6 +9,9 @@
 
 
 static uint8_t u8ChSelect[PDMA_CH_MAX];
+static uint32_t s_u32ChReserved = 0ul;
+static PDMA_CALLBACK_T s_apfnCallback[PDMA_CH_MAX];
+static void *s_apvUserData[PDMA_CH_MAX];
 
 /** @addtogroup Standard_Driver Standard Driver
   @{
@@ -402,6 +405,425 @@ void PDMA_DisableInt(PDMA_T *pdma, uint32_t u32Ch, uint32_t u32Mask)
     }
 }
 
+/**
+ * @brief       Build Scatter-gather Descriptor Chain
+ *
+ * @param[in]   pdma            The pointer of the specified PDMA module
+ * @param[out]  asDesc          Descriptor tables to fill, one per buffer. Must be word aligned and
+ *                              in the 64 KB window selected by PDMA_T::SCATBA.
+ * @param[in]   au32BufAddr     Buffer addresses
+ * @param[in]   u32BufNum       Number of buffers and descriptor tables
+ * @param[in]   u32Count        Transfer count of each buffer, 1 ~ 65536
+ * @param[in]   u32Ctl          Table attributes, combination of
+ *                - \ref PDMA_WIDTH_8 / \ref PDMA_WIDTH_16 / \ref PDMA_WIDTH_32
+ *                - \ref PDMA_REQ_SINGLE / \ref PDMA_REQ_BURST with PDMA_BURST_xxx
+ *                - \ref PDMA_TBINTDIS_ENABLE / \ref PDMA_TBINTDIS_DISABLE
+ * @param[in]   u32FixAddr      Peripheral data register (or memory word) on the other side
+ * @param[in]   u32Flags        \ref PDMA_CHAIN_TX or \ref PDMA_CHAIN_RX, optionally with \ref PDMA_CHAIN_RING
+ *
+ * @retval      0       Success
+ * @retval      -1      Invalid parameter or a table outside the PDMA_T::SCATBA window
+ *
+ * @details     Table n moves u32Count items between au32BufAddr[n] (incrementing) and u32FixAddr
+ *              (fixed) and links to table n + 1. A linear chain ends with a basic mode table; a
+ *              ring links the last table back to the first, so the channel streams without being
+ *              re-armed and each finished table raises a transfer done event in order unless
+ *              \ref PDMA_TBINTDIS_DISABLE is given. Start the chain with
+ *              PDMA_SetTransferMode(pdma, ch, peripheral, TRUE, (uint32_t)&asDesc[0]).
+ */
+int32_t PDMA_BuildScatterChain(PDMA_T *pdma, DSCT_T asDesc[], uint32_t au32BufAddr[], uint32_t u32BufNum, uint32_t u32Count, uint32_t u32Ctl, uint32_t u32FixAddr, uint32_t u32Flags)
+{
+    uint32_t i, u32Base = pdma->SCATBA & PDMA_SCATBA_SCATBA_Msk, u32Next, u32Last;
+
+    if ((u32BufNum == 0ul) || (u32Count == 0ul) || (u32Count > 65536ul))
+    {
+        return -1;
+    }
+
+    for (i = 0ul; i < u32BufNum; i++)
+    {
+        if ((((uint32_t)&asDesc[i]) & PDMA_SCATBA_SCATBA_Msk) != u32Base)
+        {
+            return -1;
+        }
+    }
+
+    u32Ctl &= (PDMA_DSCT_CTL_TXWIDTH_Msk | PDMA_DSCT_CTL_TXTYPE_Msk | PDMA_DSCT_CTL_BURSIZE_Msk | PDMA_DSCT_CTL_TBINTDIS_Msk);
+    u32Ctl |= ((u32Count - 1ul) << PDMA_DSCT_CTL_TXCNT_Pos);
+    u32Ctl |= (u32Flags & PDMA_CHAIN_RX) ? (PDMA_SAR_FIX | PDMA_DAR_INC) : (PDMA_SAR_INC | PDMA_DAR_FIX);
+
+    for (i = 0ul; i < u32BufNum; i++)
+    {
+        u32Next = (i + 1ul < u32BufNum) ? (i + 1ul) : 0ul;
+        u32Last = ((i + 1ul == u32BufNum) && ((u32Flags & PDMA_CHAIN_RING) == 0ul)) ? 1ul : 0ul;
+
+        if (u32Flags & PDMA_CHAIN_RX)
+        {
+            asDesc[i].SA = u32FixAddr;
+            asDesc[i].DA = au32BufAddr[i];
+        }
+        else
+        {
+            asDesc[i].SA = au32BufAddr[i];
+            asDesc[i].DA = u32FixAddr;
+        }
+
+        asDesc[i].NEXT = u32Last ? 0ul : (((uint32_t)&asDesc[u32Next]) - u32Base);
+        asDesc[i].CTL = u32Ctl | (u32Last ? PDMA_OP_BASIC : PDMA_OP_SCATTER);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       Stop Scatter-gather Descriptor Chain
+ *
+ * @param[in]   asDesc          Descriptor tables built by PDMA_BuildScatterChain()
+ * @param[in]   u32DescNum      Number of descriptor tables
+ *
+ * @return      None
+ *
+ * @details     Every table becomes the last one, so a streaming ring stops cleanly after the
+ *              table it has already fetched instead of being cut in the middle of a buffer.
+ *              A final transfer done event follows.
+ */
+void PDMA_StopScatterChain(DSCT_T asDesc[], uint32_t u32DescNum)
+{
+    uint32_t i;
+
+    for (i = 0ul; i < u32DescNum; i++)
+    {
+        asDesc[i].CTL = (asDesc[i].CTL & ~PDMA_DSCT_CTL_OPMODE_Msk) | PDMA_OP_BASIC;
+    }
+}
+
+/**
+ * @brief       Reserve a PDMA Channel
+ *
+ * @param[in]   pdma            The pointer of the specified PDMA module
+ * @param[in]   u32ChMask       Acceptable channels. Use \ref PDMA_CH_ANY for any channel or
+ *                              \ref PDMA_CH_TOUT for a channel with timeout counter.
+ *
+ * @retval      >=0     Reserved channel number
+ * @retval      -1      No free channel in u32ChMask
+ *
+ * @details     This function takes the highest free channel in u32ChMask, enables it and clears
+ *              its callback. Channels enabled by PDMA_Open() are treated as in use, so code with
+ *              fixed channel numbers can share the controller with reserved channels.
+ */
+int32_t PDMA_RequestChannel(PDMA_T *pdma, uint32_t u32ChMask)
+{
+    uint32_t u32Ch, u32Primask;
+    int32_t i32Ch = -1;
+
+    u32Primask = __get_PRIMASK();
+    __set_PRIMASK(1ul);
+
+    u32ChMask &= ~(s_u32ChReserved | pdma->CHCTL);
+
+    for (u32Ch = PDMA_CH_MAX; u32Ch > 0ul; u32Ch--)
+    {
+        if (u32ChMask & (1ul << (u32Ch - 1ul)))
+        {
+            i32Ch = (int32_t)(u32Ch - 1ul);
+            s_u32ChReserved |= (1ul << i32Ch);
+            s_apfnCallback[i32Ch] = NULL;
+            s_apvUserData[i32Ch] = NULL;
+            pdma->DSCT[i32Ch].CTL = 0ul;
+            u8ChSelect[i32Ch] = PDMA_MEM;
+            pdma->CHCTL |= (1ul << i32Ch);
+            break;
+        }
+    }
+
+    __set_PRIMASK(u32Primask);
+
+    return i32Ch;
+}
+
+/**
+ * @brief       Release a Reserved PDMA Channel
+ *
+ * @param[in]   pdma            The pointer of the specified PDMA module
+ * @param[in]   u32Ch           The channel returned by PDMA_RequestChannel()
+ *
+ * @return      None
+ *
+ * @details     This function disables the channel and its interrupts and clears pending flags.
+ */
+void PDMA_ReleaseChannel(PDMA_T *pdma, uint32_t u32Ch)
+{
+    uint32_t u32Primask;
+
+    u32Primask = __get_PRIMASK();
+    __set_PRIMASK(1ul);
+
+    pdma->INTEN &= ~(1ul << u32Ch);
+    pdma->TOUTIEN &= ~(1ul << u32Ch);
+    pdma->TOUTEN &= ~(1ul << u32Ch);
+    pdma->CHCTL &= ~(1ul << u32Ch);
+    pdma->TDSTS = (1ul << u32Ch);
+    pdma->ABTSTS = (1ul << u32Ch);
+    s_apfnCallback[u32Ch] = NULL;
+    s_apvUserData[u32Ch] = NULL;
+    s_u32ChReserved &= ~(1ul << u32Ch);
+
+    __set_PRIMASK(u32Primask);
+}
+
+/**
+ * @brief       Set Channel Callback
+ *
+ * @param[in]   pdma            The pointer of the specified PDMA module
+ * @param[in]   u32Ch           The channel returned by PDMA_RequestChannel()
+ * @param[in]   pfnCallback     Called from PDMA_DispatchIRQ() with the channel events
+ * @param[in]   pvUserData      Argument passed to pfnCallback
+ *
+ * @return      None
+ *
+ * @details     The interrupt sources still need PDMA_EnableInt(); this function only installs the
+ *              handler. Events are \ref PDMA_EVENT_DONE, \ref PDMA_EVENT_ABORT and \ref PDMA_EVENT_TIMEOUT.
+ */
+void PDMA_SetCallback(PDMA_T *pdma, uint32_t u32Ch, PDMA_CALLBACK_T pfnCallback, void *pvUserData)
+{
+    uint32_t u32Primask;
+
+    (void)pdma;
+
+    u32Primask = __get_PRIMASK();
+    __set_PRIMASK(1ul);
+    s_apfnCallback[u32Ch] = pfnCallback;
+    s_apvUserData[u32Ch] = pvUserData;
+    __set_PRIMASK(u32Primask);
+}
+
+/**
+ * @brief       Dispatch PDMA Interrupt to Channel Callbacks
+ *
+ * @param[in]   pdma            The pointer of the specified PDMA module
+ *
+ * @return      None
+ *
+ * @details     Call this function from PDMA_IRQHandler. It reads INTSTS once, clears the transfer
+ *              done, target abort and timeout flags of reserved channels and calls each channel
+ *              callback once with all its events. Flags of channels not reserved by
+ *              PDMA_RequestChannel() are left for the application handler.
+ */
+void PDMA_DispatchIRQ(PDMA_T *pdma)
+{
+    uint32_t u32IntSts = pdma->INTSTS, u32Done = 0ul, u32Abort = 0ul, u32Tout, u32Pend, u32Ch, u32Event;
+    PDMA_CALLBACK_T pfnCallback;
+
+    if (u32IntSts & PDMA_INTSTS_ABTIF_Msk)
+    {
+        u32Abort = pdma->ABTSTS & s_u32ChReserved;
+        pdma->ABTSTS = u32Abort;
+    }
+
+    if (u32IntSts & PDMA_INTSTS_TDIF_Msk)
+    {
+        u32Done = pdma->TDSTS & s_u32ChReserved;
+        pdma->TDSTS = u32Done;
+    }
+
+    u32Tout = ((u32IntSts & (PDMA_INTSTS_REQTOF0_Msk | PDMA_INTSTS_REQTOF1_Msk)) >> PDMA_INTSTS_REQTOF0_Pos) & s_u32ChReserved;
+
+    if (u32Tout)
+    {
+        pdma->INTSTS = (u32Tout << PDMA_INTSTS_REQTOF0_Pos);
+    }
+
+    u32Pend = u32Done | u32Abort | u32Tout;
+
+    for (u32Ch = 0ul; u32Pend != 0ul; u32Ch++, u32Pend >>= 1)
+    {
+        if ((u32Pend & 1ul) && ((pfnCallback = s_apfnCallback[u32Ch]) != NULL))
+        {
+            u32Event = ((u32Done >> u32Ch) & 1ul) * PDMA_EVENT_DONE;
+            u32Event |= ((u32Abort >> u32Ch) & 1ul) * PDMA_EVENT_ABORT;
+            u32Event |= ((u32Tout >> u32Ch) & 1ul) * PDMA_EVENT_TIMEOUT;
+            pfnCallback(u32Ch, u32Event, s_apvUserData[u32Ch]);
+        }
+    }
+}
+
+/**
+ * @brief       Finish an asynchronous transfer
+ *
+ * @param[in]   pdma            The pointer of the specified PDMA module
+ * @param[in]   psXfer          Transfer control block
+ * @param[in]   i32Status       Final transfer status
+ *
+ * @return      None
+ *
+ * @details     The peripheral request and channel are released before the status is updated,
+ *              so the callback may start a new transfer with the same control block.
+ */
+static void PDMA_XferFinish(PDMA_T *pdma, S_PDMA_XFER_T *psXfer, int32_t i32Status)
+{
+    if (psXfer->pu32ReqCtl != NULL)
+    {
+        *psXfer->pu32ReqCtl &= ~psXfer->u32ReqMsk;
+    }
+
+    PDMA_ReleaseChannel(pdma, psXfer->u32Ch);
+    psXfer->i32Status = i32Status;
+
+    if (psXfer->pfnCallback != NULL)
+    {
+        psXfer->pfnCallback(psXfer->pvUserData, i32Status);
+    }
+}
+
+/**
+ * @brief       Channel callback of asynchronous transfers
+ *
+ * @param[in]   u32Ch           The channel
+ * @param[in]   u32Event        Channel events
+ * @param[in]   pvUserData      Transfer control block
+ *
+ * @return      None
+ */
+static void PDMA_XferEvent(uint32_t u32Ch, uint32_t u32Event, void *pvUserData)
+{
+    (void)u32Ch;
+
+    if (u32Event & (PDMA_EVENT_DONE | PDMA_EVENT_ABORT))
+    {
+        PDMA_XferFinish(PDMA, (S_PDMA_XFER_T *)pvUserData, (u32Event & PDMA_EVENT_ABORT) ? PDMA_XFER_ABORT : PDMA_XFER_DONE);
+    }
+}
+
+/**
+ * @brief       Start Asynchronous Transfer
+ *
+ * @param[in]   pdma            The pointer of the specified PDMA module
+ * @param[in]   psXfer          Transfer control block. pfnCallback and pvUserData must be set by caller.
+ * @param[in]   u32Peripheral   The selected peripheral, refer to PDMA_SetTransferMode()
+ * @param[in]   u32Width        Data width. Valid values are
+ *                - \ref PDMA_WIDTH_8
+ *                - \ref PDMA_WIDTH_16
+ *                - \ref PDMA_WIDTH_32
+ * @param[in]   u32SrcAddr      Source address
+ * @param[in]   u32SrcCtrl      Source control attribute. Valid values are
+ *                - \ref PDMA_SAR_INC
+ *                - \ref PDMA_SAR_FIX
+ * @param[in]   u32DstAddr      Destination address
+ * @param[in]   u32DstCtrl      Destination control attribute. Valid values are
+ *                - \ref PDMA_DAR_INC
+ *                - \ref PDMA_DAR_FIX
+ * @param[in]   u32Count        Transfer count, 1 ~ 65536
+ *
+ * @retval      >=0                 PDMA channel used by the transfer
+ * @retval      PDMA_XFER_NO_CH     All channels are in use
+ *
+ * @details     This function reserves a channel with PDMA_RequestChannel(), programs a basic mode
+ *              transfer and enables its transfer done interrupt. Memory transfers are triggered
+ *              at once; peripheral transfers start when the caller enables the peripheral PDMA
+ *              request. Completion is reported through PDMA_DispatchIRQ(), which the application
+ *              calls from PDMA_IRQHandler with PDMA_IRQn enabled in NVIC.
+ */
+int32_t PDMA_XferStart(PDMA_T *pdma, S_PDMA_XFER_T *psXfer, uint32_t u32Peripheral, uint32_t u32Width, uint32_t u32SrcAddr, uint32_t u32SrcCtrl, uint32_t u32DstAddr, uint32_t u32DstCtrl, uint32_t u32Count)
+{
+    int32_t i32Ch;
+    uint32_t u32Ch;
+
+    i32Ch = PDMA_RequestChannel(pdma, PDMA_CH_ANY);
+
+    if (i32Ch < 0)
+    {
+        return PDMA_XFER_NO_CH;
+    }
+
+    u32Ch = (uint32_t)i32Ch;
+    psXfer->pu32ReqCtl = NULL;
+    psXfer->u32ReqMsk = 0ul;
+    psXfer->u32Ch = u32Ch;
+    psXfer->u32Count = u32Count;
+    psXfer->i32Status = PDMA_XFER_BUSY;
+
+    pdma->TDSTS = (1ul << u32Ch);
+    pdma->ABTSTS = (1ul << u32Ch);
+    PDMA_SetCallback(pdma, u32Ch, PDMA_XferEvent, psXfer);
+    PDMA_SetTransferCnt(pdma, u32Ch, u32Width, u32Count);
+    PDMA_SetTransferAddr(pdma, u32Ch, u32SrcAddr, u32SrcCtrl, u32DstAddr, u32DstCtrl);
+
+    if (u32Peripheral == PDMA_MEM)
+    {
+        PDMA_SetBurstType(pdma, u32Ch, PDMA_REQ_BURST, PDMA_BURST_128);
+    }
+    else
+    {
+        PDMA_SetBurstType(pdma, u32Ch, PDMA_REQ_SINGLE, 0ul);
+    }
+
+    pdma->INTEN |= (1ul << u32Ch);
+    PDMA_SetTransferMode(pdma, u32Ch, u32Peripheral, 0ul, 0ul);
+    PDMA_Trigger(pdma, u32Ch);
+
+    return i32Ch;
+}
+
+/**
+ * @brief       Get Remaining Count of Asynchronous Transfer
+ *
+ * @param[in]   pdma            The pointer of the specified PDMA module
+ * @param[in]   psXfer          Transfer control block
+ *
+ * @return      Data items not transferred yet. 0 if the transfer is not busy.
+ *
+ * @details     This function is useful to find how many bytes a receive transfer has got
+ *              before it is aborted, e.g. on UART receive timeout.
+ */
+uint32_t PDMA_XferGetRemain(PDMA_T *pdma, S_PDMA_XFER_T *psXfer)
+{
+    uint32_t u32Ch = psXfer->u32Ch;
+
+    if ((psXfer->i32Status != PDMA_XFER_BUSY) || (pdma->TDSTS & (1ul << u32Ch)))
+    {
+        return 0ul;
+    }
+
+    return ((pdma->DSCT[u32Ch].CTL & PDMA_DSCT_CTL_TXCNT_Msk) >> PDMA_DSCT_CTL_TXCNT_Pos) + 1ul;
+}
+
+/**
+ * @brief       Abort Asynchronous Transfer
+ *
+ * @param[in]   pdma            The pointer of the specified PDMA module
+ * @param[in]   psXfer          Transfer control block
+ *
+ * @return      Data items not transferred
+ *
+ * @details     This function stops the channel and releases it. The callback is called with
+ *              \ref PDMA_XFER_ABORT from the caller context. Nothing is done if the transfer
+ *              has already completed.
+ */
+uint32_t PDMA_XferAbort(PDMA_T *pdma, S_PDMA_XFER_T *psXfer)
+{
+    uint32_t u32Ch = psXfer->u32Ch, u32Remain = 0ul, u32Primask, u32Abort = 0ul;
+
+    u32Primask = __get_PRIMASK();
+    __set_PRIMASK(1ul);
+
+    if ((psXfer->i32Status == PDMA_XFER_BUSY) && (s_apvUserData[u32Ch] == psXfer))
+    {
+        PDMA_STOP(pdma, u32Ch);
+        u32Remain = PDMA_XferGetRemain(pdma, psXfer);
+        s_apfnCallback[u32Ch] = NULL;
+        u32Abort = 1ul;
+    }
+
+    __set_PRIMASK(u32Primask);
+
+    if (u32Abort)
+    {
+        PDMA_XferFinish(pdma, psXfer, PDMA_XFER_ABORT);
+    }
+
+    return u32Remain;
+}
+
 /*@}*/ /* end of group PDMA_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group PDMA_Driver */
@@ -803,6 +803,103 @@ uint32_t QSPI_GetStatus(QSPI_T *qspi, uint32_t u32Mask)
 
 
 
+/**
+  * @brief      Get PDMA TX request source of QSPI
+  *
+  * @param[in]  qspi       The pointer of the specified QSPI module.
+  *
+  * @return     PDMA TX request source. The RX request source is the next number.
+  */
+static uint32_t QSPI_GetPdmaReq(QSPI_T *qspi)
+{
+    (void)qspi;
+
+    return PDMA_QSPI0_TX;
+}
+
+/**
+  * @brief      Get PDMA data width matching QSPI data width
+  *
+  * @param[in]  qspi       The pointer of the specified QSPI module.
+  *
+  * @return     PDMA_WIDTH_8, PDMA_WIDTH_16 or PDMA_WIDTH_32
+  */
+static uint32_t QSPI_GetPdmaWidth(QSPI_T *qspi)
+{
+    uint32_t u32Bits = (qspi->CTL & QSPI_CTL_DWIDTH_Msk) >> QSPI_CTL_DWIDTH_Pos;
+
+    if (u32Bits == 0ul)
+    {
+        u32Bits = 32ul;   /* DWIDTH 0 means 32 bits */
+    }
+
+    return (u32Bits <= 8ul) ? PDMA_WIDTH_8 : ((u32Bits <= 16ul) ? PDMA_WIDTH_16 : PDMA_WIDTH_32);
+}
+
+/**
+  * @brief      Start asynchronous PDMA transmit
+  *
+  * @param[in]  qspi       The pointer of the specified QSPI module.
+  * @param[in]  psXfer     Transfer control block. pfnCallback and pvUserData must be set by caller.
+  * @param[in]  pvTxBuf    The buffer to send the data.
+  * @param[in]  u32Count   The number of data items to send, 1 ~ 65536.
+  *
+  * @retval     >=0                 PDMA channel used by the transfer
+  * @retval     PDMA_XFER_NO_CH     All PDMA channels are in use
+  *
+  * @details    The function returns at once. The TX PDMA request of the QSPI is enabled
+  *             until the transfer ends, then psXfer->pfnCallback is called from PDMA_DispatchIRQ().
+  */
+int32_t QSPI_WriteAsync(QSPI_T *qspi, S_PDMA_XFER_T *psXfer, void *pvTxBuf, uint32_t u32Count)
+{
+    int32_t i32Ch;
+
+    i32Ch = PDMA_XferStart(PDMA, psXfer, QSPI_GetPdmaReq(qspi), QSPI_GetPdmaWidth(qspi),
+                           (uint32_t)pvTxBuf, PDMA_SAR_INC, (uint32_t)&qspi->TX, PDMA_DAR_FIX, u32Count);
+
+    if (i32Ch >= 0)
+    {
+        psXfer->pu32ReqCtl = &qspi->PDMACTL;
+        psXfer->u32ReqMsk = QSPI_PDMACTL_TXPDMAEN_Msk;
+        qspi->PDMACTL |= QSPI_PDMACTL_TXPDMAEN_Msk;
+    }
+
+    return i32Ch;
+}
+
+/**
+  * @brief      Start asynchronous PDMA receive
+  *
+  * @param[in]  qspi       The pointer of the specified QSPI module.
+  * @param[in]  psXfer     Transfer control block. pfnCallback and pvUserData must be set by caller.
+  * @param[out] pvRxBuf    The buffer to receive the data.
+  * @param[in]  u32Count   The number of data items to receive, 1 ~ 65536.
+  *
+  * @retval     >=0                 PDMA channel used by the transfer
+  * @retval     PDMA_XFER_NO_CH     All PDMA channels are in use
+  *
+  * @details    The function returns at once. The RX PDMA request of the QSPI is enabled
+  *             until the transfer ends, then psXfer->pfnCallback is called from PDMA_DispatchIRQ().
+  *             For full-duplex transfer in master mode, start QSPI_ReadAsync() before
+  *             QSPI_WriteAsync() with the same count.
+  */
+int32_t QSPI_ReadAsync(QSPI_T *qspi, S_PDMA_XFER_T *psXfer, void *pvRxBuf, uint32_t u32Count)
+{
+    int32_t i32Ch;
+
+    i32Ch = PDMA_XferStart(PDMA, psXfer, QSPI_GetPdmaReq(qspi) + 1ul, QSPI_GetPdmaWidth(qspi),
+                           (uint32_t)&qspi->RX, PDMA_SAR_FIX, (uint32_t)pvRxBuf, PDMA_DAR_INC, u32Count);
+
+    if (i32Ch >= 0)
+    {
+        psXfer->pu32ReqCtl = &qspi->PDMACTL;
+        psXfer->u32ReqMsk = QSPI_PDMACTL_RXPDMAEN_Msk;
+        qspi->PDMACTL |= QSPI_PDMACTL_RXPDMAEN_Msk;
+    }
+
+    return i32Ch;
+}
+
 /*@}*/ /* end of group QSPI_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group QSPI_Driver */
@@ -925,6 +925,103 @@ void SPII2S_SetFIFO(SPI_T *i2s, uint32_t u32TxThreshold, uint32_t u32RxThreshold
                    (u32RxThreshold << SPI_FIFOCTL_RXTH_Pos);
 }
 
+/**
+  * @brief      Get PDMA TX request source of SPI
+  *
+  * @param[in]  spi        The pointer of the specified SPI module.
+  *
+  * @return     PDMA TX request source. The RX request source is the next number.
+  */
+static uint32_t SPI_GetPdmaReq(SPI_T *spi)
+{
+    (void)spi;
+
+    return PDMA_SPI0_TX;
+}
+
+/**
+  * @brief      Get PDMA data width matching SPI data width
+  *
+  * @param[in]  spi        The pointer of the specified SPI module.
+  *
+  * @return     PDMA_WIDTH_8, PDMA_WIDTH_16 or PDMA_WIDTH_32
+  */
+static uint32_t SPI_GetPdmaWidth(SPI_T *spi)
+{
+    uint32_t u32Bits = (spi->CTL & SPI_CTL_DWIDTH_Msk) >> SPI_CTL_DWIDTH_Pos;
+
+    if (u32Bits == 0ul)
+    {
+        u32Bits = 32ul;   /* DWIDTH 0 means 32 bits */
+    }
+
+    return (u32Bits <= 8ul) ? PDMA_WIDTH_8 : ((u32Bits <= 16ul) ? PDMA_WIDTH_16 : PDMA_WIDTH_32);
+}
+
+/**
+  * @brief      Start asynchronous PDMA transmit
+  *
+  * @param[in]  spi        The pointer of the specified SPI module.
+  * @param[in]  psXfer     Transfer control block. pfnCallback and pvUserData must be set by caller.
+  * @param[in]  pvTxBuf    The buffer to send the data.
+  * @param[in]  u32Count   The number of data items to send, 1 ~ 65536.
+  *
+  * @retval     >=0                 PDMA channel used by the transfer
+  * @retval     PDMA_XFER_NO_CH     All PDMA channels are in use
+  *
+  * @details    The function returns at once. The TX PDMA request of the SPI is enabled
+  *             until the transfer ends, then psXfer->pfnCallback is called from PDMA_DispatchIRQ().
+  */
+int32_t SPI_WriteAsync(SPI_T *spi, S_PDMA_XFER_T *psXfer, void *pvTxBuf, uint32_t u32Count)
+{
+    int32_t i32Ch;
+
+    i32Ch = PDMA_XferStart(PDMA, psXfer, SPI_GetPdmaReq(spi), SPI_GetPdmaWidth(spi),
+                           (uint32_t)pvTxBuf, PDMA_SAR_INC, (uint32_t)&spi->TX, PDMA_DAR_FIX, u32Count);
+
+    if (i32Ch >= 0)
+    {
+        psXfer->pu32ReqCtl = &spi->PDMACTL;
+        psXfer->u32ReqMsk = SPI_PDMACTL_TXPDMAEN_Msk;
+        spi->PDMACTL |= SPI_PDMACTL_TXPDMAEN_Msk;
+    }
+
+    return i32Ch;
+}
+
+/**
+  * @brief      Start asynchronous PDMA receive
+  *
+  * @param[in]  spi        The pointer of the specified SPI module.
+  * @param[in]  psXfer     Transfer control block. pfnCallback and pvUserData must be set by caller.
+  * @param[out] pvRxBuf    The buffer to receive the data.
+  * @param[in]  u32Count   The number of data items to receive, 1 ~ 65536.
+  *
+  * @retval     >=0                 PDMA channel used by the transfer
+  * @retval     PDMA_XFER_NO_CH     All PDMA channels are in use
+  *
+  * @details    The function returns at once. The RX PDMA request of the SPI is enabled
+  *             until the transfer ends, then psXfer->pfnCallback is called from PDMA_DispatchIRQ().
+  *             For full-duplex transfer in master mode, start SPI_ReadAsync() before
+  *             SPI_WriteAsync() with the same count.
+  */
+int32_t SPI_ReadAsync(SPI_T *spi, S_PDMA_XFER_T *psXfer, void *pvRxBuf, uint32_t u32Count)
+{
+    int32_t i32Ch;
+
+    i32Ch = PDMA_XferStart(PDMA, psXfer, SPI_GetPdmaReq(spi) + 1ul, SPI_GetPdmaWidth(spi),
+                           (uint32_t)&spi->RX, PDMA_SAR_FIX, (uint32_t)pvRxBuf, PDMA_DAR_INC, u32Count);
+
+    if (i32Ch >= 0)
+    {
+        psXfer->pu32ReqCtl = &spi->PDMACTL;
+        psXfer->u32ReqMsk = SPI_PDMACTL_RXPDMAEN_Msk;
+        spi->PDMACTL |= SPI_PDMACTL_RXPDMAEN_Msk;
+    }
+
+    return i32Ch;
+}
+
 /*@}*/ /* end of group SPI_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group SPI_Driver */
@@ -605,6 +605,379 @@ void UART_SelectSingleWireMode(UART_T *uart)
 }
 
 
+/**
+ *    @brief        Get PDMA TX request source of UART
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *
+ *    @return       PDMA_UARTn_TX. The RX request source is the next number.
+ */
+static uint32_t UART_GetPdmaReq(UART_T *uart)
+{
+    uint32_t u32Req;
+
+    if (uart == UART0)
+        u32Req = PDMA_UART0_TX;
+    else if (uart == UART1)
+        u32Req = PDMA_UART1_TX;
+    else if (uart == UART2)
+        u32Req = PDMA_UART2_TX;
+    else if (uart == UART3)
+        u32Req = PDMA_UART3_TX;
+    else if (uart == UART4)
+        u32Req = PDMA_UART4_TX;
+    else if (uart == UART5)
+        u32Req = PDMA_UART5_TX;
+    else if (uart == UART6)
+        u32Req = PDMA_UART6_TX;
+    else
+        u32Req = PDMA_UART7_TX;
+
+    return u32Req;
+}
+
+/**
+ *    @brief        Start asynchronous PDMA transmit
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *    @param[in]    psXfer          Transfer control block. pfnCallback and pvUserData must be set by caller.
+ *    @param[in]    pu8TxBuf        The buffer to send the data.
+ *    @param[in]    u32WriteBytes   The number of bytes to send, 1 ~ 65536.
+ *
+ *    @retval       >=0                 PDMA channel used by the transfer
+ *    @retval       PDMA_XFER_NO_CH     All PDMA channels are in use
+ *
+ *    @details      The function returns at once. The TX PDMA request of the UART is enabled
+ *                  until the transfer ends, then psXfer->pfnCallback is called from PDMA_DispatchIRQ().
+ */
+int32_t UART_WriteAsync(UART_T *uart, S_PDMA_XFER_T *psXfer, uint8_t pu8TxBuf[], uint32_t u32WriteBytes)
+{
+    int32_t i32Ch;
+
+    i32Ch = PDMA_XferStart(PDMA, psXfer, UART_GetPdmaReq(uart), PDMA_WIDTH_8,
+                           (uint32_t)pu8TxBuf, PDMA_SAR_INC, (uint32_t)&uart->DAT, PDMA_DAR_FIX, u32WriteBytes);
+
+    if (i32Ch >= 0)
+    {
+        psXfer->pu32ReqCtl = &uart->INTEN;
+        psXfer->u32ReqMsk = UART_INTEN_TXPDMAEN_Msk;
+        uart->INTEN |= UART_INTEN_TXPDMAEN_Msk;
+    }
+
+    return i32Ch;
+}
+
+/**
+ *    @brief        Start asynchronous PDMA receive
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *    @param[in]    psXfer          Transfer control block. pfnCallback and pvUserData must be set by caller.
+ *    @param[out]   pu8RxBuf        The buffer to receive the data.
+ *    @param[in]    u32ReadBytes    The number of bytes to receive, 1 ~ 65536.
+ *
+ *    @retval       >=0                 PDMA channel used by the transfer
+ *    @retval       PDMA_XFER_NO_CH     All PDMA channels are in use
+ *
+ *    @details      The function returns at once. The RX PDMA request of the UART is enabled
+ *                  until the transfer ends, then psXfer->pfnCallback is called from PDMA_DispatchIRQ().
+ *                  Use PDMA_XferGetRemain() and PDMA_XferAbort() on receive timeout to get
+ *                  a shorter frame.
+ */
+int32_t UART_ReadAsync(UART_T *uart, S_PDMA_XFER_T *psXfer, uint8_t pu8RxBuf[], uint32_t u32ReadBytes)
+{
+    int32_t i32Ch;
+
+    i32Ch = PDMA_XferStart(PDMA, psXfer, UART_GetPdmaReq(uart) + 1ul, PDMA_WIDTH_8,
+                           (uint32_t)&uart->DAT, PDMA_SAR_FIX, (uint32_t)pu8RxBuf, PDMA_DAR_INC, u32ReadBytes);
+
+    if (i32Ch >= 0)
+    {
+        psXfer->pu32ReqCtl = &uart->INTEN;
+        psXfer->u32ReqMsk = UART_INTEN_RXPDMAEN_Msk;
+        uart->INTEN |= UART_INTEN_RXPDMAEN_Msk;
+    }
+
+    return i32Ch;
+}
+
+/**
+ *    @brief        Get receive position of the buffered driver
+ *
+ *    @param[in]    psBuf           The buffered driver state.
+ *
+ *    @return       Bytes written into the receive ring by PDMA since UART_BufOpen()
+ *
+ *    @details      The position is taken from the PDMA channel without stopping it: NEXT names the
+ *                  table in progress and TXCNT the bytes it still waits for. A finished table whose
+ *                  transfer done event is not handled yet shows up to two segments ahead of the
+ *                  counted ones; a finished table whose successor is not loaded yet shows behind
+ *                  and is ignored.
+ */
+static uint32_t UART_BufRxHead(UART_BUF_T *psBuf)
+{
+    uint32_t u32Seg = psBuf->u32RxSize / UART_BUF_RX_SEG;
+    uint32_t u32Done, u32Ctl, u32Next, u32Idx, u32Pos, u32Ahead;
+
+    do
+    {
+        u32Done = psBuf->u32RxDone;
+        u32Next = PDMA->DSCT[psBuf->u32RxCh].NEXT;
+        u32Ctl = PDMA->DSCT[psBuf->u32RxCh].CTL;
+    }
+    while ((u32Next != PDMA->DSCT[psBuf->u32RxCh].NEXT) || (u32Done != psBuf->u32RxDone));
+
+    u32Idx = (((PDMA->SCATBA & PDMA_SCATBA_SCATBA_Msk) | (u32Next & PDMA_DSCT_NEXT_NEXT_Msk)) - (uint32_t)psBuf->psRxDesc) / sizeof(DSCT_T);
+    u32Idx = (u32Idx + UART_BUF_RX_SEG - 1ul) % UART_BUF_RX_SEG;
+    u32Pos = (u32Idx * u32Seg) + u32Seg - (((u32Ctl & PDMA_DSCT_CTL_TXCNT_Msk) >> PDMA_DSCT_CTL_TXCNT_Pos) + 1ul);
+    u32Ahead = (u32Pos - (u32Done * u32Seg)) & (psBuf->u32RxSize - 1ul);
+
+    if (u32Ahead >= (2ul * u32Seg))
+        u32Ahead = 0ul;
+
+    return (u32Done * u32Seg) + u32Ahead;
+}
+
+/**
+ *    @brief        PDMA event of the buffered driver receive ring
+ *
+ *    @param[in]    u32Ch           PDMA channel.
+ *    @param[in]    u32Event        PDMA_EVENT_DONE and/or PDMA_EVENT_TIMEOUT.
+ *    @param[in]    pvUserData      The buffered driver state.
+ *
+ *    @return       None
+ */
+static void UART_BufRxEvent(uint32_t u32Ch, uint32_t u32Event, void *pvUserData)
+{
+    UART_BUF_T *psBuf = (UART_BUF_T *)pvUserData;
+    uint32_t u32Head;
+
+    (void)u32Ch;
+
+    if (u32Event & PDMA_EVENT_DONE)
+        psBuf->u32RxDone++;
+
+    u32Head = UART_BufRxHead(psBuf);
+
+    /* Flush on idle line: notify once per burst, not on every time-out period */
+    if ((u32Head != psBuf->u32RxNotified) && (psBuf->pfnRxNotify != NULL))
+    {
+        psBuf->u32RxNotified = u32Head;
+        psBuf->pfnRxNotify(psBuf->pvUserData);
+    }
+}
+
+/**
+ *    @brief        Open buffered driver
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *    @param[in]    psBuf           The buffered driver state. Ring storage, descriptor tables and
+ *                                  the optional notification must be set by caller.
+ *    @param[in]    u32IdleTOC      PDMA request time-out count that flushes a partial segment when the
+ *                                  line goes idle, in units of 256 HCLK << PDMA_T::TOUTPSC. 0 disables it.
+ *
+ *    @retval       >=0                 PDMA channel used by the receive ring
+ *    @retval       PDMA_XFER_NO_CH     All PDMA channels are in use
+ *    @retval       -1                  Invalid ring size or descriptor tables outside PDMA_T::SCATBA window
+ *
+ *    @details      UART must already be opened. Receive data is moved by a PDMA scatter-gather ring
+ *                  straight into pu8RxBuf and is never copied by an interrupt; the time-out needs
+ *                  PDMA channel 0 or 1 and is skipped when both are taken. Transmit data is fed to
+ *                  the FIFO from the THRE interrupt. The application UARTn_IRQHandler must call
+ *                  UART_BufIRQHandler() and PDMA_IRQHandler must call PDMA_DispatchIRQ().
+ *                  While the line is idle the time-out interrupt recurs once per period.
+ */
+int32_t UART_BufOpen(UART_T *uart, UART_BUF_T *psBuf, uint32_t u32IdleTOC)
+{
+    uint32_t au32Seg[UART_BUF_RX_SEG], u32Seg, i;
+    int32_t i32Ch;
+
+    u32Seg = psBuf->u32RxSize / UART_BUF_RX_SEG;
+
+    if ((u32Seg == 0ul) || (psBuf->u32RxSize & (psBuf->u32RxSize - 1ul)) ||
+            (psBuf->u32TxSize & (psBuf->u32TxSize - 1ul)))
+        return -1;
+
+    for (i = 0ul; i < UART_BUF_RX_SEG; i++)
+        au32Seg[i] = (uint32_t)&psBuf->pu8RxBuf[i * u32Seg];
+
+    if (PDMA_BuildScatterChain(PDMA, psBuf->psRxDesc, au32Seg, UART_BUF_RX_SEG, u32Seg, PDMA_WIDTH_8 | PDMA_REQ_SINGLE,
+                               (uint32_t)&uart->DAT, PDMA_CHAIN_RX | PDMA_CHAIN_RING) != 0)
+        return -1;
+
+    i32Ch = (u32IdleTOC != 0ul) ? PDMA_RequestChannel(PDMA, PDMA_CH_TOUT) : -1;
+
+    if (i32Ch < 0)
+        i32Ch = PDMA_RequestChannel(PDMA, PDMA_CH_ANY);
+
+    if (i32Ch < 0)
+        return PDMA_XFER_NO_CH;
+
+    psBuf->u32RxCh = (uint32_t)i32Ch;
+    psBuf->u32RxDone = 0ul;
+    psBuf->u32RxTail = 0ul;
+    psBuf->u32RxLost = 0ul;
+    psBuf->u32RxNotified = 0ul;
+    psBuf->u32TxHead = 0ul;
+    psBuf->u32TxTail = 0ul;
+
+    PDMA_SetCallback(PDMA, psBuf->u32RxCh, UART_BufRxEvent, psBuf);
+    PDMA_SetTransferMode(PDMA, psBuf->u32RxCh, UART_GetPdmaReq(uart) + 1ul, TRUE, (uint32_t)&psBuf->psRxDesc[0]);
+    PDMA_EnableInt(PDMA, psBuf->u32RxCh, PDMA_INT_TRANS_DONE);
+
+    if ((u32IdleTOC != 0ul) && ((1ul << psBuf->u32RxCh) & PDMA_CH_TOUT))
+    {
+        PDMA_SetTimeOut(PDMA, psBuf->u32RxCh, 1ul, u32IdleTOC);
+        PDMA_EnableInt(PDMA, psBuf->u32RxCh, PDMA_INT_TIMEOUT);
+    }
+
+    uart->INTEN |= UART_INTEN_RXPDMAEN_Msk;
+
+    return i32Ch;
+}
+
+/**
+ *    @brief        Close buffered driver
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *    @param[in]    psBuf           The buffered driver state.
+ *
+ *    @return       None
+ *
+ *    @details      Receiving stops at once; data still in the transmit ring is discarded.
+ */
+void UART_BufClose(UART_T *uart, UART_BUF_T *psBuf)
+{
+    uart->INTEN &= ~(UART_INTEN_RXPDMAEN_Msk | UART_INTEN_THREIEN_Msk);
+    PDMA_STOP(PDMA, psBuf->u32RxCh);
+    PDMA_ReleaseChannel(PDMA, psBuf->u32RxCh);
+}
+
+/**
+ *    @brief        Get number of received bytes not read yet
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *    @param[in]    psBuf           The buffered driver state.
+ *
+ *    @return       Bytes UART_BufRead() can return now, at most the receive ring size.
+ */
+uint32_t UART_BufGetRxCount(UART_T *uart, UART_BUF_T *psBuf)
+{
+    uint32_t u32Count = UART_BufRxHead(psBuf) - psBuf->u32RxTail;
+
+    (void)uart;
+
+    return (u32Count > psBuf->u32RxSize) ? psBuf->u32RxSize : u32Count;
+}
+
+/**
+ *    @brief        Read data from buffered driver
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *    @param[in]    psBuf           The buffered driver state.
+ *    @param[out]   pu8RxBuf        The buffer to receive the data.
+ *    @param[in]    u32ReadBytes    The maximum number of bytes to read.
+ *
+ *    @return       Number of bytes read, 0 if nothing has been received.
+ *
+ *    @details      Never blocks. If more than the ring size arrived since the last read, the oldest
+ *                  bytes have been overwritten; they are skipped and counted in u32RxLost.
+ */
+uint32_t UART_BufRead(UART_T *uart, UART_BUF_T *psBuf, uint8_t pu8RxBuf[], uint32_t u32ReadBytes)
+{
+    uint32_t u32Head, u32Tail, u32Count, u32Mask = psBuf->u32RxSize - 1ul, i;
+
+    (void)uart;
+
+    u32Head = UART_BufRxHead(psBuf);
+    u32Tail = psBuf->u32RxTail;
+    u32Count = u32Head - u32Tail;
+
+    if (u32Count > psBuf->u32RxSize)
+    {
+        psBuf->u32RxLost += u32Count - psBuf->u32RxSize;
+        u32Tail = u32Head - psBuf->u32RxSize;
+        u32Count = psBuf->u32RxSize;
+    }
+
+    if (u32Count > u32ReadBytes)
+        u32Count = u32ReadBytes;
+
+    for (i = 0ul; i < u32Count; i++)
+        pu8RxBuf[i] = psBuf->pu8RxBuf[(u32Tail + i) & u32Mask];
+
+    psBuf->u32RxTail = u32Tail + u32Count;
+
+    return u32Count;
+}
+
+/**
+ *    @brief        Write data to buffered driver
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *    @param[in]    psBuf           The buffered driver state.
+ *    @param[in]    pu8TxBuf        The buffer to send the data.
+ *    @param[in]    u32WriteBytes   The number of bytes to send.
+ *
+ *    @return       Number of bytes queued, less than u32WriteBytes when the transmit ring is full.
+ *
+ *    @details      Never blocks. The THRE interrupt is enabled and drains the ring into the FIFO.
+ */
+uint32_t UART_BufWrite(UART_T *uart, UART_BUF_T *psBuf, uint8_t pu8TxBuf[], uint32_t u32WriteBytes)
+{
+    uint32_t u32Head = psBuf->u32TxHead, u32Free, u32Mask = psBuf->u32TxSize - 1ul, i;
+
+    u32Free = psBuf->u32TxSize - (u32Head - psBuf->u32TxTail);
+
+    if (u32WriteBytes > u32Free)
+        u32WriteBytes = u32Free;
+
+    for (i = 0ul; i < u32WriteBytes; i++)
+        psBuf->pu8TxBuf[(u32Head + i) & u32Mask] = pu8TxBuf[i];
+
+    psBuf->u32TxHead = u32Head + u32WriteBytes;
+
+    if (u32WriteBytes != 0ul)
+        uart->INTEN |= UART_INTEN_THREIEN_Msk;
+
+    return u32WriteBytes;
+}
+
+/**
+ *    @brief        Interrupt handler of buffered driver
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *    @param[in]    psBuf           The buffered driver state.
+ *
+ *    @return       None
+ *
+ *    @details      Call from UARTn_IRQHandler. Refills the TX FIFO on THRE and turns the THRE
+ *                  interrupt off when the transmit ring is empty.
+ */
+void UART_BufIRQHandler(UART_T *uart, UART_BUF_T *psBuf)
+{
+    uint32_t u32Tail = psBuf->u32TxTail, u32Mask = psBuf->u32TxSize - 1ul;
+
+    if ((uart->INTEN & UART_INTEN_THREIEN_Msk) && (uart->INTSTS & UART_INTSTS_THREIF_Msk))
+    {
+        while ((u32Tail != psBuf->u32TxHead) && !(uart->FIFOSTS & UART_FIFOSTS_TXFULL_Msk))
+        {
+            uart->DAT = psBuf->pu8TxBuf[u32Tail & u32Mask];
+            u32Tail++;
+        }
+
+        psBuf->u32TxTail = u32Tail;
+
+        if (u32Tail == psBuf->u32TxHead)
+        {
+            uart->INTEN &= ~UART_INTEN_THREIEN_Msk;
+
+            /* UART_BufWrite() may have queued data after the check above */
+            if (u32Tail != psBuf->u32TxHead)
+                uart->INTEN |= UART_INTEN_THREIEN_Msk;
+        }
+    }
+}
+
 /*@}*/ /* end of group UART_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group UART_Driver */
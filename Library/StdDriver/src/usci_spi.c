@@ -604,6 +604,108 @@ void USPI_DisableWakeup(USPI_T *uspi)
     uspi->WKCTL &= ~USPI_WKCTL_WKEN_Msk;
 }
 
+/**
+  * @brief      Get PDMA TX request source of USPI
+  *
+  * @param[in]  uspi       The pointer of the specified USPI module.
+  *
+  * @return     PDMA TX request source. The RX request source is the next number.
+  */
+static uint32_t USPI_GetPdmaReq(USPI_T *uspi)
+{
+    uint32_t u32Req;
+
+    if (uspi == USPI0)
+        u32Req = PDMA_USCI0_TX;
+    else
+        u32Req = PDMA_USCI1_TX;
+
+    return u32Req;
+}
+
+/**
+  * @brief      Get PDMA data width matching USPI data width
+  *
+  * @param[in]  uspi       The pointer of the specified USPI module.
+  *
+  * @return     PDMA_WIDTH_8, PDMA_WIDTH_16 or PDMA_WIDTH_32
+  */
+static uint32_t USPI_GetPdmaWidth(USPI_T *uspi)
+{
+    uint32_t u32Bits = (uspi->LINECTL & USPI_LINECTL_DWIDTH_Msk) >> USPI_LINECTL_DWIDTH_Pos;
+
+    if (u32Bits == 0ul)
+    {
+        u32Bits = 16ul;   /* DWIDTH 0 means 16 bits */
+    }
+
+    return (u32Bits <= 8ul) ? PDMA_WIDTH_8 : ((u32Bits <= 16ul) ? PDMA_WIDTH_16 : PDMA_WIDTH_32);
+}
+
+/**
+  * @brief      Start asynchronous PDMA transmit
+  *
+  * @param[in]  uspi       The pointer of the specified USPI module.
+  * @param[in]  psXfer     Transfer control block. pfnCallback and pvUserData must be set by caller.
+  * @param[in]  pvTxBuf    The buffer to send the data.
+  * @param[in]  u32Count   The number of data items to send, 1 ~ 65536.
+  *
+  * @retval     >=0                 PDMA channel used by the transfer
+  * @retval     PDMA_XFER_NO_CH     All PDMA channels are in use
+  *
+  * @details    The function returns at once. The TX PDMA request of the USPI is enabled
+  *             until the transfer ends, then psXfer->pfnCallback is called from PDMA_DispatchIRQ().
+  */
+int32_t USPI_WriteAsync(USPI_T *uspi, S_PDMA_XFER_T *psXfer, void *pvTxBuf, uint32_t u32Count)
+{
+    int32_t i32Ch;
+
+    i32Ch = PDMA_XferStart(PDMA, psXfer, USPI_GetPdmaReq(uspi), USPI_GetPdmaWidth(uspi),
+                           (uint32_t)pvTxBuf, PDMA_SAR_INC, (uint32_t)&uspi->TXDAT, PDMA_DAR_FIX, u32Count);
+
+    if (i32Ch >= 0)
+    {
+        psXfer->pu32ReqCtl = &uspi->PDMACTL;
+        psXfer->u32ReqMsk = USPI_PDMACTL_TXPDMAEN_Msk;
+        uspi->PDMACTL |= USPI_PDMACTL_TXPDMAEN_Msk | USPI_PDMACTL_PDMAEN_Msk;
+    }
+
+    return i32Ch;
+}
+
+/**
+  * @brief      Start asynchronous PDMA receive
+  *
+  * @param[in]  uspi       The pointer of the specified USPI module.
+  * @param[in]  psXfer     Transfer control block. pfnCallback and pvUserData must be set by caller.
+  * @param[out] pvRxBuf    The buffer to receive the data.
+  * @param[in]  u32Count   The number of data items to receive, 1 ~ 65536.
+  *
+  * @retval     >=0                 PDMA channel used by the transfer
+  * @retval     PDMA_XFER_NO_CH     All PDMA channels are in use
+  *
+  * @details    The function returns at once. The RX PDMA request of the USPI is enabled
+  *             until the transfer ends, then psXfer->pfnCallback is called from PDMA_DispatchIRQ().
+  *             For full-duplex transfer in master mode, start USPI_ReadAsync() before
+  *             USPI_WriteAsync() with the same count.
+  */
+int32_t USPI_ReadAsync(USPI_T *uspi, S_PDMA_XFER_T *psXfer, void *pvRxBuf, uint32_t u32Count)
+{
+    int32_t i32Ch;
+
+    i32Ch = PDMA_XferStart(PDMA, psXfer, USPI_GetPdmaReq(uspi) + 1ul, USPI_GetPdmaWidth(uspi),
+                           (uint32_t)&uspi->RXDAT, PDMA_SAR_FIX, (uint32_t)pvRxBuf, PDMA_DAR_INC, u32Count);
+
+    if (i32Ch >= 0)
+    {
+        psXfer->pu32ReqCtl = &uspi->PDMACTL;
+        psXfer->u32ReqMsk = USPI_PDMACTL_RXPDMAEN_Msk;
+        uspi->PDMACTL |= USPI_PDMACTL_RXPDMAEN_Msk | USPI_PDMACTL_PDMAEN_Msk;
+    }
+
+    return i32Ch;
+}
+
 /*@}*/ /* end of group USCI_SPI_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group USCI_SPI_Driver */
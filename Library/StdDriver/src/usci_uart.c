@@ -704,6 +704,354 @@ void UUART_DisableFlowCtrl(UUART_T* uuart)
     uuart->PROTCTL &= ~(UUART_PROTCTL_RTSAUTOEN_Msk | UUART_PROTCTL_CTSAUTOEN_Msk);
 }
 
+/**
+ *    @brief        Get PDMA TX request source of UUART
+ *
+ *    @param[in]    uuart           The pointer of the specified UUART module.
+ *
+ *    @return       PDMA TX request source. The RX request source is the next number.
+ */
+static uint32_t UUART_GetPdmaReq(UUART_T *uuart)
+{
+    uint32_t u32Req;
+
+    if (uuart == UUART0)
+        u32Req = PDMA_USCI0_TX;
+    else
+        u32Req = PDMA_USCI1_TX;
+
+    return u32Req;
+}
+
+/**
+ *    @brief        Start asynchronous PDMA transmit
+ *
+ *    @param[in]    uuart           The pointer of the specified UUART module.
+ *    @param[in]    psXfer          Transfer control block. pfnCallback and pvUserData must be set by caller.
+ *    @param[in]    pu8TxBuf        The buffer to send the data.
+ *    @param[in]    u32WriteBytes   The number of bytes to send, 1 ~ 65536.
+ *
+ *    @retval       >=0                 PDMA channel used by the transfer
+ *    @retval       PDMA_XFER_NO_CH     All PDMA channels are in use
+ *
+ *    @details      The function returns at once. The TX PDMA request of the UUART is enabled
+ *                  until the transfer ends, then psXfer->pfnCallback is called from PDMA_DispatchIRQ().
+ */
+int32_t UUART_WriteAsync(UUART_T *uuart, S_PDMA_XFER_T *psXfer, uint8_t pu8TxBuf[], uint32_t u32WriteBytes)
+{
+    int32_t i32Ch;
+
+    i32Ch = PDMA_XferStart(PDMA, psXfer, UUART_GetPdmaReq(uuart), PDMA_WIDTH_8,
+                           (uint32_t)pu8TxBuf, PDMA_SAR_INC, (uint32_t)&uuart->TXDAT, PDMA_DAR_FIX, u32WriteBytes);
+
+    if (i32Ch >= 0)
+    {
+        psXfer->pu32ReqCtl = &uuart->PDMACTL;
+        psXfer->u32ReqMsk = UUART_PDMACTL_TXPDMAEN_Msk;
+        uuart->PDMACTL |= UUART_PDMACTL_TXPDMAEN_Msk | UUART_PDMACTL_PDMAEN_Msk;
+    }
+
+    return i32Ch;
+}
+
+/**
+ *    @brief        Start asynchronous PDMA receive
+ *
+ *    @param[in]    uuart           The pointer of the specified UUART module.
+ *    @param[in]    psXfer          Transfer control block. pfnCallback and pvUserData must be set by caller.
+ *    @param[out]   pu8RxBuf        The buffer to receive the data.
+ *    @param[in]    u32ReadBytes    The number of bytes to receive, 1 ~ 65536.
+ *
+ *    @retval       >=0                 PDMA channel used by the transfer
+ *    @retval       PDMA_XFER_NO_CH     All PDMA channels are in use
+ *
+ *    @details      The function returns at once. The RX PDMA request of the UUART is enabled
+ *                  until the transfer ends, then psXfer->pfnCallback is called from PDMA_DispatchIRQ().
+ */
+int32_t UUART_ReadAsync(UUART_T *uuart, S_PDMA_XFER_T *psXfer, uint8_t pu8RxBuf[], uint32_t u32ReadBytes)
+{
+    int32_t i32Ch;
+
+    i32Ch = PDMA_XferStart(PDMA, psXfer, UUART_GetPdmaReq(uuart) + 1ul, PDMA_WIDTH_8,
+                           (uint32_t)&uuart->RXDAT, PDMA_SAR_FIX, (uint32_t)pu8RxBuf, PDMA_DAR_INC, u32ReadBytes);
+
+    if (i32Ch >= 0)
+    {
+        psXfer->pu32ReqCtl = &uuart->PDMACTL;
+        psXfer->u32ReqMsk = UUART_PDMACTL_RXPDMAEN_Msk;
+        uuart->PDMACTL |= UUART_PDMACTL_RXPDMAEN_Msk | UUART_PDMACTL_PDMAEN_Msk;
+    }
+
+    return i32Ch;
+}
+
+/**
+ *    @brief        Get receive position of the buffered driver
+ *
+ *    @param[in]    psBuf           The buffered driver state.
+ *
+ *    @return       Bytes written into the receive ring by PDMA since UUART_BufOpen()
+ *
+ *    @details      Same method as the UART buffered driver: NEXT names the table in progress and
+ *                  TXCNT the bytes it still waits for.
+ */
+static uint32_t UUART_BufRxHead(UUART_BUF_T *psBuf)
+{
+    uint32_t u32Seg = psBuf->u32RxSize / UUART_BUF_RX_SEG;
+    uint32_t u32Done, u32Ctl, u32Next, u32Idx, u32Pos, u32Ahead;
+
+    do
+    {
+        u32Done = psBuf->u32RxDone;
+        u32Next = PDMA->DSCT[psBuf->u32RxCh].NEXT;
+        u32Ctl = PDMA->DSCT[psBuf->u32RxCh].CTL;
+    }
+    while ((u32Next != PDMA->DSCT[psBuf->u32RxCh].NEXT) || (u32Done != psBuf->u32RxDone));
+
+    u32Idx = (((PDMA->SCATBA & PDMA_SCATBA_SCATBA_Msk) | (u32Next & PDMA_DSCT_NEXT_NEXT_Msk)) - (uint32_t)psBuf->psRxDesc) / sizeof(DSCT_T);
+    u32Idx = (u32Idx + UUART_BUF_RX_SEG - 1ul) % UUART_BUF_RX_SEG;
+    u32Pos = (u32Idx * u32Seg) + u32Seg - (((u32Ctl & PDMA_DSCT_CTL_TXCNT_Msk) >> PDMA_DSCT_CTL_TXCNT_Pos) + 1ul);
+    u32Ahead = (u32Pos - (u32Done * u32Seg)) & (psBuf->u32RxSize - 1ul);
+
+    if (u32Ahead >= (2ul * u32Seg))
+        u32Ahead = 0ul;
+
+    return (u32Done * u32Seg) + u32Ahead;
+}
+
+/**
+ *    @brief        PDMA event of the buffered driver receive ring
+ *
+ *    @param[in]    u32Ch           PDMA channel.
+ *    @param[in]    u32Event        PDMA_EVENT_DONE and/or PDMA_EVENT_TIMEOUT.
+ *    @param[in]    pvUserData      The buffered driver state.
+ *
+ *    @return       None
+ */
+static void UUART_BufRxEvent(uint32_t u32Ch, uint32_t u32Event, void *pvUserData)
+{
+    UUART_BUF_T *psBuf = (UUART_BUF_T *)pvUserData;
+    uint32_t u32Head;
+
+    (void)u32Ch;
+
+    if (u32Event & PDMA_EVENT_DONE)
+        psBuf->u32RxDone++;
+
+    u32Head = UUART_BufRxHead(psBuf);
+
+    if ((u32Head != psBuf->u32RxNotified) && (psBuf->pfnRxNotify != NULL))
+    {
+        psBuf->u32RxNotified = u32Head;
+        psBuf->pfnRxNotify(psBuf->pvUserData);
+    }
+}
+
+/**
+ *    @brief        Open buffered driver
+ *
+ *    @param[in]    uuart           The pointer of the specified UUART module.
+ *    @param[in]    psBuf           The buffered driver state. Ring storage, descriptor tables and
+ *                                  the optional notification must be set by caller.
+ *    @param[in]    u32IdleTOC      PDMA request time-out count that flushes a partial segment when the
+ *                                  line goes idle, in units of 256 HCLK << PDMA_T::TOUTPSC. 0 disables it.
+ *
+ *    @retval       >=0                 PDMA channel used by the receive ring
+ *    @retval       PDMA_XFER_NO_CH     All PDMA channels are in use
+ *    @retval       -1                  Invalid ring size or descriptor tables outside PDMA_T::SCATBA window
+ *
+ *    @details      USCI_UART must already be opened. Receive data is moved by a PDMA scatter-gather
+ *                  ring straight into pu8RxBuf; the time-out needs PDMA channel 0 or 1. Transmit data
+ *                  is fed to the TX buffer from the TX start interrupt, which stays enabled. The
+ *                  application USCI01_IRQHandler must call UUART_BufIRQHandler() and PDMA_IRQHandler
+ *                  must call PDMA_DispatchIRQ().
+ */
+int32_t UUART_BufOpen(UUART_T *uuart, UUART_BUF_T *psBuf, uint32_t u32IdleTOC)
+{
+    uint32_t au32Seg[UUART_BUF_RX_SEG], u32Seg, i;
+    int32_t i32Ch;
+
+    u32Seg = psBuf->u32RxSize / UUART_BUF_RX_SEG;
+
+    if ((u32Seg == 0ul) || (psBuf->u32RxSize & (psBuf->u32RxSize - 1ul)) ||
+            (psBuf->u32TxSize & (psBuf->u32TxSize - 1ul)))
+        return -1;
+
+    for (i = 0ul; i < UUART_BUF_RX_SEG; i++)
+        au32Seg[i] = (uint32_t)&psBuf->pu8RxBuf[i * u32Seg];
+
+    if (PDMA_BuildScatterChain(PDMA, psBuf->psRxDesc, au32Seg, UUART_BUF_RX_SEG, u32Seg, PDMA_WIDTH_8 | PDMA_REQ_SINGLE,
+                               (uint32_t)&uuart->RXDAT, PDMA_CHAIN_RX | PDMA_CHAIN_RING) != 0)
+        return -1;
+
+    i32Ch = (u32IdleTOC != 0ul) ? PDMA_RequestChannel(PDMA, PDMA_CH_TOUT) : -1;
+
+    if (i32Ch < 0)
+        i32Ch = PDMA_RequestChannel(PDMA, PDMA_CH_ANY);
+
+    if (i32Ch < 0)
+        return PDMA_XFER_NO_CH;
+
+    psBuf->u32RxCh = (uint32_t)i32Ch;
+    psBuf->u32RxDone = 0ul;
+    psBuf->u32RxTail = 0ul;
+    psBuf->u32RxLost = 0ul;
+    psBuf->u32RxNotified = 0ul;
+    psBuf->u32TxHead = 0ul;
+    psBuf->u32TxTail = 0ul;
+
+    PDMA_SetCallback(PDMA, psBuf->u32RxCh, UUART_BufRxEvent, psBuf);
+    PDMA_SetTransferMode(PDMA, psBuf->u32RxCh, UUART_GetPdmaReq(uuart) + 1ul, TRUE, (uint32_t)&psBuf->psRxDesc[0]);
+    PDMA_EnableInt(PDMA, psBuf->u32RxCh, PDMA_INT_TRANS_DONE);
+
+    if ((u32IdleTOC != 0ul) && ((1ul << psBuf->u32RxCh) & PDMA_CH_TOUT))
+    {
+        PDMA_SetTimeOut(PDMA, psBuf->u32RxCh, 1ul, u32IdleTOC);
+        PDMA_EnableInt(PDMA, psBuf->u32RxCh, PDMA_INT_TIMEOUT);
+    }
+
+    uuart->PDMACTL |= UUART_PDMACTL_RXPDMAEN_Msk | UUART_PDMACTL_PDMAEN_Msk;
+    uuart->INTEN |= UUART_INTEN_TXSTIEN_Msk;
+
+    return i32Ch;
+}
+
+/**
+ *    @brief        Close buffered driver
+ *
+ *    @param[in]    uuart           The pointer of the specified UUART module.
+ *    @param[in]    psBuf           The buffered driver state.
+ *
+ *    @return       None
+ *
+ *    @details      Receiving stops at once; data still in the transmit ring is discarded.
+ */
+void UUART_BufClose(UUART_T *uuart, UUART_BUF_T *psBuf)
+{
+    uuart->PDMACTL &= ~UUART_PDMACTL_RXPDMAEN_Msk;
+    uuart->INTEN &= ~UUART_INTEN_TXSTIEN_Msk;
+    PDMA_STOP(PDMA, psBuf->u32RxCh);
+    PDMA_ReleaseChannel(PDMA, psBuf->u32RxCh);
+}
+
+/**
+ *    @brief        Get number of received bytes not read yet
+ *
+ *    @param[in]    uuart           The pointer of the specified UUART module.
+ *    @param[in]    psBuf           The buffered driver state.
+ *
+ *    @return       Bytes UUART_BufRead() can return now, at most the receive ring size.
+ */
+uint32_t UUART_BufGetRxCount(UUART_T *uuart, UUART_BUF_T *psBuf)
+{
+    uint32_t u32Count = UUART_BufRxHead(psBuf) - psBuf->u32RxTail;
+
+    (void)uuart;
+
+    return (u32Count > psBuf->u32RxSize) ? psBuf->u32RxSize : u32Count;
+}
+
+/**
+ *    @brief        Read data from buffered driver
+ *
+ *    @param[in]    uuart           The pointer of the specified UUART module.
+ *    @param[in]    psBuf           The buffered driver state.
+ *    @param[out]   pu8RxBuf        The buffer to receive the data.
+ *    @param[in]    u32ReadBytes    The maximum number of bytes to read.
+ *
+ *    @return       Number of bytes read, 0 if nothing has been received.
+ *
+ *    @details      Never blocks. Bytes overwritten before this call are skipped and counted in u32RxLost.
+ */
+uint32_t UUART_BufRead(UUART_T *uuart, UUART_BUF_T *psBuf, uint8_t pu8RxBuf[], uint32_t u32ReadBytes)
+{
+    uint32_t u32Head, u32Tail, u32Count, u32Mask = psBuf->u32RxSize - 1ul, i;
+
+    (void)uuart;
+
+    u32Head = UUART_BufRxHead(psBuf);
+    u32Tail = psBuf->u32RxTail;
+    u32Count = u32Head - u32Tail;
+
+    if (u32Count > psBuf->u32RxSize)
+    {
+        psBuf->u32RxLost += u32Count - psBuf->u32RxSize;
+        u32Tail = u32Head - psBuf->u32RxSize;
+        u32Count = psBuf->u32RxSize;
+    }
+
+    if (u32Count > u32ReadBytes)
+        u32Count = u32ReadBytes;
+
+    for (i = 0ul; i < u32Count; i++)
+        pu8RxBuf[i] = psBuf->pu8RxBuf[(u32Tail + i) & u32Mask];
+
+    psBuf->u32RxTail = u32Tail + u32Count;
+
+    return u32Count;
+}
+
+/**
+ *    @brief        Write data to buffered driver
+ *
+ *    @param[in]    uuart           The pointer of the specified UUART module.
+ *    @param[in]    psBuf           The buffered driver state.
+ *    @param[in]    pu8TxBuf        The buffer to send the data.
+ *    @param[in]    u32WriteBytes   The number of bytes to send.
+ *
+ *    @return       Number of bytes queued, less than u32WriteBytes when the transmit ring is full.
+ *
+ *    @details      Never blocks. The USCI interrupt is set pending so that an idle transmitter is
+ *                  restarted from UUART_BufIRQHandler().
+ */
+uint32_t UUART_BufWrite(UUART_T *uuart, UUART_BUF_T *psBuf, uint8_t pu8TxBuf[], uint32_t u32WriteBytes)
+{
+    uint32_t u32Head = psBuf->u32TxHead, u32Free, u32Mask = psBuf->u32TxSize - 1ul, i;
+
+    (void)uuart;
+
+    u32Free = psBuf->u32TxSize - (u32Head - psBuf->u32TxTail);
+
+    if (u32WriteBytes > u32Free)
+        u32WriteBytes = u32Free;
+
+    for (i = 0ul; i < u32WriteBytes; i++)
+        psBuf->pu8TxBuf[(u32Head + i) & u32Mask] = pu8TxBuf[i];
+
+    psBuf->u32TxHead = u32Head + u32WriteBytes;
+
+    if (u32WriteBytes != 0ul)
+        NVIC_SetPendingIRQ(USCI01_IRQn);
+
+    return u32WriteBytes;
+}
+
+/**
+ *    @brief        Interrupt handler of buffered driver
+ *
+ *    @param[in]    uuart           The pointer of the specified UUART module.
+ *    @param[in]    psBuf           The buffered driver state.
+ *
+ *    @return       None
+ *
+ *    @details      Call from USCI01_IRQHandler. Clears the TX start flag and refills the TX buffer.
+ */
+void UUART_BufIRQHandler(UUART_T *uuart, UUART_BUF_T *psBuf)
+{
+    uint32_t u32Tail = psBuf->u32TxTail, u32Mask = psBuf->u32TxSize - 1ul;
+
+    if (uuart->PROTSTS & UUART_PROTSTS_TXSTIF_Msk)
+        uuart->PROTSTS = UUART_PROTSTS_TXSTIF_Msk;
+
+    while ((u32Tail != psBuf->u32TxHead) && !(uuart->BUFSTS & UUART_BUFSTS_TXFULL_Msk))
+    {
+        uuart->TXDAT = psBuf->pu8TxBuf[u32Tail & u32Mask];
+        u32Tail++;
+    }
+
+    psBuf->u32TxTail = u32Tail;
+}
+
 /*@}*/ /* end of group USCI_UART_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group USCI_UART_Driver */
@@ -0,0 +1,178 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Stream continuous scan ADC results through a PDMA block ring on the
+ *           host simulator.
+ * @note     ADC runs from a 32 MHz HXT (1.882 Msps) into four 256-sample
+ *           blocks that are used in place. The first run keeps up and checks
+ *           that the 12-bit ramp of the simulated input is unbroken across
+ *           blocks; the second run stalls the consumer to show overrun
+ *           reporting. Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NuMicro.h"
+#include "hostsim.h"
+
+#define TEST_HCLK           48000000UL
+#define BLK_NUM             4UL
+#define BLK_LEN             256UL
+#define RUN_BLOCKS          200UL
+#define SLOW_WORK_CYCLES    (BLK_LEN * 26UL * 6UL)  /* Consumer needs six block times per block */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static DSCT_T s_asDesc[BLK_NUM] __attribute__((aligned(16)));
+static uint16_t s_au16Ring[BLK_NUM * BLK_LEN] __attribute__((aligned(4)));
+static uint32_t s_u32Error = 0;
+
+void PDMA_IRQHandler(void)
+{
+    PDMA_DispatchIRQ(PDMA);
+}
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+
+    CLK_EnableXtalRC(CLK_PWRCTL_HIRCEN_Msk | CLK_PWRCTL_HXTEN_Msk);
+    CLK_WaitClockReady(CLK_STATUS_HIRCSTB_Msk | CLK_STATUS_HXTSTB_Msk);
+    CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(1));
+    CLK->PCLKDIV = (CLK_PCLKDIV_APB0DIV_DIV1 | CLK_PCLKDIV_APB1DIV_DIV1);
+
+    CLK_EnableModuleClock(ADC_MODULE);
+    CLK_SetModuleClock(ADC_MODULE, CLK_CLKSEL2_ADCSEL_HXT, CLK_CLKDIV0_ADC(1));
+    CLK_EnableModuleClock(PDMA_MODULE);
+
+    SystemCoreClockUpdate();
+}
+
+/* Consume u32Blocks blocks, spending u32Work HCLK cycles on each; return blocks whose ramp broke */
+static uint32_t Stream_Run(ADC_STREAM_T *psStream, uint32_t u32Blocks, uint32_t u32Work)
+{
+    uint16_t *pu16Blk;
+    uint32_t u32Got = 0UL, u32Broken = 0UL, i;
+
+    while(u32Got < u32Blocks)
+    {
+        pu16Blk = ADC_StreamGetBlock(psStream);
+        if(pu16Blk == NULL)
+        {
+            __WFI();
+            continue;
+        }
+
+        HostSim_Delay(u32Work);
+        for(i = 1UL; i < BLK_LEN; i++)
+        {
+            if(pu16Blk[i] != ((pu16Blk[i - 1UL] + 1UL) & 0xFFFUL))
+            {
+                break;
+            }
+        }
+        /* A block overwritten while in use is dropped even if it looks consistent */
+        if((ADC_StreamReleaseBlock(psStream) == 0) && (i != BLK_LEN))
+        {
+            u32Broken++;
+        }
+        u32Got++;
+    }
+    return u32Broken;
+}
+
+int main(void)
+{
+    ADC_STREAM_T sStream;
+    uint64_t u64Start, u64Lost;
+    uint16_t *pu16Blk;
+    uint32_t u32Prev, u32Gap = 0UL, u32Got = 0UL, i;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        printf("HostSim_Init failed\n");
+        return 1;
+    }
+
+    SYS_Init();
+    NVIC_EnableIRQ(PDMA_IRQn);
+    PDMA->SCATBA = (uint32_t)s_asDesc & PDMA_SCATBA_SCATBA_Msk;
+
+    ADC_POWER_ON(ADC);
+    ADC_Open(ADC, ADC_ADCR_DIFFEN_SINGLE_END, ADC_ADCR_ADMD_CONTINUOUS, BIT0);
+    ADC_SetExtendSampleTime(ADC, 0, 0);
+
+    sStream.pdma = PDMA;
+    sStream.psDesc = s_asDesc;
+    sStream.pu16Buf = s_au16Ring;
+    sStream.u32BlkNum = BLK_NUM;
+    sStream.u32BlkLen = BLK_LEN;
+
+    printf("\nADC streaming on HostSim, %u x %u sample ring\n", (unsigned)BLK_NUM, (unsigned)BLK_LEN);
+
+    /* Run 1: consumer keeps up, every sample must arrive in order */
+    u64Start = HostSim_GetCycle();
+    if(ADC_StreamStart(ADC, &sStream) < 0)
+    {
+        printf("ADC_StreamStart failed\n");
+        return 1;
+    }
+    u32Prev = 0xFFFFFFFFUL;
+    while(u32Got < RUN_BLOCKS)
+    {
+        pu16Blk = ADC_StreamGetBlock(&sStream);
+        if(pu16Blk == NULL)
+        {
+            __WFI();
+            continue;
+        }
+        for(i = 0UL; i < BLK_LEN; i++)
+        {
+            if((u32Prev != 0xFFFFFFFFUL) && (pu16Blk[i] != ((u32Prev + 1UL) & 0xFFFUL)))
+            {
+                u32Gap++;
+            }
+            u32Prev = pu16Blk[i];
+        }
+        ADC_StreamReleaseBlock(&sStream);
+        u32Got++;
+    }
+    ADC_StreamStop(ADC, &sStream);
+    HostSim_AdcGetConvCount(&u64Lost);
+
+    printf("%-24s %6u samples  %.3f Msps  gaps %u  lost blocks %u  %s\n", "Consumer keeps up",
+           (unsigned)(RUN_BLOCKS * BLK_LEN),
+           (double)(RUN_BLOCKS * BLK_LEN) * TEST_HCLK / (double)(HostSim_GetCycle() - u64Start) / 1e6,
+           (unsigned)u32Gap, (unsigned)ADC_STREAM_GET_LOST(&sStream),
+           ((u32Gap == 0UL) && (ADC_STREAM_GET_LOST(&sStream) == 0UL) && (u64Lost == 0ULL)) ? "PASS" : "FAIL");
+    if((u32Gap != 0UL) || (ADC_STREAM_GET_LOST(&sStream) != 0UL) || (u64Lost != 0ULL))
+    {
+        s_u32Error++;
+    }
+
+    /* Run 2: consumer too slow, PDMA laps it and the stream reports the lost blocks */
+    if(ADC_StreamStart(ADC, &sStream) < 0)
+    {
+        printf("ADC_StreamStart failed\n");
+        return 1;
+    }
+    i = Stream_Run(&sStream, 20UL, SLOW_WORK_CYCLES);
+    ADC_StreamStop(ADC, &sStream);
+
+    printf("%-24s %6u blocks   lost blocks %u  corrupt blocks kept %u  %s\n", "Consumer stalls",
+           20U, (unsigned)ADC_STREAM_GET_LOST(&sStream), (unsigned)i,
+           ((ADC_STREAM_GET_LOST(&sStream) != 0UL) && (i == 0UL)) ? "PASS" : "FAIL");
+    if((ADC_STREAM_GET_LOST(&sStream) == 0UL) || (i != 0UL))
+    {
+        s_u32Error++;
+    }
+
+    ADC_Close(ADC);
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
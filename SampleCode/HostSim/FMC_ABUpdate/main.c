@@ -0,0 +1,254 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    A/B firmware update with FMC_AB_* on the host simulator.
+ * @note     Bank A runs and keeps serving a 1 ms request loop while a new
+ *           image arrives in 64-byte pieces and is written to bank B one
+ *           FMC_AB_Poll() step at a time. The worst gap in the service loop
+ *           is compared with writing the same image in one go. The run then
+ *           goes through the boot selector: the trial boot of the new bank,
+ *           the automatic fall back when it is not confirmed, an instant
+ *           rollback, a confirmed update, a corrupted image, a record torn
+ *           by a reset and many records across both record pages.
+ *           Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NuMicro.h"
+#include "hostsim.h"
+
+#define TEST_HCLK           48000000UL
+#define BANK_A              0x04000UL
+#define BANK_B              0x14000UL
+#define BANK_SIZE           0x10000UL
+#define REC_PAGE0           0x24000UL
+#define REC_PAGE1           (REC_PAGE0 + FMC_FLASH_PAGE_SIZE)
+#define IMAGE_SIZE          (48UL * 1024UL + 100UL)
+#define CHUNK               64UL
+#define SERVICE_CYCLES      (TEST_HCLK / 1000UL)    /* A request to serve every 1 ms */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint8_t s_au8ImageA[BANK_SIZE];
+static uint8_t s_au8ImageB[BANK_SIZE];
+static uint8_t s_au8Flash[BANK_SIZE];
+static FMC_AB_T s_sAB;
+static uint32_t s_u32Error = 0;
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+
+    CLK_EnableXtalRC(CLK_PWRCTL_HIRCEN_Msk);
+    CLK_WaitClockReady(CLK_STATUS_HIRCSTB_Msk);
+    CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(1));
+    CLK_EnableModuleClock(ISP_MODULE);
+
+    SystemCoreClockUpdate();
+}
+
+static void Check(const char *pcName, uint32_t u32Pass)
+{
+    printf("%-40s %s\n", pcName, u32Pass ? "PASS" : "FAIL");
+    if(!u32Pass)
+    {
+        s_u32Error++;
+    }
+}
+
+/* CRC32 of an image padded with 0xFF to whole pages, as FMC_GetChkSum gives it */
+static uint32_t Image_Crc(const uint8_t *pu8Img, uint32_t u32Len)
+{
+    uint32_t u32Crc = 0xFFFFFFFFUL, u32Pad, i, j;
+    uint8_t u8;
+
+    u32Pad = (u32Len + FMC_FLASH_PAGE_SIZE - 1UL) & FMC_PAGE_ADDR_MASK;
+    for(i = 0UL; i < u32Pad; i++)
+    {
+        u8 = (i < u32Len) ? pu8Img[i] : 0xFFU;
+        u32Crc ^= u8;
+        for(j = 0UL; j < 8UL; j++)
+        {
+            u32Crc = (u32Crc >> 1) ^ (0xEDB88320UL & (0UL - (u32Crc & 1UL)));
+        }
+    }
+    return ~u32Crc;
+}
+
+/* What a reset does to the selector: a fresh FMC_AB_T read back from flash */
+static uint32_t Boot(void)
+{
+    uint32_t u32Base;
+
+    memset(&s_sAB, 0, sizeof(s_sAB));
+    s_sAB.au32Bank[0] = BANK_A;
+    s_sAB.au32Bank[1] = BANK_B;
+    s_sAB.u32BankSize = BANK_SIZE;
+    s_sAB.au32RecPage[0] = REC_PAGE0;
+    s_sAB.au32RecPage[1] = REC_PAGE1;
+    if(FMC_AB_Open(&s_sAB) != 0)
+    {
+        return 0xFFFFFFFFUL;
+    }
+
+    u32Base = FMC_AB_Select(&s_sAB);
+    FMC_SetVectorPageAddr(u32Base);
+    return (FMC_GetVECMAP() == u32Base) ? u32Base : 0xFFFFFFFFUL;
+}
+
+/* Feed an image while serving requests; returns the final FMC_AB state and the worst service gap */
+static uint32_t Update(const uint8_t *pu8Img, uint32_t u32Len, uint32_t u32Crc, uint32_t *pu32Served, uint64_t *pu64Worst)
+{
+    uint64_t u64Last, u64Now, u64NextReq;
+    uint32_t u32Pos = 0UL, u32State;
+
+    *pu32Served = 0UL;
+    *pu64Worst = 0ULL;
+    if(FMC_AB_Begin(&s_sAB, u32Len, u32Crc) != 0)
+    {
+        return FMC_AB_ERROR;
+    }
+
+    u64Last = u64NextReq = HostSim_GetCycle();
+    do
+    {
+        /* The application's own work: a request due every SERVICE_CYCLES */
+        u64Now = HostSim_GetCycle();
+        if(u64Now >= u64NextReq)
+        {
+            (*pu32Served)++;
+            u64NextReq += SERVICE_CYCLES;
+        }
+        if(u64Now - u64Last > *pu64Worst)
+        {
+            *pu64Worst = u64Now - u64Last;
+        }
+        u64Last = u64Now;
+
+        /* Update data trickles in from the link */
+        if(u32Pos < u32Len)
+        {
+            u32Pos += FMC_AB_Write(&s_sAB, &pu8Img[u32Pos], ((u32Len - u32Pos) > CHUNK) ? CHUNK : (u32Len - u32Pos));
+        }
+
+        u32State = FMC_AB_Poll(&s_sAB);
+        HostSim_Delay(200UL);
+    }
+    while(u32State == FMC_AB_BUSY);
+
+    return u32State;
+}
+
+int main(void)
+{
+    uint64_t u64Start, u64Worst, u64Blocking;
+    uint32_t u32Crc, u32State, u32Served, au32Junk[FMC_AB_REC_SIZE / 4], u32Seq, i;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        printf("HostSim_Init failed\n");
+        return 1;
+    }
+
+    SYS_Init();
+    FMC_Open();
+    FMC_ENABLE_AP_UPDATE();
+
+    for(i = 0UL; i < BANK_SIZE; i++)
+    {
+        s_au8ImageA[i] = (uint8_t)((i * 7UL) ^ (i >> 8));
+        s_au8ImageB[i] = (uint8_t)((i * 13UL) ^ (i >> 9) ^ 0xA5UL);
+    }
+    HostSim_FmcLoad(BANK_A, s_au8ImageA, IMAGE_SIZE);
+
+    printf("\nA/B update on HostSim, banks at 0x%05X and 0x%05X, %u KB each\n", (unsigned)BANK_A, (unsigned)BANK_B,
+           (unsigned)(BANK_SIZE / 1024UL));
+
+    /* Factory state: no records, bank A */
+    Check("No records: boot bank A", Boot() == BANK_A);
+
+    /* Reference: the whole image written in one go, nothing served meanwhile */
+    u64Start = HostSim_GetCycle();
+    for(i = 0UL; i < IMAGE_SIZE; i += FMC_FLASH_PAGE_SIZE)
+    {
+        memcpy(s_au8Flash, &s_au8ImageB[i], FMC_FLASH_PAGE_SIZE);
+        FMC_Erase(BANK_B + i);
+        FMC_WriteVerify(BANK_B + i, (uint32_t *)s_au8Flash, FMC_FLASH_PAGE_SIZE);
+    }
+    u64Blocking = HostSim_GetCycle() - u64Start;
+    for(i = 0UL; i < IMAGE_SIZE; i += FMC_FLASH_PAGE_SIZE)
+    {
+        FMC_Erase(BANK_B + i);
+    }
+
+    /* The background update */
+    u32Crc = Image_Crc(s_au8ImageB, IMAGE_SIZE);
+    u64Start = HostSim_GetCycle();
+    u32State = Update(s_au8ImageB, IMAGE_SIZE, u32Crc, &u32Served, &u64Worst);
+    u64Start = HostSim_GetCycle() - u64Start;
+    HostSim_FmcDump(BANK_B, s_au8Flash, IMAGE_SIZE);
+    printf("In one go:   %u ms without serving a request\n", (unsigned)(u64Blocking / (TEST_HCLK / 1000UL)));
+    printf("Background:  %u ms, %u requests served, worst gap %u us\n", (unsigned)(u64Start / (TEST_HCLK / 1000UL)),
+           (unsigned)u32Served, (unsigned)(u64Worst / (TEST_HCLK / 1000000UL)));
+    Check("Image written and verified", (u32State == FMC_AB_READY) && (memcmp(s_au8Flash, s_au8ImageB, IMAGE_SIZE) == 0));
+    Check("Worst gap one page erase at most", u64Worst <= (TEST_HCLK / 1000000UL) * 5000UL);
+    Check("Serving went on", u32Served * 2UL >= (uint32_t)(u64Start / SERVICE_CYCLES));
+    HostSim_FmcDump(BANK_A, s_au8Flash, IMAGE_SIZE);
+    Check("Running bank untouched", memcmp(s_au8Flash, s_au8ImageA, IMAGE_SIZE) == 0);
+
+    /* Switch, try, fall back */
+    Check("FMC_AB_Commit", FMC_AB_Commit(&s_sAB) == 0);
+    Check("Still bank A until reset", FMC_GetVECMAP() == BANK_A);
+    Check("Reset: trial boot of bank B", (Boot() == BANK_B) && (s_sAB.u32RecState == FMC_AB_REC_TRIAL));
+    Check("Begin refused before confirm", FMC_AB_Begin(&s_sAB, IMAGE_SIZE, u32Crc) != 0);
+    Check("Reset unconfirmed: back to bank A", (Boot() == BANK_A) && (s_sAB.u32RecState == FMC_AB_REC_OK));
+    Check("Instant rollback to bank B", (FMC_AB_Rollback(&s_sAB) == 0) && (Boot() == BANK_B) &&
+          (s_sAB.u32RecState == FMC_AB_REC_OK));
+
+    /* A confirmed update, into bank A this time */
+    for(i = 0UL; i < IMAGE_SIZE; i += 4096UL)
+    {
+        s_au8ImageA[i] ^= 0xFFU;
+    }
+    u32State = Update(s_au8ImageA, IMAGE_SIZE - 1000UL, Image_Crc(s_au8ImageA, IMAGE_SIZE - 1000UL), &u32Served, &u64Worst);
+    Check("Update into bank A", (u32State == FMC_AB_READY) && (FMC_AB_Commit(&s_sAB) == 0));
+    Check("Trial boot of bank A, confirmed", (Boot() == BANK_A) && (FMC_AB_Confirm(&s_sAB) == 0));
+    Check("Confirmed bank stays", (Boot() == BANK_A) && (s_sAB.u32RecState == FMC_AB_REC_OK));
+
+    /* Corrupted image: the CRC does not match, nothing is committed */
+    u32State = Update(s_au8ImageB, IMAGE_SIZE, u32Crc ^ 1UL, &u32Served, &u64Worst);
+    Check("Bad image CRC: FMC_AB_ERROR", (u32State == FMC_AB_ERROR) && (FMC_AB_Commit(&s_sAB) != 0));
+    Check("Bad image: rollback refused", FMC_AB_Rollback(&s_sAB) != 0);
+    Check("Bad image: bank A still boots", Boot() == BANK_A);
+
+    /* A record torn by a reset is skipped */
+    u32Seq = s_sAB.u32Seq;
+    memset(au32Junk, 0xFF, sizeof(au32Junk));
+    au32Junk[0] = 0x42414D46UL;
+    au32Junk[1] = u32Seq + 1UL;
+    au32Junk[2] = 1UL;
+    HostSim_FmcLoad(s_sAB.u32RecAddr, au32Junk, sizeof(au32Junk));
+    Check("Torn record ignored", (Boot() == BANK_A) && (s_sAB.u32Seq == u32Seq));
+    Check("Record after torn one", (FMC_AB_Confirm(&s_sAB) == 0) && (Update(s_au8ImageB, IMAGE_SIZE, u32Crc, &u32Served,
+            &u64Worst) == FMC_AB_READY) && (FMC_AB_Commit(&s_sAB) == 0) && (Boot() == BANK_B) && (FMC_AB_Confirm(&s_sAB) == 0));
+
+    /* Many switches: the records wrap through both record pages */
+    for(i = 0UL; i < 3UL * FMC_FLASH_PAGE_SIZE / FMC_AB_REC_SIZE; i++)
+    {
+        if(FMC_AB_Rollback(&s_sAB) != 0)
+        {
+            break;
+        }
+    }
+    Check("Records wrap through both pages", (i == 3UL * FMC_FLASH_PAGE_SIZE / FMC_AB_REC_SIZE) &&
+          (Boot() == ((i & 1UL) ? BANK_A : BANK_B)) && (s_sAB.u32RecState == FMC_AB_REC_OK));
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,301 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Drive the shared ISP engine over an in-memory transport on the
+ *           host simulator.
+ * @note     Only SampleCode/ISP/Common is built: no UART, SPI, I2C or USB.
+ *           Request frames are queued in memory and ISP_Poll hands them to
+ *           the engine, which programs the simulated FMC; the responses are
+ *           captured by the transport. The run covers an image programmed
+ *           with CMD_UPDATE_APROM, page CRCs and CMD_UPDATE_PAGE, CRC32
+ *           frames, the whole image CRC, transport commands through
+ *           pfnCommand, a transport without them and the security lock.
+ *           Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "hostsim.h"
+#include "isp_user.h"
+#include "isp_patch.h"
+
+#define TEST_HCLK           48000000UL
+#define IMAGE_SIZE          (8UL * 1024UL)
+#define MEM_QUEUE           4UL         /* Request frames the transport holds */
+#define CMD_MEM_ECHO        0x000000E0  /* Transport command of the test transport */
+
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint32_t s_au32Queue[MEM_QUEUE][ISP_FRAME_SIZE / 4];
+static uint32_t s_u32Head = 0UL, s_u32Tail = 0UL;
+static uint8_t s_au8Rsp[ISP_FRAME_SIZE];
+static uint32_t s_u32Sent = 0UL;
+static uint32_t s_u32HookCmd, s_u32HookLocked;
+static uint32_t s_u32PackNo;
+static uint32_t s_bCrc32 = FALSE;
+static uint8_t s_au8Image[IMAGE_SIZE];
+static uint8_t s_au8Flash[IMAGE_SIZE];
+static uint32_t s_u32Error = 0;
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+    CLK->PWRCTL |= CLK_PWRCTL_HIRCEN_Msk;
+
+    while (!(CLK->STATUS & CLK_STATUS_HIRCSTB_Msk));
+
+    CLK->CLKSEL0 = (CLK->CLKSEL0 & (~CLK_CLKSEL0_HCLKSEL_Msk)) | CLK_CLKSEL0_HCLKSEL_HIRC;
+    CLK->CLKDIV0 = (CLK->CLKDIV0 & (~CLK_CLKDIV0_HCLKDIV_Msk)) | CLK_CLKDIV0_HCLK(1);
+
+    SystemCoreClockUpdate();
+}
+
+static void Check(const char *pcName, uint32_t u32Pass)
+{
+    printf("%-40s %s\n", pcName, u32Pass ? "PASS" : "FAIL");
+    if(!u32Pass)
+    {
+        s_u32Error++;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* In-memory transport                                                                                     */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint8_t *MEM_RecvFrame(void)
+{
+    if(s_u32Tail == s_u32Head)
+    {
+        return NULL;
+    }
+
+    return (uint8_t *)s_au32Queue[s_u32Tail++ % MEM_QUEUE];
+}
+
+static void MEM_SendFrame(uint8_t *buf, uint32_t len)
+{
+    memcpy(s_au8Rsp, buf, len);
+    s_u32Sent++;
+}
+
+/* Answers CMD_MEM_ECHO with the argument inverted and records what the engine passed */
+static int MEM_Command(uint32_t cmd, unsigned char *arg, uint8_t *response, uint32_t locked)
+{
+    s_u32HookCmd = cmd;
+    s_u32HookLocked = locked;
+
+    if(cmd != CMD_MEM_ECHO)
+    {
+        return FALSE;
+    }
+
+    outpw(response + 8, ~inpw(arg));
+    return TRUE;
+}
+
+static const ISP_TRANSPORT_T s_sMemTransport = { MEM_RecvFrame, MEM_SendFrame, MEM_Command };
+static const ISP_TRANSPORT_T s_sBareTransport = { MEM_RecvFrame, MEM_SendFrame, NULL };
+
+/* Queue a 64-byte packet and poll the engine once. The response must carry the
+   packet number and the byte sum, or the CRC32 of the packet in CRC32 mode. */
+static int32_t Host_Packet(const ISP_TRANSPORT_T *psTransport, uint32_t u32Cmd, const uint32_t au32Arg[2],
+                           const uint8_t *pu8Data, uint32_t u32Len, uint8_t au8Rsp[64])
+{
+    uint8_t au8Pkt[64];
+    uint32_t u32Off = 8UL, u32Sent = s_u32Sent, i;
+    uint16_t u16Sum;
+
+    memset(au8Pkt, 0, sizeof(au8Pkt));
+    *(uint32_t *)&au8Pkt[0] = u32Cmd;
+    *(uint32_t *)&au8Pkt[4] = s_u32PackNo;
+    if(au32Arg != NULL)
+    {
+        memcpy(&au8Pkt[8], au32Arg, 8);
+        u32Off = 16UL;
+    }
+    memcpy(&au8Pkt[u32Off], pu8Data, u32Len);
+
+    for(u16Sum = 0, i = 0UL; i < 64UL; i++)
+    {
+        u16Sum += au8Pkt[i];
+    }
+
+    memcpy(s_au32Queue[s_u32Head++ % MEM_QUEUE], au8Pkt, sizeof(au8Pkt));
+    if(!ISP_Poll(psTransport) || (s_u32Sent != u32Sent + 1UL))
+    {
+        return -1;
+    }
+    memcpy(au8Rsp, s_au8Rsp, 64);
+
+    if(*(uint32_t *)&au8Rsp[4] != s_u32PackNo + 1UL)
+    {
+        return -1;
+    }
+    s_u32PackNo += 2UL;
+
+    if(s_bCrc32)
+    {
+        return (*(uint32_t *)&au8Rsp[0] == IspPatch_Crc32(au8Pkt, 64UL)) ? 0 : -1;
+    }
+    return ((au8Rsp[0] == (uint8_t)u16Sum) && (au8Rsp[1] == (uint8_t)(u16Sum >> 8))) ? 0 : -1;
+}
+
+static int32_t Host_Connect(const ISP_TRANSPORT_T *psTransport)
+{
+    uint8_t au8Rsp[64];
+
+    s_u32PackNo = 1UL;
+    s_bCrc32 = FALSE;
+    return Host_Packet(psTransport, CMD_CONNECT, NULL, NULL, 0, au8Rsp);
+}
+
+/* The stock protocol: 48 bytes in the first packet, 56 in each one after */
+static int32_t Host_FullUpload(const uint8_t *pu8Img, uint32_t u32Size)
+{
+    uint32_t au32Arg[2] = {0UL, u32Size};
+    uint8_t au8Rsp[64];
+    uint32_t u32Pos, u32Len;
+
+    if(Host_Packet(&s_sMemTransport, CMD_UPDATE_APROM, au32Arg, pu8Img, 48UL, au8Rsp) != 0)
+        return -1;
+
+    for(u32Pos = 48UL; u32Pos < u32Size; u32Pos += u32Len)
+    {
+        u32Len = ((u32Size - u32Pos) > 56UL) ? 56UL : (u32Size - u32Pos);
+        if(Host_Packet(&s_sMemTransport, 0UL, NULL, &pu8Img[u32Pos], u32Len, au8Rsp) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+/* One page by CMD_UPDATE_PAGE; returns the status of the last response */
+static int32_t Host_UpdatePage(uint32_t u32Addr, const uint8_t *pu8Page)
+{
+    uint32_t au32Arg[2] = {u32Addr, IspPatch_Crc32(pu8Page, FMC_FLASH_PAGE_SIZE)};
+    uint8_t au8Rsp[64];
+    uint32_t u32Pos, u32Len;
+
+    if(Host_Packet(&s_sMemTransport, CMD_UPDATE_PAGE, au32Arg, pu8Page, 48UL, au8Rsp) != 0)
+        return -1;
+
+    for(u32Pos = 48UL; (au8Rsp[8] == PAGE_ST_MORE) && (u32Pos < FMC_FLASH_PAGE_SIZE); u32Pos += u32Len)
+    {
+        u32Len = ((FMC_FLASH_PAGE_SIZE - u32Pos) > 56UL) ? 56UL : (FMC_FLASH_PAGE_SIZE - u32Pos);
+        if(Host_Packet(&s_sMemTransport, 0UL, NULL, &pu8Page[u32Pos], u32Len, au8Rsp) != 0)
+            return -1;
+    }
+
+    return au8Rsp[8];
+}
+
+int main(void)
+{
+    uint32_t au32Arg[2], au32Cfg[4], u32Sent, i;
+    uint8_t au8Rsp[64], au8Page[FMC_FLASH_PAGE_SIZE];
+    int32_t i32Ret;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        printf("HostSim_Init failed\n");
+        return 1;
+    }
+
+    SYS_Init();
+    FMC->ISPCTL |= (FMC_ISPCTL_ISPEN_Msk | FMC_ISPCTL_APUEN_Msk);
+    g_apromSize = GetApromSize();
+    GetDataFlashInfo(&g_dataFlashAddr, &g_dataFlashSize);
+
+    for(i = 0UL; i < IMAGE_SIZE; i++)
+    {
+        s_au8Image[i] = (uint8_t)((i * 7UL) ^ (i >> 8) ^ 0x5AUL);
+    }
+
+    printf("\nShared ISP engine over an in-memory transport, APROM %u KB\n", (unsigned)(g_apromSize / 1024UL));
+
+    /* Nothing queued: nothing parsed, nothing sent */
+    Check("Idle poll sends nothing", !ISP_Poll(&s_sMemTransport) && (s_u32Sent == 0UL));
+
+    Check("CMD_CONNECT", Host_Connect(&s_sMemTransport) == 0);
+    i32Ret = Host_Packet(&s_sMemTransport, CMD_GET_FWVER, NULL, NULL, 0, au8Rsp);
+    Check("CMD_GET_FWVER", (i32Ret == 0) && (au8Rsp[8] == FW_VERSION));
+
+    /* The stock upload */
+    i32Ret = Host_FullUpload(s_au8Image, IMAGE_SIZE);
+    HostSim_FmcDump(FMC_APROM_BASE, s_au8Flash, IMAGE_SIZE);
+    Check("CMD_UPDATE_APROM", (i32Ret == 0) && (memcmp(s_au8Flash, s_au8Image, IMAGE_SIZE) == 0));
+
+    au32Arg[0] = FMC_APROM_BASE;
+    au32Arg[1] = 2UL;
+    i32Ret = Host_Packet(&s_sMemTransport, CMD_GET_PAGE_CRC, au32Arg, NULL, 0, au8Rsp);
+    Check("CMD_GET_PAGE_CRC", (i32Ret == 0) && (*(uint32_t *)&au8Rsp[8] == 2UL) &&
+          (*(uint32_t *)&au8Rsp[12] == IspPatch_Crc32(s_au8Image, FMC_FLASH_PAGE_SIZE)) &&
+          (*(uint32_t *)&au8Rsp[16] == IspPatch_Crc32(&s_au8Image[FMC_FLASH_PAGE_SIZE], FMC_FLASH_PAGE_SIZE)));
+
+    /* One page changed, then sent again unchanged */
+    memcpy(au8Page, &s_au8Image[2UL * FMC_FLASH_PAGE_SIZE], sizeof(au8Page));
+    for(i = 0UL; i < 100UL; i++)
+    {
+        au8Page[300UL + i] ^= 0xA5U;
+    }
+    i32Ret = Host_UpdatePage(FMC_APROM_BASE + 2UL * FMC_FLASH_PAGE_SIZE, au8Page);
+    HostSim_FmcDump(FMC_APROM_BASE + 2UL * FMC_FLASH_PAGE_SIZE, s_au8Flash, sizeof(au8Page));
+    Check("CMD_UPDATE_PAGE", (i32Ret == PAGE_ST_DONE) && (memcmp(s_au8Flash, au8Page, sizeof(au8Page)) == 0));
+    u32Sent = s_u32Sent;
+    i32Ret = Host_UpdatePage(FMC_APROM_BASE + 2UL * FMC_FLASH_PAGE_SIZE, au8Page);
+    Check("Unchanged page takes one packet", (i32Ret == PAGE_ST_DONE) && (s_u32Sent == u32Sent + 1UL));
+    memcpy(&s_au8Image[2UL * FMC_FLASH_PAGE_SIZE], au8Page, sizeof(au8Page));
+
+    /* CRC32 frames from the packet after the switch */
+    au32Arg[0] = 1UL;
+    au32Arg[1] = 0UL;
+    i32Ret = Host_Packet(&s_sMemTransport, CMD_CRC32_MODE, au32Arg, NULL, 0, au8Rsp);
+    Check("CMD_CRC32_MODE", (i32Ret == 0) && (au8Rsp[8] == 1U));
+    s_bCrc32 = TRUE;
+
+    au32Arg[0] = FMC_APROM_BASE;
+    au32Arg[1] = IMAGE_SIZE - 100UL;
+    i32Ret = Host_Packet(&s_sMemTransport, CMD_GET_IMAGE_CRC, au32Arg, NULL, 0, au8Rsp);
+    Check("CMD_GET_IMAGE_CRC in CRC32 frames", (i32Ret == 0) && (*(uint32_t *)&au8Rsp[12] == IMAGE_SIZE) &&
+          (*(uint32_t *)&au8Rsp[8] == IspPatch_Crc32(s_au8Image, IMAGE_SIZE)));
+
+    /* Transport commands go to pfnCommand; engine commands never do */
+    au32Arg[0] = 0x12345678UL;
+    i32Ret = Host_Packet(&s_sMemTransport, CMD_MEM_ECHO, au32Arg, NULL, 0, au8Rsp);
+    Check("Transport command through pfnCommand", (i32Ret == 0) && (s_u32HookCmd == CMD_MEM_ECHO) &&
+          (*(uint32_t *)&au8Rsp[8] == 0xEDCBA987UL) && (s_u32HookLocked == FALSE));
+    s_u32HookCmd = 0UL;
+    i32Ret = Host_Packet(&s_sMemTransport, CMD_GET_FWVER, NULL, NULL, 0, au8Rsp);
+    Check("Engine command bypasses pfnCommand", (i32Ret == 0) && (s_u32HookCmd == 0UL));
+
+    /* Same engine, a transport without its own commands */
+    Check("Bare transport: CMD_CONNECT", Host_Connect(&s_sBareTransport) == 0);
+    i32Ret = Host_Packet(&s_sBareTransport, CMD_MEM_ECHO, au32Arg, NULL, 0, au8Rsp);
+    Check("Bare transport: command answered only", (i32Ret == 0) && (*(uint32_t *)&au8Rsp[8] != 0xEDCBA987UL));
+
+    /* Security lock set and APROM not erased in this session */
+    HostSim_FmcDump(FMC_CONFIG_BASE, au32Cfg, sizeof(au32Cfg));
+    au32Cfg[0] &= ~0x2UL;
+    HostSim_FmcLoad(FMC_CONFIG_BASE, au32Cfg, sizeof(au32Cfg));
+    bUpdateApromCmd = FALSE;
+    Check("Locked: CMD_CONNECT", Host_Connect(&s_sMemTransport) == 0);
+    au32Arg[0] = FMC_APROM_BASE;
+    au32Arg[1] = 2UL;
+    i32Ret = Host_Packet(&s_sMemTransport, CMD_GET_PAGE_CRC, au32Arg, NULL, 0, au8Rsp);
+    Check("Locked: no CRCs", (i32Ret == 0) && (*(uint32_t *)&au8Rsp[8] == 0UL));
+    Check("Locked: page update refused", Host_UpdatePage(FMC_APROM_BASE, au8Page) == PAGE_ST_REFUSED);
+    au32Arg[0] = 0UL;
+    i32Ret = Host_Packet(&s_sMemTransport, CMD_MEM_ECHO, au32Arg, NULL, 0, au8Rsp);
+    Check("Locked: pfnCommand told so", (i32Ret == 0) && (s_u32HookLocked == TRUE));
+    HostSim_FmcDump(FMC_APROM_BASE, s_au8Flash, IMAGE_SIZE);
+    Check("Locked: flash untouched", memcmp(s_au8Flash, s_au8Image, IMAGE_SIZE) == 0);
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,374 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Download an image through the ISP_DFU loader on the host
+ *           simulator, with flash programming overlapped with USB.
+ * @note     dfu_transfer.c, usbd_user.c and descriptors.c of ISP_DFU and
+ *           the shared Common/fmc_user.c are built unchanged. The USB host runs in SysTick_Handler,
+ *           one transaction per tick, and starts each control transfer on a
+ *           frame boundary as a host controller schedules it. It honours
+ *           bwPollTimeout. Meanwhile the main loop calls DFU_Poll() as the
+ *           loader does, so flash programming and the next DNLOAD share the
+ *           time; only the page erase stalls the CPU. Some blocks go LZ
+ *           compressed. The run checks the image, one GETSTATUS per block and
+ *           the time per block against the flash time, then a block too
+ *           large, a write error and an upload.
+ *           Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NuMicro.h"
+#include "hostsim.h"
+#include "dfu_transfer.h"
+#include "isp_lz.h"
+
+#define TEST_HCLK           48000000UL
+#define IMAGE_BLOCKS        64UL
+#define IMAGE_SIZE          (IMAGE_BLOCKS * TRANSFER_SIZE)
+#define HOST_TICK_US        20UL        /* One USB transaction per tick */
+#define CYCLES_PER_MS       (TEST_HCLK / 1000UL)
+
+/* Control transfer phases */
+#define XFER_SETUP          0UL
+#define XFER_DATA           1UL
+#define XFER_STATUS         2UL
+#define XFER_DONE           3UL
+
+/* Download sequence, run by the host in SysTick_Handler */
+#define SEQ_DNLOAD          0UL
+#define SEQ_GETSTATUS       1UL
+#define SEQ_FINISHED        2UL
+
+extern const S_USBD_INFO_T gsInfo;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint8_t au8Setup[8];
+    uint8_t *pu8Data;
+    uint32_t u32Len;
+    uint32_t u32Pos;
+    uint32_t u32Phase;
+    uint32_t u32Stall;
+} HOST_XFER_T;
+
+static HOST_XFER_T s_sXfer;
+static uint8_t s_au8Image[IMAGE_SIZE];
+static uint8_t s_au8Flash[IMAGE_SIZE];
+static uint8_t s_au8Block[ISP_LZ_MAX_SIZE(TRANSFER_SIZE)];
+static uint8_t s_au8Status[6];
+static uint32_t s_u32Seq, s_u32Block, s_u32Lz;
+static uint32_t s_u32Polls, s_u32Busy, s_u32MaxPoll, s_u32Error;
+static uint64_t s_u64Wake;
+static volatile uint32_t s_u32Done;
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+    CLK->PWRCTL |= CLK_PWRCTL_HIRCEN_Msk;
+
+    while (!(CLK->STATUS & CLK_STATUS_HIRCSTB_Msk));
+
+    CLK->CLKSEL0 = (CLK->CLKSEL0 & (~CLK_CLKSEL0_HCLKSEL_Msk)) | CLK_CLKSEL0_HCLKSEL_HIRC;
+    CLK->CLKDIV0 = (CLK->CLKDIV0 & (~CLK_CLKDIV0_HCLKDIV_Msk)) | CLK_CLKDIV0_HCLK(1);
+    CLK->APBCLK0 |= CLK_APBCLK0_USBDCKEN_Msk;
+    CLK->AHBCLK |= CLK_AHBCLK_ISPCKEN_Msk;
+
+    SystemCoreClockUpdate();
+}
+
+static void Check(const char *pcName, uint32_t u32Pass)
+{
+    printf("%-40s %s\n", pcName, u32Pass ? "PASS" : "FAIL");
+    if(!u32Pass)
+    {
+        s_u32Error++;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* USB host                                                                                                */
+/*---------------------------------------------------------------------------------------------------------*/
+static void Host_Start(uint8_t u8Type, uint8_t u8Req, uint16_t u16Value, uint8_t *pu8Data, uint16_t u16Len)
+{
+    s_sXfer.au8Setup[0] = u8Type;
+    s_sXfer.au8Setup[1] = u8Req;
+    s_sXfer.au8Setup[2] = (uint8_t)u16Value;
+    s_sXfer.au8Setup[3] = (uint8_t)(u16Value >> 8);
+    s_sXfer.au8Setup[4] = 0U;
+    s_sXfer.au8Setup[5] = 0U;
+    s_sXfer.au8Setup[6] = (uint8_t)u16Len;
+    s_sXfer.au8Setup[7] = (uint8_t)(u16Len >> 8);
+    s_sXfer.pu8Data = pu8Data;
+    s_sXfer.u32Len = u16Len;
+    s_sXfer.u32Pos = 0UL;
+    s_sXfer.u32Phase = XFER_SETUP;
+    s_sXfer.u32Stall = FALSE;
+}
+
+/* One transaction of the control transfer; a NAK is tried again on the next call.
+   Returns TRUE once the status stage is through or the device stalled. */
+static int32_t Host_Step(void)
+{
+    uint8_t au8Zlp[1] = {0};
+    uint32_t u32In = s_sXfer.au8Setup[0] & 0x80U, u32Len;
+    int32_t i32Ret = 0;
+
+    if(s_sXfer.u32Phase == XFER_SETUP)
+    {
+        HostSim_UsbdSetup(s_sXfer.au8Setup);
+        s_sXfer.u32Phase = s_sXfer.u32Len ? XFER_DATA : XFER_STATUS;
+        return FALSE;
+    }
+
+    if(s_sXfer.u32Phase == XFER_DATA)
+    {
+        u32Len = s_sXfer.u32Len - s_sXfer.u32Pos;
+        u32Len = (u32Len > EP0_MAX_PKT_SIZE) ? EP0_MAX_PKT_SIZE : u32Len;
+        if(u32In)
+        {
+            i32Ret = HostSim_UsbdIn(0, &s_sXfer.pu8Data[s_sXfer.u32Pos], u32Len);
+        }
+        else
+        {
+            i32Ret = HostSim_UsbdOut(0, &s_sXfer.pu8Data[s_sXfer.u32Pos], u32Len);
+        }
+        if(i32Ret >= 0)
+        {
+            s_sXfer.u32Pos += (uint32_t)i32Ret;
+            if((s_sXfer.u32Pos >= s_sXfer.u32Len) || ((uint32_t)i32Ret < EP0_MAX_PKT_SIZE))
+            {
+                s_sXfer.u32Phase = XFER_STATUS;
+            }
+        }
+    }
+    else if(s_sXfer.u32Phase == XFER_STATUS)
+    {
+        i32Ret = u32In ? HostSim_UsbdOut(0, au8Zlp, 0) : HostSim_UsbdIn(0, au8Zlp, 0);
+        if(i32Ret >= 0)
+        {
+            s_sXfer.u32Phase = XFER_DONE;
+        }
+    }
+
+    if(i32Ret == HOSTSIM_USB_STALL)
+    {
+        s_sXfer.u32Stall = TRUE;
+        s_sXfer.u32Phase = XFER_DONE;
+    }
+    return (s_sXfer.u32Phase == XFER_DONE);
+}
+
+/* A whole control transfer while the main loop runs, for the checks after the download */
+static int32_t Host_Control(uint8_t u8Type, uint8_t u8Req, uint16_t u16Value, uint8_t *pu8Data, uint16_t u16Len)
+{
+    uint32_t i;
+
+    Host_Start(u8Type, u8Req, u16Value, pu8Data, u16Len);
+    for(i = 0UL; !Host_Step(); i++)
+    {
+        if(i > 100000UL)
+            return -1;
+        if(!DFU_Poll())
+            HostSim_Delay(HOST_TICK_US * (TEST_HCLK / 1000000UL));
+    }
+    return s_sXfer.u32Stall ? -1 : 0;
+}
+
+static void Host_GetStatus(void)
+{
+    Host_Start(0xA1U, DFU_GETSTATUS, 0U, s_au8Status, sizeof(s_au8Status));
+}
+
+/* Next block, compressed when that saves a packet */
+static void Host_Dnload(void)
+{
+    int32_t i32Len;
+
+    if(s_u32Block == IMAGE_BLOCKS)
+    {
+        Host_Start(0x21U, DFU_DNLOAD, (uint16_t)s_u32Block, NULL, 0U);
+        return;
+    }
+
+    i32Len = IspLz_Encode(&s_au8Image[s_u32Block * TRANSFER_SIZE], TRANSFER_SIZE, s_au8Block, sizeof(s_au8Block));
+    if((i32Len > 0) && (i32Len <= (int32_t)(TRANSFER_SIZE - EP0_MAX_PKT_SIZE)))
+    {
+        s_u32Lz++;
+        Host_Start(0x21U, DFU_DNLOAD, (uint16_t)(s_u32Block | DFU_BLOCK_LZ), s_au8Block, (uint16_t)i32Len);
+    }
+    else
+    {
+        Host_Start(0x21U, DFU_DNLOAD, (uint16_t)s_u32Block, &s_au8Image[s_u32Block * TRANSFER_SIZE], TRANSFER_SIZE);
+    }
+}
+
+/* Next transfer after one is done; a new transfer waits for the next frame */
+static void Host_Sequence(void)
+{
+    uint64_t u64Now = HostSim_GetCycle();
+    uint32_t u32Poll;
+
+    s_u64Wake = (u64Now / CYCLES_PER_MS + 1UL) * CYCLES_PER_MS;
+
+    if(s_u32Seq == SEQ_DNLOAD)
+    {
+        s_u32Seq = SEQ_GETSTATUS;
+        Host_GetStatus();
+        return;
+    }
+
+    s_u32Polls++;
+    u32Poll = s_au8Status[1] | (s_au8Status[2] << 8) | (s_au8Status[3] << 16);
+    if(u32Poll > s_u32MaxPoll)
+    {
+        s_u32MaxPoll = u32Poll;
+    }
+    s_u64Wake += (uint64_t)u32Poll * CYCLES_PER_MS;
+
+    switch(s_au8Status[4])
+    {
+        case STATE_dfuDNLOAD_IDLE:
+            s_u32Block++;
+            s_u32Seq = SEQ_DNLOAD;
+            Host_Dnload();
+            break;
+
+        case STATE_dfuDNBUSY:
+        case STATE_dfuMANIFEST:
+            s_u32Busy++;
+            Host_GetStatus();
+            break;
+
+        default:
+            /* dfuIDLE after the manifestation, or an error */
+            s_u32Seq = SEQ_FINISHED;
+            s_u32Done = TRUE;
+            break;
+    }
+}
+
+void SysTick_Handler(void)
+{
+    if((s_u32Seq == SEQ_FINISHED) || (HostSim_GetCycle() < s_u64Wake))
+    {
+        return;
+    }
+
+    if(Host_Step())
+    {
+        Host_Sequence();
+    }
+}
+
+int main(void)
+{
+    uint64_t u64Start, u64Flash = 0;
+    uint32_t u32Blocks = 0UL, u32Ms, u32FlashMs, u32SerialMs, i;
+    uint8_t au8Big[TRANSFER_SIZE + EP0_MAX_PKT_SIZE];
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        printf("HostSim_Init failed\n");
+        return 1;
+    }
+
+    SYS_Init();
+    FMC->ISPCTL |= (FMC_ISPCTL_ISPEN_Msk | FMC_ISPCTL_APUEN_Msk);
+
+    /* Code-like data with some runs that compress */
+    for(i = 0UL; i < IMAGE_SIZE; i++)
+    {
+        s_au8Image[i] = (uint8_t)((i * 7UL) ^ (i >> 8) ^ 0x5AUL);
+        if(((i / TRANSFER_SIZE) % 4UL) == 3UL)
+        {
+            s_au8Image[i] = (uint8_t)((i & 0x30UL) ? 0xFFU : (i >> 4));
+        }
+    }
+
+    USBD_Open(&gsInfo, DFU_ClassRequest, NULL);
+    DFU_Init();
+    USBD_Start();
+    NVIC_EnableIRQ(USBD_IRQn);
+    HostSim_UsbdAttach(1);
+    HostSim_UsbdBusReset();
+
+    printf("\nISP_DFU download, %u blocks of %u bytes, host transfers on 1 ms frames\n", (unsigned)IMAGE_BLOCKS,
+           (unsigned)TRANSFER_SIZE);
+
+    /* The host in SysTick_Handler, DFU_Poll() in the main loop */
+    s_u32Seq = SEQ_DNLOAD;
+    s_u32Block = 0UL;
+    Host_Dnload();
+    s_u64Wake = 0UL;
+    u64Start = HostSim_GetCycle();
+    NVIC_SetPriority(SysTick_IRQn, 3);     /* Below USBD, as the device answers between transactions */
+    SysTick->LOAD = HOST_TICK_US * (TEST_HCLK / 1000000UL) - 1UL;
+    SysTick->VAL = 0UL;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+
+    while(!s_u32Done && (HostSim_GetCycle() - u64Start < 10000UL * CYCLES_PER_MS))
+    {
+        uint64_t u64Poll = HostSim_GetCycle();
+
+        if(DFU_Poll())
+        {
+            u64Flash += HostSim_GetCycle() - u64Poll;
+            u32Blocks++;
+        }
+        else
+        {
+            HostSim_Delay(HOST_TICK_US * (TEST_HCLK / 1000000UL));
+        }
+    }
+    SysTick->CTRL = 0UL;
+    u32Ms = (uint32_t)((HostSim_GetCycle() - u64Start) / CYCLES_PER_MS);
+    u32FlashMs = (uint32_t)(u64Flash / CYCLES_PER_MS);
+
+    /* Before, each block took its DNLOAD, five GETSTATUS transfers and the programming in between */
+    u32SerialMs = IMAGE_BLOCKS * 6UL + u32FlashMs;
+    printf("Download: %u ms, flash busy %u ms (%u us per block), %u blocks LZ\n", (unsigned)u32Ms,
+           (unsigned)u32FlashMs, (unsigned)(u64Flash / u32Blocks / (TEST_HCLK / 1000000UL)), (unsigned)s_u32Lz);
+    printf("Programming inside GETSTATUS after five polls: at least %u ms\n", (unsigned)u32SerialMs);
+
+    HostSim_FmcDump(FMC_APROM_BASE, s_au8Flash, IMAGE_SIZE);
+    Check("Download ends in dfuIDLE", s_u32Done && (s_au8Status[0] == STATUS_OK) &&
+          (s_au8Status[4] == STATE_dfuIDLE));
+    Check("Image in flash", (u32Blocks == IMAGE_BLOCKS) && (memcmp(s_au8Flash, s_au8Image, IMAGE_SIZE) == 0));
+    Check("LZ blocks taken", s_u32Lz > 0UL);
+    Check("One GETSTATUS per block", s_u32Polls <= IMAGE_BLOCKS + 1UL + s_u32Busy);
+    Check("Busy polls wait a block's program time", (s_u32Busy == 0UL) || (s_u32MaxPoll >= u32FlashMs / IMAGE_BLOCKS));
+    /* The CPU stalls for the page erase; the two transfers of a block and the rest of its programming overlap */
+    Check("Paced by the flash", u32Ms <= u32FlashMs + IMAGE_BLOCKS * 2UL);
+
+    /* wLength beyond wTransferSize */
+    Check("Block too large stalls", Host_Control(0x21U, DFU_DNLOAD, 0U, au8Big, sizeof(au8Big)) != 0);
+    Check("CLRSTATUS after the stall", Host_Control(0x21U, DFU_CLRSTATUS, 0U, NULL, 0U) == 0);
+
+    /* A block past the end of APROM fails in the main loop and shows at a later GETSTATUS */
+    Check("Block past APROM taken", Host_Control(0x21U, DFU_DNLOAD, 0x7FFFU, au8Big, TRANSFER_SIZE) == 0);
+    Check("GETSTATUS", Host_Control(0xA1U, DFU_GETSTATUS, 0U, s_au8Status, sizeof(s_au8Status)) == 0);
+    for(i = 0UL; (i < 100UL) && (s_au8Status[4] != STATE_dfuERROR); i++)
+    {
+        Host_Control(0xA1U, DFU_GETSTATUS, 0U, s_au8Status, sizeof(s_au8Status));
+    }
+    Check("Write error reported", (s_au8Status[4] == STATE_dfuERROR) && (s_au8Status[0] == STATUS_errWRITE));
+    Host_Control(0x21U, DFU_CLRSTATUS, 0U, NULL, 0U);
+    Host_Control(0xA1U, DFU_GETSTATUS, 0U, s_au8Status, sizeof(s_au8Status));
+    Check("CLRSTATUS back to dfuIDLE", (s_au8Status[4] == STATE_dfuIDLE) && (s_au8Status[0] == STATUS_OK));
+
+    /* Upload reads the flash back */
+    memset(au8Big, 0, sizeof(au8Big));
+    Check("UPLOAD", (Host_Control(0xA1U, DFU_UPLOAD, 5U, au8Big, TRANSFER_SIZE) == 0) &&
+          (memcmp(au8Big, &s_au8Image[5UL * TRANSFER_SIZE], TRANSFER_SIZE) == 0));
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
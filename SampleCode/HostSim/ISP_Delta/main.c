@@ -0,0 +1,465 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Apply page-level patches through the ISP_UART loader on the host
+ *           simulator.
+ * @note     The ISP_UART sources and the patch generator of ISP/HostTool are
+ *           built unchanged. A 64 KB image is programmed with the stock
+ *           CMD_UPDATE_APROM for reference, then a release that changes two
+ *           pages and grows by 1 KB is applied as a patch: the host reads the
+ *           page CRCs with CMD_GET_PAGE_CRC and sends only pages that differ
+ *           with CMD_UPDATE_PAGE. The run also covers a patch that is already
+ *           in, a packet corrupted on the line, a target that does not hold
+ *           the base image, pages outside APROM and the security lock.
+ *           Last, the FMC_IAP sample binaries shipped with the BSP are
+ *           programmed with CMD_UPDATE_PAGE_LZ and compared with raw pages.
+ *           Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hostsim.h"
+#include "targetdev.h"
+#include "uart_transfer.h"
+#include "isp_patch.h"
+#include "isp_lz.h"
+
+#define TEST_HCLK           48000000UL
+#define OLD_SIZE            (64UL * 1024UL)
+#define NEW_SIZE            (65UL * 1024UL)
+#define LOOP_CYCLES         4800UL      /* Loader main loop period, 100 us */
+#define PKT_TIMEOUT_MS      5000UL      /* CMD_UPDATE_APROM erases the whole APROM first */
+#define PAGE_TRIES          3UL
+#define CODE_BASE           0x20000UL   /* Where the FMC_IAP binaries are programmed */
+#define CODE_MAX            (16UL * 1024UL)
+
+/* Result of Host_ApplyPatch */
+#define APPLY_OK            0
+#define APPLY_LINK          -1          /* No or bad response after all tries */
+#define APPLY_REFUSED       -2          /* Security lock or page outside APROM and Data Flash */
+#define APPLY_NOT_BASE      -3          /* A page differs that the patch does not carry */
+
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint8_t s_au8Old[OLD_SIZE];
+static uint8_t s_au8New[NEW_SIZE];
+static uint8_t s_au8Flash[NEW_SIZE];
+static uint8_t s_au8Code[CODE_MAX];
+static const char *s_apcCode[] =
+{
+    "../../../StdDriver/FMC_IAP/GCC/LDROM_iap/LDROM_iap.bin",
+    "../../../StdDriver/FMC_IAP/IAR/Release/Exe/fmc_ld_iap.bin",
+    "../../../StdDriver/FMC_IAP/KEIL/Obj/fmc_ld_iap.bin",
+    "../../../RegBased/FMC_IAP/GCC/LDROM_iap/LDROM_iap.bin",
+    "../../../RegBased/FMC_IAP/IAR/Release/Exe/fmc_ld_iap.bin",
+    "../../../RegBased/FMC_IAP/KEIL/Obj/fmc_ld_iap.bin"
+};
+static uint32_t s_u32PackNo;
+static uint32_t s_u32Packets;
+static uint32_t s_u32CorruptAt = 0UL;   /* Packet to corrupt on the line, 0 for none */
+static uint32_t s_u32Error = 0;
+
+typedef struct
+{
+    uint32_t u32Written;
+    uint32_t u32Skipped;
+    uint32_t u32Retried;
+    uint32_t u32Compressed;
+} APPLY_STAT_T;
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+    CLK->PWRCTL |= CLK_PWRCTL_HIRCEN_Msk;
+
+    while (!(CLK->STATUS & CLK_STATUS_HIRCSTB_Msk));
+
+    CLK->CLKSEL0 = (CLK->CLKSEL0 & (~CLK_CLKSEL0_HCLKSEL_Msk)) | CLK_CLKSEL0_HCLKSEL_HIRC;
+    CLK->CLKDIV0 = (CLK->CLKDIV0 & (~CLK_CLKDIV0_HCLKDIV_Msk)) | CLK_CLKDIV0_HCLK(1);
+    CLK->APBCLK0 |= CLK_APBCLK0_UART0CKEN_Msk;
+    CLK->CLKSEL1 = (CLK->CLKSEL1 & (~CLK_CLKSEL1_UART0SEL_Msk)) | CLK_CLKSEL1_UART0SEL_HIRC;
+    CLK->CLKDIV0 = (CLK->CLKDIV0 & (~CLK_CLKDIV0_UART0DIV_Msk)) | CLK_CLKDIV0_UART0(1);
+
+    SystemCoreClockUpdate();
+}
+
+static void Check(const char *pcName, uint32_t u32Pass)
+{
+    printf("%-40s %s\n", pcName, u32Pass ? "PASS" : "FAIL");
+    if(!u32Pass)
+    {
+        s_u32Error++;
+    }
+}
+
+/* One pass of the ISP_UART main loop after CMD_CONNECT, packet mode only */
+static void Loader_Step(void)
+{
+    ISP_Poll(&g_sUartTransport);
+    HostSim_Delay(LOOP_CYCLES);
+}
+
+static uint32_t Host_Ms(uint64_t u64Start)
+{
+    return (uint32_t)((HostSim_GetCycle() - u64Start) / (TEST_HCLK / 1000UL));
+}
+
+/* Send a 64-byte packet and run the loader until its response is back. A response
+   that does not carry the packet checksum means the packet was damaged on the way. */
+static int32_t Host_Packet(uint32_t u32Cmd, const uint32_t au32Arg[2], const uint8_t *pu8Data, uint32_t u32Len,
+                           uint8_t au8Rsp[64])
+{
+    uint8_t au8Pkt[64];
+    uint32_t u32Got = 0, u32Off, i;
+    uint16_t u16Sum;
+    uint64_t u64Start;
+
+    memset(au8Pkt, 0, sizeof(au8Pkt));
+    memcpy(&au8Pkt[0], &u32Cmd, 4);
+    memcpy(&au8Pkt[4], &s_u32PackNo, 4);
+    u32Off = 8UL;
+    if(au32Arg != NULL)
+    {
+        memcpy(&au8Pkt[8], au32Arg, 8);
+        u32Off = 16UL;
+    }
+    memcpy(&au8Pkt[u32Off], pu8Data, u32Len);
+
+    for(u16Sum = 0, i = 0UL; i < 64UL; i++)
+    {
+        u16Sum += au8Pkt[i];
+    }
+    if(++s_u32Packets == s_u32CorruptAt)
+    {
+        au8Pkt[40] ^= 0x04U;
+    }
+
+    HostSim_UartInject(0, au8Pkt, sizeof(au8Pkt));
+    u64Start = HostSim_GetCycle();
+    while((u32Got < 64UL) && (Host_Ms(u64Start) < PKT_TIMEOUT_MS))
+    {
+        Loader_Step();
+        u32Got += HostSim_UartTake(0, &au8Rsp[u32Got], 64UL - u32Got);
+    }
+
+    if((u32Got != 64UL) || (*(uint32_t *)&au8Rsp[4] != s_u32PackNo + 1UL))
+    {
+        return -1;
+    }
+    s_u32PackNo += 2UL;
+
+    return ((au8Rsp[0] == (uint8_t)u16Sum) && (au8Rsp[1] == (uint8_t)(u16Sum >> 8))) ? 0 : -1;
+}
+
+static int32_t Host_Connect(void)
+{
+    uint8_t au8Rsp[64];
+
+    s_u32PackNo = 1UL;
+    return Host_Packet(CMD_CONNECT, NULL, NULL, 0, au8Rsp);
+}
+
+/* The stock protocol: 48 bytes in the first packet, 56 in each one after */
+static int32_t Host_FullUpload(const uint8_t *pu8Img, uint32_t u32Size)
+{
+    uint32_t au32Arg[2] = {0UL, u32Size};
+    uint8_t au8Rsp[64];
+    uint32_t u32Pos, u32Len;
+
+    if(Host_Packet(CMD_UPDATE_APROM, au32Arg, pu8Img, 48UL, au8Rsp) != 0)
+        return -1;
+
+    for(u32Pos = 48UL; u32Pos < u32Size; u32Pos += u32Len)
+    {
+        u32Len = ((u32Size - u32Pos) > 56UL) ? 56UL : (u32Size - u32Pos);
+        if(Host_Packet(0UL, NULL, &pu8Img[u32Pos], u32Len, au8Rsp) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+/* 64-byte packets for a page: 48 data bytes in the first, 56 in each one after */
+static uint32_t Page_Packets(uint32_t u32Len)
+{
+    return (u32Len <= 48UL) ? 1UL : (1UL + (u32Len - 48UL + 55UL) / 56UL);
+}
+
+/* One page by CMD_UPDATE_PAGE, or CMD_UPDATE_PAGE_LZ when that takes fewer packets.
+   Started over if a packet is damaged or the CRC does not match. */
+static int32_t Host_UpdatePage(uint32_t u32Addr, uint32_t u32Crc, const uint8_t *pu8Page, uint32_t u32Lz,
+                               APPLY_STAT_T *psStat)
+{
+    uint32_t au32Arg[2] = {u32Addr, u32Crc};
+    uint8_t au8Rsp[64], au8Lz[ISP_LZ_MAX_SIZE(ISP_PATCH_PAGE_SIZE)];
+    uint32_t u32Try, u32Pos, u32Len, u32St, u32Cmd = CMD_UPDATE_PAGE, u32Size = ISP_PATCH_PAGE_SIZE;
+    int32_t i32Lz;
+
+    if(u32Lz)
+    {
+        i32Lz = IspLz_Encode(pu8Page, ISP_PATCH_PAGE_SIZE, au8Lz, sizeof(au8Lz));
+        if((i32Lz > 0) && (Page_Packets((uint32_t)i32Lz) < Page_Packets(ISP_PATCH_PAGE_SIZE)))
+        {
+            u32Cmd = CMD_UPDATE_PAGE_LZ;
+            u32Size = (uint32_t)i32Lz;
+            pu8Page = au8Lz;
+            psStat->u32Compressed++;
+        }
+    }
+
+    for(u32Try = 0UL; u32Try < PAGE_TRIES; u32Try++)
+    {
+        if(u32Try)
+            psStat->u32Retried++;
+
+        if(Host_Packet(u32Cmd, au32Arg, pu8Page, (u32Size < 48UL) ? u32Size : 48UL, au8Rsp) != 0)
+            continue;
+
+        u32St = au8Rsp[8];
+        for(u32Pos = 48UL; (u32St == PAGE_ST_MORE) && (u32Pos < u32Size); u32Pos += u32Len)
+        {
+            u32Len = ((u32Size - u32Pos) > 56UL) ? 56UL : (u32Size - u32Pos);
+            if(Host_Packet(0UL, NULL, &pu8Page[u32Pos], u32Len, au8Rsp) != 0)
+                break;
+            u32St = au8Rsp[8];
+        }
+
+        if(u32St == PAGE_ST_DONE)
+            return APPLY_OK;
+        if(u32St == PAGE_ST_REFUSED)
+            return APPLY_REFUSED;
+    }
+
+    return APPLY_LINK;
+}
+
+/* Compare every page with the patch and send the ones that differ */
+static int32_t Host_ApplyPatch(const ISP_PATCH_T *psPatch, uint32_t u32Lz, APPLY_STAT_T *psStat)
+{
+    uint32_t au32Arg[2];
+    uint8_t au8Rsp[64];
+    uint32_t u32Page, u32Count, u32Crc, i;
+    const uint8_t *pu8Data;
+    int32_t i32Ret;
+
+    memset(psStat, 0, sizeof(*psStat));
+
+    for(u32Page = 0UL; u32Page < psPatch->u32Pages; u32Page += u32Count)
+    {
+        u32Count = psPatch->u32Pages - u32Page;
+        if(u32Count > PAGE_CRC_MAX)
+            u32Count = PAGE_CRC_MAX;
+
+        au32Arg[0] = psPatch->u32Base + u32Page * ISP_PATCH_PAGE_SIZE;
+        au32Arg[1] = u32Count;
+        if(Host_Packet(CMD_GET_PAGE_CRC, au32Arg, NULL, 0, au8Rsp) != 0)
+            return APPLY_LINK;
+        if(*(uint32_t *)&au8Rsp[8] != u32Count)
+            return APPLY_REFUSED;
+
+        for(i = 0UL; i < u32Count; i++)
+        {
+            u32Crc = IspPatch_PageCrc(psPatch, u32Page + i);
+            if(*(uint32_t *)&au8Rsp[12UL + i * 4UL] == u32Crc)
+            {
+                psStat->u32Skipped++;
+                continue;
+            }
+
+            if((pu8Data = IspPatch_PageData(psPatch, u32Page + i)) == NULL)
+                return APPLY_NOT_BASE;
+
+            i32Ret = Host_UpdatePage(psPatch->u32Base + (u32Page + i) * ISP_PATCH_PAGE_SIZE, u32Crc, pu8Data, u32Lz, psStat);
+            if(i32Ret != APPLY_OK)
+                return i32Ret;
+            psStat->u32Written++;
+        }
+    }
+
+    return APPLY_OK;
+}
+
+static int32_t Make_Patch(const uint8_t *pu8Old, uint32_t u32OldLen, const uint8_t *pu8New, uint32_t u32NewLen,
+                          uint32_t u32Base, ISP_PATCH_T *psPatch)
+{
+    static uint8_t *pu8Patch = NULL;
+    uint32_t u32Max = IspPatch_MaxSize(u32NewLen);
+    int32_t i32Len;
+
+    free(pu8Patch);
+    pu8Patch = malloc(u32Max);
+    i32Len = IspPatch_Create(pu8Old, u32OldLen, pu8New, u32NewLen, u32Base, pu8Patch, u32Max);
+    if((i32Len < 0) || (IspPatch_Parse(pu8Patch, (uint32_t)i32Len, psPatch) != 0))
+        return -1;
+    return i32Len;
+}
+
+int main(void)
+{
+    ISP_PATCH_T sPatch, sBack;
+    APPLY_STAT_T sStat;
+    uint32_t au32Arg[2], au32Cfg[4], u32FullMs, u32DeltaMs, u32Packets, u32CodeLen, i;
+    uint8_t au8Rsp[64], au8Page[ISP_PATCH_PAGE_SIZE];
+    uint64_t u64Start;
+    int32_t i32Ret, i32Len;
+    FILE *fp;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        printf("HostSim_Init failed\n");
+        return 1;
+    }
+
+    SYS_Init();
+    UART_Init();
+    FMC->ISPCTL |= (FMC_ISPCTL_ISPEN_Msk | FMC_ISPCTL_APUEN_Msk);
+    g_apromSize = GetApromSize();
+    GetDataFlashInfo(&g_dataFlashAddr, &g_dataFlashSize);
+
+    /* Release two: one constant changed, one routine rewritten, 1 KB added at the end */
+    for(i = 0UL; i < OLD_SIZE; i++)
+    {
+        s_au8Old[i] = (uint8_t)((i * 7UL) ^ (i >> 8) ^ 0x5AUL);
+    }
+    memcpy(s_au8New, s_au8Old, OLD_SIZE);
+    s_au8New[3UL * ISP_PATCH_PAGE_SIZE + 100UL] ^= 0xFFU;
+    for(i = 0UL; i < 300UL; i++)
+    {
+        s_au8New[50UL * ISP_PATCH_PAGE_SIZE + 200UL + i] = (uint8_t)(i * 13UL);
+    }
+    for(i = OLD_SIZE; i < NEW_SIZE; i++)
+    {
+        s_au8New[i] = (uint8_t)(i * 3UL);
+    }
+
+    printf("\nISP_UART page patch on HostSim, APROM %u KB, 115200 bps\n", (unsigned)(g_apromSize / 1024UL));
+
+    /* Reference: the whole image the stock way */
+    Check("CMD_CONNECT", Host_Connect() == 0);
+    s_u32Packets = 0UL;
+    u64Start = HostSim_GetCycle();
+    i32Ret = Host_FullUpload(s_au8Old, OLD_SIZE);
+    u32FullMs = Host_Ms(u64Start);
+    HostSim_FmcDump(FMC_APROM_BASE, s_au8Flash, OLD_SIZE);
+    printf("Full image:  %u KB, %u packets, %u ms\n", (unsigned)(OLD_SIZE / 1024UL), (unsigned)s_u32Packets,
+           (unsigned)u32FullMs);
+    Check("CMD_UPDATE_APROM", (i32Ret == 0) && (memcmp(s_au8Flash, s_au8Old, OLD_SIZE) == 0));
+
+    /* The patch */
+    i32Len = Make_Patch(s_au8Old, OLD_SIZE, s_au8New, NEW_SIZE, FMC_APROM_BASE, &sPatch);
+    printf("Patch:       %u of %u pages carried, %d bytes\n", (unsigned)sPatch.u32Carried, (unsigned)sPatch.u32Pages,
+           (int)i32Len);
+    Check("Patch carries changed pages only", (i32Len > 0) && (sPatch.u32Carried == 4UL) &&
+          (IspPatch_PageData(&sPatch, 3UL) != NULL) && (IspPatch_PageData(&sPatch, 50UL) != NULL) &&
+          (IspPatch_PageData(&sPatch, 4UL) == NULL));
+
+    s_u32Packets = 0UL;
+    u64Start = HostSim_GetCycle();
+    i32Ret = Host_ApplyPatch(&sPatch, FALSE, &sStat);
+    u32DeltaMs = Host_Ms(u64Start);
+    u32Packets = s_u32Packets;
+    HostSim_FmcDump(FMC_APROM_BASE, s_au8Flash, NEW_SIZE);
+    printf("Patch apply: %u written, %u unchanged, %u packets, %u ms\n", (unsigned)sStat.u32Written,
+           (unsigned)sStat.u32Skipped, (unsigned)u32Packets, (unsigned)u32DeltaMs);
+    Check("Patch applied", (i32Ret == APPLY_OK) && (sStat.u32Written == 4UL) &&
+          (memcmp(s_au8Flash, s_au8New, NEW_SIZE) == 0));
+    Check("Patch at least 10x faster", u32DeltaMs * 10UL < u32FullMs);
+
+    /* Applying it again only reads CRCs */
+    s_u32Packets = 0UL;
+    i32Ret = Host_ApplyPatch(&sPatch, FALSE, &sStat);
+    Check("Patch already in writes nothing", (i32Ret == APPLY_OK) && (sStat.u32Written == 0UL) &&
+          (s_u32Packets == (sPatch.u32Pages + PAGE_CRC_MAX - 1UL) / PAGE_CRC_MAX));
+
+    /* Back to the old release with a packet damaged in the middle of a page */
+    Make_Patch(s_au8New, NEW_SIZE, s_au8Old, OLD_SIZE, FMC_APROM_BASE, &sBack);
+    s_u32Packets = 0UL;
+    s_u32CorruptAt = 6UL;
+    i32Ret = Host_ApplyPatch(&sBack, FALSE, &sStat);
+    s_u32CorruptAt = 0UL;
+    HostSim_FmcDump(FMC_APROM_BASE, s_au8Flash, OLD_SIZE);
+    Check("Damaged packet restarts the page", (i32Ret == APPLY_OK) && (sStat.u32Retried == 1UL) &&
+          (memcmp(s_au8Flash, s_au8Old, OLD_SIZE) == 0));
+
+    /* Target holds something else than the patch base */
+    memset(au8Page, 0x11, sizeof(au8Page));
+    HostSim_FmcLoad(FMC_APROM_BASE + 10UL * ISP_PATCH_PAGE_SIZE, au8Page, sizeof(au8Page));
+    i32Ret = Host_ApplyPatch(&sPatch, FALSE, &sStat);
+    HostSim_FmcDump(FMC_APROM_BASE + 10UL * ISP_PATCH_PAGE_SIZE, s_au8Flash, ISP_PATCH_PAGE_SIZE);
+    Check("Wrong base detected", (i32Ret == APPLY_NOT_BASE) && (memcmp(s_au8Flash, au8Page, sizeof(au8Page)) == 0));
+
+    /* Pages outside APROM and Data Flash */
+    au32Arg[0] = FMC_LDROM_BASE;
+    au32Arg[1] = 0UL;
+    i32Ret = Host_Packet(CMD_UPDATE_PAGE, au32Arg, au8Page, 48UL, au8Rsp);
+    Check("LDROM page refused", (i32Ret == 0) && (au8Rsp[8] == PAGE_ST_REFUSED));
+    au32Arg[0] = g_apromSize - 2UL * ISP_PATCH_PAGE_SIZE;
+    au32Arg[1] = 5UL;
+    i32Ret = Host_Packet(CMD_GET_PAGE_CRC, au32Arg, NULL, 0, au8Rsp);
+    Check("CRCs stop at the APROM end", (i32Ret == 0) && (*(uint32_t *)&au8Rsp[8] == 2UL));
+
+    /* Real code: the FMC_IAP binaries one after another, into blank flash, raw then compressed */
+    for(i = 0UL, u32CodeLen = 0UL; i < sizeof(s_apcCode) / sizeof(s_apcCode[0]); i++)
+    {
+        if((fp = fopen(s_apcCode[i], "rb")) != NULL)
+        {
+            u32CodeLen += (uint32_t)fread(&s_au8Code[u32CodeLen], 1, CODE_MAX - u32CodeLen, fp);
+            fclose(fp);
+        }
+    }
+    Make_Patch(NULL, 0UL, s_au8Code, u32CodeLen, CODE_BASE, &sPatch);
+
+    s_u32Packets = 0UL;
+    u64Start = HostSim_GetCycle();
+    i32Ret = Host_ApplyPatch(&sPatch, FALSE, &sStat);
+    u32FullMs = Host_Ms(u64Start);
+    u32Packets = s_u32Packets;
+    HostSim_FmcDump(CODE_BASE, s_au8Flash, u32CodeLen);
+    printf("Raw pages:   %u B of code, %u pages, %u packets, %u ms\n", (unsigned)u32CodeLen, (unsigned)sStat.u32Written,
+           (unsigned)u32Packets, (unsigned)u32FullMs);
+    Check("CMD_UPDATE_PAGE", (u32CodeLen > 8UL * 1024UL) && (i32Ret == APPLY_OK) &&
+          (memcmp(s_au8Flash, s_au8Code, u32CodeLen) == 0));
+
+    memset(s_au8Flash, 0xFF, sizeof(s_au8Flash));
+    HostSim_FmcLoad(CODE_BASE, s_au8Flash, sPatch.u32Pages * ISP_PATCH_PAGE_SIZE);
+    s_u32Packets = 0UL;
+    u64Start = HostSim_GetCycle();
+    i32Ret = Host_ApplyPatch(&sPatch, TRUE, &sStat);
+    u32DeltaMs = Host_Ms(u64Start);
+    HostSim_FmcDump(CODE_BASE, s_au8Flash, u32CodeLen);
+    printf("LZ pages:    %u of %u pages compressed, %u packets, %u ms\n", (unsigned)sStat.u32Compressed,
+           (unsigned)sStat.u32Written, (unsigned)s_u32Packets, (unsigned)u32DeltaMs);
+    Check("CMD_UPDATE_PAGE_LZ", (i32Ret == APPLY_OK) && (sStat.u32Compressed > 0UL) &&
+          (memcmp(s_au8Flash, s_au8Code, u32CodeLen) == 0));
+    Check("At least 20% fewer packets", s_u32Packets * 10UL <= u32Packets * 8UL);
+
+    /* A match reaching before the start of the page */
+    memset(au8Page, 0, sizeof(au8Page));
+    au8Page[0] = 0x01U;
+    au8Page[1] = 0x10U;
+    au32Arg[0] = CODE_BASE;
+    au32Arg[1] = 0x12345678UL;
+    i32Ret = Host_Packet(CMD_UPDATE_PAGE_LZ, au32Arg, au8Page, 48UL, au8Rsp);
+    Check("Corrupt compressed page rejected", (i32Ret == 0) && (au8Rsp[8] == PAGE_ST_PROG_FAIL));
+
+    /* Security lock set and APROM not erased in this session */
+    HostSim_FmcDump(FMC_CONFIG_BASE, au32Cfg, sizeof(au32Cfg));
+    au32Cfg[0] &= ~0x2UL;
+    HostSim_FmcLoad(FMC_CONFIG_BASE, au32Cfg, sizeof(au32Cfg));
+    bUpdateApromCmd = FALSE;
+    au32Arg[0] = FMC_APROM_BASE;
+    au32Arg[1] = 4UL;
+    i32Ret = Host_Packet(CMD_GET_PAGE_CRC, au32Arg, NULL, 0, au8Rsp);
+    Check("Locked: no CRCs", (i32Ret == 0) && (*(uint32_t *)&au8Rsp[8] == 0UL));
+    Check("Locked: page update refused", Host_ApplyPatch(&sPatch, FALSE, &sStat) == APPLY_REFUSED);
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,502 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Program several ISP_RS485 nodes at once over a multidrop bus on the
+ *           host simulator.
+ * @note     The ISP_RS485 sources are built unchanged with RS485_MULTIDROP set;
+ *           only the loader main loop is repeated here. Every node is a process
+ *           of its own with its own simulated chip, and all of them see each
+ *           request the host puts on the bus. Five nodes join a group, a sixth
+ *           stays out. The image goes to the group once; one node misses a
+ *           part, another gets a part with a wrong byte and a third already
+ *           holds half the image. Each node is then asked for its image CRC32
+ *           and the pages it misses, and those pages go to the group again.
+ *           Build with Linux/Makefile, which also builds the run with 2 KB
+ *           pages (PAGE_SIZE_2048) as ISP_RS485_Multicast_2K.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "hostsim.h"
+#include "targetdev.h"
+#include "uart_transfer.h"
+#include "isp_mcast.h"
+#include "isp_patch.h"
+
+#define TEST_HCLK           48000000UL
+#define TEST_BAUD           115200UL
+#define CHAR_NS             (11UL * 1000000000UL / TEST_BAUD)   /* Start, 8 data, address and stop bit */
+#define LOOP_CYCLES         4800UL      /* Loader main loop period, 100 us */
+#define ANSWER_MS           20UL        /* Turnaround and the 64-byte answer of a node */
+
+#define NODE_NUM            6UL
+#define NODE_OUTSIDE        5UL         /* Does not join the group */
+#define NODE_LOSES          1UL         /* Misses a part of LOST_PAGE */
+#define NODE_CORRUPT        3UL         /* Gets a wrong byte in a part of CORRUPT_PAGE */
+#define NODE_HALF           2UL         /* Holds the first HALF_PAGES of the image already */
+#define GROUP_ADDR          0x80U
+#define LOST_PAGE           7UL
+#define CORRUPT_PAGE        20UL
+#define HALF_PAGES          16UL
+
+#define IMAGE_PAGES         32UL
+#define IMAGE_SIZE          (IMAGE_PAGES * FMC_FLASH_PAGE_SIZE - 200UL)
+
+/* Requests from the bus to a node */
+#define BUS_DUMP            0x100UL     /* Send back the flash and the page erase count */
+#define LINE_OK             0UL
+#define LINE_LOST           1UL         /* Noise, the node sees none of the request */
+#define LINE_BAD_BYTE       2UL         /* One data byte flipped */
+
+typedef struct
+{
+    uint32_t u32Addr;           /* Address byte, or BUS_DUMP */
+    uint32_t u32Us;             /* Bus time of the request, answer and pause included */
+    uint32_t u32Line;
+    uint8_t  au8Frame[64];
+} BUS_MSG_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint8_t s_au8Image[IMAGE_PAGES * FMC_FLASH_PAGE_SIZE];
+static uint8_t s_au8Old[IMAGE_PAGES * FMC_FLASH_PAGE_SIZE];
+static uint8_t s_au8Flash[IMAGE_PAGES * FMC_FLASH_PAGE_SIZE];
+static int s_aiToNode[NODE_NUM], s_aiFromNode[NODE_NUM];
+static uint32_t s_au32Line[NODE_NUM];
+static uint32_t s_bIsp;
+static uint64_t s_u64BusNs;
+static uint32_t s_u32PageFrames;
+static uint32_t s_u32Error = 0;
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+    CLK->PWRCTL |= CLK_PWRCTL_HIRCEN_Msk;
+
+    while (!(CLK->STATUS & CLK_STATUS_HIRCSTB_Msk));
+
+    CLK->CLKSEL0 = (CLK->CLKSEL0 & (~CLK_CLKSEL0_HCLKSEL_Msk)) | CLK_CLKSEL0_HCLKSEL_HIRC;
+    CLK->CLKDIV0 = (CLK->CLKDIV0 & (~CLK_CLKDIV0_HCLKDIV_Msk)) | CLK_CLKDIV0_HCLK(1);
+    CLK->APBCLK0 |= CLK_APBCLK0_UART1CKEN_Msk;
+    CLK->CLKSEL1 = (CLK->CLKSEL1 & (~CLK_CLKSEL1_UART1SEL_Msk)) | CLK_CLKSEL1_UART1SEL_HIRC;
+    CLK->CLKDIV0 = (CLK->CLKDIV0 & (~CLK_CLKDIV0_UART1DIV_Msk)) | CLK_CLKDIV0_UART1(1);
+    CLK->AHBCLK |= CLK_AHBCLK_ISPCKEN_Msk;
+
+    SystemCoreClockUpdate();
+}
+
+static void Check(const char *pcName, uint32_t u32Pass)
+{
+    printf("%-40s %s\n", pcName, u32Pass ? "PASS" : "FAIL");
+    if(!u32Pass)
+    {
+        s_u32Error++;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Node, one process per chip                                                                              */
+/*---------------------------------------------------------------------------------------------------------*/
+/* One pass of the ISP_RS485 main loop */
+static void Node_Step(void)
+{
+    if(s_bIsp)
+    {
+        ISP_Poll(&g_sUartTransport);
+    }
+    else if((bufhead >= 4) || (bUartDataReady == TRUE))
+    {
+        if(inpw(uart_rcvbuf) == CMD_CONNECT)
+        {
+            s_bIsp = TRUE;
+        }
+        else
+        {
+            bUartDataReady = FALSE;
+            bufhead = 0;
+        }
+    }
+
+    HostSim_Delay(LOOP_CYCLES);
+}
+
+static void Node_Main(uint32_t u32Node, int fdIn, int fdOut)
+{
+    BUS_MSG_T sMsg;
+    HOSTSIM_FMC_STAT_T sStat;
+    uint8_t au8Rsp[64];
+    uint32_t u32Got;
+    uint64_t u64End;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        _exit(1);
+    }
+
+    SYS_Init();
+    HostSim_FmcLoad(FMC_APROM_BASE, s_au8Old, sizeof(s_au8Old));
+    if(u32Node == NODE_HALF)
+    {
+        HostSim_FmcLoad(FMC_APROM_BASE, s_au8Image, HALF_PAGES * FMC_FLASH_PAGE_SIZE);
+    }
+
+    FMC->ISPCTL |= (FMC_ISPCTL_ISPEN_Msk | FMC_ISPCTL_APUEN_Msk);
+    g_apromSize = GetApromSize();
+    GetDataFlashInfo(&g_dataFlashAddr, &g_dataFlashSize);
+    g_u8NodeAddr = (uint8_t)(RS485_NODE_ADDR + u32Node);
+    UART_Init();
+
+    while(read(fdIn, &sMsg, sizeof(sMsg)) == (ssize_t)sizeof(sMsg))
+    {
+        if(sMsg.u32Addr == BUS_DUMP)
+        {
+            HostSim_FmcDump(FMC_APROM_BASE, s_au8Flash, sizeof(s_au8Flash));
+            HostSim_FmcGetStat(&sStat);
+            if((write(fdOut, s_au8Flash, sizeof(s_au8Flash)) < 0) || (write(fdOut, &sStat, sizeof(sStat)) < 0))
+            {
+                break;
+            }
+            continue;
+        }
+
+        if(sMsg.u32Line != LINE_LOST)
+        {
+            HostSim_UartInjectAddress(1, (uint8_t)sMsg.u32Addr);
+            HostSim_UartInject(1, sMsg.au8Frame, sizeof(sMsg.au8Frame));
+        }
+
+        /* Everyone runs for as long as the request keeps the bus */
+        u64End = HostSim_GetCycle() + (uint64_t)sMsg.u32Us * (TEST_HCLK / 1000000UL);
+        u32Got = 0UL;
+        while(HostSim_GetCycle() < u64End)
+        {
+            Node_Step();
+            u32Got += HostSim_UartTake(1, &au8Rsp[u32Got], sizeof(au8Rsp) - u32Got);
+        }
+
+        if((write(fdOut, &u32Got, sizeof(u32Got)) < 0) || (write(fdOut, au8Rsp, sizeof(au8Rsp)) < 0))
+        {
+            break;
+        }
+    }
+
+    HostSim_Close();
+    _exit(0);
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Host                                                                                                    */
+/*---------------------------------------------------------------------------------------------------------*/
+static void Bus_ReadAll(int fd, void *pvBuf, uint32_t u32Len)
+{
+    uint8_t *pu8Buf = (uint8_t *)pvBuf;
+    ssize_t n;
+
+    while(u32Len)
+    {
+        n = read(fd, pu8Buf, u32Len);
+        if(n <= 0)
+        {
+            memset(pu8Buf, 0, u32Len);
+            return;
+        }
+        pu8Buf += n;
+        u32Len -= (uint32_t)n;
+    }
+}
+
+/* Put a request on the bus. A node address waits for that node's answer and returns 0 if
+   it checks out; a group address returns the bytes any node sent, which must be none. */
+static int32_t Bus_Request(uint8_t u8Addr, uint32_t u32Cmd, const uint32_t *pu32Arg, uint32_t u32Args,
+                           const uint8_t *pu8Data, uint32_t u32Len, uint32_t u32PauseMs, uint8_t au8Rsp[64])
+{
+    static uint32_t s_u32PackNo = 1UL;
+    BUS_MSG_T sMsg;
+    uint8_t au8Got[64];
+    uint32_t u32Got, u32Any = 0UL, u32Answer = ((u8Addr - RS485_NODE_ADDR) < NODE_NUM), i;
+    uint16_t u16Sum;
+    int32_t i32Ret = -1;
+
+    memset(&sMsg, 0, sizeof(sMsg));
+    sMsg.u32Addr = u8Addr;
+    memcpy(&sMsg.au8Frame[0], &u32Cmd, 4);
+    memcpy(&sMsg.au8Frame[4], &s_u32PackNo, 4);
+    memcpy(&sMsg.au8Frame[8], pu32Arg, u32Args * 4UL);
+    memcpy(&sMsg.au8Frame[8UL + u32Args * 4UL], pu8Data, u32Len);
+    sMsg.u32Us = (uint32_t)((65UL * CHAR_NS) / 1000UL) + u32PauseMs * 1000UL + (u32Answer ? ANSWER_MS * 1000UL : 0UL);
+    s_u64BusNs += (uint64_t)sMsg.u32Us * 1000ULL;
+
+    for(i = 0UL; i < NODE_NUM; i++)
+    {
+        sMsg.u32Line = s_au32Line[i];
+        if(s_au32Line[i] == LINE_BAD_BYTE)
+        {
+            sMsg.au8Frame[40] ^= 0x10U;
+        }
+        if(write(s_aiToNode[i], &sMsg, sizeof(sMsg)) < 0)
+        {
+            return -1;
+        }
+        if(s_au32Line[i] == LINE_BAD_BYTE)
+        {
+            sMsg.au8Frame[40] ^= 0x10U;
+        }
+    }
+
+    for(i = 0UL; i < NODE_NUM; i++)
+    {
+        Bus_ReadAll(s_aiFromNode[i], &u32Got, sizeof(u32Got));
+        Bus_ReadAll(s_aiFromNode[i], au8Got, sizeof(au8Got));
+        u32Any += u32Got;
+        if(u32Answer && (i == (uint32_t)(u8Addr - RS485_NODE_ADDR)) && (u32Got == 64UL))
+        {
+            memcpy(au8Rsp, au8Got, 64);
+            for(u16Sum = 0, i32Ret = 0; i32Ret < 64; i32Ret++)
+            {
+                u16Sum += sMsg.au8Frame[i32Ret];
+            }
+            i32Ret = ((au8Rsp[0] == (uint8_t)u16Sum) && (au8Rsp[1] == (uint8_t)(u16Sum >> 8))) ? 0 : -1;
+        }
+    }
+
+    s_u32PackNo += 2UL;
+    if(!u32Answer)
+    {
+        return (int32_t)u32Any;
+    }
+    return (u32Any == 64UL) ? i32Ret : -1;
+}
+
+/* Every part of the pages set in the bitmap, to the group. The first time round one node
+   misses a part of LOST_PAGE and another gets a part of CORRUPT_PAGE with a wrong byte. */
+static void Host_SendPages(const uint8_t *pu8Map, uint32_t bFaults)
+{
+    uint32_t au32Arg[2], u32Page, u32Part, u32Len;
+    uint8_t au8Rsp[64];
+
+    for(u32Page = 0UL; u32Page < IMAGE_PAGES; u32Page++)
+    {
+        if((pu8Map[u32Page / 8UL] & (1U << (u32Page % 8UL))) == 0U)
+        {
+            continue;
+        }
+
+        au32Arg[1] = IspPatch_Crc32(&s_au8Image[u32Page * FMC_FLASH_PAGE_SIZE], FMC_FLASH_PAGE_SIZE);
+        for(u32Part = 0UL; u32Part < MCAST_PARTS; u32Part++)
+        {
+            au32Arg[0] = FMC_APROM_BASE + u32Page * FMC_FLASH_PAGE_SIZE + u32Part;
+            u32Len = FMC_FLASH_PAGE_SIZE - u32Part * MCAST_PART_SIZE;
+            u32Len = (u32Len > MCAST_PART_SIZE) ? MCAST_PART_SIZE : u32Len;
+
+            if(bFaults && (u32Page == LOST_PAGE) && (u32Part == 4UL))
+            {
+                s_au32Line[NODE_LOSES] = LINE_LOST;
+            }
+            if(bFaults && (u32Page == CORRUPT_PAGE) && (u32Part == 2UL))
+            {
+                s_au32Line[NODE_CORRUPT] = LINE_BAD_BYTE;
+            }
+
+            Bus_Request(GROUP_ADDR, CMD_MCAST_PAGE, au32Arg, 2UL,
+                        &s_au8Image[u32Page * FMC_FLASH_PAGE_SIZE + u32Part * MCAST_PART_SIZE], u32Len,
+                        (u32Part == MCAST_PARTS - 1UL) ? MCAST_PAGE_MS : 0UL, au8Rsp);
+            s_u32PageFrames++;
+            memset(s_au32Line, 0, sizeof(s_au32Line));
+        }
+    }
+}
+
+/* Ask every group node for its image CRC32 and missing pages; collects the union in pu8Map */
+static uint32_t Host_Status(uint8_t *pu8Map, uint32_t au32Missing[NODE_NUM], uint32_t au32Crc[NODE_NUM])
+{
+    uint8_t au8Rsp[64];
+    uint32_t i, j, u32Answered = 0UL;
+
+    memset(pu8Map, 0, IMAGE_PAGES / 8UL);
+    for(i = 0UL; i < NODE_NUM; i++)
+    {
+        au32Missing[i] = 0xFFFFFFFFUL;
+        au32Crc[i] = 0UL;
+        if(i == NODE_OUTSIDE)
+        {
+            continue;
+        }
+        if(Bus_Request((uint8_t)(RS485_NODE_ADDR + i), CMD_MCAST_STATUS, NULL, 0UL, NULL, 0UL, 0UL, au8Rsp) != 0)
+        {
+            continue;
+        }
+
+        u32Answered++;
+        memcpy(&au32Crc[i], &au8Rsp[8], 4);
+        memcpy(&au32Missing[i], &au8Rsp[12], 4);
+        for(j = 0UL; j < IMAGE_PAGES / 8UL; j++)
+        {
+            pu8Map[j] |= au8Rsp[16 + j];
+        }
+    }
+
+    return u32Answered;
+}
+
+static uint32_t Map_Count(const uint8_t *pu8Map)
+{
+    uint32_t i, u32Count = 0UL;
+
+    for(i = 0UL; i < IMAGE_PAGES; i++)
+    {
+        u32Count += (pu8Map[i / 8UL] >> (i % 8UL)) & 1U;
+    }
+
+    return u32Count;
+}
+
+int main(void)
+{
+    uint8_t au8Rsp[64], au8Map[IMAGE_PAGES / 8UL];
+    uint32_t au32Arg[2], au32Missing[NODE_NUM], au32Crc[NODE_NUM], au32Erase[NODE_NUM];
+    uint32_t u32ImageCrc, u32Ok, u32Packets, u32Node, i;
+    uint64_t u64OneNs;
+    int aiTo[2], aiFrom[2];
+    pid_t aPid[NODE_NUM];
+    HOSTSIM_FMC_STAT_T sStat;
+    BUS_MSG_T sMsg;
+
+    for(i = 0UL; i < sizeof(s_au8Image); i++)
+    {
+        s_au8Image[i] = (uint8_t)((i * 7UL) ^ (i >> 9));
+        s_au8Old[i] = (uint8_t)(i * 13UL + 5UL);
+    }
+    memset(&s_au8Image[IMAGE_SIZE], 0xFF, sizeof(s_au8Image) - IMAGE_SIZE);
+    u32ImageCrc = IspPatch_Crc32(s_au8Image, sizeof(s_au8Image));
+
+    printf("ISP_RS485 multicast: %lu nodes, %lu byte image, %lu parts of %u bytes a page\n",
+           (unsigned long)NODE_NUM, (unsigned long)IMAGE_SIZE, (unsigned long)MCAST_PARTS, MCAST_PART_SIZE);
+    fflush(stdout);
+
+    for(i = 0UL; i < NODE_NUM; i++)
+    {
+        if((pipe(aiTo) != 0) || (pipe(aiFrom) != 0))
+        {
+            return 1;
+        }
+        aPid[i] = fork();
+        if(aPid[i] < 0)
+        {
+            return 1;
+        }
+        if(aPid[i] == 0)
+        {
+            /* Only the parent may hold the bus ends, or a node never sees the end of it */
+            for(u32Node = 0UL; u32Node < i; u32Node++)
+            {
+                close(s_aiToNode[u32Node]);
+                close(s_aiFromNode[u32Node]);
+            }
+            close(aiTo[1]);
+            close(aiFrom[0]);
+            Node_Main(i, aiTo[0], aiFrom[1]);
+        }
+        close(aiTo[0]);
+        close(aiFrom[1]);
+        s_aiToNode[i] = aiTo[1];
+        s_aiFromNode[i] = aiFrom[0];
+    }
+
+    /* Everyone into ISP mode, then the group */
+    u32Ok = (Bus_Request(RS485_ADDR_ALL, CMD_CONNECT, NULL, 0UL, NULL, 0UL, 0UL, au8Rsp) == 0);
+    for(i = 0UL; i < NODE_NUM; i++)
+    {
+        if(i == NODE_OUTSIDE)
+        {
+            continue;
+        }
+        au32Arg[0] = GROUP_ADDR;
+        u32Ok &= (Bus_Request((uint8_t)(RS485_NODE_ADDR + i), CMD_MCAST_GROUP, au32Arg, 1UL, NULL, 0UL, 0UL, au8Rsp) == 0) &&
+                 (au8Rsp[8] == RS485_NODE_ADDR + i) && (au8Rsp[12] == GROUP_ADDR);
+    }
+    Check("Nodes answer at their own address", u32Ok);
+
+    /* The image, once */
+    au32Arg[0] = FMC_APROM_BASE;
+    au32Arg[1] = IMAGE_SIZE;
+    u32Ok = (Bus_Request(GROUP_ADDR, CMD_MCAST_START, au32Arg, 2UL, NULL, 0UL, 0UL, au8Rsp) == 0);
+    memset(au8Map, 0xFF, sizeof(au8Map));
+    Host_SendPages(au8Map, TRUE);
+    Check("Group requests are not answered", u32Ok);
+
+    Host_Status(au8Map, au32Missing, au32Crc);
+    u32Ok = 1UL;
+    for(i = 0UL; i < NODE_NUM; i++)
+    {
+        if(i == NODE_OUTSIDE)
+        {
+            continue;
+        }
+        u32Ok &= (au32Missing[i] == (((i == NODE_LOSES) || (i == NODE_CORRUPT)) ? 1UL : 0UL));
+        u32Ok &= ((au32Crc[i] == u32ImageCrc) == (au32Missing[i] == 0UL));
+    }
+    u32Ok &= (Map_Count(au8Map) == 2UL) && (au8Map[LOST_PAGE / 8UL] & (1U << (LOST_PAGE % 8UL))) &&
+             (au8Map[CORRUPT_PAGE / 8UL] & (1U << (CORRUPT_PAGE % 8UL)));
+    Check("Lost and bad parts leave their page", u32Ok);
+
+    /* Only the pages someone misses go again */
+    printf("  repair: %lu page(s)\n", (unsigned long)Map_Count(au8Map));
+    Host_SendPages(au8Map, FALSE);
+    u32Ok = (Host_Status(au8Map, au32Missing, au32Crc) == NODE_NUM - 1UL) && (Map_Count(au8Map) == 0UL);
+    for(i = 0UL; i < NODE_NUM; i++)
+    {
+        if(i != NODE_OUTSIDE)
+        {
+            u32Ok &= (au32Missing[i] == 0UL) && (au32Crc[i] == u32ImageCrc);
+        }
+    }
+    Check("Every group node reports the image CRC", u32Ok);
+
+    /* What is in flash */
+    u32Ok = 1UL;
+    memset(&sMsg, 0, sizeof(sMsg));
+    sMsg.u32Addr = BUS_DUMP;
+    for(i = 0UL; i < NODE_NUM; i++)
+    {
+        if(write(s_aiToNode[i], &sMsg, sizeof(sMsg)) < 0)
+        {
+            return 1;
+        }
+        Bus_ReadAll(s_aiFromNode[i], s_au8Flash, sizeof(s_au8Flash));
+        Bus_ReadAll(s_aiFromNode[i], &sStat, sizeof(sStat));
+        au32Erase[i] = sStat.u32PageErase;
+        u32Ok &= (memcmp(s_au8Flash, (i == NODE_OUTSIDE) ? s_au8Old : s_au8Image, sizeof(s_au8Flash)) == 0);
+    }
+    Check("Group programmed, outsider untouched", u32Ok);
+    Check("Pages already in flash are not erased",
+          (au32Erase[NODE_HALF] == IMAGE_PAGES - HALF_PAGES) && (au32Erase[0] == IMAGE_PAGES) &&
+          (au32Erase[NODE_OUTSIDE] == 0UL));
+
+    /* The same with CMD_UPDATE_APROM, node after node: 48 bytes in the first request, 56 in the
+       others, each answered; the erase of the APROM is left out */
+    u32Packets = 1UL + (IMAGE_SIZE - 48UL + 55UL) / 56UL;
+    u64OneNs = (uint64_t)u32Packets * (65UL + 64UL) * CHAR_NS;
+    printf("  bus time: %llu ms multicast, %llu ms one node with CMD_UPDATE_APROM, %llu ms for %lu nodes\n",
+           (unsigned long long)(s_u64BusNs / 1000000ULL), (unsigned long long)(u64OneNs / 1000000ULL),
+           (unsigned long long)(u64OneNs * (NODE_NUM - 1UL) / 1000000ULL), (unsigned long)(NODE_NUM - 1UL));
+    printf("  page frames: %lu, erases: %lu %lu %lu %lu %lu %lu\n", (unsigned long)s_u32PageFrames,
+           (unsigned long)au32Erase[0], (unsigned long)au32Erase[1], (unsigned long)au32Erase[2],
+           (unsigned long)au32Erase[3], (unsigned long)au32Erase[4], (unsigned long)au32Erase[5]);
+    Check("Group costs less than one node alone", s_u64BusNs < u64OneNs);
+
+    for(i = 0UL; i < NODE_NUM; i++)
+    {
+        close(s_aiToNode[i]);
+        close(s_aiFromNode[i]);
+        waitpid(aPid[i], NULL, 0);
+    }
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
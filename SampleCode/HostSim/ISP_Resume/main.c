@@ -0,0 +1,315 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Resume an interrupted CMD_UPDATE_APROM through the shared ISP
+ *           engine on the host simulator.
+ * @note     The engine is built with ISP_RESUME_RECORD and Data Flash is
+ *           enabled, so that it keeps its progress record in the last Data
+ *           Flash page. The host asks for
+ *           CMD_RESUME_APROM before every upload. The link is dropped part
+ *           way, with a damaged packet as the last one sent. On reconnect the
+ *           upload goes on from the offset the loader reports, not from
+ *           zero. The run also covers record compaction, another image, a
+ *           plain CMD_UPDATE_APROM, application data in Data Flash, a
+ *           remainder that is no longer blank and the security lock, under
+ *           which the loader never resumes. Request frames go over an
+ *           in-memory transport.
+ *           Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "hostsim.h"
+#include "isp_user.h"
+#include "isp_patch.h"
+
+#define TEST_HCLK           48000000UL
+#define IMAGE_SIZE          (100UL * 1024UL + 200UL)    /* More pages than one record page holds */
+#define DATA_FLASH_ADDR     0x3E000UL
+#define DROP_AT             1500UL      /* Packets sent before the link goes */
+
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint32_t s_au32Frame[ISP_FRAME_SIZE / 4];
+static uint32_t s_bFrame = FALSE;
+static uint8_t s_au8Rsp[ISP_FRAME_SIZE];
+static uint32_t s_u32PackNo;
+static uint32_t s_u32Packets;
+static uint8_t s_au8Image[IMAGE_SIZE];
+static uint8_t s_au8Other[IMAGE_SIZE];
+static uint8_t s_au8Flash[IMAGE_SIZE];
+static uint8_t s_au8Data[2][FMC_FLASH_PAGE_SIZE];
+static uint32_t s_u32Error = 0;
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+    CLK->PWRCTL |= CLK_PWRCTL_HIRCEN_Msk;
+
+    while (!(CLK->STATUS & CLK_STATUS_HIRCSTB_Msk));
+
+    CLK->CLKSEL0 = (CLK->CLKSEL0 & (~CLK_CLKSEL0_HCLKSEL_Msk)) | CLK_CLKSEL0_HCLKSEL_HIRC;
+    CLK->CLKDIV0 = (CLK->CLKDIV0 & (~CLK_CLKDIV0_HCLKDIV_Msk)) | CLK_CLKDIV0_HCLK(1);
+
+    SystemCoreClockUpdate();
+}
+
+static void Check(const char *pcName, uint32_t u32Pass)
+{
+    printf("%-40s %s\n", pcName, u32Pass ? "PASS" : "FAIL");
+    if(!u32Pass)
+    {
+        s_u32Error++;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* In-memory transport, one frame deep                                                                     */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint8_t *MEM_RecvFrame(void)
+{
+    if(!s_bFrame)
+    {
+        return NULL;
+    }
+
+    s_bFrame = FALSE;
+    return (uint8_t *)s_au32Frame;
+}
+
+static void MEM_SendFrame(uint8_t *buf, uint32_t len)
+{
+    memcpy(s_au8Rsp, buf, len);
+}
+
+static const ISP_TRANSPORT_T s_sMemTransport = { MEM_RecvFrame, MEM_SendFrame, NULL };
+
+/* Hand a 64-byte packet to the engine. The response must carry the packet number and
+   the byte sum. u32Damage flips a data byte after the sum is taken, as a bad link would. */
+static int32_t Host_Packet(uint32_t u32Cmd, const uint32_t au32Arg[2], const uint8_t *pu8Data, uint32_t u32Len,
+                           uint32_t u32Damage, uint8_t au8Rsp[64])
+{
+    uint8_t au8Pkt[64];
+    uint32_t u32Off = 8UL, i;
+    uint16_t u16Sum;
+
+    memset(au8Pkt, 0, sizeof(au8Pkt));
+    *(uint32_t *)&au8Pkt[0] = u32Cmd;
+    *(uint32_t *)&au8Pkt[4] = s_u32PackNo;
+    if(au32Arg != NULL)
+    {
+        memcpy(&au8Pkt[8], au32Arg, 8);
+        u32Off = 16UL;
+    }
+    memcpy(&au8Pkt[u32Off], pu8Data, u32Len);
+
+    for(u16Sum = 0, i = 0UL; i < 64UL; i++)
+    {
+        u16Sum += au8Pkt[i];
+    }
+    if(u32Damage)
+    {
+        au8Pkt[u32Off] ^= 0x5AU;
+    }
+
+    memcpy(s_au32Frame, au8Pkt, sizeof(au8Pkt));
+    s_bFrame = TRUE;
+    s_u32Packets++;
+    if(!ISP_Poll(&s_sMemTransport))
+    {
+        return -1;
+    }
+    memcpy(au8Rsp, s_au8Rsp, 64);
+
+    if(*(uint32_t *)&au8Rsp[4] != s_u32PackNo + 1UL)
+    {
+        return -1;
+    }
+    s_u32PackNo += 2UL;
+
+    return ((au8Rsp[0] == (uint8_t)u16Sum) && (au8Rsp[1] == (uint8_t)(u16Sum >> 8))) ? 0 : -1;
+}
+
+static int32_t Host_Connect(void)
+{
+    uint8_t au8Rsp[64];
+
+    s_u32PackNo = 1UL;
+    return Host_Packet(CMD_CONNECT, NULL, NULL, 0, FALSE, au8Rsp);
+}
+
+/* Bytes of the image already in flash by the loader's record, or -1 */
+static int32_t Host_Resume(const uint8_t *pu8Img, uint32_t u32Size)
+{
+    uint32_t au32Arg[2] = {u32Size, IspPatch_Crc32(pu8Img, u32Size)};
+    uint8_t au8Rsp[64];
+
+    if(Host_Packet(CMD_RESUME_APROM, au32Arg, NULL, 0, FALSE, au8Rsp) != 0)
+        return -1;
+
+    return (int32_t)*(uint32_t *)&au8Rsp[8];
+}
+
+/* Upload from u32From, by CMD_UPDATE_APROM if 0 and by command 0 packets otherwise.
+   With u32Drop the link goes after that many packets, the last of them damaged. */
+static int32_t Host_Upload(const uint8_t *pu8Img, uint32_t u32Size, uint32_t u32From, uint32_t u32Drop)
+{
+    uint32_t au32Arg[2] = {0UL, u32Size};
+    uint8_t au8Rsp[64];
+    uint32_t u32Pos = u32From, u32Len, u32Sent = 0UL;
+
+    if(u32From == 0UL)
+    {
+        if(Host_Packet(CMD_UPDATE_APROM, au32Arg, pu8Img, 48UL, FALSE, au8Rsp) != 0)
+            return -1;
+        u32Pos = 48UL;
+        u32Sent++;
+    }
+
+    for(; u32Pos < u32Size; u32Pos += u32Len)
+    {
+        u32Len = ((u32Size - u32Pos) > 56UL) ? 56UL : (u32Size - u32Pos);
+        if(++u32Sent == u32Drop)
+        {
+            Host_Packet(0UL, NULL, &pu8Img[u32Pos], u32Len, TRUE, au8Rsp);
+            return 1;
+        }
+        if(Host_Packet(0UL, NULL, &pu8Img[u32Pos], u32Len, FALSE, au8Rsp) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+/* Leave the session as a dropped link would: the loader restarts and the host reconnects */
+static int32_t Host_Reconnect(void)
+{
+    bUpdateApromCmd = FALSE;
+    return Host_Connect();
+}
+
+int main(void)
+{
+    uint32_t au32Cfg[4], au32Rec[4], u32Sent, u32Full, u32RecPage, i;
+    uint8_t au8Rsp[64];
+    int32_t i32Ret, i32From;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        printf("HostSim_Init failed\n");
+        return 1;
+    }
+
+    SYS_Init();
+    FMC->ISPCTL |= (FMC_ISPCTL_ISPEN_Msk | FMC_ISPCTL_APUEN_Msk);
+
+    /* Data Flash at the top 8 KB */
+    HostSim_FmcDump(FMC_CONFIG_BASE, au32Cfg, sizeof(au32Cfg));
+    au32Cfg[0] &= ~0x1UL;
+    au32Cfg[1] = DATA_FLASH_ADDR;
+    HostSim_FmcLoad(FMC_CONFIG_BASE, au32Cfg, sizeof(au32Cfg));
+    g_apromSize = GetApromSize();
+    GetDataFlashInfo(&g_dataFlashAddr, &g_dataFlashSize);
+
+    for(i = 0UL; i < IMAGE_SIZE; i++)
+    {
+        s_au8Image[i] = (uint8_t)((i * 7UL) ^ (i >> 8) ^ 0x5AUL);
+        s_au8Other[i] = (uint8_t)((i * 13UL) ^ (i >> 9) ^ 0xC3UL);
+    }
+
+    printf("\nResumable CMD_UPDATE_APROM, %u KB image, Data Flash at 0x%05X\n", (unsigned)(IMAGE_SIZE / 1024UL),
+           (unsigned)g_dataFlashAddr);
+
+    /* Nothing recorded yet: a full upload, dropped part way */
+    Check("CMD_CONNECT", Host_Connect() == 0);
+    Check("CMD_RESUME_APROM, no record", Host_Resume(s_au8Image, IMAGE_SIZE) == 0);
+    s_u32Packets = 0UL;
+    i32Ret = Host_Upload(s_au8Image, IMAGE_SIZE, 0UL, DROP_AT);
+    u32Sent = s_u32Packets;
+    Check("Link dropped part way", i32Ret == 1);
+
+    /* The record never covers the damaged packet, and at most a page is sent again */
+    Check("Reconnect", Host_Reconnect() == 0);
+    i32From = Host_Resume(s_au8Image, IMAGE_SIZE);
+    printf("Dropped after %u bytes, resume from %u\n", (unsigned)(48UL + (DROP_AT - 1UL) * 56UL), (unsigned)i32From);
+    Check("CMD_RESUME_APROM reports progress", (i32From > 0) && ((i32From % FMC_FLASH_PAGE_SIZE) == 0) &&
+          ((uint32_t)i32From <= 48UL + (DROP_AT - 2UL) * 56UL) &&
+          ((uint32_t)i32From + FMC_FLASH_PAGE_SIZE + 56UL > 48UL + (DROP_AT - 2UL) * 56UL));
+    i32Ret = Host_Upload(s_au8Image, IMAGE_SIZE, (uint32_t)i32From, 0UL);
+    u32Sent = s_u32Packets - u32Sent;
+    HostSim_FmcDump(FMC_APROM_BASE, s_au8Flash, IMAGE_SIZE);
+    Check("Resumed image complete", (i32Ret == 0) && (memcmp(s_au8Flash, s_au8Image, IMAGE_SIZE) == 0));
+    u32Full = 1UL + (IMAGE_SIZE - 48UL + 55UL) / 56UL;
+    printf("Packets after the drop: %u resumed, %u for a full redo\n", (unsigned)u32Sent, (unsigned)u32Full);
+
+    /* Once the host has moved on the record is gone */
+    Check("CMD_GET_FWVER", Host_Packet(CMD_GET_FWVER, NULL, NULL, 0, FALSE, au8Rsp) == 0);
+    HostSim_FmcDump(g_dataFlashAddr + g_dataFlashSize - FMC_FLASH_PAGE_SIZE, au32Rec, sizeof(au32Rec));
+    Check("Record dropped when complete", au32Rec[0] == 0xFFFFFFFFUL);
+    Check("Nothing to resume", Host_Resume(s_au8Image, IMAGE_SIZE) == 0);
+
+    /* A record only answers for its own image */
+    Check("Upload dropped again", Host_Upload(s_au8Image, IMAGE_SIZE, 0UL, DROP_AT) == 1);
+    Check("Reconnect", Host_Reconnect() == 0);
+    Check("Other image: start over", Host_Resume(s_au8Other, IMAGE_SIZE) == 0);
+    Check("Same image still resumes", Host_Resume(s_au8Image, IMAGE_SIZE) > 0);
+
+    /* A plain CMD_UPDATE_APROM drops the record */
+    Check("Reconnect", Host_Reconnect() == 0);
+    Check("Plain upload", Host_Upload(s_au8Other, IMAGE_SIZE / 2UL, 0UL, 0UL) == 0);
+    Check("No resume after a plain upload", Host_Resume(s_au8Image, IMAGE_SIZE) == 0);
+
+    /* Application data in Data Flash, the record page included, survive a plain upload */
+    u32RecPage = g_dataFlashAddr + g_dataFlashSize - FMC_FLASH_PAGE_SIZE;
+    for(i = 0UL; i < FMC_FLASH_PAGE_SIZE; i++)
+    {
+        s_au8Data[0][i] = (uint8_t)(i ^ 0xA5UL);
+    }
+    HostSim_FmcLoad(g_dataFlashAddr, s_au8Data[0], FMC_FLASH_PAGE_SIZE);
+    HostSim_FmcLoad(u32RecPage, s_au8Data[0], FMC_FLASH_PAGE_SIZE);
+    Check("Reconnect", Host_Reconnect() == 0);
+    Check("Plain upload", Host_Upload(s_au8Other, IMAGE_SIZE / 2UL, 0UL, 0UL) == 0);
+    HostSim_FmcDump(g_dataFlashAddr, s_au8Data[1], FMC_FLASH_PAGE_SIZE);
+    u32Sent = (memcmp(s_au8Data[0], s_au8Data[1], FMC_FLASH_PAGE_SIZE) == 0);
+    HostSim_FmcDump(u32RecPage, s_au8Data[1], FMC_FLASH_PAGE_SIZE);
+    Check("Data Flash kept by a plain upload", u32Sent && (memcmp(s_au8Data[0], s_au8Data[1], FMC_FLASH_PAGE_SIZE) == 0));
+
+    /* Nor does an armed resume take a page that is not blank: no record is kept */
+    Check("CMD_RESUME_APROM, no record", Host_Resume(s_au8Image, IMAGE_SIZE) == 0);
+    Check("Upload dropped again", Host_Upload(s_au8Image, IMAGE_SIZE, 0UL, DROP_AT) == 1);
+    Check("Reconnect", Host_Reconnect() == 0);
+    Check("Page in use: start over", Host_Resume(s_au8Image, IMAGE_SIZE) == 0);
+    HostSim_FmcDump(u32RecPage, s_au8Data[1], FMC_FLASH_PAGE_SIZE);
+    Check("Page in use kept", memcmp(s_au8Data[0], s_au8Data[1], FMC_FLASH_PAGE_SIZE) == 0);
+    memset(s_au8Data[1], 0xFF, FMC_FLASH_PAGE_SIZE);
+    HostSim_FmcLoad(u32RecPage, s_au8Data[1], FMC_FLASH_PAGE_SIZE);
+
+    /* Flash past the record written since: refused, nothing programmed twice */
+    Check("Upload dropped again", Host_Upload(s_au8Image, IMAGE_SIZE, 0UL, DROP_AT) == 1);
+    Check("Reconnect", Host_Reconnect() == 0);
+    HostSim_FmcLoad(FMC_APROM_BASE + IMAGE_SIZE - 100UL, s_au8Other, 4UL);
+    Check("Remainder not blank: start over", Host_Resume(s_au8Image, IMAGE_SIZE) == 0);
+
+    /* Security lock set: no resume, the host falls back to CMD_UPDATE_APROM and its full erase */
+    Check("Upload dropped again", Host_Upload(s_au8Image, IMAGE_SIZE, 0UL, DROP_AT) == 1);
+    HostSim_FmcLoad(FMC_APROM_BASE + IMAGE_SIZE + 4UL * FMC_FLASH_PAGE_SIZE, s_au8Other, 4UL);
+    HostSim_FmcDump(FMC_CONFIG_BASE, au32Cfg, sizeof(au32Cfg));
+    au32Cfg[0] &= ~0x2UL;
+    HostSim_FmcLoad(FMC_CONFIG_BASE, au32Cfg, sizeof(au32Cfg));
+    Check("Locked: reconnect", Host_Reconnect() == 0);
+    Check("Locked: no resume", Host_Resume(s_au8Image, IMAGE_SIZE) == 0);
+    i32Ret = Host_Upload(s_au8Image, IMAGE_SIZE, 0UL, 0UL);
+    HostSim_FmcDump(FMC_APROM_BASE, s_au8Flash, IMAGE_SIZE);
+    HostSim_FmcDump(FMC_APROM_BASE + IMAGE_SIZE + 4UL * FMC_FLASH_PAGE_SIZE, au32Rec, 4UL);
+    Check("Locked: image complete", (i32Ret == 0) && (memcmp(s_au8Flash, s_au8Image, IMAGE_SIZE) == 0));
+    Check("Locked: APROM erased first", au32Rec[0] == 0xFFFFFFFFUL);
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
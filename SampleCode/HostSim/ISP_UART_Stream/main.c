@@ -0,0 +1,516 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Compare the ISP_UART packet protocol with its streaming mode on the
+ *           host simulator.
+ * @note     The ISP_UART sources are built unchanged; only the loader main loop
+ *           is repeated here so that the host side can run in between. The same
+ *           image is programmed once with 64-byte stop-and-wait packets and once
+ *           with windowed stream frames, one of which is corrupted on the line
+ *           to force a go-back-N resend. A frame size that does not divide a page
+ *           is rounded down and a frame across a page boundary is refused
+ *           without touching flash. Then the baud rate is negotiated: a
+ *           rate out of tolerance is refused, a trial rate that is never
+ *           confirmed or that only carries noise falls back, and a confirmed
+ *           one streams a full 128 KB APROM. Last, CRC32 frame mode: two bytes
+ *           swapped on the line keep the byte sum but not the CRC32, in packets
+ *           and in stream frames, and CMD_GET_IMAGE_CRC checks the whole image.
+ *           Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "hostsim.h"
+#include "targetdev.h"
+#include "uart_transfer.h"
+#include "isp_stream.h"
+#include "isp_patch.h"
+
+#define TEST_HCLK           48000000UL
+#define TEST_BAUD           115200UL
+#define FAST_BAUD           3000000UL
+#define BAD_BAUD            4500000UL   /* 48 MHz / 11 is 3% off */
+#define SLOW_SIZE           (32UL * 1024UL)
+#define IMAGE_SIZE          (128UL * 1024UL)
+#define LOOP_CYCLES         4800UL      /* Loader main loop period, 100 us */
+#define PKT_TIMEOUT_MS      5000UL      /* CMD_UPDATE_APROM erases the whole APROM first */
+#define ACK_TIMEOUT_MS      300UL
+#define CORRUPT_FRAME       5UL
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint8_t s_au8Image[IMAGE_SIZE];
+static uint8_t s_au8Flash[IMAGE_SIZE];
+static uint32_t s_u32PackNo;
+static uint32_t s_bStreaming;
+static uint32_t s_bCrc32;
+static uint32_t s_bSwapOnLine;
+static uint32_t s_u32Error = 0;
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+    CLK->PWRCTL |= CLK_PWRCTL_HIRCEN_Msk;
+
+    while (!(CLK->STATUS & CLK_STATUS_HIRCSTB_Msk));
+
+    CLK->CLKSEL0 = (CLK->CLKSEL0 & (~CLK_CLKSEL0_HCLKSEL_Msk)) | CLK_CLKSEL0_HCLKSEL_HIRC;
+    CLK->CLKDIV0 = (CLK->CLKDIV0 & (~CLK_CLKDIV0_HCLKDIV_Msk)) | CLK_CLKDIV0_HCLK(1);
+    CLK->APBCLK0 |= CLK_APBCLK0_UART0CKEN_Msk;
+    CLK->CLKSEL1 = (CLK->CLKSEL1 & (~CLK_CLKSEL1_UART0SEL_Msk)) | CLK_CLKSEL1_UART0SEL_HIRC;
+    CLK->CLKDIV0 = (CLK->CLKDIV0 & (~CLK_CLKDIV0_UART0DIV_Msk)) | CLK_CLKDIV0_UART0(1);
+
+    SystemCoreClockUpdate();
+}
+
+static void Check(const char *pcName, uint32_t u32Pass)
+{
+    printf("%-40s %s\n", pcName, u32Pass ? "PASS" : "FAIL");
+    if(!u32Pass)
+    {
+        s_u32Error++;
+    }
+}
+
+/* One pass of the ISP_UART main loop after CMD_CONNECT */
+static void Loader_Step(void)
+{
+    if(s_bStreaming)
+    {
+        if(StreamPoll() != STREAM_BUSY)
+        {
+            StreamClose();
+            s_bStreaming = FALSE;
+        }
+    }
+    else if(ISP_Poll(&g_sUartTransport))
+    {
+        if(g_u32NewBaud)
+        {
+            UART_BaudTrial(g_u32NewBaud);
+            g_u32NewBaud = 0;
+        }
+
+        if(bStreamModeCmd == TRUE)
+        {
+            bStreamModeCmd = FALSE;
+            StreamOpen();
+            s_bStreaming = TRUE;
+        }
+    }
+
+    UART_BaudPoll();
+    HostSim_Delay(LOOP_CYCLES);
+}
+
+static uint32_t Host_Ms(uint64_t u64Start)
+{
+    return (uint32_t)((HostSim_GetCycle() - u64Start) / (TEST_HCLK / 1000UL));
+}
+
+/* Send a 64-byte packet and run the loader until its checked response is back */
+static int32_t Host_Packet(uint32_t u32Cmd, const uint32_t au32Arg[2], const uint8_t *pu8Data, uint32_t u32Len,
+                           uint8_t au8Rsp[64])
+{
+    uint8_t au8Pkt[64];
+    uint32_t u32Got = 0, u32Off, i;
+    uint16_t u16Sum;
+    uint64_t u64Start;
+
+    memset(au8Pkt, 0, sizeof(au8Pkt));
+    memcpy(&au8Pkt[0], &u32Cmd, 4);
+    memcpy(&au8Pkt[4], &s_u32PackNo, 4);
+    u32Off = 8UL;
+    if(au32Arg != NULL)
+    {
+        memcpy(&au8Pkt[8], au32Arg, 8);
+        u32Off = 16UL;
+    }
+    memcpy(&au8Pkt[u32Off], pu8Data, u32Len);
+
+    if(s_bSwapOnLine)
+    {
+        /* Corrupted on the line in a way the byte sum cannot see */
+        s_bSwapOnLine = FALSE;
+        i = au8Pkt[8];
+        au8Pkt[8] = au8Pkt[9];
+        au8Pkt[9] = (uint8_t)i;
+        HostSim_UartInject(0, au8Pkt, sizeof(au8Pkt));
+        au8Pkt[9] = au8Pkt[8];
+        au8Pkt[8] = (uint8_t)i;
+    }
+    else
+    {
+        HostSim_UartInject(0, au8Pkt, sizeof(au8Pkt));
+    }
+    u64Start = HostSim_GetCycle();
+    while((u32Got < 64UL) && (Host_Ms(u64Start) < PKT_TIMEOUT_MS))
+    {
+        Loader_Step();
+        u32Got += HostSim_UartTake(0, &au8Rsp[u32Got], 64UL - u32Got);
+    }
+
+    for(u16Sum = 0, i = 0UL; i < 64UL; i++)
+    {
+        u16Sum += au8Pkt[i];
+    }
+    if((u32Got != 64UL) || (*(uint32_t *)&au8Rsp[4] != s_u32PackNo + 1UL))
+    {
+        return -1;
+    }
+    if(s_bCrc32 ? (*(uint32_t *)&au8Rsp[0] != IspPatch_Crc32(au8Pkt, 64UL)) :
+            ((au8Rsp[0] != (uint8_t)u16Sum) || (au8Rsp[1] != (uint8_t)(u16Sum >> 8))))
+    {
+        return -1;
+    }
+
+    s_u32PackNo += 2UL;
+    return 0;
+}
+
+static int32_t Host_Connect(void)
+{
+    uint8_t au8Rsp[64];
+
+    s_u32PackNo = 1UL;
+    s_bCrc32 = FALSE;
+    return Host_Packet(CMD_CONNECT, NULL, NULL, 0, au8Rsp);
+}
+
+/* The stock protocol: 48 bytes in the first packet, 56 in each one after */
+static int32_t Host_PacketUpload(uint32_t u32Size, uint32_t *pu32EraseMs)
+{
+    uint32_t au32Arg[2] = {0UL, u32Size};
+    uint8_t au8Rsp[64];
+    uint32_t u32Pos, u32Len;
+    uint64_t u64Start = HostSim_GetCycle();
+
+    if(Host_Packet(CMD_UPDATE_APROM, au32Arg, s_au8Image, 48UL, au8Rsp) != 0)
+        return -1;
+    *pu32EraseMs = Host_Ms(u64Start);
+
+    for(u32Pos = 48UL; u32Pos < u32Size; u32Pos += u32Len)
+    {
+        u32Len = ((u32Size - u32Pos) > 56UL) ? 56UL : (u32Size - u32Pos);
+        if(Host_Packet(0UL, NULL, &s_au8Image[u32Pos], u32Len, au8Rsp) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+static void Host_SendFrame(uint32_t u32Seq, uint32_t u32Addr, uint32_t u32Len, uint32_t u32Corrupt)
+{
+    uint8_t au8Frame[STREAM_HDR_SIZE + STREAM_MAX_FRAME + STREAM_TRL_SIZE];
+    uint32_t i, u32Crc;
+    uint16_t u16Sum;
+
+    au8Frame[0] = STREAM_SYNC;
+    au8Frame[1] = (uint8_t)u32Seq;
+    au8Frame[2] = (uint8_t)u32Len;
+    au8Frame[3] = (uint8_t)(u32Len >> 8);
+    memcpy(&au8Frame[4], &u32Addr, 4);
+    memcpy(&au8Frame[STREAM_HDR_SIZE], &s_au8Image[u32Addr], u32Len);
+
+    for(u16Sum = 0, i = 0UL; i < STREAM_HDR_SIZE + u32Len; i++)
+    {
+        u16Sum += au8Frame[i];
+    }
+    u32Crc = s_bCrc32 ? IspPatch_Crc32(au8Frame, i) : u16Sum;
+    memcpy(&au8Frame[i], &u32Crc, 4);
+
+    if(u32Corrupt && s_bCrc32)
+    {
+        au8Frame[STREAM_HDR_SIZE + 7UL] = au8Frame[STREAM_HDR_SIZE + 8UL];
+        au8Frame[STREAM_HDR_SIZE + 8UL] = s_au8Image[u32Addr + 7UL];
+    }
+    else if(u32Corrupt)
+    {
+        au8Frame[STREAM_HDR_SIZE + 7UL] ^= 0x10U;
+    }
+
+    HostSim_UartInject(0, au8Frame, STREAM_HDR_SIZE + u32Len + STREAM_TRL_SIZE);
+}
+
+/* Go-back-N sender; frame u32Frames is the empty end frame */
+static int32_t Host_StreamUpload(uint32_t u32Size, uint32_t u32Frame, uint32_t u32Window, uint32_t u32CorruptOne,
+                                 uint32_t *pu32Resend)
+{
+    uint32_t u32Frames = u32Size / u32Frame;
+    uint32_t u32Base = 0UL, u32Next = 0UL, u32Acked, u32Len, u32Corrupt = u32CorruptOne;
+    uint8_t au8Ack[STREAM_ACK_SIZE];
+    uint32_t u32AckLen = 0UL;
+    uint64_t u64Progress = HostSim_GetCycle();
+
+    *pu32Resend = 0UL;
+    while(u32Base <= u32Frames)
+    {
+        while((u32Next <= u32Frames) && (u32Next < u32Base + u32Window))
+        {
+            u32Len = (u32Next < u32Frames) ? u32Frame : 0UL;
+            Host_SendFrame(u32Next, u32Next * u32Frame, u32Len, (u32Next == CORRUPT_FRAME) && u32Corrupt);
+            if(u32Next == CORRUPT_FRAME)
+                u32Corrupt = FALSE;
+            u32Next++;
+        }
+
+        Loader_Step();
+
+        u32AckLen += HostSim_UartTake(0, &au8Ack[u32AckLen], STREAM_ACK_SIZE - u32AckLen);
+        if(u32AckLen == STREAM_ACK_SIZE)
+        {
+            u32AckLen = 0UL;
+            if((au8Ack[0] != STREAM_ACK) || (au8Ack[3] != (uint8_t)(au8Ack[0] + au8Ack[1] + au8Ack[2])))
+                return -1;
+            if((au8Ack[2] != STREAM_ST_OK) && (au8Ack[2] != STREAM_ST_RESEND))
+                return -(int32_t)au8Ack[2];
+
+            u32Acked = (au8Ack[1] - u32Base) & 0xFFUL;
+            if(u32Acked <= u32Next - u32Base)
+            {
+                u32Base += u32Acked;
+                u64Progress = HostSim_GetCycle();
+            }
+            if(au8Ack[2] == STREAM_ST_RESEND)
+            {
+                u32Next = u32Base;
+                (*pu32Resend)++;
+            }
+        }
+        else if(Host_Ms(u64Progress) > ACK_TIMEOUT_MS)
+        {
+            u32Next = u32Base;
+            u64Progress = HostSim_GetCycle();
+            (*pu32Resend)++;
+        }
+    }
+
+    return 0;
+}
+
+/* Negotiate the link rate; returns the confirmed rate, 0 when the loader stays */
+static uint32_t Host_SetBaud(uint32_t u32Baud)
+{
+    uint32_t au32Arg[2] = {u32Baud, 0UL}, u32Real;
+    uint8_t au8Rsp[64];
+
+    if(Host_Packet(CMD_SET_BAUDRATE, au32Arg, NULL, 0, au8Rsp) != 0)
+        return 0UL;
+    memcpy(&u32Real, &au8Rsp[8], 4);
+    if(u32Real == 0UL)
+        return 0UL;
+
+    /* The host switches too and confirms at the new rate */
+    if(Host_Packet(CMD_SET_BAUDRATE, au32Arg, NULL, 0, au8Rsp) != 0)
+        return 0UL;
+    return u32Real;
+}
+
+static uint32_t Loader_Baud(void)
+{
+    uint32_t u32Brd = (UART0->BAUD & UART_BAUD_BRD_Msk) >> UART_BAUD_BRD_Pos;
+
+    return __HIRC / (u32Brd + 2UL);
+}
+
+/* Whole-image CRC32 from the loader; returns the bytes it covered */
+static uint32_t Host_ImageCrc(uint32_t u32Addr, uint32_t u32Len, uint32_t *pu32Crc)
+{
+    uint32_t au32Arg[2] = {u32Addr, u32Len}, u32Covered = 0UL;
+    uint8_t au8Rsp[64];
+
+    if(Host_Packet(CMD_GET_IMAGE_CRC, au32Arg, NULL, 0, au8Rsp) != 0)
+        return 0UL;
+    memcpy(pu32Crc, &au8Rsp[8], 4);
+    memcpy(&u32Covered, &au8Rsp[12], 4);
+    return u32Covered;
+}
+
+static void Stream_Image(const char *pcName, uint32_t u32Size, uint32_t u32CorruptOne, uint32_t *pu32Ms)
+{
+    uint32_t au32Arg[2] = {STREAM_MAX_FRAME, 0UL}, u32Frame = 0UL, u32Window = 0UL, u32Resend = 0UL;
+    uint8_t au8Rsp[64];
+    uint64_t u64Start;
+    int32_t i32Ret;
+
+    /* Over a stale image, so every page needs its erase */
+    memset(s_au8Flash, 0x3C, u32Size);
+    HostSim_FmcLoad(FMC_APROM_BASE, s_au8Flash, u32Size);
+
+    u64Start = HostSim_GetCycle();
+    i32Ret = Host_Packet(CMD_STREAM_MODE, au32Arg, NULL, 0, au8Rsp);
+    memcpy(&u32Frame, &au8Rsp[8], 4);
+    memcpy(&u32Window, &au8Rsp[12], 4);
+    if((i32Ret != 0) || (u32Frame != STREAM_MAX_FRAME) || (u32Window < 2UL) ||
+            (u32Window * (u32Frame + STREAM_HDR_SIZE + STREAM_TRL_SIZE) > STREAM_RING_SIZE / 2UL))
+    {
+        Check("CMD_STREAM_MODE negotiation", FALSE);
+        return;
+    }
+
+    i32Ret = Host_StreamUpload(u32Size, u32Frame, u32Window, u32CorruptOne, &u32Resend);
+    *pu32Ms = Host_Ms(u64Start);
+    HostSim_FmcDump(FMC_APROM_BASE, s_au8Flash, u32Size);
+    printf("Stream %7u bps: %u KB in %u ms, %.1f KB/s, frame %u window %u, %u resend\n", (unsigned)Loader_Baud(),
+           (unsigned)(u32Size / 1024UL), (unsigned)*pu32Ms, (double)u32Size / *pu32Ms * 1000.0 / 1024.0,
+           (unsigned)u32Frame, (unsigned)u32Window, (unsigned)u32Resend);
+    Check(pcName, (i32Ret == 0) && (u32Resend >= u32CorruptOne) && (memcmp(s_au8Image, s_au8Flash, u32Size) == 0));
+}
+
+int main(void)
+{
+    uint32_t au32Arg[2], u32EraseMs = 0UL, u32PacketMs, u32StreamMs = 0UL, u32FastMs = 0UL, i;
+    uint8_t au8Rsp[64], au8Noise[64];
+    uint64_t u64Start, u64Tx;
+    int32_t i32Ret;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        printf("HostSim_Init failed\n");
+        return 1;
+    }
+
+    SYS_Init();
+    UART_Init();
+    FMC->ISPCTL |= (FMC_ISPCTL_ISPEN_Msk | FMC_ISPCTL_APUEN_Msk);
+    g_apromSize = GetApromSize();
+    GetDataFlashInfo(&g_dataFlashAddr, &g_dataFlashSize);
+    SysTick->LOAD = 300000 * CyclesPerUs;
+    SysTick->VAL = 0;
+    SysTick->CTRL = SysTick->CTRL | SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+
+    for(i = 0UL; i < IMAGE_SIZE; i++)
+    {
+        s_au8Image[i] = (uint8_t)((i * 7UL) ^ (i >> 8) ^ 0x5AUL);
+    }
+
+    printf("\nISP_UART on HostSim, APROM %u KB\n", (unsigned)(g_apromSize / 1024UL));
+
+    /* Stop-and-wait packets */
+    Check("CMD_CONNECT", Host_Connect() == 0);
+    u64Start = HostSim_GetCycle();
+    i32Ret = Host_PacketUpload(SLOW_SIZE, &u32EraseMs);
+    u32PacketMs = Host_Ms(u64Start);
+    HostSim_FmcDump(FMC_APROM_BASE, s_au8Flash, SLOW_SIZE);
+    printf("Packet %7u bps: %u KB in %u ms, %.1f KB/s after %u ms APROM erase\n", (unsigned)Loader_Baud(),
+           (unsigned)(SLOW_SIZE / 1024UL), (unsigned)u32PacketMs,
+           (double)SLOW_SIZE / (u32PacketMs - u32EraseMs) * 1000.0 / 1024.0, (unsigned)u32EraseMs);
+    Check("Packet upload", (i32Ret == 0) && (memcmp(s_au8Image, s_au8Flash, SLOW_SIZE) == 0));
+
+    /* Stream frames, one corrupted on the line */
+    Check("CMD_CONNECT", Host_Connect() == 0);
+    Stream_Image("Stream upload with one corrupted frame", SLOW_SIZE, TRUE, &u32StreamMs);
+    Check("Stream at least twice as fast", u32StreamMs * 2UL < u32PacketMs);
+
+    /* Packet mode is back after the end frame */
+    Check("Packet mode after end frame", Host_Packet(CMD_GET_FWVER, NULL, NULL, 0, au8Rsp) == 0 && au8Rsp[8] == FW_VERSION);
+
+    /* A host that goes away must not leave the loader deaf */
+    au32Arg[0] = 64UL;
+    au32Arg[1] = 0UL;
+    Check("CMD_STREAM_MODE, then idle", Host_Packet(CMD_STREAM_MODE, au32Arg, NULL, 0, au8Rsp) == 0);
+    u64Start = HostSim_GetCycle();
+    while(s_bStreaming && (Host_Ms(u64Start) < 3000UL))
+    {
+        Loader_Step();
+    }
+    Check("Idle line ends streaming", !s_bStreaming && (Host_Packet(CMD_GET_FWVER, NULL, NULL, 0, au8Rsp) == 0));
+
+    /* A frame size that does not divide a page, then a frame across a page boundary */
+    au32Arg[0] = 200UL;
+    au32Arg[1] = 0UL;
+    i32Ret = Host_Packet(CMD_STREAM_MODE, au32Arg, NULL, 0, au8Rsp);
+    memcpy(&i, &au8Rsp[8], 4);
+    Check("Frame size down to a power of two", (i32Ret == 0) && (i == 128UL));
+    memset(s_au8Flash, 0x3C, 2UL * FMC_FLASH_PAGE_SIZE);
+    HostSim_FmcLoad(FMC_APROM_BASE, s_au8Flash, 2UL * FMC_FLASH_PAGE_SIZE);
+    Host_SendFrame(0UL, FMC_FLASH_PAGE_SIZE - 64UL, 128UL, FALSE);
+    i32Ret = 0;
+    u64Start = HostSim_GetCycle();
+    while((i32Ret < STREAM_ACK_SIZE) && (Host_Ms(u64Start) < 3000UL))
+    {
+        Loader_Step();
+        i32Ret += (int32_t)HostSim_UartTake(0, &au8Rsp[i32Ret], STREAM_ACK_SIZE - i32Ret);
+    }
+    HostSim_FmcDump(FMC_APROM_BASE, s_au8Flash, 2UL * FMC_FLASH_PAGE_SIZE);
+    for(i = 0UL; (i < 2UL * FMC_FLASH_PAGE_SIZE) && (s_au8Flash[i] == 0x3CU); i++);
+    Check("Frame across a page refused", !s_bStreaming && (i32Ret == STREAM_ACK_SIZE) && (au8Rsp[2] == STREAM_ST_ADDR) &&
+          (i == 2UL * FMC_FLASH_PAGE_SIZE) && (Host_Packet(CMD_GET_FWVER, NULL, NULL, 0, au8Rsp) == 0));
+
+    /* Baud rate the HIRC divider cannot hit within tolerance */
+    Check("Rate out of tolerance refused", (Host_SetBaud(BAD_BAUD) == 0UL) && (Loader_Baud() == UART_BaudCheck(TEST_BAUD)) &&
+          (Host_Packet(CMD_GET_FWVER, NULL, NULL, 0, au8Rsp) == 0));
+
+    /* Host cannot follow: no confirmation, the loader falls back on its own */
+    au32Arg[0] = FAST_BAUD;
+    au32Arg[1] = 0UL;
+    i32Ret = Host_Packet(CMD_SET_BAUDRATE, au32Arg, NULL, 0, au8Rsp);
+    for(i = 0UL; i < 10000UL; i++)
+    {
+        Loader_Step();
+    }
+    Check("Unconfirmed rate falls back", (i32Ret == 0) && (g_u32BaudTrial == 0UL) && (Loader_Baud() == UART_BaudCheck(TEST_BAUD)) &&
+          (Host_Packet(CMD_GET_FWVER, NULL, NULL, 0, au8Rsp) == 0));
+
+    /* Line noise at the trial rate: back at once, no response */
+    i32Ret = Host_Packet(CMD_SET_BAUDRATE, au32Arg, NULL, 0, au8Rsp);
+    for(i = 0UL; i < sizeof(au8Noise); i++)
+    {
+        au8Noise[i] = (uint8_t)(0xE0U | i);
+    }
+    u64Tx = HostSim_UartGetTxCount(0);
+    HostSim_UartInject(0, au8Noise, sizeof(au8Noise));
+    for(i = 0UL; i < 100UL; i++)
+    {
+        Loader_Step();
+    }
+    Check("Noise at trial rate falls back", (i32Ret == 0) && (g_u32BaudTrial == 0UL) && (Loader_Baud() == UART_BaudCheck(TEST_BAUD)) &&
+          (HostSim_UartGetTxCount(0) == u64Tx) && (Host_Packet(CMD_GET_FWVER, NULL, NULL, 0, au8Rsp) == 0));
+
+    /* Confirmed high rate, then a full APROM */
+    Check("Rate confirmed", (Host_SetBaud(FAST_BAUD) == FAST_BAUD) && (Loader_Baud() == FAST_BAUD) &&
+          (Host_Packet(CMD_GET_FWVER, NULL, NULL, 0, au8Rsp) == 0) && (au8Rsp[8] == FW_VERSION));
+    Stream_Image("Stream upload at high rate", IMAGE_SIZE, FALSE, &u32FastMs);
+    Check("128 KB in under 3 s", u32FastMs < 3000UL);
+
+    /* CRC32 frame mode */
+    au8Noise[0] = 0x12U;
+    au8Noise[1] = 0x34U;
+    s_bSwapOnLine = TRUE;
+    Check("Swapped bytes pass the byte sum", Host_Packet(CMD_GET_FWVER, NULL, au8Noise, 2UL, au8Rsp) == 0);
+    au32Arg[0] = 1UL;
+    au32Arg[1] = 0UL;
+    i32Ret = Host_Packet(CMD_CRC32_MODE, au32Arg, NULL, 0, au8Rsp);
+    Check("CMD_CRC32_MODE", (i32Ret == 0) && (au8Rsp[8] == 1U) && (bCrc32Mode == TRUE));
+    s_bCrc32 = TRUE;
+    s_bSwapOnLine = TRUE;
+    i32Ret = Host_Packet(CMD_GET_FWVER, NULL, au8Noise, 2UL, au8Rsp);
+    au32Arg[0] = s_u32PackNo;
+    Check("Swapped bytes caught by CRC32", (i32Ret != 0) && (Host_Packet(CMD_SYNC_PACKNO, au32Arg, NULL, 0, au8Rsp) == 0));
+
+    memset(s_au8Flash, 0x3C, SLOW_SIZE);
+    HostSim_FmcLoad(FMC_APROM_BASE, s_au8Flash, SLOW_SIZE);
+    i32Ret = Host_PacketUpload(SLOW_SIZE, &u32EraseMs);
+    HostSim_FmcDump(FMC_APROM_BASE, s_au8Flash, SLOW_SIZE);
+    Check("Packet upload, CRC32 frames", (i32Ret == 0) && (memcmp(s_au8Image, s_au8Flash, SLOW_SIZE) == 0));
+    Check("CMD_GET_IMAGE_CRC", (Host_ImageCrc(FMC_APROM_BASE, SLOW_SIZE, &i) == SLOW_SIZE) &&
+          (i == IspPatch_Crc32(s_au8Image, SLOW_SIZE)));
+    memset(s_au8Flash, 0xFF, 1024UL);
+    memcpy(s_au8Flash, s_au8Image, 1000UL);
+    Check("Image CRC rounded up to whole pages", (Host_ImageCrc(FMC_APROM_BASE, 1000UL, &i) == 1024UL) &&
+          (i == IspPatch_Crc32(s_au8Image, 1024UL)));
+    Check("Image CRC outside APROM refused", Host_ImageCrc(FMC_LDROM_BASE, 1024UL, &i) == 0UL);
+
+    Stream_Image("Stream, CRC32 trailer, swapped bytes", IMAGE_SIZE, TRUE, &u32FastMs);
+    Check("Whole image CRC after stream", (Host_ImageCrc(FMC_APROM_BASE, IMAGE_SIZE, &i) == IMAGE_SIZE) &&
+          (i == IspPatch_Crc32(s_au8Image, IMAGE_SIZE)));
+    Check("CMD_CONNECT goes back to byte sums", (Host_Connect() == 0) && (bCrc32Mode == FALSE));
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,250 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Measure the ILI9341 emWin port flushing lines by PDMA on the host
+ *           simulator.
+ * @note     The port is built unchanged; a panel model on the USCI0 slave hook
+ *           decodes commands and pixels by the DC and CS pins. Frames are drawn
+ *           the way GUIDRV_FlexColor does it: window, memory write, then one
+ *           _WriteM1 per line, each line rendered in a given number of cycles.
+ *           Every frame is drawn twice, once waiting for each line to leave the
+ *           bus as the port used to, once letting the next line render while
+ *           the last one is sent. Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NuMicro.h"
+#include "hostsim.h"
+#include "GUI.h"
+#include "lcm.h"
+
+#define TEST_HCLK           48000000UL
+#define PANEL_XSIZE         320UL
+#define PANEL_YSIZE         240UL
+#define LINE_BYTES          (PANEL_XSIZE * 2UL)
+#define COPY_CYCLES         LINE_BYTES  /* Line copy into the PDMA buffer, about a cycle a byte */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint8_t s_au8Line[LINE_BYTES];
+static uint8_t s_au8Panel[PANEL_YSIZE][LINE_BYTES];
+static uint32_t s_u32Error = 0;
+
+/* Panel model */
+static uint32_t s_u32Cmd, s_u32Param, s_u32Cmds;
+static uint32_t s_au32Col[2], s_au32Row[2], s_u32X, s_u32Y, s_u32Byte;
+static uint32_t s_u32NoCs;
+
+void PDMA_IRQHandler(void)
+{
+    PDMA_DispatchIRQ(PDMA);
+}
+
+void GUI_X_Delay(int ms)
+{
+    HostSim_Delay((uint32_t)ms * (TEST_HCLK / 1000UL));
+}
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+    CLK->PWRCTL |= CLK_PWRCTL_HIRCEN_Msk;
+
+    while (!(CLK->STATUS & CLK_STATUS_HIRCSTB_Msk));
+
+    CLK->CLKSEL0 = (CLK->CLKSEL0 & (~CLK_CLKSEL0_HCLKSEL_Msk)) | CLK_CLKSEL0_HCLKSEL_HIRC;
+    CLK->CLKDIV0 = (CLK->CLKDIV0 & (~CLK_CLKDIV0_HCLKDIV_Msk)) | CLK_CLKDIV0_HCLK(1);
+    CLK->APBCLK1 |= CLK_APBCLK1_USCI0CKEN_Msk;
+    CLK->AHBCLK |= CLK_AHBCLK_PDMACKEN_Msk;
+
+    SystemCoreClockUpdate();
+}
+
+static void Check(const char *pcName, uint32_t u32Pass)
+{
+    printf("%-40s %s\n", pcName, u32Pass ? "PASS" : "FAIL");
+    if(!u32Pass)
+    {
+        s_u32Error++;
+    }
+}
+
+/* ILI9341 as far as the frames need it: column/page address set and memory write */
+static uint32_t Panel_Byte(uint32_t u32Tx)
+{
+    if(HostSim_GpioGetPin(0UL, 8UL))
+    {
+        s_u32NoCs++;
+        return 0UL;
+    }
+
+    if(HostSim_GpioGetPin(1UL, 2UL) == 0UL)
+    {
+        s_u32Cmd = u32Tx & 0xFFUL;
+        s_u32Param = 0UL;
+        s_u32Cmds++;
+        if(s_u32Cmd == 0x2CUL)
+        {
+            s_u32X = s_au32Col[0];
+            s_u32Y = s_au32Row[0];
+            s_u32Byte = 0UL;
+        }
+        return 0UL;
+    }
+
+    switch(s_u32Cmd)
+    {
+        case 0x2AUL:
+        case 0x2BUL:
+            if(s_u32Param < 4UL)
+            {
+                uint32_t *pu32Win = (s_u32Cmd == 0x2AUL) ? s_au32Col : s_au32Row;
+
+                pu32Win[s_u32Param / 2UL] = (s_u32Param & 1UL) ? ((pu32Win[s_u32Param / 2UL] & 0xFF00UL) | (u32Tx & 0xFFUL)) :
+                                            ((u32Tx & 0xFFUL) << 8);
+            }
+            s_u32Param++;
+            break;
+
+        case 0x2CUL:
+            if((s_u32Y < PANEL_YSIZE) && (s_u32X < PANEL_XSIZE))
+            {
+                s_au8Panel[s_u32Y][s_u32X * 2UL + s_u32Byte] = (uint8_t)u32Tx;
+            }
+            if(++s_u32Byte == 2UL)
+            {
+                s_u32Byte = 0UL;
+                if(++s_u32X > s_au32Col[1])
+                {
+                    s_u32X = s_au32Col[0];
+                    s_u32Y++;
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return 0UL;
+}
+
+static void Line_Render(uint32_t u32Frame, uint32_t u32Y)
+{
+    uint32_t x;
+
+    for(x = 0UL; x < LINE_BYTES; x++)
+    {
+        s_au8Line[x] = (uint8_t)(x * 3UL + u32Y * 7UL + u32Frame * 29UL);
+    }
+}
+
+static uint32_t Frame_Check(uint32_t u32Frame)
+{
+    uint32_t y;
+
+    for(y = 0UL; y < PANEL_YSIZE; y++)
+    {
+        Line_Render(u32Frame, y);
+        if(memcmp(s_au8Panel[y], s_au8Line, LINE_BYTES) != 0)
+        {
+            return 0UL;
+        }
+    }
+    return 1UL;
+}
+
+/* One full screen frame, in HCLK cycles until the last pixel is in the panel */
+static uint64_t Frame_Draw(uint32_t u32Frame, uint32_t u32RenderCycles, uint32_t bWaitLine)
+{
+    uint64_t u64Start = HostSim_GetCycle();
+    uint32_t y;
+
+    _Write0(0x2A);
+    _Write1(0x00);
+    _Write1(0x00);
+    _Write1((uint8_t)((PANEL_XSIZE - 1UL) >> 8));
+    _Write1((uint8_t)(PANEL_XSIZE - 1UL));
+    _Write0(0x2B);
+    _Write1(0x00);
+    _Write1(0x00);
+    _Write1((uint8_t)((PANEL_YSIZE - 1UL) >> 8));
+    _Write1((uint8_t)(PANEL_YSIZE - 1UL));
+    _Write0(0x2C);
+
+    for(y = 0UL; y < PANEL_YSIZE; y++)
+    {
+        Line_Render(u32Frame, y);
+        HostSim_Delay(u32RenderCycles);
+        _WriteM1(s_au8Line, (int)LINE_BYTES);
+        if(bWaitLine)
+        {
+            _WaitM1();
+        }
+        else
+        {
+            HostSim_Delay(COPY_CYCLES);
+        }
+    }
+    _WaitM1();
+
+    return HostSim_GetCycle() - u64Start;
+}
+
+int main(void)
+{
+    static const uint32_t au32Render[] = { 8UL * PANEL_XSIZE, 32UL * PANEL_XSIZE, 64UL * PANEL_XSIZE };
+    uint64_t u64Block, u64Async, u64Spi, u64Render;
+    uint32_t u32Frame = 0UL, u32Ok = 1UL, u32Hidden = 1UL, u32Bound = 1UL, u32Cmds, i;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        return 1;
+    }
+
+    SYS_Init();
+    HostSim_UspiSetSlave(Panel_Byte);
+    _InitController();
+    u32Cmds = s_u32Cmds;
+    Check("Init sequence reaches the panel", (u32Cmds == 20UL) && (s_u32NoCs == 0UL));
+
+    /* Bus time of one frame: 8 clocks a byte at PCLK / 2 */
+    u64Spi = (uint64_t)PANEL_YSIZE * LINE_BYTES * 8ULL * 2ULL * TEST_HCLK / HostSim_GetHclkFreq();
+
+    for(i = 0UL; i < sizeof(au32Render) / sizeof(au32Render[0]); i++)
+    {
+        memset(s_au8Panel, 0, sizeof(s_au8Panel));
+        u64Block = Frame_Draw(++u32Frame, au32Render[i], TRUE);
+        u32Ok &= Frame_Check(u32Frame);
+
+        memset(s_au8Panel, 0, sizeof(s_au8Panel));
+        u64Async = Frame_Draw(++u32Frame, au32Render[i], FALSE);
+        u32Ok &= Frame_Check(u32Frame);
+
+        printf("  render %2lu cycles/pixel: wait each line %6.2f ms %5.1f fps, overlapped %6.2f ms %5.1f fps\n",
+               (unsigned long)(au32Render[i] / PANEL_XSIZE),
+               (double)u64Block * 1000.0 / TEST_HCLK, (double)TEST_HCLK / (double)u64Block,
+               (double)u64Async * 1000.0 / TEST_HCLK, (double)TEST_HCLK / (double)u64Async);
+
+        /* Overlapped: the slower of bus and CPU sets the pace, not their sum */
+        u64Render = PANEL_YSIZE * (uint64_t)au32Render[i];
+        u32Hidden &= ((u64Block - u64Async) * 4ULL > ((u64Spi < u64Render) ? u64Spi : u64Render) * 3ULL);
+        u64Render += PANEL_YSIZE * (uint64_t)COPY_CYCLES;
+        u32Bound &= (u64Async < ((u64Spi > u64Render) ? u64Spi : u64Render) * 11ULL / 10ULL);
+    }
+
+    Check("Every pixel reaches the panel", u32Ok);
+    Check("Commands only while DC is low", s_u32Cmds == u32Cmds + u32Frame * 3UL);
+    Check("No byte outside chip select", s_u32NoCs == 0UL);
+    Check("Overlap hides the shorter of bus/render", u32Hidden);
+    Check("Frame time is bus or render bound", u32Bound);
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
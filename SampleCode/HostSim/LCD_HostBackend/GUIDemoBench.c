@@ -0,0 +1,356 @@
+/**************************************************************************//**
+ * @file     GUIDemoBench.c
+ * @version  V1.00
+ * @brief    Run every GUIDEMO module of emWin_GUIDemo over the host display
+ *           port and report the bytes sent to the panel per frame.
+ * @note     Needs an emWin library built for the host, see Linux/Makefile.
+ *           GUI_X.c of the target is replaced: time advances with GUI_X_Delay()
+ *           and with the bus time of the bytes sent at HOSTLCD_SPI_CLOCK only,
+ *           so an animation gets as many frames as the SPI link allows on the
+ *           board and every run gives the same numbers. A frame is what is
+ *           sent between two GUI_X_Delay() calls. GUIDEMO_Config() of the demo
+ *           is built as GUIDEMO_ConfigApp() and wrapped here, so each module
+ *           is measured on its own; the program ends after the last one.
+ *           Options: -o <dir> saves the last frame of each module as PPM,
+ *           -c <file> compares with the output of an earlier run and fails if
+ *           a module sends more than BENCH_TOLERANCE percent more per frame.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "GUI.h"
+#include "GUIDEMO.h"
+#include "HostLCD.h"
+#include "TouchPanel.h"
+
+#define BENCH_MAX_MODULES   24
+#define BENCH_TOLERANCE     5       /* Percent more bytes per frame than the reference */
+
+void GUIDEMO_ConfigApp(GUIDEMO_CONFIG *pConfig);
+
+/* Modules left out by the GUIDEMO configuration are not linked */
+#pragma weak GUIDEMO_AntialiasedText
+#pragma weak GUIDEMO_Automotive
+#pragma weak GUIDEMO_BarGraph
+#pragma weak GUIDEMO_Bitmap
+#pragma weak GUIDEMO_ColorBar
+#pragma weak GUIDEMO_Cursor
+#pragma weak GUIDEMO_Fading
+#pragma weak GUIDEMO_Graph
+#pragma weak GUIDEMO_IconView
+#pragma weak GUIDEMO_ImageFlow
+#pragma weak GUIDEMO_Listview
+#pragma weak GUIDEMO_RadialMenu
+#pragma weak GUIDEMO_Skinning
+#pragma weak GUIDEMO_Speed
+#pragma weak GUIDEMO_Speedometer
+#pragma weak GUIDEMO_TransparentDialog
+#pragma weak GUIDEMO_Treeview
+#pragma weak GUIDEMO_VScreen
+#pragma weak GUIDEMO_WashingMachine
+#pragma weak GUIDEMO_ZoomAndRotate
+
+static const struct
+{
+    void (*pfnModule)(void);
+    const char *pcName;
+} s_asName[] =
+{
+    { GUIDEMO_AntialiasedText,   "AntialiasedText" },
+    { GUIDEMO_Automotive,        "Automotive" },
+    { GUIDEMO_BarGraph,          "BarGraph" },
+    { GUIDEMO_Bitmap,            "Bitmap" },
+    { GUIDEMO_ColorBar,          "ColorBar" },
+    { GUIDEMO_Cursor,            "Cursor" },
+    { GUIDEMO_Fading,            "Fading" },
+    { GUIDEMO_Graph,             "Graph" },
+    { GUIDEMO_IconView,          "IconView" },
+    { GUIDEMO_ImageFlow,         "ImageFlow" },
+    { GUIDEMO_Listview,          "Listview" },
+    { GUIDEMO_RadialMenu,        "RadialMenu" },
+    { GUIDEMO_Skinning,          "Skinning" },
+    { GUIDEMO_Speed,             "Speed" },
+    { GUIDEMO_Speedometer,       "Speedometer" },
+    { GUIDEMO_TransparentDialog, "TransparentDialog" },
+    { GUIDEMO_Treeview,          "Treeview" },
+    { GUIDEMO_VScreen,           "VScreen" },
+    { GUIDEMO_WashingMachine,    "WashingMachine" },
+    { GUIDEMO_ZoomAndRotate,     "ZoomAndRotate" },
+};
+
+typedef struct
+{
+    const char *pcName;
+    uint64_t u64Frames;
+    uint64_t u64Bytes;
+    uint64_t u64MaxBytes;       /* Largest frame */
+    uint64_t u64BusNs;
+    uint64_t u64TimeMs;         /* Demo time, delays included */
+} BENCH_MODULE_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static void (*s_apfnApp[BENCH_MAX_MODULES + 1])(void);
+static BENCH_MODULE_T s_asModule[BENCH_MAX_MODULES + 1];   /* Intro first */
+static BENCH_MODULE_T *s_psModule;
+static BENCH_MODULE_T s_sStart;     /* Counters when s_psModule started */
+static uint64_t s_u64DelayMs;
+static uint64_t s_u64FrameBytes;    /* Bytes sent when the last frame ended */
+static const char *s_pcPPMDir;
+static const char *s_pcReference;
+static uint32_t s_u32Error = 0;
+
+/* Bytes sent and bus time so far */
+static uint64_t Bench_Bytes(uint64_t *pu64BusNs)
+{
+    HOSTLCD_STAT_T sStat;
+
+    HostLCD_GetStat(&sStat);
+    if(pu64BusNs != NULL)
+    {
+        *pu64BusNs = sStat.u64BusNs;
+    }
+    return sStat.u64CmdBytes + sStat.u64ParamBytes + sStat.u64PixelBytes + sStat.u64ReadBytes;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* GUI_X.c for the bench                                                                                   */
+/*---------------------------------------------------------------------------------------------------------*/
+GUI_TIMER_TIME GUI_X_GetTime(void)
+{
+    uint64_t u64BusNs;
+
+    Bench_Bytes(&u64BusNs);
+    return (GUI_TIMER_TIME)(s_u64DelayMs + u64BusNs / 1000000ULL);
+}
+
+void GUI_X_Delay(int ms)
+{
+    uint64_t u64Bytes;
+
+    u64Bytes = Bench_Bytes(NULL);
+    if((s_psModule != NULL) && (u64Bytes != s_u64FrameBytes))
+    {
+        s_psModule->u64Frames++;
+        if(u64Bytes - s_u64FrameBytes > s_psModule->u64MaxBytes)
+        {
+            s_psModule->u64MaxBytes = u64Bytes - s_u64FrameBytes;
+        }
+    }
+    s_u64FrameBytes = u64Bytes;
+    s_u64DelayMs += (ms > 0) ? (uint64_t)ms : 0ULL;
+}
+
+void GUI_X_Init(void) {}
+void GUI_X_ExecIdle(void) {}
+void GUI_X_Log(const char *s) { GUI_USE_PARA(s); }
+void GUI_X_Warn(const char *s) { GUI_USE_PARA(s); }
+void GUI_X_ErrorOut(const char *s) { GUI_USE_PARA(s); }
+void GUI_X_InitOS(void) {}
+void GUI_X_Unlock(void) {}
+void GUI_X_Lock(void) {}
+U32 GUI_X_GetTaskId(void) { return 1; }
+void GUI_X_WaitEvent(void) {}
+void GUI_X_SignalEvent(void) {}
+void GUI_X_WaitEventTimed(int Period) { GUI_USE_PARA(Period); }
+
+/* No touch panel on the host */
+int Poll_TouchPanel(int *x, int *y)
+{
+    (void)x;
+    (void)y;
+    return 0;
+}
+
+int ts_phy2log(int *sumx, int *sumy)
+{
+    (void)sumx;
+    (void)sumy;
+    return 0;
+}
+
+int Read_TouchEvent(struct ts_sample *samp)
+{
+    (void)samp;
+    return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Measurement                                                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+static void Bench_Begin(BENCH_MODULE_T *psModule, const char *pcName)
+{
+    memset(psModule, 0, sizeof(BENCH_MODULE_T));
+    psModule->pcName = pcName;
+    s_sStart.u64Bytes = Bench_Bytes(&s_sStart.u64BusNs);
+    s_sStart.u64TimeMs = (uint64_t)GUI_X_GetTime();
+    s_u64FrameBytes = s_sStart.u64Bytes;
+    s_psModule = psModule;
+}
+
+static void Bench_End(void)
+{
+    char acFile[256];
+
+    /* Whatever is left after the last delay is a frame too */
+    GUI_X_Delay(0);
+    s_psModule->u64Bytes = Bench_Bytes(&s_psModule->u64BusNs) - s_sStart.u64Bytes;
+    s_psModule->u64BusNs -= s_sStart.u64BusNs;
+    s_psModule->u64TimeMs = (uint64_t)GUI_X_GetTime() - s_sStart.u64TimeMs;
+    if(s_pcPPMDir != NULL)
+    {
+        snprintf(acFile, sizeof(acFile), "%s/%s.ppm", s_pcPPMDir, s_psModule->pcName);
+        if(HostLCD_WritePPM(acFile) != 0)
+        {
+            printf("# cannot write %s\n", acFile);
+        }
+    }
+    s_psModule = NULL;
+}
+
+/* Checks the bytes per frame against an earlier output of the bench */
+static void Bench_Compare(const char *pcName, uint64_t u64PerFrame)
+{
+    char acLine[256], acName[64];
+    unsigned long long u64RefFrames, u64RefBytes, u64RefPerFrame;
+    FILE *pFile;
+
+    pFile = fopen(s_pcReference, "r");
+    if(pFile == NULL)
+    {
+        return;
+    }
+    while(fgets(acLine, sizeof(acLine), pFile) != NULL)
+    {
+        if((sscanf(acLine, "%63s %llu %llu %llu", acName, &u64RefFrames, &u64RefBytes, &u64RefPerFrame) != 4) ||
+                (strcmp(acName, pcName) != 0))
+        {
+            continue;
+        }
+        if(u64PerFrame * 100ULL > u64RefPerFrame * (100ULL + BENCH_TOLERANCE))
+        {
+            printf("# %s: %llu bytes per frame, %llu before\n", pcName, (unsigned long long)u64PerFrame, u64RefPerFrame);
+            s_u32Error++;
+        }
+        break;
+    }
+    fclose(pFile);
+}
+
+static void Bench_Report(void)
+{
+    BENCH_MODULE_T *psModule;
+    uint64_t u64PerFrame;
+
+    printf("# %-18s %7s %11s %9s %9s %9s %9s\n", "module", "frames", "bytes", "B/frame", "max B", "bus ms", "demo ms");
+    for(psModule = s_asModule; psModule->pcName != NULL; psModule++)
+    {
+        u64PerFrame = psModule->u64Frames ? (psModule->u64Bytes / psModule->u64Frames) : 0ULL;
+        printf("%-20s %7llu %11llu %9llu %9llu %9.1f %9llu\n", psModule->pcName,
+               (unsigned long long)psModule->u64Frames, (unsigned long long)psModule->u64Bytes,
+               (unsigned long long)u64PerFrame, (unsigned long long)psModule->u64MaxBytes,
+               (double)psModule->u64BusNs / 1e6, (unsigned long long)psModule->u64TimeMs);
+        if(s_pcReference != NULL)
+        {
+            Bench_Compare(psModule->pcName, u64PerFrame);
+        }
+    }
+    printf("# %s\n", s_u32Error ? "FAIL" : "PASS");
+}
+
+static void Bench_Run(uint32_t u32Module)
+{
+    const char *pcName = "Unknown";
+    uint32_t i;
+
+    for(i = 0; i < sizeof(s_asName) / sizeof(s_asName[0]); i++)
+    {
+        if(s_asName[i].pfnModule == s_apfnApp[u32Module])
+        {
+            pcName = s_asName[i].pcName;
+        }
+    }
+
+    /* The intro and the background before the first module */
+    if(u32Module == 0)
+    {
+        Bench_End();
+    }
+
+    Bench_Begin(&s_asModule[u32Module + 1], pcName);
+    s_apfnApp[u32Module]();
+    Bench_End();
+
+    /* GUIDEMO_Main() starts over after the last module */
+    if(s_apfnApp[u32Module + 1] == NULL)
+    {
+        Bench_Report();
+        exit(s_u32Error ? 1 : 0);
+    }
+}
+
+#define BENCH_RUN(n)    static void Bench_Run##n(void) { Bench_Run(n); }
+BENCH_RUN(0)  BENCH_RUN(1)  BENCH_RUN(2)  BENCH_RUN(3)  BENCH_RUN(4)  BENCH_RUN(5)
+BENCH_RUN(6)  BENCH_RUN(7)  BENCH_RUN(8)  BENCH_RUN(9)  BENCH_RUN(10) BENCH_RUN(11)
+BENCH_RUN(12) BENCH_RUN(13) BENCH_RUN(14) BENCH_RUN(15) BENCH_RUN(16) BENCH_RUN(17)
+BENCH_RUN(18) BENCH_RUN(19) BENCH_RUN(20) BENCH_RUN(21) BENCH_RUN(22) BENCH_RUN(23)
+
+static void (*const s_apfnRun[BENCH_MAX_MODULES])(void) =
+{
+    Bench_Run0,  Bench_Run1,  Bench_Run2,  Bench_Run3,  Bench_Run4,  Bench_Run5,
+    Bench_Run6,  Bench_Run7,  Bench_Run8,  Bench_Run9,  Bench_Run10, Bench_Run11,
+    Bench_Run12, Bench_Run13, Bench_Run14, Bench_Run15, Bench_Run16, Bench_Run17,
+    Bench_Run18, Bench_Run19, Bench_Run20, Bench_Run21, Bench_Run22, Bench_Run23,
+};
+
+/* Called by GUIDEMO_Main(): each module of the demo is run through Bench_Run() */
+void GUIDEMO_Config(GUIDEMO_CONFIG *pConfig)
+{
+    static void (*s_apfnWrap[BENCH_MAX_MODULES + 1])(void);
+    uint32_t i;
+
+    GUIDEMO_ConfigApp(pConfig);
+    for(i = 0; pConfig->apFunc[i] != NULL; i++)
+    {
+        if(i == BENCH_MAX_MODULES)
+        {
+            printf("# more than %d modules\n", BENCH_MAX_MODULES);
+            exit(1);
+        }
+        s_apfnApp[i] = pConfig->apFunc[i];
+        s_apfnWrap[i] = s_apfnRun[i];
+    }
+    if(i == 0)
+    {
+        printf("# no modules configured\n");
+        exit(1);
+    }
+    pConfig->apFunc = s_apfnWrap;
+    Bench_Begin(&s_asModule[0], "Intro");
+}
+
+int main(int argc, char *argv[])
+{
+    int i;
+
+    for(i = 1; i + 1 < argc; i += 2)
+    {
+        if(strcmp(argv[i], "-o") == 0)
+        {
+            s_pcPPMDir = argv[i + 1];
+        }
+        else if(strcmp(argv[i], "-c") == 0)
+        {
+            s_pcReference = argv[i + 1];
+        }
+    }
+
+    GUI_Init();
+    GUIDEMO_Main();
+    return 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
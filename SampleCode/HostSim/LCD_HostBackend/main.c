@@ -0,0 +1,389 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Measure the bytes the emWin LCD configuration sends to the panel
+ *           per frame with the host display port.
+ * @note     LCDConf.c is built unchanged over HostLCD.c instead of the ILI9341
+ *           port, so no simulator is needed: the controller model counts every
+ *           byte and keeps the memory, which is compared with the drawn image
+ *           after every frame. The emWin entry points LCD_X_Config() calls are
+ *           stubbed and the port functions it hands to GUIDRV_FlexColor are
+ *           driven the way the driver blits a memory device. Each scene is
+ *           sent with and without partial refresh and checked against a byte
+ *           budget per frame, so a change that sends more fails here.
+ *           Run with a directory argument to save the last frame of each
+ *           scene as PPM there. Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "GUI.h"
+#include "GUIDRV_FlexColor.h"
+#include "lcm.h"
+#include "HostLCD.h"
+#include "TouchPanel.h"
+
+#define PANEL_XSIZE         320
+#define PANEL_YSIZE         240
+#define SCENE_FRAMES        8UL
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* emWin stand-ins for LCD_X_Config()                                                                      */
+/*---------------------------------------------------------------------------------------------------------*/
+const GUI_DEVICE_API GUIDRV_FlexColor_API;
+const LCD_API_COLOR_CONV LCD_API_ColorConv_565;
+static GUI_PORT_API s_sPort;
+
+GUI_DEVICE *GUI_DEVICE_CreateAndLink(const GUI_DEVICE_API *pDeviceAPI, const LCD_API_COLOR_CONV *pColorConvAPI, U16 Flags, int LayerIndex)
+{
+    (void)pDeviceAPI;
+    (void)pColorConvAPI;
+    (void)Flags;
+    (void)LayerIndex;
+    return NULL;
+}
+
+void GUIDRV_FlexColor_Config(GUI_DEVICE *pDevice, CONFIG_FLEXCOLOR *pConfig)
+{
+    (void)pDevice;
+    (void)pConfig;
+}
+
+void GUIDRV_FlexColor_SetFunc(GUI_DEVICE *pDevice, GUI_PORT_API *pHW_API, void (*pfFunc)(GUI_DEVICE *), void (*pfMode)(GUI_DEVICE *))
+{
+    (void)pDevice;
+    (void)pfFunc;
+    (void)pfMode;
+    s_sPort = *pHW_API;
+}
+
+void GUIDRV_FlexColor_SetFunc66709(GUI_DEVICE *pDevice)
+{
+    (void)pDevice;
+}
+
+void GUIDRV_FlexColor_SetMode16bppC0B8(GUI_DEVICE *pDevice)
+{
+    (void)pDevice;
+}
+
+int LCD_SetSizeEx(int LayerIndex, int xSize, int ySize)
+{
+    (void)LayerIndex;
+    (void)xSize;
+    (void)ySize;
+    return 0;
+}
+
+int LCD_SetVSizeEx(int LayerIndex, int xSize, int ySize)
+{
+    (void)LayerIndex;
+    (void)xSize;
+    (void)ySize;
+    return 0;
+}
+
+int GUI_TOUCH_Calibrate(int Coord, int Log0, int Log1, int Phys0, int Phys1)
+{
+    (void)Coord;
+    (void)Log0;
+    (void)Log1;
+    (void)Phys0;
+    (void)Phys1;
+    return 0;
+}
+
+int Poll_TouchPanel(int *x, int *y)
+{
+    (void)x;
+    (void)y;
+    return 0;
+}
+
+int ts_phy2log(int *sumx, int *sumy)
+{
+    (void)sumx;
+    (void)sumy;
+    return 0;
+}
+
+int Read_TouchEvent(struct ts_sample *samp)
+{
+    (void)samp;
+    return 0;
+}
+
+void GUI_TOUCH_StoreStateEx(const GUI_PID_STATE *pState)
+{
+    (void)pState;
+}
+
+void GUI_X_Delay(int ms)
+{
+    (void)ms;
+}
+
+void LCD_X_Config(void);
+int LCD_X_DisplayDriver(unsigned LayerIndex, unsigned Cmd, void *pData);
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint16_t s_au16Image[PANEL_YSIZE][PANEL_XSIZE];   /* What the application drew */
+static uint8_t s_au8Line[PANEL_XSIZE * 2];
+static uint32_t s_u32Error = 0;
+
+static void Check(const char *pcName, uint32_t u32Pass)
+{
+    printf("%-40s %s\n", pcName, u32Pass ? "PASS" : "FAIL");
+    if(!u32Pass)
+    {
+        s_u32Error++;
+    }
+}
+
+/* Controller memory against the image */
+static uint32_t Panel_Same(void)
+{
+    uint32_t x, y;
+
+    for(y = 0UL; y < PANEL_YSIZE; y++)
+    {
+        for(x = 0UL; x < PANEL_XSIZE; x++)
+        {
+            if(HostLCD_GetPixel(x, y) != (int32_t)s_au16Image[y][x])
+            {
+                return 0UL;
+            }
+        }
+    }
+    return 1UL;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Scenes                                                                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+#define BAR_X0      40
+#define BAR_Y0      200
+#define BAR_XSIZE   240
+#define BAR_YSIZE   16
+#define DLG_X0      60
+#define DLG_Y0      40
+#define DLG_XSIZE   200
+#define DLG_YSIZE   120
+
+/* Whole screen redrawn with a gradient that moves every frame, e.g. a fading background */
+static void Scene_Screen(uint32_t u32Step)
+{
+    int x, y;
+
+    for(y = 0; y < PANEL_YSIZE; y++)
+    {
+        for(x = 0; x < PANEL_XSIZE; x++)
+        {
+            s_au16Image[y][x] = (uint16_t)((((x + (int)u32Step * 8) >> 4) << 11) | ((y >> 2) << 5) | (u32Step & 0x1F));
+        }
+    }
+}
+
+/* Progress bar redrawn in full for every step of 8 pixels */
+static void Scene_Bar(uint32_t u32Step)
+{
+    int x, y;
+
+    for(y = 0; y < BAR_YSIZE; y++)
+    {
+        for(x = 0; x < BAR_XSIZE; x++)
+        {
+            s_au16Image[BAR_Y0 + y][BAR_X0 + x] = (x < (int)u32Step * 8) ? 0x041F : 0xC618;
+        }
+    }
+}
+
+/* Dialog repainted by the window manager with nothing changed */
+static void Scene_Dialog(uint32_t u32Step)
+{
+    int x, y;
+
+    (void)u32Step;
+    for(y = 0; y < DLG_YSIZE; y++)
+    {
+        for(x = 0; x < DLG_XSIZE; x++)
+        {
+            s_au16Image[DLG_Y0 + y][DLG_X0 + x] = (y < 16) ? 0x001F : (uint16_t)(((x ^ y) & 8) ? 0xFFFF : 0x8410);
+        }
+    }
+}
+
+/* Blit a rectangle of the image the way GUIDRV_FlexColor does */
+static void Blit(const GUI_PORT_API *psPort, int x0, int y0, int xSize, int ySize)
+{
+    int x, y;
+
+    psPort->pfWrite8_A0(0x2A);
+    psPort->pfWrite8_A1((U8)(x0 >> 8));
+    psPort->pfWrite8_A1((U8)x0);
+    psPort->pfWrite8_A1((U8)((x0 + xSize - 1) >> 8));
+    psPort->pfWrite8_A1((U8)(x0 + xSize - 1));
+    psPort->pfWrite8_A0(0x2B);
+    psPort->pfWrite8_A1((U8)(y0 >> 8));
+    psPort->pfWrite8_A1((U8)y0);
+    psPort->pfWrite8_A1((U8)((y0 + ySize - 1) >> 8));
+    psPort->pfWrite8_A1((U8)(y0 + ySize - 1));
+    psPort->pfWrite8_A0(0x2C);
+    for(y = y0; y < y0 + ySize; y++)
+    {
+        for(x = 0; x < xSize; x++)
+        {
+            s_au8Line[x * 2] = (uint8_t)(s_au16Image[y][x0 + x] >> 8);
+            s_au8Line[x * 2 + 1] = (uint8_t)s_au16Image[y][x0 + x];
+        }
+        psPort->pfWriteM8_A1(s_au8Line, xSize * 2);
+    }
+}
+
+/* One frame of a scene; returns the bytes sent to the panel */
+static uint64_t Frame_Draw(const GUI_PORT_API *psPort, uint32_t u32Scene, uint32_t u32Step)
+{
+    HOSTLCD_STAT_T sStat;
+
+    HostLCD_ClearStat();
+    switch(u32Scene)
+    {
+        case 0:
+            Scene_Screen(u32Step);
+            Blit(psPort, 0, 0, PANEL_XSIZE, PANEL_YSIZE);
+            break;
+        case 1:
+            Scene_Bar(u32Step);
+            Blit(psPort, BAR_X0, BAR_Y0, BAR_XSIZE, BAR_YSIZE);
+            break;
+        default:
+            Scene_Dialog(u32Step);
+            Blit(psPort, DLG_X0, DLG_Y0, DLG_XSIZE, DLG_YSIZE);
+            break;
+    }
+    _WaitM1();
+
+    HostLCD_GetStat(&sStat);
+    return sStat.u64CmdBytes + sStat.u64ParamBytes + sStat.u64PixelBytes;
+}
+
+int main(int argc, char *argv[])
+{
+    static const struct
+    {
+        const char *pcName;
+        uint64_t u64Budget;     /* Bytes per frame with partial refresh */
+    } asScene[] =
+    {
+        { "screen",   PANEL_XSIZE * PANEL_YSIZE * 2 + 64 },
+        { "progress", 32 * 2 * BAR_YSIZE * 2 + 64 },
+        { "dialog",   0 },
+    };
+    HOSTLCD_STAT_T sStat;
+    GUI_PORT_API sPlain;
+    uint64_t u64Bytes, u64Raw, u64Dirty, u64Pixels, u64Unchanged;
+    uint32_t u32XSize, u32YSize, u32Same = 1UL, u32Budget = 1UL, u32Scene, u32Step;
+    uint8_t au8Read[7];
+    char acFile[256];
+    FILE *pFile;
+    long lSize = -1;
+
+    /* Initial sequence of the ILI9341 port: 20 commands, 61 parameters, landscape */
+    LCD_X_Config();
+    HostLCD_ClearStat();
+    LCD_X_DisplayDriver(0, LCD_X_INITCONTROLLER, NULL);
+    HostLCD_GetStat(&sStat);
+    HostLCD_GetSize(&u32XSize, &u32YSize);
+    Check("Initial sequence reaches the controller", (sStat.u64CmdBytes == 20ULL) && (sStat.u64ParamBytes == 61ULL) &&
+          (u32XSize == PANEL_XSIZE) && (u32YSize == PANEL_YSIZE));
+
+    memset(&sPlain, 0, sizeof(sPlain));
+    sPlain.pfWrite8_A0 = _Write0;
+    sPlain.pfWrite8_A1 = _Write1;
+    sPlain.pfWriteM8_A1 = _WriteM1;
+
+    printf("  %-10s %12s %12s %10s\n", "scene", "plain B/f", "partial B/f", "bus ms/f");
+    for(u32Scene = 0UL; u32Scene < sizeof(asScene) / sizeof(asScene[0]); u32Scene++)
+    {
+        /* Restating the address mode makes the partial refresh forget the panel */
+        s_sPort.pfWrite8_A0(0x36);
+        s_sPort.pfWrite8_A1(0xE8);
+        Frame_Draw(&s_sPort, u32Scene, 0UL);
+        u32Same &= Panel_Same();
+        u64Dirty = 0ULL;
+        for(u32Step = 1UL; u32Step <= SCENE_FRAMES; u32Step++)
+        {
+            u64Bytes = Frame_Draw(&s_sPort, u32Scene, u32Step);
+            u64Dirty += u64Bytes;
+            u32Budget &= (u64Bytes <= asScene[u32Scene].u64Budget);
+            u32Same &= Panel_Same();
+        }
+
+        u64Raw = 0ULL;
+        u64Pixels = 0ULL;
+        u64Unchanged = 0ULL;
+        for(u32Step = 1UL; u32Step <= SCENE_FRAMES; u32Step++)
+        {
+            u64Raw += Frame_Draw(&sPlain, u32Scene, u32Step);
+            HostLCD_GetStat(&sStat);
+            u64Pixels += sStat.u64Pixels;
+            u64Unchanged += sStat.u64Unchanged;
+            u32Same &= Panel_Same();
+        }
+
+        printf("  %-10s %12lu %12lu %10.2f   %3lu%% of the plain pixels unchanged\n", asScene[u32Scene].pcName,
+               (unsigned long)(u64Raw / SCENE_FRAMES), (unsigned long)(u64Dirty / SCENE_FRAMES),
+               (double)u64Dirty * 8.0 * 1000.0 / HOSTLCD_SPI_CLOCK / SCENE_FRAMES,
+               (unsigned long)(u64Unchanged * 100ULL / u64Pixels));
+
+        if(argc > 1)
+        {
+            snprintf(acFile, sizeof(acFile), "%s/%s.ppm", argv[1], asScene[u32Scene].pcName);
+            if(HostLCD_WritePPM(acFile) != 0)
+            {
+                printf("  cannot write %s\n", acFile);
+            }
+        }
+    }
+    Check("Panel matches the image after each frame", u32Same);
+    Check("Frames stay within the byte budget", u32Budget);
+
+    /* Memory read: dummy byte, then 18 bpp */
+    s_au16Image[0][0] = 0xF81F;
+    s_au16Image[0][1] = 0x07E0;
+    Blit(&sPlain, 0, 0, 2, 1);
+    _Write0(0x2E);
+    _ReadM1(au8Read, sizeof(au8Read));
+    Check("Memory reads back in 18 bpp", (au8Read[1] == 0xFC) && (au8Read[2] == 0x00) && (au8Read[3] == 0xFC) &&
+          (au8Read[4] == 0x00) && (au8Read[5] == 0xFC) && (au8Read[6] == 0x00));
+
+    /* Bus time of a full screen at 24 MHz: 153600 bytes in 51.2 ms */
+    u64Bytes = Frame_Draw(&sPlain, 0UL, 0UL);
+    HostLCD_GetStat(&sStat);
+    Check("Bus time follows the SPI clock", sStat.u64BusNs == u64Bytes * 1000ULL / 3ULL);
+    HostLCD_SetSpiClock(12000000UL);
+    HostLCD_GetStat(&sStat);
+    Check("Half the clock takes twice as long", sStat.u64BusNs == u64Bytes * 2000ULL / 3ULL);
+    HostLCD_SetSpiClock(HOSTLCD_SPI_CLOCK);
+
+    if(HostLCD_WritePPM("LCD_HostBackend.ppm") == 0)
+    {
+        pFile = fopen("LCD_HostBackend.ppm", "rb");
+        if(pFile != NULL)
+        {
+            fseek(pFile, 0L, SEEK_END);
+            lSize = ftell(pFile);
+            fclose(pFile);
+        }
+        remove("LCD_HostBackend.ppm");
+    }
+    Check("Frame dumps as a 320x240 PPM", lSize == (long)(sizeof("P6\n320 240\n255\n") - 1 + PANEL_XSIZE * PANEL_YSIZE * 3));
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,452 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Measure the partial refresh of the emWin LCD configuration on the
+ *           host simulator.
+ * @note     LCDConf.c and the ILI9341 port are built unchanged. The emWin entry
+ *           points LCD_X_Config() calls are stubbed so the port functions it
+ *           hands to GUIDRV_FlexColor can be driven directly, the way the
+ *           driver blits a memory device: window, memory write, one write per
+ *           line. A panel model on the USCI0 slave hook keeps the controller
+ *           memory, which is compared with the drawn image after every frame.
+ *           The same frames are also sent through the plain port functions to
+ *           give the bytes and time without partial refresh.
+ *           Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NuMicro.h"
+#include "hostsim.h"
+#include "GUI.h"
+#include "GUIDRV_FlexColor.h"
+#include "lcm.h"
+#include "TouchPanel.h"
+
+#define TEST_HCLK           48000000UL
+#define PANEL_XSIZE         320
+#define PANEL_YSIZE         240
+#define RENDER_CYCLES       8UL     /* Memory device drawing, per pixel */
+#define FILTER_CYCLES       3UL     /* Row copy and segment hash of the partial refresh, per byte */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* emWin stand-ins for LCD_X_Config()                                                                      */
+/*---------------------------------------------------------------------------------------------------------*/
+const GUI_DEVICE_API GUIDRV_FlexColor_API;
+const LCD_API_COLOR_CONV LCD_API_ColorConv_565;
+static GUI_PORT_API s_sPort;
+
+GUI_DEVICE *GUI_DEVICE_CreateAndLink(const GUI_DEVICE_API *pDeviceAPI, const LCD_API_COLOR_CONV *pColorConvAPI, U16 Flags, int LayerIndex)
+{
+    (void)pDeviceAPI;
+    (void)pColorConvAPI;
+    (void)Flags;
+    (void)LayerIndex;
+    return NULL;
+}
+
+void GUIDRV_FlexColor_Config(GUI_DEVICE *pDevice, CONFIG_FLEXCOLOR *pConfig)
+{
+    (void)pDevice;
+    (void)pConfig;
+}
+
+void GUIDRV_FlexColor_SetFunc(GUI_DEVICE *pDevice, GUI_PORT_API *pHW_API, void (*pfFunc)(GUI_DEVICE *), void (*pfMode)(GUI_DEVICE *))
+{
+    (void)pDevice;
+    (void)pfFunc;
+    (void)pfMode;
+    s_sPort = *pHW_API;
+}
+
+void GUIDRV_FlexColor_SetFunc66709(GUI_DEVICE *pDevice)
+{
+    (void)pDevice;
+}
+
+void GUIDRV_FlexColor_SetMode16bppC0B8(GUI_DEVICE *pDevice)
+{
+    (void)pDevice;
+}
+
+int LCD_SetSizeEx(int LayerIndex, int xSize, int ySize)
+{
+    (void)LayerIndex;
+    (void)xSize;
+    (void)ySize;
+    return 0;
+}
+
+int LCD_SetVSizeEx(int LayerIndex, int xSize, int ySize)
+{
+    (void)LayerIndex;
+    (void)xSize;
+    (void)ySize;
+    return 0;
+}
+
+int GUI_TOUCH_Calibrate(int Coord, int Log0, int Log1, int Phys0, int Phys1)
+{
+    (void)Coord;
+    (void)Log0;
+    (void)Log1;
+    (void)Phys0;
+    (void)Phys1;
+    return 0;
+}
+
+int Poll_TouchPanel(int *x, int *y)
+{
+    (void)x;
+    (void)y;
+    return 0;
+}
+
+int ts_phy2log(int *sumx, int *sumy)
+{
+    (void)sumx;
+    (void)sumy;
+    return 0;
+}
+
+int Read_TouchEvent(struct ts_sample *samp)
+{
+    (void)samp;
+    return 0;
+}
+
+void GUI_TOUCH_StoreStateEx(const GUI_PID_STATE *pState)
+{
+    (void)pState;
+}
+
+void GUI_X_Delay(int ms)
+{
+    HostSim_Delay((uint32_t)ms * (TEST_HCLK / 1000UL));
+}
+
+void LCD_X_Config(void);
+int LCD_X_DisplayDriver(unsigned LayerIndex, unsigned Cmd, void *pData);
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint16_t s_au16Image[PANEL_YSIZE][PANEL_XSIZE];   /* What the application drew */
+static uint16_t s_au16Panel[PANEL_YSIZE][PANEL_XSIZE];   /* Controller memory */
+static uint8_t s_au8Line[PANEL_XSIZE * 2];
+static uint32_t s_u32Error = 0;
+
+/* Panel model */
+static uint32_t s_u32Cmd, s_u32Param, s_u32Byte, s_u32Cmds;
+static uint32_t s_au32Col[2], s_au32Row[2], s_u32X, s_u32Y;
+static uint16_t s_u16Pixel;
+
+void PDMA_IRQHandler(void)
+{
+    PDMA_DispatchIRQ(PDMA);
+}
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+    CLK->PWRCTL |= CLK_PWRCTL_HIRCEN_Msk;
+
+    while (!(CLK->STATUS & CLK_STATUS_HIRCSTB_Msk));
+
+    CLK->CLKSEL0 = (CLK->CLKSEL0 & (~CLK_CLKSEL0_HCLKSEL_Msk)) | CLK_CLKSEL0_HCLKSEL_HIRC;
+    CLK->CLKDIV0 = (CLK->CLKDIV0 & (~CLK_CLKDIV0_HCLKDIV_Msk)) | CLK_CLKDIV0_HCLK(1);
+    CLK->APBCLK1 |= CLK_APBCLK1_USCI0CKEN_Msk;
+    CLK->AHBCLK |= CLK_AHBCLK_PDMACKEN_Msk;
+
+    SystemCoreClockUpdate();
+}
+
+static void Check(const char *pcName, uint32_t u32Pass)
+{
+    printf("%-40s %s\n", pcName, u32Pass ? "PASS" : "FAIL");
+    if(!u32Pass)
+    {
+        s_u32Error++;
+    }
+}
+
+/* ILI9341 memory interface: column/page address set, memory write with wrap-around */
+static uint32_t Panel_Byte(uint32_t u32Tx)
+{
+    if(HostSim_GpioGetPin(0UL, 8UL))
+    {
+        return 0UL;
+    }
+
+    if(HostSim_GpioGetPin(1UL, 2UL) == 0UL)
+    {
+        s_u32Cmd = u32Tx & 0xFFUL;
+        s_u32Param = 0UL;
+        s_u32Cmds++;
+        if(s_u32Cmd == 0x2CUL)
+        {
+            s_u32X = s_au32Col[0];
+            s_u32Y = s_au32Row[0];
+            s_u32Byte = 0UL;
+        }
+        return 0UL;
+    }
+
+    switch(s_u32Cmd)
+    {
+        case 0x2AUL:
+        case 0x2BUL:
+            if(s_u32Param < 4UL)
+            {
+                uint32_t *pu32Win = (s_u32Cmd == 0x2AUL) ? s_au32Col : s_au32Row;
+
+                pu32Win[s_u32Param / 2UL] = (s_u32Param & 1UL) ? ((pu32Win[s_u32Param / 2UL] & 0xFF00UL) | (u32Tx & 0xFFUL)) :
+                                            ((u32Tx & 0xFFUL) << 8);
+            }
+            s_u32Param++;
+            break;
+
+        case 0x2CUL:
+            s_u16Pixel = (uint16_t)((s_u16Pixel << 8) | (u32Tx & 0xFFUL));
+            if(++s_u32Byte < 2UL)
+            {
+                break;
+            }
+            s_u32Byte = 0UL;
+            if((s_u32Y < PANEL_YSIZE) && (s_u32X < PANEL_XSIZE))
+            {
+                s_au16Panel[s_u32Y][s_u32X] = s_u16Pixel;
+            }
+            if(++s_u32X > s_au32Col[1])
+            {
+                s_u32X = s_au32Col[0];
+                if(++s_u32Y > s_au32Row[1])
+                {
+                    s_u32Y = s_au32Row[0];
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return 0UL;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Scenes                                                                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+#define DIAL_X0     60
+#define DIAL_Y0     20
+#define DIAL_SIZE   200
+#define GRAPH_X0    10
+#define GRAPH_Y0    40
+#define GRAPH_XSIZE 300
+#define GRAPH_YSIZE 160
+
+/* Dial face with a needle from the centre at angle u32Step */
+static void Scene_Dial(uint32_t u32Step)
+{
+    static const int8_t ai8Dir[16][2] =
+    {
+        {16, 0}, {15, 6}, {11, 11}, {6, 15}, {0, 16}, {-6, 15}, {-11, 11}, {-15, 6},
+        {-16, 0}, {-15, -6}, {-11, -11}, {-6, -15}, {0, -16}, {6, -15}, {11, -11}, {15, -6}
+    };
+    int x, y, i, dx, dy;
+
+    for(y = 0; y < DIAL_SIZE; y++)
+    {
+        for(x = 0; x < DIAL_SIZE; x++)
+        {
+            s_au16Image[DIAL_Y0 + y][DIAL_X0 + x] = (uint16_t)(((x >> 3) << 11) | ((y >> 2) << 5) | ((x + y) & 0x1F));
+        }
+    }
+
+    dx = ai8Dir[u32Step & 15UL][0];
+    dy = ai8Dir[u32Step & 15UL][1];
+    for(i = 0; i < 90; i++)
+    {
+        x = DIAL_SIZE / 2 + (dx * i) / 16;
+        y = DIAL_SIZE / 2 + (dy * i) / 16;
+        s_au16Image[DIAL_Y0 + y][DIAL_X0 + x] = 0xF800;
+        s_au16Image[DIAL_Y0 + y][DIAL_X0 + x + 1] = 0xF800;
+    }
+}
+
+/* Scrolling plot: every column moves one pixel to the left */
+static void Scene_Graph(uint32_t u32Step)
+{
+    int x, y, v;
+
+    for(x = 0; x < GRAPH_XSIZE; x++)
+    {
+        v = (int)(((uint32_t)x + u32Step) * 37UL % 97UL) + 30;
+        for(y = 0; y < GRAPH_YSIZE; y++)
+        {
+            s_au16Image[GRAPH_Y0 + y][GRAPH_X0 + x] = (y == v) ? 0x07E0 : 0x0008;
+        }
+    }
+}
+
+/* Small text field, off the segment grid */
+static void Scene_Label(uint32_t u32Step)
+{
+    int x, y;
+
+    for(y = 0; y < 16; y++)
+    {
+        for(x = 0; x < 44; x++)
+        {
+            s_au16Image[214 + y][37 + x] = (uint16_t)((((x / 11) * 4 + (int)u32Step) & 7) * 0x1111 + y);
+        }
+    }
+}
+
+/* Blit a rectangle of the image the way GUIDRV_FlexColor does */
+static void Blit(const GUI_PORT_API *psPort, int x0, int y0, int xSize, int ySize)
+{
+    int x, y;
+
+    psPort->pfWrite8_A0(0x2A);
+    psPort->pfWrite8_A1((U8)(x0 >> 8));
+    psPort->pfWrite8_A1((U8)x0);
+    psPort->pfWrite8_A1((U8)((x0 + xSize - 1) >> 8));
+    psPort->pfWrite8_A1((U8)(x0 + xSize - 1));
+    psPort->pfWrite8_A0(0x2B);
+    psPort->pfWrite8_A1((U8)(y0 >> 8));
+    psPort->pfWrite8_A1((U8)y0);
+    psPort->pfWrite8_A1((U8)((y0 + ySize - 1) >> 8));
+    psPort->pfWrite8_A1((U8)(y0 + ySize - 1));
+    psPort->pfWrite8_A0(0x2C);
+    for(y = y0; y < y0 + ySize; y++)
+    {
+        for(x = 0; x < xSize; x++)
+        {
+            s_au8Line[x * 2] = (uint8_t)(s_au16Image[y][x0 + x] >> 8);
+            s_au8Line[x * 2 + 1] = (uint8_t)s_au16Image[y][x0 + x];
+        }
+        HostSim_Delay(RENDER_CYCLES * (uint32_t)xSize);
+        if(psPort->pfWrite8_A0 != _Write0)
+        {
+            HostSim_Delay(FILTER_CYCLES * 2UL * (uint32_t)xSize);
+        }
+        psPort->pfWriteM8_A1(s_au8Line, xSize * 2);
+    }
+}
+
+typedef struct
+{
+    uint64_t u64Bytes;
+    uint64_t u64Cycles;
+} FRAME_COST_T;
+
+/* One frame of a scene, until the last byte is in the panel */
+static void Frame_Draw(const GUI_PORT_API *psPort, uint32_t u32Scene, uint32_t u32Step, FRAME_COST_T *psCost)
+{
+    uint64_t u64Bytes = HostSim_UspiGetTxCount();
+    uint64_t u64Start = HostSim_GetCycle();
+
+    switch(u32Scene)
+    {
+        case 0:
+            Scene_Dial(u32Step);
+            Blit(psPort, DIAL_X0, DIAL_Y0, DIAL_SIZE, DIAL_SIZE);
+            break;
+        case 1:
+            Scene_Graph(u32Step);
+            Blit(psPort, GRAPH_X0, GRAPH_Y0, GRAPH_XSIZE, GRAPH_YSIZE);
+            break;
+        default:
+            Scene_Label(u32Step);
+            Blit(psPort, 37, 214, 44, 16);
+            break;
+    }
+    _WaitM1();
+
+    psCost->u64Bytes = HostSim_UspiGetTxCount() - u64Bytes;
+    psCost->u64Cycles = HostSim_GetCycle() - u64Start;
+}
+
+int main(void)
+{
+    static const char *apcScene[] = { "dial needle", "scrolling graph", "text label" };
+    GUI_PORT_API sPlain;
+    FRAME_COST_T sCold, sRaw, sDirty;
+    uint32_t u32Same = 1UL, u32Scene, u32Step;
+    uint32_t au32Less[3] = { 0 }, u32Cold = 1UL;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        return 1;
+    }
+
+    SYS_Init();
+    HostSim_UspiSetSlave(Panel_Byte);
+    LCD_X_Config();
+    LCD_X_DisplayDriver(0, LCD_X_INITCONTROLLER, NULL);
+
+    memset(&sPlain, 0, sizeof(sPlain));
+    sPlain.pfWrite8_A0 = _Write0;
+    sPlain.pfWrite8_A1 = _Write1;
+    sPlain.pfWriteM8_A1 = _WriteM1;
+    for(u32Scene = 0UL; u32Scene < 3UL; u32Scene++)
+    {
+        uint64_t u64Raw = 0ULL, u64RawCycles = 0ULL, u64Dirty = 0ULL, u64DirtyCycles = 0ULL;
+
+        /*
+           Restating the address mode makes the filter forget the panel, which
+           the plain frames of the last scene have changed behind its back.
+           The first frame then has to go out in full.
+        */
+        s_sPort.pfWrite8_A0(0x36);
+        s_sPort.pfWrite8_A1(0xE8);
+        Frame_Draw(&s_sPort, u32Scene, 0UL, &sCold);
+        u32Same &= (memcmp(s_au16Panel, s_au16Image, sizeof(s_au16Panel)) == 0);
+        for(u32Step = 1UL; u32Step <= 8UL; u32Step++)
+        {
+            Frame_Draw(&s_sPort, u32Scene, u32Step, &sDirty);
+            u64Dirty += sDirty.u64Bytes;
+            u64DirtyCycles += sDirty.u64Cycles;
+            u32Same &= (memcmp(s_au16Panel, s_au16Image, sizeof(s_au16Panel)) == 0);
+        }
+
+        Frame_Draw(&sPlain, u32Scene, 0UL, &sRaw);
+        u32Cold &= (sCold.u64Bytes >= sRaw.u64Bytes) && (sCold.u64Bytes <= sRaw.u64Bytes + 64ULL);
+        for(u32Step = 1UL; u32Step <= 8UL; u32Step++)
+        {
+            Frame_Draw(&sPlain, u32Scene, u32Step, &sRaw);
+            u64Raw += sRaw.u64Bytes;
+            u64RawCycles += sRaw.u64Cycles;
+            u32Same &= (memcmp(s_au16Panel, s_au16Image, sizeof(s_au16Panel)) == 0);
+        }
+
+        printf("  %-16s %6lu -> %6lu bytes/frame, %6.2f -> %6.2f ms (%5.1f -> %5.1f fps)\n", apcScene[u32Scene],
+               (unsigned long)(u64Raw / 8ULL), (unsigned long)(u64Dirty / 8ULL),
+               (double)u64RawCycles / 8.0 * 1000.0 / TEST_HCLK, (double)u64DirtyCycles / 8.0 * 1000.0 / TEST_HCLK,
+               8.0 * TEST_HCLK / (double)u64RawCycles, 8.0 * TEST_HCLK / (double)u64DirtyCycles);
+        au32Less[u32Scene] = (uint32_t)(u64Dirty * 100ULL / u64Raw);
+    }
+
+    /* Twice the same frame: nothing to send */
+    s_sPort.pfWrite8_A0(0x36);
+    s_sPort.pfWrite8_A1(0xE8);
+    Frame_Draw(&s_sPort, 0UL, 3UL, &sCold);
+    Frame_Draw(&s_sPort, 0UL, 3UL, &sDirty);
+    u32Cold &= (sCold.u64Bytes >= (uint64_t)DIAL_SIZE * DIAL_SIZE * 2ULL);
+    u32Same &= (memcmp(s_au16Panel, s_au16Image, sizeof(s_au16Panel)) == 0);
+    Check("Port hooks the driver's data path", (s_sPort.pfWrite8_A0 != _Write0) && (s_sPort.pfWriteM8_A1 != _WriteM1));
+    Check("Panel matches the image after each frame", u32Same);
+    Check("Unknown panel contents are sent in full", u32Cold);
+    Check("Needle frames send under 25% of the bytes", au32Less[0] < 25UL);
+    Check("Scrolling graph sends no more bytes", au32Less[1] <= 100UL);
+    Check("Off-grid label sends no more bytes", au32Less[2] <= 100UL);
+    Check("Unchanged frame sends nothing", sDirty.u64Bytes == 0ULL);
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,232 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Measure the USBD_Mass_Storage_Flash page cache on the host simulator.
+ * @note     DataFlashProg.c of the StdDriver sample is built unchanged. A file
+ *           copy is replayed as the sector writes MSC_Write issues: data in
+ *           8-sector commands with the FAT, its mirror and the directory
+ *           rewritten in between. The same sequence runs once through a
+ *           per-sector erase and word program, as the sample did before the
+ *           cache, and once through the cache, then the flash image is
+ *           checked. Build with Linux/Makefile; "make PAGE_SIZE=2048 run"
+ *           builds for the 2KB flash page parts.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NuMicro.h"
+#include "hostsim.h"
+#include "massstorage.h"
+#include "DataFlashProg.h"
+
+#define TEST_HCLK           48000000UL
+#define SECTOR_FAT1         1UL
+#define SECTOR_FAT2         2UL
+#define SECTOR_DIR          3UL
+#define SECTOR_DATA         4UL
+#define FILE_COUNT          3UL
+#define FILE_SECTORS        16UL
+#define CMD_SECTORS         8UL         /* Sectors per WRITE_10 */
+#define VOLUME_SECTORS      (DATA_FLASH_STORAGE_SIZE / UDC_SECTOR_SIZE)
+
+typedef void (*PFN_SECTOR_WRITE)(uint32_t u32Addr, uint32_t *pu32Buf);
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint8_t s_au8Image[DATA_FLASH_STORAGE_SIZE] __attribute__((aligned(4)));
+static uint8_t s_au8Flash[DATA_FLASH_STORAGE_SIZE];
+static uint32_t s_au32Sector[UDC_SECTOR_SIZE / 4];
+static uint32_t s_au32Page[FLASH_PAGE_SIZE / 4];
+static uint32_t s_u32SectorWrites;
+static uint32_t s_u32Error = 0;
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+
+    CLK_EnableXtalRC(CLK_PWRCTL_HIRCEN_Msk);
+    CLK_WaitClockReady(CLK_STATUS_HIRCSTB_Msk);
+    CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(1));
+
+    SystemCoreClockUpdate();
+}
+
+static void Check(const char *pcName, uint32_t u32Pass)
+{
+    printf("%-40s %s\n", pcName, u32Pass ? "PASS" : "FAIL");
+    if(!u32Pass)
+    {
+        s_u32Error++;
+    }
+}
+
+/* The sample before the cache: read-modify-erase-write of the page for every sector */
+static void Ref_SectorWrite(uint32_t u32Addr, uint32_t *pu32Buf)
+{
+    uint32_t u32Page, i;
+
+    u32Addr += MASS_STORAGE_OFFSET;
+    u32Page = u32Addr & ~(FLASH_PAGE_SIZE - 1UL);
+
+    SYS_UnlockReg();
+    FMC_Open();
+    for(i = 0UL; i < FLASH_PAGE_SIZE / 4UL; i++)
+    {
+        s_au32Page[i] = FMC_Read(u32Page + i * 4UL);
+    }
+    memcpy((uint8_t *)s_au32Page + (u32Addr - u32Page), pu32Buf, UDC_SECTOR_SIZE);
+    FMC_Erase(u32Page);
+    for(i = 0UL; i < FLASH_PAGE_SIZE / 4UL; i++)
+    {
+        FMC_Write(u32Page + i * 4UL, s_au32Page[i]);
+    }
+    FMC_Close();
+    SYS_LockReg();
+}
+
+static void Cache_SectorWrite(uint32_t u32Addr, uint32_t *pu32Buf)
+{
+    DataFlashWrite(u32Addr, UDC_SECTOR_SIZE, (uint32_t)pu32Buf);
+}
+
+static void Host_WriteSector(PFN_SECTOR_WRITE pfnWrite, uint32_t u32Sector, uint32_t u32Seed)
+{
+    uint32_t i;
+
+    for(i = 0UL; i < UDC_SECTOR_SIZE / 4UL; i++)
+    {
+        s_au32Sector[i] = (u32Seed * 0x9E3779B1UL) ^ (i * 0x01000193UL) ^ u32Sector;
+    }
+    memcpy(&s_au8Image[u32Sector * UDC_SECTOR_SIZE], s_au32Sector, UDC_SECTOR_SIZE);
+    pfnWrite(u32Sector * UDC_SECTOR_SIZE, s_au32Sector);
+    s_u32SectorWrites++;
+}
+
+/* Copy FILE_COUNT files the way a host file system does */
+static void Host_CopyFiles(PFN_SECTOR_WRITE pfnWrite)
+{
+    uint32_t u32File, u32Sector, u32Seed = 1UL, i;
+
+    for(u32File = 0UL; u32File < FILE_COUNT; u32File++)
+    {
+        u32Sector = SECTOR_DATA + u32File * FILE_SECTORS;
+        for(i = 0UL; i < FILE_SECTORS; i++)
+        {
+            Host_WriteSector(pfnWrite, u32Sector + i, u32Seed++);
+
+            /* Cluster chain grows after every command */
+            if(((i + 1UL) % CMD_SECTORS) == 0UL)
+            {
+                Host_WriteSector(pfnWrite, SECTOR_FAT1, u32File * 2UL + i);
+                Host_WriteSector(pfnWrite, SECTOR_FAT2, u32File * 2UL + i);
+            }
+        }
+        Host_WriteSector(pfnWrite, SECTOR_DIR, u32File);
+    }
+}
+
+static void Flash_Reset(void)
+{
+    memset(s_au8Image, 0xFF, sizeof(s_au8Image));
+    HostSim_FmcLoad(MASS_STORAGE_OFFSET, s_au8Image, sizeof(s_au8Image));
+    s_u32SectorWrites = 0UL;
+}
+
+static uint64_t Run(const char *pcName, PFN_SECTOR_WRITE pfnWrite, HOSTSIM_FMC_STAT_T *psStat)
+{
+    HOSTSIM_FMC_STAT_T sStart;
+    uint64_t u64Start, u64Cycle;
+
+    Flash_Reset();
+    HostSim_FmcGetStat(&sStart);
+    u64Start = HostSim_GetCycle();
+
+    Host_CopyFiles(pfnWrite);
+    if(pfnWrite == Cache_SectorWrite)
+    {
+        /* SYNCHRONIZE CACHE before the host reports the copy done */
+        DataFlashFlush();
+    }
+
+    u64Cycle = HostSim_GetCycle() - u64Start;
+    HostSim_FmcGetStat(psStat);
+    psStat->u32PageErase -= sStart.u32PageErase;
+    psStat->u32WordProgram -= sStart.u32WordProgram;
+    psStat->u32MultiProgram -= sStart.u32MultiProgram;
+
+    printf("%-10s %3u sectors: %6.2f ms, %3u page erases, %5u words programmed\n", pcName,
+           (unsigned)s_u32SectorWrites, (double)u64Cycle * 1000.0 / TEST_HCLK, (unsigned)psStat->u32PageErase,
+           (unsigned)(psStat->u32WordProgram + psStat->u32MultiProgram));
+
+    HostSim_FmcDump(MASS_STORAGE_OFFSET, s_au8Flash, sizeof(s_au8Flash));
+    return u64Cycle;
+}
+
+int main(void)
+{
+    HOSTSIM_FMC_STAT_T sRef, sCache;
+    uint64_t u64Ref, u64Cache;
+    uint32_t i, u32Pass;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        printf("HostSim_Init failed\n");
+        return 1;
+    }
+
+    SYS_Init();
+
+    /* The simulator has no data flash base; the volume sits in APROM */
+    SYS_UnlockReg();
+    FMC_Open();
+    FMC_ENABLE_AP_UPDATE();
+
+    printf("\nUSB mass storage page cache on HostSim, %u-byte flash page, %u cache pages\n",
+           (unsigned)FLASH_PAGE_SIZE, (unsigned)DATA_FLASH_CACHE_PAGES);
+
+    u64Ref = Run("Per-sector", Ref_SectorWrite, &sRef);
+    Check("Per-sector image", memcmp(s_au8Flash, s_au8Image, sizeof(s_au8Image)) == 0);
+
+    u64Cache = Run("Cached", Cache_SectorWrite, &sCache);
+    Check("Cached image after flush", memcmp(s_au8Flash, s_au8Image, sizeof(s_au8Image)) == 0);
+    printf("Speed-up %.2fx, erases %u -> %u\n", (double)u64Ref / (double)u64Cache,
+           (unsigned)sRef.u32PageErase, (unsigned)sCache.u32PageErase);
+    /* With 512-byte pages every sector is its own page; only programming gets faster */
+    Check("Faster and no more erases", (sCache.u32PageErase <= sRef.u32PageErase) && (u64Cache < u64Ref) &&
+          ((FLASH_PAGE_SIZE == UDC_SECTOR_SIZE) || (sCache.u32PageErase * 2UL < sRef.u32PageErase)));
+
+    /* Writes must be visible to reads before they reach the flash */
+    Host_WriteSector(Cache_SectorWrite, SECTOR_DIR, 0x55AAUL);
+    HostSim_FmcDump(MASS_STORAGE_OFFSET + SECTOR_DIR * UDC_SECTOR_SIZE, s_au8Flash, UDC_SECTOR_SIZE);
+    u32Pass = DataFlashIsDirty() &&
+              (memcmp(s_au8Flash, &s_au8Image[SECTOR_DIR * UDC_SECTOR_SIZE], UDC_SECTOR_SIZE) != 0);
+    DataFlashRead(0UL, DATA_FLASH_STORAGE_SIZE, (uint32_t)s_au8Flash);
+    Check("Read returns unflushed sector", u32Pass && (memcmp(s_au8Flash, s_au8Image, sizeof(s_au8Image)) == 0));
+
+    /* Flushing again, or rewriting a sector with the data it holds, must not touch the flash */
+    DataFlashFlush();
+    HostSim_FmcGetStat(&sRef);
+    DataFlashFlush();
+    DataFlashWrite(SECTOR_FAT1 * UDC_SECTOR_SIZE, UDC_SECTOR_SIZE, (uint32_t)&s_au8Image[SECTOR_FAT1 * UDC_SECTOR_SIZE]);
+    DataFlashFlush();
+    HostSim_FmcGetStat(&sCache);
+    Check("Clean or unchanged pages not rewritten", (sCache.u32PageErase == sRef.u32PageErase) &&
+          (sCache.u32MultiProgram == sRef.u32MultiProgram) && !DataFlashIsDirty());
+
+    for(i = 0UL, u32Pass = 1UL; i < VOLUME_SECTORS; i++)
+    {
+        HostSim_FmcDump(MASS_STORAGE_OFFSET + i * UDC_SECTOR_SIZE, s_au8Flash, UDC_SECTOR_SIZE);
+        u32Pass &= (memcmp(s_au8Flash, &s_au8Image[i * UDC_SECTOR_SIZE], UDC_SECTOR_SIZE) == 0);
+    }
+    Check("Final image", u32Pass);
+
+    FMC_Close();
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,267 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Exercise the asynchronous PDMA transfer API on the host simulator.
+ * @note     UART0 and SPI0 run in loopback while the CPU keeps working; the
+ *           sample checks the received data and reports how much CPU work
+ *           overlapped the transfers. A reserved timeout channel shares
+ *           PDMA_IRQHandler with them through PDMA_DispatchIRQ().
+ *           Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NuMicro.h"
+#include "hostsim.h"
+
+#define TEST_HCLK           48000000UL
+#define TEST_UART_LEN       256UL
+#define TEST_SPI_LEN        512UL
+#define TEST_MEM_LEN        1024UL
+#define TEST_MEM_NUM        3UL
+#define TEST_WORK_CYCLES    48UL            /* One unit of CPU work, 1us at 48MHz */
+#define TEST_FRAME_LEN      10UL            /* Short frame ended by PDMA request timeout */
+#define TEST_TOUT_CNT       20UL            /* Timeout = 20 x 256 HCLK, about 10 characters at 921600 bps */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint8_t s_au8Tx[TEST_MEM_LEN] __attribute__((aligned(4)));
+static uint8_t s_au8Rx[TEST_MEM_LEN] __attribute__((aligned(4)));
+static uint32_t s_au32MemDst[TEST_MEM_NUM][TEST_MEM_LEN / 4UL];
+static volatile uint32_t s_u32DoneCnt = 0;
+static volatile int32_t s_i32LastStatus = PDMA_XFER_BUSY;
+static uint32_t s_u32Error = 0;
+static volatile uint32_t s_u32RxEvent = 0;
+static volatile uint32_t s_u32RxGot = 0;
+
+void PDMA_IRQHandler(void)
+{
+    PDMA_DispatchIRQ(PDMA);
+}
+
+static void Xfer_Done(void *pvUserData, int32_t i32Status)
+{
+    (void)pvUserData;
+    s_i32LastStatus = i32Status;
+    s_u32DoneCnt++;
+}
+
+static void Rx_Event(uint32_t u32Ch, uint32_t u32Event, void *pvUserData)
+{
+    (void)pvUserData;
+
+    if(u32Event & PDMA_EVENT_TIMEOUT)
+    {
+        /* Line is idle, stop the channel and keep the partial frame */
+        PDMA_SetTimeOut(PDMA, u32Ch, 0, 0);
+        PDMA_STOP(PDMA, u32Ch);
+        s_u32RxGot = TEST_UART_LEN - (((PDMA->DSCT[u32Ch].CTL & PDMA_DSCT_CTL_TXCNT_Msk) >> PDMA_DSCT_CTL_TXCNT_Pos) + 1UL);
+    }
+    else if(u32Event & PDMA_EVENT_DONE)
+    {
+        s_u32RxGot = TEST_UART_LEN;
+    }
+    s_u32RxEvent |= u32Event;
+}
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+
+    CLK_EnableXtalRC(CLK_PWRCTL_HIRCEN_Msk);
+    CLK_WaitClockReady(CLK_STATUS_HIRCSTB_Msk);
+    CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(1));
+    CLK->PCLKDIV = (CLK_PCLKDIV_APB0DIV_DIV1 | CLK_PCLKDIV_APB1DIV_DIV1);
+
+    CLK_EnableModuleClock(UART0_MODULE);
+    CLK_SetModuleClock(UART0_MODULE, CLK_CLKSEL1_UART0SEL_HIRC, CLK_CLKDIV0_UART0(1));
+    CLK_EnableModuleClock(SPI0_MODULE);
+    CLK_SetModuleClock(SPI0_MODULE, CLK_CLKSEL2_SPI0SEL_PCLK1, MODULE_NoMsk);
+    CLK_EnableModuleClock(PDMA_MODULE);
+
+    SystemCoreClockUpdate();
+}
+
+/* Do CPU work until u32Target transfers have completed, return the work units done */
+static uint32_t Work_Until(uint32_t u32Target)
+{
+    uint32_t u32Work = 0UL;
+
+    while(s_u32DoneCnt < u32Target)
+    {
+        HostSim_Delay(TEST_WORK_CYCLES);
+        u32Work++;
+    }
+    return u32Work;
+}
+
+static void Check(const char *pcName, const void *pvExpect, const void *pvGot, uint32_t u32Len, uint32_t u32Work)
+{
+    uint32_t u32Ok = (memcmp(pvExpect, pvGot, u32Len) == 0) ? 1UL : 0UL;
+
+    printf("%-24s %5u bytes  %-4s  %6u us CPU work overlapped\n", pcName, (unsigned)u32Len, u32Ok ? "PASS" : "FAIL", (unsigned)u32Work);
+    if(!u32Ok)
+    {
+        s_u32Error++;
+    }
+}
+
+static void Test_Uart(void)
+{
+    S_PDMA_XFER_T sTx, sRx;
+    uint32_t u32Work, u32Remain;
+
+    UART_Open(UART0, 921600);
+    HostSim_UartSetLoopback(0, 1);
+
+    sTx.pfnCallback = Xfer_Done;
+    sTx.pvUserData = NULL;
+    sRx = sTx;
+    s_u32DoneCnt = 0UL;
+    memset(s_au8Rx, 0, sizeof(s_au8Rx));
+
+    UART_ReadAsync(UART0, &sRx, s_au8Rx, TEST_UART_LEN);
+    UART_WriteAsync(UART0, &sTx, s_au8Tx, TEST_UART_LEN);
+    u32Work = Work_Until(2UL);
+    Check("UART0 921600 loopback", s_au8Tx, s_au8Rx, TEST_UART_LEN, u32Work);
+
+    /* Abort a receive that cannot complete and get the partial count */
+    s_u32DoneCnt = 0UL;
+    UART_ReadAsync(UART0, &sRx, s_au8Rx, TEST_UART_LEN);
+    UART_WriteAsync(UART0, &sTx, s_au8Tx, 16UL);
+    Work_Until(1UL);
+    HostSim_Delay(TEST_HCLK / 2000UL);
+    u32Remain = PDMA_XferAbort(PDMA, &sRx);
+    printf("%-24s %5u bytes  received before abort\n", "UART0 RX abort", (unsigned)(TEST_UART_LEN - u32Remain));
+    if((s_i32LastStatus != PDMA_XFER_ABORT) || (sRx.i32Status != PDMA_XFER_ABORT) || (u32Remain != TEST_UART_LEN - 16UL))
+    {
+        s_u32Error++;
+    }
+
+    HostSim_UartSetLoopback(0, 0);
+    UART_Close(UART0);
+}
+
+static void Test_Timeout(void)
+{
+    S_PDMA_XFER_T sTx;
+    int32_t i32Ch;
+
+    UART_Open(UART0, 921600);
+    HostSim_UartSetLoopback(0, 1);
+    memset(s_au8Rx, 0, sizeof(s_au8Rx));
+
+    /* Frame receiver owns a timeout capable channel, the transmitter takes any free one */
+    i32Ch = PDMA_RequestChannel(PDMA, PDMA_CH_TOUT);
+    PDMA_SetCallback(PDMA, (uint32_t)i32Ch, Rx_Event, NULL);
+    PDMA_SetTransferCnt(PDMA, (uint32_t)i32Ch, PDMA_WIDTH_8, TEST_UART_LEN);
+    PDMA_SetTransferAddr(PDMA, (uint32_t)i32Ch, (uint32_t)&UART0->DAT, PDMA_SAR_FIX, (uint32_t)s_au8Rx, PDMA_DAR_INC);
+    PDMA_SetBurstType(PDMA, (uint32_t)i32Ch, PDMA_REQ_SINGLE, 0);
+    PDMA_SetTransferMode(PDMA, (uint32_t)i32Ch, PDMA_UART0_RX, FALSE, 0);
+    PDMA_SetTimeOut(PDMA, (uint32_t)i32Ch, 1, TEST_TOUT_CNT);
+    PDMA_EnableInt(PDMA, (uint32_t)i32Ch, PDMA_INT_TRANS_DONE);
+    PDMA_EnableInt(PDMA, (uint32_t)i32Ch, PDMA_INT_TIMEOUT);
+    UART0->INTEN |= UART_INTEN_RXPDMAEN_Msk;
+
+    s_u32RxEvent = 0UL;
+    s_u32DoneCnt = 0UL;
+    sTx.pfnCallback = Xfer_Done;
+    sTx.pvUserData = NULL;
+    UART_WriteAsync(UART0, &sTx, s_au8Tx, TEST_FRAME_LEN);
+
+    while((s_u32RxEvent == 0UL) || (s_u32DoneCnt == 0UL))
+    {
+        __WFI();
+    }
+
+    printf("%-24s %5u bytes  channel %d, event 0x%X\n", "UART0 RX timeout", (unsigned)s_u32RxGot, (int)i32Ch, (unsigned)s_u32RxEvent);
+    if((s_u32RxEvent != PDMA_EVENT_TIMEOUT) || (s_u32RxGot != TEST_FRAME_LEN) || (memcmp(s_au8Tx, s_au8Rx, TEST_FRAME_LEN) != 0))
+    {
+        s_u32Error++;
+    }
+
+    UART0->INTEN &= ~UART_INTEN_RXPDMAEN_Msk;
+    PDMA_ReleaseChannel(PDMA, (uint32_t)i32Ch);
+    HostSim_UartSetLoopback(0, 0);
+    UART_Close(UART0);
+}
+
+static void Test_Spi(void)
+{
+    S_PDMA_XFER_T sTx, sRx;
+    uint32_t u32Work;
+
+    SPI_Open(SPI0, SPI_MASTER, SPI_MODE_0, 8, 12000000);
+    HostSim_SpiSetSlave(NULL);
+
+    sTx.pfnCallback = Xfer_Done;
+    sTx.pvUserData = NULL;
+    sRx = sTx;
+    s_u32DoneCnt = 0UL;
+    memset(s_au8Rx, 0, sizeof(s_au8Rx));
+
+    SPI_ReadAsync(SPI0, &sRx, s_au8Rx, TEST_SPI_LEN);
+    SPI_WriteAsync(SPI0, &sTx, s_au8Tx, TEST_SPI_LEN);
+    u32Work = Work_Until(2UL);
+    Check("SPI0 12MHz full-duplex", s_au8Tx, s_au8Rx, TEST_SPI_LEN, u32Work);
+
+    SPI_Close(SPI0);
+}
+
+static void Test_Mem(void)
+{
+    S_PDMA_XFER_T asXfer[TEST_MEM_NUM];
+    uint32_t i, u32Work;
+    int32_t i32Ch;
+
+    s_u32DoneCnt = 0UL;
+    memset(s_au32MemDst, 0, sizeof(s_au32MemDst));
+
+    for(i = 0UL; i < TEST_MEM_NUM; i++)
+    {
+        asXfer[i].pfnCallback = Xfer_Done;
+        asXfer[i].pvUserData = NULL;
+        i32Ch = PDMA_XferStart(PDMA, &asXfer[i], PDMA_MEM, PDMA_WIDTH_32, (uint32_t)s_au8Tx, PDMA_SAR_INC,
+                               (uint32_t)s_au32MemDst[i], PDMA_DAR_INC, TEST_MEM_LEN / 4UL);
+        printf("memory transfer %u on channel %d\n", (unsigned)i, (int)i32Ch);
+    }
+    u32Work = Work_Until(TEST_MEM_NUM);
+
+    for(i = 0UL; i < TEST_MEM_NUM; i++)
+    {
+        Check("PDMA memory to memory", s_au8Tx, s_au32MemDst[i], TEST_MEM_LEN, u32Work);
+    }
+}
+
+int main(void)
+{
+    uint32_t i;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        printf("HostSim_Init failed\n");
+        return 1;
+    }
+
+    SYS_Init();
+    NVIC_EnableIRQ(PDMA_IRQn);
+
+    for(i = 0UL; i < TEST_MEM_LEN; i++)
+    {
+        s_au8Tx[i] = (uint8_t)(i * 13UL + 5UL);
+    }
+
+    printf("\nAsynchronous PDMA transfer on HostSim\n");
+    Test_Uart();
+    Test_Timeout();
+    Test_Spi();
+    Test_Mem();
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
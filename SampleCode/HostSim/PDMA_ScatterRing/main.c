@@ -0,0 +1,196 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Stream UART0 receive data into a PDMA scatter-gather ring on the
+ *           host simulator.
+ * @note     Four 32-byte buffers built by PDMA_BuildScatterChain() form a ring
+ *           that is never re-armed; the consumer walks the buffers in order on
+ *           each transfer done event. A linear transmit chain then gathers
+ *           three separate buffers into UART0 TX. Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NuMicro.h"
+#include "hostsim.h"
+
+#define TEST_HCLK           48000000UL
+#define RING_NUM            4UL
+#define RING_LEN            32UL
+#define STREAM_LEN          1024UL
+#define GATHER_NUM          3UL
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+/* All descriptor tables share the 64 KB window selected by PDMA->SCATBA */
+static struct
+{
+    DSCT_T asRx[RING_NUM];
+    DSCT_T asTx[GATHER_NUM];
+} s_sDesc __attribute__((aligned(16)));
+
+static uint8_t s_au8Ring[RING_NUM][RING_LEN] __attribute__((aligned(4)));
+static uint8_t s_au8Gather[GATHER_NUM][RING_LEN] __attribute__((aligned(4)));
+static uint8_t s_au8Tx[STREAM_LEN] __attribute__((aligned(4)));
+static uint8_t s_au8Got[STREAM_LEN + GATHER_NUM * RING_LEN];
+static volatile uint32_t s_u32BufCnt = 0;
+static volatile uint32_t s_u32TxDone = 0;
+static uint32_t s_u32Error = 0;
+
+void PDMA_IRQHandler(void)
+{
+    PDMA_DispatchIRQ(PDMA);
+}
+
+static void Ring_Event(uint32_t u32Ch, uint32_t u32Event, void *pvUserData)
+{
+    (void)u32Ch;
+    (void)pvUserData;
+
+    if(u32Event & PDMA_EVENT_DONE)
+    {
+        /* Tables finish in order, so a running count names the buffer just filled */
+        memcpy(&s_au8Got[s_u32BufCnt * RING_LEN], s_au8Ring[s_u32BufCnt % RING_NUM], RING_LEN);
+        s_u32BufCnt++;
+    }
+}
+
+static void Tx_Event(uint32_t u32Ch, uint32_t u32Event, void *pvUserData)
+{
+    (void)u32Ch;
+    (void)pvUserData;
+
+    if(u32Event & PDMA_EVENT_DONE)
+    {
+        s_u32TxDone++;
+    }
+}
+
+static void Xfer_Done(void *pvUserData, int32_t i32Status)
+{
+    (void)pvUserData;
+    (void)i32Status;
+    s_u32TxDone++;
+}
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+
+    CLK_EnableXtalRC(CLK_PWRCTL_HIRCEN_Msk);
+    CLK_WaitClockReady(CLK_STATUS_HIRCSTB_Msk);
+    CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(1));
+    CLK->PCLKDIV = (CLK_PCLKDIV_APB0DIV_DIV1 | CLK_PCLKDIV_APB1DIV_DIV1);
+
+    CLK_EnableModuleClock(UART0_MODULE);
+    CLK_SetModuleClock(UART0_MODULE, CLK_CLKSEL1_UART0SEL_HIRC, CLK_CLKDIV0_UART0(1));
+    CLK_EnableModuleClock(PDMA_MODULE);
+
+    SystemCoreClockUpdate();
+}
+
+static void Wait_Buffers(uint32_t u32Target)
+{
+    while(s_u32BufCnt < u32Target)
+    {
+        __WFI();
+    }
+}
+
+int main(void)
+{
+    S_PDMA_XFER_T sTx;
+    uint32_t i, au32Buf[RING_NUM > GATHER_NUM ? RING_NUM : GATHER_NUM];
+    int32_t i32RxCh, i32TxCh;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        printf("HostSim_Init failed\n");
+        return 1;
+    }
+
+    SYS_Init();
+    NVIC_EnableIRQ(PDMA_IRQn);
+
+    for(i = 0UL; i < STREAM_LEN; i++)
+    {
+        s_au8Tx[i] = (uint8_t)(i * 7UL + 3UL);
+    }
+    for(i = 0UL; i < GATHER_NUM * RING_LEN; i++)
+    {
+        s_au8Gather[i / RING_LEN][i % RING_LEN] = (uint8_t)(0xA0UL + i);
+    }
+
+    UART_Open(UART0, 921600);
+    HostSim_UartSetLoopback(0, 1);
+    PDMA->SCATBA = (uint32_t)&s_sDesc & PDMA_SCATBA_SCATBA_Msk;
+
+    printf("\nPDMA scatter-gather ring on HostSim\n");
+
+    /* Receive ring: armed once, keeps streaming until stopped */
+    for(i = 0UL; i < RING_NUM; i++)
+    {
+        au32Buf[i] = (uint32_t)s_au8Ring[i];
+    }
+    if(PDMA_BuildScatterChain(PDMA, s_sDesc.asRx, au32Buf, RING_NUM, RING_LEN, PDMA_WIDTH_8 | PDMA_REQ_SINGLE,
+                              (uint32_t)&UART0->DAT, PDMA_CHAIN_RX | PDMA_CHAIN_RING) != 0)
+    {
+        printf("Build receive ring failed\n");
+        return 1;
+    }
+    i32RxCh = PDMA_RequestChannel(PDMA, PDMA_CH_ANY);
+    PDMA_SetCallback(PDMA, (uint32_t)i32RxCh, Ring_Event, NULL);
+    PDMA_SetTransferMode(PDMA, (uint32_t)i32RxCh, PDMA_UART0_RX, TRUE, (uint32_t)&s_sDesc.asRx[0]);
+    PDMA_EnableInt(PDMA, (uint32_t)i32RxCh, PDMA_INT_TRANS_DONE);
+    UART0->INTEN |= UART_INTEN_RXPDMAEN_Msk;
+
+    /* Continuous stream, many times the ring size */
+    sTx.pfnCallback = Xfer_Done;
+    sTx.pvUserData = NULL;
+    UART_WriteAsync(UART0, &sTx, s_au8Tx, STREAM_LEN);
+    Wait_Buffers(STREAM_LEN / RING_LEN);
+
+    printf("%-24s %5u bytes  %3u buffers  %s\n", "UART0 RX ring", (unsigned)STREAM_LEN, (unsigned)s_u32BufCnt,
+           (memcmp(s_au8Tx, s_au8Got, STREAM_LEN) == 0) ? "PASS" : "FAIL");
+    if(memcmp(s_au8Tx, s_au8Got, STREAM_LEN) != 0)
+    {
+        s_u32Error++;
+    }
+
+    /* Gather: linear transmit chain of three separate buffers, the ring keeps receiving */
+    for(i = 0UL; i < GATHER_NUM; i++)
+    {
+        au32Buf[i] = (uint32_t)s_au8Gather[i];
+    }
+    PDMA_BuildScatterChain(PDMA, s_sDesc.asTx, au32Buf, GATHER_NUM, RING_LEN, PDMA_WIDTH_8 | PDMA_REQ_SINGLE | PDMA_TBINTDIS_DISABLE,
+                           (uint32_t)&UART0->DAT, PDMA_CHAIN_TX);
+    s_u32TxDone = 0UL;
+    i32TxCh = PDMA_RequestChannel(PDMA, PDMA_CH_ANY);
+    PDMA_SetCallback(PDMA, (uint32_t)i32TxCh, Tx_Event, NULL);
+    PDMA_SetTransferMode(PDMA, (uint32_t)i32TxCh, PDMA_UART0_TX, TRUE, (uint32_t)&s_sDesc.asTx[0]);
+    PDMA_EnableInt(PDMA, (uint32_t)i32TxCh, PDMA_INT_TRANS_DONE);
+    UART0->INTEN |= UART_INTEN_TXPDMAEN_Msk;
+    Wait_Buffers(STREAM_LEN / RING_LEN + GATHER_NUM);
+
+    printf("%-24s %5u bytes  %3u done event  %s\n", "UART0 TX gather", (unsigned)(GATHER_NUM * RING_LEN), (unsigned)s_u32TxDone,
+           ((s_u32TxDone == 1UL) && (memcmp(s_au8Gather, &s_au8Got[STREAM_LEN], GATHER_NUM * RING_LEN) == 0)) ? "PASS" : "FAIL");
+    if((s_u32TxDone != 1UL) || (memcmp(s_au8Gather, &s_au8Got[STREAM_LEN], GATHER_NUM * RING_LEN) != 0))
+    {
+        s_u32Error++;
+    }
+
+    UART0->INTEN &= ~(UART_INTEN_RXPDMAEN_Msk | UART_INTEN_TXPDMAEN_Msk);
+    PDMA_STOP(PDMA, (uint32_t)i32RxCh);
+    PDMA_ReleaseChannel(PDMA, (uint32_t)i32TxCh);
+    PDMA_ReleaseChannel(PDMA, (uint32_t)i32RxCh);
+    HostSim_UartSetLoopback(0, 0);
+    UART_Close(UART0);
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
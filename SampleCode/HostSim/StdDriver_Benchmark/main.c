@@ -0,0 +1,365 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Measure StdDriver throughput on the host register-level simulator.
+ * @note     Build with Linux/Makefile on an x86-64 Linux host. The figures are
+ *           simulated HCLK cycles, not host run time.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NuMicro.h"
+#include "hostsim.h"
+
+#define BENCH_HCLK          48000000UL
+#define BENCH_UART_LEN      1024UL
+#define BENCH_SPI_LEN       1024UL
+#define BENCH_PDMA_LEN      4096UL
+#define BENCH_FMC_ADDR      0x20000UL
+#define BENCH_FMC_LEN       FMC_FLASH_PAGE_SIZE
+#define BENCH_CRC_LEN       4096UL
+#define BENCH_USB_LEN       64UL
+#define BENCH_USB_PKT       1024UL
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint8_t s_au8Src[BENCH_PDMA_LEN] __attribute__((aligned(4)));
+static uint8_t s_au8Dst[BENCH_PDMA_LEN] __attribute__((aligned(4)));
+static volatile uint32_t s_u32PdmaDone = 0;
+
+void PDMA_IRQHandler(void)
+{
+    uint32_t u32Sts = PDMA_GET_TD_STS(PDMA);
+
+    PDMA_CLR_TD_FLAG(PDMA, u32Sts);
+    s_u32PdmaDone |= u32Sts;
+}
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+
+    /* Enable HIRC clock (Internal RC 48MHz) and run HCLK from it */
+    CLK_EnableXtalRC(CLK_PWRCTL_HIRCEN_Msk);
+    CLK_WaitClockReady(CLK_STATUS_HIRCSTB_Msk);
+    CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(1));
+    CLK->PCLKDIV = (CLK_PCLKDIV_APB0DIV_DIV1 | CLK_PCLKDIV_APB1DIV_DIV1);
+
+    CLK_EnableModuleClock(UART0_MODULE);
+    CLK_SetModuleClock(UART0_MODULE, CLK_CLKSEL1_UART0SEL_HIRC, CLK_CLKDIV0_UART0(1));
+    CLK_EnableModuleClock(SPI0_MODULE);
+    CLK_SetModuleClock(SPI0_MODULE, CLK_CLKSEL2_SPI0SEL_PCLK1, MODULE_NoMsk);
+    CLK_EnableModuleClock(PDMA_MODULE);
+    CLK_EnableModuleClock(CRC_MODULE);
+    CLK_EnableModuleClock(ISP_MODULE);
+    CLK_EnableModuleClock(USBD_MODULE);
+
+    SystemCoreClockUpdate();
+}
+
+static void Bench_Report(const char *pcName, uint32_t u32Bytes)
+{
+    HOSTSIM_STAT_T sStat;
+    uint32_t i, u32Irq = 0UL;
+    double dSec;
+
+    HostSim_GetStat(&sStat);
+    for(i = 0UL; i < 32UL; i++)
+    {
+        u32Irq += sStat.au32IrqCnt[i];
+    }
+    dSec = (double)sStat.u64Cycle / (double)HostSim_GetHclkFreq();
+    printf("%-28s %7u bytes %10llu cycles %10.0f B/s %6llu acc %6llu dma %4u irq\n",
+           pcName, (unsigned)u32Bytes, (unsigned long long)sStat.u64Cycle,
+           (dSec > 0.0) ? ((double)u32Bytes / dSec) : 0.0,
+           (unsigned long long)sStat.u64Access, (unsigned long long)sStat.u64DmaBeat, (unsigned)u32Irq);
+}
+
+static void Bench_Uart(void)
+{
+    UART_Open(UART0, 115200);
+    HostSim_ClearStat();
+    UART_Write(UART0, s_au8Src, BENCH_UART_LEN);
+    UART_WAIT_TX_EMPTY(UART0);
+    Bench_Report("UART_Write 115200", BENCH_UART_LEN);
+
+    UART_Open(UART0, 921600);
+    HostSim_ClearStat();
+    UART_Write(UART0, s_au8Src, BENCH_UART_LEN);
+    UART_WAIT_TX_EMPTY(UART0);
+    Bench_Report("UART_Write 921600", BENCH_UART_LEN);
+    UART_Close(UART0);
+}
+
+static void Bench_Spi(void)
+{
+    uint32_t i;
+
+    SPI_Open(SPI0, SPI_MASTER, SPI_MODE_0, 8, 12000000);
+    HostSim_SpiSetSlave(NULL);
+    HostSim_ClearStat();
+    for(i = 0UL; i < BENCH_SPI_LEN; i++)
+    {
+        while(SPI_GET_TX_FIFO_FULL_FLAG(SPI0));
+        SPI_WRITE_TX(SPI0, s_au8Src[i]);
+    }
+    while(SPI_IS_BUSY(SPI0));
+    Bench_Report("SPI TX polled 12MHz", BENCH_SPI_LEN);
+
+    SPI_ClearRxFIFO(SPI0);
+    PDMA_Open(PDMA, 1UL << 2);
+    PDMA_SetTransferCnt(PDMA, 2, PDMA_WIDTH_8, BENCH_SPI_LEN);
+    PDMA_SetTransferAddr(PDMA, 2, (uint32_t)s_au8Src, PDMA_SAR_INC, (uint32_t)&SPI0->TX, PDMA_DAR_FIX);
+    PDMA_SetTransferMode(PDMA, 2, PDMA_SPI0_TX, FALSE, 0);
+    PDMA_SetBurstType(PDMA, 2, PDMA_REQ_SINGLE, 0);
+    PDMA_EnableInt(PDMA, 2, PDMA_INT_TRANS_DONE);
+    NVIC_EnableIRQ(PDMA_IRQn);
+    s_u32PdmaDone = 0UL;
+    HostSim_ClearStat();
+    SPI_TRIGGER_TX_PDMA(SPI0);
+    while((s_u32PdmaDone & PDMA_TDSTS_TDIF2_Msk) == 0UL)
+    {
+        __WFI();
+    }
+    while(SPI_IS_BUSY(SPI0));
+    Bench_Report("SPI TX PDMA 12MHz", BENCH_SPI_LEN);
+    SPI_DISABLE_TX_PDMA(SPI0);
+    PDMA_Close(PDMA);
+    SPI_Close(SPI0);
+}
+
+static void Bench_Pdma(void)
+{
+    PDMA_Open(PDMA, 1UL << 1);
+    PDMA_SetTransferCnt(PDMA, 1, PDMA_WIDTH_32, BENCH_PDMA_LEN / 4UL);
+    PDMA_SetTransferAddr(PDMA, 1, (uint32_t)s_au8Src, PDMA_SAR_INC, (uint32_t)s_au8Dst, PDMA_DAR_INC);
+    PDMA_SetTransferMode(PDMA, 1, PDMA_MEM, FALSE, 0);
+    PDMA_SetBurstType(PDMA, 1, PDMA_REQ_BURST, PDMA_BURST_4);
+    PDMA_EnableInt(PDMA, 1, PDMA_INT_TRANS_DONE);
+    NVIC_EnableIRQ(PDMA_IRQn);
+    s_u32PdmaDone = 0UL;
+    memset(s_au8Dst, 0, sizeof(s_au8Dst));
+    HostSim_ClearStat();
+    PDMA_Trigger(PDMA, 1);
+    while((s_u32PdmaDone & PDMA_TDSTS_TDIF1_Msk) == 0UL)
+    {
+        __WFI();
+    }
+    Bench_Report("PDMA memcpy 32-bit", BENCH_PDMA_LEN);
+    if(memcmp(s_au8Src, s_au8Dst, BENCH_PDMA_LEN) != 0)
+    {
+        printf("  PDMA data mismatch\n");
+    }
+    PDMA_Close(PDMA);
+}
+
+static void Bench_Fmc(void)
+{
+    uint32_t i, u32Sum;
+
+    SYS_UnlockReg();
+    FMC_Open();
+    FMC_ENABLE_AP_UPDATE();
+
+    HostSim_ClearStat();
+    FMC_Erase(BENCH_FMC_ADDR);
+    Bench_Report("FMC_Erase page", BENCH_FMC_LEN);
+
+    HostSim_ClearStat();
+    for(i = 0UL; i < BENCH_FMC_LEN; i += 4UL)
+    {
+        FMC_Write(BENCH_FMC_ADDR + i, *(uint32_t *)&s_au8Src[i]);
+    }
+    Bench_Report("FMC_Write", BENCH_FMC_LEN);
+
+    FMC_Erase(BENCH_FMC_ADDR);
+    HostSim_ClearStat();
+    for(i = 0UL; i < BENCH_FMC_LEN; i += FMC_MULTI_WORD_PROG_LEN)
+    {
+        FMC_WriteMultiple(BENCH_FMC_ADDR + i, (uint32_t *)&s_au8Src[i], FMC_MULTI_WORD_PROG_LEN);
+    }
+    Bench_Report("FMC_WriteMultiple", BENCH_FMC_LEN);
+
+    HostSim_ClearStat();
+    u32Sum = FMC_GetChkSum(BENCH_FMC_ADDR, BENCH_FMC_LEN);
+    Bench_Report("FMC_GetChkSum", BENCH_FMC_LEN);
+    printf("  checksum 0x%08X\n", (unsigned)u32Sum);
+
+    FMC_Erase(BENCH_FMC_ADDR);
+    HostSim_ClearStat();
+    i = (uint32_t)FMC_WriteVerify(BENCH_FMC_ADDR, (uint32_t *)s_au8Src, BENCH_FMC_LEN);
+    Bench_Report("FMC_WriteVerify", BENCH_FMC_LEN);
+    if((i != 0UL) || (FMC_GetChkSum(BENCH_FMC_ADDR, BENCH_FMC_LEN) != u32Sum))
+    {
+        printf("  FMC_WriteVerify failed\n");
+    }
+
+    /* Unaligned edges take single-word program and read back; a programmed area must fail */
+    FMC_Erase(BENCH_FMC_ADDR);
+    if((FMC_WriteVerify(BENCH_FMC_ADDR + 4UL, (uint32_t *)&s_au8Src[4], BENCH_FMC_LEN - 12UL) != 0) ||
+       (FMC_Read(BENCH_FMC_ADDR) != 0xFFFFFFFFUL) || (FMC_Read(BENCH_FMC_ADDR + BENCH_FMC_LEN - 8UL) != 0xFFFFFFFFUL) ||
+       (FMC_Read(BENCH_FMC_ADDR + BENCH_FMC_LEN - 12UL) != *(uint32_t *)&s_au8Src[BENCH_FMC_LEN - 12UL]))
+    {
+        printf("  FMC_WriteVerify unaligned failed\n");
+    }
+    if(FMC_WriteVerify(BENCH_FMC_ADDR, (uint32_t *)&s_au8Src[4], BENCH_FMC_LEN - 16UL) == 0)
+    {
+        printf("  FMC_WriteVerify missed a mismatch\n");
+    }
+
+    FMC_DISABLE_AP_UPDATE();
+    FMC_Close();
+}
+
+static void Bench_Crc(void)
+{
+    uint32_t i, u32Cpu, u32Dma;
+
+    CRC_Open(CRC_32, (CRC_WDATA_RVS | CRC_CHECKSUM_RVS | CRC_CHECKSUM_COM), 0xFFFFFFFF, CRC_WDATA_32);
+    HostSim_ClearStat();
+    for(i = 0UL; i < BENCH_CRC_LEN; i += 4UL)
+    {
+        CRC->DAT = *(uint32_t *)&s_au8Src[i];
+    }
+    u32Cpu = CRC_GetChecksum();
+    Bench_Report("CRC32 CPU write", BENCH_CRC_LEN);
+
+    CRC_Open(CRC_32, (CRC_WDATA_RVS | CRC_CHECKSUM_RVS | CRC_CHECKSUM_COM), 0xFFFFFFFF, CRC_WDATA_32);
+    PDMA_Open(PDMA, 1UL << 0);
+    PDMA_SetTransferCnt(PDMA, 0, PDMA_WIDTH_32, BENCH_CRC_LEN / 4UL);
+    PDMA_SetTransferAddr(PDMA, 0, (uint32_t)s_au8Src, PDMA_SAR_INC, (uint32_t)&CRC->DAT, PDMA_DAR_FIX);
+    PDMA_SetTransferMode(PDMA, 0, PDMA_MEM, FALSE, 0);
+    PDMA_SetBurstType(PDMA, 0, PDMA_REQ_BURST, PDMA_BURST_4);
+    PDMA_EnableInt(PDMA, 0, PDMA_INT_TRANS_DONE);
+    NVIC_EnableIRQ(PDMA_IRQn);
+    s_u32PdmaDone = 0UL;
+    HostSim_ClearStat();
+    PDMA_Trigger(PDMA, 0);
+    while((s_u32PdmaDone & PDMA_TDSTS_TDIF0_Msk) == 0UL)
+    {
+        __WFI();
+    }
+    u32Dma = CRC_GetChecksum();
+    Bench_Report("CRC32 PDMA", BENCH_CRC_LEN);
+    printf("  CPU 0x%08X PDMA 0x%08X\n", (unsigned)u32Cpu, (unsigned)u32Dma);
+    PDMA_Close(PDMA);
+}
+
+/* USBD_MemCopy before word access, kept as the reference */
+static void Bench_ByteCopy(uint8_t dest[], uint8_t src[], uint32_t size)
+{
+    uint32_t volatile i = 0UL;
+
+    while(size--)
+    {
+        dest[i] = src[i];
+        i++;
+    }
+}
+
+static uint64_t Bench_BulkOut(void (*pfnCopy)(uint8_t *, uint8_t *, uint32_t))
+{
+    HOSTSIM_STAT_T sStat;
+    uint32_t i;
+
+    /* Per packet driver work of a bulk OUT endpoint: drain the buffer, re-arm MXPLD */
+    HostSim_ClearStat();
+    for(i = 0UL; i < BENCH_USB_PKT; i++)
+    {
+        pfnCopy(&s_au8Dst[(i * BENCH_USB_LEN) % BENCH_PDMA_LEN], (uint8_t *)(USBD_BUF_BASE + 0x40UL), BENCH_USB_LEN);
+        USBD_SET_PAYLOAD_LEN(EP2, BENCH_USB_LEN);
+    }
+    HostSim_GetStat(&sStat);
+    return sStat.u64Cycle;
+}
+
+static void Bench_Usbd(void)
+{
+    uint64_t u64Byte, u64Word;
+    uint32_t i, u32Error = 0UL;
+
+    USBD->ATTR = 0x7D0UL;
+    HostSim_ClearStat();
+    Bench_ByteCopy((uint8_t *)(USBD_BUF_BASE + 0x40UL), s_au8Src, BENCH_USB_LEN);
+    Bench_Report("Byte copy to SRAM", BENCH_USB_LEN);
+
+    HostSim_ClearStat();
+    USBD_MemCopy((uint8_t *)(USBD_BUF_BASE + 0x40UL), s_au8Src, BENCH_USB_LEN);
+    Bench_Report("USBD_MemCopy to SRAM", BENCH_USB_LEN);
+
+    HostSim_ClearStat();
+    USBD_MemCopy(s_au8Dst, (uint8_t *)(USBD_BUF_BASE + 0x40UL), BENCH_USB_LEN);
+    Bench_Report("USBD_MemCopy from SRAM", BENCH_USB_LEN);
+    if(memcmp(s_au8Src, s_au8Dst, BENCH_USB_LEN) != 0)
+    {
+        u32Error++;
+    }
+
+    HostSim_ClearStat();
+    USBD_MemCopy((uint8_t *)(USBD_BUF_BASE + 0x41UL), &s_au8Src[1], BENCH_USB_LEN - 2UL);
+    Bench_Report("USBD_MemCopy odd aligned", BENCH_USB_LEN - 2UL);
+
+    HostSim_ClearStat();
+    USBD_MemCopy((uint8_t *)(USBD_BUF_BASE + 0x40UL), &s_au8Src[1], BENCH_USB_LEN);
+    Bench_Report("USBD_MemCopy misaligned", BENCH_USB_LEN);
+
+    /* Every head/tail length against the byte copy */
+    for(i = 0UL; i < 8UL * 3UL; i++)
+    {
+        memset(s_au8Dst, 0, 16UL);
+        USBD_MemCopy((uint8_t *)(USBD_BUF_BASE + 0x80UL), s_au8Src, 16UL);
+        USBD_MemCopy(&s_au8Dst[i % 4UL], (uint8_t *)(USBD_BUF_BASE + 0x80UL + (i / 4UL) % 4UL), i % 8UL + 1UL);
+        if((memcmp(&s_au8Dst[i % 4UL], &s_au8Src[(i / 4UL) % 4UL], i % 8UL + 1UL) != 0) ||
+                ((i % 4UL) && (s_au8Dst[0] != 0U)))
+        {
+            u32Error++;
+        }
+    }
+    if(u32Error)
+    {
+        printf("  USB SRAM data mismatch\n");
+    }
+
+    /* Full-speed bulk moves at most 19 x 64-byte packets per 1 ms frame */
+    u64Byte = Bench_BulkOut(Bench_ByteCopy);
+    u64Word = Bench_BulkOut(USBD_MemCopy);
+    printf("  FS bulk OUT, %u x %u-byte packets: byte copy %llu, word copy %llu cycles/packet\n",
+           (unsigned)BENCH_USB_PKT, (unsigned)BENCH_USB_LEN,
+           (unsigned long long)(u64Byte / BENCH_USB_PKT), (unsigned long long)(u64Word / BENCH_USB_PKT));
+    printf("  USB SRAM access share of HCLK at 1216000 B/s: byte copy %.1f%%, word copy %.1f%%\n",
+           (double)u64Byte / BENCH_USB_PKT * 19000.0 * 100.0 / HostSim_GetHclkFreq(),
+           (double)u64Word / BENCH_USB_PKT * 19000.0 * 100.0 / HostSim_GetHclkFreq());
+}
+
+int main(void)
+{
+    uint32_t i;
+
+    if(HostSim_Init(BENCH_HCLK) != 0)
+    {
+        printf("HostSim_Init failed\n");
+        return 1;
+    }
+
+    SYS_Init();
+
+    for(i = 0UL; i < BENCH_PDMA_LEN; i++)
+    {
+        s_au8Src[i] = (uint8_t)(i * 7UL + 3UL);
+    }
+
+    printf("\nStdDriver benchmark on HostSim, HCLK %u Hz\n", (unsigned)HostSim_GetHclkFreq());
+    Bench_Uart();
+    Bench_Spi();
+    Bench_Pdma();
+    Bench_Fmc();
+    Bench_Crc();
+    Bench_Usbd();
+
+    HostSim_Close();
+    return 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
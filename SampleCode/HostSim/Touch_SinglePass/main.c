@@ -0,0 +1,260 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Check the single scan touch sampling of the emWin port on the host
+ *           simulator.
+ * @note     TouchPanel.c and the touch callbacks of LCDConf.c are built
+ *           unchanged. An analog source stands in for the 4-wire panel: CH7
+ *           reads the X position while XR/XL are driven, CH4 the Y position
+ *           while YU/YD are driven, full scale when the pen is up or the drive
+ *           is wrong. The callbacks are called in the order GUI_TOUCH_Exec()
+ *           uses, one axis per 10 ms tick. Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NuMicro.h"
+#include "hostsim.h"
+#include "GUI.h"
+#include "GUIDRV_FlexColor.h"
+#include "TouchPanel.h"
+
+#define TEST_HCLK           48000000UL
+#define TICK_CYCLES         (TEST_HCLK / 100UL)     /* GUI_TOUCH_Exec() every 10 ms */
+#define PEN_UP_ADC          0xFFFUL
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* emWin stand-ins for LCDConf.c                                                                           */
+/*---------------------------------------------------------------------------------------------------------*/
+const GUI_DEVICE_API GUIDRV_FlexColor_API;
+const LCD_API_COLOR_CONV LCD_API_ColorConv_565;
+
+GUI_DEVICE *GUI_DEVICE_CreateAndLink(const GUI_DEVICE_API *pDeviceAPI, const LCD_API_COLOR_CONV *pColorConvAPI, U16 Flags, int LayerIndex)
+{
+    (void)pDeviceAPI;
+    (void)pColorConvAPI;
+    (void)Flags;
+    (void)LayerIndex;
+    return NULL;
+}
+
+void GUIDRV_FlexColor_Config(GUI_DEVICE *pDevice, CONFIG_FLEXCOLOR *pConfig)
+{
+    (void)pDevice;
+    (void)pConfig;
+}
+
+void GUIDRV_FlexColor_SetFunc(GUI_DEVICE *pDevice, GUI_PORT_API *pHW_API, void (*pfFunc)(GUI_DEVICE *), void (*pfMode)(GUI_DEVICE *))
+{
+    (void)pDevice;
+    (void)pHW_API;
+    (void)pfFunc;
+    (void)pfMode;
+}
+
+void GUIDRV_FlexColor_SetFunc66709(GUI_DEVICE *pDevice)
+{
+    (void)pDevice;
+}
+
+void GUIDRV_FlexColor_SetMode16bppC0B8(GUI_DEVICE *pDevice)
+{
+    (void)pDevice;
+}
+
+int LCD_SetSizeEx(int LayerIndex, int xSize, int ySize)
+{
+    (void)LayerIndex;
+    (void)xSize;
+    (void)ySize;
+    return 0;
+}
+
+int LCD_SetVSizeEx(int LayerIndex, int xSize, int ySize)
+{
+    (void)LayerIndex;
+    (void)xSize;
+    (void)ySize;
+    return 0;
+}
+
+int GUI_TOUCH_Calibrate(int Coord, int Log0, int Log1, int Phys0, int Phys1)
+{
+    (void)Coord;
+    (void)Log0;
+    (void)Log1;
+    (void)Phys0;
+    (void)Phys1;
+    return 0;
+}
+
+/* Identity calibration, the physical values reach the callbacks */
+int ts_phy2log(int *sumx, int *sumy)
+{
+    (void)sumx;
+    (void)sumy;
+    return 1;
+}
+
+void GUI_TOUCH_StoreStateEx(const GUI_PID_STATE *pState)
+{
+    (void)pState;
+}
+
+void GUI_X_Delay(int ms)
+{
+    HostSim_Delay((uint32_t)ms * (TEST_HCLK / 1000UL));
+}
+
+void PDMA_IRQHandler(void)
+{
+    PDMA_DispatchIRQ(PDMA);
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static volatile uint32_t s_u32PenDown;
+static volatile uint32_t s_u32PenX, s_u32PenY;
+static uint32_t s_u32BadDrive;
+static uint32_t s_u32Error = 0;
+
+/* 4-wire resistive panel on PB4 (XR), PB5 (YD), PB6 (XL), PB7 (YU) */
+static uint32_t Panel_Sample(uint32_t u32Ch, uint64_t u64Cycle)
+{
+    (void)u64Cycle;
+
+    if(u32Ch == 7UL)
+    {
+        if(!HostSim_GpioGetPin(1UL, 4UL) || HostSim_GpioGetPin(1UL, 6UL))
+        {
+            s_u32BadDrive++;
+            return PEN_UP_ADC;
+        }
+        return s_u32PenDown ? s_u32PenX : PEN_UP_ADC;
+    }
+    if(u32Ch == 4UL)
+    {
+        if(!HostSim_GpioGetPin(1UL, 7UL) || HostSim_GpioGetPin(1UL, 5UL))
+        {
+            s_u32BadDrive++;
+            return PEN_UP_ADC;
+        }
+        return s_u32PenDown ? s_u32PenY : PEN_UP_ADC;
+    }
+    return 0UL;
+}
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+
+    CLK_EnableXtalRC(CLK_PWRCTL_HIRCEN_Msk);
+    CLK_WaitClockReady(CLK_STATUS_HIRCSTB_Msk);
+    CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(1));
+    CLK->PCLKDIV = (CLK_PCLKDIV_APB0DIV_DIV1 | CLK_PCLKDIV_APB1DIV_DIV1);
+
+    SystemCoreClockUpdate();
+}
+
+static void Check(const char *pcName, uint32_t u32Pass)
+{
+    printf("%-40s %s\n", pcName, u32Pass ? "PASS" : "FAIL");
+    if(!u32Pass)
+    {
+        s_u32Error++;
+    }
+}
+
+/* GUI_TOUCH_Exec(): Y on one tick, X on the next; cycles spent in the callbacks are added to *pu64Busy */
+static void Touch_Exec(int *pi32X, int *pi32Y, uint64_t *pu64Busy)
+{
+    uint64_t u64Start;
+
+    u64Start = HostSim_GetCycle();
+    *pi32Y = GUI_TOUCH_X_MeasureY();
+    GUI_TOUCH_X_ActivateY();
+    *pu64Busy += HostSim_GetCycle() - u64Start;
+    HostSim_Delay(TICK_CYCLES);
+
+    u64Start = HostSim_GetCycle();
+    *pi32X = GUI_TOUCH_X_MeasureX();
+    GUI_TOUCH_X_ActivateX();
+    *pu64Busy += HostSim_GetCycle() - u64Start;
+    HostSim_Delay(TICK_CYCLES);
+}
+
+int main(void)
+{
+    uint64_t u64Busy = 0ULL, u64Conv, u64Start, u64Read;
+    uint32_t u32Pass, i;
+    int x, y;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        return 1;
+    }
+
+    SYS_Init();
+    HostSim_AdcSetSource(Panel_Sample);
+    Init_TouchPanel();
+
+    /* Pen up */
+    u32Pass = 1UL;
+    for(i = 0UL; i < 10UL; i++)
+    {
+        Touch_Exec(&x, &y, &u64Busy);
+        u32Pass &= (x == -1) && (y == -1);
+    }
+    Check("Pen up reports -1 on both axes", u32Pass);
+
+    /* Pen down, then moving: each pair is one poll old, X and Y from the same scan */
+    u64Conv = HostSim_AdcGetConvCount(NULL);
+    u64Busy = 0ULL;
+    u32Pass = 1UL;
+    s_u32PenX = 1000UL;
+    s_u32PenY = 2000UL;
+    s_u32PenDown = 1UL;
+    for(i = 0UL; i < 100UL; i++)
+    {
+        Touch_Exec(&x, &y, &u64Busy);
+        if(i == 0UL)
+        {
+            u32Pass &= (x == -1) && (y == -1);
+        }
+        else
+        {
+            u32Pass &= (x == (int)s_u32PenX - 3) && (y == (int)s_u32PenY - 3);
+        }
+        s_u32PenX += 3UL;
+        s_u32PenY += 3UL;
+    }
+    u64Conv = HostSim_AdcGetConvCount(NULL) - u64Conv;
+    Check("Pairs follow the pen one poll behind", u32Pass);
+    Check("One conversion per axis per pair", u64Conv == 200ULL);
+    Check("Panel drive matches each channel", s_u32BadDrive == 0UL);
+    printf("  100 pairs: %llu conversions, %llu cycles in the callbacks (%.1f per pair)\n",
+           (unsigned long long)u64Conv, (unsigned long long)u64Busy, (double)u64Busy / 100.0);
+
+    /* The callbacks never wait for the ADC: well under the time of one conversion */
+    Check("Callbacks never wait for a conversion", u64Busy < 100ULL * 272ULL);
+
+    /* Thread context readers such as the calibration get a fresh pair */
+    s_u32PenX = 1234UL;
+    s_u32PenY = 2345UL;
+    u64Start = HostSim_GetCycle();
+    u32Pass = (Read_TouchPanel(&x, &y) == 1) && (x == 1234) && (y == 2345);
+    u64Read = HostSim_GetCycle() - u64Start;
+    s_u32PenDown = 0UL;
+    u32Pass &= (Read_TouchPanel(&x, &y) == 0);
+    Check("Read_TouchPanel sleeps for a fresh pair", u32Pass);
+    printf("  Read_TouchPanel: %llu cycles (%.1f us) for one X/Y scan\n",
+           (unsigned long long)u64Read, (double)u64Read * 1e6 / TEST_HCLK);
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
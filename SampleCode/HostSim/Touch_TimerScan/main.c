@@ -0,0 +1,374 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Check the timer driven background touch scan of the emWin port on
+ *           the host simulator.
+ * @note     TouchPanel.c, ts_filter.c and the touch part of LCDConf.c are built
+ *           unchanged. Timer1 triggers the ADC, the filtered pen events are
+ *           passed to emWin by Store_TouchEvents() from a 1 kHz Timer0 tick
+ *           every 10 ms as in the emWin demos, while the main loop stands for
+ *           the GUI drawing frames. An analog source stands in for the 4-wire
+ *           panel as in Touch_SinglePass and can add single sample spikes.
+ *           Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NuMicro.h"
+#include "hostsim.h"
+#include "GUI.h"
+#include "GUIDRV_FlexColor.h"
+#include "TouchPanel.h"
+#include "tslib.h"
+
+#define TEST_HCLK           48000000UL
+#define MS_CYCLES           (TEST_HCLK / 1000UL)
+#define FRAME_MS            30UL        /* GUI frame, drawn without touching the panel */
+#define PEN_UP_ADC          0xFFFUL
+#define SPIKE_ADC           300UL       /* Added to every 4th X conversion while spikes are on */
+#define EVENT_NUM           256UL
+
+extern void Store_TouchEvents(void);
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* emWin stand-ins for LCDConf.c                                                                           */
+/*---------------------------------------------------------------------------------------------------------*/
+const GUI_DEVICE_API GUIDRV_FlexColor_API;
+const LCD_API_COLOR_CONV LCD_API_ColorConv_565;
+
+GUI_DEVICE *GUI_DEVICE_CreateAndLink(const GUI_DEVICE_API *pDeviceAPI, const LCD_API_COLOR_CONV *pColorConvAPI, U16 Flags, int LayerIndex)
+{
+    (void)pDeviceAPI;
+    (void)pColorConvAPI;
+    (void)Flags;
+    (void)LayerIndex;
+    return NULL;
+}
+
+void GUIDRV_FlexColor_Config(GUI_DEVICE *pDevice, CONFIG_FLEXCOLOR *pConfig)
+{
+    (void)pDevice;
+    (void)pConfig;
+}
+
+void GUIDRV_FlexColor_SetFunc(GUI_DEVICE *pDevice, GUI_PORT_API *pHW_API, void (*pfFunc)(GUI_DEVICE *), void (*pfMode)(GUI_DEVICE *))
+{
+    (void)pDevice;
+    (void)pHW_API;
+    (void)pfFunc;
+    (void)pfMode;
+}
+
+void GUIDRV_FlexColor_SetFunc66709(GUI_DEVICE *pDevice)
+{
+    (void)pDevice;
+}
+
+void GUIDRV_FlexColor_SetMode16bppC0B8(GUI_DEVICE *pDevice)
+{
+    (void)pDevice;
+}
+
+int LCD_SetSizeEx(int LayerIndex, int xSize, int ySize)
+{
+    (void)LayerIndex;
+    (void)xSize;
+    (void)ySize;
+    return 0;
+}
+
+int LCD_SetVSizeEx(int LayerIndex, int xSize, int ySize)
+{
+    (void)LayerIndex;
+    (void)xSize;
+    (void)ySize;
+    return 0;
+}
+
+int GUI_TOUCH_Calibrate(int Coord, int Log0, int Log1, int Phys0, int Phys1)
+{
+    (void)Coord;
+    (void)Log0;
+    (void)Log1;
+    (void)Phys0;
+    (void)Phys1;
+    return 0;
+}
+
+/* Identity calibration, the physical values reach emWin */
+int ts_phy2log(int *sumx, int *sumy)
+{
+    (void)sumx;
+    (void)sumy;
+    return 1;
+}
+
+void GUI_X_Delay(int ms)
+{
+    HostSim_Delay((uint32_t)ms * MS_CYCLES);
+}
+
+void PDMA_IRQHandler(void)
+{
+    PDMA_DispatchIRQ(PDMA);
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    int32_t  i32X, i32Y;
+    uint32_t u32Pressed;
+    uint64_t u64Cycle;
+} EVENT_T;
+
+static EVENT_T s_asEvent[EVENT_NUM];
+static volatile uint32_t s_u32EventCnt;
+static volatile uint32_t s_u32PenDown, s_u32Spike;
+static volatile uint32_t s_u32PenX, s_u32PenY;
+static volatile uint32_t s_u32TouchOn;
+static uint32_t s_u32XConv, s_u32BadDrive;
+static uint64_t s_u64TickBusy;
+static uint32_t s_u32Error = 0;
+
+void GUI_TOUCH_StoreStateEx(const GUI_PID_STATE *pState)
+{
+    if(s_u32EventCnt < EVENT_NUM)
+    {
+        s_asEvent[s_u32EventCnt].i32X = pState->x;
+        s_asEvent[s_u32EventCnt].i32Y = pState->y;
+        s_asEvent[s_u32EventCnt].u32Pressed = pState->Pressed;
+        s_asEvent[s_u32EventCnt].u64Cycle = HostSim_GetCycle();
+    }
+    s_u32EventCnt++;
+}
+
+/* OS tick of the emWin demos: the touch events go to emWin every 10 ms */
+void TMR0_IRQHandler(void)
+{
+    static uint32_t u32Ms;
+    uint64_t u64Start;
+
+    if((++u32Ms % 10UL) == 0UL && s_u32TouchOn)
+    {
+        u64Start = HostSim_GetCycle();
+        Store_TouchEvents();
+        s_u64TickBusy += HostSim_GetCycle() - u64Start;
+    }
+    TIMER_ClearIntFlag(TIMER0);
+}
+
+/* 4-wire resistive panel on PB4 (XR), PB5 (YD), PB6 (XL), PB7 (YU) */
+static uint32_t Panel_Sample(uint32_t u32Ch, uint64_t u64Cycle)
+{
+    (void)u64Cycle;
+
+    if(u32Ch == 7UL)
+    {
+        if(!HostSim_GpioGetPin(1UL, 4UL) || HostSim_GpioGetPin(1UL, 6UL))
+        {
+            s_u32BadDrive++;
+            return PEN_UP_ADC;
+        }
+        if(!s_u32PenDown)
+        {
+            return PEN_UP_ADC;
+        }
+        return (s_u32Spike && ((++s_u32XConv % 4UL) == 0UL)) ? (s_u32PenX + SPIKE_ADC) : s_u32PenX;
+    }
+    if(u32Ch == 4UL)
+    {
+        if(!HostSim_GpioGetPin(1UL, 7UL) || HostSim_GpioGetPin(1UL, 5UL))
+        {
+            s_u32BadDrive++;
+            return PEN_UP_ADC;
+        }
+        return s_u32PenDown ? s_u32PenY : PEN_UP_ADC;
+    }
+    return 0UL;
+}
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+
+    CLK_EnableXtalRC(CLK_PWRCTL_HIRCEN_Msk);
+    CLK_WaitClockReady(CLK_STATUS_HIRCSTB_Msk);
+    CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(1));
+    CLK->PCLKDIV = (CLK_PCLKDIV_APB0DIV_DIV1 | CLK_PCLKDIV_APB1DIV_DIV1);
+
+    CLK_EnableModuleClock(TMR0_MODULE);
+    CLK_SetModuleClock(TMR0_MODULE, CLK_CLKSEL1_TMR0SEL_HIRC, 0);
+
+    SystemCoreClockUpdate();
+}
+
+static void Check(const char *pcName, uint32_t u32Pass)
+{
+    printf("%-40s %s\n", pcName, u32Pass ? "PASS" : "FAIL");
+    if(!u32Pass)
+    {
+        s_u32Error++;
+    }
+}
+
+/* GUI frames for u32Ms: drawing only, the touch scan runs on its own */
+static void Gui_Run(uint32_t u32Ms)
+{
+    while(u32Ms >= FRAME_MS)
+    {
+        HostSim_Delay(FRAME_MS * MS_CYCLES);
+        u32Ms -= FRAME_MS;
+    }
+    HostSim_Delay(u32Ms * MS_CYCLES);
+}
+
+int main(void)
+{
+    uint64_t u64Conv, u64Timeout, u64Start, u64Lat, u64LatMin = UINT64_MAX, u64LatMax = 0ULL;
+    uint32_t u32Pass, u32First, i;
+    int x, y;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        return 1;
+    }
+
+    SYS_Init();
+    HostSim_AdcSetSource(Panel_Sample);
+
+    TIMER_Open(TIMER0, TIMER_PERIODIC_MODE, 1000);
+    TIMER_EnableInt(TIMER0);
+    NVIC_SetPriority(TMR0_IRQn, 1);
+    NVIC_EnableIRQ(TMR0_IRQn);
+    TIMER_Start(TIMER0);
+
+    Init_TouchPanel();
+    u32Pass = Start_TouchScan();
+    s_u32TouchOn = 1UL;
+
+    /* Pen up: the scan runs at the timer rate and nothing reaches emWin */
+    u64Conv = HostSim_AdcGetConvCount(NULL);
+    u64Timeout = HostSim_TimerGetTimeoutCount(1UL);
+    Gui_Run(1000UL);
+    u64Conv = HostSim_AdcGetConvCount(NULL) - u64Conv;
+    u64Timeout = HostSim_TimerGetTimeoutCount(1UL) - u64Timeout;
+    printf("  1 s: %llu timer triggers, %llu conversions\n", (unsigned long long)u64Timeout, (unsigned long long)u64Conv);
+    Check("Timer triggers one conversion each", u32Pass && (u64Timeout == 400ULL) && (u64Conv == u64Timeout));
+    Check("Pen up sends no events", s_u32EventCnt == 0UL);
+
+    /* A contact shorter than the debounce is dropped */
+    s_u32PenX = 1000UL;
+    s_u32PenY = 2000UL;
+    for(i = 0UL; i < 20UL; i++)
+    {
+        s_u32PenDown = 1UL;
+        Gui_Run(7UL);
+        s_u32PenDown = 0UL;
+        Gui_Run(23UL);
+    }
+    Check("Bounces shorter than the debounce", s_u32EventCnt == 0UL);
+
+    /* Taps at every phase of the scan: one press and one release each, latency bounded */
+    u32Pass = 1UL;
+    for(i = 0UL; i < 20UL; i++)
+    {
+        u32First = s_u32EventCnt;
+        HostSim_Delay((i * 7UL % 10UL) * MS_CYCLES / 2UL + i * 1000UL);
+        s_u32PenX = 1000UL + i * 10UL;
+        s_u32PenY = 2000UL - i * 10UL;
+        s_u32PenDown = 1UL;
+        u64Start = HostSim_GetCycle();
+        Gui_Run(100UL);
+        s_u32PenDown = 0UL;
+        Gui_Run(100UL);
+
+        u32Pass &= (s_u32EventCnt == u32First + 2UL);
+        u32Pass &= s_asEvent[u32First].u32Pressed && !s_asEvent[u32First + 1UL].u32Pressed;
+        u32Pass &= (s_asEvent[u32First].i32X == (int32_t)s_u32PenX) && (s_asEvent[u32First].i32Y == (int32_t)s_u32PenY);
+        u32Pass &= (s_asEvent[u32First + 1UL].i32X == (int32_t)s_u32PenX) && (s_asEvent[u32First + 1UL].i32Y == (int32_t)s_u32PenY);
+        u64Lat = s_asEvent[u32First].u64Cycle - u64Start;
+        u64LatMin = (u64Lat < u64LatMin) ? u64Lat : u64LatMin;
+        u64LatMax = (u64Lat > u64LatMax) ? u64Lat : u64LatMax;
+    }
+    printf("  pen down to emWin: %.1f ~ %.1f ms\n", (double)u64LatMin / MS_CYCLES, (double)u64LatMax / MS_CYCLES);
+    Check("One press and one release per tap", u32Pass);
+    Check("Press latency within 3 pairs + 2 ticks", u64LatMax <= 35ULL * MS_CYCLES);
+
+    /* Pen held still with spikes on X: the median keeps them out, no repeated events */
+    u32First = s_u32EventCnt;
+    s_u32PenX = 1500UL;
+    s_u32PenY = 1500UL;
+    s_u32Spike = 1UL;
+    s_u32PenDown = 1UL;
+    Gui_Run(500UL);
+    s_u32PenDown = 0UL;
+    Gui_Run(100UL);
+    s_u32Spike = 0UL;
+    Check("Median filters single spikes", (s_u32EventCnt == u32First + 2UL) &&
+          (s_asEvent[u32First].i32X == 1500) && (s_asEvent[u32First + 1UL].i32X == 1500));
+
+    /* Pen moving: events follow, the GUI side only copies events */
+    u32First = s_u32EventCnt;
+    s_u64TickBusy = 0ULL;
+    s_u32PenX = 500UL;
+    s_u32PenY = 500UL;
+    s_u32PenDown = 1UL;
+    for(i = 0UL; i < 100UL; i++)
+    {
+        Gui_Run(5UL);
+        s_u32PenX += 10UL;
+        s_u32PenY += 5UL;
+    }
+    s_u32PenDown = 0UL;
+    Gui_Run(100UL);
+    u32Pass = (s_u32EventCnt > u32First + 50UL) && !s_asEvent[s_u32EventCnt - 1UL].u32Pressed;
+    for(i = u32First + 1UL; i < s_u32EventCnt - 1UL; i++)
+    {
+        u32Pass &= s_asEvent[i].u32Pressed && (s_asEvent[i].i32X > s_asEvent[i - 1UL].i32X);
+    }
+    u32Pass &= (s_asEvent[s_u32EventCnt - 1UL].i32X >= (int32_t)s_u32PenX - 30);
+    printf("  moving pen: %lu events, %llu cycles in Store_TouchEvents()\n",
+           (unsigned long)(s_u32EventCnt - u32First), (unsigned long long)s_u64TickBusy);
+    Check("Moves are followed", u32Pass);
+    Check("emWin side never touches the ADC", s_u64TickBusy == 0ULL);
+    Check("Panel drive matches each channel", s_u32BadDrive == 0UL);
+
+    /* emWin not taking events: the queue overflows, the release still arrives */
+    s_u32TouchOn = 0UL;
+    u32First = s_u32EventCnt;
+    s_u32PenDown = 1UL;
+    for(i = 0UL; i < 60UL; i++)
+    {
+        Gui_Run(5UL);
+        s_u32PenX -= 10UL;
+    }
+    s_u32PenDown = 0UL;
+    Gui_Run(100UL);
+    s_u32TouchOn = 1UL;
+    Gui_Run(20UL);
+    /* At most the queue and the sample kept back from it */
+    Check("Full queue keeps the last pen state", (s_u32EventCnt > u32First) && (s_u32EventCnt <= u32First + 17UL) &&
+          !s_asEvent[s_u32EventCnt - 1UL].u32Pressed && (s_asEvent[s_u32EventCnt - 1UL].i32X <= (int32_t)s_u32PenX + 30));
+
+    /* The raw readers keep working during the scan and after it stops */
+    s_u32PenX = 1234UL;
+    s_u32PenY = 2345UL;
+    s_u32PenDown = 1UL;
+    u32Pass = (Read_TouchPanel(&x, &y) == 1) && (x == 1234) && (y == 2345);
+    Stop_TouchScan();
+    u64Conv = HostSim_AdcGetConvCount(NULL);
+    Gui_Run(100UL);
+    u32Pass &= (HostSim_AdcGetConvCount(NULL) == u64Conv);
+    s_u32PenX = 1111UL;
+    u32Pass &= (Read_TouchPanel(&x, &y) == 1) && (x == 1111) && (y == 2345);
+    Check("Raw reads during and after the scan", u32Pass);
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,178 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Exercise the ring-buffered UART driver on the host simulator.
+ * @note     UART0 runs in loopback. Receive data goes through a PDMA
+ *           scatter-gather ring with the request time-out as idle flush;
+ *           transmit data is drained by the THRE interrupt. A stream many times
+ *           the ring size is echoed while the main loop is kept busy, then a
+ *           short burst that never fills a segment must be reported by the
+ *           time-out. Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NuMicro.h"
+#include "hostsim.h"
+
+#define TEST_HCLK           48000000UL
+#define TEST_BAUD           921600UL
+#define RX_RING_SIZE        256UL
+#define TX_RING_SIZE        128UL
+#define STREAM_LEN          8192UL
+#define BURST_LEN           10UL
+#define IDLE_TOC            8UL         /* 8 x 256 HCLK, about four characters at TEST_BAUD */
+#define BUSY_CYCLES         2000UL      /* Simulated main loop work between polls */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static DSCT_T s_asRxDesc[UART_BUF_RX_SEG] __attribute__((aligned(16)));
+static uint8_t s_au8RxRing[RX_RING_SIZE] __attribute__((aligned(4)));
+static uint8_t s_au8TxRing[TX_RING_SIZE];
+static uint8_t s_au8Tx[STREAM_LEN];
+static uint8_t s_au8Got[STREAM_LEN];
+static UART_BUF_T s_sBuf;
+static volatile uint32_t s_u32Notify = 0;
+static uint32_t s_u32Error = 0;
+
+void PDMA_IRQHandler(void)
+{
+    PDMA_DispatchIRQ(PDMA);
+}
+
+void UART02_IRQHandler(void)
+{
+    UART_BufIRQHandler(UART0, &s_sBuf);
+}
+
+static void Rx_Notify(void *pvUserData)
+{
+    (void)pvUserData;
+    s_u32Notify++;
+}
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+
+    CLK_EnableXtalRC(CLK_PWRCTL_HIRCEN_Msk);
+    CLK_WaitClockReady(CLK_STATUS_HIRCSTB_Msk);
+    CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(1));
+    CLK->PCLKDIV = (CLK_PCLKDIV_APB0DIV_DIV1 | CLK_PCLKDIV_APB1DIV_DIV1);
+
+    CLK_EnableModuleClock(UART0_MODULE);
+    CLK_SetModuleClock(UART0_MODULE, CLK_CLKSEL1_UART0SEL_HIRC, CLK_CLKDIV0_UART0(1));
+    CLK_EnableModuleClock(PDMA_MODULE);
+
+    SystemCoreClockUpdate();
+}
+
+static void Check(const char *pcName, uint32_t u32Pass)
+{
+    printf("%-40s %s\n", pcName, u32Pass ? "PASS" : "FAIL");
+    if(!u32Pass)
+    {
+        s_u32Error++;
+    }
+}
+
+int main(void)
+{
+    uint32_t u32Sent = 0, u32Got = 0, u32Loop = 0, u32Notify;
+    uint64_t u64Start;
+    int32_t i32Ch;
+    uint32_t i;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        printf("HostSim_Init failed\n");
+        return 1;
+    }
+
+    SYS_Init();
+
+    for(i = 0UL; i < STREAM_LEN; i++)
+    {
+        s_au8Tx[i] = (uint8_t)((i * 13UL) ^ (i >> 8));
+    }
+
+    UART_Open(UART0, TEST_BAUD);
+    HostSim_UartSetLoopback(0, 1);
+    PDMA->SCATBA = (uint32_t)s_asRxDesc & PDMA_SCATBA_SCATBA_Msk;
+
+    s_sBuf.pu8RxBuf = s_au8RxRing;
+    s_sBuf.u32RxSize = RX_RING_SIZE;
+    s_sBuf.pu8TxBuf = s_au8TxRing;
+    s_sBuf.u32TxSize = TX_RING_SIZE;
+    s_sBuf.psRxDesc = s_asRxDesc;
+    s_sBuf.pfnRxNotify = Rx_Notify;
+    s_sBuf.pvUserData = NULL;
+
+    i32Ch = UART_BufOpen(UART0, &s_sBuf, IDLE_TOC);
+    if(i32Ch < 0)
+    {
+        printf("UART_BufOpen failed %d\n", (int)i32Ch);
+        return 1;
+    }
+    NVIC_EnableIRQ(PDMA_IRQn);
+    NVIC_EnableIRQ(UART02_IRQn);
+
+    printf("\nUART ring-buffered driver on HostSim, PDMA CH%d\n", (int)i32Ch);
+
+    /* Stream: queue and collect without ever blocking, with work in between */
+    u64Start = HostSim_GetCycle();
+    while((u32Got < STREAM_LEN) && (u32Loop < 1000000UL))
+    {
+        u32Sent += UART_BufWrite(UART0, &s_sBuf, &s_au8Tx[u32Sent], STREAM_LEN - u32Sent);
+        u32Got += UART_BufRead(UART0, &s_sBuf, &s_au8Got[u32Got], STREAM_LEN - u32Got);
+        HostSim_Delay(BUSY_CYCLES);
+        u32Loop++;
+    }
+
+    printf("%u bytes in %.2f ms, %u polls, %u lost\n", (unsigned)u32Got,
+           (double)(HostSim_GetCycle() - u64Start) * 1000.0 / TEST_HCLK, (unsigned)u32Loop, (unsigned)s_sBuf.u32RxLost);
+    Check("Echo stream through both rings", (u32Got == STREAM_LEN) && (s_sBuf.u32RxLost == 0UL) &&
+          (memcmp(s_au8Tx, s_au8Got, STREAM_LEN) == 0));
+
+    /* Burst shorter than a segment: only the idle time-out can report it */
+    HostSim_Delay(100000UL);
+    u32Notify = s_u32Notify;
+    UART_BufWrite(UART0, &s_sBuf, s_au8Tx, BURST_LEN);
+    for(i = 0UL; (i < 1000UL) && (s_u32Notify == u32Notify); i++)
+    {
+        __WFI();
+    }
+    Check("Idle time-out flushes partial segment", (s_u32Notify != u32Notify) &&
+          (UART_BufGetRxCount(UART0, &s_sBuf) == BURST_LEN));
+    u32Got = UART_BufRead(UART0, &s_sBuf, s_au8Got, STREAM_LEN);
+    Check("Partial segment data", (u32Got == BURST_LEN) && (memcmp(s_au8Tx, s_au8Got, BURST_LEN) == 0));
+
+    /* Idle line: time-out keeps firing but must not notify again */
+    u32Notify = s_u32Notify;
+    HostSim_Delay(200000UL);
+    Check("No notification while idle", s_u32Notify == u32Notify);
+
+    /* Consumer asleep for more than a ring: oldest data is dropped and counted */
+    UART_BufWrite(UART0, &s_sBuf, s_au8Tx, TX_RING_SIZE);
+    HostSim_Delay(TEST_HCLK / TEST_BAUD * 10UL * (TX_RING_SIZE + 8UL));
+    UART_BufWrite(UART0, &s_sBuf, &s_au8Tx[TX_RING_SIZE], TX_RING_SIZE);
+    HostSim_Delay(TEST_HCLK / TEST_BAUD * 10UL * (TX_RING_SIZE + 8UL));
+    UART_BufWrite(UART0, &s_sBuf, &s_au8Tx[TX_RING_SIZE * 2UL], TX_RING_SIZE);
+    HostSim_Delay(TEST_HCLK / TEST_BAUD * 10UL * (TX_RING_SIZE + 8UL));
+    u32Got = UART_BufRead(UART0, &s_sBuf, s_au8Got, STREAM_LEN);
+    Check("Overrun keeps newest ring of data", (u32Got == RX_RING_SIZE) &&
+          (s_sBuf.u32RxLost == TX_RING_SIZE * 3UL - RX_RING_SIZE) &&
+          (memcmp(&s_au8Tx[TX_RING_SIZE * 3UL - RX_RING_SIZE], s_au8Got, RX_RING_SIZE) == 0));
+
+    UART_BufClose(UART0, &s_sBuf);
+    HostSim_UartSetLoopback(0, 0);
+    UART_Close(UART0);
+
+    printf("%s\n", s_u32Error ? "FAIL" : "PASS");
+    HostSim_Close();
+    return s_u32Error ? 1 : 0;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
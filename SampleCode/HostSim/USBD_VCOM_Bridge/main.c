@@ -0,0 +1,155 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Drive the USBD_VCOM_SerialEmulator bridge from a simulated USB host.
+ * @note     vcom_serial.c and descriptors.c of the StdDriver sample are built
+ *           unchanged. The host sets 3 Mbps line coding, then streams bulk OUT
+ *           data that UART0 loops back to bulk IN, and checks the data and the
+ *           NAK count. Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NuMicro.h"
+#include "hostsim.h"
+#include "vcom_serial.h"
+
+#define TEST_HCLK           48000000UL
+#define TEST_BAUD           3000000UL
+#define STREAM_LEN          (32UL * 1024UL)
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Global variables                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+STR_VCOM_LINE_CODING gLineCoding = {115200, 0, 0, 8};
+uint16_t gCtrlSignal = 0;
+
+static uint8_t s_au8Tx[STREAM_LEN];
+static uint8_t s_au8Got[STREAM_LEN];
+
+void PDMA_IRQHandler(void)
+{
+    PDMA_DispatchIRQ(PDMA);
+}
+
+void SYS_Init(void)
+{
+    SYS_UnlockReg();
+
+    CLK_EnableXtalRC(CLK_PWRCTL_HIRCEN_Msk);
+    CLK_WaitClockReady(CLK_STATUS_HIRCSTB_Msk);
+    CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(1));
+    CLK->PCLKDIV = (CLK_PCLKDIV_APB0DIV_DIV1 | CLK_PCLKDIV_APB1DIV_DIV1);
+
+    CLK_SetModuleClock(UART0_MODULE, CLK_CLKSEL1_UART0SEL_HIRC, CLK_CLKDIV0_UART0(1));
+    CLK_EnableModuleClock(UART0_MODULE);
+    CLK_SetModuleClock(USBD_MODULE, CLK_CLKSEL0_USBDSEL_HIRC, CLK_CLKDIV0_USB(1));
+    CLK_EnableModuleClock(USBD_MODULE);
+    CLK_EnableModuleClock(PDMA_MODULE);
+
+    SystemCoreClockUpdate();
+}
+
+static int32_t Host_SetLineCoding(uint32_t u32Baud)
+{
+    const uint8_t au8Setup[8] = {0x21, SET_LINE_CODE, 0, 0, 0, 0, 7, 0};
+    uint8_t au8Line[7] = {0, 0, 0, 0, 0, 0, 8};
+
+    au8Line[0] = (uint8_t)u32Baud;
+    au8Line[1] = (uint8_t)(u32Baud >> 8);
+    au8Line[2] = (uint8_t)(u32Baud >> 16);
+    au8Line[3] = (uint8_t)(u32Baud >> 24);
+
+    if(HostSim_UsbdSetup(au8Setup) != 0)
+        return -1;
+    if(HostSim_UsbdOut(0, au8Line, sizeof(au8Line)) != (int32_t)sizeof(au8Line))
+        return -1;
+
+    /* Status stage */
+    return (HostSim_UsbdIn(0, au8Line, 0) == 0) ? 0 : -1;
+}
+
+int main(void)
+{
+    uint32_t u32Sent = 0, u32Got = 0, u32OutNak = 0, u32InNak = 0, u32InPkt = 0, u32Len, i;
+    uint64_t u64Start, u64Cycle;
+    int32_t i32Ret;
+
+    if(HostSim_Init(TEST_HCLK) != 0)
+    {
+        printf("HostSim_Init failed\n");
+        return 1;
+    }
+
+    SYS_Init();
+    UART_Open(UART0, 115200);
+    HostSim_UartSetLoopback(0, 1);
+
+    for(i = 0UL; i < STREAM_LEN; i++)
+    {
+        s_au8Tx[i] = (uint8_t)((i * 29UL) ^ (i >> 9));
+    }
+
+    USBD_Open(&gsInfo, VCOM_ClassRequest, NULL);
+    USBD_Start();
+    NVIC_EnableIRQ(USBD_IRQn);
+    NVIC_EnableIRQ(PDMA_IRQn);
+    HostSim_UsbdAttach(1);
+    HostSim_UsbdBusReset();
+    VCOM_Init();
+
+    if(Host_SetLineCoding(TEST_BAUD) != 0)
+    {
+        printf("SET_LINE_CODE failed\n");
+        return 1;
+    }
+
+    printf("\nUSB VCOM bridge on HostSim, UART0 %u bps loopback\n", (unsigned)gLineCoding.u32DTERate);
+
+    /* Host keeps both pipes busy; the device main loop runs between transactions */
+    u64Start = HostSim_GetCycle();
+    while((u32Got < STREAM_LEN) && ((HostSim_GetCycle() - u64Start) < (uint64_t)TEST_HCLK))
+    {
+        if(u32Sent < STREAM_LEN)
+        {
+            u32Len = STREAM_LEN - u32Sent;
+            i32Ret = HostSim_UsbdOut(BULK_OUT_EP_NUM, &s_au8Tx[u32Sent], (u32Len > EP3_MAX_PKT_SIZE) ? EP3_MAX_PKT_SIZE : u32Len);
+            if(i32Ret > 0)
+                u32Sent += (uint32_t)i32Ret;
+            else
+                u32OutNak++;
+        }
+
+        i32Ret = HostSim_UsbdIn(BULK_IN_EP_NUM, &s_au8Got[u32Got], STREAM_LEN - u32Got);
+        if(i32Ret > 0)
+        {
+            u32Got += (uint32_t)i32Ret;
+            u32InPkt++;
+        }
+        else if(i32Ret == HOSTSIM_USB_NAK)
+        {
+            u32InNak++;
+        }
+
+        VCOM_TransferData();
+    }
+    u64Cycle = HostSim_GetCycle() - u64Start;
+
+    printf("%u bytes in %.2f ms: %.0f B/s, UART line rate %.0f B/s\n", (unsigned)u32Got,
+           (double)u64Cycle * 1000.0 / TEST_HCLK, (double)u32Got * TEST_HCLK / (double)u64Cycle, TEST_BAUD / 10.0);
+    printf("OUT %u packets %u NAK, IN %u packets %u NAK\n", (unsigned)((STREAM_LEN + EP3_MAX_PKT_SIZE - 1UL) / EP3_MAX_PKT_SIZE),
+           (unsigned)u32OutNak, (unsigned)u32InPkt, (unsigned)u32InNak);
+
+    i = (u32Got == STREAM_LEN) && (memcmp(s_au8Tx, s_au8Got, STREAM_LEN) == 0) &&
+        ((double)u32Got * TEST_HCLK / (double)u64Cycle > TEST_BAUD / 10.0 * 0.95);
+
+    HostSim_UsbdAttach(0);
+    HostSim_UartSetLoopback(0, 0);
+
+    printf("%s\n", i ? "PASS" : "FAIL");
+    HostSim_Close();
+    return i ? 0 : 1;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,263 @@
+/***************************************************************************//**
+ * @file     fmc_user.c
+ * @brief    M031 series FMC driver source file
+ * @version  2.0.0
+ *
+ * @copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include "fmc_user.h"
+
+#if 0
+#define ISPCTL      ISPCON
+#define ISPADDR     ISPADR
+#define FMC_ISPCTL_ISPFF_Msk        FMC_ISPCON_ISPFF_Msk
+#endif
+
+/* Multi-word program from u32Addr (16-byte aligned) towards addr_end, staying inside one
+   FMC_MULTI_WORD_PROG_LEN row. A burst that runs dry ends early, e.g. when the CPU is
+   slowed by flash wait states. Every word before the first pair MPSTS still holds is
+   programmed; the address to continue from is returned. */
+static uint32_t FMC_MultiProg(uint32_t u32Addr, uint32_t addr_end, uint32_t *data)
+{
+    uint32_t i, u32Words, u32Sts;
+
+    u32Words = FMC_MULTI_WORD_PROG_LEN - (u32Addr & (FMC_MULTI_WORD_PROG_LEN - 1));
+
+    if (u32Words > addr_end - u32Addr)
+    {
+        u32Words = addr_end - u32Addr;
+    }
+
+    u32Words = (u32Words & ~0xF) / 4;
+
+    FMC->ISPCMD = FMC_ISPCMD_MULTI_PROG;
+    FMC->ISPADDR = u32Addr;
+    FMC->MPDAT0 = data[0];
+    FMC->MPDAT1 = data[1];
+    FMC->MPDAT2 = data[2];
+    FMC->MPDAT3 = data[3];
+    FMC->ISPTRG = 0x1;
+
+    for (i = 4; i < u32Words; i += 2)
+    {
+        /* Wait for the register pair to be taken; it still holds words i - 4 and i - 3 */
+        while ((u32Sts = FMC->MPSTS) & ((i & 2) ? (FMC_MPSTS_D2_Msk | FMC_MPSTS_D3_Msk) : (FMC_MPSTS_D0_Msk | FMC_MPSTS_D1_Msk)))
+        {
+            if ((u32Sts & FMC_MPSTS_MPBUSY_Msk) == 0)
+            {
+                return u32Addr + (i - 4) * 4;
+            }
+        }
+
+        if (i & 2)
+        {
+            FMC->MPDAT2 = data[i];
+            FMC->MPDAT3 = data[i + 1];
+        }
+        else
+        {
+            FMC->MPDAT0 = data[i];
+            FMC->MPDAT1 = data[i + 1];
+        }
+    }
+
+    while ((u32Sts = FMC->MPSTS) & FMC_MPSTS_MPBUSY_Msk) ;
+
+    /* The last two pairs, words u32Words - 4 on in MPDAT0/1 and MPDAT2/3 */
+    if (u32Sts & (FMC_MPSTS_D0_Msk | FMC_MPSTS_D1_Msk))
+    {
+        return u32Addr + (u32Words - 4) * 4;
+    }
+
+    if (u32Sts & (FMC_MPSTS_D2_Msk | FMC_MPSTS_D3_Msk))
+    {
+        return u32Addr + (u32Words - 2) * 4;
+    }
+
+    return u32Addr + u32Words * 4;
+}
+
+/* CRC32 of len bytes at data by the CRC engine, as the FMC checksum engine computes it */
+static uint32_t FMC_BufCrc32(uint32_t *data, uint32_t len)
+{
+    CLK->AHBCLK |= CLK_AHBCLK_CRCCKEN_Msk;
+    CRC->SEED = 0xFFFFFFFF;
+    CRC->CTL = CRC_32 | CRC_WDATA_RVS | CRC_CHECKSUM_RVS | CRC_CHECKSUM_COM | CRC_WDATA_32 | CRC_CTL_CRCEN_Msk;
+    CRC->CTL |= CRC_CTL_CHKSINIT_Msk;
+
+    for (; len != 0; len -= 4)
+    {
+        CRC->DAT = *data++;
+    }
+
+    return CRC->CHECKSUM;
+}
+
+int FMC_Proc(uint32_t u32Cmd, uint32_t addr_start, uint32_t addr_end, uint32_t *data)
+{
+    unsigned int u32Addr, Reg;
+
+    for (u32Addr = addr_start; u32Addr < addr_end; data++)
+    {
+        FMC->ISPCMD = u32Cmd;
+        FMC->ISPADDR = u32Addr;
+
+        if (u32Cmd == FMC_ISPCMD_PROGRAM)
+        {
+            FMC->ISPDAT = *data;
+        }
+
+        FMC->ISPTRG = 0x1;
+        __ISB();
+
+        while (FMC->ISPTRG & 0x1) ;  /* Wait for ISP command done. */
+
+        Reg = FMC->ISPCTL;
+
+        if (Reg & FMC_ISPCTL_ISPFF_Msk)
+        {
+            FMC->ISPCTL = Reg;
+            return (-1);
+        }
+
+        if (u32Cmd == FMC_ISPCMD_READ)
+        {
+            *data = FMC->ISPDAT;
+        }
+
+        if (u32Cmd == FMC_ISPCMD_PAGE_ERASE)
+        {
+            u32Addr += FMC_FLASH_PAGE_SIZE;
+        }
+        else
+        {
+            u32Addr += 4;
+        }
+    }
+
+    return (0);
+}
+
+/* Program and verify; the flash must be erased. Whole pages are verified by the FMC checksum,
+   the rest word by word. Returns -1 if programming fails or the flash differs from data. */
+int WriteData(uint32_t addr_start, uint32_t addr_end, uint32_t *data)
+{
+    uint32_t u32Addr, u32Next, u32Data, *pu32Src = data;
+
+    for (u32Addr = addr_start; u32Addr < addr_end; u32Addr = u32Next)
+    {
+        u32Next = u32Addr;
+
+        if (((u32Addr & 0xF) == 0) && ((addr_end - u32Addr) >= 16))
+        {
+            u32Next = FMC_MultiProg(u32Addr, addr_end, data);
+
+            if (FMC->ISPCTL & FMC_ISPCTL_ISPFF_Msk)
+            {
+                FMC->ISPCTL |= FMC_ISPCTL_ISPFF_Msk;
+                return -1;
+            }
+        }
+
+        /* One word at a time, also when a burst ended before its first pair */
+        if (u32Next == u32Addr)
+        {
+            u32Next = u32Addr + 4;
+
+            if (FMC_Proc(FMC_ISPCMD_PROGRAM, u32Addr, u32Next, data) != 0)
+            {
+                return -1;
+            }
+        }
+
+        data += (u32Next - u32Addr) / 4;
+    }
+
+    for (u32Addr = addr_start; u32Addr < addr_end; u32Addr = u32Next)
+    {
+        if (((u32Addr & (FMC_FLASH_PAGE_SIZE - 1)) == 0) && ((addr_end - u32Addr) >= FMC_FLASH_PAGE_SIZE))
+        {
+            u32Next = u32Addr + FMC_FLASH_PAGE_SIZE;
+
+            if (GetCRC32(u32Addr, FMC_FLASH_PAGE_SIZE) != FMC_BufCrc32(pu32Src, FMC_FLASH_PAGE_SIZE))
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            u32Next = u32Addr + 4;
+
+            if ((FMC_Read_User(u32Addr, &u32Data) != 0) || (u32Data != *pu32Src))
+            {
+                return -1;
+            }
+        }
+
+        pu32Src += (u32Next - u32Addr) / 4;
+    }
+
+    return 0;
+}
+
+/* CRC32 of size bytes from addr_start by the FMC checksum engine; both must be multiples of 512 */
+uint32_t GetCRC32(uint32_t addr_start, uint32_t size)
+{
+    FMC->ISPCMD = FMC_ISPCMD_RUN_CKS;
+    FMC->ISPADDR = addr_start;
+    FMC->ISPDAT = size;
+    FMC->ISPTRG = 0x1;
+    __ISB();
+
+    while (FMC->ISPTRG & 0x1) ;
+
+    FMC->ISPCMD = FMC_ISPCMD_READ_CKS;
+    FMC->ISPADDR = addr_start;
+    FMC->ISPTRG = 0x1;
+    __ISB();
+
+    while (FMC->ISPTRG & 0x1) ;
+
+    return FMC->ISPDAT;
+}
+
+/* TRUE if size bytes from addr_start are all erased, checked by the FMC all-one engine */
+int IsAllOne(uint32_t addr_start, uint32_t size)
+{
+    FMC->ISPCMD = FMC_ISPCMD_RUN_ALL1;
+    FMC->ISPADDR = addr_start;
+    FMC->ISPDAT = size;
+    FMC->ISPTRG = 0x1;
+    __ISB();
+
+    while (FMC->ISPTRG & 0x1) ;
+
+    do
+    {
+        FMC->ISPCMD = FMC_ISPCMD_READ_ALL1;
+        FMC->ISPADDR = addr_start;
+        FMC->ISPTRG = 0x1;
+        __ISB();
+
+        while (FMC->ISPTRG & 0x1) ;
+    }
+    while (FMC->ISPDAT == 0);
+
+    return (FMC->ISPDAT == READ_ALLONE_YES);
+}
+
+void UpdateConfig(uint32_t *data, uint32_t *res)
+{
+    unsigned int u32Size = CONFIG_SIZE;
+    FMC_ENABLE_CFG_UPDATE();
+    FMC_Proc(FMC_ISPCMD_PAGE_ERASE, Config0, Config0 + 8, 0);
+    FMC_Proc(FMC_ISPCMD_PROGRAM, Config0, Config0 + u32Size, data);
+
+    if (res)
+    {
+        FMC_Proc(FMC_ISPCMD_READ, Config0, Config0 + u32Size, res);
+    }
+
+    FMC_DISABLE_CFG_UPDATE();
+}
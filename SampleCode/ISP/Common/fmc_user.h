@@ -8,13 +8,14 @@
 #ifndef FMC_USER_H
 #define FMC_USER_H
 
-#include "targetdev.h"
+#include "NuMicro.h"
 
 extern int FMC_Proc(uint32_t u32Cmd, uint32_t addr_start, uint32_t addr_end, uint32_t *data);
 
 
 #define Config0         FMC_CONFIG_BASE
 #define Config1         (FMC_CONFIG_BASE+4)
+#define CONFIG_SIZE     8   // in bytes
 
 #define ISPGO           0x01
 
@@ -51,9 +52,11 @@ extern int FMC_Proc(uint32_t u32Cmd, uint32_t addr_start, uint32_t addr_end, uin
 #define FMC_Erase_User(u32Addr) (FMC_Proc(FMC_ISPCMD_PAGE_ERASE, u32Addr, (u32Addr) + 4, 0))
 
 #define ReadData(addr_start, addr_end, data) (FMC_Proc(FMC_ISPCMD_READ, addr_start, addr_end, data))
-#define WriteData(addr_start, addr_end, data) (FMC_Proc(FMC_ISPCMD_PROGRAM, addr_start, addr_end, data))
 #define EraseAP(addr_start, size) (FMC_Proc(FMC_ISPCMD_PAGE_ERASE, addr_start, (addr_start) + (size), NULL))
 
+extern int WriteData(uint32_t addr_start, uint32_t addr_end, uint32_t *data);
+extern uint32_t GetCRC32(uint32_t addr_start, uint32_t size);
+extern int IsAllOne(uint32_t addr_start, uint32_t size);
 extern void UpdateConfig(uint32_t *data, uint32_t *res);
 
 #endif
@@ -0,0 +1,677 @@
+/**************************************************************************//**
+ * @file     isp_user.c
+ * @brief    ISP Command source file, shared by the UART, RS485, I2C, SPI and HID loaders
+ * @version  0x32
+ * @date     14, June, 2017
+ *
+ * @note
+ * Copyright (C) 2017-2018 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include "isp_user.h"
+#include "fmc_user.h"
+
+#if 0
+#define RSTSTS      RSTSRC
+#define ISPCTL      ISPCON
+#endif
+
+
+#ifdef __ICCARM__
+#pragma data_alignment=4
+uint8_t response_buff[64];
+static uint8_t aprom_buf[FMC_FLASH_PAGE_SIZE];
+#else
+uint8_t response_buff[64] __attribute__((aligned(4)));
+static uint8_t aprom_buf[FMC_FLASH_PAGE_SIZE] __attribute__((aligned(4)));
+#endif
+
+uint32_t bUpdateApromCmd;
+uint32_t bCrc32Mode;
+uint32_t g_apromSize, g_dataFlashAddr, g_dataFlashSize;
+
+__STATIC_INLINE uint16_t Checksum(unsigned char *buf, int len)
+{
+    int i;
+    uint16_t c;
+
+    for (c = 0, i = 0 ; i < len; i++)
+    {
+        c += buf[i];
+    }
+
+    return (c);
+}
+
+#if ISP_CRC32_MODE || UART_STREAM_MODE || RS485_MULTIDROP
+/* CRC32 of len bytes at buf, both word aligned. PDMA feeds the CRC engine so that the
+   CPU does not touch the data. The transport options come from the project defines. */
+uint32_t Crc32Calc(uint32_t *buf, uint32_t len)
+{
+    CLK->AHBCLK |= (CLK_AHBCLK_CRCCKEN_Msk | CLK_AHBCLK_PDMACKEN_Msk);
+    CRC->SEED = 0xFFFFFFFF;
+    CRC->CTL = CRC_32 | CRC_WDATA_RVS | CRC_CHECKSUM_RVS | CRC_CHECKSUM_COM | CRC_WDATA_32 | CRC_CTL_CRCEN_Msk;
+    CRC->CTL |= CRC_CTL_CHKSINIT_Msk;
+
+    PDMA->CHCTL |= (1 << CRC_PDMA_CH);
+    PDMA->REQSEL0_3 &= ~(PDMA_REQSEL0_3_REQSRC0_Msk << (CRC_PDMA_CH * 8));    /* PDMA_MEM */
+    PDMA->DSCT[CRC_PDMA_CH].SA = (uint32_t)buf;
+    PDMA->DSCT[CRC_PDMA_CH].DA = (uint32_t)&CRC->DAT;
+    PDMA->DSCT[CRC_PDMA_CH].CTL = ((len / 4 - 1) << PDMA_DSCT_CTL_TXCNT_Pos) | PDMA_WIDTH_32 | PDMA_SAR_INC | PDMA_DAR_FIX |
+                                  PDMA_REQ_BURST | PDMA_BURST_4 | PDMA_OP_BASIC;
+    PDMA->TDSTS = (1 << CRC_PDMA_CH);
+    PDMA->SWREQ = (1 << CRC_PDMA_CH);
+
+    while ((PDMA->TDSTS & (1 << CRC_PDMA_CH)) == 0);
+
+    PDMA->TDSTS = (1 << CRC_PDMA_CH);
+    return CRC->CHECKSUM;
+}
+#endif
+
+#if ISP_PAGE_UPDATE || ISP_CRC32_MODE
+/* Page address inside APROM or Data Flash */
+static int IsFlashPage(uint32_t u32Addr)
+{
+    uint32_t u32ApLimit = (g_apromSize < g_dataFlashAddr) ? g_apromSize : g_dataFlashAddr;
+
+    if (u32Addr & (FMC_FLASH_PAGE_SIZE - 1))
+    {
+        return FALSE;
+    }
+
+    return (u32Addr < u32ApLimit) || ((u32Addr >= g_dataFlashAddr) && (u32Addr < g_dataFlashAddr + g_dataFlashSize));
+}
+
+#endif
+
+#if ISP_CRC32_MODE
+/* Page aligned range inside APROM or inside Data Flash */
+static int IsFlashRange(uint32_t u32Addr, uint32_t u32Len)
+{
+    return (u32Len != 0) && (u32Addr + u32Len > u32Addr) &&
+           IsFlashPage(u32Addr) && IsFlashPage(u32Addr + u32Len - FMC_FLASH_PAGE_SIZE);
+}
+#endif
+
+#if ISP_PAGE_LZ
+/* State of the compressed page being received */
+static uint32_t LzFlags, LzLow;
+
+/* Expand compressed bytes into aprom_buf after the remain bytes still missing there.
+   Each flag byte covers the next 8 items, LSB first: 0 a literal, 1 a 2-byte match of
+   3..130 bytes from up to 512 bytes back in the page. Returns the bytes still missing. */
+static uint32_t LzDecode(unsigned char *pSrc, uint32_t srclen, uint32_t remain)
+{
+    uint32_t out = FMC_FLASH_PAGE_SIZE - remain, dist, c;
+
+    while (srclen-- && (out < FMC_FLASH_PAGE_SIZE))
+    {
+        c = *pSrc++;
+
+        if (LzFlags == 1)
+        {
+            LzFlags = c | 0x100;
+        }
+        else if ((LzFlags & 1) == 0)
+        {
+            aprom_buf[out++] = c;
+            LzFlags >>= 1;
+        }
+        else if (LzLow > 0xFF)
+        {
+            LzLow = c;
+        }
+        else
+        {
+            dist = (((c & 1) << 8) | LzLow) + 1;
+
+            if (dist > out)
+            {
+                return 0;    /* Corrupt stream; the CRC check rejects the page */
+            }
+
+            for (c = (c >> 1) + 3; c && (out < FMC_FLASH_PAGE_SIZE); c--, out++)
+            {
+                aprom_buf[out] = aprom_buf[out - dist];
+            }
+
+            LzLow = 0x100;
+            LzFlags >>= 1;
+        }
+    }
+
+    return FMC_FLASH_PAGE_SIZE - out;
+}
+#endif
+
+#if ISP_RESUME_RECORD
+/* Progress record of a resumable CMD_UPDATE_APROM, kept in the last Data Flash page:
+   [0] RESUME_MAGIC, [1] image length, [2] image ID, then the bytes in flash so far, one word
+   appended per page the host has accepted. The last word written is the one that counts.
+   The page is only erased while it holds a record, so data left there by mistake survives. */
+#define RESUME_MAGIC          0x52505349    /* "ISPR" */
+#define RESUME_HDR_SIZE       12
+
+static uint32_t ResumeLen, ResumeId;    /* Image the record is for, or to be for */
+static uint32_t ResumeSlot;             /* Next free progress word, 0 if no record is kept */
+static uint32_t ResumeDone;             /* Bytes the record holds */
+static uint32_t ResumeMark;             /* Bytes written, waiting for the host to take the answer */
+
+static uint32_t ResumePage(void)
+{
+    return g_dataFlashSize ? (g_dataFlashAddr + g_dataFlashSize - FMC_FLASH_PAGE_SIZE) : 0;
+}
+
+/* Header of the record page; TRUE if it is a record, for any image */
+static int ResumeHeader(uint32_t au32Hdr[3])
+{
+    uint32_t u32Page = ResumePage();
+
+    return u32Page && (ReadData(u32Page, u32Page + RESUME_HDR_SIZE, au32Hdr) == 0) && (au32Hdr[0] == RESUME_MAGIC);
+}
+
+/* Forget the record. Any record goes once APROM is erased, it no longer describes the flash. */
+static void ResumeDrop(void)
+{
+    uint32_t au32Hdr[3];
+
+    ResumeSlot = 0;
+    ResumeMark = 0;
+
+    if (ResumeHeader(au32Hdr))
+    {
+        FMC_Erase_User(ResumePage());
+    }
+}
+
+/* Write a new record, u32Done bytes of the ResumeLen byte image ResumeId. A record of another
+   image is replaced; a page that is neither blank nor a record is left alone and nothing kept. */
+static void ResumeStart(uint32_t u32Done)
+{
+    uint32_t u32Page = ResumePage(), au32Rec[4];
+
+    ResumeSlot = 0;
+
+    if (ResumeHeader(au32Rec))
+    {
+        FMC_Erase_User(u32Page);
+    }
+    else if (!IsAllOne(u32Page, FMC_FLASH_PAGE_SIZE))
+    {
+        return;
+    }
+
+    au32Rec[0] = RESUME_MAGIC;
+    au32Rec[1] = ResumeLen;
+    au32Rec[2] = ResumeId;
+    au32Rec[3] = u32Done;
+    ResumeSlot = (WriteData(u32Page, u32Page + sizeof(au32Rec), au32Rec) == 0) ? (u32Page + sizeof(au32Rec)) : 0;
+    ResumeDone = u32Done;
+}
+
+/* Bytes of image ResumeId in flash by the record, 0 if the record is for something else */
+static uint32_t ResumeFind(void)
+{
+    uint32_t u32Page = ResumePage(), *pu32Rec = (uint32_t *)aprom_buf, i;
+
+    if (u32Page == 0)
+    {
+        return 0;
+    }
+
+    ReadData(u32Page, u32Page + FMC_FLASH_PAGE_SIZE, pu32Rec);
+
+    if ((pu32Rec[0] != RESUME_MAGIC) || (pu32Rec[1] != ResumeLen) || (pu32Rec[2] != ResumeId))
+    {
+        return 0;
+    }
+
+    for (i = RESUME_HDR_SIZE / 4; (i < FMC_FLASH_PAGE_SIZE / 4) && (pu32Rec[i] != 0xFFFFFFFF); i++);
+
+    ResumeSlot = u32Page + i * 4;
+    ResumeDone = pu32Rec[i - 1];
+    return ResumeDone;
+}
+
+/* Add u32Done to the record; a full page starts over with the header and the latest count */
+static void ResumeLog(uint32_t u32Done)
+{
+    if ((ResumeSlot == 0) || (u32Done <= ResumeDone))
+    {
+        return;
+    }
+
+    if (u32Done >= ResumeLen)
+    {
+        ResumeDrop();   /* Image complete */
+    }
+    else if (ResumeSlot >= ResumePage() + FMC_FLASH_PAGE_SIZE)
+    {
+        ResumeStart(u32Done);
+    }
+    else if (WriteData(ResumeSlot, ResumeSlot + 4, &u32Done) == 0)
+    {
+        ResumeSlot += 4;
+        ResumeDone = u32Done;
+    }
+}
+#endif
+
+static int ParseCmd(const ISP_TRANSPORT_T *psTransport, unsigned char *buffer, uint8_t len)
+{
+    static uint32_t StartAddress, TotalLen, LastDataLen, g_packno = 1;
+#if ISP_PAGE_UPDATE
+    static uint32_t PageCrc;
+#endif
+    uint8_t *response;
+    uint16_t lcksum;
+    uint32_t lcmd, srclen, i, regcnf0, security;
+    unsigned char *pSrc;
+    static uint32_t gcmd;
+    response = response_buff;
+    pSrc = buffer;
+    srclen = len;
+    lcmd = inpw(pSrc);
+    outpw(response + 4, 0);
+    pSrc += 8;
+    srclen -= 8;
+    ReadData(Config0, Config0 + 16, (uint32_t *)(response + 8)); /*read config */
+    regcnf0 = *(uint32_t *)(response + 8);
+    security = regcnf0 & 0x2;
+
+    if (lcmd == CMD_SYNC_PACKNO)
+    {
+        g_packno = inpw(pSrc);
+    }
+
+#if ISP_RESUME_RECORD
+
+    if (ResumeMark)
+    {
+        /* The host sends the next part, or leaves a finished image, only once the answer checked
+           out, so the flash holds what the mark covers. Anything else may follow a lost link. */
+        if (((lcmd == 0) && (gcmd == CMD_UPDATE_APROM)) ||
+                ((ResumeMark == ResumeLen) && (lcmd != CMD_RESEND_PACKET)))
+        {
+            ResumeLog(ResumeMark);
+        }
+
+        ResumeMark = 0;
+    }
+
+#endif
+
+    if ((lcmd) && (lcmd != CMD_RESEND_PACKET))
+    {
+        gcmd = lcmd;
+    }
+
+    if (lcmd == CMD_GET_FWVER)
+    {
+        response[8] = FW_VERSION;
+    }
+    else if (lcmd == CMD_GET_DEVICEID)
+    {
+        outpw(response + 8, SYS->PDID);
+        goto out;
+    }
+    else if (lcmd == CMD_RUN_APROM || lcmd == CMD_RUN_LDROM || lcmd == CMD_RESET)
+    {
+        SYS->RSTSTS = 3; /*clear bit*/
+
+        /* Set BS */
+        if (lcmd == CMD_RUN_APROM)
+        {
+            i = (FMC->ISPCTL & 0xFFFFFFFC);
+        }
+        else if (lcmd == CMD_RUN_LDROM)
+        {
+            i = (FMC->ISPCTL & 0xFFFFFFFC);
+            i |= 0x00000002;
+        }
+        else
+        {
+            i = (FMC->ISPCTL & 0xFFFFFFFE);/* ISP disable */
+        }
+
+        FMC->ISPCTL = i;
+        SCB->AIRCR = (V6M_AIRCR_VECTKEY_DATA | V6M_AIRCR_SYSRESETREQ);
+
+        /* Trap the CPU */
+        while (1);
+    }
+    else if (lcmd == CMD_CONNECT)
+    {
+        g_packno = 1;
+        bCrc32Mode = FALSE;
+        goto out;
+    }
+    else if ((lcmd == CMD_UPDATE_APROM) || (lcmd == CMD_ERASE_ALL))
+    {
+        EraseAP(FMC_APROM_BASE, (g_apromSize < g_dataFlashAddr) ? g_apromSize : g_dataFlashAddr); /* erase APROM */
+#if ISP_RESUME_RECORD
+        ResumeDrop();
+#endif
+
+        if (lcmd == CMD_ERASE_ALL)
+        {
+            EraseAP(g_dataFlashAddr, g_dataFlashSize);
+            *(uint32_t *)(response + 8) = regcnf0 | 0x02;
+            UpdateConfig((uint32_t *)(response + 8), NULL);
+        }
+
+        bUpdateApromCmd = TRUE;
+    }
+    else if (lcmd == CMD_GET_PAGE_CRC)
+    {
+        /* [8] first page, [12] page count in; [8] pages reported, [12..] CRC32 of each out */
+#if ISP_PAGE_UPDATE
+        uint32_t u32Page = inpw(pSrc);
+
+        for (i = 0; (i < inpw(pSrc + 4)) && (i < PAGE_CRC_MAX); i++, u32Page += FMC_FLASH_PAGE_SIZE)
+        {
+            if (((security == 0) && (!bUpdateApromCmd)) || (!IsFlashPage(u32Page)))   /*security lock*/
+            {
+                break;
+            }
+
+            outpw(response + 12 + i * 4, GetCRC32(u32Page, FMC_FLASH_PAGE_SIZE));
+        }
+
+#else
+        i = 0;
+#endif
+        outpw(response + 8, i);
+        goto out;
+    }
+    else if ((lcmd == CMD_UPDATE_PAGE) || (lcmd == CMD_UPDATE_PAGE_LZ))
+    {
+        /* [8] page address, [12] CRC32 of the new page, [16..] first part of the page, raw or compressed */
+#if ISP_PAGE_UPDATE
+        StartAddress = inpw(pSrc);
+        PageCrc = inpw(pSrc + 4);
+        TotalLen = FMC_FLASH_PAGE_SIZE;
+#if ISP_PAGE_LZ
+        LzFlags = 1;
+        LzLow = 0x100;
+#endif
+
+        if (((security == 0) && (!bUpdateApromCmd)) || (!IsFlashPage(StartAddress)) ||   /*security lock*/
+                ((lcmd == CMD_UPDATE_PAGE_LZ) && !ISP_PAGE_LZ))
+        {
+            gcmd = 0;
+            outpw(response + 8, PAGE_ST_REFUSED);
+            goto out;
+        }
+
+        if (GetCRC32(StartAddress, FMC_FLASH_PAGE_SIZE) == PageCrc)
+        {
+            /* Unchanged, the rest of the page is not needed */
+            gcmd = 0;
+            outpw(response + 8, PAGE_ST_DONE);
+            goto out;
+        }
+
+        pSrc += 8;
+        srclen -= 8;
+#else
+        gcmd = 0;
+        outpw(response + 8, PAGE_ST_REFUSED);
+        goto out;
+#endif
+    }
+    else if (lcmd == CMD_GET_IMAGE_CRC)
+    {
+        /* [8] start, [12] length in; [8] CRC32, [12] bytes covered out, whole pages, 0 if refused */
+#if ISP_CRC32_MODE
+        uint32_t u32Page = inpw(pSrc);
+
+        i = (inpw(pSrc + 4) + FMC_FLASH_PAGE_SIZE - 1) & ~(FMC_FLASH_PAGE_SIZE - 1);
+
+        if (((security == 0) && (!bUpdateApromCmd)) || (!IsFlashRange(u32Page, i)))   /*security lock*/
+        {
+            i = 0;
+        }
+
+        outpw(response + 8, i ? GetCRC32(u32Page, i) : 0);
+        outpw(response + 12, i);
+#else
+        outpw(response + 8, 0);
+        outpw(response + 12, 0);
+#endif
+        goto out;
+    }
+    else if (lcmd == CMD_RESUME_APROM)
+    {
+        /* [8] image length, [12] image ID in; [8] bytes already in flash out. With 0 the host sends
+           CMD_UPDATE_APROM, which then keeps a record for this image; otherwise it goes on with
+           command 0 packets from there. The packets after the last recorded page reach at most
+           into the page after it; these two are erased again and the rest must still be blank,
+           so nothing is programmed twice nor can be read back. Always 0 under the security lock,
+           where only CMD_UPDATE_APROM with its full APROM erase may program, and without
+           ISP_RESUME_RECORD. */
+#if ISP_RESUME_RECORD
+        uint32_t u32Page;
+
+        ResumeLen = inpw(pSrc);
+        ResumeId = inpw(pSrc + 4);
+        i = ResumeFind();
+        u32Page = (ResumeLen + FMC_FLASH_PAGE_SIZE - 1) & ~(FMC_FLASH_PAGE_SIZE - 1);
+
+        if (((security == 0) && (!bUpdateApromCmd)) ||   /*security lock*/
+                (i == 0) || (i >= ResumeLen) || (i & (FMC_FLASH_PAGE_SIZE - 1)) ||
+                (u32Page > ((g_apromSize < g_dataFlashAddr) ? g_apromSize : g_dataFlashAddr)) ||
+                ((i + 2 * FMC_FLASH_PAGE_SIZE < u32Page) &&
+                 !IsAllOne(FMC_APROM_BASE + i + 2 * FMC_FLASH_PAGE_SIZE, u32Page - i - 2 * FMC_FLASH_PAGE_SIZE)))
+        {
+            ResumeSlot = 0;
+            i = 0;
+        }
+        else
+        {
+            EraseAP(FMC_APROM_BASE + i, (u32Page - i > 2 * FMC_FLASH_PAGE_SIZE) ? (2 * FMC_FLASH_PAGE_SIZE) : (u32Page - i));
+            StartAddress = FMC_APROM_BASE + i;
+            TotalLen = ResumeLen - i;
+            LastDataLen = 0;
+            gcmd = CMD_UPDATE_APROM;
+        }
+
+#else
+        i = 0;
+#endif
+        outpw(response + 8, i);
+        goto out;
+    }
+    else if (lcmd == CMD_CRC32_MODE)
+    {
+        /* [8] 1 for CRC32 frames, 0 for byte sums; in effect from the next packet */
+        outpw(response + 8, ISP_CRC32_MODE && (inpw(pSrc) == 1));
+        goto out;
+    }
+    else if ((psTransport->pfnCommand != NULL) &&
+             psTransport->pfnCommand(lcmd, pSrc, response, (security == 0) && (!bUpdateApromCmd)))
+    {
+        goto out;
+    }
+
+    if ((lcmd == CMD_UPDATE_APROM) || (lcmd == CMD_UPDATE_DATAFLASH))
+    {
+        if (lcmd == CMD_UPDATE_DATAFLASH)
+        {
+            StartAddress = g_dataFlashAddr;
+
+            if (g_dataFlashSize)   /*g_dataFlashAddr*/
+            {
+                EraseAP(g_dataFlashAddr, g_dataFlashSize);
+#if ISP_RESUME_RECORD
+                ResumeSlot = 0;
+                ResumeMark = 0;
+#endif
+            }
+            else
+            {
+                goto out;
+            }
+        }
+        else
+        {
+            StartAddress = 0;
+        }
+
+        TotalLen = inpw(pSrc + 4);
+        pSrc += 8;
+        srclen -= 8;
+
+#if ISP_RESUME_RECORD
+
+        if ((lcmd == CMD_UPDATE_APROM) && ResumePage() && (TotalLen == ResumeLen))
+        {
+            ResumeStart(0);     /* Armed by CMD_RESUME_APROM */
+        }
+
+#endif
+    }
+    else if (lcmd == CMD_UPDATE_CONFIG)
+    {
+        if ((security == 0) && (!bUpdateApromCmd))   /*security lock*/
+        {
+            goto out;
+        }
+
+        UpdateConfig((uint32_t *)(pSrc), (uint32_t *)(response + 8));
+        GetDataFlashInfo(&g_dataFlashAddr, &g_dataFlashSize);
+        goto out;
+    }
+    else if (lcmd == CMD_RESEND_PACKET)     /*for APROM&Data flash only*/
+    {
+        uint32_t PageAddress;
+        StartAddress -= LastDataLen;
+        TotalLen += LastDataLen;
+        PageAddress = StartAddress & (0x100000 - FMC_FLASH_PAGE_SIZE);
+
+        if (PageAddress >= Config0)
+        {
+            goto out;
+        }
+
+        ReadData(PageAddress, StartAddress, (uint32_t *)aprom_buf);
+        FMC_Erase_User(PageAddress);
+        WriteData(PageAddress, StartAddress, (uint32_t *)aprom_buf);
+
+        if ((StartAddress % FMC_FLASH_PAGE_SIZE) >= (FMC_FLASH_PAGE_SIZE - LastDataLen))
+        {
+            FMC_Erase_User(PageAddress + FMC_FLASH_PAGE_SIZE);
+        }
+
+        goto out;
+    }
+
+    if ((gcmd == CMD_UPDATE_APROM) || (gcmd == CMD_UPDATE_DATAFLASH))
+    {
+        if (TotalLen < srclen)
+        {
+            srclen = TotalLen;/*prevent last package from over writing*/
+        }
+
+        TotalLen -= srclen;
+        WriteData(StartAddress, StartAddress + srclen, (uint32_t *)pSrc);
+        memset(pSrc, 0, srclen);
+        ReadData(StartAddress, StartAddress + srclen, (uint32_t *)pSrc);
+        StartAddress += srclen;
+        LastDataLen =  srclen;
+#if ISP_RESUME_RECORD
+
+        if ((gcmd == CMD_UPDATE_APROM) && ResumeSlot)
+        {
+            ResumeMark = TotalLen ? ((StartAddress - FMC_APROM_BASE) & ~(FMC_FLASH_PAGE_SIZE - 1)) : ResumeLen;
+        }
+
+#endif
+    }
+
+#if ISP_PAGE_UPDATE
+    else if ((gcmd == CMD_UPDATE_PAGE) || (gcmd == CMD_UPDATE_PAGE_LZ))
+    {
+        /* Erase only once the whole page is here */
+#if ISP_PAGE_LZ
+
+        if (gcmd == CMD_UPDATE_PAGE_LZ)
+        {
+            TotalLen = LzDecode(pSrc, srclen, TotalLen);
+        }
+        else
+#endif
+        {
+            if (TotalLen < srclen)
+            {
+                srclen = TotalLen;
+            }
+
+            memcpy(&aprom_buf[FMC_FLASH_PAGE_SIZE - TotalLen], pSrc, srclen);
+            TotalLen -= srclen;
+        }
+
+        if (TotalLen)
+        {
+            outpw(response + 8, PAGE_ST_MORE);
+        }
+        else
+        {
+            if ((FMC_Erase_User(StartAddress) != 0) ||
+                    (WriteData(StartAddress, StartAddress + FMC_FLASH_PAGE_SIZE, (uint32_t *)aprom_buf) != 0) ||
+                    (GetCRC32(StartAddress, FMC_FLASH_PAGE_SIZE) != PageCrc))
+            {
+                outpw(response + 8, PAGE_ST_PROG_FAIL);
+            }
+            else
+            {
+                outpw(response + 8, PAGE_ST_DONE);
+            }
+
+            gcmd = 0;
+        }
+    }
+
+#endif
+out:
+#if ISP_CRC32_MODE
+
+    if (bCrc32Mode)
+    {
+        /* CRC32 of the whole packet instead of the byte sum */
+        outpw(response, Crc32Calc((uint32_t *)buffer, len));
+    }
+    else
+#endif
+    {
+        lcksum = Checksum(buffer, len);
+        outps(response, lcksum);
+    }
+
+    if (lcmd == CMD_CRC32_MODE)
+    {
+        bCrc32Mode = inpw(response + 8);
+    }
+
+    ++g_packno;
+    outpw(response + 4, g_packno);
+    g_packno++;
+    return (0);
+}
+
+/* Take the next request from the transport, if one is waiting, and send the answer back.
+   Returns TRUE if a request was handled. */
+int ISP_Poll(const ISP_TRANSPORT_T *psTransport)
+{
+    unsigned char *buffer = psTransport->pfnRecvFrame();
+
+    if (buffer == NULL)
+    {
+        return FALSE;
+    }
+
+    ParseCmd(psTransport, buffer, ISP_FRAME_SIZE);
+    psTransport->pfnSendFrame(response_buff, ISP_FRAME_SIZE);
+    return TRUE;
+}
@@ -0,0 +1,127 @@
+/**************************************************************************//**
+ * @file     isp_user.h
+ * @brief    ISP Command header file, shared by the UART, RS485, I2C, SPI and HID loaders
+ * @version  0x34
+ * @date     14, June, 2017
+ *
+ * @note
+ * Copyright (C) 2017-2018 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef ISP_USER_H
+#define ISP_USER_H
+
+#define FW_VERSION 0x34
+
+#include "fmc_user.h"
+#include <string.h>
+
+#define CMD_UPDATE_APROM      0x000000A0
+#define CMD_UPDATE_CONFIG     0x000000A1
+#define CMD_READ_CONFIG       0x000000A2
+#define CMD_ERASE_ALL         0x000000A3
+#define CMD_SYNC_PACKNO       0x000000A4
+#define CMD_GET_FWVER         0x000000A6
+#define CMD_RUN_APROM         0x000000AB
+#define CMD_RUN_LDROM         0x000000AC
+#define CMD_RESET             0x000000AD
+#define CMD_CONNECT           0x000000AE
+#define CMD_GET_DEVICEID      0x000000B1
+#define CMD_UPDATE_DATAFLASH  0x000000C3
+#define CMD_STREAM_MODE       0x000000D0    /* ISP_UART transport command */
+#define CMD_SET_BAUDRATE      0x000000D1    /* ISP_UART transport command */
+#define CMD_GET_PAGE_CRC      0x000000D2
+#define CMD_UPDATE_PAGE       0x000000D3
+#define CMD_UPDATE_PAGE_LZ    0x000000D4
+#define CMD_CRC32_MODE        0x000000D5
+#define CMD_GET_IMAGE_CRC     0x000000D6
+#define CMD_RESUME_APROM      0x000000D7
+#define CMD_MCAST_GROUP       0x000000D8    /* ISP_RS485 transport command */
+#define CMD_MCAST_START       0x000000D9    /* ISP_RS485 transport command */
+#define CMD_MCAST_PAGE        0x000000DA    /* ISP_RS485 transport command */
+#define CMD_MCAST_STATUS      0x000000DB    /* ISP_RS485 transport command */
+#define CMD_RESEND_PACKET     0x000000FF
+
+/* CMD_UPDATE_PAGE status at response [8] */
+#define PAGE_ST_DONE          0x00    /* Page holds the new data, programmed or already equal */
+#define PAGE_ST_MORE          0x01    /* Send the next part of the page */
+#define PAGE_ST_PROG_FAIL     0x02    /* Erase or program failed, or the CRC differs afterwards */
+#define PAGE_ST_REFUSED       0x03    /* Not an APROM or Data Flash page, or security lock set */
+/* Most CRCs returned by one CMD_GET_PAGE_CRC */
+#define PAGE_CRC_MAX          13
+
+/* Build options, 0 leaves the feature out; set them in the project to 1 where wanted.
+   The loader must fit in the 4 KB LDROM, which the Keil targets and the IAR linker
+   configuration enforce. The default build has all of them off and keeps the commands of
+   the original ISP tool; the <loader>_Features Keil target and the Features IAR
+   configuration turn on those that fit that loader, as noted for each option.
+   A command left out still answers, so that the host falls back:
+   ISP_PAGE_UPDATE: CMD_GET_PAGE_CRC and CMD_UPDATE_PAGE. Without it no page CRC is
+   reported and pages are refused. On in the ISP_SPI and ISP_HID feature builds.
+   ISP_PAGE_LZ: CMD_UPDATE_PAGE_LZ, needs ISP_PAGE_UPDATE. Without it pages are refused.
+   On in the ISP_SPI feature build.
+   ISP_CRC32_MODE: CMD_CRC32_MODE and CMD_GET_IMAGE_CRC. Without them frames keep the byte
+   sum and no bytes are covered. On in the ISP_RS485, ISP_SPI and ISP_HID feature builds.
+   ISP_RESUME_RECORD: CMD_RESUME_APROM keeps its progress record in the last Data Flash page.
+   That page then belongs to the loader and the application must not keep data in it; the
+   loader only erases it while it holds a record. Without it CMD_RESUME_APROM reports 0.
+   On in the ISP_I2C feature build. */
+#ifndef ISP_PAGE_UPDATE
+#define ISP_PAGE_UPDATE       0
+#endif
+#ifndef ISP_PAGE_LZ
+#define ISP_PAGE_LZ           0
+#endif
+#ifndef ISP_CRC32_MODE
+#define ISP_CRC32_MODE        0
+#endif
+#if ISP_PAGE_LZ && !ISP_PAGE_UPDATE
+#error "ISP_PAGE_LZ needs ISP_PAGE_UPDATE"
+#endif
+#ifndef ISP_RESUME_RECORD
+#define ISP_RESUME_RECORD     0
+#endif
+
+/* PDMA channel feeding the CRC engine in CRC32 frame mode */
+#define CRC_PDMA_CH           1
+
+#define V6M_AIRCR_VECTKEY_DATA    0x05FA0000UL
+#define V6M_AIRCR_SYSRESETREQ     0x00000004UL
+
+/* Request and response size of every transport */
+#define ISP_FRAME_SIZE        64
+
+/* The link a loader talks over. The ISP engine is the same for all of them; only the way a
+   frame comes in and goes out, and any command of the link itself, differ. */
+typedef struct
+{
+    /* Next complete request, ISP_FRAME_SIZE bytes at a word aligned address, or NULL if none yet */
+    uint8_t *(*pfnRecvFrame)(void);
+    /* Send the response, len bytes at buf */
+    void (*pfnSendFrame)(uint8_t *buf, uint32_t len);
+    /* Command of the link itself, or NULL. arg is the request from [8] on and the answer goes
+       to response from [8] on; locked is set while the security lock refuses updates.
+       Returns TRUE if it took the command. */
+    int (*pfnCommand)(uint32_t cmd, unsigned char *arg, uint8_t *response, uint32_t locked);
+} ISP_TRANSPORT_T;
+
+// targetdev.c
+extern void GetDataFlashInfo(uint32_t *addr, uint32_t *size);
+extern uint32_t GetApromSize(void);
+
+// isp_user.c
+extern int ISP_Poll(const ISP_TRANSPORT_T *psTransport);
+extern uint32_t Crc32Calc(uint32_t *buf, uint32_t len);
+extern uint32_t g_apromSize, g_dataFlashAddr, g_dataFlashSize;
+extern uint32_t bUpdateApromCmd;
+extern uint32_t bCrc32Mode;
+
+#ifdef __ICCARM__
+#pragma data_alignment=4
+extern uint8_t response_buff[64];
+#else
+extern uint8_t response_buff[64] __attribute__((aligned (4)));
+#endif
+
+
+
+#endif  // #ifndef ISP_USER_H
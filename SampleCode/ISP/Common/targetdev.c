@@ -7,7 +7,6 @@
  * @note
  * Copyright (C) 2017-2018 Nuvoton Technology Corp. All rights reserved.
  ******************************************************************************/
-#include "targetdev.h"
 #include "isp_user.h"
 
 uint32_t GetApromSize()
@@ -0,0 +1,137 @@
+/**************************************************************************//**
+ * @file     isp_lz.c
+ * @version  V1.00
+ * @brief    LZSS page compression for the ISP loaders, host side
+ *
+ * @note     The parse is optimal for the format: for every position the
+ *           cheapest way to reach the end of the page is found from the back,
+ *           with a literal costing 9 bits and a match 17.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "isp_lz.h"
+
+#define LZ_MAX_LEN      4096UL      /* Longest input; the loaders use one page */
+
+/**
+  * @brief      Compress one page
+  * @param[in]  pu8In   Page data
+  * @param[in]  u32Len  Page length in bytes, up to 4096
+  * @param[out] pu8Out  Compressed data
+  * @param[in]  u32Max  Size of the output buffer; ISP_LZ_MAX_SIZE(u32Len) always fits
+  * @return     Compressed length, or -1 if the input is too long or the output does not fit
+  */
+int32_t IspLz_Encode(const uint8_t *pu8In, uint32_t u32Len, uint8_t *pu8Out, uint32_t u32Max)
+{
+    static uint32_t au32Cost[LZ_MAX_LEN + 1UL];
+    static uint16_t au16Len[LZ_MAX_LEN], au16Dist[LZ_MAX_LEN];
+    uint32_t i, j, u32Dist, u32Run, u32Pos = 0UL, u32FlagPos = 0UL, u32Items = 0UL;
+
+    if(u32Len > LZ_MAX_LEN)
+        return -1;
+
+    /* Cheapest encoding of pu8In[i..] for every i, from the end */
+    au32Cost[u32Len] = 0UL;
+    for(i = u32Len; i-- > 0UL;)
+    {
+        au32Cost[i] = au32Cost[i + 1UL] + 9UL;
+        au16Len[i] = 1U;
+        au16Dist[i] = 0U;
+
+        for(u32Dist = 1UL; (u32Dist <= ISP_LZ_MAX_DIST) && (u32Dist <= i); u32Dist++)
+        {
+            for(u32Run = 0UL; (u32Run < ISP_LZ_MAX_MATCH) && (i + u32Run < u32Len) &&
+                    (pu8In[i + u32Run] == pu8In[i + u32Run - u32Dist]); u32Run++)
+            {
+            }
+
+            for(j = ISP_LZ_MIN_MATCH; j <= u32Run; j++)
+            {
+                if(au32Cost[i + j] + 17UL < au32Cost[i])
+                {
+                    au32Cost[i] = au32Cost[i + j] + 17UL;
+                    au16Len[i] = (uint16_t)j;
+                    au16Dist[i] = (uint16_t)u32Dist;
+                }
+            }
+        }
+    }
+
+    for(i = 0UL; i < u32Len; i += au16Len[i])
+    {
+        if((u32Items++ % 8UL) == 0UL)
+        {
+            if(u32Pos >= u32Max)
+                return -1;
+            u32FlagPos = u32Pos++;
+            pu8Out[u32FlagPos] = 0U;
+        }
+
+        if(au16Len[i] == 1U)
+        {
+            if(u32Pos + 1UL > u32Max)
+                return -1;
+            pu8Out[u32Pos++] = pu8In[i];
+        }
+        else
+        {
+            if(u32Pos + 2UL > u32Max)
+                return -1;
+            pu8Out[u32FlagPos] |= (uint8_t)(1U << ((u32Items - 1UL) % 8UL));
+            pu8Out[u32Pos++] = (uint8_t)(au16Dist[i] - 1U);
+            pu8Out[u32Pos++] = (uint8_t)((((uint32_t)au16Len[i] - ISP_LZ_MIN_MATCH) << 1) | ((au16Dist[i] - 1U) >> 8));
+        }
+    }
+
+    return (int32_t)u32Pos;
+}
+
+/**
+  * @brief      Expand one page, as the loader does
+  * @param[in]  pu8In      Compressed data
+  * @param[in]  u32InLen   Compressed length in bytes
+  * @param[out] pu8Out     Page buffer
+  * @param[in]  u32OutLen  Page length in bytes
+  * @return     Compressed bytes used, or -1 if the data is short or a match reaches before the page
+  */
+int32_t IspLz_Decode(const uint8_t *pu8In, uint32_t u32InLen, uint8_t *pu8Out, uint32_t u32OutLen)
+{
+    uint32_t u32In = 0UL, u32Out = 0UL, u32Flags = 1UL, u32Dist, u32Run;
+
+    while(u32Out < u32OutLen)
+    {
+        if(u32Flags == 1UL)
+        {
+            if(u32In >= u32InLen)
+                return -1;
+            u32Flags = pu8In[u32In++] | 0x100UL;
+        }
+
+        if((u32Flags & 1UL) == 0UL)
+        {
+            if(u32In >= u32InLen)
+                return -1;
+            pu8Out[u32Out++] = pu8In[u32In++];
+        }
+        else
+        {
+            if(u32In + 2UL > u32InLen)
+                return -1;
+            u32Dist = ((((uint32_t)pu8In[u32In + 1UL] & 1UL) << 8) | pu8In[u32In]) + 1UL;
+            u32Run = ((uint32_t)pu8In[u32In + 1UL] >> 1) + ISP_LZ_MIN_MATCH;
+            u32In += 2UL;
+            if(u32Dist > u32Out)
+                return -1;
+            for(; u32Run && (u32Out < u32OutLen); u32Run--, u32Out++)
+            {
+                pu8Out[u32Out] = pu8Out[u32Out - u32Dist];
+            }
+        }
+        u32Flags >>= 1;
+    }
+
+    return (int32_t)u32In;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
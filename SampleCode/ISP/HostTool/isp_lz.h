@@ -0,0 +1,41 @@
+/**************************************************************************//**
+ * @file     isp_lz.h
+ * @version  V1.00
+ * @brief    LZSS page compression for the ISP loaders, host side
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __ISP_LZ_H__
+#define __ISP_LZ_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*-------------------------------------------------------------*/
+/* Compressed page: groups of one flag byte and 8 items, flag bits LSB first.
+ *   0: literal, one byte
+ *   1: match, two bytes b0 b1; distance = (((b1 & 1) << 8) | b0) + 1,
+ *      length = (b1 >> 1) + 3
+ * A match copies from earlier in the same page, so the loader needs no RAM
+ * beyond its page buffer. The stream ends when the page is full.
+ */
+#define ISP_LZ_MIN_MATCH        3UL
+#define ISP_LZ_MAX_MATCH        130UL
+#define ISP_LZ_MAX_DIST         512UL
+/* Worst case for a page of incompressible data */
+#define ISP_LZ_MAX_SIZE(len)    ((len) + ((len) + 7UL) / 8UL)
+
+int32_t IspLz_Encode(const uint8_t *pu8In, uint32_t u32Len, uint8_t *pu8Out, uint32_t u32Max);
+int32_t IspLz_Decode(const uint8_t *pu8In, uint32_t u32InLen, uint8_t *pu8Out, uint32_t u32OutLen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __ISP_LZ_H__ */
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,189 @@
+/**************************************************************************//**
+ * @file     isp_patch.c
+ * @version  V1.00
+ * @brief    Page-level firmware patch for the ISP loaders, host side
+ *
+ * @note     A patch lists the CRC32 of every page of the new image and carries
+ *           the data of the pages that differ from the old one. The CRC32 is
+ *           the one the FMC checksum engine computes, so the host can compare
+ *           it with CMD_GET_PAGE_CRC and CMD_UPDATE_PAGE can check the result.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "isp_patch.h"
+
+static void Put32(uint8_t *pu8Buf, uint32_t u32Val)
+{
+    pu8Buf[0] = (uint8_t)u32Val;
+    pu8Buf[1] = (uint8_t)(u32Val >> 8);
+    pu8Buf[2] = (uint8_t)(u32Val >> 16);
+    pu8Buf[3] = (uint8_t)(u32Val >> 24);
+}
+
+static uint32_t Get32(const uint8_t *pu8Buf)
+{
+    return (uint32_t)pu8Buf[0] | ((uint32_t)pu8Buf[1] << 8) | ((uint32_t)pu8Buf[2] << 16) | ((uint32_t)pu8Buf[3] << 24);
+}
+
+/* Page u32Page of an image, padded with 0xFF past its end */
+static void GetPage(const uint8_t *pu8Img, uint32_t u32Len, uint32_t u32Page, uint8_t au8Page[ISP_PATCH_PAGE_SIZE])
+{
+    uint32_t u32Off = u32Page * ISP_PATCH_PAGE_SIZE, u32Copy = 0UL;
+
+    if(u32Off < u32Len)
+    {
+        u32Copy = ((u32Len - u32Off) > ISP_PATCH_PAGE_SIZE) ? ISP_PATCH_PAGE_SIZE : (u32Len - u32Off);
+        memcpy(au8Page, &pu8Img[u32Off], u32Copy);
+    }
+    memset(&au8Page[u32Copy], 0xFF, ISP_PATCH_PAGE_SIZE - u32Copy);
+}
+
+/**
+  * @brief      CRC32 as computed by FMC_ISPCMD_RUN_CKS
+  * @param[in]  pu8Buf  Data
+  * @param[in]  u32Len  Length in bytes
+  * @return     CRC32, polynomial 0x04C11DB7 reflected, initial and final XOR 0xFFFFFFFF
+  */
+uint32_t IspPatch_Crc32(const uint8_t *pu8Buf, uint32_t u32Len)
+{
+    uint32_t u32Crc = 0xFFFFFFFFUL, i, j;
+
+    for(i = 0UL; i < u32Len; i++)
+    {
+        u32Crc ^= pu8Buf[i];
+        for(j = 0UL; j < 8UL; j++)
+        {
+            u32Crc = (u32Crc >> 1) ^ ((u32Crc & 1UL) ? 0xEDB88320UL : 0UL);
+        }
+    }
+    return ~u32Crc;
+}
+
+/**
+  * @brief      Largest patch IspPatch_Create can produce for an image
+  * @param[in]  u32NewLen  Length of the new image in bytes
+  * @return     Bytes
+  */
+uint32_t IspPatch_MaxSize(uint32_t u32NewLen)
+{
+    uint32_t u32Pages = (u32NewLen + ISP_PATCH_PAGE_SIZE - 1UL) / ISP_PATCH_PAGE_SIZE;
+
+    return ISP_PATCH_HDR_SIZE + u32Pages * (4UL + 4UL + ISP_PATCH_PAGE_SIZE);
+}
+
+/**
+  * @brief      Build the patch that turns the old image into the new one
+  * @param[in]  pu8Old     Image the target holds now, NULL if unknown
+  * @param[in]  u32OldLen  Length of the old image in bytes
+  * @param[in]  pu8New     Image to program
+  * @param[in]  u32NewLen  Length of the new image in bytes
+  * @param[in]  u32Base    Flash address of the images, page aligned
+  * @param[out] pu8Patch   Patch buffer
+  * @param[in]  u32Max     Size of the patch buffer
+  * @return     Length of the patch, or -1 if an argument is invalid or the buffer is too small
+  * @details    Every page whose padded contents differ is carried; without an old
+  *             image all pages are carried.
+  */
+int32_t IspPatch_Create(const uint8_t *pu8Old, uint32_t u32OldLen, const uint8_t *pu8New, uint32_t u32NewLen,
+                        uint32_t u32Base, uint8_t *pu8Patch, uint32_t u32Max)
+{
+    uint8_t au8Old[ISP_PATCH_PAGE_SIZE], au8New[ISP_PATCH_PAGE_SIZE];
+    uint32_t u32Pages, u32Carried = 0UL, u32Pos, i;
+
+    u32Pages = (u32NewLen + ISP_PATCH_PAGE_SIZE - 1UL) / ISP_PATCH_PAGE_SIZE;
+    if((u32Base % ISP_PATCH_PAGE_SIZE) || (u32Pages == 0UL) || (u32Max < ISP_PATCH_HDR_SIZE + u32Pages * 4UL))
+        return -1;
+
+    Put32(&pu8Patch[0], ISP_PATCH_MAGIC);
+    Put32(&pu8Patch[4], ISP_PATCH_PAGE_SIZE);
+    Put32(&pu8Patch[8], u32Base);
+    Put32(&pu8Patch[12], u32Pages);
+
+    u32Pos = ISP_PATCH_HDR_SIZE + u32Pages * 4UL;
+    for(i = 0UL; i < u32Pages; i++)
+    {
+        GetPage(pu8New, u32NewLen, i, au8New);
+        Put32(&pu8Patch[ISP_PATCH_HDR_SIZE + i * 4UL], IspPatch_Crc32(au8New, ISP_PATCH_PAGE_SIZE));
+
+        if(pu8Old != NULL)
+        {
+            GetPage(pu8Old, u32OldLen, i, au8Old);
+            if(memcmp(au8Old, au8New, ISP_PATCH_PAGE_SIZE) == 0)
+                continue;
+        }
+
+        if(u32Pos + 4UL + ISP_PATCH_PAGE_SIZE > u32Max)
+            return -1;
+        Put32(&pu8Patch[u32Pos], i);
+        memcpy(&pu8Patch[u32Pos + 4UL], au8New, ISP_PATCH_PAGE_SIZE);
+        u32Pos += 4UL + ISP_PATCH_PAGE_SIZE;
+        u32Carried++;
+    }
+
+    Put32(&pu8Patch[16], u32Carried);
+    return (int32_t)u32Pos;
+}
+
+/**
+  * @brief      Check a patch and index it
+  * @param[in]  pu8Patch  Patch
+  * @param[in]  u32Len    Length of the patch in bytes
+  * @param[out] psPatch   Index into the patch buffer, valid while the buffer is
+  * @retval     0   Success
+  * @retval     -1  Not a patch, wrong page size or truncated
+  */
+int32_t IspPatch_Parse(const uint8_t *pu8Patch, uint32_t u32Len, ISP_PATCH_T *psPatch)
+{
+    if((u32Len < ISP_PATCH_HDR_SIZE) || (Get32(&pu8Patch[0]) != ISP_PATCH_MAGIC) ||
+            (Get32(&pu8Patch[4]) != ISP_PATCH_PAGE_SIZE))
+        return -1;
+
+    psPatch->u32Base = Get32(&pu8Patch[8]);
+    psPatch->u32Pages = Get32(&pu8Patch[12]);
+    psPatch->u32Carried = Get32(&pu8Patch[16]);
+
+    if((psPatch->u32Pages == 0UL) || (psPatch->u32Carried > psPatch->u32Pages) ||
+            ((uint64_t)u32Len != ISP_PATCH_HDR_SIZE + (uint64_t)psPatch->u32Pages * 4UL +
+             (uint64_t)psPatch->u32Carried * (4UL + ISP_PATCH_PAGE_SIZE)))
+        return -1;
+
+    psPatch->pu8Crc = &pu8Patch[ISP_PATCH_HDR_SIZE];
+    psPatch->pu8Entry = &pu8Patch[ISP_PATCH_HDR_SIZE + psPatch->u32Pages * 4UL];
+    return 0;
+}
+
+/**
+  * @brief      CRC32 the page must have after the update
+  * @param[in]  psPatch  Parsed patch
+  * @param[in]  u32Page  Page index, less than u32Pages
+  * @return     CRC32
+  */
+uint32_t IspPatch_PageCrc(const ISP_PATCH_T *psPatch, uint32_t u32Page)
+{
+    return Get32(&psPatch->pu8Crc[u32Page * 4UL]);
+}
+
+/**
+  * @brief      New data of a page
+  * @param[in]  psPatch  Parsed patch
+  * @param[in]  u32Page  Page index
+  * @return     ISP_PATCH_PAGE_SIZE bytes, or NULL if the patch does not carry the page
+  */
+const uint8_t *IspPatch_PageData(const ISP_PATCH_T *psPatch, uint32_t u32Page)
+{
+    uint32_t i;
+    const uint8_t *pu8Entry = psPatch->pu8Entry;
+
+    /* Entries are in page order */
+    for(i = 0UL; i < psPatch->u32Carried; i++, pu8Entry += 4UL + ISP_PATCH_PAGE_SIZE)
+    {
+        if(Get32(pu8Entry) == u32Page)
+            return pu8Entry + 4UL;
+        if(Get32(pu8Entry) > u32Page)
+            break;
+    }
+    return NULL;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
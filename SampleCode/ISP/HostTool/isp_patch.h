@@ -0,0 +1,58 @@
+/**************************************************************************//**
+ * @file     isp_patch.h
+ * @version  V1.00
+ * @brief    Page-level firmware patch for the ISP loaders, host side
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __ISP_PATCH_H__
+#define __ISP_PATCH_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*-------------------------------------------------------------*/
+/* Patch file, little endian:
+ *   [0..3]   ISP_PATCH_MAGIC
+ *   [4..7]   page size
+ *   [8..11]  flash address of the first page
+ *   [12..15] pages in the new image, N
+ *   [16..19] pages carried by the patch, M
+ *   [20..]   N x CRC32 of each page of the new image
+ *   then     M x { page index, page data }
+ * The last page of an image is padded with 0xFF, as erased flash reads.
+ * Pages not carried must already hold the new data on the target;
+ * their CRC32 is what proves it.
+ */
+#define ISP_PATCH_MAGIC         0x31504449UL    /* "IDP1" */
+#define ISP_PATCH_HDR_SIZE      20UL
+#define ISP_PATCH_PAGE_SIZE     512UL           /* FMC_FLASH_PAGE_SIZE */
+
+typedef struct
+{
+    uint32_t u32Base;           /* Flash address of page 0 */
+    uint32_t u32Pages;          /* Pages in the new image */
+    uint32_t u32Carried;        /* Pages with data in the patch */
+    const uint8_t *pu8Crc;      /* u32Pages CRC32 values */
+    const uint8_t *pu8Entry;    /* u32Carried page entries */
+} ISP_PATCH_T;
+
+uint32_t IspPatch_Crc32(const uint8_t *pu8Buf, uint32_t u32Len);
+uint32_t IspPatch_MaxSize(uint32_t u32NewLen);
+int32_t  IspPatch_Create(const uint8_t *pu8Old, uint32_t u32OldLen, const uint8_t *pu8New, uint32_t u32NewLen,
+                         uint32_t u32Base, uint8_t *pu8Patch, uint32_t u32Max);
+int32_t  IspPatch_Parse(const uint8_t *pu8Patch, uint32_t u32Len, ISP_PATCH_T *psPatch);
+uint32_t IspPatch_PageCrc(const ISP_PATCH_T *psPatch, uint32_t u32Page);
+const uint8_t *IspPatch_PageData(const ISP_PATCH_T *psPatch, uint32_t u32Page);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __ISP_PATCH_H__ */
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -0,0 +1,176 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Host command line tool for the ISP loaders.
+ * @note     isp_tool patch <old.bin> <new.bin> <out.idp> [base]
+ *             Write the page-level patch from old.bin to new.bin. Use "-" for
+ *             old.bin when the target contents are unknown; every page is
+ *             then carried. base is the flash address of the images, 0 by
+ *             default, e.g. 0x1F000 for Data Flash.
+ *           isp_tool info <patch.idp>
+ *             List the pages a patch carries.
+ *           isp_tool lz <image.bin>
+ *             Show how much CMD_UPDATE_PAGE_LZ saves on each page of an image.
+ *           The patch is applied over any ISP transport with CMD_GET_PAGE_CRC
+ *           and CMD_UPDATE_PAGE, of a loader built with ISP_PAGE_UPDATE (and
+ *           ISP_PAGE_LZ for compressed pages). Build with Linux/Makefile.
+ *
+ * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "isp_patch.h"
+#include "isp_lz.h"
+
+#define MAX_IMAGE_SIZE      (1024UL * 1024UL)
+
+/* 64-byte ISP packets for a page: 48 data bytes in the first, 56 in each one after */
+#define PAGE_PACKETS(len)   (((len) <= 48UL) ? 1UL : (1UL + ((len) - 48UL + 55UL) / 56UL))
+
+static uint8_t *ReadFile(const char *pcName, uint32_t *pu32Len)
+{
+    FILE *fp;
+    uint8_t *pu8Buf;
+    long lLen;
+
+    if((fp = fopen(pcName, "rb")) == NULL)
+        return NULL;
+
+    fseek(fp, 0L, SEEK_END);
+    lLen = ftell(fp);
+    fseek(fp, 0L, SEEK_SET);
+
+    pu8Buf = ((lLen >= 0L) && ((unsigned long)lLen <= MAX_IMAGE_SIZE * 2UL)) ? malloc((size_t)lLen + 1U) : NULL;
+    if((pu8Buf != NULL) && (fread(pu8Buf, 1, (size_t)lLen, fp) != (size_t)lLen))
+    {
+        free(pu8Buf);
+        pu8Buf = NULL;
+    }
+    fclose(fp);
+
+    *pu32Len = (uint32_t)lLen;
+    return pu8Buf;
+}
+
+static int Cmd_Patch(int argc, char *argv[])
+{
+    uint8_t *pu8Old = NULL, *pu8New, *pu8Patch;
+    uint32_t u32OldLen = 0UL, u32NewLen, u32Base = 0UL, u32Max;
+    int32_t i32Len;
+    ISP_PATCH_T sPatch;
+    FILE *fp;
+
+    if(argc > 5)
+        u32Base = (uint32_t)strtoul(argv[5], NULL, 0);
+
+    if((strcmp(argv[2], "-") != 0) && ((pu8Old = ReadFile(argv[2], &u32OldLen)) == NULL))
+    {
+        printf("Cannot read %s\n", argv[2]);
+        return 1;
+    }
+    if(((pu8New = ReadFile(argv[3], &u32NewLen)) == NULL) || (u32NewLen > MAX_IMAGE_SIZE))
+    {
+        printf("Cannot read %s\n", argv[3]);
+        return 1;
+    }
+
+    u32Max = IspPatch_MaxSize(u32NewLen);
+    pu8Patch = malloc(u32Max);
+    i32Len = (pu8Patch != NULL) ? IspPatch_Create(pu8Old, u32OldLen, pu8New, u32NewLen, u32Base, pu8Patch, u32Max) : -1;
+    if(i32Len < 0)
+    {
+        printf("Cannot build the patch; base must be page aligned and the image not empty\n");
+        return 1;
+    }
+
+    if(((fp = fopen(argv[4], "wb")) == NULL) || (fwrite(pu8Patch, 1, (size_t)i32Len, fp) != (size_t)i32Len))
+    {
+        printf("Cannot write %s\n", argv[4]);
+        return 1;
+    }
+    fclose(fp);
+
+    IspPatch_Parse(pu8Patch, (uint32_t)i32Len, &sPatch);
+    printf("%s: %u of %u pages carried, %d bytes (full image %u bytes)\n", argv[4], (unsigned)sPatch.u32Carried,
+           (unsigned)sPatch.u32Pages, (int)i32Len, (unsigned)u32NewLen);
+
+    free(pu8Patch);
+    free(pu8New);
+    free(pu8Old);
+    return 0;
+}
+
+static int Cmd_Info(char *argv[])
+{
+    uint8_t *pu8Patch;
+    uint32_t u32Len, i;
+    ISP_PATCH_T sPatch;
+
+    if(((pu8Patch = ReadFile(argv[2], &u32Len)) == NULL) || (IspPatch_Parse(pu8Patch, u32Len, &sPatch) != 0))
+    {
+        printf("%s is not a patch\n", argv[2]);
+        return 1;
+    }
+
+    printf("Base 0x%08X, %u pages, %u carried\n", (unsigned)sPatch.u32Base, (unsigned)sPatch.u32Pages,
+           (unsigned)sPatch.u32Carried);
+    for(i = 0UL; i < sPatch.u32Pages; i++)
+    {
+        if(IspPatch_PageData(&sPatch, i) != NULL)
+            printf("  0x%08X  CRC32 0x%08X\n", (unsigned)(sPatch.u32Base + i * ISP_PATCH_PAGE_SIZE),
+                   (unsigned)IspPatch_PageCrc(&sPatch, i));
+    }
+
+    free(pu8Patch);
+    return 0;
+}
+
+static int Cmd_Lz(char *argv[])
+{
+    uint8_t *pu8Img, au8Page[ISP_PATCH_PAGE_SIZE], au8Lz[ISP_LZ_MAX_SIZE(ISP_PATCH_PAGE_SIZE)];
+    uint32_t u32Len, u32Off, u32Lz, u32Raw = 0UL, u32Packed = 0UL, u32RawPkt = 0UL, u32LzPkt = 0UL;
+
+    if((pu8Img = ReadFile(argv[2], &u32Len)) == NULL)
+    {
+        printf("Cannot read %s\n", argv[2]);
+        return 1;
+    }
+
+    for(u32Off = 0UL; u32Off < u32Len; u32Off += ISP_PATCH_PAGE_SIZE)
+    {
+        memset(au8Page, 0xFF, sizeof(au8Page));
+        memcpy(au8Page, &pu8Img[u32Off], ((u32Len - u32Off) > ISP_PATCH_PAGE_SIZE) ? ISP_PATCH_PAGE_SIZE : (u32Len - u32Off));
+        u32Lz = (uint32_t)IspLz_Encode(au8Page, ISP_PATCH_PAGE_SIZE, au8Lz, sizeof(au8Lz));
+
+        /* The host sends a page raw when compression saves no packet */
+        u32Raw += ISP_PATCH_PAGE_SIZE;
+        u32Packed += u32Lz;
+        u32RawPkt += PAGE_PACKETS(ISP_PATCH_PAGE_SIZE);
+        u32LzPkt += (PAGE_PACKETS(u32Lz) < PAGE_PACKETS(ISP_PATCH_PAGE_SIZE)) ? PAGE_PACKETS(u32Lz) : PAGE_PACKETS(ISP_PATCH_PAGE_SIZE);
+    }
+
+    printf("%u pages: %u bytes compressed to %u (%.2f:1), %u packets instead of %u\n",
+           (unsigned)(u32Raw / ISP_PATCH_PAGE_SIZE), (unsigned)u32Raw, (unsigned)u32Packed,
+           u32Packed ? (double)u32Raw / u32Packed : 0.0, (unsigned)u32LzPkt, (unsigned)u32RawPkt);
+
+    free(pu8Img);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if((argc >= 5) && (strcmp(argv[1], "patch") == 0))
+        return Cmd_Patch(argc, argv);
+    if((argc == 3) && (strcmp(argv[1], "info") == 0))
+        return Cmd_Info(argv);
+    if((argc == 3) && (strcmp(argv[1], "lz") == 0))
+        return Cmd_Lz(argv);
+
+    printf("usage: isp_tool patch <old.bin|-> <new.bin> <out.idp> [base]\n"
+           "       isp_tool info <patch.idp>\n"
+           "       isp_tool lz <image.bin>\n");
+    return 1;
+}
+
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
@@ -16,16 +16,65 @@
 #define FMC_APROM_SIZE           0x10000
 #define APROM_BLOCK_NUM         ((FMC_APROM_SIZE/TRANSFER_SIZE)-1)
 
-unsigned int command_Count=0;
-
 uint8_t manifest_state = MANIFEST_COMPLETE;
 dfu_status_struct dfu_status;
+
+/* Two block buffers: USB fills one while the main loop programs the other */
 #ifdef __ICCARM__
 #pragma data_alignment=4
-s_prog_struct prog_struct = {{0}, 0, 0, APP_LOADED_ADDR};
+s_prog_struct prog_struct[2] = {{{0}, 0, 0, APP_LOADED_ADDR}, {{0}, 0, 0, APP_LOADED_ADDR}};
 #else
-s_prog_struct prog_struct __attribute__ ((aligned (4))) = {{0}, 0, 0, APP_LOADED_ADDR};
+s_prog_struct prog_struct[2] __attribute__ ((aligned (4))) = {{{0}, 0, 0, APP_LOADED_ADDR}, {{0}, 0, 0, APP_LOADED_ADDR}};
 #endif
+static volatile uint8_t prog_head;      /* Buffer programmed next */
+static volatile uint8_t prog_count;     /* Blocks handed to the main loop and not done yet */
+static volatile uint8_t prog_status;    /* First programming error, reported at the next GETSTATUS */
+static volatile uint32_t prog_time = FLASH_BLOCK_TIMEOUT;   /* ms the last block took */
+
+/* Buffer the next DNLOAD goes to */
+#define PROG_RX_BUF()                  (&prog_struct[(prog_head + prog_count) & 1])
+
+#ifdef __ICCARM__
+#pragma data_alignment=4
+static uint8_t lz_buf[TRANSFER_SIZE];
+#else
+static uint8_t lz_buf[TRANSFER_SIZE] __attribute__ ((aligned (4)));
+#endif
+
+/* Expand a compressed block into lz_buf. Each flag byte covers the next 8 items, LSB
+   first: 0 a literal, 1 a 2-byte match of 3..130 bytes from up to 512 bytes back. */
+static int LzExpand(const uint8_t *src, uint32_t len)
+{
+    uint32_t out = 0, flags = 1, dist, cnt;
+    const uint8_t *end = src + len;
+
+    while (out < TRANSFER_SIZE) {
+        if (flags == 1) {
+            if (src >= end)
+                return -1;
+            flags = *src++ | 0x100;
+        }
+
+        if ((flags & 1) == 0) {
+            if (src >= end)
+                return -1;
+            lz_buf[out++] = *src++;
+        } else {
+            if (src + 2 > end)
+                return -1;
+            dist = (((src[1] & 1) << 8) | src[0]) + 1;
+            cnt = (src[1] >> 1) + 3;
+            src += 2;
+            if (dist > out)
+                return -1;
+            for (; cnt && (out < TRANSFER_SIZE); cnt--, out++)
+                lz_buf[out] = lz_buf[out - dist];
+        }
+        flags >>= 1;
+    }
+
+    return 0;
+}
 
 void USBD_IRQHandler(void)
 {
@@ -139,9 +188,55 @@ void DFU_Init(void)
     dfu_status.bStatus = STATUS_OK;
     dfu_status.bState = STATE_dfuIDLE;
 
-    prog_struct.block_num = 0;
-    prog_struct.data_len = 0;
+    prog_head = 0;
+    prog_count = 0;
+    prog_status = STATUS_OK;
+}
+
+/**
+  * @brief  Program the oldest block the host has sent, if any. Called from the main loop,
+  *         so that the USB interrupt takes the next block meanwhile.
+  * @param  None.
+  * @retval 1 if a block was programmed, 0 if none was waiting.
+  */
+int DFU_Poll(void)
+{
+    s_prog_struct *p;
+    uint32_t addr, frame;
+    uint8_t status = STATUS_OK;
+
+    if(prog_count == 0)
+        return 0;
+
+    p = &prog_struct[prog_head];
+    frame = USBD->FN;
+
+    /* Erase each page as programming reaches it */
+    addr = (p->block_num & ~DFU_BLOCK_LZ)*TRANSFER_SIZE;
+    if(((addr & (FMC_FLASH_PAGE_SIZE-1)) == 0) && (FMC_Erase_User(addr) != 0))
+        status = STATUS_errWRITE;
+    else if(p->block_num & DFU_BLOCK_LZ)
+    {
+        /* Compressed block, always a whole TRANSFER_SIZE */
+        if(LzExpand(p->buf, p->data_len) != 0)
+            status = STATUS_errFILE;
+        else if(WriteData(addr, addr+TRANSFER_SIZE, (uint32_t *)lz_buf) != 0)
+            status = STATUS_errWRITE;
+    }
+    else if(WriteData(addr, addr+p->data_len, (uint32_t *)p->buf) != 0)
+        status = STATUS_errWRITE;
+
+    /* The frame number counts milliseconds; round up for the frame already begun */
+    prog_time = ((USBD->FN - frame) & USBD_FN_FN_Msk) + 1;
+
+    __disable_irq();
+    if(prog_status == STATUS_OK)
+        prog_status = status;
+    prog_head ^= 1;
+    prog_count--;
+    __enable_irq();
 
+    return 1;
 }
 
 
@@ -162,38 +257,48 @@ void DFU_ClassRequest(void)
              {
                  if(dfu_status.bState == STATE_dfuDNLOAD_SYNC)
                  {
-                     command_Count++;
-                     if(command_Count==5)
-                     {
-                         dfu_status.bState =STATE_dfuDNLOAD_IDLE;
-             
-                         if(WriteData(prog_struct.block_num*TRANSFER_SIZE, (prog_struct.block_num*TRANSFER_SIZE)+prog_struct.data_len, (unsigned int *)prog_struct.buf) !=0)
-                            dfu_status.bStatus = STATUS_errWRITE;
-             
-                         command_Count=0;
-                     }
+                     /* The block is in, the main loop programs it from here */
+                     prog_count++;
+                     dfu_status.bState = STATE_dfuDNBUSY;
                  }
 
-                 if(dfu_status.bState == STATE_dfuDNLOAD_IDLE)
+                 if(dfu_status.bState == STATE_dfuDNBUSY)
                  {
-                     command_Count++;
-                     if(command_Count==5)
+                     /* The next block is welcome while a buffer is free, else after the block in hand */
+                     if(prog_count < 2)
+                     {
+                         dfu_status.bState = STATE_dfuDNLOAD_IDLE;
+                         SET_POLLING_TIMEOUT(0);
+                     }
+                     else
                      {
-                         dfu_status.bState =STATE_dfuMANIFEST_SYNC;
-                         command_Count=0;
+                         SET_POLLING_TIMEOUT(prog_time);
                      }
                  }
 
-                 if(dfu_status.bState == STATE_dfuMANIFEST_SYNC)
+                 if((dfu_status.bState == STATE_dfuMANIFEST_SYNC) || (dfu_status.bState == STATE_dfuMANIFEST))
                  {
-                     command_Count++;
-                     if(command_Count==5)
+                     /* Done once the last blocks are in flash */
+                     if(prog_count)
+                     {
+                         dfu_status.bState = STATE_dfuMANIFEST;
+                         SET_POLLING_TIMEOUT(prog_time*prog_count);
+                     }
+                     else
                      {
-                         dfu_status.bState =STATE_dfuIDLE;
-                         command_Count=0;
+                         manifest_state = MANIFEST_COMPLETE;
+                         dfu_status.bState = STATE_dfuIDLE;
+                         SET_POLLING_TIMEOUT(0);
                      }
                  }
-             
+
+                 if(prog_status != STATUS_OK)
+                 {
+                     dfu_status.bStatus = prog_status;
+                     dfu_status.bState = STATE_dfuERROR;
+                     SET_POLLING_TIMEOUT(0);
+                 }
+
                  USBD_PrepareCtrlIn((uint8_t *)&dfu_status.bStatus, 6);
                  USBD_PrepareCtrlOut(0,0);
                  break;
@@ -222,7 +327,7 @@ void DFU_ClassRequest(void)
                             dfu_status.bState = STATE_dfuUPLOAD_IDLE;
                          }
              
-                         if(wValue > APROM_BLOCK_NUM)
+                         if((wValue > APROM_BLOCK_NUM) || (wLength > TRANSFER_SIZE) || (prog_count > 1))
                          {
                             dfu_status.bState = STATE_dfuIDLE;
                             USBD_PrepareCtrlIn(0,0);
@@ -230,8 +335,8 @@ void DFU_ClassRequest(void)
                             break;
                          }
 
-                         ReadData(wValue*TRANSFER_SIZE, (wValue*TRANSFER_SIZE)+wLength, (unsigned int *)prog_struct.buf);
-                         USBD_PrepareCtrlIn((uint8_t *)prog_struct.buf, wLength);
+                         ReadData(wValue*TRANSFER_SIZE, (wValue*TRANSFER_SIZE)+wLength, (uint32_t *)PROG_RX_BUF()->buf);
+                         USBD_PrepareCtrlIn((uint8_t *)PROG_RX_BUF()->buf, wLength);
                      }
                      
                      USBD_PrepareCtrlOut(0,0);
@@ -265,8 +370,8 @@ void DFU_ClassRequest(void)
                           dfu_status.bStatus = STATUS_OK;
                           dfu_status.bState = STATE_dfuIDLE;
                           dfu_status.iString = 0; /* iString */
-                          prog_struct.block_num = 0;
-                          prog_struct.data_len = 0;
+                          if(prog_count > 1)
+                              prog_count = 1;   /* Drop the block not started yet */
                           break;
 
                      default:
@@ -281,11 +386,18 @@ void DFU_ClassRequest(void)
                  {
                      case STATE_dfuIDLE:
                      case STATE_dfuDNLOAD_IDLE:
+                         if ((wLength > TRANSFER_SIZE) || (prog_count > 1))
+                         {
+                             /* Setup error, stall the device */
+                             USBD_SetStall(0);
+                             break;
+                         }
+
                          if (wLength > 0) 
                          {
-                             /* update the global length and block number */
-                             prog_struct.block_num = wValue;
-                             prog_struct.data_len = wLength;
+                             /* update the length and block number of the free buffer */
+                             PROG_RX_BUF()->block_num = wValue;
+                             PROG_RX_BUF()->data_len = wLength;
                              dfu_status.bState = STATE_dfuDNLOAD_SYNC;
                              
                          }
@@ -297,7 +409,7 @@ void DFU_ClassRequest(void)
                          }
 
                           /* enable EP0 prepare receive the buffer */
-                           USBD_PrepareCtrlOut((uint8_t *)prog_struct.buf, wLength);
+                           USBD_PrepareCtrlOut((uint8_t *)PROG_RX_BUF()->buf, wLength);
                            USBD_PrepareCtrlIn(0,0);
                          break;
                  }
@@ -310,6 +422,9 @@ void DFU_ClassRequest(void)
                  //  if (STATE_dfuERROR == dfu_status.bState) {
                  dfu_status.bStatus = STATUS_OK;
                  dfu_status.bState = STATE_dfuIDLE;
+                 prog_status = STATUS_OK;
+                 if(prog_count > 1)
+                     prog_count = 1;    /* Drop the block not started yet */
                  // } //else {
                  /* state Error */
                  // dfu_status.bStatus = STATUS_errUNKNOWN;
@@ -317,6 +432,7 @@ void DFU_ClassRequest(void)
                  // }
              
                  dfu_status.iString = 0; /* iString: index = 0 */
+                 USBD_PrepareCtrlIn(0,0);
                  break;
              
              }
@@ -335,14 +451,16 @@ void DFU_ClassRequest(void)
                          dfu_status.bState = STATE_dfuIDLE;
                          dfu_status.iString = 0; /* iString: index = 0 */
                      
-                         prog_struct.block_num = 0;
-                         prog_struct.data_len = 0;
+                         if(prog_count > 1)
+                             prog_count = 1;    /* Drop the block not started yet */
                          break;
 
                      default:
                          break;
                  }
-             
+
+                 USBD_PrepareCtrlIn(0,0);
+                 break;
              }
 
 
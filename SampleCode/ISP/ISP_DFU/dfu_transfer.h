@@ -17,7 +17,7 @@
 /* Define EP maximum packet size */
 #define EP0_MAX_PKT_SIZE               64
 #define EP1_MAX_PKT_SIZE               EP0_MAX_PKT_SIZE
-#define TRANSFER_SIZE                  512
+#define TRANSFER_SIZE                  512     /* wTransferSize, one flash page */
 #define SETUP_BUF_BASE                 0
 #define SETUP_BUF_LEN                  8
 #define EP0_BUF_BASE                   (SETUP_BUF_BASE + SETUP_BUF_LEN)
@@ -58,6 +58,10 @@
 
 #define FLASH_ERASE_TIMEOUT            60
 #define FLASH_WRITE_TIMEOUT            80
+#define FLASH_BLOCK_TIMEOUT            6       /* ms to erase and program a block, until one has been timed */
+
+/* wValue bit of DFU_DNLOAD: the block is LZ compressed and expands to TRANSFER_SIZE bytes */
+#define DFU_BLOCK_LZ                   0x8000
 
 
 /* bit detach capable = bit 3 in bmAttributes field */
@@ -151,6 +155,7 @@ typedef struct
 /*-------------------------------------------------------------*/
 void DFU_Init(void);
 void DFU_ClassRequest(void);
+int DFU_Poll(void);
 void HID_SetInReport(void);
 void HID_GetOutReport(uint8_t *pu8EpBuf, uint32_t u32Size);
 
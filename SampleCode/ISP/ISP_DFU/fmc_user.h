@@ -1,34 +0,0 @@
-/**************************************************************************//**
- * @file     fmc_user.h
- * @brief    M031 series FMC driver header file
- * @version  2.0.0
- *
- * @copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
- ******************************************************************************/
-#ifndef FMC_USER_H
-#define FMC_USER_H
-
-#include "NuMicro.h"
-
-#define Config0         FMC_CONFIG_BASE
-#define Config1         (FMC_CONFIG_BASE+4)
-
-#define ISPGO           0x01
-
-/*---------------------------------------------------------------------------------------------------------*/
-/* Define parameter                                                                                        */
-/*---------------------------------------------------------------------------------------------------------*/
-
-/*---------------------------------------------------------------------------------------------------------*/
-/*  FMC Macro Definitions                                                                                  */
-/*---------------------------------------------------------------------------------------------------------*/
-#define _FMC_ENABLE_CFG_UPDATE()   (FMC->ISPCTL |=  FMC_ISPCTL_CFGUEN_Msk) /*!< Enable CONFIG Update Function  */
-#define _FMC_DISABLE_CFG_UPDATE()  (FMC->ISPCTL &= ~FMC_ISPCTL_CFGUEN_Msk) /*!< Disable CONFIG Update Function */
-
-
-int ReadData(unsigned int addr_start, unsigned int addr_end, unsigned int *data);
-int WriteData(unsigned int addr_start, unsigned int addr_end, unsigned int *data);
-
-
-#endif
-
@@ -97,7 +97,11 @@ int32_t main(void)
     /* Enable USB device interrupt */
     NVIC_EnableIRQ(USBD_IRQn);
 
-    while(1);
+    /* Program the blocks USB brings in */
+    while(1)
+    {
+        DFU_Poll();
+    }
 
 _APROM:
     SYS->RSTSTS = (SYS_RSTSTS_PORF_Msk | SYS_RSTSTS_PINRF_Msk);
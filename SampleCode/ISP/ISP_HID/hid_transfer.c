@@ -16,10 +16,8 @@
 
 #ifdef __ICCARM__
 #pragma data_alignment=4
-extern uint8_t response_buff[64];
 uint8_t usb_rcvbuf[64];
 #else
-extern uint8_t response_buff[64] __attribute__((aligned(4)));
 uint8_t usb_rcvbuf[64] __attribute__((aligned(4)));
 #endif
 uint8_t bUsbDataReady;
@@ -279,4 +277,22 @@ void HID_ClassRequest(void)
         }
     }
 }
+/*--------------------------------------------------------------------------*/
+/* ISP transport                                                            */
+/*--------------------------------------------------------------------------*/
+static uint8_t *HID_RecvFrame(void)
+{
+    return (bUsbDataReady == TRUE) ? usb_rcvbuf : NULL;
+}
+
+static void HID_SendFrame(uint8_t *buf, uint32_t len)
+{
+    (void)buf;
+    (void)len;
+    EP2_Handler();
+    bUsbDataReady = FALSE;
+}
+
+const ISP_TRANSPORT_T g_sHidTransport = { HID_RecvFrame, HID_SendFrame, NULL };
+
 
@@ -11,6 +11,8 @@
 #ifndef __USBD_HID_H__
 #define __USBD_HID_H__
 
+#include "isp_user.h"
+
 /* Define the vendor id and product id */
 #define USBD_VID        0x0416
 #define USBD_PID        0x3F00
@@ -67,6 +69,8 @@
 /*-------------------------------------------------------------*/
 
 extern uint8_t bUsbDataReady;
+extern uint8_t usb_rcvbuf[64];
+extern const ISP_TRANSPORT_T g_sHidTransport;
 
 /*-------------------------------------------------------------*/
 void HID_Init(void);
@@ -90,12 +90,7 @@ int32_t main(void)
 
     while (DetectPin == 0)
     {
-        if (bUsbDataReady == TRUE)
-        {
-            ParseCmd((uint8_t *)usb_rcvbuf, EP3_MAX_PKT_SIZE);
-            EP2_Handler();
-            bUsbDataReady = FALSE;
-        }
+        ISP_Poll(&g_sHidTransport);
     }
 
 _APROM:
@@ -8,12 +8,14 @@
  * Copyright (C) 2017 Nuvoton Technology Corp. All rights reserved.
  ******************************************************************************/
 #include <stdio.h>
+#include <string.h>
 #include "targetdev.h"
 
 /*---------------------------------------------------------------------------------------------------------*/
 /* Global variables                                                                                        */
 /*---------------------------------------------------------------------------------------------------------*/
 uint8_t i2c_rcvbuf[64];
+volatile uint8_t bISPDataReady;
 volatile uint8_t bI2cDataReady;
 
 volatile uint8_t g_u8DeviceAddr = 0x60;
@@ -168,4 +170,32 @@ void I2C_SlaveTRx(I2C_T *i2c, uint32_t u32Status)
     }
 }
 
+/*---------------------------------------------------------------------------------------------------------*/
+/* ISP transport                                                                                           */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint8_t *I2C_RecvFrame(void)
+{
+    static uint32_t cmd_buff[16];
+
+    if (bI2cDataReady == 0)
+    {
+        return NULL;
+    }
+
+    memcpy(cmd_buff, i2c_rcvbuf, 64);
+    bI2cDataReady = 0;
+    return (uint8_t *)cmd_buff;
+}
+
+// The master clocks response_buff out once bISPDataReady is set
+static void I2C_SendFrame(uint8_t *buf, uint32_t len)
+{
+    (void)buf;
+    (void)len;
+    bISPDataReady = 1;
+#ifdef ReadyPin
+    ReadyPin = 0;
+#endif
+}
 
+const ISP_TRANSPORT_T g_sI2cTransport = { I2C_RecvFrame, I2C_SendFrame, NULL };
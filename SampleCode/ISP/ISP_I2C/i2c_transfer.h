@@ -9,8 +9,11 @@
 #ifndef __I2C_TRANS_H__
 #define __I2C_TRANS_H__
 #include <stdint.h>
+#include "isp_user.h"
 
 extern volatile uint8_t bI2cDataReady;
+extern volatile uint8_t bISPDataReady;
+extern const ISP_TRANSPORT_T g_sI2cTransport;
 extern uint8_t i2c_rcvbuf[];
 
 /*-------------------------------------------------------------*/
@@ -46,7 +46,6 @@ void SYS_Init(void)
 
 int main(void)
 {
-    uint32_t cmd_buff[16];
     SYS_Init();
 
     /* Checking if flash page size matches with target chip's */
@@ -95,16 +94,7 @@ _ISP:
 
     while (1)
     {
-        if (bI2cDataReady == 1)
-        {
-            memcpy(cmd_buff, i2c_rcvbuf, 64);
-            bI2cDataReady = 0;
-            ParseCmd((unsigned char *)cmd_buff, 64);
-            bISPDataReady = 1;
-#ifdef ReadyPin
-            ReadyPin = 0;
-#endif
-        }
+        ISP_Poll(&g_sI2cTransport);
     }
 
 _APROM:
@@ -0,0 +1,126 @@
+/**************************************************************************//**
+ * @file     isp_mcast.c
+ * @brief    RS485 multicast programming source file
+ *
+ * @note
+ * The pages of an image come in parts to a group address, with nothing sent back. A node
+ * collects the parts of one page at a time and programs the page once it is whole and its
+ * CRC32 checks out; a page it missed a part of, or got a bad part of, stays missing. The
+ * host asks each node for the pages missing afterwards and sends just those again.
+ *
+ * Copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "isp_user.h"
+#include "isp_mcast.h"
+
+#ifdef __ICCARM__
+#pragma data_alignment=4
+static uint8_t mcast_buf[FMC_FLASH_PAGE_SIZE];
+#else
+static uint8_t mcast_buf[FMC_FLASH_PAGE_SIZE] __attribute__((aligned(4)));
+#endif
+
+static uint32_t McastBase, McastLen;                /* Image, 0 length if none */
+static uint32_t McastDone[MCAST_MAX_PAGES / 32];    /* Pages of the image in flash */
+static uint32_t McastAddr, McastCrc;                /* Page being collected */
+static uint32_t McastParts[(MCAST_PARTS + 31) / 32];    /* Its parts in */
+static uint32_t McastGot;                           /* Number of them */
+
+/* Page aligned image inside APROM or inside Data Flash */
+void McastStart(uint32_t u32Addr, uint32_t u32Len)
+{
+    uint32_t u32ApLimit = (g_apromSize < g_dataFlashAddr) ? g_apromSize : g_dataFlashAddr;
+    uint32_t u32End = u32Addr + ((u32Len + FMC_FLASH_PAGE_SIZE - 1) & ~(FMC_FLASH_PAGE_SIZE - 1));
+
+    memset(McastDone, 0, sizeof(McastDone));
+    memset(McastParts, 0, sizeof(McastParts));
+    McastGot = 0;
+    McastLen = 0;
+
+    if ((u32Len == 0) || (u32Addr & (FMC_FLASH_PAGE_SIZE - 1)) || (u32End <= u32Addr) ||
+            (u32End - u32Addr > MCAST_MAX_PAGES * FMC_FLASH_PAGE_SIZE) ||
+            ((u32End > u32ApLimit) && ((u32Addr < g_dataFlashAddr) || (u32End > g_dataFlashAddr + g_dataFlashSize))))
+    {
+        return;
+    }
+
+    McastBase = u32Addr;
+    McastLen = u32End - u32Addr;
+}
+
+void McastPage(unsigned char *arg, uint32_t locked)
+{
+    uint32_t u32Addr = inpw(arg) & ~(FMC_FLASH_PAGE_SIZE - 1);
+    uint32_t u32Part = inpw(arg) & (FMC_FLASH_PAGE_SIZE - 1);
+    uint32_t u32Crc = inpw(arg + 4), u32Page, u32Len;
+
+    if (locked || (u32Addr < McastBase) || (u32Addr - McastBase >= McastLen) || (u32Part >= MCAST_PARTS))
+    {
+        return;
+    }
+
+    u32Page = (u32Addr - McastBase) / FMC_FLASH_PAGE_SIZE;
+
+    if (McastDone[u32Page / 32] & (1UL << (u32Page % 32)))
+    {
+        return;     /* Sent again for another node */
+    }
+
+    if ((u32Addr != McastAddr) || (u32Crc != McastCrc))
+    {
+        /* A new page; the one being collected stays missing */
+        McastAddr = u32Addr;
+        McastCrc = u32Crc;
+        memset(McastParts, 0, sizeof(McastParts));
+        McastGot = 0;
+    }
+
+    u32Len = FMC_FLASH_PAGE_SIZE - u32Part * MCAST_PART_SIZE;
+    memcpy(&mcast_buf[u32Part * MCAST_PART_SIZE], arg + 8, (u32Len < MCAST_PART_SIZE) ? u32Len : MCAST_PART_SIZE);
+
+    if ((McastParts[u32Part / 32] & (1UL << (u32Part % 32))) == 0)
+    {
+        McastParts[u32Part / 32] |= (1UL << (u32Part % 32));
+        McastGot++;
+    }
+
+    if (McastGot != MCAST_PARTS)
+    {
+        return;
+    }
+
+    memset(McastParts, 0, sizeof(McastParts));
+    McastGot = 0;
+
+    if (Crc32Calc((uint32_t *)mcast_buf, FMC_FLASH_PAGE_SIZE) != u32Crc)
+    {
+        return;     /* A part went wrong on the line */
+    }
+
+    if ((GetCRC32(u32Addr, FMC_FLASH_PAGE_SIZE) == u32Crc) ||
+            ((FMC_Erase_User(u32Addr) == 0) &&
+             (WriteData(u32Addr, u32Addr + FMC_FLASH_PAGE_SIZE, (uint32_t *)mcast_buf) == 0) &&
+             (GetCRC32(u32Addr, FMC_FLASH_PAGE_SIZE) == u32Crc)))
+    {
+        McastDone[u32Page / 32] |= (1UL << (u32Page % 32));
+    }
+}
+
+void McastStatus(uint8_t *response, uint32_t locked)
+{
+    uint32_t u32Pages = McastLen / FMC_FLASH_PAGE_SIZE, u32Missing = 0, i;
+
+    memset(response + 16, 0, MCAST_MAX_PAGES / 8);
+
+    for (i = 0; i < u32Pages; i++)
+    {
+        if ((McastDone[i / 32] & (1UL << (i % 32))) == 0)
+        {
+            response[16 + i / 8] |= (1 << (i % 8));
+            u32Missing++;
+        }
+    }
+
+    outpw(response + 8, (McastLen && !locked) ? GetCRC32(McastBase, McastLen) : 0);
+    outpw(response + 12, u32Missing);
+}
@@ -0,0 +1,40 @@
+/**************************************************************************//**
+ * @file     isp_mcast.h
+ * @brief    RS485 multicast programming header file
+ *
+ * @note
+ * Copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef ISP_MCAST_H
+#define ISP_MCAST_H
+
+#include <stdint.h>
+
+/*-------------------------------------------------------------*/
+/* On the multidrop bus every request starts with an address byte, 9th bit set. A node
+ * answers the requests to its own address. Requests to its group address are taken
+ * without an answer, so the host sends an image once for all the nodes of a group:
+ *   CMD_MCAST_GROUP   to the node: [8] group address in; [8] node, [12] group address out
+ *   CMD_MCAST_START   [8] flash address, [12] length of the image; no page is in yet
+ *   CMD_MCAST_PAGE    [8] page address + part number, [12] CRC32 of the page,
+ *                     [16..63] MCAST_PART_SIZE bytes from part number x MCAST_PART_SIZE
+ *   CMD_MCAST_STATUS  to the node: [8] CRC32 of the image in flash, [12] pages missing,
+ *                     [16..] bitmap of the pages missing, LSB first
+ * A page is programmed once all its parts are in and their CRC32 matches; a page that
+ * already holds the data is left as it is. The host pauses MCAST_PAGE_MS after the last
+ * part of a page, as the erase stalls the CPU for longer than the RX FIFO lasts. Pages
+ * reported missing go again, to the group or with CMD_UPDATE_PAGE to one node.
+ */
+#define RS485_ADDR_ALL          0xFF    /* Group of every node until CMD_MCAST_GROUP */
+
+#define MCAST_PART_SIZE         48
+#define MCAST_PARTS             ((FMC_FLASH_PAGE_SIZE + MCAST_PART_SIZE - 1) / MCAST_PART_SIZE)
+#define MCAST_PAGE_MS           5
+/* Largest image, the whole APROM of the biggest part in pages of either size */
+#define MCAST_MAX_PAGES         256
+
+void McastStart(uint32_t u32Addr, uint32_t u32Len);
+void McastPage(unsigned char *arg, uint32_t locked);
+void McastStatus(uint8_t *response, uint32_t locked);
+
+#endif  /* ISP_MCAST_H */
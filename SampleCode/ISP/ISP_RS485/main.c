@@ -11,10 +11,6 @@
 #include "targetdev.h"
 #include "uart_transfer.h"
 
-#define nRTSPin                 (PA0)
-#define RECEIVE_MODE            (0)
-#define TRANSMIT_MODE           (1)
-
 void SYS_Init(void)
 {
     /*---------------------------------------------------------------------------------------------------------*/
@@ -113,19 +109,7 @@ _ISP:
 
     while (1)
     {
-        if (bUartDataReady == TRUE)
-        {
-            bUartDataReady = FALSE;
-            ParseCmd(uart_rcvbuf, 64);
-            NVIC_DisableIRQ(UART13_IRQn);
-            nRTSPin = TRANSMIT_MODE;
-            PutString();
-
-            while ((UART1->FIFOSTS & UART_FIFOSTS_TXEMPTYF_Msk) == 0);
-
-            nRTSPin = RECEIVE_MODE;
-            NVIC_EnableIRQ(UART13_IRQn);
-        }
+        ISP_Poll(&g_sUartTransport);
     }
 
 _APROM:
@@ -18,4 +18,3 @@
 #define UART_N_IRQHandler       UART02_IRQHandler
 #define UART_N_IRQn                 UART02_IRQn
 
-#define CONFIG_SIZE 8 // in bytes
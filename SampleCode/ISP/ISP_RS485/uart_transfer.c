@@ -12,6 +12,7 @@
 #include <string.h>
 #include "NuMicro.h"
 #include "uart_transfer.h"
+#include "isp_mcast.h"
 
 #ifdef __ICCARM__
 #pragma data_alignment=4
@@ -22,13 +23,59 @@ __attribute__((aligned(4))) uint8_t uart_rcvbuf[MAX_PKT_SIZE] = {0};
 
 uint8_t volatile bUartDataReady = 0;
 uint8_t volatile bufhead = 0;
+uint8_t g_u8NodeAddr = RS485_NODE_ADDR;
 
+#if RS485_MULTIDROP
+static uint8_t s_u8Group = RS485_ADDR_ALL;
+static uint8_t volatile s_u8RxAddr, s_u8FrameAddr;
+#endif
 
 /* please check "targetdev.h" for chip specifc define option */
 
 /*---------------------------------------------------------------------------------------------------------*/
 /* INTSTS to handle UART Channel 1 interrupt event                                                            */
 /*---------------------------------------------------------------------------------------------------------*/
+#if RS485_MULTIDROP
+void UART13_IRQHandler(void)
+{
+    uint8_t u8Data;
+
+    /* One byte per interrupt, so ADDRDETF is about the byte at the head of the FIFO */
+    while ((UART1->FIFOSTS & UART_FIFOSTS_RXEMPTY_Msk) == 0)
+    {
+        if (UART1->FIFOSTS & UART_FIFOSTS_ADDRDETF_Msk)
+        {
+            u8Data = UART1->DAT;
+            UART1->FIFOSTS = UART_FIFOSTS_ADDRDETF_Msk;
+            bufhead = 0;
+
+            /* NMM leaves the address filter to software: the node and its group */
+            if ((u8Data == g_u8NodeAddr) || (u8Data == s_u8Group))
+            {
+                s_u8RxAddr = u8Data;
+                UART1->FIFO &= ~UART_FIFO_RXOFF_Msk;
+            }
+            else
+            {
+                UART1->FIFO |= UART_FIFO_RXOFF_Msk;
+            }
+        }
+        else
+        {
+            uart_rcvbuf[bufhead++] = UART1->DAT;
+
+            if (bufhead == MAX_PKT_SIZE)
+            {
+                /* Anything after the frame waits for the next address byte */
+                UART1->FIFO |= UART_FIFO_RXOFF_Msk;
+                s_u8FrameAddr = s_u8RxAddr;
+                bUartDataReady = TRUE;
+                bufhead = 0;
+            }
+        }
+    }
+}
+#else
 void UART13_IRQHandler(void)
 {
     /*----- Determine interrupt source -----*/
@@ -52,24 +99,7 @@ void UART13_IRQHandler(void)
         bufhead = 0;
     }
 }
-#ifdef __ICCARM__
-#pragma data_alignment=4
-extern uint8_t response_buff[64];
-#else
-extern __attribute__((aligned(4))) uint8_t response_buff[64];
-#endif 
-void PutString(void)
-{
-    uint32_t i;
-
-    for (i = 0; i < MAX_PKT_SIZE; i++)
-    {
-        while ((UART1->FIFOSTS & UART_FIFOSTS_TXFULL_Msk));
-
-        UART1->DAT = response_buff[i];
-    }
-}
-
+#endif
 void UART_Init()
 {
     /*---------------------------------------------------------------------------------------------------------*/
@@ -77,10 +107,21 @@ void UART_Init()
     /*---------------------------------------------------------------------------------------------------------*/
     /* Select UART function mode */
     UART1->FUNCSEL = ((UART1->FUNCSEL & (~UART_FUNCSEL_FUNCSEL_Msk)) | UART_FUNCSEL_MODE);
+#if RS485_MULTIDROP
+    /* As UART_SelectRS485Mode(UART1, UART_ALTCTL_RS485NMM_Msk | UART_ALTCTL_ADDRDEN_Msk, 0); AAD
+       would match one address only */
+    UART1->ALTCTL = (UART1->ALTCTL & ~(UART_ALTCTL_RS485NMM_Msk | UART_ALTCTL_RS485AUD_Msk | UART_ALTCTL_RS485AAD_Msk |
+                                       UART_ALTCTL_ADDRMV_Msk)) | UART_ALTCTL_RS485NMM_Msk | UART_ALTCTL_ADDRDEN_Msk;
+    /* The 9th bit marks address bytes; what the node sends has it clear */
+    UART1->LINE = UART_WORD_LEN_8 | UART_PARITY_SPACE | UART_STOP_BIT_1;
+    /* Receive nothing but address bytes until one is for this node */
+    UART1->FIFO = UART_FIFO_RFITL_1BYTE | UART_FIFO_RTSTRGLV_14BYTES | UART_FIFO_RXOFF_Msk;
+#else
     /* Set UART line configuration */
     UART1->LINE = UART_WORD_LEN_8 | UART_PARITY_NONE | UART_STOP_BIT_1;
     /* Set UART Rx and RTS trigger level */
     UART1->FIFO = UART_FIFO_RFITL_14BYTES | UART_FIFO_RTSTRGLV_14BYTES;
+#endif
     /* Set UART baud rate */
     UART1->BAUD = (UART_BAUD_MODE2 | UART_BAUD_MODE2_DIVIDER(__HIRC, 115200));
     /* Set time-out interrupt comparator */
@@ -91,3 +132,92 @@ void UART_Init()
     UART1->INTEN = (UART_INTEN_TOCNTEN_Msk | UART_INTEN_RXTOIEN_Msk | UART_INTEN_RDAIEN_Msk);
 }
 
+/*---------------------------------------------------------------------------------------------------------*/
+/* ISP transport                                                                                           */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint8_t *UART_RecvFrame(void)
+{
+    if (bUartDataReady == FALSE)
+    {
+        return NULL;
+    }
+
+    bUartDataReady = FALSE;
+#if RS485_MULTIDROP
+
+    /* Nothing that can do harm if a bit flips on the way, as no answer shows it */
+    if ((s_u8FrameAddr != g_u8NodeAddr) && (inpw(uart_rcvbuf) != CMD_CONNECT) &&
+            (inpw(uart_rcvbuf) != CMD_MCAST_START) && (inpw(uart_rcvbuf) != CMD_MCAST_PAGE))
+    {
+        return NULL;
+    }
+
+#endif
+    return uart_rcvbuf;
+}
+
+// Drive the bus only while the response goes out
+static void UART_SendFrame(uint8_t *buf, uint32_t len)
+{
+#if RS485_MULTIDROP
+
+    if (s_u8FrameAddr != g_u8NodeAddr)
+    {
+        return;     /* Request to the group */
+    }
+
+#endif
+    NVIC_DisableIRQ(UART13_IRQn);
+    nRTSPin = TRANSMIT_MODE;
+
+    while (len--)
+    {
+        while ((UART1->FIFOSTS & UART_FIFOSTS_TXFULL_Msk));
+
+        UART1->DAT = *buf++;
+    }
+
+    while ((UART1->FIFOSTS & UART_FIFOSTS_TXEMPTYF_Msk) == 0);
+
+    nRTSPin = RECEIVE_MODE;
+    NVIC_EnableIRQ(UART13_IRQn);
+}
+
+#if RS485_MULTIDROP
+/* Multicast programming only works on the multidrop bus */
+static int UART_Command(uint32_t cmd, unsigned char *arg, uint8_t *response, uint32_t locked)
+{
+    if (cmd == CMD_MCAST_GROUP)
+    {
+        if (inpw(arg) != g_u8NodeAddr)
+        {
+            s_u8Group = (uint8_t)inpw(arg);
+        }
+
+        outpw(response + 8, g_u8NodeAddr);
+        outpw(response + 12, s_u8Group);
+        return TRUE;
+    }
+    else if (cmd == CMD_MCAST_START)
+    {
+        McastStart(inpw(arg), inpw(arg + 4));
+        return TRUE;
+    }
+    else if (cmd == CMD_MCAST_PAGE)
+    {
+        McastPage(arg, locked);
+        return TRUE;
+    }
+    else if (cmd == CMD_MCAST_STATUS)
+    {
+        McastStatus(response, locked);
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+const ISP_TRANSPORT_T g_sUartTransport = { UART_RecvFrame, UART_SendFrame, UART_Command };
+#else
+const ISP_TRANSPORT_T g_sUartTransport = { UART_RecvFrame, UART_SendFrame, NULL };
+#endif
@@ -10,21 +10,38 @@
 #ifndef __UART_TRANS_H__
 #define __UART_TRANS_H__
 #include <stdint.h>
+#include "isp_user.h"
 
 /*-------------------------------------------------------------*/
 /* Define maximum packet size */
 #define MAX_PKT_SIZE            64
 
+/* 9-bit multidrop bus with node and group addresses and the CMD_MCAST_* commands of
+   isp_mcast.h. 0 keeps the plain 8N1 link of the ISP tool; on in the ISP_RS485_Features
+   target and the Features configuration. */
+#ifndef RS485_MULTIDROP
+#define RS485_MULTIDROP         0
+#endif
+/* Address of this node on the multidrop bus; g_u8NodeAddr may be set from board straps
+   before UART_Init() */
+#define RS485_NODE_ADDR         0x01
+
+/* RS485 transceiver direction */
+#define nRTSPin                 (PA0)
+#define RECEIVE_MODE            (0)
+#define TRANSMIT_MODE           (1)
+
 /*-------------------------------------------------------------*/
 
 extern uint8_t  uart_rcvbuf[];
 extern uint8_t volatile bUartDataReady;
 extern uint8_t volatile bufhead;
+extern uint8_t g_u8NodeAddr;
+extern const ISP_TRANSPORT_T g_sUartTransport;
 
 /*-------------------------------------------------------------*/
 void UART_Init(void);
 void UART0_IRQHandler(void);
-void PutString(void);
 
 #include "clk.h"
 ///*---------------------------------------------------------------------------------------------------------*/
@@ -35,7 +52,11 @@ void PutString(void);
 //#define UART_FUNCSEL_IrDA  (0x2ul << UART_FUNCSEL_FUNCSEL_Pos) /*!< UART_FUNCSEL setting to set IrDA Function            \hideinitializer */
 //#define UART_FUNCSEL_RS485 (0x3ul << UART_FUNCSEL_FUNCSEL_Pos) /*!< UART_FUNCSEL setting to set RS485 Function           \hideinitializer */
 //#define UART_FUNCSEL_SINGLE_WIRE (0x4ul << UART_FUNCSEL_FUNCSEL_Pos) /*!< UART_FUNCSEL setting to set Single Wire Function           \hideinitializer */
+#if RS485_MULTIDROP
+#define UART_FUNCSEL_MODE (UART_FUNCSEL_RS485)
+#else
 #define UART_FUNCSEL_MODE (UART_FUNCSEL_UART)
+#endif
 
 
 #endif  /* __UART_TRANS_H__ */
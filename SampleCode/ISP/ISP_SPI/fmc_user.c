@@ -1,69 +0,0 @@
-/***************************************************************************//**
- * @file     fmc_user.c
- * @brief    M031 series FMC driver source file
- * @version  2.0.0
- *
- * @copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
- ******************************************************************************/
-#include <stdio.h>
-#include "fmc_user.h"
-
-int FMC_Proc(uint32_t u32Cmd, uint32_t addr_start, uint32_t addr_end, uint32_t *data)
-{
-    unsigned int u32Addr, Reg;
-
-    for (u32Addr = addr_start; u32Addr < addr_end; data++)
-    {
-        FMC->ISPCMD = u32Cmd;
-        FMC->ISPADDR = u32Addr;
-
-        if (u32Cmd == FMC_ISPCMD_PROGRAM)
-        {
-            FMC->ISPDAT = *data;
-        }
-
-        FMC->ISPTRG = 0x1;
-        __ISB();
-
-        while (FMC->ISPTRG & 0x1) ;  /* Wait for ISP command done. */
-
-        Reg = FMC->ISPCTL;
-
-        if (Reg & FMC_ISPCTL_ISPFF_Msk)
-        {
-            FMC->ISPCTL = Reg;
-            return -1;
-        }
-
-        if (u32Cmd == FMC_ISPCMD_READ)
-        {
-            *data = FMC->ISPDAT;
-        }
-
-        if (u32Cmd == FMC_ISPCMD_PAGE_ERASE)
-        {
-            u32Addr += FMC_FLASH_PAGE_SIZE;
-        }
-        else
-        {
-            u32Addr += 4;
-        }
-    }
-
-    return 0;
-}
-
-void UpdateConfig(uint32_t *data, uint32_t *res)
-{
-    unsigned int u32Size = CONFIG_SIZE;
-    FMC_ENABLE_CFG_UPDATE();
-    FMC_Proc(FMC_ISPCMD_PAGE_ERASE, Config0, Config0 + 8, 0);
-    FMC_Proc(FMC_ISPCMD_PROGRAM, Config0, Config0 + u32Size, data);
-
-    if (res)
-    {
-        FMC_Proc(FMC_ISPCMD_READ, Config0, Config0 + u32Size, res);
-    }
-
-    FMC_DISABLE_CFG_UPDATE();
-}
@@ -72,7 +72,6 @@ void SYS_Init(void)
 
 int main(void)
 {
-    uint32_t cmd_buff[16];
     SYS_Init();
 
     /* Checking if flash page size matches with target chip's */
@@ -119,16 +118,7 @@ _ISP:
 
     while (1)
     {
-        if (bSpiDataReady == 1)
-        {
-            memcpy(cmd_buff, spi_rcvbuf, 64);
-            bSpiDataReady = 0;
-            ParseCmd((unsigned char *)cmd_buff, 64);
-            bISPDataReady = 1;
-#ifdef ReadyPin
-            ReadyPin = 0;
-#endif
-        }
+        ISP_Poll(&g_sSpiTransport);
     }
 
 _APROM:
@@ -8,6 +8,7 @@
  * Copyright (C) 2017 Nuvoton Technology Corp. All rights reserved.
  ******************************************************************************/
 #include <stdio.h>
+#include <string.h>
 #include "targetdev.h"
 
 /*---------------------------------------------------------------------------------------------------------*/
@@ -19,6 +20,7 @@ uint32_t spi_rcvbuf[TEST_COUNT];
 volatile uint32_t g_u32TxDataCount;
 volatile uint32_t g_u32RxDataCount;
 
+volatile uint8_t bISPDataReady;
 volatile uint8_t bSpiDataReady = 0;
 
 void SPI_Init(void)
@@ -117,3 +119,33 @@ void SPI0_IRQHandler(void)
     {
     }
 }
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* ISP transport                                                                                           */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint8_t *SPI_RecvFrame(void)
+{
+    static uint32_t cmd_buff[16];
+
+    if (bSpiDataReady == 0)
+    {
+        return NULL;
+    }
+
+    memcpy(cmd_buff, spi_rcvbuf, 64);
+    bSpiDataReady = 0;
+    return (uint8_t *)cmd_buff;
+}
+
+// The master clocks response_buff out once bISPDataReady is set
+static void SPI_SendFrame(uint8_t *buf, uint32_t len)
+{
+    (void)buf;
+    (void)len;
+    bISPDataReady = 1;
+#ifdef ReadyPin
+    ReadyPin = 0;
+#endif
+}
+
+const ISP_TRANSPORT_T g_sSpiTransport = { SPI_RecvFrame, SPI_SendFrame, NULL };
@@ -9,8 +9,11 @@
 #ifndef __SPI_TRANS_H__
 #define __SPI_TRANS_H__
 #include <stdint.h>
+#include "isp_user.h"
 
 extern volatile uint8_t bSpiDataReady;
+extern volatile uint8_t bISPDataReady;
+extern const ISP_TRANSPORT_T g_sSpiTransport;
 extern uint32_t spi_rcvbuf[];
 
 /*-------------------------------------------------------------*/
@@ -14,4 +14,3 @@
 
 #define ReadyPin  (PB6)
 
-#define CONFIG_SIZE 8 // in bytes
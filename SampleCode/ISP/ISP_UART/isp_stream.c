@@ -0,0 +1,243 @@
+/**************************************************************************//**
+ * @file     isp_stream.c
+ * @brief    Pipelined ISP streaming mode source file
+ *
+ * @note
+ * Streaming is entered by CMD_STREAM_MODE. The host then sends up to a window of
+ * frames without waiting; the target takes them in order only (go-back-N) and
+ * answers with cumulative acks. The frame size is a power of two and a frame
+ * starts at a multiple of it, so no frame crosses a page boundary; one that starts
+ * on a page boundary erases that page before it is programmed.
+ *
+ * Copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "isp_user.h"
+#include "isp_stream.h"
+#include "uart_transfer.h"
+
+#if UART_STREAM_MODE
+uint32_t g_u32StreamFrame = STREAM_MAX_FRAME, g_u32StreamWindow = 1;
+
+#ifdef __ICCARM__
+#pragma data_alignment=4
+static uint8_t stream_ring[STREAM_RING_SIZE];
+#pragma data_alignment=4
+static uint32_t stream_frame[(STREAM_HDR_SIZE + STREAM_MAX_FRAME) / 4];
+#else
+static uint8_t stream_ring[STREAM_RING_SIZE] __attribute__((aligned(4)));
+static uint32_t stream_frame[(STREAM_HDR_SIZE + STREAM_MAX_FRAME) / 4] __attribute__((aligned(4)));
+#endif
+
+static uint32_t s_u32Tail, s_u32LastHead, s_u32Idle;
+static uint8_t s_u8Seq, s_u8Resend;
+
+/* Clamp the frame size and window the host asked for to what the ring can hold. The frame
+   size goes down to a power of two, which divides the flash page. */
+void StreamNegotiate(uint32_t *pu32Frame, uint32_t *pu32Window)
+{
+    uint32_t u32Max;
+
+    if ((*pu32Frame < 16) || (*pu32Frame > STREAM_MAX_FRAME))
+    {
+        *pu32Frame = STREAM_MAX_FRAME;
+    }
+
+    while (*pu32Frame & (*pu32Frame - 1))
+    {
+        *pu32Frame &= *pu32Frame - 1;
+    }
+
+    u32Max = (STREAM_RING_SIZE / 2) / (*pu32Frame + STREAM_HDR_SIZE + STREAM_TRL_SIZE);
+
+    if ((*pu32Window == 0) || (*pu32Window > u32Max))
+    {
+        *pu32Window = u32Max;
+    }
+
+    g_u32StreamFrame = *pu32Frame;
+    g_u32StreamWindow = *pu32Window;
+}
+
+static uint8_t RingByte(uint32_t u32Pos)
+{
+    return stream_ring[u32Pos & (STREAM_RING_SIZE - 1)];
+}
+
+static void StreamAck(uint8_t u8Status)
+{
+    uint8_t au8Ack[STREAM_ACK_SIZE];
+
+    au8Ack[0] = STREAM_ACK;
+    au8Ack[1] = s_u8Seq;
+    au8Ack[2] = u8Status;
+    au8Ack[3] = (uint8_t)(au8Ack[0] + au8Ack[1] + au8Ack[2]);
+    UART_StreamWrite(au8Ack, STREAM_ACK_SIZE);
+}
+
+static uint8_t StreamProgram(uint32_t u32Addr, uint32_t u32Len)
+{
+    uint32_t u32ApLimit, u32End, i, u32Data;
+    uint32_t *pu32Payload = &stream_frame[STREAM_HDR_SIZE / 4];
+
+    u32ApLimit = (g_apromSize < g_dataFlashAddr) ? g_apromSize : g_dataFlashAddr;
+    u32End = u32Addr + u32Len;
+
+    /* Frame aligned, so the frame stays in the page erased at its start */
+    if ((u32Addr & (g_u32StreamFrame - 1)) || (u32End < u32Addr) ||
+            ((u32End > u32ApLimit) && ((u32Addr < g_dataFlashAddr) || (u32End > g_dataFlashAddr + g_dataFlashSize))))
+    {
+        return STREAM_ST_ADDR;
+    }
+
+    if ((u32Addr & (FMC_FLASH_PAGE_SIZE - 1)) == 0)
+    {
+        if (FMC_Erase_User(u32Addr) != 0)
+        {
+            return STREAM_ST_PROG_FAIL;
+        }
+    }
+
+    if (WriteData(u32Addr, u32End, pu32Payload) != 0)
+    {
+        return STREAM_ST_PROG_FAIL;
+    }
+
+    for (i = 0; i < u32Len / 4; i++)
+    {
+        if ((FMC_Read_User(u32Addr + i * 4, &u32Data) != 0) || (u32Data != pu32Payload[i]))
+        {
+            return STREAM_ST_PROG_FAIL;
+        }
+    }
+
+    return STREAM_ST_OK;
+}
+
+void StreamOpen(void)
+{
+    s_u32Tail = 0;
+    s_u32LastHead = 0;
+    s_u32Idle = 0;
+    s_u8Seq = 0;
+    s_u8Resend = FALSE;
+    UART_StreamOpen(stream_ring, STREAM_RING_SIZE);
+}
+
+void StreamClose(void)
+{
+    UART_StreamClose();
+}
+
+/* Take every complete frame in the ring. Returns STREAM_END on the end frame, an
+   aborting error or an idle line, else STREAM_BUSY. */
+int StreamPoll(void)
+{
+    uint32_t u32Head, u32Len, u32Addr, u32Trailer, i;
+    uint16_t u16Sum;
+    uint8_t u8Byte, u8Status, bAck = FALSE;
+
+    u32Head = UART_StreamRxHead();
+
+    if (u32Head != s_u32LastHead)
+    {
+        s_u32LastHead = u32Head;
+        s_u32Idle = 0;
+    }
+    else if ((SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) && (++s_u32Idle >= STREAM_IDLE_TICKS))
+    {
+        return STREAM_END;
+    }
+
+    while ((u32Head - s_u32Tail) >= STREAM_HDR_SIZE)
+    {
+        /* Hunt for the sync byte after an error */
+        if (RingByte(s_u32Tail) != STREAM_SYNC)
+        {
+            s_u32Tail++;
+            continue;
+        }
+
+        u32Len = RingByte(s_u32Tail + 2) | ((uint32_t)RingByte(s_u32Tail + 3) << 8);
+
+        if ((u32Len > g_u32StreamFrame) || (u32Len & 0x3))
+        {
+            s_u32Tail++;
+            continue;
+        }
+
+        if ((u32Head - s_u32Tail) < (STREAM_HDR_SIZE + u32Len + STREAM_TRL_SIZE))
+        {
+            break;
+        }
+
+        /* Header and payload into word aligned memory, for the CRC engine and the programming */
+        for (u16Sum = 0, i = 0; i < STREAM_HDR_SIZE + u32Len; i++)
+        {
+            u8Byte = RingByte(s_u32Tail + i);
+            ((uint8_t *)stream_frame)[i] = u8Byte;
+            u16Sum += u8Byte;
+        }
+
+        i = s_u32Tail + STREAM_HDR_SIZE + u32Len;
+        u32Trailer = RingByte(i) | ((uint32_t)RingByte(i + 1) << 8) |
+                     ((uint32_t)RingByte(i + 2) << 16) | ((uint32_t)RingByte(i + 3) << 24);
+
+        if ((ISP_CRC32_MODE && bCrc32Mode) ? (Crc32Calc(stream_frame, STREAM_HDR_SIZE + u32Len) != u32Trailer) :
+                (u16Sum != (u32Trailer & 0xFFFF)))
+        {
+            if (!s_u8Resend)
+            {
+                s_u8Resend = TRUE;
+                StreamAck(STREAM_ST_RESEND);
+            }
+
+            s_u32Tail++;
+            continue;
+        }
+
+        i = s_u32Tail + 1;
+        s_u32Tail += STREAM_HDR_SIZE + u32Len + STREAM_TRL_SIZE;
+
+        /* Frames after a lost one are dropped until the host goes back */
+        if (RingByte(i) != s_u8Seq)
+        {
+            if (!s_u8Resend)
+            {
+                s_u8Resend = TRUE;
+                StreamAck(STREAM_ST_RESEND);
+            }
+
+            continue;
+        }
+
+        if (u32Len == 0)
+        {
+            s_u8Seq++;
+            StreamAck(STREAM_ST_OK);
+            return STREAM_END;
+        }
+
+        u32Addr = RingByte(i + 3) | ((uint32_t)RingByte(i + 4) << 8) |
+                  ((uint32_t)RingByte(i + 5) << 16) | ((uint32_t)RingByte(i + 6) << 24);
+        u8Status = StreamProgram(u32Addr, u32Len);
+
+        if (u8Status != STREAM_ST_OK)
+        {
+            StreamAck(u8Status);
+            return STREAM_END;
+        }
+
+        s_u8Seq++;
+        s_u8Resend = FALSE;
+        bAck = TRUE;
+    }
+
+    /* One cumulative ack for all frames taken in this pass */
+    if (bAck)
+    {
+        StreamAck(STREAM_ST_OK);
+    }
+
+    return STREAM_BUSY;
+}
+#endif
@@ -0,0 +1,57 @@
+/**************************************************************************//**
+ * @file     isp_stream.h
+ * @brief    Pipelined ISP streaming mode header file
+ *
+ * @note
+ * Copyright (C) 2019 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef ISP_STREAM_H
+#define ISP_STREAM_H
+
+#include <stdint.h>
+
+/*-------------------------------------------------------------*/
+/* Stream frame, host to target:
+ *   [0]     STREAM_SYNC
+ *   [1]     sequence number, modulo 256
+ *   [2..3]  payload length, multiple of 4, 0 ends the stream
+ *   [4..7]  flash address of the payload, word aligned
+ *   [8..]   payload
+ *   [+0..1] 16-bit byte sum of header and payload
+ *   [+2..3] reserved, 0
+ *   In CRC32 frame mode (CMD_CRC32_MODE) [+0..3] is the CRC32 of header and payload.
+ * Ack, target to host:
+ *   [0] STREAM_ACK, [1] next expected sequence, [2] status, [3] byte sum of [0..2]
+ */
+#define STREAM_SYNC             0xA5
+#define STREAM_ACK              0x5A
+#define STREAM_HDR_SIZE         8
+#define STREAM_TRL_SIZE         4
+#define STREAM_ACK_SIZE         4
+
+/* Largest payload; one multi-word program row */
+#define STREAM_MAX_FRAME        256
+/* Receive ring, two PDMA segments. Window x frame must fit in one segment so that the
+   main loop never misses a segment wrap while the CPU is stalled by erase or program. */
+#define STREAM_RING_SIZE        2048
+/* Leave streaming after this many idle SysTick periods */
+#define STREAM_IDLE_TICKS       4
+
+/* Ack status */
+#define STREAM_ST_OK            0x00    /* Frames before the sequence are programmed */
+#define STREAM_ST_RESEND        0x01    /* Checksum or CRC error or gap, resend from the sequence */
+#define STREAM_ST_PROG_FAIL     0x02    /* Erase, program or verify failed, stream aborted */
+#define STREAM_ST_ADDR          0x03    /* Address outside APROM and Data Flash, stream aborted */
+
+/* StreamPoll() return value */
+#define STREAM_BUSY             0
+#define STREAM_END              1
+
+extern uint32_t g_u32StreamFrame, g_u32StreamWindow;
+
+void StreamNegotiate(uint32_t *pu32Frame, uint32_t *pu32Window);
+void StreamOpen(void);
+int  StreamPoll(void);
+void StreamClose(void);
+
+#endif  /* ISP_STREAM_H */
@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include "targetdev.h"
 #include "uart_transfer.h"
+#include "isp_stream.h"
 
 void SYS_Init(void)
 {
@@ -108,12 +109,35 @@ _ISP:
 
     while (1)
     {
-        if (bUartDataReady == TRUE)
+        if (ISP_Poll(&g_sUartTransport))
         {
-            bUartDataReady = FALSE;
-            ParseCmd(uart_rcvbuf, 64);
-            PutString();
+#if UART_BAUD_NEGOTIATE
+
+            if (g_u32NewBaud)
+            {
+                UART_BaudTrial(g_u32NewBaud);
+                g_u32NewBaud = 0;
+            }
+
+#endif
+#if UART_STREAM_MODE
+
+            if (bStreamModeCmd == TRUE)
+            {
+                bStreamModeCmd = FALSE;
+                StreamOpen();
+
+                while (StreamPoll() == STREAM_BUSY);
+
+                StreamClose();
+            }
+
+#endif
         }
+
+#if UART_BAUD_NEGOTIATE
+        UART_BaudPoll();
+#endif
     }
 
 _APROM:
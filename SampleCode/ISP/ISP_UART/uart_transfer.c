@@ -12,6 +12,7 @@
 #include <string.h>
 #include "NuMicro.h"
 #include "uart_transfer.h"
+#include "isp_stream.h"
 
 #ifdef __ICCARM__
 #pragma data_alignment=4
@@ -23,6 +24,27 @@ __attribute__((aligned(4))) uint8_t uart_rcvbuf[MAX_PKT_SIZE] = {0};
 uint8_t volatile bUartDataReady = 0;
 uint8_t volatile bufhead = 0;
 
+#if UART_STREAM_MODE
+uint32_t bStreamModeCmd;
+
+/* Stream mode receive ring: two scatter-gather tables that link to each other */
+#ifdef __ICCARM__
+#pragma data_alignment=16
+static DSCT_T stream_dsct[2];
+#else
+static DSCT_T stream_dsct[2] __attribute__((aligned(16)));
+#endif
+static uint32_t s_u32StreamSeg, s_u32StreamDone;
+#endif
+
+#if UART_BAUD_NEGOTIATE
+uint32_t g_u32NewBaud;
+
+/* Rate on trial after CMD_SET_BAUDRATE, 0 when none */
+uint32_t g_u32BaudTrial = 0;
+static uint32_t s_u32BaudPrev, s_u32BaudTicks;
+#endif
+
 
 /* please check "targetdev.h" for chip specifc define option */
 
@@ -52,25 +74,6 @@ void UART02_IRQHandler(void)
         bufhead = 0;
     }
 }
-#ifdef __ICCARM__
-#pragma data_alignment=4
-extern uint8_t response_buff[64];
-#else
-extern __attribute__((aligned(4))) uint8_t response_buff[64];
-#endif 
-
-void PutString(void)
-{
-    uint32_t i;
-
-    for (i = 0; i < MAX_PKT_SIZE; i++)
-    {
-        while ((UART0->FIFOSTS & UART_FIFOSTS_TXFULL_Msk));
-
-        UART0->DAT = response_buff[i];
-    }
-}
-
 void UART_Init()
 {
     /*---------------------------------------------------------------------------------------------------------*/
@@ -83,7 +86,7 @@ void UART_Init()
     /* Set UART Rx and RTS trigger level */
     UART0->FIFO = UART_FIFO_RFITL_14BYTES | UART_FIFO_RTSTRGLV_14BYTES;
     /* Set UART baud rate */
-    UART0->BAUD = (UART_BAUD_MODE2 | UART_BAUD_MODE2_DIVIDER(__HIRC, 115200));
+    UART0->BAUD = (UART_BAUD_MODE2 | UART_BAUD_MODE2_DIVIDER(__HIRC, UART_BAUD_DEFAULT));
     /* Set time-out interrupt comparator */
     UART0->TOUT = (UART0->TOUT & ~UART_TOUT_TOIC_Msk) | (0x40);
     NVIC_SetPriority(UART02_IRQn, 2);
@@ -92,3 +95,242 @@ void UART_Init()
     UART0->INTEN = (UART_INTEN_TOCNTEN_Msk | UART_INTEN_RXTOIEN_Msk | UART_INTEN_RDAIEN_Msk);
 }
 
+#if UART_STREAM_MODE
+void UART_StreamOpen(uint8_t *pu8Ring, uint32_t u32Size)
+{
+    uint32_t i;
+
+    /* Erase and program stall the CPU for longer than the FIFO lasts, so PDMA takes the data */
+    NVIC_DisableIRQ(UART02_IRQn);
+    UART0->INTEN = 0;
+    CLK->AHBCLK |= CLK_AHBCLK_PDMACKEN_Msk;
+    s_u32StreamSeg = u32Size / 2;
+    s_u32StreamDone = 0;
+    PDMA->SCATBA = (uint32_t)stream_dsct & PDMA_SCATBA_SCATBA_Msk;
+
+    for (i = 0; i < 2; i++)
+    {
+        stream_dsct[i].CTL = ((s_u32StreamSeg - 1) << PDMA_DSCT_CTL_TXCNT_Pos) | PDMA_WIDTH_8 | PDMA_SAR_FIX | PDMA_DAR_INC |
+                             PDMA_REQ_SINGLE | PDMA_OP_SCATTER;
+        stream_dsct[i].SA = (uint32_t)&UART0->DAT;
+        stream_dsct[i].DA = (uint32_t)&pu8Ring[i * s_u32StreamSeg];
+        stream_dsct[i].NEXT = (uint32_t)&stream_dsct[i ^ 1] - PDMA->SCATBA;
+    }
+
+    PDMA->CHCTL |= (1 << STREAM_PDMA_CH);
+    PDMA->REQSEL0_3 = (PDMA->REQSEL0_3 & ~PDMA_REQSEL0_3_REQSRC0_Msk) | (PDMA_UART0_RX << PDMA_REQSEL0_3_REQSRC0_Pos);
+    PDMA->TDSTS = (1 << STREAM_PDMA_CH);
+    PDMA->DSCT[STREAM_PDMA_CH].CTL = PDMA_OP_SCATTER;
+    PDMA->DSCT[STREAM_PDMA_CH].NEXT = (uint32_t)&stream_dsct[0] - PDMA->SCATBA;
+    UART0->INTEN = UART_INTEN_RXPDMAEN_Msk;
+}
+
+/* Bytes written into the ring since UART_StreamOpen(). A table that has just finished is
+   counted from its done flag; until then the position may lag, never lead. */
+uint32_t UART_StreamRxHead(void)
+{
+    uint32_t u32Next, u32Ctl, u32Cur;
+
+    if (PDMA->TDSTS & (1 << STREAM_PDMA_CH))
+    {
+        PDMA->TDSTS = (1 << STREAM_PDMA_CH);
+        s_u32StreamDone++;
+    }
+
+    do
+    {
+        u32Next = PDMA->DSCT[STREAM_PDMA_CH].NEXT;
+        u32Ctl = PDMA->DSCT[STREAM_PDMA_CH].CTL;
+    }
+    while (u32Next != PDMA->DSCT[STREAM_PDMA_CH].NEXT);
+
+    /* NEXT links to the table after the one in progress */
+    u32Cur = (((PDMA->SCATBA & PDMA_SCATBA_SCATBA_Msk) | (u32Next & PDMA_DSCT_NEXT_NEXT_Msk)) == (uint32_t)&stream_dsct[0]) ? 1 : 0;
+
+    if (u32Cur != (s_u32StreamDone & 1))
+    {
+        return s_u32StreamDone * s_u32StreamSeg;
+    }
+
+    return (s_u32StreamDone * s_u32StreamSeg) + s_u32StreamSeg - (((u32Ctl & PDMA_DSCT_CTL_TXCNT_Msk) >> PDMA_DSCT_CTL_TXCNT_Pos) + 1);
+}
+
+void UART_StreamWrite(const uint8_t *pu8Buf, uint32_t u32Len)
+{
+    uint32_t i;
+
+    for (i = 0; i < u32Len; i++)
+    {
+        while ((UART0->FIFOSTS & UART_FIFOSTS_TXFULL_Msk));
+
+        UART0->DAT = pu8Buf[i];
+    }
+}
+
+/* Back to 64-byte packets */
+void UART_StreamClose(void)
+{
+    UART0->INTEN = 0;
+    /* Drop the table in progress so that the next open starts from the ring base */
+    PDMA->PAUSE = (1 << STREAM_PDMA_CH);
+    PDMA->CHCTL &= ~(1 << STREAM_PDMA_CH);
+    bufhead = 0;
+    bUartDataReady = FALSE;
+    UART0->INTEN = (UART_INTEN_TOCNTEN_Msk | UART_INTEN_RXTOIEN_Msk | UART_INTEN_RDAIEN_Msk);
+    NVIC_EnableIRQ(UART02_IRQn);
+}
+#endif
+
+#if UART_BAUD_NEGOTIATE
+/* Rate UART0 really runs at for u32Baud, or 0 if it cannot come within tolerance */
+uint32_t UART_BaudCheck(uint32_t u32Baud)
+{
+    uint32_t u32Div, u32Real, u32Err;
+
+    if ((u32Baud == 0) || (u32Baud > UART_BAUD_MAX))
+    {
+        return 0;
+    }
+
+    u32Div = UART_BAUD_MODE2_DIVIDER(__HIRC, u32Baud);
+
+    if (u32Div > (UART_BAUD_BRD_Msk >> UART_BAUD_BRD_Pos))
+    {
+        return 0;
+    }
+
+    u32Real = __HIRC / (u32Div + 2);
+    u32Err = (u32Real > u32Baud) ? (u32Real - u32Baud) : (u32Baud - u32Real);
+
+    return (u32Err <= (u32Baud / UART_BAUD_TOLERANCE)) ? u32Real : 0;
+}
+
+/* Switch once the response has left at the old rate. The host has to repeat
+   CMD_SET_BAUDRATE at the new rate before UART_BAUD_TRIAL_TICKS run out. */
+void UART_BaudTrial(uint32_t u32Baud)
+{
+    while ((UART0->FIFOSTS & UART_FIFOSTS_TXEMPTYF_Msk) == 0);
+
+    s_u32BaudPrev = UART0->BAUD;
+    s_u32BaudTicks = 0;
+    g_u32BaudTrial = u32Baud;
+    (void)(SysTick->CTRL);  /* Clear COUNTFLAG */
+    UART0->BAUD = (UART_BAUD_MODE2 | UART_BAUD_MODE2_DIVIDER(__HIRC, u32Baud));
+    bufhead = 0;
+}
+
+void UART_BaudCommit(void)
+{
+    g_u32BaudTrial = 0;
+}
+
+void UART_BaudRevert(void)
+{
+    if (g_u32BaudTrial)
+    {
+        UART0->BAUD = s_u32BaudPrev;
+        g_u32BaudTrial = 0;
+        bufhead = 0;
+        bUartDataReady = FALSE;
+    }
+}
+
+/* Fall back when the host never shows up at the new rate */
+void UART_BaudPoll(void)
+{
+    if (g_u32BaudTrial && (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) && (++s_u32BaudTicks >= UART_BAUD_TRIAL_TICKS))
+    {
+        UART_BaudRevert();
+    }
+}
+#endif
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* ISP transport                                                                                           */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint8_t *UART_RecvFrame(void)
+{
+    if (bUartDataReady == FALSE)
+    {
+        return NULL;
+    }
+
+    bUartDataReady = FALSE;
+#if UART_BAUD_NEGOTIATE
+
+    /* Anything but the confirmation at a trial rate means the link does not work */
+    if (g_u32BaudTrial && (inpw(uart_rcvbuf) != CMD_SET_BAUDRATE))
+    {
+        UART_BaudRevert();
+        return NULL;
+    }
+
+#endif
+    return uart_rcvbuf;
+}
+
+static void UART_SendFrame(uint8_t *buf, uint32_t len)
+{
+    while (len--)
+    {
+        while ((UART0->FIFOSTS & UART_FIFOSTS_TXFULL_Msk));
+
+        UART0->DAT = *buf++;
+    }
+}
+
+/* CMD_STREAM_MODE and CMD_SET_BAUDRATE only make sense on this link */
+static int UART_Command(uint32_t cmd, unsigned char *arg, uint8_t *response, uint32_t locked)
+{
+    if (cmd == CMD_STREAM_MODE)
+    {
+#if UART_STREAM_MODE
+
+        if (locked)   /*security lock: stream into a blank APROM only*/
+        {
+            EraseAP(FMC_APROM_BASE, (g_apromSize < g_dataFlashAddr) ? g_apromSize : g_dataFlashAddr);
+            bUpdateApromCmd = TRUE;
+        }
+
+        /* Requested frame size and window in, accepted ones out */
+        outpw(response + 8, inpw(arg));
+        outpw(response + 12, inpw(arg + 4));
+        StreamNegotiate((uint32_t *)(response + 8), (uint32_t *)(response + 12));
+        bStreamModeCmd = TRUE;
+#else
+        /* No streaming, the host goes on with packets */
+        (void)arg;
+        (void)locked;
+        outpw(response + 8, 0);
+        outpw(response + 12, 0);
+#endif
+        return TRUE;
+    }
+    else if (cmd == CMD_SET_BAUDRATE)
+    {
+#if UART_BAUD_NEGOTIATE
+
+        if (g_u32BaudTrial)
+        {
+            /* Repeated at the new rate: the link works, keep it */
+            UART_BaudCommit();
+            outpw(response + 8, UART_BaudCheck(inpw(arg)));
+        }
+        else
+        {
+            /* Rate really used, or 0 to stay at the current one */
+            g_u32NewBaud = UART_BaudCheck(inpw(arg));
+            outpw(response + 8, g_u32NewBaud);
+        }
+
+#else
+        (void)arg;
+        outpw(response + 8, 0);     /* Stay at the current rate */
+#endif
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+const ISP_TRANSPORT_T g_sUartTransport = { UART_RecvFrame, UART_SendFrame, UART_Command };
@@ -10,21 +10,56 @@
 #ifndef __UART_TRANS_H__
 #define __UART_TRANS_H__
 #include <stdint.h>
+#include "isp_user.h"
 
 /*-------------------------------------------------------------*/
 /* Define maximum packet size */
 #define MAX_PKT_SIZE            64
+/* Build options, 0 keeps the link of the original ISP tool; set them in the project to 1
+   where wanted. Left out, CMD_STREAM_MODE answers a frame size and window of 0 and
+   CMD_SET_BAUDRATE a rate of 0, so the host goes on with 64-byte packets at 115200.
+   UART_STREAM_MODE: CMD_STREAM_MODE and the receive ring of isp_stream.c; on in the
+   ISP_UART_Features target and the Features configuration
+   UART_BAUD_NEGOTIATE: CMD_SET_BAUDRATE; off in every target, as with streaming the
+   loader would come within about 250 bytes of the LDROM end. Alone it fits. */
+#ifndef UART_STREAM_MODE
+#define UART_STREAM_MODE        0
+#endif
+#ifndef UART_BAUD_NEGOTIATE
+#define UART_BAUD_NEGOTIATE     0
+#endif
+
+/* PDMA channel of the stream mode receive ring */
+#define STREAM_PDMA_CH          0
+
+/* Baud rate negotiated by CMD_SET_BAUDRATE; UART clock is HIRC */
+#define UART_BAUD_DEFAULT       115200
+#define UART_BAUD_MAX           (__HIRC / 8)
+#define UART_BAUD_TOLERANCE     50      /* Accept up to 1/50 (2%) rate error */
+#define UART_BAUD_TRIAL_TICKS   2       /* SysTick periods to wait for the confirmation */
 
 /*-------------------------------------------------------------*/
 
 extern uint8_t  uart_rcvbuf[];
 extern uint8_t volatile bUartDataReady;
 extern uint8_t volatile bufhead;
+extern uint32_t g_u32BaudTrial;
+extern uint32_t bStreamModeCmd;
+extern uint32_t g_u32NewBaud;
+extern const ISP_TRANSPORT_T g_sUartTransport;
 
 /*-------------------------------------------------------------*/
 void UART_Init(void);
 void UART0_IRQHandler(void);
-void PutString(void);
+void UART_StreamOpen(uint8_t *pu8Ring, uint32_t u32Size);
+uint32_t UART_StreamRxHead(void);
+void UART_StreamWrite(const uint8_t *pu8Buf, uint32_t u32Len);
+void UART_StreamClose(void);
+uint32_t UART_BaudCheck(uint32_t u32Baud);
+void UART_BaudTrial(uint32_t u32Baud);
+void UART_BaudCommit(void);
+void UART_BaudRevert(void);
+void UART_BaudPoll(void);
 
 #include "clk.h"
 ///*---------------------------------------------------------------------------------------------------------*/
@@ -23,6 +23,7 @@ extern int ts_writefile(void);
 extern int ts_readfile(void);
 extern void ts_init(void);
 int ts_calibrate(int xsize, int ysize);
+extern void Store_TouchEvents(void);
 void ts_test(int xsize, int ysize);
 
 /*********************************************************************
@@ -81,6 +82,16 @@ void _SYS_Init(void)
     SYS_LockReg();
 }
 
+/*********************************************************************
+*
+*       PDMA_IRQHandler
+*/
+void PDMA_IRQHandler(void)
+{
+    /* LCD pixel transfers started by _WriteM1 */
+    PDMA_DispatchIRQ(PDMA);
+}
+
 /*********************************************************************
 *
 *       TMR0_IRQHandler
@@ -93,7 +104,8 @@ void TMR0_IRQHandler(void)
     {
         if(g_enable_Touch == 1)
         {
-            GUI_TOUCH_Exec();
+            /* Pen events from the background scan, see Start_TouchScan() */
+            Store_TouchEvents();
         }
     }
 #endif
@@ -184,6 +196,9 @@ int main(void)
     /* Lock protected registers */
     SYS_LockReg();
 
+    /* Scan the panel from Timer1 from now on, after the calibration */
+    Start_TouchScan();
+
     g_enable_Touch = 1;
 
 //    ts_test(__DEMO_TS_WIDTH__, __DEMO_TS_HEIGHT__);
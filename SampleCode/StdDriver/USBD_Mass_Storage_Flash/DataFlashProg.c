@@ -19,9 +19,20 @@
 /*---------------------------------------------------------------------------------------------------------*/
 /* Macro, type and constant definitions                                                                    */
 /*---------------------------------------------------------------------------------------------------------*/
+/* One cache line holds one whole flash page. Sector writes only touch the line;
+   the page is erased and programmed once when the line is written back. */
+typedef struct
+{
+    uint32_t u32Addr;                       /* Flash page address of this line */
+    uint8_t  u8Valid;
+    uint8_t  u8Dirty;
+    uint16_t u16Age;                        /* Last use, for LRU replacement */
+    uint32_t au32Data[FLASH_PAGE_SIZE / 4];
+} DATA_FLASH_CACHE_T;
 
+static DATA_FLASH_CACHE_T s_asCache[DATA_FLASH_CACHE_PAGES];
+static uint16_t s_u16CacheTick = 0;
 
-uint32_t g_sectorBuf[FLASH_PAGE_SIZE/4];
 
 uint32_t FMC_ReadPage(uint32_t u32StartAddr, uint32_t * u32Buf)
 {
@@ -33,115 +44,199 @@ uint32_t FMC_ReadPage(uint32_t u32StartAddr, uint32_t * u32Buf)
     return 0;
 }
 
-void DataFlashRead(uint32_t addr, uint32_t size, uint32_t buffer)
+int32_t FMC_ProgramPage(uint32_t u32StartAddr, uint32_t * u32Buf)
 {
-    /* This is low level read function of USB Mass Storage */
-    int32_t len;
-
-    /* Modify the address to MASS_STORAGE_OFFSET */
-    addr += MASS_STORAGE_OFFSET;
-
-    len = (int32_t)size;
+    /* Multi-word program and checksum verify */
+    return FMC_WriteVerify(u32StartAddr, u32Buf, FLASH_PAGE_SIZE);
+}
 
-    SYS_UnlockReg();
-    FMC_Open();
+static DATA_FLASH_CACHE_T *DataFlashLookup(uint32_t u32PageAddr)
+{
+    uint32_t i;
 
-    while(len >= FLASH_PAGE_SIZE)
+    for (i = 0; i < DATA_FLASH_CACHE_PAGES; i++)
     {
-        FMC_ReadPage(addr, (uint32_t *)buffer);
-        addr   += FLASH_PAGE_SIZE;
-        buffer += FLASH_PAGE_SIZE;
-        len  -= FLASH_PAGE_SIZE;
+        if (s_asCache[i].u8Valid && (s_asCache[i].u32Addr == u32PageAddr))
+            return &s_asCache[i];
     }
 
-    FMC_Close();
-    SYS_LockReg();
+    return NULL;
 }
 
-
-uint32_t FMC_ProgramPage(uint32_t u32StartAddr, uint32_t * u32Buf)
+static void DataFlashWriteBack(DATA_FLASH_CACHE_T *psLine)
 {
     uint32_t i;
 
+    if (!psLine->u8Dirty)
+        return;
+
+    psLine->u8Dirty = 0;
+
+    /* Rewriting the same data (FAT mirrors, directory updates) needs no erase */
     for (i = 0; i < FLASH_PAGE_SIZE/4; i++)
     {
-        FMC_Write(u32StartAddr + i*4, u32Buf[i]);
+        if (FMC_Read(psLine->u32Addr + i*4) != psLine->au32Data[i])
+            break;
     }
+    if (i == FLASH_PAGE_SIZE/4)
+        return;
 
-    return 0;
+    /* Retry once; a page that still fails to verify is left as programmed */
+    for (i = 0; i < 2; i++)
+    {
+        FMC_Erase(psLine->u32Addr);
+        if (FMC_ProgramPage(psLine->u32Addr, psLine->au32Data) == 0)
+            break;
+    }
 }
 
+static DATA_FLASH_CACHE_T *DataFlashAllocate(uint32_t u32PageAddr)
+{
+    DATA_FLASH_CACHE_T *psLine = &s_asCache[0];
+    uint32_t i;
 
-void DataFlashWrite(uint32_t addr, uint32_t size, uint32_t buffer)
+    /* Take a free line, else the least recently used one */
+    for (i = 0; i < DATA_FLASH_CACHE_PAGES; i++)
+    {
+        if (!s_asCache[i].u8Valid)
+        {
+            psLine = &s_asCache[i];
+            break;
+        }
+        if ((uint16_t)(s_u16CacheTick - s_asCache[i].u16Age) > (uint16_t)(s_u16CacheTick - psLine->u16Age))
+            psLine = &s_asCache[i];
+    }
+
+    if (psLine->u8Valid)
+        DataFlashWriteBack(psLine);
+
+    psLine->u32Addr = u32PageAddr;
+    psLine->u8Valid = 1;
+    psLine->u8Dirty = 0;
+
+    return psLine;
+}
+
+void DataFlashRead(uint32_t addr, uint32_t size, uint32_t buffer)
 {
-    /* This is low level write function of USB Mass Storage */
-    int32_t len, i, offset;
+    /* This is low level read function of USB Mass Storage */
+    DATA_FLASH_CACHE_T *psLine;
     uint32_t *pu32;
-    uint32_t alignAddr;
+    uint32_t offset, len, i;
 
     /* Modify the address to MASS_STORAGE_OFFSET */
     addr += MASS_STORAGE_OFFSET;
 
-    len = (int32_t)size;
-
     SYS_UnlockReg();
     FMC_Open();
 
-    if ( len == FLASH_PAGE_SIZE && ((addr & (FLASH_PAGE_SIZE-1)) == 0) )
+    while (size > 0)
     {
-        FMC_Erase(addr);
-
-        while (len >= FLASH_PAGE_SIZE)
+        offset = addr & (FLASH_PAGE_SIZE-1);
+        len = FLASH_PAGE_SIZE - offset;
+        if (size < len)
+            len = size;
+
+        /* Cached pages may hold data not yet written back. Misses are not
+           allocated so that reading a large file does not evict dirty pages. */
+        psLine = DataFlashLookup(addr - offset);
+        pu32 = (uint32_t *)buffer;
+        if (psLine != NULL)
+        {
+            for (i = 0; i < len/4; i++)
+                pu32[i] = psLine->au32Data[offset/4 + i];
+        }
+        else
         {
-            FMC_ProgramPage(addr, (uint32_t *) buffer);
-            len    -= FLASH_PAGE_SIZE;
-            buffer += FLASH_PAGE_SIZE;
-            addr   += FLASH_PAGE_SIZE;
+            for (i = 0; i < len/4; i++)
+                pu32[i] = FMC_Read(addr + i*4);
         }
+
+        size   -= len;
+        addr   += len;
+        buffer += len;
     }
-    else
+
+    FMC_Close();
+    SYS_LockReg();
+}
+
+void DataFlashWrite(uint32_t addr, uint32_t size, uint32_t buffer)
+{
+    /* This is low level write function of USB Mass Storage */
+    DATA_FLASH_CACHE_T *psLine;
+    uint32_t *pu32;
+    uint32_t offset, len, i;
+
+    /* Modify the address to MASS_STORAGE_OFFSET */
+    addr += MASS_STORAGE_OFFSET;
+
+    SYS_UnlockReg();
+    FMC_Open();
+
+    while (size > 0)
     {
-        do
+        /* Get the sector offset*/
+        offset = addr & (FLASH_PAGE_SIZE-1);
+        len = FLASH_PAGE_SIZE - offset;
+        if (size < len)
+            len = size;
+
+        psLine = DataFlashLookup(addr - offset);
+        if (psLine == NULL)
         {
-            alignAddr = addr & 0x1FE00;
+            psLine = DataFlashAllocate(addr - offset);
 
-            /* Get the sector offset*/
-            offset = ( addr & (FLASH_PAGE_SIZE-1) );
-
-            if ( offset || (size < FLASH_PAGE_SIZE) )
-            {
-                /* Non 4k alignment. Note: It needs to avoid add MASS_STORAGE_OFFSET twice. */
-                DataFlashRead(alignAddr - MASS_STORAGE_OFFSET, FLASH_PAGE_SIZE, (uint32_t)&g_sectorBuf[0]);
+            /* Keep the rest of the page if this write does not cover it */
+            if (len != FLASH_PAGE_SIZE)
+                FMC_ReadPage(addr - offset, psLine->au32Data);
+        }
 
-            }
+        /* Update the data */
+        pu32 = (uint32_t *)buffer;
+        for (i = 0; i < len/4; i++)
+            psLine->au32Data[offset/4 + i] = pu32[i];
 
-            /* Update the data */
-            pu32 = (uint32_t *)buffer;
-            len = FLASH_PAGE_SIZE - offset;
-            if (size < len)
-                len = size;
+        psLine->u8Dirty = 1;
+        psLine->u16Age = ++s_u16CacheTick;
 
-            for (i=0; i<len/4; i++)
-            {
-                g_sectorBuf[offset/4 + i] = pu32[i];
-            }
+        size   -= len;
+        addr   += len;
+        buffer += len;
+    }
 
-            FMC_Erase(alignAddr);
+    FMC_Close();
+    SYS_LockReg();
+}
 
-            for(i=0; i<16; i++)
-            {
-                FMC_ProgramPage(alignAddr + (i << 8), (uint32_t *) g_sectorBuf + (i << 8));
-            }
+void DataFlashFlush(void)
+{
+    /* Write back all dirty pages. Lines stay valid as clean read cache. */
+    uint32_t i;
 
-            size -= len;
-            addr += len;
-            buffer += len;
+    SYS_UnlockReg();
+    FMC_Open();
 
-        }
-        while (size > 0);
+    for (i = 0; i < DATA_FLASH_CACHE_PAGES; i++)
+    {
+        if (s_asCache[i].u8Valid)
+            DataFlashWriteBack(&s_asCache[i]);
     }
 
     FMC_Close();
     SYS_LockReg();
 }
 
+uint32_t DataFlashIsDirty(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < DATA_FLASH_CACHE_PAGES; i++)
+    {
+        if (s_asCache[i].u8Valid && s_asCache[i].u8Dirty)
+            return 1;
+    }
+
+    return 0;
+}
+
@@ -18,6 +18,12 @@
 
 #define FLASH_PAGE_SIZE           FMC_FLASH_PAGE_SIZE
 
+/* Write-back page cache. Sector writes are collected per flash page and each page is
+   erased and programmed once when it is evicted or flushed. Costs FLASH_PAGE_SIZE bytes
+   of SRAM per page. */
+#define DATA_FLASH_CACHE_PAGES    4
+#define DATA_FLASH_FLUSH_IDLE_MS  100        /* Write back after the host stops writing for this long */
+
 #endif  /* __DATA_FLASH_PROG_H__ */
 
 /*** (C) COPYRIGHT 2018 Nuvoton Technology Corp. ***/
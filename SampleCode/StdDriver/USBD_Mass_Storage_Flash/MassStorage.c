@@ -13,6 +13,7 @@
 #include <string.h>
 #include "NuMicro.h"
 #include "massstorage.h"
+#include "DataFlashProg.h"
 
 /*--------------------------------------------------------------------------*/
 /* Global variables for Control Pipe */
@@ -31,6 +32,7 @@ uint8_t g_u8Size;
 uint8_t g_au8SenseKey[4];
 
 uint32_t g_u32DataFlashStartAddr;
+uint32_t g_u32WriteFrame;               /* USB frame number of the last media write */
 uint32_t g_u32Address;
 uint32_t g_u32Length;
 uint32_t g_u32LbaAddress;
@@ -709,6 +711,7 @@ void MSC_Write(void)
             if (g_u32Address >= (STORAGE_DATA_BUF + STORAGE_BUFFER_SIZE))
             {
                 DataFlashWrite(g_u32DataFlashStartAddr, STORAGE_BUFFER_SIZE, (uint32_t)STORAGE_DATA_BUF);
+                g_u32WriteFrame = USBD->FN;
 
                 g_u32Address = STORAGE_DATA_BUF;
                 g_u32DataFlashStartAddr += STORAGE_BUFFER_SIZE;
@@ -731,7 +734,10 @@ void MSC_Write(void)
 
                 len = lba * UDC_SECTOR_SIZE + g_sCBW.dCBWDataTransferLength - g_u32DataFlashStartAddr;
                 if (len)
+                {
                     DataFlashWrite(g_u32DataFlashStartAddr, len, (uint32_t)STORAGE_DATA_BUF);
+                    g_u32WriteFrame = USBD->FN;
+                }
             }
 
             g_u8BulkState = BULK_IN;
@@ -831,6 +837,11 @@ void MSC_ProcessCmd(void)
 
                 case UFI_START_STOP:
                 {
+                    /* Stop or eject: the medium must be up to date */
+                    if ((g_sCBW.au8Data[2] & 0x01) == 0)
+                    {
+                        DataFlashFlush();
+                    }
                     if ((g_sCBW.au8Data[2] & 0x03) == 0x2)
                     {
                         g_u8Remove = 1;
@@ -845,6 +856,13 @@ void MSC_ProcessCmd(void)
                     MSC_AckCmd();
                     return;
                 }
+                case UFI_SYNCHRONIZE_CACHE_10:
+                {
+                    DataFlashFlush();
+                    g_u8BulkState = BULK_IN;
+                    MSC_AckCmd();
+                    return;
+                }
 
                 case UFI_REQUEST_SENSE:
                 {
@@ -1249,6 +1267,7 @@ void MSC_AckCmd(void)
             case UFI_PREVENT_ALLOW_MEDIUM_REMOVAL:
             case UFI_VERIFY_10:
             case UFI_START_STOP:
+            case UFI_SYNCHRONIZE_CACHE_10:
             {
                 int32_t tmp;
 
@@ -1296,6 +1315,20 @@ void MSC_WriteMedia(uint32_t addr, uint32_t size, uint8_t *buffer)
 {
 }
 
+void MSC_FlushIdle(void)
+{
+    uint32_t u32Idle;
+
+    /* Write back the page cache once the host has been quiet for a while.
+       Never in the middle of a command, the flash is busy for milliseconds. */
+    if ((g_u8BulkState != BULK_CBW) || !DataFlashIsDirty())
+        return;
+
+    u32Idle = (USBD->FN - g_u32WriteFrame) & USBD_FN_FN_Msk;
+    if (u32Idle >= DATA_FLASH_FLUSH_IDLE_MS)
+        DataFlashFlush();
+}
+
 void MSC_SetConfig(void)
 {
     /* Clear stall status and ready */
@@ -224,9 +224,14 @@ int32_t main(void)
 #endif
         /* Enter power down when USB suspend */
         if(g_u8Suspend)
+        {
+            /* The host may cut power while suspended */
+            DataFlashFlush();
             PowerDown();
+        }
 
         MSC_ProcessCmd();
+        MSC_FlushIdle();
     }
 }
 
@@ -67,6 +67,7 @@
 #define UFI_WRITE_10                            0x2A
 #define UFI_WRITE_12                            0xAA
 #define UFI_VERIFY_10                           0x2F
+#define UFI_SYNCHRONIZE_CACHE_10                0x35
 #define UFI_MODE_SELECT_10                      0x55
 #define UFI_MODE_SENSE_10                       0x5A
 
@@ -132,12 +133,15 @@ extern uint32_t Storage_Block[];
 /*-------------------------------------------------------------*/
 void DataFlashWrite(uint32_t addr, uint32_t size, uint32_t buffer);
 void DataFlashRead(uint32_t addr, uint32_t size, uint32_t buffer);
+void DataFlashFlush(void);
+uint32_t DataFlashIsDirty(void);
 void MSC_Init(void);
 void MSC_RequestSense(void);
 void MSC_ReadFormatCapacity(void);
 void MSC_Read(void);
 void MSC_ReadCapacity(void);
 void MSC_Write(void);
+void MSC_FlushIdle(void);
 void MSC_ModeSense10(void);
 void MSC_ReadTrig(void);
 void MSC_ClassRequest(void);
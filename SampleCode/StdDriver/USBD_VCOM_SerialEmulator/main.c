@@ -24,31 +24,6 @@ STR_VCOM_LINE_CODING gLineCoding = {115200, 0, 0, 8};   /* Baud rate: 115200
 /* data bits: 8 Bits     */
 uint16_t gCtrlSignal = 0;     /* BIT0: DTR(Data Terminal Ready) , BIT1: RTS(Request To Send) */
 
-/*--------------------------------------------------------------------------*/
-#define RX_BUFSIZE           512 /* RX buffer size */
-#define TX_BUFSIZE           512 /* RX buffer size */
-#define TX_FIFO_SIZE         64  /* TX Hardware FIFO size */
-
-/*---------------------------------------------------------------------------------------------------------*/
-/* Global variables                                                                                        */
-/*---------------------------------------------------------------------------------------------------------*/
-/* UART0 */
-volatile uint8_t comRbuf[RX_BUFSIZE];
-volatile uint16_t comRbytes = 0;
-volatile uint16_t comRhead = 0;
-volatile uint16_t comRtail = 0;
-
-volatile uint8_t comTbuf[TX_BUFSIZE];
-volatile uint16_t comTbytes = 0;
-volatile uint16_t comThead = 0;
-volatile uint16_t comTtail = 0;
-
-uint8_t gRxBuf[64] = {0};
-uint8_t *gpu8RxBuf = 0;
-uint32_t gu32RxSize = 0;
-uint32_t gu32TxSize = 0;
-
-volatile int8_t gi8BulkOutReady = 0;
 extern uint8_t volatile g_u8Suspend;
 
 void SYS_Init(void)
@@ -77,6 +52,9 @@ void SYS_Init(void)
     /* Enable USB clock */
     CLK_EnableModuleClock(USBD_MODULE);
 
+    /* Enable PDMA clock */
+    CLK_EnableModuleClock(PDMA_MODULE);
+
     /* Update System Core Clock */
     SystemCoreClockUpdate();
 
@@ -112,152 +90,12 @@ void PowerDown()
 }
 
 /*---------------------------------------------------------------------------------------------------------*/
-/* UART Callback function                                                                                  */
+/* PDMA Callback function                                                                                  */
 /*---------------------------------------------------------------------------------------------------------*/
-void UART02_IRQHandler(void)
+void PDMA_IRQHandler(void)
 {
-    uint32_t u32IntStatus;
-    uint8_t bInChar;
-    int32_t size;
-
-    u32IntStatus = UART0->INTSTS;
-
-    if((u32IntStatus & UART_INTSTS_RDAIF_Msk) || (u32IntStatus & UART_INTSTS_RXTOIF_Msk))
-    {
-        /* Receiver FIFO threshold level is reached or Rx time out */
-
-        /* Get all the input characters */
-        while (UART_GET_RX_EMPTY(UART0) == 0)
-        {
-            /* Get the character from UART Buffer */
-            bInChar = UART0->DAT;
-
-            /* Check if buffer full */
-            if(comRbytes < RX_BUFSIZE)
-            {
-                /* Enqueue the character */
-                comRbuf[comRtail++] = bInChar;
-                if(comRtail >= RX_BUFSIZE)
-                    comRtail = 0;
-                comRbytes++;
-            }
-            else
-            {
-                /* FIFO over run */
-            }
-        }
-    }
-
-    if(u32IntStatus & UART_INTSTS_THREIF_Msk)
-    {
-        if(comTbytes)
-        {
-            /* Fill the Tx FIFO */
-            size = comTbytes;
-            if(size >= TX_FIFO_SIZE)
-            {
-                size = TX_FIFO_SIZE;
-            }
-
-            while(size)
-            {
-                bInChar = comTbuf[comThead++];
-                UART0->DAT = bInChar;
-
-                if (comThead >= TX_BUFSIZE)
-                    comThead = 0;
-                comTbytes--;
-                size--;
-            }
-        }
-        else
-        {
-            /* No more data, just stop Tx (Stop work) */
-            UART_DISABLE_INT(UART0, UART_INTEN_THREIEN_Msk);
-        }
-    }
-}
-
-void VCOM_TransferData(void)
-{
-    int32_t i, i32Len;
-
-    /* Check whether USB is ready for next packet or not*/
-    if(gu32TxSize == 0)
-    {
-        /* Check whether we have new COM Rx data to send to USB or not */
-        if(comRbytes)
-        {
-            i32Len = comRbytes;
-            if(i32Len > EP2_MAX_PKT_SIZE)
-                i32Len = EP2_MAX_PKT_SIZE;
-
-            for(i = 0; i < i32Len; i++)
-            {
-                gRxBuf[i] = comRbuf[comRhead++];
-                if(comRhead >= RX_BUFSIZE)
-                    comRhead = 0;
-            }
-
-            __set_PRIMASK(1);
-            comRbytes -= i32Len;
-            __set_PRIMASK(0);
-
-            gu32TxSize = i32Len;
-            USBD_MemCopy((uint8_t *)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP2)), (uint8_t *)gRxBuf, i32Len);
-            USBD_SET_PAYLOAD_LEN(EP2, i32Len);
-        }
-        else
-        {
-            /* Prepare a zero packet if previous packet size is EP2_MAX_PKT_SIZE and
-               no more data to send at this moment to note Host the transfer has been done */
-            i32Len = USBD_GET_PAYLOAD_LEN(EP2);
-            if(i32Len == EP2_MAX_PKT_SIZE)
-                USBD_SET_PAYLOAD_LEN(EP2, 0);
-        }
-    }
-
-    /* Process the Bulk out data when bulk out data is ready. */
-    if(gi8BulkOutReady && (gu32RxSize <= TX_BUFSIZE - comTbytes))
-    {
-        for(i = 0; i < gu32RxSize; i++)
-        {
-            comTbuf[comTtail++] = gpu8RxBuf[i];
-            if(comTtail >= TX_BUFSIZE)
-                comTtail = 0;
-        }
-
-        __set_PRIMASK(1);
-        comTbytes += gu32RxSize;
-        __set_PRIMASK(0);
-
-        gu32RxSize = 0;
-        gi8BulkOutReady = 0; /* Clear bulk out ready flag */
-
-        /* Ready to get next BULK out */
-        USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
-    }
-
-    /* Process the software Tx FIFO */
-    if(comTbytes)
-    {
-        /* Check if Tx is working */
-        if((UART0->INTEN & UART_INTEN_THREIEN_Msk) == 0)
-        {
-            /* Send one bytes out */
-            UART0->DAT = comTbuf[comThead++];
-
-            if (comThead >= TX_BUFSIZE)
-                comThead = 0;
-
-            __set_PRIMASK(1);
-            comTbytes--;
-            __set_PRIMASK(0);
-
-            /* Enable Tx Empty Interrupt. (Trigger first one) */
-            UART_ENABLE_INT(UART0, UART_INTEN_THREIEN_Msk);
-        }
-    }
+    /* UART0 receive ring and USB-to-UART transmit complete in vcom_serial.c */
+    PDMA_DispatchIRQ(PDMA);
 }
 
 
@@ -294,7 +132,7 @@ int32_t main(void)
 
     NVIC_EnableIRQ(USBD_IRQn);
 
-    NVIC_EnableIRQ(UART02_IRQn);
+    NVIC_EnableIRQ(PDMA_IRQn);
 
 #if CRYSTAL_LESS
     /* Backup default trim */
@@ -16,6 +16,29 @@
 
 uint8_t volatile g_u8Suspend = 0;
 
+/*--------------------------------------------------------------------------*/
+/* UART0 <-> USB bridge.
+   Bulk IN (EP2) and bulk OUT (EP3) each own two packet buffers in USB SRAM.
+   One is armed on the bus while the other is filled or drained, so the host
+   is NAKed only when both are busy. UART0 RX goes into a ring by PDMA and
+   OUT packets go to UART0 TX by PDMA straight from USB SRAM. */
+static DSCT_T s_asUartRxDesc[UART_BUF_RX_SEG];
+static uint8_t s_au8UartRxRing[UART_RX_RING_SIZE];
+static UART_BUF_T s_sUartBuf;
+
+static volatile uint32_t s_u32InBusy = 0;   /* EP2 armed, cleared by IN ACK */
+static uint32_t s_u32InFill = 0;            /* Buffer filled from UART */
+static uint32_t s_u32InLen = 0;             /* Bytes in fill buffer */
+static uint32_t s_u32InLastLen = 0;         /* Size of the last IN packet, for zero length packet */
+
+static uint32_t s_au32OutLen[2];            /* Received size of each OUT buffer */
+static volatile uint32_t s_u32OutFull = 0;  /* OUT buffers waiting for UART, one bit each */
+static uint32_t s_u32OutArm = 0;            /* Buffer EP3 receives into next */
+static uint32_t s_u32OutArmed = 0;          /* EP3 armed */
+static uint32_t s_u32OutDrain = 0;          /* Buffer UART transmits next */
+static uint32_t s_u32OutXferBusy = 0;       /* UART TX PDMA in progress */
+static S_PDMA_XFER_T s_sOutXfer;
+
 /*--------------------------------------------------------------------------*/
 void USBD_IRQHandler(void)
 {
@@ -162,20 +185,116 @@ void USBD_IRQHandler(void)
     }
 }
 
+static void VCOM_OutArm(void)
+{
+    /* Receive the next packet into the free buffer while the other one drains */
+    if((s_u32OutArmed == 0) && ((s_u32OutFull & (1ul << s_u32OutArm)) == 0))
+    {
+        s_u32OutArmed = 1;
+        USBD_SET_EP_BUF_ADDR(EP3, EP3_BUF_BASE + s_u32OutArm * EP3_MAX_PKT_SIZE);
+        USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
+    }
+}
+
+static void VCOM_OutDone(void *pvUserData, int32_t i32Status);
+
+static void VCOM_OutDrain(void)
+{
+    uint32_t u32Buf;
+
+    while((s_u32OutXferBusy == 0) && (s_u32OutFull & (1ul << s_u32OutDrain)))
+    {
+        u32Buf = s_u32OutDrain;
+
+        if(s_au32OutLen[u32Buf] == 0)
+        {
+            /* Zero length packet, nothing for UART */
+            s_u32OutFull &= ~(1ul << u32Buf);
+            s_u32OutDrain ^= 1;
+            VCOM_OutArm();
+            continue;
+        }
+
+        s_sOutXfer.pfnCallback = VCOM_OutDone;
+        s_sOutXfer.pvUserData = NULL;
+
+        if(UART_WriteAsync(UART0, &s_sOutXfer, (uint8_t *)(USBD_BUF_BASE + EP3_BUF_BASE + u32Buf * EP3_MAX_PKT_SIZE),
+                           s_au32OutLen[u32Buf]) < 0)
+            break;  /* No PDMA channel now, VCOM_TransferData() retries */
+
+        s_u32OutXferBusy = 1;
+    }
+}
+
+static void VCOM_OutDone(void *pvUserData, int32_t i32Status)
+{
+    (void)pvUserData;
+    (void)i32Status;
+
+    /* UART has taken the packet, hand the buffer back to USB */
+    s_u32OutFull &= ~(1ul << s_u32OutDrain);
+    s_u32OutDrain ^= 1;
+    s_u32OutXferBusy = 0;
+    VCOM_OutArm();
+    VCOM_OutDrain();
+}
+
 void EP2_Handler(void)
 {
-    gu32TxSize = 0;
+    /* Bulk IN ACK, the other buffer may be armed now */
+    s_u32InBusy = 0;
 }
 
 
 void EP3_Handler(void)
 {
     /* Bulk OUT */
-    gu32RxSize = USBD_GET_PAYLOAD_LEN(EP3);
-    gpu8RxBuf = (uint8_t *)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP3));
+    s_au32OutLen[s_u32OutArm] = USBD_GET_PAYLOAD_LEN(EP3);
+    s_u32OutFull |= (1ul << s_u32OutArm);
+    s_u32OutArm ^= 1;
+    s_u32OutArmed = 0;
+
+    VCOM_OutArm();
+    VCOM_OutDrain();
+}
+
+void VCOM_TransferData(void)
+{
+    uint32_t u32Buf;
+
+    /* Fill the IN buffer that is not on the bus straight from the UART ring */
+    if(s_u32InLen < EP2_MAX_PKT_SIZE)
+    {
+        u32Buf = USBD_BUF_BASE + EP2_BUF_BASE + s_u32InFill * EP2_MAX_PKT_SIZE;
+        s_u32InLen += UART_BufRead(UART0, &s_sUartBuf, (uint8_t *)(u32Buf + s_u32InLen), EP2_MAX_PKT_SIZE - s_u32InLen);
+    }
 
-    /* Set a flag to indicate bulk out ready */
-    gi8BulkOutReady = 1;
+    /* Check whether USB is ready for next packet or not */
+    if(s_u32InBusy == 0)
+    {
+        if(s_u32InLen)
+        {
+            USBD_SET_EP_BUF_ADDR(EP2, EP2_BUF_BASE + s_u32InFill * EP2_MAX_PKT_SIZE);
+            s_u32InBusy = 1;
+            USBD_SET_PAYLOAD_LEN(EP2, s_u32InLen);
+            s_u32InLastLen = s_u32InLen;
+            s_u32InFill ^= 1;
+            s_u32InLen = 0;
+        }
+        else if(s_u32InLastLen == EP2_MAX_PKT_SIZE)
+        {
+            /* Prepare a zero packet if previous packet size is EP2_MAX_PKT_SIZE and
+               no more data to send at this moment to note Host the transfer has been done */
+            s_u32InBusy = 1;
+            USBD_SET_PAYLOAD_LEN(EP2, 0);
+            s_u32InLastLen = 0;
+        }
+    }
+
+    /* Retry an OUT packet that found no free PDMA channel */
+    __set_PRIMASK(1);
+    VCOM_OutDrain();
+    __set_PRIMASK(0);
 }
 
 
@@ -212,15 +331,29 @@ void VCOM_Init(void)
 
     /* EP3 ==> Bulk Out endpoint, address 2 */
     USBD_CONFIG_EP(EP3, USBD_CFG_EPMODE_OUT | BULK_OUT_EP_NUM);
-    /* Buffer offset for EP3 */
-    USBD_SET_EP_BUF_ADDR(EP3, EP3_BUF_BASE);
-    /* trigger receive OUT data */
-    USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
+    /* Buffer offset for EP3 and trigger receive OUT data */
+    s_u32OutFull = 0;
+    s_u32OutArm = 0;
+    s_u32OutArmed = 0;
+    s_u32OutDrain = 0;
+    s_u32OutXferBusy = 0;
+    VCOM_OutArm();
 
     /* EP4 ==> Interrupt IN endpoint, address 3 */
     USBD_CONFIG_EP(EP4, USBD_CFG_EPMODE_IN | INT_IN_EP_NUM);
     /* Buffer offset for EP4 ->  */
     USBD_SET_EP_BUF_ADDR(EP4, EP4_BUF_BASE);
+
+    /* UART0 receive ring, PDMA keeps it filled without interrupts */
+    PDMA->SCATBA = (uint32_t)s_asUartRxDesc & PDMA_SCATBA_SCATBA_Msk;
+    s_sUartBuf.pu8RxBuf = s_au8UartRxRing;
+    s_sUartBuf.u32RxSize = UART_RX_RING_SIZE;
+    s_sUartBuf.pu8TxBuf = NULL;
+    s_sUartBuf.u32TxSize = 0;
+    s_sUartBuf.psRxDesc = s_asUartRxDesc;
+    s_sUartBuf.pfnRxNotify = NULL;
+    s_sUartBuf.pvUserData = NULL;
+    UART_BufOpen(UART0, &s_sUartBuf, 0);
 }
 
 
@@ -306,19 +439,13 @@ void VCOM_LineCoding(uint8_t port)
 
     if (port == 0)
     {
-        NVIC_DisableIRQ(UART02_IRQn);
+        NVIC_DisableIRQ(PDMA_IRQn);
 
-        /* Reset software FIFO */
-        comRbytes = 0;
-        comRhead = 0;
-        comRtail = 0;
-
-        comTbytes = 0;
-        comThead = 0;
-        comTtail = 0;
+        /* Restart receive ring, a packet being transmitted is finished at the new setting */
+        UART_BufClose(UART0, &s_sUartBuf);
 
         /* Reset hardware FIFO */
-        UART0->FIFO = UART0->FIFO | (UART_FIFO_RXRST_Msk | UART_FIFO_TXRST_Msk);
+        UART0->FIFO = UART0->FIFO | UART_FIFO_RXRST_Msk;
 
         /* Set baudrate */
         u32Baud_Div = UART_BAUD_MODE2_DIVIDER(__HIRC, gLineCoding.u32DTERate);
@@ -363,8 +490,10 @@ void VCOM_LineCoding(uint8_t port)
 
         UART0->LINE = u32Reg;
 
-        /* Re-enable UART interrupt */
-        NVIC_EnableIRQ(UART02_IRQn);
+        UART_BufOpen(UART0, &s_sUartBuf, 0);
+
+        /* Re-enable PDMA interrupt */
+        NVIC_EnableIRQ(PDMA_IRQn);
     }
 }
 
@@ -36,9 +36,9 @@
 #define EP1_BUF_BASE        (SETUP_BUF_BASE + SETUP_BUF_LEN)
 #define EP1_BUF_LEN         EP1_MAX_PKT_SIZE
 #define EP2_BUF_BASE        (EP1_BUF_BASE + EP1_BUF_LEN)
-#define EP2_BUF_LEN         EP2_MAX_PKT_SIZE
+#define EP2_BUF_LEN         (EP2_MAX_PKT_SIZE * 2)  /* Ping-pong: two packets */
 #define EP3_BUF_BASE        (EP2_BUF_BASE + EP2_BUF_LEN)
-#define EP3_BUF_LEN         EP3_MAX_PKT_SIZE
+#define EP3_BUF_LEN         (EP3_MAX_PKT_SIZE * 2)  /* Ping-pong: two packets */
 #define EP4_BUF_BASE        (EP3_BUF_BASE + EP3_BUF_LEN)
 #define EP4_BUF_LEN         EP4_MAX_PKT_SIZE
 
@@ -69,19 +69,12 @@ typedef struct
     uint8_t   u8DataBits;     /* data bits    */
 } STR_VCOM_LINE_CODING;
 
+/* UART0 receive ring filled by PDMA, must be a power of two */
+#define UART_RX_RING_SIZE   1024
+
 /*-------------------------------------------------------------*/
-extern volatile int8_t gi8BulkOutReady;
 extern STR_VCOM_LINE_CODING gLineCoding;
 extern uint16_t gCtrlSignal;
-extern volatile uint16_t comRbytes;
-extern volatile uint16_t comRhead;
-extern volatile uint16_t comRtail;
-extern volatile uint16_t comTbytes;
-extern volatile uint16_t comThead;
-extern volatile uint16_t comTtail;
-extern uint8_t *gpu8RxBuf;
-extern uint32_t gu32RxSize;
-extern uint32_t gu32TxSize;
 
 /*-------------------------------------------------------------*/
 void VCOM_Init(void);
@@ -43,6 +43,7 @@ Purpose     : Display controller configuration (single layer)
 
 #include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "GUI.h"
 #include "GUIDRV_FlexColor.h"
@@ -50,6 +51,7 @@ Purpose     : Display controller configuration (single layer)
 #include "NuMicro.h"
 
 #include "TouchPanel.h"
+#include "tslib.h"
 
 #include "lcm.h"
 
@@ -99,6 +101,20 @@ Purpose     : Display controller configuration (single layer)
 #endif
 //#define DISPLAY_ORIENTATION (GUI_MIRROR_X | GUI_MIRROR_Y | GUI_SWAP_XY)
 
+//
+// Partial refresh
+//
+// Pixel data written by the driver are held back one row at a time and
+// compared segment by segment with a hash of what the panel already shows.
+// Only changed segments go over SPI, in the smallest window that covers
+// them; consecutive rows of the same span share one window. Costs a hash
+// per segment of the controller's memory (9.6 KB at 320x240).
+//
+#ifndef   LCD_USE_PARTIAL_REFRESH
+  #define LCD_USE_PARTIAL_REFRESH 1
+#endif
+#define DIRTY_SEG_PIXELS 32
+
 /*********************************************************************
 *
 *       Configuration checking
@@ -127,12 +143,326 @@ Purpose     : Display controller configuration (single layer)
   #define DISPLAY_ORIENTATION 0
 #endif
 
+//
+// Controller memory as addressed by CASET/PASET; the driver lets the
+// controller do the XY swap
+//
+#if (DISPLAY_ORIENTATION & GUI_SWAP_XY)
+  #define DIRTY_XSIZE YSIZE_PHYS
+  #define DIRTY_YSIZE XSIZE_PHYS
+#else
+  #define DIRTY_XSIZE XSIZE_PHYS
+  #define DIRTY_YSIZE YSIZE_PHYS
+#endif
+#define DIRTY_NUM_SEGS ((DIRTY_XSIZE + DIRTY_SEG_PIXELS - 1) / DIRTY_SEG_PIXELS)
+
+//
+// Controller commands seen by the partial refresh
+//
+#define CMD_SWRESET 0x01
+#define CMD_CASET   0x2A
+#define CMD_PASET   0x2B
+#define CMD_RAMWR   0x2C
+#define CMD_RAMRD   0x2E
+#define CMD_MADCTL  0x36
+
+#if LCD_USE_PARTIAL_REFRESH
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static U32 _aHash[DIRTY_YSIZE][DIRTY_NUM_SEGS];     // Hash of the last write to each segment, 0 if unknown
+static U16 _aRow[DIRTY_NUM_SEGS * DIRTY_SEG_PIXELS]; // Row being written, at its x position
+static U8  _Cmd;          // Last command written by the driver
+static int _NumParas;     // Parameter bytes received for _Cmd
+static int _aWin[4];      // Window requested by the driver: x0, x1, y0, y1
+static int _NumBytes;     // Bytes of the current row received
+static int _yPos;         // Row receiving data
+static int _Bypass;       // Window outside of the tracked memory, data go straight to the panel
+static int _aPanel[4];    // Window programmed into the panel
+static int _PanelValid;   // _aPanel[] is known
+static int _yPanel;       // Panel row receiving the next data, -1 if no memory write is open
+
+#endif
+
 /*********************************************************************
 *
 *       Static code
 *
 **********************************************************************
 */
+#if LCD_USE_PARTIAL_REFRESH
+
+/*********************************************************************
+*
+*       _Invalidate
+*
+* Purpose:
+*   Forgets the panel contents and window, e.g. after a reset of the
+*   controller or when its address mode changes.
+*/
+static void _Invalidate(void) {
+  memset(_aHash, 0, sizeof(_aHash));
+  _PanelValid = 0;
+  _yPanel     = -1;
+}
+
+/*********************************************************************
+*
+*       _WriteWin
+*/
+static void _WriteWin(U8 Cmd, int v0, int v1) {
+  _Write0(Cmd);
+  _Write1((U8)(v0 >> 8));
+  _Write1((U8)v0);
+  _Write1((U8)(v1 >> 8));
+  _Write1((U8)v1);
+}
+
+/*********************************************************************
+*
+*       _SetWindow
+*
+* Purpose:
+*   Opens a memory write at column x0, row y0 of the window x0..x1,
+*   y0..y1. Nothing is sent if the panel will take data there anyway.
+*/
+static void _SetWindow(int x0, int x1, int y0, int y1) {
+  if (_PanelValid && (_yPanel == y0) && (_aPanel[0] == x0) && (_aPanel[1] == x1) && (y0 <= _aPanel[3])) {
+    return;
+  }
+  if ((_PanelValid == 0) || (_aPanel[0] != x0) || (_aPanel[1] != x1)) {
+    _WriteWin(CMD_CASET, x0, x1);
+  }
+  if ((_PanelValid == 0) || (_aPanel[2] != y0) || (_aPanel[3] != y1)) {
+    _WriteWin(CMD_PASET, y0, y1);
+  }
+  _Write0(CMD_RAMWR);
+  _aPanel[0]  = x0;
+  _aPanel[1]  = x1;
+  _aPanel[2]  = y0;
+  _aPanel[3]  = y1;
+  _PanelValid = 1;
+  _yPanel     = y0;
+}
+
+/*********************************************************************
+*
+*       _SendSpan
+*
+* Purpose:
+*   Sends columns x0..x1 of the buffered row to the panel.
+*/
+static void _SendSpan(int x0, int x1) {
+  _SetWindow(x0, x1, _yPos, _aWin[3]);
+  _WriteM1((U8 *)_aRow + x0 * 2, (x1 - x0 + 1) * 2);
+  _yPanel++;
+}
+
+/*********************************************************************
+*
+*       _HashSpan
+*
+* Purpose:
+*   Hashes columns x0..x1 of the buffered row. The columns are part of
+*   the hash, so a segment only matches a write of the same extent.
+*/
+static U32 _HashSpan(int x0, int x1) {
+  const U16 * pData;
+  U32 Hash;
+  int x;
+
+  pData = &_aRow[x0];
+  Hash  = (2166136261u ^ ((U32)x0 << 16) ^ (U32)x1) * 16777619u;
+  for (x = x0; x <= x1; x++) {
+    Hash = (Hash ^ *pData++) * 16777619u;
+  }
+  return Hash | 1;  // 0 is reserved for unknown segments
+}
+
+/*********************************************************************
+*
+*       _FlushRow
+*
+* Purpose:
+*   Sends the parts of the buffered row which differ from what was last
+*   written to the same segments of the panel.
+*/
+static void _FlushRow(void) {
+  int x0;
+  int x1;
+  int xSpan;
+  int Seg;
+  U32 Hash;
+
+  xSpan = -1;
+  for (Seg = _aWin[0] / DIRTY_SEG_PIXELS; Seg <= _aWin[1] / DIRTY_SEG_PIXELS; Seg++) {
+    x0   = Seg * DIRTY_SEG_PIXELS;
+    x1   = x0 + DIRTY_SEG_PIXELS - 1;
+    x0   = (x0 < _aWin[0]) ? _aWin[0] : x0;
+    x1   = (x1 > _aWin[1]) ? _aWin[1] : x1;
+    Hash = _HashSpan(x0, x1);
+    if (_aHash[_yPos][Seg] == Hash) {
+      if (xSpan >= 0) {
+        _SendSpan(xSpan, x0 - 1);
+        xSpan = -1;
+      }
+    } else {
+      _aHash[_yPos][Seg] = Hash;
+      if (xSpan < 0) {
+        xSpan = x0;
+      }
+    }
+  }
+  if (xSpan >= 0) {
+    _SendSpan(xSpan, _aWin[1]);
+  }
+}
+
+/*********************************************************************
+*
+*       _EndWrite
+*
+* Purpose:
+*   Completes a memory write ended by another command. A row cut short
+*   is sent as it is.
+*/
+static void _EndWrite(void) {
+  int x0;
+  int x1;
+  int Seg;
+
+  if ((_Cmd != CMD_RAMWR) || _Bypass || (_NumBytes == 0)) {
+    return;
+  }
+  x0 = _aWin[0];
+  x1 = x0 + (_NumBytes - 1) / 2;
+  for (Seg = x0 / DIRTY_SEG_PIXELS; Seg <= x1 / DIRTY_SEG_PIXELS; Seg++) {
+    _aHash[_yPos][Seg] = 0;
+  }
+  _SetWindow(x0, _aWin[1], _yPos, _aWin[3]);
+  _WriteM1((U8 *)_aRow + x0 * 2, _NumBytes);
+  _yPanel   = -1;
+  _NumBytes = 0;
+}
+
+/*********************************************************************
+*
+*       _WriteRAM
+*/
+static void _WriteRAM(U8 * pData, int NumItems) {
+  int NumBytesRow;
+  int NumBytes;
+
+  if (_Bypass) {
+    _WriteM1(pData, NumItems);
+    return;
+  }
+  NumBytesRow = (_aWin[1] - _aWin[0] + 1) * 2;
+  while (NumItems) {
+    NumBytes = NumBytesRow - _NumBytes;
+    if (NumBytes > NumItems) {
+      NumBytes = NumItems;
+    }
+    memcpy((U8 *)_aRow + _aWin[0] * 2 + _NumBytes, pData, NumBytes);
+    _NumBytes += NumBytes;
+    pData     += NumBytes;
+    NumItems  -= NumBytes;
+    if (_NumBytes == NumBytesRow) {
+      _FlushRow();
+      _NumBytes = 0;
+      if (++_yPos > _aWin[3]) {
+        _yPos = _aWin[2];
+      }
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       _DirtyWrite0
+*
+* Purpose:
+*   Command port of the driver. Window and memory write commands are
+*   held back until there are pixels to send, all others pass through.
+*/
+static void _DirtyWrite0(U8 Cmd) {
+  _EndWrite();
+  _Cmd      = Cmd;
+  _NumParas = 0;
+  switch (Cmd) {
+  case CMD_CASET:
+  case CMD_PASET:
+    return;
+  case CMD_RAMWR:
+    _yPos     = _aWin[2];
+    _NumBytes = 0;
+    _Bypass   = (_aWin[0] > _aWin[1]) || (_aWin[2] > _aWin[3]) || (_aWin[1] >= DIRTY_XSIZE) || (_aWin[3] >= DIRTY_YSIZE);
+    if (_Bypass) {
+      _Invalidate();
+      _WriteWin(CMD_CASET, _aWin[0], _aWin[1]);
+      _WriteWin(CMD_PASET, _aWin[2], _aWin[3]);
+      _Write0(CMD_RAMWR);
+    }
+    return;
+  case CMD_RAMRD:
+    _WriteWin(CMD_CASET, _aWin[0], _aWin[1]);
+    _WriteWin(CMD_PASET, _aWin[2], _aWin[3]);
+    _PanelValid = 0;
+    break;
+  case CMD_SWRESET:
+  case CMD_MADCTL:
+    _Invalidate();
+    break;
+  }
+  _yPanel = -1;
+  _Write0(Cmd);
+}
+
+/*********************************************************************
+*
+*       _DirtyWriteM1
+*
+* Purpose:
+*   Data port of the driver.
+*/
+static void _DirtyWriteM1(U8 * pData, int NumItems) {
+  int * pWin;
+
+  switch (_Cmd) {
+  case CMD_CASET:
+  case CMD_PASET:
+    pWin = &_aWin[(_Cmd == CMD_CASET) ? 0 : 2];
+    for (; NumItems && (_NumParas < 4); NumItems--, _NumParas++) {
+      if (_NumParas & 1) {
+        pWin[_NumParas >> 1] |= *pData++;
+      } else {
+        pWin[_NumParas >> 1]  = *pData++ << 8;
+      }
+    }
+    break;
+  case CMD_RAMWR:
+    _WriteRAM(pData, NumItems);
+    break;
+  default:
+    _WriteM1(pData, NumItems);
+    break;
+  }
+}
+
+/*********************************************************************
+*
+*       _DirtyWrite1
+*/
+static void _DirtyWrite1(U8 Data) {
+  _DirtyWriteM1(&Data, 1);
+}
+
+#endif
+
 /*********************************************************************
 *
 *       Public code
@@ -175,10 +505,17 @@ void LCD_X_Config(void) {
   //
   // Function selection, hardware routines (PortAPI) and operation mode (bus, bpp and cache)
   //
+#if LCD_USE_PARTIAL_REFRESH
+  PortAPI.pfWrite8_A0  = _DirtyWrite0;
+  PortAPI.pfWrite8_A1  = _DirtyWrite1;
+  PortAPI.pfWriteM8_A0 = _WriteM1;
+  PortAPI.pfWriteM8_A1 = _DirtyWriteM1;
+#else
   PortAPI.pfWrite8_A0  = _Write0;
   PortAPI.pfWrite8_A1  = _Write1;
   PortAPI.pfWriteM8_A0 = _WriteM1;
   PortAPI.pfWriteM8_A1 = _WriteM1;
+#endif
   PortAPI.pfRead8_A0   = _Read1;    /* FIXME if panel supports read back feature */
   PortAPI.pfRead8_A1   = _Read1;    /* FIXME if panel supports read back feature */
   PortAPI.pfReadM8_A0  = _ReadM1;   /* FIXME if panel supports read back feature */
@@ -229,6 +566,9 @@ int LCD_X_DisplayDriver(unsigned LayerIndex, unsigned Cmd, void * pData) {
     // to be adapted by the customer...
     //
     _InitController();
+#if LCD_USE_PARTIAL_REFRESH
+    _Invalidate();
+#endif
     return 0;
   }
   default:
@@ -239,36 +579,75 @@ int LCD_X_DisplayDriver(unsigned LayerIndex, unsigned Cmd, void * pData) {
 #if GUI_SUPPORT_TOUCH
 extern int ts_phy2log(int *sumx, int *sumy);
 
+//
+// GUI_TOUCH_Exec() measures one axis per call. Both axes of a pair come
+// from one panel scan; the second callback takes the cached coordinate.
+//
+#define TOUCH_AXIS_X 1
+#define TOUCH_AXIS_Y 2
+
+static int      _aTouch[2];     // Logical x and y of the last scan, -1 if the pen is up
+static unsigned _TouchUnread;   // Axes of _aTouch[] not measured yet
+
+/*********************************************************************
+*
+*       _MeasureTouch
+*/
+static int _MeasureTouch(unsigned Axis) {
+  int x;
+  int y;
+
+  if ((_TouchUnread & Axis) == 0) {
+    if (Poll_TouchPanel(&x, &y)) {
+      ts_phy2log(&x, &y);
+      _aTouch[0] = x;
+      _aTouch[1] = y;
+    } else {
+      _aTouch[0] = -1;
+      _aTouch[1] = -1;
+    }
+    _TouchUnread = TOUCH_AXIS_X | TOUCH_AXIS_Y;
+  }
+  _TouchUnread &= ~Axis;
+  return _aTouch[(Axis == TOUCH_AXIS_Y) ? 1 : 0];
+}
+
 void GUI_TOUCH_X_ActivateX(void) {
 }
 
 void GUI_TOUCH_X_ActivateY(void) {
 }
 
-
- 
 int  GUI_TOUCH_X_MeasureX(void) {
-  int sumx;
-  int sumy;
-	if (Read_TouchPanel(&sumx, &sumy))
-	{
-//		printf("X = %d\n", sumx);
-		ts_phy2log(&sumx, &sumy);		
-    return sumx;
-	}
-	return -1;
+  return _MeasureTouch(TOUCH_AXIS_X);
 }
 
 int  GUI_TOUCH_X_MeasureY(void) {
-  int sumx;
-  int sumy;
-	if ( Read_TouchPanel(&sumx, &sumy) )
-	{
-//		printf("Y = %d\n", sumy);
-		ts_phy2log(&sumx, &sumy);				
-    return sumy;
-	}
-	return -1;
+  return _MeasureTouch(TOUCH_AXIS_Y);
+}
+
+/*********************************************************************
+*
+*       Store_TouchEvents
+*
+* Purpose:
+*   Replaces GUI_TOUCH_Exec() while Start_TouchScan() is in effect:
+*   passes the pen events queued by the background scan to emWin.
+*   The events are filtered and in screen coordinates already, so
+*   the GUI_TOUCH_Calibrate() setting does not apply. Call it from
+*   the same context as GUI_TOUCH_Exec() would be.
+*/
+void Store_TouchEvents(void) {
+  struct ts_sample Sample;
+  GUI_PID_STATE    State;
+
+  while (Read_TouchEvent(&Sample)) {
+    State.x       = Sample.x;
+    State.y       = Sample.y;
+    State.Pressed = (Sample.pressure != 0) ? 1 : 0;
+    State.Layer   = 0;
+    GUI_TOUCH_StoreStateEx(&State);
+  }
 }
 #endif
 /*************************** End of file ****************************/